@@ -18,6 +18,7 @@
 #include "cast/common/certificate/cast_cert_validator_internal.h"
 #include "cast/common/certificate/cast_crl.h"
 #include "cast/common/certificate/cast_trust_store.h"
+#include "cast/common/certificate/cert_verification_cache.h"
 #include "util/osp_logging.h"
 
 namespace openscreen {
@@ -127,24 +128,34 @@ CastDeviceCertPolicy GetAudioPolicy(const std::vector<X509*>& path) {
   return policy;
 }
 
-}  // namespace
-
-Error VerifyDeviceCert(const std::vector<std::string>& der_certs,
-                       const DateTime& time,
-                       std::unique_ptr<CertVerificationContext>* context,
-                       CastDeviceCertPolicy* policy,
-                       const CastCRL* crl,
-                       CRLPolicy crl_policy,
-                       TrustStore* trust_store) {
-  if (!trust_store) {
-    trust_store = CastTrustStore::GetInstance()->trust_store();
-  }
-
-  // Fail early if CRL is required but not provided.
-  if (!crl && crl_policy == CRLPolicy::kCrlRequired) {
-    return Error::Code::kErrCrlInvalid;
+// Returns the period during which every certificate in |path| is valid.
+bool GetPathValidTimeRange(const std::vector<X509*>& path,
+                           DateTime* not_before,
+                           DateTime* not_after) {
+  for (size_t i = 0; i < path.size(); ++i) {
+    DateTime cert_not_before;
+    DateTime cert_not_after;
+    if (!GetCertValidTimeRange(path[i], &cert_not_before, &cert_not_after)) {
+      return false;
+    }
+    if (i == 0 || *not_before < cert_not_before) {
+      *not_before = cert_not_before;
+    }
+    if (i == 0 || cert_not_after < *not_after) {
+      *not_after = cert_not_after;
+    }
   }
+  return !path.empty();
+}
 
+// Verifies |der_certs| as VerifyDeviceCert() does, apart from revocation,
+// which is checked against |crl| only if |crl_policy| requires it.
+ErrorOr<std::shared_ptr<const CertVerificationCache::VerifiedChain>>
+VerifyChain(const std::vector<std::string>& der_certs,
+            const DateTime& time,
+            const CastCRL* crl,
+            CRLPolicy crl_policy,
+            TrustStore* trust_store) {
   CertificatePathResult result_path = {};
   Error error = FindCertificatePath(der_certs, time, &result_path, trust_store);
   if (!error.ok()) {
@@ -156,7 +167,8 @@ Error VerifyDeviceCert(const std::vector<std::string>& der_certs,
     return Error::Code::kErrCertsRevoked;
   }
 
-  *policy = GetAudioPolicy(result_path.path);
+  auto chain = std::make_shared<CertVerificationCache::VerifiedChain>();
+  chain->policy = GetAudioPolicy(result_path.path);
 
   // Finally, make sure there is a common name to give to
   // CertVerificationContextImpl.
@@ -169,10 +181,73 @@ Error VerifyDeviceCert(const std::vector<std::string>& der_certs,
     return Error::Code::kErrCertsRestrictions;
   }
   common_name.resize(len);
+  chain->common_name = std::move(common_name);
+
+  if (!GetPathValidTimeRange(result_path.path, &chain->not_before,
+                             &chain->not_after)) {
+    return Error::Code::kErrCertsDateInvalid;
+  }
+
+  // The path also refers to the trust anchor, which belongs to |trust_store|,
+  // so each certificate takes its own reference.
+  for (X509* cert : result_path.path) {
+    X509_up_ref(cert);
+    chain->certs.emplace_back(cert);
+    chain->path.push_back(cert);
+  }
+  chain->public_key.reset(X509_get_pubkey(result_path.target_cert.get()));
+  return std::shared_ptr<const CertVerificationCache::VerifiedChain>(
+      std::move(chain));
+}
+
+}  // namespace
+
+Error VerifyDeviceCert(const std::vector<std::string>& der_certs,
+                       const DateTime& time,
+                       std::unique_ptr<CertVerificationContext>* context,
+                       CastDeviceCertPolicy* policy,
+                       const CastCRL* crl,
+                       CRLPolicy crl_policy,
+                       TrustStore* trust_store,
+                       CertVerificationCache* cache) {
+  if (!trust_store) {
+    trust_store = CastTrustStore::GetInstance()->trust_store();
+  }
+
+  // Fail early if CRL is required but not provided.
+  if (!crl && crl_policy == CRLPolicy::kCrlRequired) {
+    return Error::Code::kErrCrlInvalid;
+  }
+
+  std::string cache_key;
+  std::shared_ptr<const CertVerificationCache::VerifiedChain> chain;
+  if (cache) {
+    cache_key = CertVerificationCache::MakeKey(der_certs, *trust_store);
+    chain = cache->Find(cache_key, time);
+  }
+
+  if (chain) {
+    // The CRL may have changed since the chain was cached.
+    if (crl_policy == CRLPolicy::kCrlRequired &&
+        !crl->CheckRevocation(chain->path, time)) {
+      return Error::Code::kErrCertsRevoked;
+    }
+  } else {
+    ErrorOr<std::shared_ptr<const CertVerificationCache::VerifiedChain>>
+        result = VerifyChain(der_certs, time, crl, crl_policy, trust_store);
+    if (result.is_error()) {
+      return std::move(result.error());
+    }
+    chain = std::move(result.value());
+    if (cache) {
+      cache->Add(std::move(cache_key), chain);
+    }
+  }
 
+  *policy = chain->policy;
+  EVP_PKEY_up_ref(chain->public_key.get());
   context->reset(new CertVerificationContextImpl(
-      bssl::UniquePtr<EVP_PKEY>{X509_get_pubkey(result_path.target_cert.get())},
-      std::move(common_name)));
+      bssl::UniquePtr<EVP_PKEY>{chain->public_key.get()}, chain->common_name));
 
   return Error::Code::kNone;
 }
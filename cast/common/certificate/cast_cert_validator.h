@@ -17,6 +17,7 @@ namespace openscreen {
 namespace cast {
 
 class CastCRL;
+class CertVerificationCache;
 
 // Describes the policy for a Device certificate.
 enum class CastDeviceCertPolicy {
@@ -93,6 +94,10 @@ class CertVerificationContext {
 //   root CAs during chain verification.  If this is nullptr, the built-in Cast
 //   root certificates will be used.
 //
+// * |cache| optionally holds the results of earlier verifications.  If the
+//   same chain was verified against the same trust store before, path building
+//   and signature checks are skipped, though revocation is still checked.
+//
 // Outputs:
 //
 // Returns Error::Code::kNone on success.  Otherwise, the corresponding
@@ -110,7 +115,8 @@ class CertVerificationContext {
     CastDeviceCertPolicy* policy,
     const CastCRL* crl,
     CRLPolicy crl_policy,
-    TrustStore* trust_store = nullptr);
+    TrustStore* trust_store = nullptr,
+    CertVerificationCache* cache = nullptr);
 
 }  // namespace cast
 }  // namespace openscreen
@@ -7,7 +7,9 @@
 #include <openssl/digest.h>
 #include <time.h>
 
+#include <algorithm>
 #include <memory>
+#include <utility>
 
 #include "absl/strings/string_view.h"
 #include "cast/common/certificate/cast_cert_validator_internal.h"
@@ -161,6 +163,27 @@ CastCRL::CastCRL(const TbsCrl& tbs_crl, const DateTime& overall_not_after) {
     auto& serial_number_range = revoked_serial_numbers_[issuer_hash];
     serial_number_range.push_back({first_serial_number, last_serial_number});
   }
+
+  // Sort and merge the ranges of each issuer.
+  for (auto& issuer_ranges : revoked_serial_numbers_) {
+    std::vector<SerialNumberRange>& ranges = issuer_ranges.second;
+    std::sort(ranges.begin(), ranges.end(),
+              [](const SerialNumberRange& a, const SerialNumberRange& b) {
+                return a.first_serial < b.first_serial;
+              });
+    size_t merged = 0;
+    for (size_t i = 1; i < ranges.size(); ++i) {
+      SerialNumberRange& last = ranges[merged];
+      if (ranges[i].first_serial <= last.last_serial ||
+          ranges[i].first_serial - last.last_serial == 1) {
+        last.last_serial = std::max(last.last_serial, ranges[i].last_serial);
+      } else {
+        ranges[++merged] = ranges[i];
+      }
+    }
+    ranges.resize(merged + 1);
+    ranges.shrink_to_fit();
+  }
 }
 
 CastCRL::~CastCRL() {}
@@ -205,11 +228,17 @@ bool CastCRL::CheckRevocation(const std::vector<X509*>& trusted_chain,
           continue;
         }
         serial_number = maybe_serial.value();
-        for (const auto& revoked_serial : issuer_iter->second) {
-          if (revoked_serial.first_serial <= serial_number &&
-              revoked_serial.last_serial >= serial_number) {
-            return false;
-          }
+
+        // Find the last range starting at or before |serial_number|.
+        const std::vector<SerialNumberRange>& ranges = issuer_iter->second;
+        auto range = std::upper_bound(
+            ranges.begin(), ranges.end(), serial_number,
+            [](uint64_t serial, const SerialNumberRange& range) {
+              return serial < range.first_serial;
+            });
+        if (range != ranges.begin() &&
+            std::prev(range)->last_serial >= serial_number) {
+          return false;
         }
       }
     }
@@ -248,5 +277,69 @@ std::unique_ptr<CastCRL> ParseAndVerifyCRL(const std::string& crl_proto,
   return nullptr;
 }
 
+// static
+constexpr size_t CastCRLStore::kMaxEntries;
+
+// static
+CastCRLStore* CastCRLStore::GetInstance() {
+  static CastCRLStore* const store = new CastCRLStore();
+  return store;
+}
+
+CastCRLStore::CastCRLStore(TrustStore* trust_store)
+    : trust_store_(trust_store) {}
+
+CastCRLStore::~CastCRLStore() = default;
+
+std::shared_ptr<const CastCRL> CastCRLStore::GetCRL(
+    const std::string& crl_proto,
+    const DateTime& time) {
+  ErrorOr<std::string> bundle_hash = SHA256HashString(crl_proto);
+  if (bundle_hash.is_error()) {
+    return nullptr;
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto it = std::find_if(entries_.begin(), entries_.end(),
+                           [&bundle_hash](const Entry& entry) {
+                             return entry.bundle_hash == bundle_hash.value();
+                           });
+    if (it != entries_.end()) {
+      if (!(time < it->crl->not_before()) && !(it->crl->not_after() < time)) {
+        return it->crl;
+      }
+      entries_.erase(it);
+    }
+  }
+
+  // Verifying the signature is the expensive part, so it is done without
+  // holding the lock.  Another thread may verify the same bundle meanwhile, in
+  // which case its result is replaced.
+  std::shared_ptr<const CastCRL> crl =
+      ParseAndVerifyCRL(crl_proto, time, trust_store_);
+  if (!crl) {
+    return nullptr;
+  }
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  entries_.erase(std::remove_if(entries_.begin(), entries_.end(),
+                                [&bundle_hash](const Entry& entry) {
+                                  return entry.bundle_hash ==
+                                         bundle_hash.value();
+                                }),
+                 entries_.end());
+  if (entries_.size() == kMaxEntries) {
+    entries_.erase(entries_.begin());
+  }
+  entries_.push_back(Entry{std::move(bundle_hash.value()), crl});
+  return crl;
+}
+
+size_t CastCRLStore::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
 }  // namespace cast
 }  // namespace openscreen
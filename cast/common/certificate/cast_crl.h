@@ -8,11 +8,13 @@
 #include <openssl/x509.h>
 
 #include <memory>
+#include <mutex>
 #include <string>
 #include <unordered_map>
 #include <unordered_set>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "cast/common/certificate/cast_cert_validator.h"
 #include "cast/common/certificate/proto/revocation.pb.h"
 #include "platform/base/macros.h"
@@ -49,6 +51,10 @@ class CastCRL {
   bool CheckRevocation(const std::vector<X509*>& trusted_chain,
                        const DateTime& time) const;
 
+  // The period during which the CRL may be used.
+  const DateTime& not_before() const { return not_before_; }
+  const DateTime& not_after() const { return not_after_; }
+
  private:
   struct SerialNumberRange {
     uint64_t first_serial;
@@ -64,7 +70,9 @@ class CastCRL {
 
   // Revoked serial number ranges indexed by issuer public key hash.
   // The key is the SHA256 hash of issuer's SubjectPublicKeyInfo.
-  // The value is a list of revoked serial number ranges.
+  // The value is a list of revoked serial number ranges, sorted and with
+  // overlapping ranges merged, so that a serial number can be looked up by
+  // binary search.
   std::unordered_map<std::string, std::vector<SerialNumberRange>>
       revoked_serial_numbers_;
 
@@ -88,6 +96,48 @@ std::unique_ptr<CastCRL> ParseAndVerifyCRL(const std::string& crl_proto,
                                            const DateTime& time,
                                            TrustStore* trust_store = nullptr);
 
+// Keeps the CRLs that have already been parsed and verified, so that every
+// authentication presenting the same CRL bundle (usually all of them, between
+// CRL updates) shares one CastCRL instead of parsing the bundle and verifying
+// its signature again.  A CRL is reused until its not-after time, after which
+// the bundle must verify anew.  It is safe to use from multiple threads.
+class CastCRLStore {
+ public:
+  static constexpr size_t kMaxEntries = 4;
+
+  // The store used for sender-side device authentication, which verifies CRLs
+  // using the built-in Cast CRL trust anchors.
+  static CastCRLStore* GetInstance();
+
+  // |trust_store| is as for ParseAndVerifyCRL(), and must outlive the store.
+  explicit CastCRLStore(TrustStore* trust_store = nullptr);
+  ~CastCRLStore();
+
+  // Returns the CRL in |crl_proto| as ParseAndVerifyCRL() would, but without
+  // repeating the work if the same bundle was verified before and its CRL is
+  // still valid at |time|.  Returns nullptr if the CRL is invalid.
+  std::shared_ptr<const CastCRL> GetCRL(const std::string& crl_proto,
+                                        const DateTime& time);
+
+  size_t size() const;
+
+ private:
+  struct Entry {
+    // The SHA256 hash of the serialized CrlBundle.
+    std::string bundle_hash;
+    std::shared_ptr<const CastCRL> crl;
+  };
+
+  TrustStore* const trust_store_;
+
+  mutable std::mutex mutex_;
+
+  // Oldest first.
+  std::vector<Entry> entries_ GUARDED_BY(mutex_);
+
+  OSP_DISALLOW_COPY_AND_ASSIGN(CastCRLStore);
+};
+
 }  // namespace cast
 }  // namespace openscreen
 
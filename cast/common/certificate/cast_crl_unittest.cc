@@ -4,6 +4,8 @@
 
 #include "cast/common/certificate/cast_crl.h"
 
+#include <algorithm>
+
 #include "cast/common/certificate/cast_cert_validator.h"
 #include "cast/common/certificate/cast_cert_validator_internal.h"
 #include "cast/common/certificate/proto/test_suite.pb.h"
@@ -11,6 +13,9 @@
 #include "gtest/gtest.h"
 #include "platform/test/paths.h"
 #include "testing/util/read_file.h"
+#include "util/crypto/certificate_utils.h"
+#include "util/crypto/pem_helpers.h"
+#include "util/crypto/sha2.h"
 #include "util/osp_logging.h"
 
 namespace openscreen {
@@ -199,6 +204,179 @@ TEST(CastCertificateTest, TestSuite1) {
   RunTestSuite(GetSpecificTestDataPath() + "testsuite/testsuite1.pb");
 }
 
+const std::string& GetChannelTestDataPath() {
+  static std::string data_path = GetTestDataPath() + "cast/receiver/channel/";
+  return data_path;
+}
+
+DateTime CreateDate(int year, int month, int day) {
+  DateTime time = {};
+  time.year = year;
+  time.month = month;
+  time.day = day;
+  return time;
+}
+
+// A time when the CRLs in the channel test data are valid.
+DateTime December2019() {
+  return CreateDate(2019, 12, 17);
+}
+
+// Returns the test device certificate chain, trust anchor first, as expected
+// by CastCRL::CheckRevocation().
+std::vector<bssl::UniquePtr<X509>> ReadDeviceChain() {
+  std::vector<bssl::UniquePtr<X509>> chain;
+  for (const std::string& der_cert : ReadCertificatesFromPemFile(
+           GetChannelTestDataPath() + "device_chain.pem")) {
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(der_cert.data());
+    chain.emplace_back(d2i_X509(nullptr, &data, der_cert.size()));
+  }
+  std::reverse(chain.begin(), chain.end());
+  return chain;
+}
+
+std::vector<X509*> GetPath(const std::vector<bssl::UniquePtr<X509>>& chain) {
+  std::vector<X509*> path;
+  for (const bssl::UniquePtr<X509>& cert : chain) {
+    path.push_back(cert.get());
+  }
+  return path;
+}
+
+void AddSerialNumberRange(TbsCrl* tbs_crl,
+                          X509* issuer,
+                          uint64_t first,
+                          uint64_t last) {
+  SerialNumberRange* serial_range = tbs_crl->add_revoked_serial_number_ranges();
+  serial_range->set_issuer_public_key_hash(
+      SHA256HashString(GetSpkiTlv(issuer)).value());
+  serial_range->set_first_serial_number(first);
+  serial_range->set_last_serial_number(last);
+}
+
+TEST(CastCRLTest, ChecksOverlappingSerialNumberRanges) {
+  const std::vector<bssl::UniquePtr<X509>> chain = ReadDeviceChain();
+  ASSERT_EQ(3u, chain.size());
+  X509* const inter_cert = chain[1].get();
+  ErrorOr<uint64_t> device_serial =
+      ParseDerUint64(X509_get0_serialNumber(chain[2].get()));
+  ASSERT_TRUE(device_serial);
+  const uint64_t serial = device_serial.value();
+  ASSERT_GE(serial, 100u);
+
+  TbsCrl tbs_crl;
+  tbs_crl.set_not_before_seconds(
+      DateTimeToSeconds(CreateDate(2019, 12, 1)).count());
+  tbs_crl.set_not_after_seconds(
+      DateTimeToSeconds(CreateDate(2020, 12, 1)).count());
+
+  // Ranges on either side of the device's serial number, given out of order,
+  // some overlapping and some contained in others.
+  AddSerialNumberRange(&tbs_crl, inter_cert, serial + 1, serial + 10);
+  AddSerialNumberRange(&tbs_crl, inter_cert, serial - 100, serial - 50);
+  AddSerialNumberRange(&tbs_crl, inter_cert, serial - 60, serial - 1);
+  AddSerialNumberRange(&tbs_crl, inter_cert, serial - 20, serial - 10);
+  AddSerialNumberRange(&tbs_crl, inter_cert, serial + 5, serial + 50);
+  const std::vector<X509*> path = GetPath(chain);
+  {
+    CastCRL crl(tbs_crl, CreateDate(2020, 12, 1));
+    EXPECT_TRUE(crl.CheckRevocation(path, December2019()));
+  }
+
+  // The device's serial number alone.
+  AddSerialNumberRange(&tbs_crl, inter_cert, serial, serial);
+  {
+    CastCRL crl(tbs_crl, CreateDate(2020, 12, 1));
+    EXPECT_FALSE(crl.CheckRevocation(path, December2019()));
+  }
+
+  // A range that contains the device's serial number, but is overlapped by a
+  // range that starts closer to it.
+  tbs_crl.clear_revoked_serial_number_ranges();
+  AddSerialNumberRange(&tbs_crl, inter_cert, serial - 50, serial + 50);
+  AddSerialNumberRange(&tbs_crl, inter_cert, serial - 10, serial - 5);
+  {
+    CastCRL crl(tbs_crl, CreateDate(2020, 12, 1));
+    EXPECT_FALSE(crl.CheckRevocation(path, December2019()));
+  }
+}
+
+class CastCRLStoreTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    crl_trust_store_ = TrustStore::CreateInstanceFromPemFile(
+        GetChannelTestDataPath() + "crl_root.pem");
+    ASSERT_FALSE(crl_trust_store_.certs.empty());
+  }
+
+  std::string ReadCrl(const std::string& file_name) {
+    return ReadEntireFileToString(GetChannelTestDataPath() + file_name);
+  }
+
+  TrustStore crl_trust_store_;
+};
+
+TEST_F(CastCRLStoreTest, SharesVerifiedCrls) {
+  CastCRLStore store(&crl_trust_store_);
+  const std::string good_crl = ReadCrl("good_crl.pb");
+  std::shared_ptr<const CastCRL> crl = store.GetCRL(good_crl, December2019());
+  ASSERT_TRUE(crl);
+  EXPECT_EQ(1u, store.size());
+  EXPECT_EQ(crl, store.GetCRL(good_crl, CreateDate(2020, 1, 1)));
+  EXPECT_EQ(1u, store.size());
+
+  const std::vector<bssl::UniquePtr<X509>> chain = ReadDeviceChain();
+  EXPECT_TRUE(crl->CheckRevocation(GetPath(chain), December2019()));
+
+  std::shared_ptr<const CastCRL> revoked_crl =
+      store.GetCRL(ReadCrl("device_revoked_crl.pb"), December2019());
+  ASSERT_TRUE(revoked_crl);
+  EXPECT_NE(crl, revoked_crl);
+  EXPECT_EQ(2u, store.size());
+  EXPECT_FALSE(revoked_crl->CheckRevocation(GetPath(chain), December2019()));
+}
+
+TEST_F(CastCRLStoreTest, DoesNotStoreInvalidCrls) {
+  CastCRLStore store(&crl_trust_store_);
+  EXPECT_FALSE(store.GetCRL(ReadCrl("bad_signature_crl.pb"), December2019()));
+  EXPECT_FALSE(store.GetCRL(ReadCrl("bad_signer_cert_crl.pb"), December2019()));
+  EXPECT_FALSE(store.GetCRL(ReadCrl("invalid_time_crl.pb"), December2019()));
+  EXPECT_FALSE(store.GetCRL("not a CRL", December2019()));
+  EXPECT_EQ(0u, store.size());
+}
+
+TEST_F(CastCRLStoreTest, VerifiesCrlsAgainAfterTheyExpire) {
+  CastCRLStore store(&crl_trust_store_);
+  const std::string good_crl = ReadCrl("good_crl.pb");
+  ASSERT_TRUE(store.GetCRL(good_crl, December2019()));
+  EXPECT_EQ(1u, store.size());
+
+  // The CRL is valid until July 2020.
+  EXPECT_FALSE(store.GetCRL(good_crl, CreateDate(2020, 8, 1)));
+  EXPECT_EQ(0u, store.size());
+}
+
+TEST_F(CastCRLStoreTest, EvictsOldestCrls) {
+  CastCRLStore store(&crl_trust_store_);
+  const std::string good_crl = ReadCrl("good_crl.pb");
+  std::shared_ptr<const CastCRL> crl = store.GetCRL(good_crl, December2019());
+  ASSERT_TRUE(crl);
+
+  const char* const kOtherCrls[] = {
+      "device_revoked_crl.pb", "issuer_revoked_crl.pb",
+      "device_serial_revoked_crl.pb", "issuer_serial_revoked_crl.pb"};
+  for (const char* file_name : kOtherCrls) {
+    ASSERT_TRUE(store.GetCRL(ReadCrl(file_name), December2019()));
+  }
+  EXPECT_EQ(CastCRLStore::kMaxEntries, store.size());
+
+  std::shared_ptr<const CastCRL> new_crl =
+      store.GetCRL(good_crl, December2019());
+  ASSERT_TRUE(new_crl);
+  EXPECT_NE(crl, new_crl);
+  EXPECT_EQ(CastCRLStore::kMaxEntries, store.size());
+}
+
 }  // namespace
 }  // namespace cast
 }  // namespace openscreen
@@ -0,0 +1,131 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/common/certificate/cert_verification_cache.h"
+
+#include <openssl/mem.h>
+#include <openssl/sha.h>
+
+#include "cast/common/certificate/cast_cert_validator_internal.h"
+#include "util/big_endian.h"
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+namespace {
+
+void HashLength(SHA256_CTX* context, size_t length) {
+  uint8_t length_bytes[sizeof(uint32_t)];
+  WriteBigEndian<uint32_t>(static_cast<uint32_t>(length), length_bytes);
+  SHA256_Update(context, length_bytes, sizeof(length_bytes));
+}
+
+// Hashes the length of |data| ahead of it, so that the boundaries between
+// certificates are part of the key.
+void HashBytes(SHA256_CTX* context, const void* data, size_t length) {
+  HashLength(context, length);
+  SHA256_Update(context, data, length);
+}
+
+}  // namespace
+
+// static
+constexpr size_t CertVerificationCache::kDefaultMaxEntries;
+
+CertVerificationCache::VerifiedChain::VerifiedChain() = default;
+CertVerificationCache::VerifiedChain::~VerifiedChain() = default;
+
+// static
+CertVerificationCache* CertVerificationCache::GetInstance() {
+  static CertVerificationCache* const cache = new CertVerificationCache();
+  return cache;
+}
+
+CertVerificationCache::CertVerificationCache(size_t max_entries)
+    : max_entries_(max_entries) {
+  OSP_DCHECK_GT(max_entries_, 0u);
+}
+
+CertVerificationCache::~CertVerificationCache() = default;
+
+// static
+std::string CertVerificationCache::MakeKey(
+    const std::vector<std::string>& der_certs,
+    const TrustStore& trust_store) {
+  SHA256_CTX context;
+  SHA256_Init(&context);
+  HashLength(&context, der_certs.size());
+  for (const std::string& der_cert : der_certs) {
+    HashBytes(&context, der_cert.data(), der_cert.size());
+  }
+
+  // The trust store is hashed by content rather than identity, so that any
+  // change to its anchors makes for new keys.
+  HashLength(&context, trust_store.certs.size());
+  for (const bssl::UniquePtr<X509>& cert : trust_store.certs) {
+    uint8_t* der = nullptr;
+    const int length = i2d_X509(cert.get(), &der);
+    if (length > 0) {
+      HashBytes(&context, der, length);
+    }
+    OPENSSL_free(der);
+  }
+
+  std::string key(SHA256_DIGEST_LENGTH, 0);
+  SHA256_Final(reinterpret_cast<uint8_t*>(&key[0]), &context);
+  return key;
+}
+
+std::shared_ptr<const CertVerificationCache::VerifiedChain>
+CertVerificationCache::Find(const std::string& key, const DateTime& time) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(key);
+  if (it == index_.end()) {
+    return nullptr;
+  }
+
+  const VerifiedChain& chain = *it->second->second;
+  if (time < chain.not_before || chain.not_after < time) {
+    entries_.erase(it->second);
+    index_.erase(it);
+    return nullptr;
+  }
+
+  entries_.splice(entries_.begin(), entries_, it->second);
+  return entries_.front().second;
+}
+
+void CertVerificationCache::Add(std::string key,
+                                std::shared_ptr<const VerifiedChain> chain) {
+  OSP_DCHECK(chain);
+  std::lock_guard<std::mutex> lock(mutex_);
+  auto it = index_.find(key);
+  if (it != index_.end()) {
+    it->second->second = std::move(chain);
+    entries_.splice(entries_.begin(), entries_, it->second);
+    return;
+  }
+
+  if (entries_.size() == max_entries_) {
+    index_.erase(entries_.back().first);
+    entries_.pop_back();
+  }
+  entries_.emplace_front(std::move(key), std::move(chain));
+  index_.emplace(entries_.front().first, entries_.begin());
+}
+
+void CertVerificationCache::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  index_.clear();
+  entries_.clear();
+}
+
+size_t CertVerificationCache::size() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+}  // namespace cast
+}  // namespace openscreen
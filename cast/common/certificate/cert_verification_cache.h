@@ -0,0 +1,104 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_COMMON_CERTIFICATE_CERT_VERIFICATION_CACHE_H_
+#define CAST_COMMON_CERTIFICATE_CERT_VERIFICATION_CACHE_H_
+
+#include <openssl/evp.h>
+#include <openssl/x509.h>
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "cast/common/certificate/cast_cert_validator.h"
+#include "cast/common/certificate/types.h"
+
+namespace openscreen {
+namespace cast {
+
+struct TrustStore;
+
+// Remembers device certificate chains that VerifyDeviceCert() has already
+// built and verified, so that a device presenting the same chain again (e.g.
+// when a sender reconnects to it) skips path building and the signature checks
+// along it.  Revocation is not cached: it is checked again against the CRL
+// given with each verification.
+//
+// Entries are keyed by the DER chain together with the trust store it was
+// verified against, are only used while every certificate in the chain is
+// valid, and the least recently used entry is evicted once |max_entries| is
+// reached.  It is safe to use from multiple threads.
+class CertVerificationCache {
+ public:
+  // The parts of a verified chain needed to produce VerifyDeviceCert()'s
+  // results.
+  struct VerifiedChain {
+    VerifiedChain();
+    ~VerifiedChain();
+
+    // The certificates of the chain, as built by FindCertificatePath(), for
+    // revocation checks.  |path| points into |certs|.
+    std::vector<bssl::UniquePtr<X509>> certs;
+    std::vector<X509*> path;
+
+    // From the device certificate.
+    bssl::UniquePtr<EVP_PKEY> public_key;
+    std::string common_name;
+
+    CastDeviceCertPolicy policy = CastDeviceCertPolicy::kUnrestricted;
+
+    // The period during which every certificate in the chain is valid.
+    DateTime not_before = {};
+    DateTime not_after = {};
+  };
+
+  static constexpr size_t kDefaultMaxEntries = 64;
+
+  // The cache used for sender-side device authentication.
+  static CertVerificationCache* GetInstance();
+
+  explicit CertVerificationCache(size_t max_entries = kDefaultMaxEntries);
+  CertVerificationCache(const CertVerificationCache&) = delete;
+  CertVerificationCache& operator=(const CertVerificationCache&) = delete;
+  ~CertVerificationCache();
+
+  // Returns the key for verifying |der_certs| against |trust_store|: a SHA-256
+  // hash of the chain and of the trust anchors.
+  static std::string MakeKey(const std::vector<std::string>& der_certs,
+                             const TrustStore& trust_store);
+
+  // Returns the chain cached under |key| if it is valid at |time|, or nullptr.
+  // Entries that have expired are dropped.
+  std::shared_ptr<const VerifiedChain> Find(const std::string& key,
+                                            const DateTime& time);
+
+  void Add(std::string key, std::shared_ptr<const VerifiedChain> chain);
+
+  void Clear();
+
+  size_t size() const;
+
+ private:
+  using Entry = std::pair<std::string, std::shared_ptr<const VerifiedChain>>;
+
+  const size_t max_entries_;
+
+  mutable std::mutex mutex_;
+
+  // Most recently used first.
+  std::list<Entry> entries_ GUARDED_BY(mutex_);
+  std::unordered_map<std::string, std::list<Entry>::iterator> index_
+      GUARDED_BY(mutex_);
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_COMMON_CERTIFICATE_CERT_VERIFICATION_CACHE_H_
@@ -0,0 +1,197 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/common/certificate/cert_verification_cache.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cast/common/certificate/cast_cert_validator_internal.h"
+#include "cast/common/certificate/cast_trust_store.h"
+#include "gtest/gtest.h"
+#include "platform/test/paths.h"
+#include "util/crypto/pem_helpers.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+DateTime CreateDate(int year, int month, int day) {
+  DateTime time = {};
+  time.year = year;
+  time.month = month;
+  time.day = day;
+  return time;
+}
+
+const std::string& GetSpecificTestDataPath() {
+  static std::string data_path =
+      GetTestDataPath() + "cast/common/certificate/certificates/";
+  return data_path;
+}
+
+std::vector<std::string> ReadCerts(const std::string& file_name) {
+  return ReadCertificatesFromPemFile(GetSpecificTestDataPath() + file_name);
+}
+
+// Returns a trust store holding the certificates in |file_name|.
+std::unique_ptr<TrustStore> ReadTrustStore(const std::string& file_name) {
+  auto trust_store = std::make_unique<TrustStore>();
+  for (const std::string& der_cert : ReadCerts(file_name)) {
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(der_cert.data());
+    trust_store->certs.emplace_back(d2i_X509(nullptr, &data, der_cert.size()));
+  }
+  return trust_store;
+}
+
+std::shared_ptr<const CertVerificationCache::VerifiedChain> MakeChain(
+    const std::string& common_name,
+    const DateTime& not_before,
+    const DateTime& not_after) {
+  auto chain = std::make_shared<CertVerificationCache::VerifiedChain>();
+  chain->common_name = common_name;
+  chain->not_before = not_before;
+  chain->not_after = not_after;
+  return chain;
+}
+
+const DateTime kNotBefore = CreateDate(2016, 1, 1);
+const DateTime kNow = CreateDate(2016, 4, 1);
+const DateTime kNotAfter = CreateDate(2017, 1, 1);
+
+}  // namespace
+
+TEST(CertVerificationCacheTest, KeysDependOnChainAndTrustStore) {
+  const std::vector<std::string> gen1 = ReadCerts("chromecast_gen1.pem");
+  const std::vector<std::string> gen2 = ReadCerts("chromecast_gen2.pem");
+  ASSERT_FALSE(gen1.empty());
+  ASSERT_FALSE(gen2.empty());
+  std::unique_ptr<TrustStore> root = ReadTrustStore("cast_root_ca.pem");
+  std::unique_ptr<TrustStore> test_root =
+      ReadTrustStore("cast_test_root_ca.pem");
+  ASSERT_EQ(1u, root->certs.size());
+  ASSERT_EQ(1u, test_root->certs.size());
+
+  const std::string key = CertVerificationCache::MakeKey(gen1, *root);
+  EXPECT_EQ(key, CertVerificationCache::MakeKey(gen1, *root));
+  EXPECT_EQ(key, CertVerificationCache::MakeKey(
+                     gen1, *ReadTrustStore("cast_root_ca.pem")));
+  EXPECT_NE(key, CertVerificationCache::MakeKey(gen2, *root));
+  EXPECT_NE(key, CertVerificationCache::MakeKey(gen1, *test_root));
+  EXPECT_NE(key, CertVerificationCache::MakeKey(
+                     std::vector<std::string>(gen1.begin(), gen1.end() - 1),
+                     *root));
+
+  // Moving bytes from one certificate to the next makes for a new key.
+  EXPECT_NE(CertVerificationCache::MakeKey({"ab", "c"}, *root),
+            CertVerificationCache::MakeKey({"a", "bc"}, *root));
+}
+
+TEST(CertVerificationCacheTest, FindsEntriesWhileTheChainIsValid) {
+  CertVerificationCache cache;
+  EXPECT_FALSE(cache.Find("key", kNow));
+
+  cache.Add("key", MakeChain("device", kNotBefore, kNotAfter));
+  EXPECT_EQ(1u, cache.size());
+  std::shared_ptr<const CertVerificationCache::VerifiedChain> chain =
+      cache.Find("key", kNow);
+  ASSERT_TRUE(chain);
+  EXPECT_EQ("device", chain->common_name);
+  EXPECT_FALSE(cache.Find("other key", kNow));
+
+  // Not yet valid.
+  EXPECT_FALSE(cache.Find("key", CreateDate(2015, 12, 31)));
+  EXPECT_EQ(0u, cache.size());
+
+  // Expired.
+  cache.Add("key", MakeChain("device", kNotBefore, kNotAfter));
+  EXPECT_FALSE(cache.Find("key", CreateDate(2017, 1, 2)));
+  EXPECT_EQ(0u, cache.size());
+}
+
+TEST(CertVerificationCacheTest, EvictsLeastRecentlyUsedEntries) {
+  CertVerificationCache cache(2);
+  cache.Add("a", MakeChain("a", kNotBefore, kNotAfter));
+  cache.Add("b", MakeChain("b", kNotBefore, kNotAfter));
+  ASSERT_TRUE(cache.Find("a", kNow));
+
+  cache.Add("c", MakeChain("c", kNotBefore, kNotAfter));
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_TRUE(cache.Find("a", kNow));
+  EXPECT_FALSE(cache.Find("b", kNow));
+  EXPECT_TRUE(cache.Find("c", kNow));
+
+  // Adding under an existing key replaces the entry.
+  cache.Add("a", MakeChain("new a", kNotBefore, kNotAfter));
+  EXPECT_EQ(2u, cache.size());
+  EXPECT_EQ("new a", cache.Find("a", kNow)->common_name);
+
+  cache.Clear();
+  EXPECT_EQ(0u, cache.size());
+  EXPECT_FALSE(cache.Find("a", kNow));
+}
+
+TEST(CertVerificationCacheTest, CachesVerifiedDeviceCerts) {
+  CertVerificationCache cache;
+  const std::vector<std::string> certs = ReadCerts("chromecast_audio.pem");
+
+  std::unique_ptr<CertVerificationContext> context;
+  CastDeviceCertPolicy policy = CastDeviceCertPolicy::kUnrestricted;
+  ASSERT_EQ(Error::Code::kNone,
+            VerifyDeviceCert(certs, kNow, &context, &policy, nullptr,
+                             CRLPolicy::kCrlOptional, nullptr, &cache)
+                .code());
+  EXPECT_EQ(CastDeviceCertPolicy::kAudioOnly, policy);
+  EXPECT_EQ("4ZZDZJ FA8FCA7EFE3C", context->GetCommonName());
+  ASSERT_EQ(1u, cache.size());
+
+  const std::string key = CertVerificationCache::MakeKey(
+      certs, *CastTrustStore::GetInstance()->trust_store());
+  std::shared_ptr<const CertVerificationCache::VerifiedChain> chain =
+      cache.Find(key, kNow);
+  ASSERT_TRUE(chain);
+  EXPECT_EQ(CastDeviceCertPolicy::kAudioOnly, chain->policy);
+  EXPECT_EQ("4ZZDZJ FA8FCA7EFE3C", chain->common_name);
+
+  // The second verification comes from the cache, as shown by replacing the
+  // cached entry.
+  cache.Add(key, MakeChain("cached", chain->not_before, chain->not_after));
+  context.reset();
+  ASSERT_EQ(Error::Code::kNone,
+            VerifyDeviceCert(certs, kNow, &context, &policy, nullptr,
+                             CRLPolicy::kCrlOptional, nullptr, &cache)
+                .code());
+  EXPECT_EQ(CastDeviceCertPolicy::kUnrestricted, policy);
+  EXPECT_EQ("cached", context->GetCommonName());
+}
+
+TEST(CertVerificationCacheTest, DoesNotCacheFailures) {
+  CertVerificationCache cache;
+  std::unique_ptr<CertVerificationContext> context;
+  CastDeviceCertPolicy policy;
+  EXPECT_EQ(Error::Code::kErrCertsVerifyUntrustedCert,
+            VerifyDeviceCert(ReadCerts("unchained.pem"), kNow, &context,
+                             &policy, nullptr, CRLPolicy::kCrlOptional,
+                             nullptr, &cache)
+                .code());
+  EXPECT_EQ(0u, cache.size());
+
+  // A cached chain is not used once it has expired.
+  const std::vector<std::string> certs = ReadCerts("chromecast_gen2.pem");
+  ASSERT_EQ(Error::Code::kNone,
+            VerifyDeviceCert(certs, kNow, &context, &policy, nullptr,
+                             CRLPolicy::kCrlOptional, nullptr, &cache)
+                .code());
+  EXPECT_EQ(1u, cache.size());
+  EXPECT_EQ(Error::Code::kErrCertsDateInvalid,
+            VerifyDeviceCert(certs, CreateDate(2037, 3, 1), &context, &policy,
+                             nullptr, CRLPolicy::kCrlOptional, nullptr, &cache)
+                .code());
+  EXPECT_EQ(0u, cache.size());
+}
+
+}  // namespace cast
+}  // namespace openscreen
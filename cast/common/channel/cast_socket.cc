@@ -6,6 +6,7 @@
 
 #include "cast/common/channel/message_framer.h"
 #include "cast/common/channel/proto/cast_channel.pb.h"
+#include "platform/api/task_runner.h"
 #include "util/osp_logging.h"
 
 namespace openscreen {
@@ -14,6 +15,20 @@ namespace cast {
 using ::cast::channel::CastMessage;
 using message_serialization::DeserializeResult;
 
+namespace {
+
+// The most application data that fits in a single TLS record.
+constexpr size_t kMaxCoalescedBytes = 16384;
+
+// While the TLS connection is write-blocked, coalesced messages are kept and
+// retried this often.  Send() fails the socket once more than
+// |kMaxPendingWriteBytes| pile up.
+constexpr Clock::duration kWriteBlockedRetryDelay =
+    std::chrono::milliseconds(10);
+constexpr size_t kMaxPendingWriteBytes = 1 << 20;
+
+}  // namespace
+
 CastSocket::CastSocket(std::unique_ptr<TlsConnection> connection,
                        Client* client)
     : connection_(std::move(connection)),
@@ -24,6 +39,12 @@ CastSocket::CastSocket(std::unique_ptr<TlsConnection> connection,
 }
 
 CastSocket::~CastSocket() {
+  if (state_ == State::kOpen && !write_buffer_.empty() &&
+      !connection_->Send(write_buffer_.data(), write_buffer_.size())) {
+    OSP_LOG_WARN << "Dropped " << write_buffer_.size()
+                 << " bytes of coalesced messages: TLS connection is "
+                    "write-blocked";
+  }
   connection_->SetClient(nullptr);
 }
 
@@ -32,18 +53,44 @@ Error CastSocket::Send(const CastMessage& message) {
     return Error::Code::kSocketClosedFailure;
   }
 
-  const ErrorOr<std::vector<uint8_t>> out =
-      message_serialization::Serialize(message);
-  if (!out) {
-    return out.error();
+  Error error = message_serialization::SerializeTo(message, &write_buffer_);
+  if (!error.ok()) {
+    return error;
+  }
+
+  if (!write_task_runner_) {
+    const bool sent =
+        connection_->Send(write_buffer_.data(), write_buffer_.size());
+    write_buffer_.clear();
+    return sent ? Error::Code::kNone : Error::Code::kAgain;
+  }
+
+  if (write_buffer_.size() < kMaxCoalescedBytes) {
+    ScheduleFlush(max_write_delay_);
+    return Error::Code::kNone;
   }
 
-  if (!connection_->Send(out.value().data(), out.value().size())) {
-    return Error::Code::kAgain;
+  FlushWrites();
+  // The messages kept while write-blocked were already reported as sent, so
+  // once too many pile up, fail the socket rather than silently drop some.
+  if (write_buffer_.size() > kMaxPendingWriteBytes) {
+    state_ = State::kError;
+    write_buffer_.clear();
+    return Error(Error::Code::kSocketSendFailure,
+                 "TLS connection stayed write-blocked");
   }
   return Error::Code::kNone;
 }
 
+void CastSocket::SetWriteCoalescing(TaskRunner* task_runner,
+                                    Clock::duration max_delay) {
+  if (!task_runner) {
+    FlushWrites();
+  }
+  write_task_runner_ = task_runner;
+  max_write_delay_ = max_delay;
+}
+
 void CastSocket::SetClient(Client* client) {
   OSP_DCHECK(client);
   client_ = client;
@@ -67,24 +114,80 @@ std::array<uint8_t, 2> CastSocket::GetSanitizedIpAddress() {
 
 void CastSocket::OnError(TlsConnection* connection, Error error) {
   state_ = State::kError;
+  write_buffer_.clear();
   client_->OnError(this, error);
 }
 
 void CastSocket::OnRead(TlsConnection* connection, std::vector<uint8_t> block) {
-  read_buffer_.insert(read_buffer_.end(), block.begin(), block.end());
-  // NOTE: Read as many messages as possible out of |read_buffer_| since we only
-  // get one callback opportunity for this.
-  do {
+  // When no partial message is pending, which is the common case, messages are
+  // parsed straight out of |block|. Otherwise, |block| continues the bytes held
+  // in |read_buffer_|.
+  const bool read_from_block = read_buffer_.empty();
+  if (!read_from_block) {
+    read_buffer_.insert(read_buffer_.end(), block.begin(), block.end());
+  }
+  const absl::Span<const uint8_t> input =
+      read_from_block ? absl::MakeConstSpan(block)
+                      : absl::MakeConstSpan(read_buffer_);
+
+  // NOTE: Read as many messages as possible out of |input| since we only get
+  // one callback opportunity for this.
+  const WeakPtr<CastSocket> weak_this = GetWeakPtr();
+  size_t consumed = 0;
+  while (consumed < input.size()) {
     ErrorOr<DeserializeResult> message_or_error =
-        message_serialization::TryDeserialize(
-            absl::Span<uint8_t>(&read_buffer_[0], read_buffer_.size()));
+        message_serialization::TryDeserialize(input.subspan(consumed));
     if (!message_or_error) {
-      return;
+      break;
     }
-    read_buffer_.erase(read_buffer_.begin(),
-                       read_buffer_.begin() + message_or_error.value().length);
+    consumed += message_or_error.value().length;
     client_->OnMessage(this, std::move(message_or_error.value().message));
-  } while (!read_buffer_.empty());
+    // The client may have destroyed this socket in response to the message.
+    if (!weak_this) {
+      return;
+    }
+  }
+
+  // Keep whatever is left of a partial message, moving it at most once per
+  // block instead of once per message.
+  if (read_from_block) {
+    read_buffer_.assign(block.begin() + consumed, block.end());
+  } else {
+    read_buffer_.erase(read_buffer_.begin(), read_buffer_.begin() + consumed);
+  }
+  connection_->ReturnReadBlock(std::move(block));
+}
+
+void CastSocket::ScheduleFlush(Clock::duration delay) {
+  if (flush_scheduled_) {
+    return;
+  }
+  flush_scheduled_ = true;
+  auto flush = [weak_this = GetWeakPtr()] {
+    if (CastSocket* self = weak_this.get()) {
+      self->flush_scheduled_ = false;
+      self->FlushWrites();
+    }
+  };
+  if (delay > Clock::duration::zero()) {
+    write_task_runner_->PostTaskWithDelay(std::move(flush), delay);
+  } else {
+    write_task_runner_->PostTask(std::move(flush));
+  }
+}
+
+void CastSocket::FlushWrites() {
+  if (write_buffer_.empty() ||
+      connection_->Send(write_buffer_.data(), write_buffer_.size())) {
+    write_buffer_.clear();
+    return;
+  }
+
+  // Send() already reported these messages as sent, so keep them for a retry
+  // instead of dropping them.
+  if (write_task_runner_) {
+    ScheduleFlush(kWriteBlockedRetryDelay);
+  }
 }
 
 int CastSocket::g_next_socket_id_ = 1;
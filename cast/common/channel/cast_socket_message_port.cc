@@ -58,6 +58,25 @@ void CastSocketMessagePort::PostMessage(
     const std::string& destination_sender_id,
     const std::string& message_namespace,
     const std::string& message) {
+  SendMessage(destination_sender_id,
+              MakeSimpleUTF8Message(message_namespace, message));
+}
+
+bool CastSocketMessagePort::SupportsBinaryMessages() const {
+  return true;
+}
+
+void CastSocketMessagePort::PostBinaryMessage(
+    const std::string& destination_sender_id,
+    const std::string& message_namespace,
+    absl::Span<const uint8_t> payload) {
+  SendMessage(destination_sender_id,
+              MakeSimpleBinaryMessage(message_namespace, payload));
+}
+
+void CastSocketMessagePort::SendMessage(
+    const std::string& destination_sender_id,
+    ::cast::channel::CastMessage message) {
   if (!client_) {
     OSP_DLOG_WARN << "Not posting message due to nullptr client_";
     return;
@@ -74,8 +93,8 @@ void CastSocketMessagePort::PostMessage(
     router_->AddConnection(connection, VirtualConnection::AssociatedData{});
   }
 
-  const Error send_error = router_->Send(
-      std::move(connection), MakeSimpleUTF8Message(message_namespace, message));
+  const Error send_error =
+      router_->Send(std::move(connection), std::move(message));
   if (!send_error.ok()) {
     client_->OnError(std::move(send_error));
   }
@@ -99,6 +118,16 @@ void CastSocketMessagePort::OnMessage(VirtualConnectionRouter* router,
     return;
   }
 
+  if (message.payload_type() ==
+      ::cast::channel::CastMessage_PayloadType_BINARY) {
+    const std::string& payload = message.payload_binary();
+    client_->OnBinaryMessage(
+        message.source_id(), message.namespace_(),
+        absl::Span<const uint8_t>(
+            reinterpret_cast<const uint8_t*>(payload.data()), payload.size()));
+    return;
+  }
+
   client_->OnMessage(message.source_id(), message.namespace_(),
                      message.payload_utf8());
 }
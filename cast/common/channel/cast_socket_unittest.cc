@@ -4,11 +4,15 @@
 
 #include "cast/common/public/cast_socket.h"
 
+#include <algorithm>
+
 #include "cast/common/channel/message_framer.h"
 #include "cast/common/channel/proto/cast_channel.pb.h"
 #include "cast/common/channel/testing/fake_cast_socket.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "platform/test/fake_clock.h"
+#include "platform/test/fake_task_runner.h"
 
 namespace openscreen {
 namespace cast {
@@ -41,6 +45,8 @@ class CastSocketTest : public ::testing::Test {
   MockCastSocketClient& mock_client() { return fake_socket_.mock_client; }
   CastSocket& socket() { return fake_socket_.socket; }
 
+  FakeClock clock_{Clock::time_point() + std::chrono::hours(1)};
+  FakeTaskRunner task_runner_{&clock_};
   FakeCastSocket fake_socket_;
   CastMessage message_;
   std::vector<uint8_t> frame_serial_;
@@ -79,6 +85,119 @@ TEST_F(CastSocketTest, SendMessageEventuallyBlocks) {
   ASSERT_EQ(socket().Send(message_).code(), Error::Code::kAgain);
 }
 
+TEST_F(CastSocketTest, CoalescesWritesWithinOneTask) {
+  socket().SetWriteCoalescing(&task_runner_);
+  EXPECT_CALL(connection(), Send(_, _)).Times(0);
+  ASSERT_TRUE(socket().Send(message_).ok());
+  ASSERT_TRUE(socket().Send(message_).ok());
+  ASSERT_TRUE(socket().Send(message_).ok());
+  testing::Mock::VerifyAndClearExpectations(&connection());
+
+  std::vector<uint8_t> expected;
+  for (int i = 0; i < 3; ++i) {
+    expected.insert(expected.end(), frame_serial_.begin(), frame_serial_.end());
+  }
+  EXPECT_CALL(connection(), Send(_, _))
+      .WillOnce(Invoke([&expected](const void* data, size_t len) {
+        EXPECT_EQ(
+            expected,
+            std::vector<uint8_t>(reinterpret_cast<const uint8_t*>(data),
+                                 reinterpret_cast<const uint8_t*>(data) + len));
+        return true;
+      }));
+  task_runner_.RunTasksUntilIdle();
+  testing::Mock::VerifyAndClearExpectations(&connection());
+
+  // The next message starts a new batch.
+  EXPECT_CALL(connection(), Send(_, frame_serial_.size()))
+      .WillOnce(Return(true));
+  ASSERT_TRUE(socket().Send(message_).ok());
+  task_runner_.RunTasksUntilIdle();
+}
+
+TEST_F(CastSocketTest, CoalescedWritesWaitForMaxDelay) {
+  socket().SetWriteCoalescing(&task_runner_, std::chrono::milliseconds(10));
+  EXPECT_CALL(connection(), Send(_, _)).Times(0);
+  ASSERT_TRUE(socket().Send(message_).ok());
+  task_runner_.RunTasksUntilIdle();
+  clock_.Advance(std::chrono::milliseconds(5));
+  ASSERT_TRUE(socket().Send(message_).ok());
+  testing::Mock::VerifyAndClearExpectations(&connection());
+
+  EXPECT_CALL(connection(), Send(_, 2 * frame_serial_.size()))
+      .WillOnce(Return(true));
+  clock_.Advance(std::chrono::milliseconds(5));
+}
+
+TEST_F(CastSocketTest, CoalescedWritesFlushWhenFull) {
+  socket().SetWriteCoalescing(&task_runner_, std::chrono::seconds(1));
+  message_.set_payload_utf8(std::string(10000, 'x'));
+  EXPECT_CALL(connection(), Send(_, _)).Times(0);
+  ASSERT_TRUE(socket().Send(message_).ok());
+  testing::Mock::VerifyAndClearExpectations(&connection());
+
+  // The second message takes the buffer past one TLS record.
+  EXPECT_CALL(connection(), Send(_, _)).WillOnce(Return(true));
+  ASSERT_TRUE(socket().Send(message_).ok());
+  testing::Mock::VerifyAndClearExpectations(&connection());
+
+  // Nothing is left for the delayed flush to write.
+  EXPECT_CALL(connection(), Send(_, _)).Times(0);
+  clock_.Advance(std::chrono::seconds(1));
+}
+
+TEST_F(CastSocketTest, DisablingWriteCoalescingFlushes) {
+  socket().SetWriteCoalescing(&task_runner_);
+  ASSERT_TRUE(socket().Send(message_).ok());
+
+  EXPECT_CALL(connection(), Send(_, frame_serial_.size()))
+      .WillOnce(Return(true));
+  socket().SetWriteCoalescing(nullptr);
+  testing::Mock::VerifyAndClearExpectations(&connection());
+
+  // Back to writing immediately, and reporting a blocked connection.
+  EXPECT_CALL(connection(), Send(_, _)).WillOnce(Return(false));
+  EXPECT_EQ(Error::Code::kAgain, socket().Send(message_).code());
+  task_runner_.RunTasksUntilIdle();
+}
+
+TEST_F(CastSocketTest, RetriesCoalescedWritesWhileWriteBlocked) {
+  socket().SetWriteCoalescing(&task_runner_);
+  ASSERT_TRUE(socket().Send(message_).ok());
+
+  EXPECT_CALL(connection(), Send(_, frame_serial_.size()))
+      .WillOnce(Return(false));
+  task_runner_.RunTasksUntilIdle();
+  testing::Mock::VerifyAndClearExpectations(&connection());
+
+  // The blocked message is kept, and goes out with the next one.
+  ASSERT_TRUE(socket().Send(message_).ok());
+  EXPECT_CALL(connection(), Send(_, 2 * frame_serial_.size()))
+      .WillOnce(Return(true));
+  clock_.Advance(std::chrono::milliseconds(10));
+  testing::Mock::VerifyAndClearExpectations(&connection());
+
+  EXPECT_CALL(connection(), Send(_, _)).Times(0);
+  clock_.Advance(std::chrono::seconds(1));
+}
+
+TEST_F(CastSocketTest, FailsWhenCoalescedWritesStayBlocked) {
+  socket().SetWriteCoalescing(&task_runner_);
+  message_.set_payload_utf8(std::string(60000, 'x'));
+  EXPECT_CALL(connection(), Send(_, _)).WillRepeatedly(Return(false));
+
+  Error error = Error::None();
+  int sent = 0;
+  while (error.ok() && sent < 100) {
+    error = socket().Send(message_);
+    ++sent;
+  }
+  EXPECT_EQ(Error::Code::kSocketSendFailure, error.code());
+  EXPECT_GT(sent, 16);
+  EXPECT_EQ(Error::Code::kSocketClosedFailure, socket().Send(message_).code());
+  task_runner_.RunTasksUntilIdle();
+}
+
 TEST_F(CastSocketTest, ReadCompleteMessage) {
   const uint8_t* data = frame_serial_.data();
   EXPECT_CALL(mock_client(), OnMessage(_, _))
@@ -149,6 +268,33 @@ TEST_F(CastSocketTest, ReadMultipleMessagesPerBlock) {
   connection().OnRead(std::move(send_data));
 }
 
+TEST_F(CastSocketTest, ReadMessagesSplitAcrossManyBlocks) {
+  std::vector<uint8_t> send_data = frame_serial_;
+  send_data.insert(send_data.end(), frame_serial_.begin(), frame_serial_.end());
+  EXPECT_CALL(mock_client(), OnMessage(_, _))
+      .Times(2)
+      .WillRepeatedly(Invoke([this](CastSocket* socket, CastMessage message) {
+        EXPECT_EQ(message_.SerializeAsString(), message.SerializeAsString());
+      }));
+  // Blocks of 3 bytes straddle both the header and the boundary between the
+  // two messages.
+  for (size_t i = 0; i < send_data.size(); i += 3) {
+    const size_t end = std::min(i + 3, send_data.size());
+    connection().OnRead(std::vector<uint8_t>(send_data.begin() + i,
+                                             send_data.begin() + end));
+  }
+}
+
+TEST_F(CastSocketTest, ReturnsReadBlocksToConnection) {
+  EXPECT_CALL(mock_client(), OnMessage(_, _)).Times(1);
+  const uint8_t* data = frame_serial_.data();
+  connection().OnRead(std::vector<uint8_t>(data, data + 10));
+  EXPECT_EQ(1, connection().returned_read_blocks());
+  connection().OnRead(
+      std::vector<uint8_t>(data + 10, data + frame_serial_.size()));
+  EXPECT_EQ(2, connection().returned_read_blocks());
+}
+
 TEST_F(CastSocketTest, SanitizedAddress) {
   std::array<uint8_t, 2> result1 = socket().GetSanitizedIpAddress();
   EXPECT_EQ(result1[0], 1u);
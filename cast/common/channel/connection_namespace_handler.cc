@@ -6,7 +6,6 @@
 
 #include <algorithm>
 #include <string>
-#include <type_traits>
 #include <utility>
 
 #include "absl/types/optional.h"
@@ -15,8 +14,8 @@
 #include "cast/common/channel/virtual_connection.h"
 #include "cast/common/channel/virtual_connection_router.h"
 #include "cast/common/public/cast_socket.h"
-#include "util/json/json_serialization.h"
-#include "util/json/json_value.h"
+#include "util/json/json_document.h"
+#include "util/json/json_writer.h"
 #include "util/osp_logging.h"
 
 namespace openscreen {
@@ -31,26 +30,23 @@ bool IsValidProtocolVersion(int version) {
   return ::cast::channel::CastMessage_ProtocolVersion_IsValid(version);
 }
 
-absl::optional<int> FindMaxProtocolVersion(const Json::Value* version,
-                                           const Json::Value* version_list) {
-  using ArrayIndex = Json::Value::ArrayIndex;
-  static_assert(std::is_integral<ArrayIndex>::value,
-                "Assuming ArrayIndex is integral");
+absl::optional<int> FindMaxProtocolVersion(
+    const json::JsonValue* version,
+    const json::JsonValue* version_list) {
   absl::optional<int> max_version;
-  if (version_list && version_list->isArray()) {
+  if (version_list && version_list->is_array()) {
     max_version = ::cast::channel::CastMessage_ProtocolVersion_CASTV2_1_0;
-    for (auto it = version_list->begin(), end = version_list->end(); it != end;
-         ++it) {
-      if (it->isInt()) {
-        int version_int = it->asInt();
+    for (const json::JsonValue& element : version_list->elements()) {
+      if (element.is_int()) {
+        int version_int = element.as_int();
         if (IsValidProtocolVersion(version_int) && version_int > *max_version) {
           max_version = version_int;
         }
       }
     }
   }
-  if (version && version->isInt()) {
-    int version_int = version->asInt();
+  if (version && version->is_int()) {
+    int version_int = version->as_int();
     if (IsValidProtocolVersion(version_int)) {
       if (!max_version) {
         max_version = ::cast::channel::CastMessage_ProtocolVersion_CASTV2_1_0;
@@ -63,12 +59,33 @@ absl::optional<int> FindMaxProtocolVersion(const Json::Value* version,
   return max_version;
 }
 
+absl::optional<int> MaybeGetInt(const json::JsonValue& message,
+                                absl::string_view key) {
+  const json::JsonValue* value = message.Find(key);
+  absl::optional<int> result;
+  if (value && value->is_int()) {
+    result = value->as_int();
+  }
+  return result;
+}
+
+absl::optional<absl::string_view> MaybeGetString(
+    const json::JsonValue& message,
+    absl::string_view key) {
+  const json::JsonValue* value = message.Find(key);
+  absl::optional<absl::string_view> result;
+  if (value && value->is_string()) {
+    result = value->as_string();
+  }
+  return result;
+}
+
 VirtualConnection::CloseReason GetCloseReason(
-    const Json::Value& parsed_message) {
+    const json::JsonValue& parsed_message) {
   VirtualConnection::CloseReason reason =
       VirtualConnection::CloseReason::kClosedByPeer;
-  absl::optional<int> reason_code = MaybeGetInt(
-      parsed_message, JSON_EXPAND_FIND_CONSTANT_ARGS(kMessageKeyReasonCode));
+  absl::optional<int> reason_code =
+      MaybeGetInt(parsed_message, kMessageKeyReasonCode);
   if (reason_code) {
     int code = reason_code.value();
     if (code >= VirtualConnection::CloseReason::kFirstReason &&
@@ -123,18 +140,20 @@ void ConnectionNamespaceHandler::OnMessage(VirtualConnectionRouter* router,
     return;
   }
 
-  ErrorOr<Json::Value> result = json::Parse(message.payload_utf8());
-  if (result.is_error()) {
+  // The parsed document refers to the payload, so take it out of |message|
+  // before that is handed on below.
+  const std::string payload = std::move(*message.mutable_payload_utf8());
+  if (!document_.Parse(payload).ok()) {
     return;
   }
 
-  Json::Value& value = result.value();
-  if (!value.isObject()) {
+  const json::JsonValue& value = document_.root();
+  if (!value.is_object()) {
     return;
   }
 
   absl::optional<absl::string_view> type =
-      MaybeGetString(value, JSON_EXPAND_FIND_CONSTANT_ARGS(kMessageKeyType));
+      MaybeGetString(value, kMessageKeyType);
   if (!type) {
     // TODO(btolsch): Some of these paths should have error reporting.  One
     // possibility is to pass errors back through |router| so higher-level code
@@ -145,20 +164,21 @@ void ConnectionNamespaceHandler::OnMessage(VirtualConnectionRouter* router,
 
   absl::string_view type_str = type.value();
   if (type_str == kMessageTypeConnect) {
-    HandleConnect(socket, std::move(message), std::move(value));
+    HandleConnect(socket, std::move(message), value);
   } else if (type_str == kMessageTypeClose) {
-    HandleClose(socket, std::move(message), std::move(value));
+    HandleClose(socket, std::move(message), value);
   } else if (type_str == kMessageTypeConnected) {
-    HandleConnectedResponse(socket, std::move(message), std::move(value));
+    HandleConnectedResponse(socket, std::move(message), value);
   } else {
     // NOTE: Unknown message type so ignore it.
     // TODO(btolsch): Should be included in future error reporting.
   }
 }
 
-void ConnectionNamespaceHandler::HandleConnect(CastSocket* socket,
-                                               CastMessage message,
-                                               Json::Value parsed_message) {
+void ConnectionNamespaceHandler::HandleConnect(
+    CastSocket* socket,
+    CastMessage message,
+    const json::JsonValue& parsed_message) {
   if (message.destination_id() == kBroadcastId ||
       message.source_id() == kBroadcastId) {
     return;
@@ -172,8 +192,8 @@ void ConnectionNamespaceHandler::HandleConnect(CastSocket* socket,
     return;
   }
 
-  absl::optional<int> maybe_conn_type = MaybeGetInt(
-      parsed_message, JSON_EXPAND_FIND_CONSTANT_ARGS(kMessageKeyConnType));
+  absl::optional<int> maybe_conn_type =
+      MaybeGetInt(parsed_message, kMessageKeyConnType);
   VirtualConnection::Type conn_type = VirtualConnection::Type::kStrong;
   if (maybe_conn_type) {
     int int_type = maybe_conn_type.value();
@@ -189,23 +209,23 @@ void ConnectionNamespaceHandler::HandleConnect(CastSocket* socket,
 
   data.type = conn_type;
 
-  absl::optional<absl::string_view> user_agent = MaybeGetString(
-      parsed_message, JSON_EXPAND_FIND_CONSTANT_ARGS(kMessageKeyUserAgent));
+  absl::optional<absl::string_view> user_agent =
+      MaybeGetString(parsed_message, kMessageKeyUserAgent);
   if (user_agent) {
     data.user_agent = std::string(user_agent.value());
   }
 
-  const Json::Value* sender_info_value = parsed_message.find(
-      JSON_EXPAND_FIND_CONSTANT_ARGS(kMessageKeySenderInfo));
-  if (!sender_info_value || !sender_info_value->isObject()) {
+  const json::JsonValue* sender_info_value =
+      parsed_message.Find(kMessageKeySenderInfo);
+  if (!sender_info_value || !sender_info_value->is_object()) {
     // TODO(btolsch): Should this be guessed from user agent?
     OSP_DVLOG << "No sender info from protocol.";
   }
 
-  const Json::Value* version_value = parsed_message.find(
-      JSON_EXPAND_FIND_CONSTANT_ARGS(kMessageKeyProtocolVersion));
-  const Json::Value* version_list_value = parsed_message.find(
-      JSON_EXPAND_FIND_CONSTANT_ARGS(kMessageKeyProtocolVersionList));
+  const json::JsonValue* version_value =
+      parsed_message.Find(kMessageKeyProtocolVersion);
+  const json::JsonValue* version_list_value =
+      parsed_message.Find(kMessageKeyProtocolVersionList);
   absl::optional<int> negotiated_version =
       FindMaxProtocolVersion(version_value, version_list_value);
   if (negotiated_version) {
@@ -234,9 +254,10 @@ void ConnectionNamespaceHandler::HandleConnect(CastSocket* socket,
   vc_router_->AddConnection(std::move(virtual_conn), std::move(data));
 }
 
-void ConnectionNamespaceHandler::HandleClose(CastSocket* socket,
-                                             CastMessage message,
-                                             Json::Value parsed_message) {
+void ConnectionNamespaceHandler::HandleClose(
+    CastSocket* socket,
+    CastMessage message,
+    const json::JsonValue& parsed_message) {
   const VirtualConnection conn{std::move(*message.mutable_destination_id()),
                                std::move(*message.mutable_source_id()),
                                ToCastSocketId(socket)};
@@ -251,7 +272,7 @@ void ConnectionNamespaceHandler::HandleClose(CastSocket* socket,
 void ConnectionNamespaceHandler::HandleConnectedResponse(
     CastSocket* socket,
     CastMessage message,
-    Json::Value parsed_message) {
+    const json::JsonValue& parsed_message) {
   const VirtualConnection conn{std::move(message.destination_id()),
                                std::move(message.source_id()),
                                ToCastSocketId(socket)};
@@ -288,19 +309,17 @@ void ConnectionNamespaceHandler::SendClose(VirtualConnection virtual_conn) {
 void ConnectionNamespaceHandler::SendConnectedResponse(
     const VirtualConnection& virtual_conn,
     int max_protocol_version) {
-  Json::Value connected_message(Json::ValueType::objectValue);
-  connected_message[kMessageKeyType] = kMessageTypeConnected;
-  connected_message[kMessageKeyProtocolVersion] =
-      static_cast<int>(max_protocol_version);
-
-  ErrorOr<std::string> result = json::Stringify(connected_message);
-  if (result.is_error()) {
-    return;
-  }
-
-  vc_router_->Send(
-      virtual_conn,
-      MakeSimpleUTF8Message(kConnectionNamespace, std::move(result.value())));
+  std::string payload;
+  json::JsonWriter writer(&payload);
+  writer.BeginObject();
+  writer.Key(kMessageKeyType);
+  writer.String(kMessageTypeConnected);
+  writer.Key(kMessageKeyProtocolVersion);
+  writer.Int(max_protocol_version);
+  writer.EndObject();
+
+  vc_router_->Send(virtual_conn, MakeSimpleUTF8Message(kConnectionNamespace,
+                                                       std::move(payload)));
 }
 
 bool ConnectionNamespaceHandler::RemoveConnection(
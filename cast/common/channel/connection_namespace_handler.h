@@ -11,7 +11,7 @@
 #include "cast/common/channel/cast_message_handler.h"
 #include "cast/common/channel/proto/cast_channel.pb.h"
 #include "cast/common/channel/virtual_connection.h"
-#include "util/json/json_serialization.h"
+#include "util/json/json_document.h"
 
 namespace openscreen {
 namespace cast {
@@ -67,13 +67,13 @@ class ConnectionNamespaceHandler : public CastMessageHandler {
  private:
   void HandleConnect(CastSocket* socket,
                      ::cast::channel::CastMessage message,
-                     Json::Value parsed_message);
+                     const json::JsonValue& parsed_message);
   void HandleClose(CastSocket* socket,
                    ::cast::channel::CastMessage message,
-                   Json::Value parsed_message);
+                   const json::JsonValue& parsed_message);
   void HandleConnectedResponse(CastSocket* socket,
                                ::cast::channel::CastMessage message,
-                               Json::Value parsed_message);
+                               const json::JsonValue& parsed_message);
 
   void SendConnect(VirtualConnection virtual_conn);
   void SendClose(VirtualConnection virtual_conn);
@@ -91,6 +91,10 @@ class ConnectionNamespaceHandler : public CastMessageHandler {
     RemoteConnectionResultCallback result_callback;
   };
   std::vector<PendingRequest> pending_remote_requests_;
+
+  // Reused to parse each incoming message, so its storage is only allocated
+  // once.
+  json::JsonDocument document_;
 };
 
 }  // namespace cast
@@ -0,0 +1,60 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/common/channel/id_interner.h"
+
+#include <utility>
+
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+// static
+constexpr IdInterner::Handle IdInterner::kInvalidHandle;
+
+IdInterner::IdInterner() = default;
+IdInterner::~IdInterner() = default;
+
+IdInterner::Handle IdInterner::Intern(const std::string& id) {
+  auto it = handles_.find(id);
+  if (it != handles_.end()) {
+    ++entries_[it->second - 1].ref_count;
+    return it->second;
+  }
+
+  Handle handle;
+  if (free_handles_.empty()) {
+    entries_.emplace_back();
+    handle = static_cast<Handle>(entries_.size());
+  } else {
+    handle = free_handles_.back();
+    free_handles_.pop_back();
+  }
+  Entry& entry = entries_[handle - 1];
+  entry.id = id;
+  entry.ref_count = 1;
+  handles_.emplace(id, handle);
+  return handle;
+}
+
+void IdInterner::Release(Handle handle) {
+  OSP_DCHECK_NE(handle, kInvalidHandle);
+  OSP_DCHECK_LE(handle, entries_.size());
+  Entry& entry = entries_[handle - 1];
+  OSP_DCHECK_GT(entry.ref_count, 0);
+  if (--entry.ref_count == 0) {
+    handles_.erase(entry.id);
+    entry.id.clear();
+    free_handles_.push_back(handle);
+  }
+}
+
+IdInterner::Handle IdInterner::Find(const std::string& id) const {
+  auto it = handles_.find(id);
+  return it == handles_.end() ? kInvalidHandle : it->second;
+}
+
+}  // namespace cast
+}  // namespace openscreen
@@ -0,0 +1,67 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_COMMON_CHANNEL_ID_INTERNER_H_
+#define CAST_COMMON_CHANNEL_ID_INTERNER_H_
+
+#include <stdint.h>
+
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace openscreen {
+namespace cast {
+
+// Maps the strings used to identify Cast endpoints (sender and receiver IDs)
+// to small integer handles, so that routing tables can be keyed by integers
+// that hash and compare in constant time.  Each string is hashed once, when it
+// is looked up, rather than once per table it is used in.
+//
+// Handles are reference counted: every Intern() must be balanced by a
+// Release(), after which the handle may be reused for another string.
+class IdInterner {
+ public:
+  using Handle = uint32_t;
+
+  // Never returned by Intern().
+  static constexpr Handle kInvalidHandle = 0;
+
+  IdInterner();
+  IdInterner(const IdInterner&) = delete;
+  IdInterner& operator=(const IdInterner&) = delete;
+  ~IdInterner();
+
+  // Returns the handle for |id|, adding it if it isn't already interned, and
+  // takes a reference on it.
+  Handle Intern(const std::string& id);
+
+  // Drops a reference taken by Intern().
+  void Release(Handle handle);
+
+  // Returns the handle for |id| without taking a reference, or kInvalidHandle
+  // if it isn't interned.  Looking up an ID that is not interned can't match
+  // any entry in a table keyed by handles, so callers can stop there.
+  Handle Find(const std::string& id) const;
+
+  size_t size() const { return handles_.size(); }
+
+ private:
+  struct Entry {
+    std::string id;
+    int ref_count = 0;
+  };
+
+  std::unordered_map<std::string, Handle> handles_;
+
+  // Indexed by handle - 1.  Entries for released handles have a zero
+  // |ref_count| and are listed in |free_handles_|.
+  std::vector<Entry> entries_;
+  std::vector<Handle> free_handles_;
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_COMMON_CHANNEL_ID_INTERNER_H_
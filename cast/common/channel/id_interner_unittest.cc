@@ -0,0 +1,54 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/common/channel/id_interner.h"
+
+#include "gtest/gtest.h"
+
+namespace openscreen {
+namespace cast {
+
+TEST(IdInternerTest, InternsEachStringOnce) {
+  IdInterner interner;
+  const IdInterner::Handle sender = interner.Intern("sender-0");
+  const IdInterner::Handle receiver = interner.Intern("receiver-0");
+  EXPECT_NE(IdInterner::kInvalidHandle, sender);
+  EXPECT_NE(IdInterner::kInvalidHandle, receiver);
+  EXPECT_NE(sender, receiver);
+
+  EXPECT_EQ(sender, interner.Intern("sender-0"));
+  EXPECT_EQ(sender, interner.Find("sender-0"));
+  EXPECT_EQ(receiver, interner.Find("receiver-0"));
+  EXPECT_EQ(IdInterner::kInvalidHandle, interner.Find("sender-1"));
+  EXPECT_EQ(2u, interner.size());
+}
+
+TEST(IdInternerTest, ReleasesWhenUnreferenced) {
+  IdInterner interner;
+  const IdInterner::Handle handle = interner.Intern("sender-0");
+  interner.Intern("sender-0");
+
+  interner.Release(handle);
+  EXPECT_EQ(handle, interner.Find("sender-0"));
+
+  interner.Release(handle);
+  EXPECT_EQ(IdInterner::kInvalidHandle, interner.Find("sender-0"));
+  EXPECT_EQ(0u, interner.size());
+}
+
+TEST(IdInternerTest, ReusesReleasedHandles) {
+  IdInterner interner;
+  const IdInterner::Handle first = interner.Intern("sender-0");
+  const IdInterner::Handle second = interner.Intern("sender-1");
+  interner.Release(first);
+
+  // A sender that reconnects with a new ID takes over the old handle.
+  EXPECT_EQ(first, interner.Intern("sender-2"));
+  EXPECT_EQ(first, interner.Find("sender-2"));
+  EXPECT_EQ(second, interner.Find("sender-1"));
+  EXPECT_EQ(IdInterner::kInvalidHandle, interner.Find("sender-0"));
+}
+
+}  // namespace cast
+}  // namespace openscreen
@@ -28,16 +28,32 @@ static constexpr size_t kMaxBodySize = 65536;
 
 ErrorOr<std::vector<uint8_t>> Serialize(
     const ::cast::channel::CastMessage& message) {
+  std::vector<uint8_t> out;
+  Error error = SerializeTo(message, &out);
+  if (!error.ok()) {
+    return error;
+  }
+  return out;
+}
+
+Error SerializeTo(const ::cast::channel::CastMessage& message,
+                  std::vector<uint8_t>* out) {
   const size_t message_size = message.ByteSizeLong();
   if (message_size > kMaxBodySize || message_size == 0) {
     return Error::Code::kCastV2InvalidMessage;
   }
-  std::vector<uint8_t> out(message_size + kHeaderSize, 0);
-  WriteBigEndian<uint32_t>(message_size, out.data());
-  if (!message.SerializeToArray(&out[kHeaderSize], message_size)) {
+  const size_t start = out->size();
+  out->resize(start + kHeaderSize + message_size);
+  uint8_t* const frame = out->data() + start;
+  WriteBigEndian<uint32_t>(message_size, frame);
+  // ByteSizeLong() cached the sizes that this relies on.
+  const uint8_t* const end =
+      message.SerializeWithCachedSizesToArray(frame + kHeaderSize);
+  if (end != frame + kHeaderSize + message_size) {
+    out->resize(start);
     return Error::Code::kCastV2InvalidMessage;
   }
-  return out;
+  return Error::None();
 }
 
 ErrorOr<DeserializeResult> TryDeserialize(absl::Span<const uint8_t> input) {
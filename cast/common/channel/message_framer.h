@@ -24,6 +24,12 @@ namespace message_serialization {
 ErrorOr<std::vector<uint8_t>> Serialize(
     const ::cast::channel::CastMessage& message);
 
+// Like Serialize(), but appends the framed |message| to |out|, so that a
+// buffer may be reused or shared by several messages.  |out| is left as it
+// was if an error is returned.
+Error SerializeTo(const ::cast::channel::CastMessage& message,
+                  std::vector<uint8_t>* out);
+
 struct DeserializeResult {
   ::cast::channel::CastMessage message;
   size_t length;
@@ -91,6 +91,30 @@ TEST_F(CastFramerTest, TestSerializeErrorMessageTooLarge) {
   EXPECT_FALSE(Serialize(big_message));
 }
 
+TEST_F(CastFramerTest, TestSerializeToAppends) {
+  std::vector<uint8_t> out = {1, 2, 3};
+  ASSERT_TRUE(SerializeTo(cast_message_, &out).ok());
+  ASSERT_TRUE(SerializeTo(cast_message_, &out).ok());
+
+  std::vector<uint8_t> expected = {1, 2, 3};
+  expected.insert(expected.end(), cast_message_serial_.begin(),
+                  cast_message_serial_.end());
+  expected.insert(expected.end(), cast_message_serial_.begin(),
+                  cast_message_serial_.end());
+  EXPECT_EQ(expected, out);
+}
+
+TEST_F(CastFramerTest, TestSerializeToErrorLeavesBufferUnchanged) {
+  CastMessage big_message;
+  big_message.CopyFrom(cast_message_);
+  big_message.set_payload_utf8(std::string(kMaxBodySize + 1, 'x'));
+
+  std::vector<uint8_t> out = {1, 2, 3};
+  EXPECT_EQ(Error::Code::kCastV2InvalidMessage,
+            SerializeTo(big_message, &out).code());
+  EXPECT_EQ((std::vector<uint8_t>{1, 2, 3}), out);
+}
+
 TEST_F(CastFramerTest, TestCompleteMessageAtOnce) {
   WriteToBuffer(cast_message_serial_);
 
@@ -110,6 +110,16 @@ CastMessage MakeSimpleUTF8Message(const std::string& namespace_,
   return message;
 }
 
+CastMessage MakeSimpleBinaryMessage(const std::string& namespace_,
+                                    absl::Span<const uint8_t> payload) {
+  CastMessage message;
+  message.set_protocol_version(kDefaultOutgoingMessageVersion);
+  message.set_namespace_(namespace_);
+  message.set_payload_type(::cast::channel::CastMessage_PayloadType_BINARY);
+  message.set_payload_binary(payload.data(), payload.size());
+  return message;
+}
+
 CastMessage MakeConnectMessage(const std::string& source_id,
                                const std::string& destination_id) {
   CastMessage connect_message =
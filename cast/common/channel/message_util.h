@@ -5,9 +5,12 @@
 #ifndef CAST_COMMON_CHANNEL_MESSAGE_UTIL_H_
 #define CAST_COMMON_CHANNEL_MESSAGE_UTIL_H_
 
+#include <stdint.h>
+
 #include <string>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "cast/common/channel/proto/cast_channel.pb.h"
 
 namespace openscreen {
@@ -230,6 +233,10 @@ inline bool IsTransportNamespace(absl::string_view namespace_) {
     const std::string& namespace_,
     std::string payload);
 
+::cast::channel::CastMessage MakeSimpleBinaryMessage(
+    const std::string& namespace_,
+    absl::Span<const uint8_t> payload);
+
 ::cast::channel::CastMessage MakeConnectMessage(
     const std::string& source_id,
     const std::string& destination_id);
@@ -5,8 +5,8 @@
 #ifndef CAST_COMMON_CHANNEL_NAMESPACE_ROUTER_H_
 #define CAST_COMMON_CHANNEL_NAMESPACE_ROUTER_H_
 
-#include <map>
 #include <string>
+#include <unordered_map>
 
 #include "cast/common/channel/cast_message_handler.h"
 #include "cast/common/channel/proto/cast_channel.pb.h"
@@ -28,7 +28,8 @@ class NamespaceRouter final : public CastMessageHandler {
                  ::cast::channel::CastMessage message) override;
 
  private:
-  std::map<std::string /* namespace */, CastMessageHandler*> handlers_;
+  std::unordered_map<std::string /* namespace */, CastMessageHandler*>
+      handlers_;
 };
 
 }  // namespace cast
@@ -5,6 +5,7 @@
 #include "cast/common/channel/virtual_connection_router.h"
 
 #include <utility>
+#include <vector>
 
 #include "cast/common/channel/cast_message_handler.h"
 #include "cast/common/channel/connection_namespace_handler.h"
@@ -24,99 +25,89 @@ VirtualConnectionRouter::~VirtualConnectionRouter() = default;
 void VirtualConnectionRouter::AddConnection(
     VirtualConnection virtual_connection,
     VirtualConnection::AssociatedData associated_data) {
-  auto& socket_map = connections_[virtual_connection.socket_id];
-  auto local_entries = socket_map.equal_range(virtual_connection.local_id);
-  auto it = std::find_if(
-      local_entries.first, local_entries.second,
-      [&virtual_connection](const std::pair<std::string, VCTail>& entry) {
-        return entry.second.peer_id == virtual_connection.peer_id;
-      });
-  if (it == socket_map.end()) {
-    socket_map.emplace(std::move(virtual_connection.local_id),
-                       VCTail{std::move(virtual_connection.peer_id),
-                              std::move(associated_data)});
+  if (FindConnection(virtual_connection.socket_id,
+                     ids_.Find(virtual_connection.local_id),
+                     virtual_connection.peer_id)) {
+    return;
   }
+
+  const ConnectionKey key{virtual_connection.socket_id,
+                          ids_.Intern(virtual_connection.local_id),
+                          ids_.Intern(virtual_connection.peer_id)};
+  connections_.emplace(key, std::move(associated_data));
 }
 
 bool VirtualConnectionRouter::RemoveConnection(
     const VirtualConnection& virtual_connection,
     VirtualConnection::CloseReason reason) {
-  auto socket_entry = connections_.find(virtual_connection.socket_id);
-  if (socket_entry == connections_.end()) {
-    return false;
-  }
-
-  auto& socket_map = socket_entry->second;
-  auto local_entries = socket_map.equal_range(virtual_connection.local_id);
-  if (local_entries.first == socket_map.end()) {
+  const ConnectionKey key{virtual_connection.socket_id,
+                          ids_.Find(virtual_connection.local_id),
+                          ids_.Find(virtual_connection.peer_id)};
+  auto it = connections_.find(key);
+  if (it == connections_.end()) {
     return false;
   }
-  for (auto it = local_entries.first; it != local_entries.second; ++it) {
-    if (it->second.peer_id == virtual_connection.peer_id) {
-      socket_map.erase(it);
-      if (socket_map.empty()) {
-        connections_.erase(socket_entry);
-      }
-      return true;
-    }
-  }
-  return false;
+  EraseConnection(it);
+  return true;
 }
 
 void VirtualConnectionRouter::RemoveConnectionsByLocalId(
     const std::string& local_id) {
-  for (auto socket_entry = connections_.begin();
-       socket_entry != connections_.end();) {
-    auto& socket_map = socket_entry->second;
-    auto local_entries = socket_map.equal_range(local_id);
-    if (local_entries.first != socket_map.end()) {
-      socket_map.erase(local_entries.first, local_entries.second);
-      if (socket_map.empty()) {
-        socket_entry = connections_.erase(socket_entry);
-        continue;
-      }
+  const Handle handle = ids_.Find(local_id);
+  if (handle == IdInterner::kInvalidHandle) {
+    return;
+  }
+  for (auto it = connections_.begin(); it != connections_.end();) {
+    if (it->first.local_id == handle) {
+      it = EraseConnection(it);
+    } else {
+      ++it;
     }
-    ++socket_entry;
   }
 }
 
 void VirtualConnectionRouter::RemoveConnectionsBySocketId(int socket_id) {
-  auto entry = connections_.find(socket_id);
-  if (entry != connections_.end()) {
-    connections_.erase(entry);
+  for (auto it = connections_.begin(); it != connections_.end();) {
+    if (it->first.socket_id == socket_id) {
+      it = EraseConnection(it);
+    } else {
+      ++it;
+    }
   }
 }
 
 absl::optional<const VirtualConnection::AssociatedData*>
 VirtualConnectionRouter::GetConnectionData(
     const VirtualConnection& virtual_connection) const {
-  auto socket_entry = connections_.find(virtual_connection.socket_id);
-  if (socket_entry == connections_.end()) {
+  const VirtualConnection::AssociatedData* data =
+      FindConnection(virtual_connection.socket_id,
+                     ids_.Find(virtual_connection.local_id),
+                     virtual_connection.peer_id);
+  if (!data) {
     return absl::nullopt;
   }
-
-  auto& socket_map = socket_entry->second;
-  auto local_entries = socket_map.equal_range(virtual_connection.local_id);
-  if (local_entries.first == socket_map.end()) {
-    return absl::nullopt;
-  }
-  for (auto it = local_entries.first; it != local_entries.second; ++it) {
-    if (it->second.peer_id == virtual_connection.peer_id) {
-      return &it->second.data;
-    }
-  }
-  return absl::nullopt;
+  return data;
 }
 
 bool VirtualConnectionRouter::AddHandlerForLocalId(
     std::string local_id,
     CastMessageHandler* endpoint) {
-  return endpoints_.emplace(std::move(local_id), endpoint).second;
+  const Handle handle = ids_.Intern(local_id);
+  if (!endpoints_.emplace(handle, endpoint).second) {
+    ids_.Release(handle);
+    return false;
+  }
+  return true;
 }
 
 bool VirtualConnectionRouter::RemoveHandlerForLocalId(
     const std::string& local_id) {
-  return endpoints_.erase(local_id) == 1u;
+  const Handle handle = ids_.Find(local_id);
+  if (handle == IdInterner::kInvalidHandle || endpoints_.erase(handle) == 0) {
+    return false;
+  }
+  ids_.Release(handle);
+  return true;
 }
 
 void VirtualConnectionRouter::TakeSocket(SocketErrorHandler* error_handler,
@@ -164,11 +155,7 @@ Error VirtualConnectionRouter::BroadcastFromLocalPeer(
   message.set_destination_id(kBroadcastId);
 
   // Broadcast to local endpoints.
-  for (const auto& entry : endpoints_) {
-    if (entry.first != message.source_id()) {
-      entry.second->OnMessage(this, nullptr, message);
-    }
-  }
+  BroadcastToEndpoints(nullptr, message, ids_.Find(message.source_id()));
 
   // Broadcast to remote endpoints. If an Error occurs, continue broadcasting,
   // and later return the first Error that occurred.
@@ -198,11 +185,8 @@ void VirtualConnectionRouter::OnMessage(CastSocket* socket,
                                         CastMessage message) {
   OSP_DCHECK(socket);
 
-  const std::string& local_id = message.destination_id();
-  if (local_id == kBroadcastId) {
-    for (const auto& entry : endpoints_) {
-      entry.second->OnMessage(this, socket, message);
-    }
+  if (message.destination_id() == kBroadcastId) {
+    BroadcastToEndpoints(socket, message, IdInterner::kInvalidHandle);
   } else {
     // Connection namespace messages are weird: The message.source_id() and
     // message.destination_id() are NOT treated as "envelope routing
@@ -216,12 +200,17 @@ void VirtualConnectionRouter::OnMessage(CastSocket* socket,
       return;
     }
 
+    // An uninterned destination has neither an endpoint nor a connection.
+    const Handle local_id = ids_.Find(message.destination_id());
+    if (local_id == IdInterner::kInvalidHandle) {
+      return;
+    }
+
     // Drop all messages for virtual connections that do not yet exist.
     // Exception: All transport namespace messages (e.g., device auth,
     // heartbeats, etc.); because these are always assumed to have a route.
     if (!IsTransportNamespace(message.namespace_()) &&
-        !GetConnectionData(VirtualConnection{local_id, message.source_id(),
-                                             socket->socket_id()})) {
+        !FindConnection(socket->socket_id(), local_id, message.source_id())) {
       return;
     }
     auto it = endpoints_.find(local_id);
@@ -231,5 +220,47 @@ void VirtualConnectionRouter::OnMessage(CastSocket* socket,
   }
 }
 
+const VirtualConnection::AssociatedData*
+VirtualConnectionRouter::FindConnection(int socket_id,
+                                        Handle local_id,
+                                        const std::string& peer_id) const {
+  if (local_id == IdInterner::kInvalidHandle) {
+    return nullptr;
+  }
+  const Handle peer_handle = ids_.Find(peer_id);
+  if (peer_handle == IdInterner::kInvalidHandle) {
+    return nullptr;
+  }
+  auto it = connections_.find(ConnectionKey{socket_id, local_id, peer_handle});
+  return it == connections_.end() ? nullptr : &it->second;
+}
+
+void VirtualConnectionRouter::BroadcastToEndpoints(CastSocket* socket,
+                                                   const CastMessage& message,
+                                                   Handle excluded_id) {
+  // Handlers may add or remove endpoints, which would invalidate iterators
+  // into |endpoints_|, so walk a copy of the handles instead.
+  std::vector<Handle> local_ids;
+  local_ids.reserve(endpoints_.size());
+  for (const auto& entry : endpoints_) {
+    if (entry.first != excluded_id) {
+      local_ids.push_back(entry.first);
+    }
+  }
+  for (Handle local_id : local_ids) {
+    auto it = endpoints_.find(local_id);
+    if (it != endpoints_.end()) {
+      it->second->OnMessage(this, socket, message);
+    }
+  }
+}
+
+VirtualConnectionRouter::ConnectionMap::iterator
+VirtualConnectionRouter::EraseConnection(ConnectionMap::iterator it) {
+  ids_.Release(it->first.local_id);
+  ids_.Release(it->first.peer_id);
+  return connections_.erase(it);
+}
+
 }  // namespace cast
 }  // namespace openscreen
@@ -6,11 +6,14 @@
 #define CAST_COMMON_CHANNEL_VIRTUAL_CONNECTION_ROUTER_H_
 
 #include <cstdint>
-#include <map>
 #include <memory>
 #include <string>
+#include <unordered_map>
+#include <utility>
 
+#include "absl/hash/hash.h"
 #include "absl/types/optional.h"
+#include "cast/common/channel/id_interner.h"
 #include "cast/common/channel/proto/cast_channel.pb.h"
 #include "cast/common/channel/virtual_connection.h"
 #include "cast/common/public/cast_socket.h"
@@ -113,27 +116,60 @@ class VirtualConnectionRouter final : public CastSocket::Client {
   }
 
  private:
-  // This struct simply stores the remainder of the data {VirtualConnection,
-  // VirtualConnection::AssociatedData} that is not broken up into map keys for
-  // |connections_|.
-  struct VCTail {
-    std::string peer_id;
-    VirtualConnection::AssociatedData data;
+  using Handle = IdInterner::Handle;
+
+  // A VirtualConnection, with its local and peer IDs interned in |ids_|.
+  struct ConnectionKey {
+    int socket_id;
+    Handle local_id;
+    Handle peer_id;
+
+    bool operator==(const ConnectionKey& other) const {
+      return socket_id == other.socket_id && local_id == other.local_id &&
+             peer_id == other.peer_id;
+    }
+
+    template <typename H>
+    friend H AbslHashValue(H h, const ConnectionKey& key) {
+      return H::combine(std::move(h), key.socket_id, key.local_id,
+                        key.peer_id);
+    }
   };
 
+  using ConnectionMap = std::unordered_map<ConnectionKey,
+                                           VirtualConnection::AssociatedData,
+                                           absl::Hash<ConnectionKey>>;
+
   struct SocketWithHandler {
     std::unique_ptr<CastSocket> socket;
     SocketErrorHandler* error_handler;
   };
 
+  // Returns the data for the connection from the already-interned |local_id|
+  // to |peer_id| over |socket_id|, or nullptr if there is none.
+  const VirtualConnection::AssociatedData* FindConnection(
+      int socket_id,
+      Handle local_id,
+      const std::string& peer_id) const;
+
+  // Delivers |message| to every local endpoint but |excluded_id|.
+  void BroadcastToEndpoints(CastSocket* socket,
+                            const ::cast::channel::CastMessage& message,
+                            Handle excluded_id);
+
+  // Removes the connection at |it|, dropping its references to its IDs, and
+  // returns the iterator following it.
+  ConnectionMap::iterator EraseConnection(ConnectionMap::iterator it);
+
   ConnectionNamespaceHandler* connection_handler_ = nullptr;
 
-  std::map<int /* socket_id */,
-           std::multimap<std::string /* local_id */, VCTail>>
-      connections_;
+  // Local and peer IDs of |connections_| and |endpoints_|.  Each connection
+  // holds a reference to both of its IDs, and each endpoint to its local ID.
+  IdInterner ids_;
 
-  std::map<int, SocketWithHandler> sockets_;
-  std::map<std::string /* local_id */, CastMessageHandler*> endpoints_;
+  ConnectionMap connections_;
+  std::unordered_map<int, SocketWithHandler> sockets_;
+  std::unordered_map<Handle /* local_id */, CastMessageHandler*> endpoints_;
 };
 
 }  // namespace cast
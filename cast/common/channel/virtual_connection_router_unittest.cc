@@ -160,6 +160,34 @@ TEST_F(VirtualConnectionRouterTest, RemoveConnectionsByIds) {
   EXPECT_FALSE(local_router_.GetConnectionData(vc3_));
 }
 
+TEST_F(VirtualConnectionRouterTest, DistinguishesIdsAfterRemovingThem) {
+  local_router_.AddConnection(vc1_, {});
+  // The same IDs, but swapped.
+  EXPECT_FALSE(local_router_.GetConnectionData(
+      VirtualConnection{vc1_.peer_id, vc1_.local_id, vc1_.socket_id}));
+
+  EXPECT_TRUE(local_router_.RemoveConnection(
+      vc1_, VirtualConnection::CloseReason::kClosedBySelf));
+  local_router_.AddConnection(vc2_, {});
+  EXPECT_FALSE(local_router_.GetConnectionData(vc1_));
+  EXPECT_TRUE(local_router_.GetConnectionData(vc2_));
+
+  local_router_.AddConnection(vc1_, {});
+  local_router_.AddConnection(vc3_, {});
+  EXPECT_TRUE(local_router_.GetConnectionData(vc1_));
+  EXPECT_TRUE(local_router_.GetConnectionData(vc2_));
+  EXPECT_TRUE(local_router_.GetConnectionData(vc3_));
+
+  // Removing the handler for "local1" leaves its connections in place.
+  MockCastMessageHandler mock_message_handler;
+  EXPECT_TRUE(local_router_.AddHandlerForLocalId(vc1_.local_id,
+                                                 &mock_message_handler));
+  EXPECT_TRUE(local_router_.RemoveHandlerForLocalId(vc1_.local_id));
+  EXPECT_FALSE(local_router_.RemoveHandlerForLocalId(vc1_.local_id));
+  EXPECT_TRUE(local_router_.GetConnectionData(vc1_));
+  EXPECT_TRUE(local_router_.GetConnectionData(vc3_));
+}
+
 TEST_F(VirtualConnectionRouterTest, LocalIdHandler) {
   MockCastMessageHandler mock_message_handler;
   local_router_.AddHandlerForLocalId("receiver-1234", &mock_message_handler);
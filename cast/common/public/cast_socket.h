@@ -9,6 +9,7 @@
 #include <memory>
 #include <vector>
 
+#include "platform/api/time.h"
 #include "platform/api/tls_connection.h"
 #include "util/weak_ptr.h"
 
@@ -19,6 +20,9 @@ class CastMessage;
 }  // namespace cast
 
 namespace openscreen {
+
+class TaskRunner;
+
 namespace cast {
 
 // Represents a simple message-oriented socket for communicating with the Cast
@@ -46,6 +50,20 @@ class CastSocket : public TlsConnection::Client {
   // write-blocked.
   [[nodiscard]] Error Send(const ::cast::channel::CastMessage& message);
 
+  // Enables write coalescing: rather than each Send() being its own write to
+  // the TLS connection, messages are serialized into a shared buffer that is
+  // written all at once when the current |task_runner| task has finished, or
+  // |max_delay| after the first of them if that is non-zero.  The buffer is
+  // also written as soon as it holds a full TLS record's worth.  Passing a null
+  // |task_runner| writes anything still buffered and goes back to writing each
+  // message immediately.
+  //
+  // While coalescing, messages that a write-blocked TLS connection won't take
+  // are kept and retried later.  If too many pile up, Send() returns
+  // kSocketSendFailure and the socket stops accepting messages.
+  void SetWriteCoalescing(TaskRunner* task_runner,
+                          Clock::duration max_delay = Clock::duration::zero());
+
   void SetClient(Client* client);
 
   std::array<uint8_t, 2> GetSanitizedIpAddress();
@@ -67,15 +85,32 @@ class CastSocket : public TlsConnection::Client {
     kError = false,
   };
 
+  // Posts a FlushWrites() to |write_task_runner_|, if one isn't pending.
+  void ScheduleFlush(Clock::duration delay);
+
+  // Writes everything in |write_buffer_| to the TLS connection, keeping it for
+  // a later retry if the connection is write-blocked.
+  void FlushWrites();
+
   static int g_next_socket_id_;
 
   const std::unique_ptr<TlsConnection> connection_;
   Client* client_;  // May never be null.
   const int socket_id_;
   bool audio_only_ = false;
+  // The start of a message whose remaining bytes have yet to arrive.
   std::vector<uint8_t> read_buffer_;
   State state_ = State::kOpen;
 
+  // Non-null while writes are being coalesced.
+  TaskRunner* write_task_runner_ = nullptr;
+  Clock::duration max_write_delay_ = Clock::duration::zero();
+  bool flush_scheduled_ = false;
+
+  // Messages waiting to be written while coalescing, and otherwise the message
+  // being sent.  Reused so that it only grows to fit the largest burst.
+  std::vector<uint8_t> write_buffer_;
+
   WeakPtrFactory<CastSocket> weak_factory_{this};
 };
 
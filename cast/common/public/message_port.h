@@ -5,8 +5,11 @@
 #ifndef CAST_COMMON_PUBLIC_MESSAGE_PORT_H_
 #define CAST_COMMON_PUBLIC_MESSAGE_PORT_H_
 
+#include <stdint.h>
+
 #include <string>
 
+#include "absl/types/span.h"
 #include "platform/base/error.h"
 
 namespace openscreen {
@@ -25,6 +28,12 @@ class MessagePort {
                            const std::string& message_namespace,
                            const std::string& message) = 0;
     virtual void OnError(Error error) = 0;
+
+    // Called for messages carrying a binary payload. Only ports that return
+    // true from SupportsBinaryMessages() will ever call this.
+    virtual void OnBinaryMessage(const std::string& source_sender_id,
+                                 const std::string& message_namespace,
+                                 absl::Span<const uint8_t> payload) {}
   };
 
   virtual ~MessagePort() = default;
@@ -34,6 +43,13 @@ class MessagePort {
   virtual void PostMessage(const std::string& destination_sender_id,
                            const std::string& message_namespace,
                            const std::string& message) = 0;
+
+  // Binary messages are optional: callers must check SupportsBinaryMessages()
+  // before calling PostBinaryMessage(), and otherwise use PostMessage().
+  virtual bool SupportsBinaryMessages() const { return false; }
+  virtual void PostBinaryMessage(const std::string& destination_sender_id,
+                                 const std::string& message_namespace,
+                                 absl::Span<const uint8_t> payload) {}
 };
 
 }  // namespace cast
@@ -113,6 +113,7 @@ void ApplicationAgent::StopApplicationIfRunning(Application* app) {
 void ApplicationAgent::OnConnected(ReceiverSocketFactory* factory,
                                    const IPEndpoint& endpoint,
                                    std::unique_ptr<CastSocket> socket) {
+  socket->SetWriteCoalescing(task_runner_);
   router_.TakeSocket(this, std::move(socket));
 }
 
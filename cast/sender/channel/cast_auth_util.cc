@@ -12,6 +12,7 @@
 #include "cast/common/certificate/cast_cert_validator.h"
 #include "cast/common/certificate/cast_cert_validator_internal.h"
 #include "cast/common/certificate/cast_crl.h"
+#include "cast/common/certificate/cert_verification_cache.h"
 #include "cast/common/channel/proto/cast_channel.pb.h"
 #include "platform/api/time.h"
 #include "platform/base/error.h"
@@ -229,6 +230,8 @@ ErrorOr<CastDeviceCertPolicy> VerifyCredentialsImpl(
     const CRLPolicy& crl_policy,
     TrustStore* cast_trust_store,
     TrustStore* crl_trust_store,
+    CertVerificationCache* cert_cache,
+    CastCRLStore* crl_store,
     const DateTime& verification_time,
     bool enforce_sha256_checking);
 
@@ -239,6 +242,8 @@ ErrorOr<CastDeviceCertPolicy> AuthenticateChallengeReplyImpl(
     const CRLPolicy& crl_policy,
     TrustStore* cast_trust_store,
     TrustStore* crl_trust_store,
+    CertVerificationCache* cert_cache,
+    CastCRLStore* crl_store,
     const DateTime& verification_time) {
   DeviceAuthMessage auth_message;
   Error result = ParseAuthMessage(challenge_reply, &auth_message);
@@ -275,8 +280,8 @@ ErrorOr<CastDeviceCertPolicy> AuthenticateChallengeReplyImpl(
   }
 
   return VerifyCredentialsImpl(response, nonce_plus_peer_cert_der, crl_policy,
-                               cast_trust_store, crl_trust_store,
-                               verification_time, false);
+                               cast_trust_store, crl_trust_store, cert_cache,
+                               crl_store, verification_time, false);
 }
 
 ErrorOr<CastDeviceCertPolicy> AuthenticateChallengeReply(
@@ -288,7 +293,8 @@ ErrorOr<CastDeviceCertPolicy> AuthenticateChallengeReply(
   CRLPolicy policy = CRLPolicy::kCrlOptional;
   return AuthenticateChallengeReplyImpl(
       challenge_reply, peer_cert, auth_context, policy,
-      /* cast_trust_store */ nullptr, /* crl_trust_store */ nullptr, now);
+      /* cast_trust_store */ nullptr, /* crl_trust_store */ nullptr,
+      CertVerificationCache::GetInstance(), CastCRLStore::GetInstance(), now);
 }
 
 ErrorOr<CastDeviceCertPolicy> AuthenticateChallengeReplyForTest(
@@ -301,7 +307,8 @@ ErrorOr<CastDeviceCertPolicy> AuthenticateChallengeReplyForTest(
     const DateTime& verification_time) {
   return AuthenticateChallengeReplyImpl(
       challenge_reply, peer_cert, auth_context, crl_policy, cast_trust_store,
-      crl_trust_store, verification_time);
+      crl_trust_store, /* cert_cache */ nullptr, /* crl_store */ nullptr,
+      verification_time);
 }
 
 // This function does the following
@@ -319,6 +326,13 @@ ErrorOr<CastDeviceCertPolicy> AuthenticateChallengeReplyForTest(
 //   |crl_trust_store|. If |crl_policy| is kCrlOptional then the result of
 //   revocation checking is ignored. The CRL is verified at |verification_time|.
 //
+// * Reuses the result of verifying the same chain earlier if it is in the
+//   non-nullptr |cert_cache|; revocation is still checked every time.
+//
+// * If |crl_store| is non-nullptr, it is used to parse and verify the CRL in
+//   place of |crl_trust_store|, sharing the result with other authentications
+//   that present the same CRL.
+//
 // * Verifies that |response.signature| matches the signature of
 //   |signature_input| by |response.client_auth_certificate|'s public key.
 ErrorOr<CastDeviceCertPolicy> VerifyCredentialsImpl(
@@ -327,6 +341,8 @@ ErrorOr<CastDeviceCertPolicy> VerifyCredentialsImpl(
     const CRLPolicy& crl_policy,
     TrustStore* cast_trust_store,
     TrustStore* crl_trust_store,
+    CertVerificationCache* cert_cache,
+    CastCRLStore* crl_store,
     const DateTime& verification_time,
     bool enforce_sha256_checking) {
   if (response.signature().empty() && !signature_input.empty()) {
@@ -344,16 +360,22 @@ ErrorOr<CastDeviceCertPolicy> VerifyCredentialsImpl(
                     response.intermediate_certificate().end());
 
   // Parse the CRL.
-  std::unique_ptr<CastCRL> crl;
+  std::shared_ptr<const CastCRL> crl;
   if (!response.crl().empty()) {
-    crl = ParseAndVerifyCRL(response.crl(), verification_time, crl_trust_store);
+    if (crl_store) {
+      crl = crl_store->GetCRL(response.crl(), verification_time);
+    } else {
+      crl =
+          ParseAndVerifyCRL(response.crl(), verification_time, crl_trust_store);
+    }
   }
 
   // Perform certificate verification.
   CastDeviceCertPolicy device_policy;
   Error verify_result =
       VerifyDeviceCert(cert_chain, verification_time, &verification_context,
-                       &device_policy, crl.get(), crl_policy, cast_trust_store);
+                       &device_policy, crl.get(), crl_policy, cast_trust_store,
+                       cert_cache);
 
   // Handle and report errors.
   Error result = MapToOpenscreenError(verify_result.code(),
@@ -393,8 +415,10 @@ ErrorOr<CastDeviceCertPolicy> VerifyCredentials(
   OSP_CHECK(DateTimeFromSeconds(GetWallTimeSinceUnixEpoch().count(), &now));
   CRLPolicy policy = (enforce_revocation_checking) ? CRLPolicy::kCrlRequired
                                                    : CRLPolicy::kCrlOptional;
-  return VerifyCredentialsImpl(response, signature_input, policy, nullptr,
-                               nullptr, now, enforce_sha256_checking);
+  return VerifyCredentialsImpl(
+      response, signature_input, policy, nullptr, nullptr,
+      CertVerificationCache::GetInstance(), CastCRLStore::GetInstance(), now,
+      enforce_sha256_checking);
 }
 
 ErrorOr<CastDeviceCertPolicy> VerifyCredentialsForTest(
@@ -407,7 +431,9 @@ ErrorOr<CastDeviceCertPolicy> VerifyCredentialsForTest(
     bool enforce_sha256_checking) {
   return VerifyCredentialsImpl(response, signature_input, crl_policy,
                                cast_trust_store, crl_trust_store,
-                               verification_time, enforce_sha256_checking);
+                               /* cert_cache */ nullptr,
+                               /* crl_store */ nullptr, verification_time,
+                               enforce_sha256_checking);
 }
 
 }  // namespace cast
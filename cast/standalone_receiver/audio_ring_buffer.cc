@@ -0,0 +1,76 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/standalone_receiver/audio_ring_buffer.h"
+
+#include <string.h>
+
+#include <algorithm>
+
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+AudioRingBuffer::AudioRingBuffer(int capacity) : buffer_(capacity) {
+  OSP_DCHECK_GT(capacity, 0);
+}
+
+AudioRingBuffer::~AudioRingBuffer() = default;
+
+int AudioRingBuffer::Write(absl::Span<const uint8_t> data) {
+  int64_t position;
+  int index;
+  const int count = std::min(GetWritableSpace(&position, &index),
+                             static_cast<int>(data.size()));
+
+  // Copy in up to two pieces: up to the end of |buffer_|, and then from the
+  // start.
+  const int first_part = std::min(count, capacity() - index);
+  memcpy(buffer_.data() + index, data.data(), first_part);
+  memcpy(buffer_.data(), data.data() + first_part, count - first_part);
+
+  write_position_.store(position + count, std::memory_order_release);
+  return count;
+}
+
+int AudioRingBuffer::WriteFill(uint8_t value, int count) {
+  int64_t position;
+  int index;
+  count = std::min(GetWritableSpace(&position, &index), count);
+
+  const int first_part = std::min(count, capacity() - index);
+  memset(buffer_.data() + index, value, first_part);
+  memset(buffer_.data(), value, count - first_part);
+
+  write_position_.store(position + count, std::memory_order_release);
+  return count;
+}
+
+int AudioRingBuffer::Read(absl::Span<uint8_t> out) {
+  const int64_t position = read_position_.load(std::memory_order_relaxed);
+  const int available = static_cast<int>(
+      write_position_.load(std::memory_order_acquire) - position);
+  const int count = std::min(available, static_cast<int>(out.size()));
+  const int index = static_cast<int>(position % capacity());
+
+  const int first_part = std::min(count, capacity() - index);
+  memcpy(out.data(), buffer_.data() + index, first_part);
+  memcpy(out.data() + first_part, buffer_.data(), count - first_part);
+
+  read_position_.store(position + count, std::memory_order_release);
+  return count;
+}
+
+int AudioRingBuffer::GetWritableSpace(int64_t* write_position,
+                                      int* index) const {
+  *write_position = write_position_.load(std::memory_order_relaxed);
+  *index = static_cast<int>(*write_position % capacity());
+  return capacity() -
+         static_cast<int>(*write_position -
+                          read_position_.load(std::memory_order_acquire));
+}
+
+}  // namespace cast
+}  // namespace openscreen
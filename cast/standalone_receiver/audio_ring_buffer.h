@@ -0,0 +1,78 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STANDALONE_RECEIVER_AUDIO_RING_BUFFER_H_
+#define CAST_STANDALONE_RECEIVER_AUDIO_RING_BUFFER_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "platform/base/macros.h"
+
+namespace openscreen {
+namespace cast {
+
+// A fixed-capacity ring of bytes for passing audio samples from exactly one
+// producer thread to exactly one consumer thread (e.g., an audio device
+// callback), without locking. The Write*() methods must only be called from the
+// producer thread, and Read() only from the consumer thread.
+//
+// The read and write positions count every byte that has passed through the
+// ring, and never wrap. Thus, they also serve as sample clocks: A consumer can
+// tell exactly which byte of the stream it is about to play out.
+class AudioRingBuffer {
+ public:
+  explicit AudioRingBuffer(int capacity);
+  ~AudioRingBuffer();
+
+  int capacity() const { return static_cast<int>(buffer_.size()); }
+
+  // Copies as many bytes from |data| as will fit, and returns that count.
+  int Write(absl::Span<const uint8_t> data);
+
+  // Writes up to |count| copies of |value| (e.g., silence), as will fit, and
+  // returns the number written.
+  int WriteFill(uint8_t value, int count);
+
+  // Copies up to |out.size()| bytes into |out|, and returns that count.
+  int Read(absl::Span<uint8_t> out);
+
+  // The total number of bytes written to, or read from, the ring so far. Both
+  // may be called from either thread, but are only a snapshot.
+  int64_t write_position() const {
+    return write_position_.load(std::memory_order_acquire);
+  }
+  int64_t read_position() const {
+    return read_position_.load(std::memory_order_acquire);
+  }
+
+  // The number of bytes waiting to be read (a snapshot).
+  int size() const {
+    return static_cast<int>(write_position() - read_position());
+  }
+
+ private:
+  // Returns the number of bytes that can be written right now, and the index
+  // in |buffer_| where writing starts.
+  int GetWritableSpace(int64_t* write_position, int* index) const;
+
+  std::vector<uint8_t> buffer_;
+
+  // Written only by the consumer. Kept on its own cache line, apart from
+  // |write_position_|, to avoid false sharing.
+  alignas(64) std::atomic<int64_t> read_position_{0};
+
+  // Written only by the producer.
+  alignas(64) std::atomic<int64_t> write_position_{0};
+
+  OSP_DISALLOW_COPY_AND_ASSIGN(AudioRingBuffer);
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STANDALONE_RECEIVER_AUDIO_RING_BUFFER_H_
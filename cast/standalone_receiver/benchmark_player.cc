@@ -0,0 +1,170 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/standalone_receiver/benchmark_player.h"
+
+#include <chrono>
+#include <utility>
+
+#include "cast/streaming/encoded_frame.h"
+#include "util/chrono_helpers.h"
+#include "util/osp_logging.h"
+#include "util/trace_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+namespace {
+
+// How often to log the measurements.
+constexpr std::chrono::seconds kReportInterval{5};
+
+}  // namespace
+
+BenchmarkPlayer::BenchmarkPlayer(ClockNowFunctionPtr now_function,
+                                 TaskRunner* task_runner,
+                                 Receiver* receiver,
+                                 const std::string& codec_name,
+                                 std::function<void()> error_callback,
+                                 const char* media_type)
+    : now_(now_function),
+      receiver_(receiver),
+      error_callback_(std::move(error_callback)),
+      media_type_(media_type),
+      key_frame_gate_(receiver, media_type),
+      last_report_time_(now_()),
+      last_report_cpu_time_(std::clock()),
+      decoder_(task_runner, codec_name),
+      decode_alarm_(now_, task_runner),
+      report_alarm_(now_, task_runner) {
+  OSP_DCHECK(receiver_);
+  OSP_DCHECK(media_type_);
+
+  decoder_.set_client(this);
+  receiver_->SetConsumer(this);
+  report_alarm_.ScheduleFromNow([this] { LogReport(); }, kReportInterval);
+}
+
+BenchmarkPlayer::~BenchmarkPlayer() {
+  receiver_->SetConsumer(nullptr);
+  decoder_.set_client(nullptr);
+  LogReport();
+}
+
+void BenchmarkPlayer::OnFramesReady(int buffer_size) {
+  TRACE_DEFAULT_SCOPED(TraceCategory::kStandaloneReceiver);
+  if (static_cast<int>(frames_in_flight_.size()) >= kMaxFramesInFlight) {
+    return;
+  }
+
+  // Consume the next frame.
+  const Clock::time_point start_time = now_();
+  Decoder::Buffer buffer = decoder_.TakeBuffer();
+  buffer.Resize(buffer_size);
+  const EncodedFrame frame = receiver_->ConsumeNextFrame(buffer.GetSpan());
+
+  if (!key_frame_gate_.ShouldDecode(frame)) {
+    ++frames_dropped_;
+    return;
+  }
+
+  OSP_DCHECK_EQ(frames_in_flight_.count(frame.frame_id), 0);
+  if (decoder_.Decode(frame.frame_id, std::move(buffer))) {
+    frames_in_flight_[frame.frame_id] =
+        InFlightFrame{start_time, frame.reference_time};
+  } else {
+    ++frames_dropped_;
+    key_frame_gate_.OnDecoderFellBehind(frame.frame_id);
+  }
+}
+
+void BenchmarkPlayer::OnFrameDecoded(FrameId frame_id, const AVFrame& frame) {
+  const auto it = frames_in_flight_.find(frame_id);
+  if (it == frames_in_flight_.end()) {
+    return;
+  }
+  const Clock::time_point now = now_();
+  decode_latency_.Add(to_microseconds(now - it->second.start_time).count());
+  ++frames_decoded_;
+  if (now > it->second.playout_time) {
+    ++frames_decoded_late_;
+  }
+  frames_in_flight_.erase(it);
+  ResumeDecoding();
+}
+
+void BenchmarkPlayer::OnDecodeError(FrameId frame_id, std::string message) {
+  frames_in_flight_.erase(frame_id);
+  ++decode_errors_;
+  OSP_LOG_WARN << "Requesting " << media_type_
+               << " key frame because of error decoding " << frame_id << ": "
+               << message;
+  receiver_->RequestKeyFrame();
+  ResumeDecoding();
+}
+
+void BenchmarkPlayer::OnFatalError(std::string message) {
+  error_status_ = Error(Error::Code::kUnknownError, std::move(message));
+
+  // Halt decoding.
+  receiver_->SetConsumer(nullptr);
+  decoder_.set_client(nullptr);
+  decode_alarm_.Cancel();
+  frames_in_flight_.clear();
+
+  if (error_callback_) {
+    const auto callback = std::move(error_callback_);
+    callback();
+  }
+}
+
+void BenchmarkPlayer::ResumeDecoding() {
+  decode_alarm_.Schedule(
+      [this] {
+        const int buffer_size = receiver_->AdvanceToNextFrame();
+        if (buffer_size != Receiver::kNoFramesReady) {
+          OnFramesReady(buffer_size);
+        }
+      },
+      Alarm::kImmediately);
+}
+
+void BenchmarkPlayer::LogReport() {
+  const Clock::time_point now = now_();
+  const std::clock_t cpu_time = std::clock();
+  const int64_t frames_decoded =
+      frames_decoded_ - last_report_frames_decoded_;
+  const double elapsed_seconds =
+      std::chrono::duration<double>(now - last_report_time_).count();
+  const double fps =
+      (elapsed_seconds > 0) ? (frames_decoded / elapsed_seconds) : 0.0;
+  // NOTE: This is the CPU time of the whole process, which includes the
+  // network and decrypt work, as well as the decoder's own threads.
+  const double cpu_ms_per_frame =
+      (frames_decoded > 0)
+          ? (1000.0 * (cpu_time - last_report_cpu_time_) / CLOCKS_PER_SEC /
+             frames_decoded)
+          : 0.0;
+  const LockFreeHistogram::Summary latency = decode_latency_.Summarize();
+
+  OSP_LOG_INFO << "[Benchmark] " << media_type_ << ": " << fps
+               << " frames/sec decoded; " << frames_decoded_ << " decoded ("
+               << frames_decoded_late_ << " late), " << frames_dropped_
+               << " dropped, " << decode_errors_
+               << " errors; decode latency (µs): p50=" << latency.p50
+               << " p95=" << latency.p95 << " p99=" << latency.p99
+               << " max=" << latency.max
+               << "; CPU time per frame: " << cpu_ms_per_frame << " ms";
+
+  last_report_time_ = now;
+  last_report_cpu_time_ = cpu_time;
+  last_report_frames_decoded_ = frames_decoded_;
+  report_alarm_.ScheduleFromNow([this] { LogReport(); }, kReportInterval);
+}
+
+// static
+constexpr int BenchmarkPlayer::kMaxFramesInFlight;
+
+}  // namespace cast
+}  // namespace openscreen
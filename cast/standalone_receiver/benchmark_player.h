@@ -0,0 +1,123 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STANDALONE_RECEIVER_BENCHMARK_PLAYER_H_
+#define CAST_STANDALONE_RECEIVER_BENCHMARK_PLAYER_H_
+
+#include <stdint.h>
+
+#include <ctime>
+#include <functional>
+#include <map>
+#include <string>
+
+#include "cast/standalone_receiver/decoder.h"
+#include "cast/standalone_receiver/key_frame_gate.h"
+#include "cast/standalone_receiver/threaded_decoder.h"
+#include "cast/streaming/receiver.h"
+#include "cast/streaming/receiver_stats.h"
+#include "platform/api/task_runner.h"
+#include "platform/api/time.h"
+#include "platform/base/error.h"
+#include "util/alarm.h"
+
+namespace openscreen {
+namespace cast {
+
+// Consumes frames from a Receiver and decodes them, just like the SDL players,
+// but then discards the decoded frames instead of rendering them. This allows
+// measuring the receiver-side decode capacity on machines without a display
+// (e.g., on CI bots). Every few seconds, and when destroyed, it logs:
+//
+//   * The decode rate (frames per second).
+//   * The decode latency percentiles, from when a frame was consumed until it
+//     was decoded.
+//   * The number of frames decoded after their playout time.
+//   * The process CPU time spent per decoded frame.
+class BenchmarkPlayer final : public Receiver::Consumer,
+                              public Decoder::Client {
+ public:
+  // |error_callback| is run only if a fatal error occurs, at which point the
+  // player has halted and set |error_status()|. |media_type| should be "audio"
+  // or "video" (only used when logging).
+  BenchmarkPlayer(ClockNowFunctionPtr now_function,
+                  TaskRunner* task_runner,
+                  Receiver* receiver,
+                  const std::string& codec_name,
+                  std::function<void()> error_callback,
+                  const char* media_type);
+
+  ~BenchmarkPlayer() final;
+
+  // Returns OK unless a fatal error has occurred.
+  const Error& error_status() const { return error_status_; }
+
+ private:
+  // The tracking state for a frame that has been consumed, but not yet
+  // decoded.
+  struct InFlightFrame {
+    Clock::time_point start_time;
+    Clock::time_point playout_time;
+  };
+
+  // Receiver::Consumer implementation.
+  void OnFramesReady(int next_frame_buffer_size) final;
+
+  // Decoder::Client implementation.
+  void OnFrameDecoded(FrameId frame_id, const AVFrame& frame) final;
+  void OnDecodeError(FrameId frame_id, std::string message) final;
+  void OnFatalError(std::string message) final;
+
+  // Schedules an explicit check to see if more frames are ready for
+  // consumption, since prior notifications may have been ignored while too many
+  // frames were in-flight.
+  void ResumeDecoding();
+
+  // Logs the measurements since the last report (or since the start), and then
+  // schedules the next report.
+  void LogReport();
+
+  const ClockNowFunctionPtr now_;
+  Receiver* const receiver_;
+  std::function<void()> error_callback_;  // Run once by OnFatalError().
+  const char* const media_type_;          // For logging only.
+
+  // Set to the error code that halted the player.
+  Error error_status_;
+
+  // Frames handed off to the decoder, but not yet decoded.
+  std::map<FrameId, InFlightFrame> frames_in_flight_;
+
+  // Drops frames after the decoder has fallen too far behind, until the next
+  // key frame arrives.
+  KeyFrameGate key_frame_gate_;
+
+  // Cumulative counts, since the player was created.
+  int64_t frames_decoded_ = 0;
+  int64_t frames_decoded_late_ = 0;
+  int64_t frames_dropped_ = 0;
+  int64_t decode_errors_ = 0;
+
+  // Microseconds from consuming each frame until it was decoded.
+  LockFreeHistogram decode_latency_;
+
+  // The time, CPU time, and |frames_decoded_| as of the last report.
+  Clock::time_point last_report_time_;
+  std::clock_t last_report_cpu_time_;
+  int64_t last_report_frames_decoded_ = 0;
+
+  ThreadedDecoder decoder_;
+
+  Alarm decode_alarm_;
+  Alarm report_alarm_;
+
+  // Maximum number of frames in-flight at once. Beyond this, frames are left in
+  // the Receiver's queue until the decoder has caught up.
+  static constexpr int kMaxFramesInFlight = 8;
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STANDALONE_RECEIVER_BENCHMARK_PLAYER_H_
@@ -53,11 +53,17 @@ CastService::CastService(TaskRunner* task_runner,
                          GeneratedCredentials credentials,
                          const std::string& friendly_name,
                          const std::string& model_name,
-                         bool enable_discovery)
+                         bool enable_discovery,
+                         const std::string& capture_path,
+                         bool benchmark_mode)
     : local_endpoint_(DetermineEndpoint(interface)),
       credentials_(std::move(credentials)),
       agent_(task_runner, credentials_.provider.get()),
-      mirroring_application_(task_runner, local_endpoint_.address, &agent_),
+      mirroring_application_(task_runner,
+                             local_endpoint_.address,
+                             &agent_,
+                             capture_path,
+                             benchmark_mode),
       socket_factory_(&agent_, agent_.cast_socket_client()),
       connection_factory_(
           TlsConnectionFactory::CreateFactory(&socket_factory_, task_runner)),
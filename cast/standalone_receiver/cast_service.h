@@ -46,7 +46,9 @@ class CastService final : public discovery::ReportingClient {
               GeneratedCredentials credentials,
               const std::string& friendly_name,
               const std::string& model_name,
-              bool enable_discovery = true);
+              bool enable_discovery = true,
+              const std::string& capture_path = std::string(),
+              bool benchmark_mode = false);
 
   ~CastService() final;
 
@@ -19,6 +19,8 @@ Decoder::Buffer::Buffer() {
 }
 
 Decoder::Buffer::~Buffer() = default;
+Decoder::Buffer::Buffer(Buffer&&) noexcept = default;
+Decoder::Buffer& Decoder::Buffer::operator=(Buffer&&) noexcept = default;
 
 void Decoder::Buffer::Resize(int new_size) {
   const int padded_size = new_size + AV_INPUT_BUFFER_PADDING_SIZE;
@@ -138,6 +140,10 @@ bool Decoder::Initialize() {
   // max here, just to be safe.
   context_->thread_count =
       std::min(std::max<int>(std::thread::hardware_concurrency(), 1), 8);
+  // Let FFMPEG choose frame-level threading where the codec supports it, and
+  // slice-level threading otherwise. Frame threading delays the output by up to
+  // |thread_count| - 1 frames, which the player's pipeline has room for.
+  context_->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
   const int open_result = avcodec_open2(context_.get(), codec_, nullptr);
   if (open_result < 0) {
     HandleInitializationError("failed to open codec", open_result);
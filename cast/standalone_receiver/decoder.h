@@ -26,6 +26,8 @@ class Decoder {
    public:
     Buffer();
     ~Buffer();
+    Buffer(Buffer&& other) noexcept;
+    Buffer& operator=(Buffer&& other) noexcept;
 
     void Resize(int new_size);
     absl::Span<const uint8_t> GetSpan() const;
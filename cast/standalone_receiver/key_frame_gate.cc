@@ -0,0 +1,39 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/standalone_receiver/key_frame_gate.h"
+
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+KeyFrameGate::KeyFrameGate(Receiver* receiver, const char* media_type)
+    : receiver_(receiver), media_type_(media_type) {
+  OSP_DCHECK(receiver_);
+  OSP_DCHECK(media_type_);
+}
+
+KeyFrameGate::~KeyFrameGate() = default;
+
+bool KeyFrameGate::ShouldDecode(const EncodedFrame& frame) {
+  if (is_awaiting_key_frame_) {
+    if (frame.dependency != EncodedFrame::KEY_FRAME) {
+      return false;
+    }
+    is_awaiting_key_frame_ = false;
+  }
+  return true;
+}
+
+void KeyFrameGate::OnDecoderFellBehind(FrameId frame_id) {
+  OSP_LOG_WARN << "Requesting " << media_type_
+               << " key frame because the decoder has fallen behind at "
+               << frame_id;
+  is_awaiting_key_frame_ = true;
+  receiver_->RequestKeyFrame();
+}
+
+}  // namespace cast
+}  // namespace openscreen
@@ -0,0 +1,45 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STANDALONE_RECEIVER_KEY_FRAME_GATE_H_
+#define CAST_STANDALONE_RECEIVER_KEY_FRAME_GATE_H_
+
+#include "cast/streaming/encoded_frame.h"
+#include "cast/streaming/frame_id.h"
+#include "cast/streaming/receiver.h"
+
+namespace openscreen {
+namespace cast {
+
+// Shared by the players to recover when the decoder falls too far behind to
+// accept a frame: that frame is dropped, a key frame is requested from the
+// Receiver, and everything up to the key frame is dropped too, since the
+// decoder would be unable to make sense of it.
+class KeyFrameGate {
+ public:
+  // |media_type| should be "audio" or "video" (only used when logging).
+  KeyFrameGate(Receiver* receiver, const char* media_type);
+  ~KeyFrameGate();
+
+  // Returns false if |frame| must be dropped because it comes before the
+  // awaited key frame.
+  bool ShouldDecode(const EncodedFrame& frame);
+
+  // Called when the decoder refused |frame_id|: requests a key frame, and
+  // drops frames until it arrives.
+  void OnDecoderFellBehind(FrameId frame_id);
+
+ private:
+  Receiver* const receiver_;
+  const char* const media_type_;
+
+  // Set when a frame had to be dropped because the decoder fell too far
+  // behind. No frames can be decoded until the next key frame arrives.
+  bool is_awaiting_key_frame_ = false;
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STANDALONE_RECEIVER_KEY_FRAME_GATE_H_
@@ -62,6 +62,18 @@ options:
 
     -m, --model-name: Model name to be used for device discovery.
 
+    -c, --capture=path-to-file: Capture all RTP/RTCP packets of the streaming
+                                session to the given file, for later replay
+                                with the cast_streaming_replay tool. The file
+                                is overwritten by each new session, and
+                                contains the session's encryption keys.
+
+    -b, --benchmark: Decode the media, but discard it instead of playing it
+                     out, and periodically log the decode rate, latency, late
+                     frames, and CPU time per frame. This does not require a
+                     display, so it can be used to benchmark receiver capacity
+                     on headless machines.
+
     -t, --tracing: Enable performance tracing logging.
 
     -v, --verbose: Enable verbose logging.
@@ -100,12 +112,15 @@ void RunCastService(TaskRunnerImpl* task_runner,
                     GeneratedCredentials creds,
                     const std::string& friendly_name,
                     const std::string& model_name,
-                    bool discovery_enabled) {
+                    bool discovery_enabled,
+                    const std::string& capture_path,
+                    bool benchmark_mode) {
   std::unique_ptr<CastService> service;
   task_runner->PostTask([&] {
     service = std::make_unique<CastService>(task_runner, interface,
                                             std::move(creds), friendly_name,
-                                            model_name, discovery_enabled);
+                                            model_name, discovery_enabled,
+                                            capture_path, benchmark_mode);
   });
 
   OSP_LOG_INFO << "CastService is running. CTRL-C (SIGINT), or send a "
@@ -142,6 +157,8 @@ int RunStandaloneReceiver(int argc, char* argv[]) {
       {"generate-credentials", no_argument, nullptr, 'g'},
       {"friendly-name", required_argument, nullptr, 'f'},
       {"model-name", required_argument, nullptr, 'm'},
+      {"capture", required_argument, nullptr, 'c'},
+      {"benchmark", no_argument, nullptr, 'b'},
       {"tracing", no_argument, nullptr, 't'},
       {"verbose", no_argument, nullptr, 'v'},
       {"help", no_argument, nullptr, 'h'},
@@ -157,10 +174,12 @@ int RunStandaloneReceiver(int argc, char* argv[]) {
   std::string developer_certificate_path;
   std::string friendly_name = "Cast Standalone Receiver";
   std::string model_name = "cast_standalone_receiver";
+  std::string capture_path;
+  bool benchmark_mode = false;
   bool should_generate_credentials = false;
   std::unique_ptr<TextTraceLoggingPlatform> trace_logger;
   int ch = -1;
-  while ((ch = getopt_long(argc, argv, "p:d:f:m:gtvhx", kArgumentOptions,
+  while ((ch = getopt_long(argc, argv, "p:d:f:m:c:bgtvhx", kArgumentOptions,
                            nullptr)) != -1) {
     switch (ch) {
       case 'p':
@@ -175,6 +194,12 @@ int RunStandaloneReceiver(int argc, char* argv[]) {
       case 'm':
         model_name = optarg;
         break;
+      case 'c':
+        capture_path = optarg;
+        break;
+      case 'b':
+        benchmark_mode = true;
+        break;
       case 'g':
         should_generate_credentials = true;
         break;
@@ -233,7 +258,8 @@ int RunStandaloneReceiver(int argc, char* argv[]) {
   PlatformClientPosix::Create(milliseconds(50),
                               std::unique_ptr<TaskRunnerImpl>(task_runner));
   RunCastService(task_runner, interface, std::move(creds.value()),
-                 friendly_name, model_name, discovery_enabled);
+                 friendly_name, model_name, discovery_enabled, capture_path,
+                 benchmark_mode);
   PlatformClientPosix::ShutDown();
 
   return 0;
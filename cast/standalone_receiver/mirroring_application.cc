@@ -4,9 +4,12 @@
 
 #include "cast/standalone_receiver/mirroring_application.h"
 
+#include <utility>
+
 #include "cast/common/public/message_port.h"
 #include "cast/streaming/environment.h"
 #include "cast/streaming/message_fields.h"
+#include "cast/streaming/packet_capture.h"
 #include "cast/streaming/receiver_session.h"
 #include "platform/api/task_runner.h"
 #include "util/osp_logging.h"
@@ -22,11 +25,15 @@ const char kRemotingRpcNamespace[] = "urn:x-cast:com.google.cast.remoting";
 
 MirroringApplication::MirroringApplication(TaskRunner* task_runner,
                                            const IPAddress& interface_address,
-                                           ApplicationAgent* agent)
+                                           ApplicationAgent* agent,
+                                           std::string capture_path,
+                                           bool benchmark_mode)
     : task_runner_(task_runner),
       interface_address_(interface_address),
       app_ids_({kMirroringAppId, kMirroringAudioOnlyAppId}),
-      agent_(agent) {
+      agent_(agent),
+      capture_path_(std::move(capture_path)),
+      benchmark_mode_(benchmark_mode) {
   OSP_DCHECK(task_runner_);
   OSP_DCHECK(agent_);
   agent_->RegisterApplication(this);
@@ -53,11 +60,28 @@ bool MirroringApplication::Launch(const std::string& app_id,
   environment_ = std::make_unique<Environment>(
       &Clock::now, task_runner_,
       IPEndpoint{interface_address_, kDefaultCastStreamingPort});
-  controller_ =
-      std::make_unique<StreamingPlaybackController>(task_runner_, this);
+  if (!capture_path_.empty()) {
+    ErrorOr<std::unique_ptr<PacketCaptureWriter>> writer =
+        PacketCaptureWriter::Create(capture_path_.c_str());
+    if (writer.is_value()) {
+      capture_writer_ = std::move(writer.value());
+      environment_->SetPacketObserver(capture_writer_.get());
+      OSP_LOG_INFO << "[MirroringApplication] Capturing packets to "
+                   << capture_path_;
+    } else {
+      OSP_LOG_ERROR << "[MirroringApplication] Not capturing packets: "
+                    << writer.error();
+    }
+  }
+  controller_ = std::make_unique<StreamingPlaybackController>(
+      task_runner_, this, benchmark_mode_);
   current_session_ = std::make_unique<ReceiverSession>(
       controller_.get(), environment_.get(), message_port,
-      ReceiverSession::Preferences{});
+      // FFMPEG decodes VP9 as well, so prefer it over VP8 when a sender offers
+      // both, since it produces better quality at the same bitrate.
+      ReceiverSession::Preferences{
+          {VideoCodec::kVp9, VideoCodec::kVp8, VideoCodec::kH264},
+          {AudioCodec::kOpus, AudioCodec::kAac}});
   return true;
 }
 
@@ -76,6 +100,13 @@ std::vector<std::string> MirroringApplication::GetSupportedNamespaces() {
 void MirroringApplication::Stop() {
   current_session_.reset();
   controller_.reset();
+  if (capture_writer_) {
+    environment_->SetPacketObserver(nullptr);
+    OSP_LOG_INFO << "[MirroringApplication] Captured "
+                 << capture_writer_->num_packets_written() << " packets to "
+                 << capture_path_;
+    capture_writer_.reset();
+  }
   environment_.reset();
   wake_lock_.reset();
 }
@@ -23,6 +23,7 @@ class TaskRunner;
 namespace cast {
 
 class MessagePort;
+class PacketCaptureWriter;
 class ReceiverSession;
 
 // Implements a basic Cast V2 Mirroring Application which, at launch time,
@@ -31,9 +32,15 @@ class ReceiverSession;
 class MirroringApplication final : public ApplicationAgent::Application,
                                    public StreamingPlaybackController::Client {
  public:
+  // If |capture_path| is not empty, all RTP/RTCP packets of each session are
+  // captured to that file (see PacketCaptureWriter), overwriting the capture
+  // of any prior session. If |benchmark_mode| is true, the media is decoded and
+  // measured, but not played out (see BenchmarkPlayer).
   MirroringApplication(TaskRunner* task_runner,
                        const IPAddress& interface_address,
-                       ApplicationAgent* agent);
+                       ApplicationAgent* agent,
+                       std::string capture_path = std::string(),
+                       bool benchmark_mode = false);
 
   ~MirroringApplication() final;
 
@@ -56,9 +63,12 @@ class MirroringApplication final : public ApplicationAgent::Application,
   const IPAddress interface_address_;
   const std::vector<std::string> app_ids_;
   ApplicationAgent* const agent_;
+  const std::string capture_path_;
+  const bool benchmark_mode_;
 
   SerialDeletePtr<ScopedWakeLock> wake_lock_;
   std::unique_ptr<Environment> environment_;
+  std::unique_ptr<PacketCaptureWriter> capture_writer_;
   std::unique_ptr<StreamingPlaybackController> controller_;
   std::unique_ptr<ReceiverSession> current_session_;
 };
@@ -4,6 +4,9 @@
 
 #include "cast/standalone_receiver/sdl_audio_player.h"
 
+#include <string.h>
+
+#include <algorithm>
 #include <chrono>
 #include <sstream>
 #include <utility>
@@ -23,6 +26,23 @@ namespace {
 constexpr char kAudioMediaType[] = "audio";
 constexpr SDL_AudioFormat kSDLAudioFormatUnknown = 0;
 
+// The minimum duration of the SDL audio device's buffer. Smaller buffers mean
+// less latency, but a greater risk of glitches if the audio thread is delayed.
+constexpr auto kMinDeviceBufferDuration = milliseconds(10);
+
+// How far ahead of the audio callback to write the samples of each frame, to
+// allow for jitter in when Present() gets run.
+constexpr auto kWriteAheadMargin = milliseconds(5);
+
+// The capacity of the ring between Present() and the audio callback. This is
+// far more than is normally buffered, to absorb an occasional long delay in
+// the audio callback.
+constexpr auto kRingDuration = milliseconds(250);
+
+// If the device clock indicates a frame would play out more than this amount
+// early or late, samples are inserted or dropped to correct it.
+constexpr auto kMaxAudioDrift = milliseconds(15);
+
 bool SDLAudioSpecsAreDifferent(const SDL_AudioSpec& a, const SDL_AudioSpec& b) {
   return a.freq != b.freq || a.format != b.format || a.channels != b.channels ||
          a.samples != b.samples;
@@ -62,7 +82,8 @@ SDLAudioPlayer::SDLAudioPlayer(ClockNowFunctionPtr now_function,
                     receiver,
                     CodecToString(codec),
                     std::move(error_callback),
-                    kAudioMediaType) {}
+                    kAudioMediaType),
+      now_(now_function) {}
 
 SDLAudioPlayer::~SDLAudioPlayer() {
   if (device_ > 0) {
@@ -104,20 +125,23 @@ ErrorOr<Clock::time_point> SDLAudioPlayer::RenderNextFrame(
   // be updated to match |pending_audio_spec_| later, in Present().
   if (SDLAudioSpecsAreDifferent(device_spec_, pending_audio_spec_)) {
     // Find the smallest power-of-two number of samples that represents at least
-    // 20ms of audio.
-    constexpr auto kMinBufferDuration = milliseconds(20);
+    // kMinDeviceBufferDuration of audio.
     constexpr auto kOneSecond = seconds(1);
     const auto required_samples = static_cast<int>(
-        pending_audio_spec_.freq * kMinBufferDuration / kOneSecond);
+        pending_audio_spec_.freq * kMinDeviceBufferDuration / kOneSecond);
     OSP_DCHECK_GE(required_samples, 1);
     pending_audio_spec_.samples = 1 << av_log2(required_samples);
     if (pending_audio_spec_.samples < required_samples) {
       pending_audio_spec_.samples *= 2;
     }
 
+    // The samples for a given moment in time are pulled by the audio callback
+    // about one device buffer ahead of time, so they must have been written to
+    // the ring just before that.
     approximate_lead_time_ =
         (pending_audio_spec_.samples * Clock::to_duration(kOneSecond)) /
-        pending_audio_spec_.freq;
+            pending_audio_spec_.freq +
+        kWriteAheadMargin;
   }
 
   // If the decoded audio is in planar format, interleave it for SDL.
@@ -153,12 +177,13 @@ ErrorOr<Clock::time_point> SDLAudioPlayer::RenderNextFrame(
     }
     pending_audio_ = absl::Span<const uint8_t>(frame.data[0], byte_count);
   }
+  pending_presentation_time_ = next_frame.presentation_time;
 
   // SDL provides no way to query the actual lead time before audio samples will
   // be output by the sound hardware. The only advice seems to be a quick
   // comment about "the intent is double buffered audio." Thus, schedule the
-  // "push" of this data to happen such that the audio will be playing out of
-  // the hardware at the intended moment in time.
+  // write of this data to happen just before the audio callback will pull it.
+  // Any remaining error is measured and corrected in WritePendingAudio().
   return next_frame.presentation_time - approximate_lead_time_;
 }
 
@@ -170,37 +195,140 @@ bool SDLAudioPlayer::RenderWhileIdle(const PresentableFrame* frame) {
 void SDLAudioPlayer::Present() {
   TRACE_DEFAULT_SCOPED(TraceCategory::kStandaloneReceiver);
   if (state() != kScheduledToPresent) {
-    // In all other states, just do nothing. The SDL audio buffer will underrun
-    // and result in silence.
+    // In all other states, just do nothing. The audio callback will run out of
+    // samples, and play silence.
     return;
   }
 
   // Re-open audio device, if the audio format has changed.
-  if (SDLAudioSpecsAreDifferent(pending_audio_spec_, device_spec_)) {
-    if (device_ > 0) {
-      SDL_CloseAudioDevice(device_);
-      device_spec_ = SDL_AudioSpec{};
-    }
+  if (SDLAudioSpecsAreDifferent(pending_audio_spec_, device_spec_) &&
+      !ReopenAudioDevice()) {
+    return;
+  }
 
-    device_ = SDL_OpenAudioDevice(nullptr,  // Pick default device.
-                                  0,        // For playback, not recording.
-                                  &pending_audio_spec_,  // Desired format.
-                                  &device_spec_,  // [output] Obtained format.
-                                  0  // Disallow formats other than desired.
-    );
-    if (device_ <= 0) {
-      std::ostringstream error;
-      error << "SDL_OpenAudioDevice failed: " << SDL_GetError();
-      OnFatalError(error.str());
-      return;
-    }
-    OSP_DCHECK(!SDLAudioSpecsAreDifferent(pending_audio_spec_, device_spec_));
+  WritePendingAudio();
+}
+
+bool SDLAudioPlayer::ReopenAudioDevice() {
+  // Closing the device also waits for any in-progress audio callback to
+  // complete. After that, the callback will not be running, and so the
+  // |device_spec_|, |ring_|, etc. can be safely changed.
+  if (device_ > 0) {
+    SDL_CloseAudioDevice(device_);
+    device_ = 0;
+    device_spec_ = SDL_AudioSpec{};
+  }
 
-    constexpr int kSdlResumePlaybackCommand = 0;
-    SDL_PauseAudioDevice(device_, kSdlResumePlaybackCommand);
+  const int bytes_per_frame =
+      SDL_AUDIO_BITSIZE(pending_audio_spec_.format) / 8 *
+      pending_audio_spec_.channels;
+  const int bytes_per_second = pending_audio_spec_.freq * bytes_per_frame;
+  ring_ = std::make_unique<AudioRingBuffer>(static_cast<int>(
+      bytes_per_second * kRingDuration / Clock::to_duration(seconds(1))));
+  device_clock_origin_.store(kNoDeviceClock);
+
+  pending_audio_spec_.callback = &SDLAudioPlayer::OnAudioDeviceCallback;
+  pending_audio_spec_.userdata = this;
+  device_ = SDL_OpenAudioDevice(nullptr,  // Pick default device.
+                                0,        // For playback, not recording.
+                                &pending_audio_spec_,  // Desired format.
+                                &device_spec_,  // [output] Obtained format.
+                                0  // Disallow formats other than desired.
+  );
+  if (device_ <= 0) {
+    device_spec_ = SDL_AudioSpec{};
+    std::ostringstream error;
+    error << "SDL_OpenAudioDevice failed: " << SDL_GetError();
+    OnFatalError(error.str());
+    return false;
   }
+  OSP_DCHECK(!SDLAudioSpecsAreDifferent(pending_audio_spec_, device_spec_));
+  device_bytes_per_frame_ = bytes_per_frame;
+  device_buffer_duration_ =
+      (device_spec_.samples * Clock::to_duration(seconds(1))) /
+      device_spec_.freq;
+
+  constexpr int kSdlResumePlaybackCommand = 0;
+  SDL_PauseAudioDevice(device_, kSdlResumePlaybackCommand);
+  return true;
+}
+
+void SDLAudioPlayer::WritePendingAudio() {
+  absl::Span<const uint8_t> audio = pending_audio_;
+
+  // Determine when the first of the pending samples would be played out, and
+  // how far that is from when they are supposed to be. Nothing can be known
+  // until the audio callback has run at least once.
+  const Clock::rep origin = device_clock_origin_.load();
+  if (origin != kNoDeviceClock) {
+    const Clock::time_point play_out_time =
+        Clock::time_point(Clock::duration(origin)) +
+        BytesToDuration(ring_->write_position());
+    const Clock::duration drift = play_out_time - pending_presentation_time_;
+    OSP_DVLOG << "Audio latency: "
+              << to_milliseconds(play_out_time - now_()).count()
+              << " ms, drift: " << to_milliseconds(drift).count() << " ms";
+
+    if (drift > kMaxAudioDrift) {
+      // The audio would play out late: Catch up by skipping samples.
+      const int skip_bytes = std::min(DurationToBytes(drift),
+                                      static_cast<int>(audio.size()));
+      OSP_LOG_INFO << "Audio is " << to_milliseconds(drift).count()
+                   << " ms late. Dropping " << skip_bytes << " bytes.";
+      audio.remove_prefix(skip_bytes);
+    } else if (drift < -kMaxAudioDrift) {
+      // The audio would play out early: Wait by inserting silence.
+      const int silence_bytes = DurationToBytes(-drift);
+      OSP_LOG_INFO << "Audio is " << to_milliseconds(-drift).count()
+                   << " ms early. Inserting " << silence_bytes
+                   << " bytes of silence.";
+      ring_->WriteFill(device_spec_.silence, silence_bytes);
+    }
+  }
+
+  const int bytes_written = ring_->Write(audio);
+  OSP_LOG_IF(WARN, bytes_written < static_cast<int>(audio.size()))
+      << "Audio ring overflowed. Dropped "
+      << (audio.size() - bytes_written) << " bytes.";
+}
 
-  SDL_QueueAudio(device_, pending_audio_.data(), pending_audio_.size());
+Clock::duration SDLAudioPlayer::BytesToDuration(int64_t bytes) const {
+  const double seconds_of_audio =
+      static_cast<double>(bytes) / device_bytes_per_frame_ / device_spec_.freq;
+  return std::chrono::duration_cast<Clock::duration>(
+      std::chrono::duration<double>(seconds_of_audio));
+}
+
+int SDLAudioPlayer::DurationToBytes(Clock::duration duration) const {
+  // Only whole sample frames (i.e., one sample for every channel) may be
+  // dropped or inserted, or the channels would be swapped around.
+  const int64_t frames =
+      duration * device_spec_.freq / Clock::to_duration(seconds(1));
+  return static_cast<int>(frames * device_bytes_per_frame_);
+}
+
+// static
+void SDLAudioPlayer::OnAudioDeviceCallback(void* userdata,
+                                           uint8_t* stream,
+                                           int length) {
+  auto* const player = static_cast<SDLAudioPlayer*>(userdata);
+
+  // The samples handed over now will be played out after those already in the
+  // device's buffer. From that, and the ring's read position, infer when the
+  // byte at position zero would have been played out.
+  const int64_t read_position = player->ring_->read_position();
+  const Clock::time_point play_out_time =
+      player->now_() + player->device_buffer_duration_;
+  player->device_clock_origin_.store(
+      (play_out_time - player->BytesToDuration(read_position))
+          .time_since_epoch()
+          .count());
+
+  // Fill any shortfall with silence.
+  const int bytes_read =
+      player->ring_->Read(absl::Span<uint8_t>(stream, length));
+  memset(stream + bytes_read, player->device_spec_.silence,
+         length - bytes_read);
 }
 
 // static
@@ -230,5 +358,8 @@ SDL_AudioFormat SDLAudioPlayer::GetSDLAudioFormat(AVSampleFormat format) {
   return kSDLAudioFormatUnknown;
 }
 
+// static
+constexpr Clock::rep SDLAudioPlayer::kNoDeviceClock;
+
 }  // namespace cast
 }  // namespace openscreen
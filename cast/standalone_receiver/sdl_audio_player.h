@@ -5,9 +5,15 @@
 #ifndef CAST_STANDALONE_RECEIVER_SDL_AUDIO_PLAYER_H_
 #define CAST_STANDALONE_RECEIVER_SDL_AUDIO_PLAYER_H_
 
+#include <stdint.h>
+
+#include <atomic>
+#include <limits>
+#include <memory>
 #include <string>
 #include <vector>
 
+#include "cast/standalone_receiver/audio_ring_buffer.h"
 #include "cast/standalone_receiver/sdl_player_base.h"
 
 namespace openscreen {
@@ -15,6 +21,13 @@ namespace cast {
 
 // Consumes frames from a Receiver, decodes them, and renders them to an
 // internally-owned SDL audio device.
+//
+// Decoded audio is written to a lock-free ring, which the SDL audio callback
+// pulls from on the audio device's own thread. The callback also tracks the
+// device's clock, so that each frame's samples can be checked against the
+// frame's presentation time as they are written. Any drift is then corrected by
+// dropping samples or inserting silence, which keeps the amount of buffered
+// audio to a few milliseconds beyond the device's own buffer.
 class SDLAudioPlayer final : public SDLPlayerBase {
  public:
   // |error_callback| is run only if a fatal error occurs, at which point the
@@ -34,9 +47,30 @@ class SDLAudioPlayer final : public SDLPlayerBase {
   bool RenderWhileIdle(const SDLPlayerBase::PresentableFrame* frame) final;
   void Present() final;
 
+  // Re-opens the SDL audio device with the |pending_audio_spec_|. Returns false
+  // if this failed (and OnFatalError() was called).
+  bool ReopenAudioDevice();
+
+  // Writes the |pending_audio_| to the |ring_|, first dropping samples or
+  // inserting silence to correct for any drift between the device clock and
+  // the intended presentation time.
+  void WritePendingAudio();
+
+  // Converts between a byte count and a duration of audio at the device's
+  // sample rate.
+  Clock::duration BytesToDuration(int64_t bytes) const;
+  int DurationToBytes(Clock::duration duration) const;
+
+  // Called by SDL, on its audio thread, whenever the device needs more samples.
+  static void SDLCALL OnAudioDeviceCallback(void* userdata,
+                                            uint8_t* stream,
+                                            int length);
+
   // Maps an AVSampleFormat enum to the SDL_AudioFormat equivalent.
   static SDL_AudioFormat GetSDLAudioFormat(AVSampleFormat format);
 
+  const ClockNowFunctionPtr now_;
+
   // The audio format determined by the last call to RenderCurrentFrame().
   SDL_AudioSpec pending_audio_spec_{};
 
@@ -48,14 +82,32 @@ class SDLAudioPlayer final : public SDLPlayerBase {
   // interleaved conversion.
   std::vector<uint8_t> interleaved_audio_buffer_;
 
-  // Points to the memory containing the next chunk of interleaved audio.
+  // Points to the memory containing the next chunk of interleaved audio, and
+  // the time at which it should begin playing out.
   absl::Span<const uint8_t> pending_audio_;
+  Clock::time_point pending_presentation_time_{};
 
   // The currently-open SDL audio device (or zero, if not open).
   SDL_AudioDeviceID device_ = 0;
 
-  // The audio format being used by the currently-open SDL audio device.
+  // The audio format being used by the currently-open SDL audio device, and
+  // some values derived from it. These only change while the device is closed,
+  // and so may be read by the audio callback without synchronization.
   SDL_AudioSpec device_spec_{};
+  int device_bytes_per_frame_ = 0;  // Bytes per sample, times channels.
+  Clock::duration device_buffer_duration_{};
+
+  // Holds the audio written by Present(), until the audio callback pulls it.
+  // Re-created whenever the device is re-opened.
+  std::unique_ptr<AudioRingBuffer> ring_;
+
+  // The device clock, as observed by the audio callback: the (estimated) time
+  // at which the byte at |ring_| position zero was, or would have been, played
+  // out. Every other byte's play-out time follows from its position. Set to
+  // kNoDeviceClock until the first callback after the device is opened.
+  std::atomic<Clock::rep> device_clock_origin_{kNoDeviceClock};
+  static constexpr Clock::rep kNoDeviceClock =
+      std::numeric_limits<Clock::rep>::min();
 };
 
 }  // namespace cast
@@ -30,7 +30,8 @@ SDLPlayerBase::SDLPlayerBase(ClockNowFunctionPtr now_function,
       receiver_(receiver),
       error_callback_(std::move(error_callback)),
       media_type_(media_type),
-      decoder_(codec_name),
+      key_frame_gate_(receiver, media_type),
+      decoder_(task_runner, codec_name),
       decode_alarm_(now_, task_runner),
       render_alarm_(now_, task_runner),
       presentation_alarm_(now_, task_runner) {
@@ -101,8 +102,13 @@ void SDLPlayerBase::OnFramesReady(int buffer_size) {
 
   // Consume the next frame.
   const Clock::time_point start_time = now_();
-  buffer_.Resize(buffer_size);
-  EncodedFrame frame = receiver_->ConsumeNextFrame(buffer_.GetSpan());
+  Decoder::Buffer buffer = decoder_.TakeBuffer();
+  buffer.Resize(buffer_size);
+  EncodedFrame frame = receiver_->ConsumeNextFrame(buffer.GetSpan());
+
+  if (!key_frame_gate_.ShouldDecode(frame)) {
+    return;
+  }
 
   // Create the tracking state for the frame in the player pipeline.
   OSP_DCHECK_EQ(frames_to_render_.count(frame.frame_id), 0);
@@ -111,9 +117,13 @@ void SDLPlayerBase::OnFramesReady(int buffer_size) {
 
   pending_frame.presentation_time = ResyncAndDeterminePresentationTime(frame);
 
-  // Start decoding the frame. This call may synchronously call back into the
-  // AVCodecDecoder::Client methods in this class.
-  decoder_.Decode(frame.frame_id, buffer_);
+  // Hand off the frame for decoding. The results will be delivered later, via
+  // the Decoder::Client methods in this class. If the decoder has fallen too
+  // far behind, drop the frame and catch up from the next key frame instead.
+  if (!decoder_.Decode(frame.frame_id, std::move(buffer))) {
+    frames_to_render_.erase(frame.frame_id);
+    key_frame_gate_.OnDecoderFellBehind(frame.frame_id);
+  }
 }
 
 void SDLPlayerBase::OnFrameDecoded(FrameId frame_id, const AVFrame& frame) {
@@ -12,7 +12,9 @@
 #include <string>
 
 #include "cast/standalone_receiver/decoder.h"
+#include "cast/standalone_receiver/key_frame_gate.h"
 #include "cast/standalone_receiver/sdl_glue.h"
+#include "cast/standalone_receiver/threaded_decoder.h"
 #include "cast/streaming/message_fields.h"
 #include "cast/streaming/receiver.h"
 #include "platform/api/task_runner.h"
@@ -22,9 +24,10 @@
 namespace openscreen {
 namespace cast {
 
-// Common base class that consumes frames from a Receiver, decodes them, and
-// plays them out via the appropriate SDL subsystem. Subclasses implement the
-// specifics, based on the type of media (audio or video).
+// Common base class that consumes frames from a Receiver, decodes them (on a
+// separate thread), and plays them out via the appropriate SDL subsystem.
+// Subclasses implement the specifics, based on the type of media (audio or
+// video).
 class SDLPlayerBase : public Receiver::Consumer, public Decoder::Client {
  public:
   ~SDLPlayerBase() override;
@@ -103,8 +106,8 @@ class SDLPlayerBase : public Receiver::Consumer, public Decoder::Client {
   Clock::time_point ResyncAndDeterminePresentationTime(
       const EncodedFrame& frame);
 
-  // AVCodecDecoder::Client implementation. These are called-back from
-  // |decoder_| to provide results.
+  // Decoder::Client implementation. These are called-back from |decoder_|, on
+  // the TaskRunner thread, to provide results.
   void OnFrameDecoded(FrameId frame_id, const AVFrame& frame) final;
   void OnDecodeError(FrameId frame_id, std::string message) final;
 
@@ -143,8 +146,9 @@ class SDLPlayerBase : public Receiver::Consumer, public Decoder::Client {
 
   std::map<FrameId, PendingFrame> frames_to_render_;
 
-  // Buffer for holding EncodedFrame::data.
-  Decoder::Buffer buffer_;
+  // Drops frames after the decoder has fallen too far behind, until the next
+  // key frame arrives.
+  KeyFrameGate key_frame_gate_;
 
   // Associates a RTP timestamp with a local clock time point. This is updated
   // whenever the media (RTP) timestamps drift too much away from the rate at
@@ -152,7 +156,7 @@ class SDLPlayerBase : public Receiver::Consumer, public Decoder::Client {
   RtpTimeTicks last_sync_rtp_timestamp_{};
   Clock::time_point last_sync_reference_time_{};
 
-  Decoder decoder_;
+  ThreadedDecoder decoder_;
 
   // The decoded frame to be rendered/presented.
   PendingFrame current_frame_;
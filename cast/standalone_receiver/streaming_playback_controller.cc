@@ -4,9 +4,11 @@
 
 #include "cast/standalone_receiver/streaming_playback_controller.h"
 
+#include <chrono>
 #include <string>
 
 #if defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
+#include "cast/standalone_receiver/benchmark_player.h"
 #include "cast/standalone_receiver/sdl_audio_player.h"
 #include "cast/standalone_receiver/sdl_glue.h"
 #include "cast/standalone_receiver/sdl_video_player.h"
@@ -14,24 +16,62 @@
 #include "cast/standalone_receiver/dummy_player.h"
 #endif  // defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
 
+#include "util/osp_logging.h"
 #include "util/trace_logging.h"
 
 namespace openscreen {
 namespace cast {
 
+namespace {
+
+// How often to log the frame pipeline statistics of each Receiver.
+constexpr std::chrono::seconds kStatsLoggingInterval{10};
+
+void LogStatsForReceiver(const char* name, const Receiver& receiver) {
+  const ReceiverStats stats = receiver.GetStats();
+  OSP_LOG_INFO << name << " frames: " << stats.frames_completed
+               << " completed, " << stats.frames_consumed << " consumed ("
+               << stats.frames_consumed_late << " late), "
+               << stats.frames_dropped << " dropped; NACKs: "
+               << stats.nacks_sent << " sent, " << stats.packets_recovered
+               << " packets recovered; completion time (µs): p50="
+               << stats.frame_completion_time.p50
+               << " p95=" << stats.frame_completion_time.p95
+               << " p99=" << stats.frame_completion_time.p99
+               << " max=" << stats.frame_completion_time.max
+               << "; decrypt time (µs): p50=" << stats.decrypt_time.p50
+               << " p99=" << stats.decrypt_time.p99;
+}
+
+}  // namespace
+
 #if defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
 StreamingPlaybackController::StreamingPlaybackController(
     TaskRunner* task_runner,
-    StreamingPlaybackController::Client* client)
+    StreamingPlaybackController::Client* client,
+    bool benchmark_mode)
     : task_runner_(task_runner),
       client_(client),
-      sdl_event_loop_(task_runner_, [this] {
+      stats_alarm_(&Clock::now, task_runner_),
+      benchmark_mode_(benchmark_mode) {
+  OSP_DCHECK(task_runner_ != nullptr);
+  OSP_DCHECK(client_ != nullptr);
+  if (benchmark_mode_) {
+    OSP_LOG_INFO << "Running in benchmark mode: Media will be decoded, but not "
+                    "played out.";
+    return;
+  }
+
+  sdl_audio_sub_system_ =
+      std::make_unique<ScopedSDLSubSystem<SDL_INIT_AUDIO>>();
+  sdl_video_sub_system_ =
+      std::make_unique<ScopedSDLSubSystem<SDL_INIT_VIDEO>>();
+  sdl_event_loop_ =
+      std::make_unique<SDLEventLoopProcessor>(task_runner_, [this] {
         client_->OnPlaybackError(this,
                                  Error{Error::Code::kOperationCancelled,
                                        std::string("SDL event loop closed.")});
-      }) {
-  OSP_DCHECK(task_runner_ != nullptr);
-  OSP_DCHECK(client_ != nullptr);
+      });
   constexpr int kDefaultWindowWidth = 1280;
   constexpr int kDefaultWindowHeight = 720;
   window_ = MakeUniqueSDLWindow(
@@ -46,10 +86,16 @@ StreamingPlaybackController::StreamingPlaybackController(
 #else
 StreamingPlaybackController::StreamingPlaybackController(
     TaskRunner* task_runner,
-    StreamingPlaybackController::Client* client)
-    : task_runner_(task_runner), client_(client) {
+    StreamingPlaybackController::Client* client,
+    bool benchmark_mode)
+    : task_runner_(task_runner),
+      client_(client),
+      stats_alarm_(&Clock::now, task_runner_) {
   OSP_DCHECK(task_runner_ != nullptr);
   OSP_DCHECK(client_ != nullptr);
+  OSP_LOG_IF(WARN, benchmark_mode)
+      << "Benchmark mode requires FFMPEG, which this build does not have. "
+         "Frames will be consumed, but not decoded.";
 }
 #endif  // defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
 
@@ -58,19 +104,42 @@ void StreamingPlaybackController::OnMirroringNegotiated(
     ReceiverSession::ConfiguredReceivers receivers) {
   TRACE_DEFAULT_SCOPED(TraceCategory::kStandaloneReceiver);
 #if defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
-  if (receivers.audio_receiver) {
-    audio_player_ = std::make_unique<SDLAudioPlayer>(
-        &Clock::now, task_runner_, receivers.audio_receiver,
-        receivers.audio_config.codec, [this] {
-          client_->OnPlaybackError(this, audio_player_->error_status());
-        });
-  }
-  if (receivers.video_receiver) {
-    video_player_ = std::make_unique<SDLVideoPlayer>(
-        &Clock::now, task_runner_, receivers.video_receiver,
-        receivers.video_config.codec, renderer_.get(), [this] {
-          client_->OnPlaybackError(this, video_player_->error_status());
-        });
+  if (benchmark_mode_) {
+    if (receivers.audio_receiver) {
+      audio_benchmark_player_ = std::make_unique<BenchmarkPlayer>(
+          &Clock::now, task_runner_, receivers.audio_receiver,
+          CodecToString(receivers.audio_config.codec),
+          [this] {
+            client_->OnPlaybackError(this,
+                                     audio_benchmark_player_->error_status());
+          },
+          "audio");
+    }
+    if (receivers.video_receiver) {
+      video_benchmark_player_ = std::make_unique<BenchmarkPlayer>(
+          &Clock::now, task_runner_, receivers.video_receiver,
+          CodecToString(receivers.video_config.codec),
+          [this] {
+            client_->OnPlaybackError(this,
+                                     video_benchmark_player_->error_status());
+          },
+          "video");
+    }
+  } else {
+    if (receivers.audio_receiver) {
+      audio_player_ = std::make_unique<SDLAudioPlayer>(
+          &Clock::now, task_runner_, receivers.audio_receiver,
+          receivers.audio_config.codec, [this] {
+            client_->OnPlaybackError(this, audio_player_->error_status());
+          });
+    }
+    if (receivers.video_receiver) {
+      video_player_ = std::make_unique<SDLVideoPlayer>(
+          &Clock::now, task_runner_, receivers.video_receiver,
+          receivers.video_config.codec, renderer_.get(), [this] {
+            client_->OnPlaybackError(this, video_player_->error_status());
+          });
+    }
   }
 #else
   if (receivers.audio_receiver) {
@@ -81,13 +150,46 @@ void StreamingPlaybackController::OnMirroringNegotiated(
     video_player_ = std::make_unique<DummyPlayer>(receivers.video_receiver);
   }
 #endif  // defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
+
+  // Report the frame statistics back to the Sender too, which is harmless for
+  // Senders that do not understand them.
+  audio_receiver_ = receivers.audio_receiver;
+  video_receiver_ = receivers.video_receiver;
+  for (Receiver* receiver : {audio_receiver_, video_receiver_}) {
+    if (receiver) {
+      receiver->SetFrameStatsReportingEnabled(true);
+    }
+  }
+  stats_alarm_.ScheduleFromNow([this] { LogReceiverStats(); },
+                               kStatsLoggingInterval);
 }
 
 void StreamingPlaybackController::OnReceiversDestroying(
     const ReceiverSession* session,
     ReceiversDestroyingReason reason) {
+  LogReceiverStats();
+  stats_alarm_.Cancel();
+  audio_receiver_ = nullptr;
+  video_receiver_ = nullptr;
   audio_player_.reset();
   video_player_.reset();
+#if defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
+  audio_benchmark_player_.reset();
+  video_benchmark_player_.reset();
+#endif  // defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
+}
+
+void StreamingPlaybackController::LogReceiverStats() {
+  if (audio_receiver_) {
+    LogStatsForReceiver("Audio", *audio_receiver_);
+  }
+  if (video_receiver_) {
+    LogStatsForReceiver("Video", *video_receiver_);
+  }
+  if (audio_receiver_ || video_receiver_) {
+    stats_alarm_.ScheduleFromNow([this] { LogReceiverStats(); },
+                                 kStatsLoggingInterval);
+  }
 }
 
 void StreamingPlaybackController::OnError(const ReceiverSession* session,
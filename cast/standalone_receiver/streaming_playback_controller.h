@@ -9,8 +9,10 @@
 
 #include "cast/streaming/receiver_session.h"
 #include "platform/impl/task_runner.h"
+#include "util/alarm.h"
 
 #if defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
+#include "cast/standalone_receiver/benchmark_player.h"
 #include "cast/standalone_receiver/sdl_audio_player.h"
 #include "cast/standalone_receiver/sdl_glue.h"
 #include "cast/standalone_receiver/sdl_video_player.h"
@@ -29,8 +31,12 @@ class StreamingPlaybackController final : public ReceiverSession::Client {
                                  Error error) = 0;
   };
 
+  // If |benchmark_mode| is true, the media is decoded, measured and discarded
+  // by BenchmarkPlayers, instead of being played out via SDL. This allows the
+  // receiver to run without a display.
   StreamingPlaybackController(TaskRunner* task_runner,
-                              StreamingPlaybackController::Client* client);
+                              StreamingPlaybackController::Client* client,
+                              bool benchmark_mode = false);
 
   // ReceiverSession::Client overrides.
   void OnMirroringNegotiated(
@@ -43,21 +49,37 @@ class StreamingPlaybackController final : public ReceiverSession::Client {
   void OnError(const ReceiverSession* session, Error error) override;
 
  private:
+  // Logs the frame pipeline statistics of each Receiver, then schedules the
+  // next call.
+  void LogReceiverStats();
+
   TaskRunner* const task_runner_;
   StreamingPlaybackController::Client* client_;
 
+  // The Receivers for the current session, if any, and the alarm that
+  // periodically dumps their statistics.
+  Receiver* audio_receiver_ = nullptr;
+  Receiver* video_receiver_ = nullptr;
+  Alarm stats_alarm_;
+
 #if defined(CAST_STANDALONE_RECEIVER_HAVE_EXTERNAL_LIBS)
+  const bool benchmark_mode_;
+
   // NOTE: member ordering is important, since the sub systems must be
   // first-constructed, last-destroyed. Make sure any new SDL related
-  // members are added below the sub systems.
-  const ScopedSDLSubSystem<SDL_INIT_AUDIO> sdl_audio_sub_system_;
-  const ScopedSDLSubSystem<SDL_INIT_VIDEO> sdl_video_sub_system_;
-  const SDLEventLoopProcessor sdl_event_loop_;
+  // members are added below the sub systems. None of the SDL members are
+  // created in benchmark mode.
+  std::unique_ptr<ScopedSDLSubSystem<SDL_INIT_AUDIO>> sdl_audio_sub_system_;
+  std::unique_ptr<ScopedSDLSubSystem<SDL_INIT_VIDEO>> sdl_video_sub_system_;
+  std::unique_ptr<SDLEventLoopProcessor> sdl_event_loop_;
 
   SDLWindowUniquePtr window_;
   SDLRendererUniquePtr renderer_;
   std::unique_ptr<SDLAudioPlayer> audio_player_;
   std::unique_ptr<SDLVideoPlayer> video_player_;
+
+  std::unique_ptr<BenchmarkPlayer> audio_benchmark_player_;
+  std::unique_ptr<BenchmarkPlayer> video_benchmark_player_;
 #else
   std::unique_ptr<DummyPlayer> audio_player_;
   std::unique_ptr<DummyPlayer> video_player_;
@@ -0,0 +1,194 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/standalone_receiver/threaded_decoder.h"
+
+#include <utility>
+
+#include "util/chrono_helpers.h"
+#include "util/osp_logging.h"
+#include "util/trace_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+class ThreadedDecoder::Core final : public Decoder::Client {
+ public:
+  Core(TaskRunner* task_runner,
+       std::shared_ptr<SharedState> shared,
+       const std::string& codec_name,
+       const std::atomic<bool>* is_stopping)
+      : task_runner_(task_runner),
+        shared_(std::move(shared)),
+        is_stopping_(is_stopping),
+        decoder_(codec_name) {
+    decoder_.set_client(this);
+  }
+
+  ~Core() final { decoder_.set_client(nullptr); }
+
+  void Decode(Request request) {
+    decoder_.Decode(request.frame_id, request.buffer);
+    // If the pool is already full, the buffer is just freed.
+    shared_->recycled_buffers.TryPush(std::move(request.buffer));
+  }
+
+ private:
+  // Decoder::Client implementation.
+  void OnFrameDecoded(FrameId frame_id, const AVFrame& frame) final {
+    Result result;
+    result.type = Result::kFrameDecoded;
+    result.frame_id = frame_id;
+    // av_frame_clone() does a shallow copy here, incrementing a ref-count on
+    // the memory backing the frame, which the Decoder is about to unref.
+    result.frame = AVFrameUniquePtr(av_frame_clone(&frame));
+    PushResult(std::move(result));
+  }
+
+  void OnDecodeError(FrameId frame_id, std::string message) final {
+    Result result;
+    result.type = Result::kDecodeError;
+    result.frame_id = frame_id;
+    result.message = std::move(message);
+    PushResult(std::move(result));
+  }
+
+  void OnFatalError(std::string message) final {
+    Result result;
+    result.type = Result::kFatalError;
+    result.message = std::move(message);
+    PushResult(std::move(result));
+  }
+
+  // Queues the |result| for delivery, waiting for the TaskRunner thread to
+  // catch up if the results queue is full. Then, ensures a delivery task has
+  // been posted.
+  void PushResult(Result result) {
+    while (!shared_->results.TryPush(std::move(result))) {
+      if (is_stopping_->load()) {
+        return;
+      }
+      std::this_thread::sleep_for(milliseconds(1));
+    }
+    if (!shared_->delivery_task_posted.exchange(true)) {
+      task_runner_->PostTask(
+          [shared = shared_] { ThreadedDecoder::DeliverResults(shared); });
+    }
+  }
+
+  TaskRunner* const task_runner_;
+  const std::shared_ptr<SharedState> shared_;
+  const std::atomic<bool>* const is_stopping_;
+  Decoder decoder_;
+};
+
+ThreadedDecoder::ThreadedDecoder(TaskRunner* task_runner,
+                                 const std::string& codec_name,
+                                 int queue_capacity)
+    : task_runner_(task_runner),
+      // Most codecs produce at most one decoded frame per encoded frame, so
+      // room for a few times as many results is plenty.
+      shared_(std::make_shared<SharedState>(queue_capacity,
+                                            4 * queue_capacity)),
+      core_(std::make_unique<Core>(task_runner_,
+                                   shared_,
+                                   codec_name,
+                                   &is_stopping_)),
+      requests_(queue_capacity),
+      decode_thread_([this] { ProcessRequestsUntilTimeToQuit(); }) {
+  OSP_DCHECK(task_runner_);
+  OSP_DCHECK_GT(queue_capacity, 0);
+}
+
+ThreadedDecoder::~ThreadedDecoder() {
+  shared_->client = nullptr;
+  {
+    std::unique_lock<std::mutex> lock(mutex_);
+    is_stopping_.store(true);
+    cv_.notify_one();
+  }
+  decode_thread_.join();
+}
+
+Decoder::Buffer ThreadedDecoder::TakeBuffer() {
+  Decoder::Buffer buffer;
+  shared_->recycled_buffers.TryPop(&buffer);
+  return buffer;
+}
+
+bool ThreadedDecoder::Decode(FrameId frame_id, Decoder::Buffer buffer) {
+  OSP_DCHECK(task_runner_->IsRunningOnTaskRunner());
+  if (!requests_.TryPush(Request{frame_id, std::move(buffer)})) {
+    return false;
+  }
+  // Taking the lock (even briefly) guarantees the decode thread is either
+  // about to check the queue, or is already waiting and will be woken.
+  { std::unique_lock<std::mutex> lock(mutex_); }
+  cv_.notify_one();
+  return true;
+}
+
+// static
+void ThreadedDecoder::DeliverResults(
+    const std::shared_ptr<SharedState>& shared) {
+  TRACE_DEFAULT_SCOPED(TraceCategory::kStandaloneReceiver);
+  // Clear the flag first, so that any result pushed after the queue is found
+  // empty below will cause another delivery task to be posted.
+  shared->delivery_task_posted.store(false);
+
+  Result result;
+  while (shared->results.TryPop(&result)) {
+    // Re-check the Client each time, since it can be cleared by a callback.
+    Decoder::Client* const client = shared->client;
+    if (!client) {
+      continue;
+    }
+    switch (result.type) {
+      case Result::kFrameDecoded:
+        if (result.frame) {
+          client->OnFrameDecoded(result.frame_id, *result.frame);
+        } else {
+          client->OnDecodeError(result.frame_id, "av_frame_clone failed");
+        }
+        break;
+      case Result::kDecodeError:
+        client->OnDecodeError(result.frame_id, std::move(result.message));
+        break;
+      case Result::kFatalError:
+        client->OnFatalError(std::move(result.message));
+        break;
+    }
+  }
+}
+
+void ThreadedDecoder::ProcessRequestsUntilTimeToQuit() {
+  OSP_DCHECK_EQ(std::this_thread::get_id(), decode_thread_.get_id());
+
+  for (;;) {
+    {
+      std::unique_lock<std::mutex> lock(mutex_);
+      cv_.wait(lock,
+               [this] { return is_stopping_.load() || !requests_.empty(); });
+      if (is_stopping_.load()) {
+        break;  // Time to end this thread.
+      }
+    }
+
+    Request request;
+    while (!is_stopping_.load() && requests_.TryPop(&request)) {
+      core_->Decode(std::move(request));
+    }
+  }
+}
+
+ThreadedDecoder::SharedState::SharedState(int queue_capacity,
+                                          int results_capacity)
+    : results(results_capacity), recycled_buffers(queue_capacity) {}
+ThreadedDecoder::SharedState::~SharedState() = default;
+
+// static
+constexpr int ThreadedDecoder::kDefaultQueueCapacity;
+
+}  // namespace cast
+}  // namespace openscreen
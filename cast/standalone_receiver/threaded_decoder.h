@@ -0,0 +1,123 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STANDALONE_RECEIVER_THREADED_DECODER_H_
+#define CAST_STANDALONE_RECEIVER_THREADED_DECODER_H_
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include "cast/standalone_receiver/avcodec_glue.h"
+#include "cast/standalone_receiver/decoder.h"
+#include "cast/streaming/frame_id.h"
+#include "platform/api/task_runner.h"
+#include "util/spsc_queue.h"
+
+namespace openscreen {
+namespace cast {
+
+// Runs a Decoder on a dedicated thread, so that decoding does not hold up the
+// TaskRunner thread, which also consumes, renders, and presents frames.
+// Encoded frames are handed off to the decode thread, and the decoded frames
+// (and errors) are handed back, via bounded lock-free queues. The Client is
+// always called back on the TaskRunner thread.
+//
+// All public methods must be called on the TaskRunner thread.
+class ThreadedDecoder {
+ public:
+  // The default maximum number of encoded frames waiting to be decoded. A
+  // real-time player is better off skipping ahead to the next key frame than
+  // falling further behind than this.
+  static constexpr int kDefaultQueueCapacity = 4;
+
+  ThreadedDecoder(TaskRunner* task_runner,
+                  const std::string& codec_name,
+                  int queue_capacity = kDefaultQueueCapacity);
+
+  // Blocks until the decode thread has finished any decode in progress. Any
+  // results not yet delivered to the Client are discarded.
+  ~ThreadedDecoder();
+
+  Decoder::Client* client() const { return shared_->client; }
+  void set_client(Decoder::Client* client) { shared_->client = client; }
+
+  // Returns a Buffer to be filled with the next encoded frame, re-using the
+  // storage of one that has already been decoded whenever possible.
+  Decoder::Buffer TakeBuffer();
+
+  // Hands off |buffer|, which is associated with the given |frame_id|, to be
+  // decoded. Returns false, discarding the buffer, if the decode thread has
+  // fallen too far behind to accept it. Otherwise, the Client will be called
+  // back later with the result(s).
+  bool Decode(FrameId frame_id, Decoder::Buffer buffer);
+
+ private:
+  struct Request {
+    FrameId frame_id;
+    Decoder::Buffer buffer;
+  };
+
+  struct Result {
+    enum Type { kFrameDecoded, kDecodeError, kFatalError };
+
+    Type type = kFrameDecoded;
+    FrameId frame_id;
+    AVFrameUniquePtr frame;  // Only for kFrameDecoded.
+    std::string message;     // Only for kDecodeError and kFatalError.
+  };
+
+  // State that outlives this ThreadedDecoder, for as long as a task posted to
+  // deliver results still references it.
+  struct SharedState {
+    SharedState(int queue_capacity, int results_capacity);
+    ~SharedState();
+
+    // Accessed only on the TaskRunner thread.
+    Decoder::Client* client = nullptr;
+
+    // Produced by the decode thread, consumed on the TaskRunner thread.
+    SpscQueue<Result> results;
+    SpscQueue<Decoder::Buffer> recycled_buffers;
+
+    // Set while a task to deliver results has been posted but has not yet
+    // started to run.
+    std::atomic<bool> delivery_task_posted{false};
+  };
+
+  // The decode thread side, which implements Decoder::Client to queue up the
+  // results.
+  class Core;
+
+  // Delivers all queued results to the Client.
+  static void DeliverResults(const std::shared_ptr<SharedState>& shared);
+
+  // Runs on the decode thread until |is_stopping_| is set.
+  void ProcessRequestsUntilTimeToQuit();
+
+  TaskRunner* const task_runner_;
+  const std::shared_ptr<SharedState> shared_;
+  const std::unique_ptr<Core> core_;
+
+  // Produced on the TaskRunner thread, consumed by the decode thread.
+  SpscQueue<Request> requests_;
+
+  // Used only to put the decode thread to sleep while there is nothing to do,
+  // and wake it when there is.
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::atomic<bool> is_stopping_{false};
+
+  // This member should be last in the class since the thread should not start
+  // until all above members have been initialized by the constructor.
+  std::thread decode_thread_;
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STANDALONE_RECEIVER_THREADED_DECODER_H_
@@ -27,6 +27,10 @@ constexpr int kDefaultMaxBitrate = 5 << 20;  // 5 Mbps.
 // What is the minimum amount of bandwidth required?
 constexpr int kMinRequiredBitrate = 384 << 10;  // 384 kbps.
 
+// What fraction of the estimated network bandwidth should be used? Don't ever
+// try to use *all* of it!
+constexpr double kGoodNetworkCitizenFactor = 0.8;
+
 }  // namespace cast
 }  // namespace openscreen
 
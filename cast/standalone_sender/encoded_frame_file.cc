@@ -0,0 +1,409 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/standalone_sender/encoded_frame_file.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <type_traits>
+#include <utility>
+
+#include "util/chrono_helpers.h"
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+using encoded_frame_file::FileHeader;
+using encoded_frame_file::FrameRecord;
+using encoded_frame_file::kMagic;
+using encoded_frame_file::kVersion;
+using encoded_frame_file::TrackHeader;
+using encoded_frame_file::TrackType;
+
+namespace {
+
+static_assert(std::is_trivially_copyable<FileHeader>::value &&
+                  std::is_trivially_copyable<TrackHeader>::value &&
+                  std::is_trivially_copyable<FrameRecord>::value,
+              "Index structs must be read in-place from the file mapping.");
+static_assert(sizeof(FileHeader) % 8 == 0 && sizeof(TrackHeader) % 8 == 0 &&
+                  sizeof(FrameRecord) % 8 == 0,
+              "Index structs must keep 8-byte alignment when packed.");
+
+// The loop duration used when a clip has too few frames to infer one.
+constexpr Clock::duration kDefaultLoopDuration = milliseconds(100);
+
+// Rounds |offset| up to the next multiple of 8.
+uint64_t AlignTo8(uint64_t offset) {
+  return (offset + 7) & ~uint64_t{7};
+}
+
+Error MakeFileError(const char* what, const char* path) {
+  return Error(Error::Code::kFileLoadFailure,
+               std::string(what) + " " + path + ": " + strerror(errno));
+}
+
+Error MakeParseError(const char* what) {
+  return Error(Error::Code::kParseError,
+               std::string("Malformed EncodedFrameFile: ") + what);
+}
+
+}  // namespace
+
+EncodedFrameFileWriter::EncodedFrameFileWriter(FILE* file) : file_(file) {}
+
+EncodedFrameFileWriter::~EncodedFrameFileWriter() {
+  if (file_) {
+    fclose(file_);
+  }
+}
+
+// static
+ErrorOr<std::unique_ptr<EncodedFrameFileWriter>> EncodedFrameFileWriter::Create(
+    const char* path) {
+  FILE* const file = fopen(path, "wb");
+  if (!file) {
+    return MakeFileError("Unable to create", path);
+  }
+  std::unique_ptr<EncodedFrameFileWriter> writer(
+      new EncodedFrameFileWriter(file));
+
+  // Reserve space for the FileHeader, which is written last by Finish().
+  const FileHeader placeholder{};
+  const Error result = writer->Write(&placeholder, sizeof(placeholder));
+  if (!result.ok()) {
+    return result;
+  }
+  return writer;
+}
+
+int EncodedFrameFileWriter::AddTrack(TrackType type,
+                                     const char* codec_name,
+                                     int rtp_timebase,
+                                     int channels) {
+  OSP_DCHECK(file_);
+  OSP_DCHECK(std::all_of(
+      tracks_.begin(), tracks_.end(),
+      [](const PendingTrack& track) { return track.frames.empty(); }));
+  OSP_DCHECK_LT(strlen(codec_name), sizeof(TrackHeader::codec_name));
+  OSP_DCHECK_GT(rtp_timebase, 0);
+
+  tracks_.emplace_back();
+  TrackHeader& header = tracks_.back().header;
+  strncpy(header.codec_name, codec_name, sizeof(header.codec_name) - 1);
+  header.type = type;
+  header.rtp_timebase = rtp_timebase;
+  header.channels = channels;
+  return static_cast<int>(tracks_.size()) - 1;
+}
+
+Error EncodedFrameFileWriter::AppendFrame(int track_index,
+                                          const EncodedFrame& frame) {
+  OSP_DCHECK(file_);
+  OSP_DCHECK_GE(track_index, 0);
+  OSP_DCHECK_LT(track_index, static_cast<int>(tracks_.size()));
+  PendingTrack& track = tracks_[track_index];
+  OSP_DCHECK(track.frame_ids.empty() ||
+             frame.frame_id > track.frame_ids.back());
+
+  // Replay always starts at the beginning of a track, so it must begin with a
+  // key frame.
+  if (track.frames.empty() && frame.dependency != EncodedFrame::KEY_FRAME) {
+    OSP_VLOG << "Dropping frame " << frame.frame_id
+             << ": waiting for the first key frame.";
+    return Error::None();
+  }
+
+  FrameRecord record{};
+  if (frame.referenced_frame_id == frame.frame_id) {
+    record.referenced_frame_delta = 0;  // Independently decodable.
+  } else {
+    // Find the referenced frame among those already appended. If it is not
+    // there, this frame could never be decoded during replay.
+    const auto it =
+        std::lower_bound(track.frame_ids.begin(), track.frame_ids.end(),
+                         frame.referenced_frame_id);
+    if (it == track.frame_ids.end() || *it != frame.referenced_frame_id) {
+      OSP_VLOG << "Dropping frame " << frame.frame_id
+               << ": its referenced frame is not in the file.";
+      return Error::None();
+    }
+    record.referenced_frame_delta =
+        static_cast<uint32_t>(track.frame_ids.end() - it);
+  }
+
+  if (track.frames.empty()) {
+    track.first_rtp_timestamp = frame.rtp_timestamp;
+  }
+  record.data_offset = write_offset_;
+  record.data_size = static_cast<uint32_t>(frame.data.size());
+  // RtpTimeDelta has no accessor for its tick count, but dividing by a single
+  // tick yields it.
+  record.rtp_timestamp = (frame.rtp_timestamp - track.first_rtp_timestamp) /
+                         RtpTimeDelta::FromTicks(1);
+  record.dependency = static_cast<uint8_t>(frame.dependency);
+
+  const Error result = Write(frame.data.data(), frame.data.size());
+  if (!result.ok()) {
+    return result;
+  }
+
+  if (frame.dependency == EncodedFrame::KEY_FRAME) {
+    track.key_frames.push_back(static_cast<uint32_t>(track.frames.size()));
+  }
+  track.frames.push_back(record);
+  track.frame_ids.push_back(frame.frame_id);
+  track.reference_times.push_back(frame.reference_time);
+  return Error::None();
+}
+
+Error EncodedFrameFileWriter::Finish() {
+  OSP_DCHECK(file_);
+
+  // All tracks share one timeline, starting at the earliest reference time of
+  // any frame. The loop duration is the end of the longest track, plus one
+  // average frame duration so that its last frame gets its proper play time.
+  Clock::time_point origin = Clock::time_point::max();
+  for (const PendingTrack& track : tracks_) {
+    if (!track.reference_times.empty()) {
+      origin = std::min(origin, track.reference_times.front());
+    }
+  }
+  Clock::duration loop_duration = kDefaultLoopDuration;
+  for (PendingTrack& track : tracks_) {
+    for (size_t i = 0; i < track.frames.size(); ++i) {
+      track.frames[i].time_offset_us =
+          to_microseconds(track.reference_times[i] - origin).count();
+    }
+    if (track.frames.size() >= 2) {
+      const Clock::duration first = track.reference_times.front() - origin;
+      const Clock::duration last = track.reference_times.back() - origin;
+      const Clock::duration average_frame_duration =
+          (last - first) / static_cast<int>(track.frames.size() - 1);
+      loop_duration = std::max(loop_duration, last + average_frame_duration);
+    }
+  }
+
+  // Pad so that the index is 8-byte aligned in the file mapping.
+  constexpr uint8_t kZeros[8] = {};
+  const uint64_t index_offset = AlignTo8(write_offset_);
+  Error result = Write(kZeros, index_offset - write_offset_);
+
+  for (PendingTrack& track : tracks_) {
+    track.header.num_frames = static_cast<uint32_t>(track.frames.size());
+    track.header.num_key_frames =
+        static_cast<uint32_t>(track.key_frames.size());
+    if (result.ok()) {
+      result = Write(&track.header, sizeof(track.header));
+    }
+  }
+  for (const PendingTrack& track : tracks_) {
+    if (result.ok()) {
+      result = Write(track.frames.data(),
+                     track.frames.size() * sizeof(FrameRecord));
+    }
+    if (result.ok()) {
+      result = Write(track.key_frames.data(),
+                     track.key_frames.size() * sizeof(uint32_t));
+    }
+    if (result.ok()) {
+      result = Write(kZeros, AlignTo8(write_offset_) - write_offset_);
+    }
+  }
+
+  if (result.ok()) {
+    FileHeader header{};
+    memcpy(header.magic, kMagic, sizeof(kMagic));
+    header.version = kVersion;
+    header.num_tracks = static_cast<uint32_t>(tracks_.size());
+    header.index_offset = index_offset;
+    header.loop_duration_us = to_microseconds(loop_duration).count();
+    if (fseek(file_, 0, SEEK_SET) != 0 ||
+        fwrite(&header, sizeof(header), 1, file_) != 1) {
+      result = Error(Error::Code::kIOFailure, "Unable to write FileHeader.");
+    }
+  }
+
+  if (fclose(file_) != 0 && result.ok()) {
+    result = Error(Error::Code::kIOFailure, strerror(errno));
+  }
+  file_ = nullptr;
+  return result;
+}
+
+Error EncodedFrameFileWriter::Write(const void* data, size_t size) {
+  if (size > 0 && fwrite(data, size, 1, file_) != 1) {
+    return Error(Error::Code::kIOFailure, strerror(errno));
+  }
+  write_offset_ += size;
+  return Error::None();
+}
+
+EncodedFrameFileReader::Track::Track() = default;
+EncodedFrameFileReader::Track::Track(Track&&) noexcept = default;
+EncodedFrameFileReader::Track::~Track() = default;
+
+size_t EncodedFrameFileReader::Track::FindKeyFrameAtOrAfter(
+    size_t index) const {
+  const auto it = std::lower_bound(key_frames.begin(), key_frames.end(), index);
+  return it == key_frames.end() ? frames.size() : *it;
+}
+
+EncodedFrameFileReader::EncodedFrameFileReader(const uint8_t* mapping,
+                                               size_t mapping_size)
+    : mapping_(mapping), mapping_size_(mapping_size) {}
+
+EncodedFrameFileReader::~EncodedFrameFileReader() {
+  munmap(const_cast<uint8_t*>(mapping_), mapping_size_);
+}
+
+// static
+ErrorOr<std::unique_ptr<EncodedFrameFileReader>> EncodedFrameFileReader::Open(
+    const char* path) {
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0) {
+    return MakeFileError("Unable to open", path);
+  }
+  struct stat file_info;
+  if (fstat(fd, &file_info) != 0) {
+    const Error error = MakeFileError("Unable to stat", path);
+    close(fd);
+    return error;
+  }
+  const size_t size = static_cast<size_t>(file_info.st_size);
+  if (size < sizeof(FileHeader)) {
+    close(fd);
+    return MakeParseError("file is too small.");
+  }
+  void* const mapping = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+  // The mapping remains valid after the file descriptor is closed.
+  const Error map_error = (mapping == MAP_FAILED)
+                              ? MakeFileError("Unable to map", path)
+                              : Error::None();
+  close(fd);
+  if (!map_error.ok()) {
+    return map_error;
+  }
+
+  std::unique_ptr<EncodedFrameFileReader> reader(
+      new EncodedFrameFileReader(static_cast<const uint8_t*>(mapping), size));
+  const Error result = reader->ParseIndex();
+  if (!result.ok()) {
+    return result;
+  }
+  return reader;
+}
+
+const EncodedFrameFileReader::Track* EncodedFrameFileReader::FindTrack(
+    TrackType type) const {
+  for (const Track& track : tracks_) {
+    if (track.type == type) {
+      return &track;
+    }
+  }
+  return nullptr;
+}
+
+Error EncodedFrameFileReader::ParseIndex() {
+  const FileHeader& header = *reinterpret_cast<const FileHeader*>(mapping_);
+  if (memcmp(header.magic, kMagic, sizeof(kMagic)) != 0) {
+    return MakeParseError("bad magic.");
+  }
+  if (header.version != kVersion) {
+    return MakeParseError("unsupported version.");
+  }
+  if (header.loop_duration_us <= 0) {
+    return MakeParseError("bad loop duration.");
+  }
+  loop_duration_ = microseconds(header.loop_duration_us);
+
+  // Returns a pointer to |count| elements of T at |offset|, advancing
+  // |offset| past them; or nullptr if they would extend beyond the end of the
+  // file.
+  uint64_t offset = header.index_offset;
+  const auto take = [this, &offset](auto* type_tag, uint64_t count) {
+    using T = std::remove_pointer_t<decltype(type_tag)>;
+    if (offset % alignof(T) != 0 || offset > mapping_size_ ||
+        count > (mapping_size_ - offset) / sizeof(T)) {
+      return static_cast<const T*>(nullptr);
+    }
+    const T* const result = reinterpret_cast<const T*>(mapping_ + offset);
+    offset = AlignTo8(offset + count * sizeof(T));
+    return result;
+  };
+
+  const TrackHeader* const track_headers =
+      take(static_cast<TrackHeader*>(nullptr), header.num_tracks);
+  if (!track_headers) {
+    return MakeParseError("truncated track headers.");
+  }
+  for (uint32_t i = 0; i < header.num_tracks; ++i) {
+    const TrackHeader& track_header = track_headers[i];
+    const FrameRecord* const frames =
+        take(static_cast<FrameRecord*>(nullptr), track_header.num_frames);
+    const uint32_t* const key_frames =
+        take(static_cast<uint32_t*>(nullptr), track_header.num_key_frames);
+    if (!frames || !key_frames) {
+      return MakeParseError("truncated frame index.");
+    }
+
+    Track track;
+    track.codec_name.assign(
+        track_header.codec_name,
+        strnlen(track_header.codec_name, sizeof(track_header.codec_name)));
+    track.type = track_header.type;
+    track.rtp_timebase = static_cast<int>(track_header.rtp_timebase);
+    track.channels = static_cast<int>(track_header.channels);
+    track.frames = absl::MakeConstSpan(frames, track_header.num_frames);
+    track.key_frames =
+        absl::MakeConstSpan(key_frames, track_header.num_key_frames);
+
+    if (track.type != TrackType::kAudio && track.type != TrackType::kVideo) {
+      return MakeParseError("unknown track type.");
+    }
+    if (track.rtp_timebase <= 0) {
+      return MakeParseError("bad RTP timebase.");
+    }
+    if (!track.frames.empty() &&
+        (track.key_frames.empty() || track.key_frames.front() != 0)) {
+      return MakeParseError("track does not start with a key frame.");
+    }
+    for (size_t j = 0; j < track.key_frames.size(); ++j) {
+      if (track.key_frames[j] >= track.frames.size() ||
+          (j > 0 && track.key_frames[j] <= track.key_frames[j - 1]) ||
+          track.frames[track.key_frames[j]].referenced_frame_delta != 0) {
+        return MakeParseError("bad key frame index.");
+      }
+    }
+    for (size_t j = 0; j < track.frames.size(); ++j) {
+      const FrameRecord& frame = track.frames[j];
+      if (frame.data_offset > header.index_offset ||
+          frame.data_size > header.index_offset - frame.data_offset) {
+        return MakeParseError("frame data out of bounds.");
+      }
+      if (frame.referenced_frame_delta > j) {
+        return MakeParseError("frame references a frame before the track.");
+      }
+      if (j > 0 &&
+          (frame.rtp_timestamp <= track.frames[j - 1].rtp_timestamp ||
+           frame.time_offset_us <= track.frames[j - 1].time_offset_us ||
+           frame.time_offset_us >= header.loop_duration_us)) {
+        return MakeParseError("frame timestamps are not increasing.");
+      }
+    }
+    tracks_.push_back(std::move(track));
+  }
+
+  return Error::None();
+}
+
+}  // namespace cast
+}  // namespace openscreen
@@ -0,0 +1,208 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STANDALONE_SENDER_ENCODED_FRAME_FILE_H_
+#define CAST_STANDALONE_SENDER_ENCODED_FRAME_FILE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "cast/streaming/encoded_frame.h"
+#include "cast/streaming/frame_id.h"
+#include "cast/streaming/rtp_time.h"
+#include "platform/api/time.h"
+#include "platform/base/error.h"
+#include "platform/base/macros.h"
+
+namespace openscreen {
+namespace cast {
+
+// An EncodedFrameFile is a compact container of pre-encoded audio and video
+// frames, meant to be replayed directly into Senders (see
+// PreencodedFileSender). This avoids all of the decode/re-encode costs of
+// LoopingFileSender, so that one machine can drive many concurrent streaming
+// sessions for load testing.
+//
+// The file consists of a FileHeader, followed by all of the frame payloads
+// (in the order they were appended), followed by an index: one TrackHeader per
+// track and then, for each track, its FrameRecords and key frame index. The
+// index is read in-place from a memory-mapped file, so all values are stored in
+// the native byte order; files are not meant to be portable across platforms.
+namespace encoded_frame_file {
+
+constexpr char kMagic[8] = {'O', 'S', 'C', 'E', 'F', 'R', 'M', '1'};
+constexpr uint32_t kVersion = 1;
+
+enum class TrackType : uint32_t {
+  kAudio = 0,
+  kVideo = 1,
+};
+
+struct FileHeader {
+  char magic[8];
+  uint32_t version;
+  uint32_t num_tracks;
+
+  // The file offset of the first TrackHeader.
+  uint64_t index_offset;
+
+  // The amount of time between the start of one loop of the clip and the
+  // start of the next.
+  int64_t loop_duration_us;
+};
+
+struct TrackHeader {
+  // NUL-terminated codec name, as returned by CodecToString().
+  char codec_name[16];
+  TrackType type;
+  uint32_t rtp_timebase;
+  uint32_t channels;
+  uint32_t num_frames;
+  uint32_t num_key_frames;
+  uint32_t reserved;
+};
+
+struct FrameRecord {
+  // Location of the frame payload in the file.
+  uint64_t data_offset;
+  uint32_t data_size;
+
+  // The number of frames back, in the same track, to the frame this one
+  // depends on. Zero for frames that are independently decodable.
+  uint32_t referenced_frame_delta;
+
+  // The frame's RTP timestamp, relative to that of the first frame in the
+  // track.
+  int64_t rtp_timestamp;
+
+  // When the frame should be sent, relative to the start of the clip. This is
+  // a shared timeline for all tracks, which keeps them in sync.
+  int64_t time_offset_us;
+
+  // An EncodedFrame::Dependency value.
+  uint8_t dependency;
+  uint8_t reserved[7];
+};
+
+}  // namespace encoded_frame_file
+
+// Writes an EncodedFrameFile. Frames from all tracks may be appended in any
+// order; but, within each track, they must be appended in FrameId order.
+class EncodedFrameFileWriter {
+ public:
+  ~EncodedFrameFileWriter();
+
+  // Creates (or truncates) the file at |path| for writing.
+  static ErrorOr<std::unique_ptr<EncodedFrameFileWriter>> Create(
+      const char* path);
+
+  // Adds a track, returning its index. All tracks must be added before the
+  // first call to AppendFrame().
+  int AddTrack(encoded_frame_file::TrackType type,
+               const char* codec_name,
+               int rtp_timebase,
+               int channels);
+
+  // Appends the given |frame| to the track at |track_index|. Frames that cannot
+  // be decoded from the file alone (i.e., those before the first key frame, or
+  // those whose referenced frame was never appended) are silently dropped.
+  Error AppendFrame(int track_index, const EncodedFrame& frame);
+
+  // Writes the index and the final FileHeader, and closes the file. No methods
+  // may be called after this.
+  Error Finish();
+
+ private:
+  struct PendingTrack {
+    encoded_frame_file::TrackHeader header{};
+    std::vector<encoded_frame_file::FrameRecord> frames;
+    std::vector<uint32_t> key_frames;
+
+    // The FrameId and reference time of each frame in |frames|, needed to
+    // compute FrameRecord::referenced_frame_delta and time_offset_us.
+    std::vector<FrameId> frame_ids;
+    std::vector<Clock::time_point> reference_times;
+    RtpTimeTicks first_rtp_timestamp;
+  };
+
+  explicit EncodedFrameFileWriter(FILE* file);
+
+  Error Write(const void* data, size_t size);
+
+  FILE* file_;
+  uint64_t write_offset_ = 0;
+  std::vector<PendingTrack> tracks_;
+
+  OSP_DISALLOW_COPY_AND_ASSIGN(EncodedFrameFileWriter);
+};
+
+// Provides read-only access to an EncodedFrameFile, which is memory-mapped.
+// Frame payloads can be handed to Sender::EnqueueFrame() without copying, and
+// the OS page cache shares one copy of the file among all processes replaying
+// it.
+class EncodedFrameFileReader {
+ public:
+  struct Track {
+    Track();
+    Track(Track&&) noexcept;
+    ~Track();
+
+    std::string codec_name;
+    encoded_frame_file::TrackType type;
+    int rtp_timebase;
+    int channels;
+    absl::Span<const encoded_frame_file::FrameRecord> frames;
+
+    // The indices of all key frames in |frames|, in ascending order. The first
+    // frame of a track is always a key frame.
+    absl::Span<const uint32_t> key_frames;
+
+    // Returns the index of the first key frame at or after |index|, or
+    // |frames.size()| if there are none.
+    size_t FindKeyFrameAtOrAfter(size_t index) const;
+  };
+
+  ~EncodedFrameFileReader();
+
+  // Maps the file at |path| into memory and validates its index.
+  static ErrorOr<std::unique_ptr<EncodedFrameFileReader>> Open(
+      const char* path);
+
+  Clock::duration loop_duration() const { return loop_duration_; }
+  const std::vector<Track>& tracks() const { return tracks_; }
+
+  // Returns the first track of the given |type|, or nullptr if none.
+  const Track* FindTrack(encoded_frame_file::TrackType type) const;
+
+  // Returns the payload of the given |frame|.
+  absl::Span<const uint8_t> GetFrameData(
+      const encoded_frame_file::FrameRecord& frame) const {
+    return absl::Span<const uint8_t>(mapping_ + frame.data_offset,
+                                     frame.data_size);
+  }
+
+ private:
+  EncodedFrameFileReader(const uint8_t* mapping, size_t mapping_size);
+
+  // Parses and validates the index, populating |tracks_| and
+  // |loop_duration_|.
+  Error ParseIndex();
+
+  const uint8_t* const mapping_;
+  const size_t mapping_size_;
+  Clock::duration loop_duration_{};
+  std::vector<Track> tracks_;
+
+  OSP_DISALLOW_COPY_AND_ASSIGN(EncodedFrameFileReader);
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STANDALONE_SENDER_ENCODED_FRAME_FILE_H_
@@ -0,0 +1,326 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Compares the StreamingVp8Encoder and StreamingVp9Encoder on the same content
+// (the video track of a media file, as used by the standalone sender's looping
+// file mode). Each codec is run, one at a time, through the full streaming
+// path: SimulatedVideoCapturer → encoder → Sender → loopback UDP → Receiver.
+// Once the end of the file is reached, encode cost and bitrate statistics are
+// printed to the console.
+
+#include <getopt.h>
+
+#include <algorithm>
+#include <climits>
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "cast/standalone_sender/simulated_capturer.h"
+#include "cast/standalone_sender/streaming_video_encoder.h"
+#include "cast/standalone_sender/streaming_vp8_encoder.h"
+#include "cast/standalone_sender/streaming_vp9_encoder.h"
+#include "cast/streaming/constants.h"
+#include "cast/streaming/encoded_frame.h"
+#include "cast/streaming/environment.h"
+#include "cast/streaming/message_fields.h"
+#include "cast/streaming/receiver.h"
+#include "cast/streaming/receiver_packet_router.h"
+#include "cast/streaming/rtp_defines.h"
+#include "cast/streaming/sender.h"
+#include "cast/streaming/sender_packet_router.h"
+#include "cast/streaming/session_config.h"
+#include "cast/streaming/ssrc.h"
+#include "platform/api/time.h"
+#include "platform/impl/logging.h"
+#include "platform/impl/platform_client_posix.h"
+#include "platform/impl/task_runner.h"
+#include "util/chrono_helpers.h"
+#include "util/crypto/random_bytes.h"
+#include "util/osp_logging.h"
+#include "util/stringprintf.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+constexpr int kDefaultTargetBitrate = 2 << 20;  // 2 Mbps.
+
+void LogUsage(const char* argv0) {
+  constexpr char kTemplate[] = R"(
+usage: %s <options> media_file
+
+   Encodes the video track of media_file once with each of the VP8 and VP9
+   streaming encoders, streaming the result to a Receiver over the loopback
+   interface, and reports the encode cost and bitrate of each.
+
+      -b, --bitrate=N
+           Target encoder bitrate, in bits per second.
+
+           Default if not set: %d
+
+      -t, --threads=N
+           Number of encode threads. Default: Number of CPU cores (max 8).
+
+      -h, --help: Show this help message.
+)";
+  std::cerr << StringPrintf(kTemplate, argv0, kDefaultTargetBitrate);
+}
+
+// Returns the given |percentile| (in the range [0,100]) from the already-sorted
+// |values|.
+double GetPercentile(const std::vector<double>& values, int percentile) {
+  if (values.empty()) {
+    return 0.0;
+  }
+  const size_t index = (values.size() - 1) * percentile / 100;
+  return values[index];
+}
+
+// Streams one pass of the video track of a file with one codec, collecting the
+// per-frame encode Stats along the way.
+class BenchmarkRun final : public SimulatedVideoCapturer::Client,
+                           public Receiver::Consumer,
+                           public Environment::SocketSubscriber {
+ public:
+  BenchmarkRun(TaskRunner* task_runner,
+               const char* path,
+               VideoCodec codec,
+               const StreamingVideoEncoder::Parameters& params,
+               int target_bitrate,
+               std::function<void()> done_callback)
+      : task_runner_(task_runner),
+        path_(path),
+        codec_(codec),
+        params_(params),
+        target_bitrate_(target_bitrate),
+        done_callback_(std::move(done_callback)),
+        receiver_env_(&Clock::now,
+                      task_runner_,
+                      IPEndpoint{IPAddress::kV4LoopbackAddress(), 0}) {
+    // The Sender side is set up once the Receiver's UDP socket is bound, since
+    // its port number is not known until then.
+    receiver_env_.SetSocketSubscriber(this);
+  }
+
+  ~BenchmarkRun() final {
+    if (receiver_) {
+      receiver_->SetConsumer(nullptr);
+    }
+  }
+
+  // Prints a one-line summary of the run.
+  void PrintSummary() const {
+    std::vector<double> encode_millis;
+    double total_bytes = 0.0;
+    double total_quantizer = 0.0;
+    double total_time_utilization = 0.0;
+    Clock::duration total_duration{};
+    for (const StreamingVideoEncoder::Stats& stats : stats_) {
+      encode_millis.push_back(
+          to_microseconds(stats.encode_wall_time).count() / 1000.0);
+      total_bytes += stats.encoded_size;
+      total_quantizer += stats.quantizer;
+      total_time_utilization += stats.time_utilization();
+      total_duration += stats.frame_duration;
+    }
+    std::sort(encode_millis.begin(), encode_millis.end());
+
+    const double num_frames = std::max<size_t>(stats_.size(), 1);
+    const double seconds =
+        std::max(to_microseconds(total_duration).count() / 1e6, 1e-6);
+    double mean_encode_millis = 0.0;
+    for (double millis : encode_millis) {
+      mean_encode_millis += millis;
+    }
+    mean_encode_millis /= num_frames;
+
+    printf(
+        "%-4s frames=%zu received=%d encode_ms(mean/p50/p95/max)=%.2f/%.2f/"
+        "%.2f/%.2f time_util=%.3f bitrate_kbps=%.1f (target=%d) "
+        "quantizer=%.1f\n",
+        CodecToString(codec_), stats_.size(), num_frames_received_,
+        mean_encode_millis, GetPercentile(encode_millis, 50),
+        GetPercentile(encode_millis, 95), GetPercentile(encode_millis, 100),
+        total_time_utilization / num_frames,
+        total_bytes * CHAR_BIT / seconds / 1000.0, target_bitrate_ / 1000,
+        total_quantizer / num_frames);
+    fflush(stdout);
+  }
+
+ private:
+  // Environment::SocketSubscriber implementation.
+  void OnSocketReady() final {
+    if (sender_env_) {
+      return;  // This is the Sender's socket becoming ready.
+    }
+
+    const SessionConfig config(GenerateSsrc(false), GenerateSsrc(false),
+                               kRtpVideoTimebase, 1 /* channels */,
+                               kDefaultTargetPlayoutDelay,
+                               GenerateRandomBytes16(), GenerateRandomBytes16(),
+                               true /* is_pli_enabled */);
+
+    receiver_router_ = std::make_unique<ReceiverPacketRouter>(&receiver_env_);
+    receiver_ =
+        std::make_unique<Receiver>(&receiver_env_, receiver_router_.get(),
+                                   config);
+    receiver_->SetConsumer(this);
+
+    sender_env_ = std::make_unique<Environment>(
+        &Clock::now, task_runner_,
+        IPEndpoint{IPAddress::kV4LoopbackAddress(), 0});
+    sender_env_->set_remote_endpoint(receiver_env_.GetBoundLocalEndpoint());
+    sender_router_ = std::make_unique<SenderPacketRouter>(sender_env_.get());
+    sender_ = std::make_unique<Sender>(sender_env_.get(), sender_router_.get(),
+                                       config, GetPayloadType(codec_));
+
+    if (codec_ == VideoCodec::kVp9) {
+      encoder_ = std::make_unique<StreamingVp9Encoder>(params_, task_runner_,
+                                                       sender_.get());
+    } else {
+      encoder_ = std::make_unique<StreamingVp8Encoder>(params_, task_runner_,
+                                                       sender_.get());
+    }
+    encoder_->SetTargetBitrate(target_bitrate_);
+
+    capturer_.emplace(sender_env_.get(), path_,
+                      Clock::now() + milliseconds(100), this);
+  }
+
+  void OnSocketInvalid(Error error) final {
+    OSP_LOG_ERROR << "Loopback UDP socket failed: " << error;
+    done_callback_();
+  }
+
+  // SimulatedVideoCapturer::Client implementation.
+  void OnVideoFrame(const AVFrame& av_frame,
+                    Clock::time_point capture_time) final {
+    StreamingVideoEncoder::VideoFrame frame{};
+    frame.width = av_frame.width - av_frame.crop_left - av_frame.crop_right;
+    frame.height = av_frame.height - av_frame.crop_top - av_frame.crop_bottom;
+    frame.yuv_planes[0] = av_frame.data[0] + av_frame.crop_left +
+                          av_frame.linesize[0] * av_frame.crop_top;
+    frame.yuv_planes[1] = av_frame.data[1] + av_frame.crop_left / 2 +
+                          av_frame.linesize[1] * av_frame.crop_top / 2;
+    frame.yuv_planes[2] = av_frame.data[2] + av_frame.crop_left / 2 +
+                          av_frame.linesize[2] * av_frame.crop_top / 2;
+    for (int i = 0; i < 3; ++i) {
+      frame.yuv_strides[i] = av_frame.linesize[i];
+    }
+    encoder_->EncodeAndSend(frame, capture_time,
+                            [this](StreamingVideoEncoder::Stats stats) {
+                              stats_.push_back(stats);
+                            });
+  }
+
+  void OnEndOfFile(SimulatedCapturer* capturer) final {
+    // Allow some time for the last frames to be encoded and delivered.
+    task_runner_->PostTaskWithDelay([this] { done_callback_(); },
+                                    kDefaultTargetPlayoutDelay);
+  }
+
+  void OnError(SimulatedCapturer* capturer, std::string message) final {
+    OSP_LOG_ERROR << "Video capturer failed: " << message;
+    done_callback_();
+  }
+
+  // Receiver::Consumer implementation.
+  void OnFramesReady(int next_frame_buffer_size) final {
+    buffer_.resize(next_frame_buffer_size);
+    receiver_->ConsumeNextFrame(absl::Span<uint8_t>(buffer_));
+    ++num_frames_received_;
+  }
+
+  TaskRunner* const task_runner_;
+  const char* const path_;
+  const VideoCodec codec_;
+  const StreamingVideoEncoder::Parameters params_;
+  const int target_bitrate_;
+  const std::function<void()> done_callback_;
+
+  Environment receiver_env_;
+  std::unique_ptr<ReceiverPacketRouter> receiver_router_;
+  std::unique_ptr<Receiver> receiver_;
+  std::vector<uint8_t> buffer_;
+  int num_frames_received_ = 0;
+
+  std::unique_ptr<Environment> sender_env_;
+  std::unique_ptr<SenderPacketRouter> sender_router_;
+  std::unique_ptr<Sender> sender_;
+  std::unique_ptr<StreamingVideoEncoder> encoder_;
+  absl::optional<SimulatedVideoCapturer> capturer_;
+
+  std::vector<StreamingVideoEncoder::Stats> stats_;
+};
+
+int EncoderBenchmarkMain(int argc, char* argv[]) {
+  const struct option kArgumentOptions[] = {
+      {"bitrate", required_argument, nullptr, 'b'},
+      {"threads", required_argument, nullptr, 't'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, 0}};
+
+  int target_bitrate = kDefaultTargetBitrate;
+  StreamingVideoEncoder::Parameters params;
+  int ch = -1;
+  while ((ch = getopt_long(argc, argv, "b:t:h", kArgumentOptions, nullptr)) !=
+         -1) {
+    switch (ch) {
+      case 'b':
+        target_bitrate = atoi(optarg);
+        break;
+      case 't':
+        params.num_encode_threads = atoi(optarg);
+        break;
+      case 'h':
+        LogUsage(argv[0]);
+        return 1;
+    }
+  }
+  if (optind != (argc - 1) || target_bitrate <= 0 ||
+      params.num_encode_threads <= 0) {
+    LogUsage(argv[0]);
+    return 1;
+  }
+  const char* const path = argv[optind];
+
+  openscreen::SetLogLevel(openscreen::LogLevel::kWarning);
+  auto* const task_runner = new TaskRunnerImpl(&Clock::now);
+  PlatformClientPosix::Create(milliseconds(50),
+                              std::unique_ptr<TaskRunnerImpl>(task_runner));
+
+  for (VideoCodec codec : {VideoCodec::kVp8, VideoCodec::kVp9}) {
+    // |run| must be constructed and destroyed from a Task run by the
+    // TaskRunner.
+    BenchmarkRun* run = nullptr;
+    task_runner->PostTask([&] {
+      run = new BenchmarkRun(task_runner, path, codec, params, target_bitrate,
+                             [&] { task_runner->RequestStopSoon(); });
+    });
+    task_runner->RunUntilStopped();
+    task_runner->PostTask([&] {
+      run->PrintSummary();
+      delete run;
+      task_runner->RequestStopSoon();
+    });
+    task_runner->RunUntilStopped();
+  }
+
+  PlatformClientPosix::ShutDown();
+  return 0;
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
+
+int main(int argc, char* argv[]) {
+  return openscreen::cast::EncoderBenchmarkMain(argc, argv);
+}
@@ -4,6 +4,7 @@
 
 #include "cast/standalone_sender/looping_file_cast_agent.h"
 
+#include <sstream>
 #include <string>
 #include <utility>
 #include <vector>
@@ -12,9 +13,12 @@
 #include "cast/standalone_sender/looping_file_sender.h"
 #include "cast/streaming/capture_recommendations.h"
 #include "cast/streaming/constants.h"
+#include "cast/streaming/message_fields.h"
 #include "cast/streaming/offer_messages.h"
 #include "json/value.h"
+#include "platform/api/time.h"
 #include "platform/api/tls_connection_factory.h"
+#include "util/chrono_helpers.h"
 #include "util/stringprintf.h"
 #include "util/trace_logging.h"
 
@@ -63,6 +67,27 @@ std::string ExtractStringFieldValue(const Json::Value& object,
   return fallback;
 }
 
+// Returns an error if the pre-encoded clip |file| cannot be replayed, which
+// requires an Opus audio track and a video track in a supported codec.
+Error CheckPreencodedFileIsPlayable(const EncodedFrameFileReader& file) {
+  using encoded_frame_file::TrackType;
+  const EncodedFrameFileReader::Track* const audio =
+      file.FindTrack(TrackType::kAudio);
+  if (!audio || audio->frames.empty() ||
+      audio->codec_name != CodecToString(AudioCodec::kOpus)) {
+    return Error(Error::Code::kParameterInvalid,
+                 "Pre-encoded clip must have an Opus audio track.");
+  }
+  const EncodedFrameFileReader::Track* const video =
+      file.FindTrack(TrackType::kVideo);
+  if (!video || video->frames.empty() ||
+      StringToVideoCodec(video->codec_name).is_error()) {
+    return Error(Error::Code::kParameterInvalid,
+                 "Pre-encoded clip must have a video track.");
+  }
+  return Error::None();
+}
+
 }  // namespace
 
 LoopingFileCastAgent::LoopingFileCastAgent(TaskRunner* task_runner,
@@ -87,6 +112,23 @@ void LoopingFileCastAgent::Connect(ConnectionSettings settings) {
 
   OSP_DCHECK(!connection_settings_);
   connection_settings_ = std::move(settings);
+
+  if (connection_settings_->is_preencoded) {
+    ErrorOr<std::unique_ptr<EncodedFrameFileReader>> file =
+        EncodedFrameFileReader::Open(
+            connection_settings_->path_to_file.c_str());
+    const Error error = file.is_error()
+                            ? file.error()
+                            : CheckPreencodedFileIsPlayable(*file.value());
+    if (!error.ok()) {
+      OSP_LOG_ERROR << "Cannot replay " << connection_settings_->path_to_file
+                    << ": " << error;
+      Shutdown();
+      return;
+    }
+    preencoded_file_ = std::move(file.value());
+  }
+
   const auto policy = connection_settings_->should_include_video
                           ? DeviceMediaPolicy::kIncludesVideo
                           : DeviceMediaPolicy::kAudioOnly;
@@ -108,6 +150,7 @@ void LoopingFileCastAgent::OnConnected(SenderSocketFactory* factory,
     return;
   }
   message_port_.SetSocket(socket->GetWeakPtr());
+  socket->SetWriteCoalescing(task_runner_);
   router_.TakeSocket(this, std::move(socket));
 
   OSP_LOG_INFO << "Launching Mirroring App on the Cast Receiver...";
@@ -276,6 +319,7 @@ void LoopingFileCastAgent::CreateAndStartSession() {
       &message_port_, remote_connection_->local_id,
       remote_connection_->peer_id);
   OSP_DCHECK(!message_port_.client_sender_id().empty());
+  LoadNetworkHistory();
 
   AudioCaptureConfig audio_config;
   // Opus does best at 192kbps, so we cap that here.
@@ -287,9 +331,33 @@ void LoopingFileCastAgent::CreateAndStartSession() {
   // Use default display resolution of 1080P.
   video_config.resolutions.emplace_back(DisplayResolution{});
 
+  std::vector<VideoCaptureConfig> video_configs;
+  if (preencoded_file_) {
+    // A pre-encoded clip can only be streamed in the format it was encoded in.
+    using encoded_frame_file::TrackType;
+    const EncodedFrameFileReader::Track* const audio_track =
+        preencoded_file_->FindTrack(TrackType::kAudio);
+    audio_config.channels = audio_track->channels;
+    audio_config.sample_rate = audio_track->rtp_timebase;
+    video_configs.push_back(video_config);
+    video_configs.back().codec =
+        StringToVideoCodec(
+            preencoded_file_->FindTrack(TrackType::kVideo)->codec_name)
+            .value();
+  } else {
+    // Offer the preferred video codec first. VP8 is always offered, since all
+    // Cast Receivers are required to support it.
+    if (connection_settings_->codec != VideoCodec::kVp8) {
+      video_configs.push_back(video_config);
+      video_configs.back().codec = connection_settings_->codec;
+    }
+    video_configs.push_back(video_config);
+    video_configs.back().codec = VideoCodec::kVp8;
+  }
+
   OSP_VLOG << "Starting session negotiation.";
-  const Error negotiation_error =
-      current_session_->NegotiateMirroring({audio_config}, {video_config});
+  const Error negotiation_error = current_session_->NegotiateMirroring(
+      {audio_config}, std::move(video_configs));
   if (!negotiation_error.ok()) {
     OSP_LOG_ERROR << "Failed to negotiate a session: " << negotiation_error;
   }
@@ -304,9 +372,24 @@ void LoopingFileCastAgent::OnMirroringNegotiated(
     return;
   }
 
+  if (preencoded_file_) {
+    preencoded_sender_ = std::make_unique<PreencodedFileSender>(
+        environment_.get(), preencoded_file_.get(), std::move(senders));
+    return;
+  }
+
   file_sender_ = std::make_unique<LoopingFileSender>(
-      environment_.get(), connection_settings_->path_to_file.c_str(), session,
-      std::move(senders), connection_settings_->max_bitrate);
+      environment_.get(), connection_settings_->path_to_file.c_str(),
+      current_session_.get(), std::move(senders),
+      connection_settings_->max_bitrate);
+}
+
+void LoopingFileCastAgent::OnCaptureResolutionChanged(
+    const SenderSession* session,
+    const capture_recommendations::Resolution& resolution) {
+  if (file_sender_) {
+    file_sender_->SetCaptureResolution(resolution);
+  }
 }
 
 void LoopingFileCastAgent::OnError(const SenderSession* session, Error error) {
@@ -314,11 +397,70 @@ void LoopingFileCastAgent::OnError(const SenderSession* session, Error error) {
   Shutdown();
 }
 
+void LoopingFileCastAgent::LoadNetworkHistory() {
+  const ConnectionSettings& settings = *connection_settings_;
+  if (settings.network_history_path.empty()) {
+    return;
+  }
+  const std::chrono::seconds now = GetWallTimeSinceUnixEpoch();
+  NetworkHistoryCache cache;
+  const Error error =
+      cache.LoadFromFile(settings.network_history_path.c_str(), now);
+  if (!error.ok()) {
+    OSP_LOG_WARN << "Unable to load network history: " << error;
+    return;
+  }
+  const absl::optional<NetworkConditions> conditions =
+      cache.Lookup(GetReceiverId(), now);
+  if (conditions) {
+    OSP_LOG_INFO << "Last session with this receiver measured "
+                 << conditions->bandwidth << " bps, with a round trip time of "
+                 << to_milliseconds(conditions->round_trip_time).count()
+                 << " ms.";
+    current_session_->SetPriorNetworkConditions(conditions.value());
+  }
+}
+
+void LoopingFileCastAgent::SaveNetworkHistory() {
+  const ConnectionSettings& settings = *connection_settings_;
+  if (settings.network_history_path.empty()) {
+    return;
+  }
+  const absl::optional<NetworkConditions> conditions =
+      current_session_->GetNetworkConditions();
+  if (!conditions) {
+    return;
+  }
+  // Re-load the file, in case another instance has updated it meanwhile.
+  const std::chrono::seconds now = GetWallTimeSinceUnixEpoch();
+  NetworkHistoryCache cache;
+  Error error = cache.LoadFromFile(settings.network_history_path.c_str(), now);
+  if (error.ok()) {
+    cache.Update(GetReceiverId(), conditions.value(), now);
+    error = cache.SaveToFile(settings.network_history_path.c_str());
+  }
+  if (!error.ok()) {
+    OSP_LOG_WARN << "Unable to save network history: " << error;
+  }
+}
+
+std::string LoopingFileCastAgent::GetReceiverId() const {
+  const ConnectionSettings& settings = *connection_settings_;
+  if (!settings.receiver_id.empty()) {
+    return settings.receiver_id;
+  }
+  std::ostringstream address;
+  address << settings.receiver_endpoint.address;
+  return address.str();
+}
+
 void LoopingFileCastAgent::Shutdown() {
   TRACE_DEFAULT_SCOPED(TraceCategory::kStandaloneSender);
 
   file_sender_.reset();
+  preencoded_sender_.reset();
   if (current_session_) {
+    SaveNetworkHistory();
     OSP_LOG_INFO << "Stopping mirroring session...";
     current_session_.reset();
   }
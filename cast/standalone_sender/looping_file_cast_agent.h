@@ -19,8 +19,12 @@
 #include "cast/common/channel/virtual_connection_router.h"
 #include "cast/common/public/cast_socket.h"
 #include "cast/sender/public/sender_socket_factory.h"
+#include "cast/standalone_sender/encoded_frame_file.h"
 #include "cast/standalone_sender/looping_file_sender.h"
+#include "cast/standalone_sender/preencoded_file_sender.h"
+#include "cast/streaming/constants.h"
 #include "cast/streaming/environment.h"
+#include "cast/streaming/network_history_cache.h"
 #include "cast/streaming/sender_session.h"
 #include "platform/api/scoped_wake_lock.h"
 #include "platform/api/serial_delete_ptr.h"
@@ -95,6 +99,24 @@ class LoopingFileCastAgent final
     // Whether we should use the hacky RTP stream IDs for legacy android
     // receivers, or if we should use the proper values.
     bool use_android_rtp_hack = true;
+
+    // The preferred video codec, VP8 or VP9. If VP9 is preferred, VP8 is also
+    // offered to the Receiver as a fallback.
+    VideoCodec codec = VideoCodec::kVp8;
+
+    // If true, |path_to_file| is a pre-encoded clip (an EncodedFrameFile) to be
+    // replayed as-is, instead of a media file to be transcoded. The clip's own
+    // codecs are offered to the Receiver, and |codec| is ignored.
+    bool is_preencoded = false;
+
+    // The unique ID of the receiver, if known from discovery. Otherwise, the
+    // receiver is identified by its address.
+    std::string receiver_id;
+
+    // If non-empty, the path to a NetworkHistoryCache file, used to start each
+    // session with the network conditions measured at the end of the last one
+    // with the same receiver.
+    std::string network_history_path;
   };
 
   // Connect to a Cast Receiver, and start the workflow to establish a
@@ -148,6 +170,18 @@ class LoopingFileCastAgent final
                              capture_recommendations::Recommendations
                                  capture_recommendations) override;
   void OnError(const SenderSession* session, Error error) override;
+  void OnCaptureResolutionChanged(
+      const SenderSession* session,
+      const capture_recommendations::Resolution& resolution) override;
+
+  // Seeds the |current_session_| with the network conditions last recorded for
+  // the receiver, or records the current ones, if |network_history_path| was
+  // provided.
+  void LoadNetworkHistory();
+  void SaveNetworkHistory();
+
+  // Returns the key for the receiver in the NetworkHistoryCache.
+  std::string GetReceiverId() const;
 
   // Helper for stopping the current session, and/or unwinding a remote
   // connection request (pre-session). This ensures LoopingFileCastAgent is in a
@@ -168,6 +202,7 @@ class LoopingFileCastAgent final
 
   // Initialized by Connect().
   absl::optional<ConnectionSettings> connection_settings_;
+  std::unique_ptr<EncodedFrameFileReader> preencoded_file_;
   SerialDeletePtr<ScopedWakeLock> wake_lock_;
 
   // If non-empty, this is the sessionId associated with the Cast Receiver
@@ -183,6 +218,7 @@ class LoopingFileCastAgent final
   std::unique_ptr<Environment> environment_;
   std::unique_ptr<SenderSession> current_session_;
   std::unique_ptr<LoopingFileSender> file_sender_;
+  std::unique_ptr<PreencodedFileSender> preencoded_sender_;
 };
 
 }  // namespace cast
@@ -4,6 +4,13 @@
 
 #include "cast/standalone_sender/looping_file_sender.h"
 
+#include <algorithm>
+#include <chrono>
+#include <utility>
+
+#include "cast/standalone_sender/streaming_vp8_encoder.h"
+#include "cast/standalone_sender/streaming_vp9_encoder.h"
+#include "cast/streaming/message_fields.h"
 #include "util/trace_logging.h"
 
 namespace openscreen {
@@ -11,7 +18,7 @@ namespace cast {
 
 LoopingFileSender::LoopingFileSender(Environment* environment,
                                      const char* path,
-                                     const SenderSession* session,
+                                     SenderSession* session,
                                      SenderSession::ConfiguredSenders senders,
                                      int max_bitrate)
     : env_(environment),
@@ -21,19 +28,33 @@ LoopingFileSender::LoopingFileSender(Environment* environment,
       audio_encoder_(senders.audio_sender->config().channels,
                      StreamingOpusEncoder::kDefaultCastAudioFramesPerSecond,
                      senders.audio_sender),
-      video_encoder_(StreamingVp8Encoder::Parameters{},
-                     env_->task_runner(),
-                     senders.video_sender),
+      video_encoder_(CreateVideoEncoder(senders.video_config.codec,
+                                        env_->task_runner(),
+                                        senders.video_sender)),
       next_task_(env_->now_function(), env_->task_runner()),
       console_update_task_(env_->now_function(), env_->task_runner()) {
-  // Opus and Vp8 are the default values for the config, and if these are set
-  // to a different value that means we offered a codec that we do not
-  // support, which is a developer error.
+  // Opus is the default value for the audio config, and if it is set to a
+  // different value that means we offered a codec that we do not support,
+  // which is a developer error. The same goes for video codecs other than
+  // VP8/VP9 (see CreateVideoEncoder()).
   OSP_CHECK(senders.audio_config.codec == AudioCodec::kOpus);
-  OSP_CHECK(senders.video_config.codec == VideoCodec::kVp8);
   OSP_LOG_INFO << "Max allowed media bitrate (audio + video) will be "
-               << max_bitrate_;
-  bandwidth_being_utilized_ = max_bitrate_ / 2;
+               << max_bitrate_ << ", using the "
+               << CodecToString(senders.video_config.codec)
+               << " video encoder.";
+  // Start at the prior bandwidth estimate from a previous session, if there is
+  // one. Otherwise, start in the middle of the range and adapt from there.
+  const int prior_estimate = session_->GetEstimatedNetworkBandwidth();
+  if (prior_estimate > 0) {
+    bandwidth_being_utilized_ = std::min(
+        std::max<int>(kGoodNetworkCitizenFactor * prior_estimate,
+                      kMinRequiredBitrate),
+        max_bitrate_);
+    OSP_LOG_INFO << "Starting at " << bandwidth_being_utilized_
+                 << " bps, based on the last session with this receiver.";
+  } else {
+    bandwidth_being_utilized_ = max_bitrate_ / 2;
+  }
   UpdateEncoderBitrates();
 
   next_task_.Schedule([this] { SendFileAgain(); }, Alarm::kImmediately);
@@ -41,14 +62,23 @@ LoopingFileSender::LoopingFileSender(Environment* environment,
 
 LoopingFileSender::~LoopingFileSender() = default;
 
+void LoopingFileSender::SetCaptureResolution(
+    const capture_recommendations::Resolution& resolution) {
+  OSP_DCHECK_GT(resolution.frame_rate, 0.0);
+  OSP_LOG_INFO << "Capturing video at " << resolution.width << 'x'
+               << resolution.height << '@' << resolution.frame_rate
+               << " FPS from now on.";
+  capture_resolution_ = resolution;
+}
+
 void LoopingFileSender::UpdateEncoderBitrates() {
   if (bandwidth_being_utilized_ >= kHighBandwidthThreshold) {
     audio_encoder_.UseHighQuality();
   } else {
     audio_encoder_.UseStandardQuality();
   }
-  video_encoder_.SetTargetBitrate(bandwidth_being_utilized_ -
-                                  audio_encoder_.GetBitrate());
+  video_encoder_->SetTargetBitrate(bandwidth_being_utilized_ -
+                                   audio_encoder_.GetBitrate());
 }
 
 void LoopingFileSender::ControlForNetworkCongestion() {
@@ -56,7 +86,6 @@ void LoopingFileSender::ControlForNetworkCongestion() {
   if (bandwidth_estimate_ > 0) {
     // Don't ever try to use *all* of the network bandwidth! However, don't go
     // below the absolute minimum requirement either.
-    constexpr double kGoodNetworkCitizenFactor = 0.8;
     const int usable_bandwidth = std::max<int>(
         kGoodNetworkCitizenFactor * bandwidth_estimate_, kMinRequiredBitrate);
 
@@ -79,6 +108,12 @@ void LoopingFileSender::ControlForNetworkCongestion() {
     // There is no current bandwidth estimate. So, nothing should be adjusted.
   }
 
+  const absl::optional<NetworkConditions> conditions =
+      session_->GetNetworkConditions();
+  if (conditions) {
+    audio_encoder_.SetNetworkConditions(conditions.value());
+  }
+
   next_task_.ScheduleFromNow([this] { ControlForNetworkCongestion(); },
                              kCongestionCheckInterval);
 }
@@ -113,7 +148,24 @@ void LoopingFileSender::OnVideoFrame(const AVFrame& av_frame,
                                      Clock::time_point capture_time) {
   TRACE_DEFAULT_SCOPED(TraceCategory::kStandaloneSender);
   latest_frame_time_ = std::max(capture_time, latest_frame_time_);
-  StreamingVp8Encoder::VideoFrame frame{};
+
+  // Drop frames to achieve the target frame rate, if lower than the file's.
+  // Some slack is allowed, since capture times are not perfectly regular.
+  if (capture_resolution_) {
+    constexpr double kFrameIntervalSlack = 0.9;
+    const auto min_interval =
+        std::chrono::duration_cast<Clock::duration>(
+            std::chrono::duration<double>(kFrameIntervalSlack /
+                                          capture_resolution_->frame_rate));
+    if (last_video_frame_time_ != Clock::time_point::min() &&
+        capture_time >= last_video_frame_time_ &&
+        capture_time - last_video_frame_time_ < min_interval) {
+      return;
+    }
+  }
+  last_video_frame_time_ = capture_time;
+
+  StreamingVideoEncoder::VideoFrame frame{};
   frame.width = av_frame.width - av_frame.crop_left - av_frame.crop_right;
   frame.height = av_frame.height - av_frame.crop_top - av_frame.crop_bottom;
   frame.yuv_planes[0] = av_frame.data[0] + av_frame.crop_left +
@@ -125,9 +177,57 @@ void LoopingFileSender::OnVideoFrame(const AVFrame& av_frame,
   for (int i = 0; i < 3; ++i) {
     frame.yuv_strides[i] = av_frame.linesize[i];
   }
+  ScaleDownFrame(&frame);
+
   // TODO(miu): Add performance metrics visual overlay (based on Stats
   // callback).
-  video_encoder_.EncodeAndSend(frame, capture_time, {});
+  video_encoder_->EncodeAndSend(
+      frame, capture_time, [this](StreamingVideoEncoder::Stats stats) {
+        session_->ReportVideoEncoderUtilization(
+            std::max({stats.time_utilization(), stats.space_utilization(),
+                      stats.entropy_utilization()}));
+      });
+}
+
+void LoopingFileSender::ScaleDownFrame(
+    StreamingVideoEncoder::VideoFrame* frame) {
+  if (!capture_resolution_ || (frame->width <= capture_resolution_->width &&
+                               frame->height <= capture_resolution_->height)) {
+    return;
+  }
+
+  // Fit within the capture resolution, preserving the aspect ratio. I420
+  // requires even dimensions.
+  const double scale =
+      std::min(static_cast<double>(capture_resolution_->width) / frame->width,
+               static_cast<double>(capture_resolution_->height) /
+                   frame->height);
+  const int width = std::max(2, static_cast<int>(frame->width * scale) & ~1);
+  const int height = std::max(2, static_cast<int>(frame->height * scale) & ~1);
+
+  const int chroma_width = width / 2;
+  const int chroma_height = height / 2;
+  scaled_frame_.resize(width * height + 2 * chroma_width * chroma_height);
+  uint8_t* dst = scaled_frame_.data();
+  for (int i = 0; i < 3; ++i) {
+    const int src_width = (i == 0) ? frame->width : (frame->width + 1) / 2;
+    const int src_height = (i == 0) ? frame->height : (frame->height + 1) / 2;
+    const int dst_width = (i == 0) ? width : chroma_width;
+    const int dst_height = (i == 0) ? height : chroma_height;
+    for (int y = 0; y < dst_height; ++y) {
+      const uint8_t* const src_row =
+          frame->yuv_planes[i] +
+          (y * src_height / dst_height) * frame->yuv_strides[i];
+      for (int x = 0; x < dst_width; ++x) {
+        dst[y * dst_width + x] = src_row[x * src_width / dst_width];
+      }
+    }
+    frame->yuv_planes[i] = dst;
+    frame->yuv_strides[i] = dst_width;
+    dst += dst_width * dst_height;
+  }
+  frame->width = width;
+  frame->height = height;
 }
 
 void LoopingFileSender::UpdateStatusOnConsole() {
@@ -183,5 +283,24 @@ const char* LoopingFileSender::ToTrackName(SimulatedCapturer* capturer) const {
   return which;
 }
 
+// static
+std::unique_ptr<StreamingVideoEncoder> LoopingFileSender::CreateVideoEncoder(
+    VideoCodec codec,
+    TaskRunner* task_runner,
+    Sender* sender) {
+  switch (codec) {
+    case VideoCodec::kVp8:
+      return std::make_unique<StreamingVp8Encoder>(
+          StreamingVideoEncoder::Parameters{}, task_runner, sender);
+    case VideoCodec::kVp9:
+      return std::make_unique<StreamingVp9Encoder>(
+          StreamingVideoEncoder::Parameters{}, task_runner, sender);
+    default:
+      OSP_LOG_FATAL << "No encoder available for video codec "
+                    << CodecToString(codec);
+      return nullptr;
+  }
+}
+
 }  // namespace cast
 }  // namespace openscreen
@@ -6,12 +6,15 @@
 #define CAST_STANDALONE_SENDER_LOOPING_FILE_SENDER_H_
 
 #include <algorithm>
+#include <memory>
 #include <string>
+#include <vector>
 
 #include "cast/standalone_sender/constants.h"
 #include "cast/standalone_sender/simulated_capturer.h"
 #include "cast/standalone_sender/streaming_opus_encoder.h"
-#include "cast/standalone_sender/streaming_vp8_encoder.h"
+#include "cast/standalone_sender/streaming_video_encoder.h"
+#include "cast/streaming/capture_recommendations.h"
 #include "cast/streaming/sender_session.h"
 
 namespace openscreen {
@@ -24,12 +27,19 @@ class LoopingFileSender final : public SimulatedAudioCapturer::Client,
  public:
   LoopingFileSender(Environment* environment,
                     const char* path,
-                    const SenderSession* session,
+                    SenderSession* session,
                     SenderSession::ConfiguredSenders senders,
                     int max_bitrate);
 
   ~LoopingFileSender() final;
 
+  // Changes the resolution and frame rate at which video is captured, to
+  // follow the SenderSession's capture ladder. Video frames are only ever
+  // scaled down, preserving their aspect ratio, and frames are dropped to
+  // achieve the lower frame rate.
+  void SetCaptureResolution(
+      const capture_recommendations::Resolution& resolution);
+
  private:
   void UpdateEncoderBitrates();
   void ControlForNetworkCongestion();
@@ -44,6 +54,10 @@ class LoopingFileSender final : public SimulatedAudioCapturer::Client,
   void OnVideoFrame(const AVFrame& av_frame,
                     Clock::time_point capture_time) final;
 
+  // Scales |frame| down, in-place, to fit within |capture_resolution_|, using
+  // the nearest-neighbor algorithm. The result is stored in |scaled_frame_|.
+  void ScaleDownFrame(StreamingVideoEncoder::VideoFrame* frame);
+
   void UpdateStatusOnConsole();
 
   // SimulatedCapturer overrides.
@@ -52,6 +66,12 @@ class LoopingFileSender final : public SimulatedAudioCapturer::Client,
 
   const char* ToTrackName(SimulatedCapturer* capturer) const;
 
+  // Creates the video encoder implementation for the negotiated |codec|.
+  static std::unique_ptr<StreamingVideoEncoder> CreateVideoEncoder(
+      VideoCodec codec,
+      TaskRunner* task_runner,
+      Sender* sender);
+
   // Holds the required injected dependencies (clock, task runner) used for Cast
   // Streaming, and owns the UDP socket over which all communications occur with
   // the remote's Receivers.
@@ -60,8 +80,9 @@ class LoopingFileSender final : public SimulatedAudioCapturer::Client,
   // The path to the media file to stream over and over.
   const char* const path_;
 
-  // Session to query for bandwidth information.
-  const SenderSession* session_;
+  // Session to query for bandwidth information, and to report the video
+  // encoder's utilization to.
+  SenderSession* const session_;
 
   // User provided maximum bitrate (from command line argument).
   const int max_bitrate_;
@@ -70,7 +91,18 @@ class LoopingFileSender final : public SimulatedAudioCapturer::Client,
   int bandwidth_being_utilized_;
 
   StreamingOpusEncoder audio_encoder_;
-  StreamingVp8Encoder video_encoder_;
+
+  // A StreamingVp8Encoder or StreamingVp9Encoder, depending on the video codec
+  // that was negotiated for the session.
+  const std::unique_ptr<StreamingVideoEncoder> video_encoder_;
+
+  // The current capture resolution and frame rate, if any has been set, and
+  // the capture time of the last video frame sent to the encoder.
+  absl::optional<capture_recommendations::Resolution> capture_resolution_;
+  Clock::time_point last_video_frame_time_ = Clock::time_point::min();
+
+  // Backing buffer for scaled-down I420 video frames.
+  std::vector<uint8_t> scaled_frame_;
 
   int num_capturers_running_ = 0;
   Clock::time_point capture_start_time_{};
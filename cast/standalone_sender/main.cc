@@ -12,6 +12,8 @@
 #include <cstring>
 #include <iostream>
 #include <sstream>
+#include <string>
+#include <utility>
 #include <vector>
 
 #include "cast/common/certificate/cast_trust_store.h"
@@ -19,6 +21,7 @@
 #include "cast/standalone_sender/looping_file_cast_agent.h"
 #include "cast/standalone_sender/receiver_chooser.h"
 #include "cast/streaming/constants.h"
+#include "cast/streaming/message_fields.h"
 #include "platform/api/network_interface.h"
 #include "platform/api/time.h"
 #include "platform/base/error.h"
@@ -54,6 +57,26 @@ usage: %s <options> addr[:port] media_file
            Specifies the maximum bits per second for the media streams.
 
            Default if not set: %d
+
+      -c, --codec=vp8|vp9
+           Specifies the preferred video codec. If vp9 is chosen, vp8 is still
+           offered as a fallback for Cast Receivers that do not support vp9.
+
+           Default if not set: vp8
+
+      -p, --preencoded
+           Treat media_file as a pre-encoded clip, made by cast_preencoder, and
+           replay it without any decoding or encoding. This is meant for load
+           testing, since the streaming itself is then nearly the only CPU cost.
+           The clip's own codecs are offered to the Cast Receiver, and the
+           --codec and --max-bitrate options are ignored.
+
+      -n, --network-history=path
+           Specifies the path to a file in which to remember the network
+           conditions measured at the end of each session, per Cast Receiver.
+           Sessions with a known Cast Receiver then start at the last-known
+           bitrate instead of a conservative one. The file is created if it
+           does not exist.
 )"
 #if defined(CAST_ALLOW_DEVELOPER_CERTIFICATE)
                                R"(
@@ -107,6 +130,9 @@ int StandaloneSenderMain(int argc, char* argv[]) {
   // standalone sender, osp demo, and test_main argument options.
   const struct option kArgumentOptions[] = {
     {"max-bitrate", required_argument, nullptr, 'm'},
+    {"codec", required_argument, nullptr, 'c'},
+    {"preencoded", no_argument, nullptr, 'p'},
+    {"network-history", required_argument, nullptr, 'n'},
 #if defined(CAST_ALLOW_DEVELOPER_CERTIFICATE)
     {"developer-certificate", required_argument, nullptr, 'd'},
 #endif
@@ -121,9 +147,12 @@ int StandaloneSenderMain(int argc, char* argv[]) {
   std::string developer_certificate_path;
   bool use_android_rtp_hack = false;
   int max_bitrate = kDefaultMaxBitrate;
+  VideoCodec codec = VideoCodec::kVp8;
+  bool is_preencoded = false;
+  std::string network_history_path;
   std::unique_ptr<TextTraceLoggingPlatform> trace_logger;
   int ch = -1;
-  while ((ch = getopt_long(argc, argv, "m:d:atvh", kArgumentOptions,
+  while ((ch = getopt_long(argc, argv, "m:c:pn:d:atvh", kArgumentOptions,
                            nullptr)) != -1) {
     switch (ch) {
       case 'm':
@@ -135,6 +164,24 @@ int StandaloneSenderMain(int argc, char* argv[]) {
           return 1;
         }
         break;
+      case 'c': {
+        const ErrorOr<VideoCodec> parsed_codec = StringToVideoCodec(optarg);
+        if (parsed_codec.is_error() ||
+            (parsed_codec.value() != VideoCodec::kVp8 &&
+             parsed_codec.value() != VideoCodec::kVp9)) {
+          OSP_LOG_ERROR << "Invalid --codec specified: " << optarg;
+          LogUsage(argv[0]);
+          return 1;
+        }
+        codec = parsed_codec.value();
+        break;
+      }
+      case 'p':
+        is_preencoded = true;
+        break;
+      case 'n':
+        network_history_path = optarg;
+        break;
 #if defined(CAST_ALLOW_DEVELOPER_CERTIFICATE)
       case 'd':
         developer_certificate_path = optarg;
@@ -178,12 +225,14 @@ int StandaloneSenderMain(int argc, char* argv[]) {
                               std::unique_ptr<TaskRunnerImpl>(task_runner));
 
   IPEndpoint remote_endpoint = ParseAsEndpoint(iface_or_endpoint);
+  std::string receiver_id;
   if (!remote_endpoint.port) {
     for (const InterfaceInfo& interface : GetNetworkInterfaces()) {
       if (interface.name == iface_or_endpoint) {
         ReceiverChooser chooser(interface, task_runner,
-                                [&](IPEndpoint endpoint) {
+                                [&](IPEndpoint endpoint, std::string id) {
                                   remote_endpoint = endpoint;
+                                  receiver_id = std::move(id);
                                   task_runner->RequestStopSoon();
                                 });
         task_runner->RunUntilSignaled();
@@ -207,7 +256,8 @@ int StandaloneSenderMain(int argc, char* argv[]) {
         task_runner, [&] { task_runner->RequestStopSoon(); });
     cast_agent->Connect({remote_endpoint, path, max_bitrate,
                          true /* should_include_video */,
-                         use_android_rtp_hack});
+                         use_android_rtp_hack, codec, is_preencoded,
+                         receiver_id, network_history_path});
   });
 
   // Run the event loop until SIGINT (e.g., CTRL-C at the console) or
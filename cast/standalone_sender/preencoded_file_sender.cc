@@ -0,0 +1,167 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/standalone_sender/preencoded_file_sender.h"
+
+#include <algorithm>
+
+#include "cast/streaming/environment.h"
+#include "cast/streaming/sender.h"
+#include "util/chrono_helpers.h"
+#include "util/osp_logging.h"
+#include "util/trace_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+using encoded_frame_file::FrameRecord;
+using encoded_frame_file::TrackType;
+
+PreencodedFileSender::PreencodedFileSender(
+    Environment* environment,
+    const EncodedFrameFileReader* file,
+    SenderSession::ConfiguredSenders senders)
+    : audio_player_(environment,
+                    file,
+                    file->FindTrack(TrackType::kAudio),
+                    senders.audio_sender),
+      video_player_(environment,
+                    file,
+                    file->FindTrack(TrackType::kVideo),
+                    senders.video_sender) {
+  OSP_LOG_INFO << "Replaying pre-encoded clip (starts in one second)...";
+  const Clock::time_point start_time = environment->now() + seconds(1);
+  audio_player_.Start(start_time);
+  video_player_.Start(start_time);
+}
+
+PreencodedFileSender::~PreencodedFileSender() = default;
+
+PreencodedFileSender::TrackPlayer::TrackPlayer(
+    Environment* environment,
+    const EncodedFrameFileReader* file,
+    const EncodedFrameFileReader::Track* track,
+    Sender* sender)
+    : environment_(environment),
+      file_(file),
+      track_(track),
+      sender_(sender),
+      // Each loop must start at a later RTP timestamp than the last frame of
+      // the prior loop, even if the clip's timing is slightly off.
+      loop_rtp_duration_(std::max(
+          RtpTimeDelta::FromDuration(file_->loop_duration(),
+                                     track_->rtp_timebase),
+          RtpTimeDelta::FromTicks(track_->frames.back().rtp_timestamp + 1))),
+      frame_ids_(track_->frames.size()),
+      alarm_(environment_->now_function(), environment_->task_runner()) {
+  OSP_DCHECK(sender_);
+  OSP_DCHECK_EQ(track_->rtp_timebase, sender_->rtp_timebase());
+}
+
+PreencodedFileSender::TrackPlayer::~TrackPlayer() = default;
+
+void PreencodedFileSender::TrackPlayer::Start(Clock::time_point start_time) {
+  next_index_ = 0;
+  chain_start_index_ = 0;
+  loop_start_time_ = start_time;
+  loop_start_rtp_timestamp_ = RtpTimeTicks();
+  alarm_.Schedule([this] { SendFramesUntil(environment_->now()); },
+                  GetFrameTime(next_index_));
+}
+
+const char* PreencodedFileSender::TrackPlayer::name() const {
+  return track_->type == TrackType::kAudio ? "AUDIO" : "VIDEO";
+}
+
+void PreencodedFileSender::TrackPlayer::SendFramesUntil(Clock::time_point now) {
+  TRACE_DEFAULT_SCOPED(TraceCategory::kStandaloneSender);
+
+  // If this task ran late, catch up by sending all frames that are due. Frames
+  // that are dropped have moved |next_index_| ahead to the next key frame, so
+  // this loop always makes progress.
+  while (GetFrameTime(next_index_) <= now) {
+    EnqueueNextFrame();
+  }
+  alarm_.Schedule([this] { SendFramesUntil(environment_->now()); },
+                  GetFrameTime(next_index_));
+}
+
+void PreencodedFileSender::TrackPlayer::EnqueueNextFrame() {
+  const FrameRecord& record = track_->frames[next_index_];
+  const auto dependency =
+      static_cast<EncodedFrame::Dependency>(record.dependency);
+
+  if (dependency == EncodedFrame::KEY_FRAME) {
+    chain_start_index_ = next_index_;
+  } else if (sender_->NeedsKeyFrame() ||
+             next_index_ - record.referenced_frame_delta < chain_start_index_) {
+    // Either the Receiver has requested a key frame, or this frame depends on
+    // one that was not sent.
+    SkipToNextKeyFrame();
+    return;
+  }
+
+  frame_.dependency = dependency;
+  frame_.frame_id = sender_->GetNextFrameId();
+  frame_.referenced_frame_id =
+      (record.referenced_frame_delta == 0)
+          ? frame_.frame_id
+          : frame_ids_[next_index_ - record.referenced_frame_delta];
+  frame_.rtp_timestamp = loop_start_rtp_timestamp_ +
+                         RtpTimeDelta::FromTicks(record.rtp_timestamp);
+  frame_.reference_time = GetFrameTime(next_index_);
+  // The Sender never modifies the frame data, so it is safe to point it at the
+  // read-only file mapping.
+  const absl::Span<const uint8_t> data = file_->GetFrameData(record);
+  frame_.data =
+      absl::Span<uint8_t>(const_cast<uint8_t*>(data.data()), data.size());
+
+  const Sender::EnqueueFrameResult result = sender_->EnqueueFrame(frame_);
+  if (result != Sender::OK) {
+    ++num_frames_dropped_;
+    OSP_VLOG << name() << "[" << sender_->ssrc() << "] Dropping frame "
+             << frame_.frame_id << " (result=" << result
+             << "), skipping to the next key frame.";
+    SkipToNextKeyFrame();
+    return;
+  }
+
+  frame_ids_[next_index_] = frame_.frame_id;
+  ++num_frames_sent_;
+  AdvanceIndex();
+}
+
+void PreencodedFileSender::TrackPlayer::SkipToNextKeyFrame() {
+  const size_t key_frame_index = track_->FindKeyFrameAtOrAfter(next_index_ + 1);
+  if (key_frame_index < track_->frames.size()) {
+    next_index_ = key_frame_index;
+  } else {
+    next_index_ = track_->frames.size() - 1;
+    AdvanceIndex();
+  }
+}
+
+void PreencodedFileSender::TrackPlayer::AdvanceIndex() {
+  ++next_index_;
+  if (next_index_ < track_->frames.size()) {
+    return;
+  }
+
+  OSP_LOG_INFO << name() << "[" << sender_->ssrc()
+               << "] Reached the end of the clip (sent " << num_frames_sent_
+               << " frames, dropped " << num_frames_dropped_
+               << " so far). Looping...";
+  next_index_ = 0;
+  chain_start_index_ = 0;
+  loop_start_time_ += file_->loop_duration();
+  loop_start_rtp_timestamp_ += loop_rtp_duration_;
+}
+
+Clock::time_point PreencodedFileSender::TrackPlayer::GetFrameTime(
+    size_t index) const {
+  return loop_start_time_ + microseconds(track_->frames[index].time_offset_us);
+}
+
+}  // namespace cast
+}  // namespace openscreen
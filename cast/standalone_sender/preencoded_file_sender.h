@@ -0,0 +1,115 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STANDALONE_SENDER_PREENCODED_FILE_SENDER_H_
+#define CAST_STANDALONE_SENDER_PREENCODED_FILE_SENDER_H_
+
+#include <stddef.h>
+
+#include <vector>
+
+#include "cast/standalone_sender/encoded_frame_file.h"
+#include "cast/streaming/encoded_frame.h"
+#include "cast/streaming/rtp_time.h"
+#include "cast/streaming/sender_session.h"
+#include "platform/api/time.h"
+#include "util/alarm.h"
+
+namespace openscreen {
+namespace cast {
+
+class Environment;
+class Sender;
+
+// Plays a pre-encoded clip (an EncodedFrameFile, as produced by the
+// cast_preencoder tool) over and over again, enqueuing its frames directly
+// into the Senders at their original pace. Since nothing is decoded or
+// encoded, the CPU cost is almost entirely that of the streaming stack itself,
+// which makes this useful for load testing many concurrent sessions.
+//
+// Unlike LoopingFileSender, there is no congestion control: the clip is always
+// streamed at the bitrate at which it was encoded. When a Sender rejects a
+// frame, or the Receiver requests a key frame, playback of that track skips
+// ahead to its next key frame.
+class PreencodedFileSender {
+ public:
+  // |file| must outlive this instance, and must contain both an audio and a
+  // video track, whose codecs match those negotiated for the |senders|.
+  PreencodedFileSender(Environment* environment,
+                       const EncodedFrameFileReader* file,
+                       SenderSession::ConfiguredSenders senders);
+
+  ~PreencodedFileSender();
+
+ private:
+  // Plays one track of the |file| into one Sender.
+  class TrackPlayer {
+   public:
+    TrackPlayer(Environment* environment,
+                const EncodedFrameFileReader* file,
+                const EncodedFrameFileReader::Track* track,
+                Sender* sender);
+    ~TrackPlayer();
+
+    // Starts playing the track, with the first loop beginning at |start_time|.
+    void Start(Clock::time_point start_time);
+
+    const char* name() const;
+
+   private:
+    // Enqueues all frames whose time has come, and then schedules the next
+    // call.
+    void SendFramesUntil(Clock::time_point now);
+
+    // Attempts to enqueue the frame at |next_index_| into the Sender, and then
+    // moves |next_index_| to the next frame that should be sent.
+    void EnqueueNextFrame();
+
+    // Moves |next_index_| to the next key frame, possibly in the next loop.
+    void SkipToNextKeyFrame();
+
+    // Moves |next_index_| forward by one, starting a new loop if the end of
+    // the track has been reached.
+    void AdvanceIndex();
+
+    Clock::time_point GetFrameTime(size_t index) const;
+
+    Environment* const environment_;
+    const EncodedFrameFileReader* const file_;
+    const EncodedFrameFileReader::Track* const track_;
+    Sender* const sender_;
+
+    // How much to advance the RTP timestamps at the start of each loop.
+    const RtpTimeDelta loop_rtp_duration_;
+
+    // The index of the next frame to send, and the start time and RTP
+    // timestamp of the current loop.
+    size_t next_index_ = 0;
+    Clock::time_point loop_start_time_{};
+    RtpTimeTicks loop_start_rtp_timestamp_;
+
+    // The FrameIds assigned to the frames sent during the current loop, so
+    // that each frame's |referenced_frame_id| can be looked up. Entries are
+    // only valid from |chain_start_index_| up to |next_index_|: the range of
+    // frames that were all successfully enqueued since the last key frame.
+    std::vector<FrameId> frame_ids_;
+    size_t chain_start_index_ = 0;
+
+    // Reused for each frame, to avoid re-allocation.
+    EncodedFrame frame_;
+
+    int num_frames_sent_ = 0;
+    int num_frames_dropped_ = 0;
+
+    Alarm alarm_;
+  };
+
+  TrackPlayer audio_player_;
+  TrackPlayer video_player_;
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STANDALONE_SENDER_PREENCODED_FILE_SENDER_H_
@@ -0,0 +1,409 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Pre-encodes a media file into an EncodedFrameFile, for later replay by
+// cast_sender's --preencoded mode. The audio and video are transcoded once, in
+// real time, using the same encoders as cast_sender. Both streams are sent
+// through a Sender and a Receiver over the loopback interface, and the frames
+// the Receivers deliver are what is written to the file. This way, the clip
+// has exactly the frame dependency structure and timing that a live session
+// would produce.
+
+#include <getopt.h>
+
+#include <cstdio>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "cast/standalone_sender/encoded_frame_file.h"
+#include "cast/standalone_sender/simulated_capturer.h"
+#include "cast/standalone_sender/streaming_opus_encoder.h"
+#include "cast/standalone_sender/streaming_video_encoder.h"
+#include "cast/standalone_sender/streaming_vp8_encoder.h"
+#include "cast/standalone_sender/streaming_vp9_encoder.h"
+#include "cast/streaming/constants.h"
+#include "cast/streaming/encoded_frame.h"
+#include "cast/streaming/environment.h"
+#include "cast/streaming/message_fields.h"
+#include "cast/streaming/receiver.h"
+#include "cast/streaming/receiver_packet_router.h"
+#include "cast/streaming/rtp_defines.h"
+#include "cast/streaming/sender.h"
+#include "cast/streaming/sender_packet_router.h"
+#include "cast/streaming/session_config.h"
+#include "cast/streaming/ssrc.h"
+#include "platform/api/time.h"
+#include "platform/impl/logging.h"
+#include "platform/impl/platform_client_posix.h"
+#include "platform/impl/task_runner.h"
+#include "util/chrono_helpers.h"
+#include "util/crypto/random_bytes.h"
+#include "util/osp_logging.h"
+#include "util/stringprintf.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+using encoded_frame_file::TrackType;
+
+constexpr int kDefaultVideoBitrate = 4 << 20;  // 4 Mbps.
+constexpr Clock::duration kDefaultKeyFrameInterval = seconds(2);
+
+void LogUsage(const char* argv0) {
+  constexpr char kTemplate[] = R"(
+usage: %s <options> media_file output_file
+
+   Encodes the audio and video of media_file, in real time, into a pre-encoded
+   clip that cast_sender can replay with its --preencoded option.
+
+      -c, --codec=vp8|vp9
+           The video codec. Default if not set: vp8
+
+      -b, --bitrate=N
+           Video bitrate, in bits per second. Since a pre-encoded clip is always
+           replayed as-is, choose this to suit the network used for testing.
+
+           Default if not set: %d
+
+      -k, --key-frame-interval=N
+           Maximum number of milliseconds between video key frames. Replay can
+           only recover from frame drops at a key frame.
+
+           Default if not set: %d
+
+      -v, --verbose: Enable verbose logging.
+
+      -h, --help: Show this help message.
+)";
+  std::cerr << StringPrintf(
+      kTemplate, argv0, kDefaultVideoBitrate,
+      static_cast<int>(to_milliseconds(kDefaultKeyFrameInterval).count()));
+}
+
+// Writes each frame delivered by a Receiver to one track of the output file.
+class TrackRecorder final : public Receiver::Consumer {
+ public:
+  TrackRecorder(Receiver* receiver,
+                EncodedFrameFileWriter* writer,
+                int track_index)
+      : receiver_(receiver), writer_(writer), track_index_(track_index) {
+    receiver_->SetConsumer(this);
+  }
+
+  ~TrackRecorder() final { receiver_->SetConsumer(nullptr); }
+
+  int num_frames_recorded() const { return num_frames_recorded_; }
+
+ private:
+  // Receiver::Consumer implementation.
+  void OnFramesReady(int next_frame_buffer_size) final {
+    do {
+      buffer_.resize(next_frame_buffer_size);
+      const EncodedFrame frame =
+          receiver_->ConsumeNextFrame(absl::Span<uint8_t>(buffer_));
+      const Error result = writer_->AppendFrame(track_index_, frame);
+      if (!result.ok()) {
+        OSP_LOG_FATAL << "Failed to write frame: " << result;
+      }
+      ++num_frames_recorded_;
+      next_frame_buffer_size = receiver_->AdvanceToNextFrame();
+    } while (next_frame_buffer_size != Receiver::kNoFramesReady);
+  }
+
+  Receiver* const receiver_;
+  EncodedFrameFileWriter* const writer_;
+  const int track_index_;
+  std::vector<uint8_t> buffer_;
+  int num_frames_recorded_ = 0;
+};
+
+// Streams the media file, once, through loopback Sender/Receiver pairs, and
+// records what the Receivers get.
+class Preencoder final : public SimulatedAudioCapturer::Client,
+                         public SimulatedVideoCapturer::Client,
+                         public Environment::SocketSubscriber {
+ public:
+  // |done_callback| is run once the whole file has been processed (or on
+  // failure), with the result of finishing the output file.
+  Preencoder(TaskRunner* task_runner,
+             const char* path,
+             EncodedFrameFileWriter* writer,
+             VideoCodec codec,
+             const StreamingVideoEncoder::Parameters& video_params,
+             int video_bitrate,
+             std::function<void(Error)> done_callback)
+      : task_runner_(task_runner),
+        path_(path),
+        writer_(writer),
+        codec_(codec),
+        video_params_(video_params),
+        video_bitrate_(video_bitrate),
+        done_callback_(std::move(done_callback)),
+        receiver_env_(&Clock::now,
+                      task_runner_,
+                      IPEndpoint{IPAddress::kV4LoopbackAddress(), 0}) {
+    // The Sender side is set up once the Receivers' UDP socket is bound, since
+    // its port number is not known until then.
+    receiver_env_.SetSocketSubscriber(this);
+  }
+
+  ~Preencoder() final = default;
+
+ private:
+  // Creates a Sender and Receiver pair, using the same SessionConfig for both.
+  void CreateStream(int rtp_timebase,
+                    int channels,
+                    RtpPayloadType payload_type,
+                    std::unique_ptr<Sender>* sender,
+                    std::unique_ptr<Receiver>* receiver) {
+    const SessionConfig config(GenerateSsrc(channels > 1), GenerateSsrc(false),
+                               rtp_timebase, channels,
+                               kDefaultTargetPlayoutDelay,
+                               GenerateRandomBytes16(), GenerateRandomBytes16(),
+                               true /* is_pli_enabled */);
+    *receiver = std::make_unique<Receiver>(&receiver_env_,
+                                           receiver_router_.get(), config);
+    *sender = std::make_unique<Sender>(sender_env_.get(), sender_router_.get(),
+                                       config, payload_type);
+  }
+
+  // Environment::SocketSubscriber implementation.
+  void OnSocketReady() final {
+    if (sender_env_) {
+      return;  // This is the Sender's socket becoming ready.
+    }
+
+    receiver_router_ = std::make_unique<ReceiverPacketRouter>(&receiver_env_);
+    sender_env_ = std::make_unique<Environment>(
+        &Clock::now, task_runner_,
+        IPEndpoint{IPAddress::kV4LoopbackAddress(), 0});
+    sender_env_->set_remote_endpoint(receiver_env_.GetBoundLocalEndpoint());
+    sender_router_ = std::make_unique<SenderPacketRouter>(sender_env_.get());
+
+    CreateStream(kDefaultAudioSampleRate, kDefaultAudioChannels,
+                 GetPayloadType(AudioCodec::kOpus), &audio_sender_,
+                 &audio_receiver_);
+    CreateStream(kRtpVideoTimebase, 1, GetPayloadType(codec_), &video_sender_,
+                 &video_receiver_);
+
+    audio_recorder_.emplace(
+        audio_receiver_.get(), writer_,
+        writer_->AddTrack(TrackType::kAudio, CodecToString(AudioCodec::kOpus),
+                          kDefaultAudioSampleRate, kDefaultAudioChannels));
+    video_recorder_.emplace(
+        video_receiver_.get(), writer_,
+        writer_->AddTrack(TrackType::kVideo, CodecToString(codec_),
+                          kRtpVideoTimebase, 1));
+
+    audio_encoder_.emplace(
+        kDefaultAudioChannels,
+        StreamingOpusEncoder::kDefaultCastAudioFramesPerSecond,
+        audio_sender_.get());
+    audio_encoder_->UseHighQuality();
+    if (codec_ == VideoCodec::kVp9) {
+      video_encoder_ = std::make_unique<StreamingVp9Encoder>(
+          video_params_, task_runner_, video_sender_.get());
+    } else {
+      video_encoder_ = std::make_unique<StreamingVp8Encoder>(
+          video_params_, task_runner_, video_sender_.get());
+    }
+    video_encoder_->SetTargetBitrate(video_bitrate_);
+
+    const Clock::time_point start_time = Clock::now() + milliseconds(100);
+    num_capturers_running_ = 2;
+    audio_capturer_.emplace(sender_env_.get(), path_,
+                            audio_encoder_->num_channels(),
+                            audio_encoder_->sample_rate(), start_time, this);
+    video_capturer_.emplace(sender_env_.get(), path_, start_time, this);
+    OSP_LOG_INFO << "Encoding " << path_ << " in real time...";
+  }
+
+  void OnSocketInvalid(Error error) final {
+    OSP_LOG_ERROR << "Loopback UDP socket failed: " << error;
+    done_callback_(std::move(error));
+  }
+
+  // SimulatedAudioCapturer::Client implementation.
+  void OnAudioData(const float* interleaved_samples,
+                   int num_samples,
+                   Clock::time_point capture_time) final {
+    audio_encoder_->EncodeAndSend(interleaved_samples, num_samples,
+                                  capture_time);
+  }
+
+  // SimulatedVideoCapturer::Client implementation.
+  void OnVideoFrame(const AVFrame& av_frame,
+                    Clock::time_point capture_time) final {
+    StreamingVideoEncoder::VideoFrame frame{};
+    frame.width = av_frame.width - av_frame.crop_left - av_frame.crop_right;
+    frame.height = av_frame.height - av_frame.crop_top - av_frame.crop_bottom;
+    frame.yuv_planes[0] = av_frame.data[0] + av_frame.crop_left +
+                          av_frame.linesize[0] * av_frame.crop_top;
+    frame.yuv_planes[1] = av_frame.data[1] + av_frame.crop_left / 2 +
+                          av_frame.linesize[1] * av_frame.crop_top / 2;
+    frame.yuv_planes[2] = av_frame.data[2] + av_frame.crop_left / 2 +
+                          av_frame.linesize[2] * av_frame.crop_top / 2;
+    for (int i = 0; i < 3; ++i) {
+      frame.yuv_strides[i] = av_frame.linesize[i];
+    }
+    video_encoder_->EncodeAndSend(frame, capture_time, {});
+  }
+
+  // SimulatedCapturer::Observer implementation.
+  void OnEndOfFile(SimulatedCapturer* capturer) final {
+    if (--num_capturers_running_ > 0) {
+      return;
+    }
+    // Allow time for the last frames to be encoded, sent, and played out at
+    // the Receivers.
+    task_runner_->PostTaskWithDelay(
+        [this] {
+          OSP_LOG_INFO << "Recorded " << audio_recorder_->num_frames_recorded()
+                       << " audio frames and "
+                       << video_recorder_->num_frames_recorded()
+                       << " video frames.";
+          done_callback_(writer_->Finish());
+        },
+        2 * kDefaultTargetPlayoutDelay);
+  }
+
+  void OnError(SimulatedCapturer* capturer, std::string message) final {
+    done_callback_(Error(Error::Code::kUnknownError, std::move(message)));
+  }
+
+  TaskRunner* const task_runner_;
+  const char* const path_;
+  EncodedFrameFileWriter* const writer_;
+  const VideoCodec codec_;
+  const StreamingVideoEncoder::Parameters video_params_;
+  const int video_bitrate_;
+  const std::function<void(Error)> done_callback_;
+
+  Environment receiver_env_;
+  std::unique_ptr<ReceiverPacketRouter> receiver_router_;
+  std::unique_ptr<Receiver> audio_receiver_;
+  std::unique_ptr<Receiver> video_receiver_;
+  absl::optional<TrackRecorder> audio_recorder_;
+  absl::optional<TrackRecorder> video_recorder_;
+
+  std::unique_ptr<Environment> sender_env_;
+  std::unique_ptr<SenderPacketRouter> sender_router_;
+  std::unique_ptr<Sender> audio_sender_;
+  std::unique_ptr<Sender> video_sender_;
+  absl::optional<StreamingOpusEncoder> audio_encoder_;
+  std::unique_ptr<StreamingVideoEncoder> video_encoder_;
+
+  int num_capturers_running_ = 0;
+  absl::optional<SimulatedAudioCapturer> audio_capturer_;
+  absl::optional<SimulatedVideoCapturer> video_capturer_;
+};
+
+int PreencoderMain(int argc, char* argv[]) {
+  const struct option kArgumentOptions[] = {
+      {"codec", required_argument, nullptr, 'c'},
+      {"bitrate", required_argument, nullptr, 'b'},
+      {"key-frame-interval", required_argument, nullptr, 'k'},
+      {"verbose", no_argument, nullptr, 'v'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, 0}};
+
+  VideoCodec codec = VideoCodec::kVp8;
+  int video_bitrate = kDefaultVideoBitrate;
+  StreamingVideoEncoder::Parameters video_params;
+  video_params.key_frame_interval = kDefaultKeyFrameInterval;
+  bool is_verbose = false;
+  int ch = -1;
+  while ((ch = getopt_long(argc, argv, "c:b:k:vh", kArgumentOptions,
+                           nullptr)) != -1) {
+    switch (ch) {
+      case 'c': {
+        const ErrorOr<VideoCodec> parsed_codec = StringToVideoCodec(optarg);
+        if (parsed_codec.is_error() ||
+            (parsed_codec.value() != VideoCodec::kVp8 &&
+             parsed_codec.value() != VideoCodec::kVp9)) {
+          OSP_LOG_ERROR << "Invalid --codec specified: " << optarg;
+          LogUsage(argv[0]);
+          return 1;
+        }
+        codec = parsed_codec.value();
+        break;
+      }
+      case 'b':
+        video_bitrate = atoi(optarg);
+        break;
+      case 'k':
+        video_params.key_frame_interval = milliseconds(atoi(optarg));
+        break;
+      case 'v':
+        is_verbose = true;
+        break;
+      case 'h':
+        LogUsage(argv[0]);
+        return 1;
+    }
+  }
+  if (optind != (argc - 2) || video_bitrate <= 0 ||
+      video_params.key_frame_interval <= Clock::duration::zero()) {
+    LogUsage(argv[0]);
+    return 1;
+  }
+  const char* const input_path = argv[optind++];
+  const char* const output_path = argv[optind];
+
+  openscreen::SetLogLevel(is_verbose ? openscreen::LogLevel::kVerbose
+                                     : openscreen::LogLevel::kInfo);
+
+  ErrorOr<std::unique_ptr<EncodedFrameFileWriter>> writer =
+      EncodedFrameFileWriter::Create(output_path);
+  if (writer.is_error()) {
+    OSP_LOG_ERROR << writer.error();
+    return 1;
+  }
+
+  auto* const task_runner = new TaskRunnerImpl(&Clock::now);
+  PlatformClientPosix::Create(milliseconds(50),
+                              std::unique_ptr<TaskRunnerImpl>(task_runner));
+
+  // |preencoder| must be constructed and destroyed from a Task run by the
+  // TaskRunner.
+  Preencoder* preencoder = nullptr;
+  Error result = Error::None();
+  task_runner->PostTask([&] {
+    preencoder = new Preencoder(task_runner, input_path, writer.value().get(),
+                                codec, video_params, video_bitrate,
+                                [&](Error error) {
+                                  result = std::move(error);
+                                  task_runner->RequestStopSoon();
+                                });
+  });
+  task_runner->RunUntilStopped();
+  task_runner->PostTask([&] {
+    delete preencoder;
+    task_runner->RequestStopSoon();
+  });
+  task_runner->RunUntilStopped();
+
+  PlatformClientPosix::ShutDown();
+
+  if (!result.ok()) {
+    OSP_LOG_ERROR << "Pre-encoding failed: " << result;
+    return 2;
+  }
+  OSP_LOG_INFO << "Wrote " << output_path;
+  return 0;
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
+
+int main(int argc, char* argv[]) {
+  return openscreen::cast::PreencoderMain(argc, argv);
+}
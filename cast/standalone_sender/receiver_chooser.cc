@@ -120,12 +120,15 @@ void ReceiverChooser::PrintMenuAndHandleChoice() {
         menu_choice < static_cast<int>(discovered_receivers_.size())) {
       const ServiceInfo& choice = discovered_receivers_[menu_choice];
       if (choice.v6_address) {
-        callback_on_stack(IPEndpoint{choice.v6_address, choice.port});
+        callback_on_stack(IPEndpoint{choice.v6_address, choice.port},
+                          choice.unique_id);
       } else {
-        callback_on_stack(IPEndpoint{choice.v4_address, choice.port});
+        callback_on_stack(IPEndpoint{choice.v4_address, choice.port},
+                          choice.unique_id);
       }
     } else {
-      callback_on_stack(IPEndpoint{});  // Signal "bad choice" or EOF.
+      // Signal "bad choice" or EOF.
+      callback_on_stack(IPEndpoint{}, std::string());
     }
     return;
   }
@@ -7,6 +7,7 @@
 
 #include <functional>
 #include <memory>
+#include <string>
 #include <vector>
 
 #include "cast/common/public/service_info.h"
@@ -27,7 +28,10 @@ namespace cast {
 // provides a console menu interface for the user to choose one.
 class ReceiverChooser final : public discovery::ReportingClient {
  public:
-  using ResultCallback = std::function<void(IPEndpoint)>;
+  // Called with the endpoint and unique ID (see ServiceInfo::unique_id) of the
+  // chosen Cast Receiver, or a zero-port endpoint if none was chosen.
+  using ResultCallback =
+      std::function<void(IPEndpoint endpoint, std::string unique_id)>;
 
   ReceiverChooser(const InterfaceInfo& interface,
                   TaskRunner* task_runner,
@@ -27,6 +27,39 @@ constexpr opus_int32 kTransparentBitrate = 160000;
 // skipping-ahead the RTP timestamps to compensate.
 constexpr int kMaxCastFramesBeforeSkip = 3;
 
+// The longest frame duration supported by Opus.
+constexpr int kMaxFrameDurationMillis = 60;
+
+// In-band FEC is enabled once the packet loss reaches the first fraction, and
+// disabled once it falls below the second. The gap prevents flapping.
+constexpr double kFecEnableLossFraction = 0.02;
+constexpr double kFecDisableLossFraction = 0.005;
+
+// The frame durations to use, from longest to shortest, and the round trip
+// times and bandwidths that call for each. 10 ms is used otherwise.
+struct FrameDurationThreshold {
+  int duration_millis;
+  milliseconds min_round_trip_time;
+  int max_bandwidth;
+};
+constexpr FrameDurationThreshold kFrameDurationThresholds[] = {
+    {60, milliseconds(200), 512 << 10},  // 512 kbps.
+    {40, milliseconds(100), 1 << 20},    // 1 Mbps.
+    {20, milliseconds(50), 2 << 20},     // 2 Mbps.
+};
+constexpr int kMinFrameDurationMillis = 10;
+
+int ChooseFrameDurationMillis(const NetworkConditions& conditions) {
+  for (const FrameDurationThreshold& threshold : kFrameDurationThresholds) {
+    if (conditions.round_trip_time >= threshold.min_round_trip_time ||
+        (conditions.bandwidth > 0 &&
+         conditions.bandwidth < threshold.max_bandwidth)) {
+      return threshold.duration_millis;
+    }
+  }
+  return kMinFrameDurationMillis;
+}
+
 }  // namespace
 
 StreamingOpusEncoder::StreamingOpusEncoder(int num_channels,
@@ -38,11 +71,15 @@ StreamingOpusEncoder::StreamingOpusEncoder(int num_channels,
       approximate_cast_frame_duration_(Clock::to_duration(seconds(1)) /
                                        cast_frames_per_second),
       encoder_storage_(new uint8_t[opus_encoder_get_size(num_channels_)]),
-      input_(new float[num_channels_ * samples_per_cast_frame_]),
-      output_(new uint8_t[kOpusMaxPayloadSize]) {
+      input_(new float[num_channels_ * sample_rate() *
+                       kMaxFrameDurationMillis / 1000]),
+      output_(new uint8_t[kOpusMaxPayloadSize]),
+      next_samples_per_cast_frame_(samples_per_cast_frame_) {
   OSP_CHECK_GT(cast_frames_per_second, 0);
   OSP_DCHECK(sender_);
   OSP_CHECK_GT(samples_per_cast_frame_, 0);
+  OSP_CHECK_LE(samples_per_cast_frame_,
+               sample_rate() * kMaxFrameDurationMillis / 1000);
   OSP_CHECK_EQ(sample_rate() % cast_frames_per_second, 0);
   OSP_CHECK(approximate_cast_frame_duration_ > Clock::duration::zero());
 
@@ -82,6 +119,34 @@ void StreamingOpusEncoder::UseHighQuality() {
   UpdateCodecDelay();
 }
 
+void StreamingOpusEncoder::SetNetworkConditions(
+    const NetworkConditions& conditions) {
+  const bool should_enable_fec =
+      is_fec_enabled_
+          ? (conditions.packet_loss_fraction >= kFecDisableLossFraction)
+          : (conditions.packet_loss_fraction >= kFecEnableLossFraction);
+  if (should_enable_fec != is_fec_enabled_) {
+    OSP_LOG_INFO << "AUDIO[" << sender_->ssrc() << "] "
+                 << (should_enable_fec ? "Enabling" : "Disabling")
+                 << " in-band FEC, at " << conditions.packet_loss_fraction
+                 << " packet loss.";
+    is_fec_enabled_ = should_enable_fec;
+    const auto ctl_result = opus_encoder_ctl(
+        encoder(), OPUS_SET_INBAND_FEC(is_fec_enabled_ ? 1 : 0));
+    OSP_CHECK_EQ(ctl_result, OPUS_OK);
+  }
+  // The expected loss tells the encoder how much redundancy to spend bits on.
+  const auto ctl_result = opus_encoder_ctl(
+      encoder(), OPUS_SET_PACKET_LOSS_PERC(std::min(
+                     100, static_cast<int>(
+                              conditions.packet_loss_fraction * 100 + 0.5))));
+  OSP_CHECK_EQ(ctl_result, OPUS_OK);
+
+  next_samples_per_cast_frame_ =
+      sample_rate() * ChooseFrameDurationMillis(conditions) / 1000;
+  MaybeChangeFrameSize();
+}
+
 void StreamingOpusEncoder::EncodeAndSend(const float* interleaved_samples,
                                          int num_samples,
                                          Clock::time_point reference_time) {
@@ -136,6 +201,7 @@ void StreamingOpusEncoder::EncodeAndSend(const float* interleaved_samples,
 
     frame_.rtp_timestamp += RtpTimeDelta::FromTicks(samples_per_cast_frame_);
     frame_.reference_time += approximate_cast_frame_duration_;
+    MaybeChangeFrameSize();
   }
 }
 
@@ -148,6 +214,19 @@ void StreamingOpusEncoder::UpdateCodecDelay() {
       sample_rate());
 }
 
+void StreamingOpusEncoder::MaybeChangeFrameSize() {
+  if (next_samples_per_cast_frame_ == samples_per_cast_frame_ ||
+      num_samples_queued_ > 0) {
+    return;
+  }
+  samples_per_cast_frame_ = next_samples_per_cast_frame_;
+  approximate_cast_frame_duration_ =
+      RtpTimeDelta::FromTicks(samples_per_cast_frame_)
+          .ToDuration<Clock::duration>(sample_rate());
+  OSP_LOG_INFO << "AUDIO[" << sender_->ssrc() << "] Frame duration is now "
+               << approximate_cast_frame_duration_ << '.';
+}
+
 void StreamingOpusEncoder::ResolveTimestampsAndMaybeSkip(
     Clock::time_point reference_time) {
   // Back-track the reference time to account for the audio delay introduced by
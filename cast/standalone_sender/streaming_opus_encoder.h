@@ -10,6 +10,7 @@
 #include <memory>
 
 #include "cast/streaming/encoded_frame.h"
+#include "cast/streaming/network_history_cache.h"
 #include "cast/streaming/sender.h"
 #include "platform/api/time.h"
 
@@ -27,9 +28,9 @@ class StreamingOpusEncoder {
  public:
   // Constructs the encoder for mono or stereo sound, dividing the stream of
   // audio samples up into chunks as determined by the given
-  // |cast_frames_per_second|, and for EncodedFrame output to the given
-  // |sender|. The sample rate of the audio is assumed to be the Sender's fixed
-  // |rtp_timebase()|.
+  // |cast_frames_per_second| (until SetNetworkConditions() says otherwise), and
+  // for EncodedFrame output to the given |sender|. The sample rate of the audio
+  // is assumed to be the Sender's fixed |rtp_timebase()|.
   StreamingOpusEncoder(int num_channels,
                        int cast_frames_per_second,
                        Sender* sender);
@@ -54,6 +55,26 @@ class StreamingOpusEncoder {
   // be called as often as needed as conditions change.
   void UseHighQuality();
 
+  // Adapts the encoding to the current network |conditions|. This may be called
+  // as often as needed as conditions change:
+  //
+  //   1. When packets are being lost, Opus in-band forward error correction is
+  //      enabled, so that a Receiver can recover the audio of a lost frame from
+  //      the next one, without waiting on a retransmission. (Note that libopus
+  //      only does this in its SILK and hybrid modes; i.e., at lower bitrates.)
+  //   2. The frame duration (10, 20, 40 or 60 ms) is increased as the round
+  //      trip time increases, or the bandwidth decreases. Longer frames mean
+  //      fewer packets, and less per-packet overhead, under congestion. Shorter
+  //      frames mean lower latency when the network is good.
+  //
+  // A change in frame duration takes effect at the next frame boundary.
+  void SetNetworkConditions(const NetworkConditions& conditions);
+
+  // The duration of the Cast audio frames currently being produced.
+  Clock::duration frame_duration() const {
+    return approximate_cast_frame_duration_;
+  }
+
   // Encode and send the given |interleaved_samples|, which contains
   // |num_samples| tuples (i.e., multiply by the number of channels to determine
   // the number of array elements). The audio is assumed to have been captured
@@ -74,6 +95,10 @@ class StreamingOpusEncoder {
   // Updates the |codec_delay_| based on the current encoder settings.
   void UpdateCodecDelay();
 
+  // Changes the frame size to |next_samples_per_cast_frame_|, if different
+  // and there are no samples queued for the current frame.
+  void MaybeChangeFrameSize();
+
   // Sets the next frame's reference time, accounting for codec buffering delay.
   // Also, checks whether the reference time has drifted too far forwards, and
   // skips if necessary.
@@ -85,12 +110,20 @@ class StreamingOpusEncoder {
 
   const int num_channels_;
   Sender* const sender_;
-  const int samples_per_cast_frame_;
-  const Clock::duration approximate_cast_frame_duration_;
+  int samples_per_cast_frame_;
+  Clock::duration approximate_cast_frame_duration_;
   const std::unique_ptr<uint8_t[]> encoder_storage_;
-  const std::unique_ptr<float[]> input_;     // Interleaved audio samples.
+  // Interleaved audio samples, with room for the longest frame duration.
+  const std::unique_ptr<float[]> input_;
   const std::unique_ptr<uint8_t[]> output_;  // Opus-encoded packet.
 
+  // The frame size chosen by SetNetworkConditions(), to be used once the
+  // current frame is complete.
+  int next_samples_per_cast_frame_;
+
+  // Whether in-band forward error correction is currently enabled.
+  bool is_fec_enabled_ = false;
+
   // The audio delay introduced by the codec.
   Clock::duration codec_delay_{};
 
@@ -0,0 +1,19 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/standalone_sender/streaming_video_encoder.h"
+
+namespace openscreen {
+namespace cast {
+
+StreamingVideoEncoder::StreamingVideoEncoder() = default;
+
+StreamingVideoEncoder::~StreamingVideoEncoder() = default;
+
+// static
+constexpr int StreamingVideoEncoder::kMinQuantizer;
+constexpr int StreamingVideoEncoder::kMaxQuantizer;
+
+}  // namespace cast
+}  // namespace openscreen
@@ -0,0 +1,90 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/standalone_sender/streaming_vp9_encoder.h"
+
+#include <vpx/vp8cx.h>
+
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+namespace {
+
+// Highest/lowest allowed encoding speed set to the encoder. libvpx only enables
+// its real-time VP9 code paths for speeds [5, 9]. Below 5, encode time grows
+// far faster than quality does; and 9 is the fastest setting libvpx provides.
+constexpr int kHighestEncodingSpeed = 9;
+constexpr int kLowestEncodingSpeed = 5;
+
+// The VP9 encoder splits each frame into at most 2^kMaxLog2TileColumns tile
+// columns, each at least kMinTileColumnWidth pixels wide (a limit imposed by
+// the VP9 bitstream). Tiles are encoded in parallel, one per thread.
+constexpr int kMaxLog2TileColumns = 6;
+constexpr int kMinTileColumnWidth = 256;
+
+// Adaptive quantization mode 3 ("cyclic refresh") is what libvpx recommends for
+// real-time streaming: It spreads intra-coded refresh blocks across frames,
+// improving quality after loss without the bitrate spike of a key frame.
+constexpr unsigned int kCyclicRefreshAqMode = 3;
+
+// Returns the base-2 logarithm of the number of tile columns to use, so that
+// each encode thread can work on its own tile column, but without going past
+// the bitstream limit for the given frame |width|.
+int ComputeLog2TileColumns(int width, int num_threads) {
+  int log2_tile_columns = 0;
+  while (log2_tile_columns < kMaxLog2TileColumns &&
+         (1 << (log2_tile_columns + 1)) <= num_threads &&
+         (width >> (log2_tile_columns + 1)) >= kMinTileColumnWidth) {
+    ++log2_tile_columns;
+  }
+  return log2_tile_columns;
+}
+
+void ApplyVp9EncoderControls(vpx_codec_ctx_t* encoder,
+                             const vpx_codec_enc_cfg_t& config) {
+  // Encode tile columns in parallel, and also parallelize the encoding of the
+  // rows within each tile column ("row-based multithreading"). The latter keeps
+  // all threads busy even when the frame is too narrow for one tile column per
+  // thread.
+  const int log2_tile_columns =
+      ComputeLog2TileColumns(config.g_w, config.g_threads);
+  auto ctl_result =
+      vpx_codec_control(encoder, VP9E_SET_TILE_COLUMNS, log2_tile_columns);
+  OSP_CHECK_EQ(ctl_result, VPX_CODEC_OK);
+  ctl_result = vpx_codec_control(encoder, VP9E_SET_ROW_MT, 1);
+  OSP_CHECK_EQ(ctl_result, VPX_CODEC_OK);
+
+  ctl_result =
+      vpx_codec_control(encoder, VP9E_SET_AQ_MODE, kCyclicRefreshAqMode);
+  OSP_CHECK_EQ(ctl_result, VPX_CODEC_OK);
+
+  // Raise the threshold for considering macroblocks as static. The default is
+  // zero, so this setting makes the encoder less sensitive to motion. This
+  // lowers the probability of needing to utilize more CPU to search for
+  // motion vectors.
+  ctl_result = vpx_codec_control(encoder, VP8E_SET_STATIC_THRESHOLD, 1);
+  OSP_CHECK_EQ(ctl_result, VPX_CODEC_OK);
+}
+
+}  // namespace
+
+StreamingVp9Encoder::StreamingVp9Encoder(const Parameters& params,
+                                         TaskRunner* task_runner,
+                                         Sender* sender)
+    : StreamingVpxEncoder(
+          // Unlike VP8, the VP9 encoder has no automatic speed selection logic
+          // to be turned off, and so the speed is passed as-is.
+          CodecTraits{vpx_codec_vp9_cx(), kLowestEncodingSpeed,
+                      kHighestEncodingSpeed, false /* negate_speed */,
+                      &ApplyVp9EncoderControls},
+          params,
+          task_runner,
+          sender) {}
+
+StreamingVp9Encoder::~StreamingVp9Encoder() = default;
+
+}  // namespace cast
+}  // namespace openscreen
@@ -0,0 +1,38 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STANDALONE_SENDER_STREAMING_VP9_ENCODER_H_
+#define CAST_STANDALONE_SENDER_STREAMING_VP9_ENCODER_H_
+
+#include "cast/standalone_sender/streaming_vpx_encoder.h"
+
+namespace openscreen {
+
+class TaskRunner;
+
+namespace cast {
+
+class Sender;
+
+// Uses libvpx to encode VP9 video and streams it to a Sender. VP9 requires
+// significantly fewer bits than VP8 for the same visual quality (especially for
+// screen content), at the cost of more CPU per frame. To keep that cost in
+// check, this uses the same real-time speed adaptation logic as
+// StreamingVp8Encoder (see StreamingVpxEncoder), plus VP9's tile-based and
+// row-based multithreading.
+//
+// See StreamingVideoEncoder for usage details.
+class StreamingVp9Encoder final : public StreamingVpxEncoder {
+ public:
+  StreamingVp9Encoder(const Parameters& params,
+                      TaskRunner* task_runner,
+                      Sender* sender);
+
+  ~StreamingVp9Encoder() final;
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STANDALONE_SENDER_STREAMING_VP9_ENCODER_H_
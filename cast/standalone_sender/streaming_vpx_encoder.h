@@ -0,0 +1,212 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STANDALONE_SENDER_STREAMING_VPX_ENCODER_H_
+#define CAST_STANDALONE_SENDER_STREAMING_VPX_ENCODER_H_
+
+#include <vpx/vpx_encoder.h>
+#include <vpx/vpx_image.h>
+
+#include <condition_variable>  // NOLINT
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "absl/base/thread_annotations.h"
+#include "cast/standalone_sender/streaming_video_encoder.h"
+#include "cast/streaming/rtp_time.h"
+#include "platform/api/task_runner.h"
+#include "platform/api/time.h"
+
+namespace openscreen {
+
+class TaskRunner;
+
+namespace cast {
+
+class Sender;
+
+// Uses one of the libvpx video codecs to encode video and streams it to a
+// Sender. Includes extensive logic for fine-tuning the encoder parameters in
+// real-time, to provide the best quality results given external,
+// uncontrollable factors: CPU/network availability, and the complexity of the
+// video frame content. The subclasses provide the codec-specific parts (see
+// CodecTraits).
+//
+// Internally, a separate encode thread is created and used to prevent blocking
+// the main thread while frames are being encoded. All public API methods are
+// assumed to be called on the same sequence/thread as the main TaskRunner
+// (injected via the constructor).
+//
+// See StreamingVideoEncoder for usage details.
+class StreamingVpxEncoder : public StreamingVideoEncoder {
+ public:
+  ~StreamingVpxEncoder() override;
+
+  // StreamingVideoEncoder implementation.
+  int GetTargetBitrate() const final;
+  void SetTargetBitrate(int new_bitrate) final;
+  void EncodeAndSend(const VideoFrame& frame,
+                     Clock::time_point reference_time,
+                     std::function<void(Stats)> stats_callback) final;
+
+ protected:
+  // Describes a libvpx video codec, and how to tune its encoder for real-time
+  // streaming.
+  struct CodecTraits {
+    // The libvpx encoder interface, e.g., vpx_codec_vp8_cx().
+    vpx_codec_iface_t* codec_interface;
+
+    // The range of VP8E_SET_CPUUSED speed settings to choose from, where
+    // larger values (i.e., faster speed) request less CPU usage but will
+    // provide lower video quality.
+    int lowest_speed;
+    int highest_speed;
+
+    // Whether the speed must be passed to VP8E_SET_CPUUSED as a negative value,
+    // to turn off the codec's automatic speed selection logic and force the
+    // exact setting.
+    bool negate_speed;
+
+    // Applies the codec-specific controls to a newly-initialized |encoder|,
+    // given its |config|. Called on the encode thread.
+    void (*apply_controls)(vpx_codec_ctx_t* encoder,
+                           const vpx_codec_enc_cfg_t& config);
+  };
+
+  StreamingVpxEncoder(const CodecTraits& codec,
+                      const Parameters& params,
+                      TaskRunner* task_runner,
+                      Sender* sender);
+
+ private:
+  // Syntactic convenience to wrap the vpx_image_t alloc/free API in a smart
+  // pointer.
+  struct VpxImageDeleter {
+    void operator()(vpx_image_t* ptr) const { vpx_img_free(ptr); }
+  };
+  using VpxImageUniquePtr = std::unique_ptr<vpx_image_t, VpxImageDeleter>;
+
+  // Represents the state of one frame encode. This is created in
+  // EncodeAndSend(), and passed to the encode thread via the |encode_queue_|.
+  struct WorkUnit {
+    VpxImageUniquePtr image;
+    Clock::duration duration;
+    Clock::time_point reference_time;
+    RtpTimeTicks rtp_timestamp;
+    std::function<void(Stats)> stats_callback;
+  };
+
+  // Same as WorkUnit, but with additional fields to carry the encode results.
+  struct WorkUnitWithResults : public WorkUnit {
+    std::vector<uint8_t> payload;
+    bool is_key_frame;
+    Stats stats;
+  };
+
+  bool is_encoder_initialized() const { return config_.g_threads != 0; }
+
+  // Destroys the encoder context if it has been initialized.
+  void DestroyEncoder();
+
+  // The procedure for the |encode_thread_| that loops, processing work units
+  // from the |encode_queue_| by calling Encode() until it's time to end the
+  // thread.
+  void ProcessWorkUnitsUntilTimeToQuit();
+
+  // If the |encoder_| is live, attempt reconfiguration to allow it to encode
+  // frames at a new frame size, target bitrate, or "CPU encoding speed." If
+  // reconfiguration is not possible, destroy the existing instance and
+  // re-create a new |encoder_| instance.
+  void PrepareEncoder(int width, int height, int target_bitrate);
+
+  // Wraps the complex libvpx vpx_codec_encode() call using inputs from
+  // |work_unit| and populating results there.
+  void EncodeFrame(bool force_key_frame, WorkUnitWithResults* work_unit);
+
+  // Computes and populates |work_unit.stats| after the last call to
+  // EncodeFrame().
+  void ComputeFrameEncodeStats(Clock::duration encode_wall_time,
+                               int target_bitrate,
+                               WorkUnitWithResults* work_unit);
+
+  // Updates the |ideal_speed_setting_|, to take effect with the next frame
+  // encode, based on the given performance |stats|.
+  void UpdateSpeedSettingForNextFrame(const Stats& stats);
+
+  // Assembles and enqueues an EncodedFrame with the Sender on the main thread.
+  void SendEncodedFrame(WorkUnitWithResults results);
+
+  // Allocates a vpx_image_t and copies the content from |frame| to it.
+  static VpxImageUniquePtr CloneAsVpxImage(const VideoFrame& frame);
+
+  const CodecTraits codec_;
+  const Parameters params_;
+  TaskRunner* const main_task_runner_;
+  Sender* const sender_;
+
+  // The reference time of the first frame passed to EncodeAndSend().
+  Clock::time_point start_time_ = Clock::time_point::min();
+
+  // The RTP timestamp of the last frame that was pushed into the
+  // |encode_queue_| by EncodeAndSend(). This is used to check whether
+  // timestamps are monotonically increasing.
+  RtpTimeTicks last_enqueued_rtp_timestamp_;
+
+  // When EncodeAndSend() will next force a key frame, if periodic key frames
+  // were requested via Parameters::key_frame_interval.
+  Clock::time_point next_key_frame_time_ = Clock::time_point::min();
+
+  // Guards a few members shared by both the main and encode threads.
+  std::mutex mutex_;
+
+  // Used by the encode thread to sleep until more work is available.
+  std::condition_variable cv_ ABSL_GUARDED_BY(mutex_);
+
+  // These encode parameters not passed in the WorkUnit struct because it is
+  // desirable for them to be applied as soon as possible, with the very next
+  // WorkUnit popped from the |encode_queue_| on the encode thread, and not to
+  // wait until some later WorkUnit is processed.
+  bool needs_key_frame_ ABSL_GUARDED_BY(mutex_) = true;
+  int target_bitrate_ ABSL_GUARDED_BY(mutex_) = 2 << 20;  // Default: 2 Mbps.
+
+  // The queue of frame encodes. The size of this queue is implicitly bounded by
+  // EncodeAndSend(), where it checks for the total in-flight media duration and
+  // maybe drops a frame.
+  std::queue<WorkUnit> encode_queue_ ABSL_GUARDED_BY(mutex_);
+
+  // Payload buffers released by sent EncodedFrames, for EncodeFrame() to
+  // re-use.
+  std::vector<std::vector<uint8_t>> free_payload_buffers_
+      ABSL_GUARDED_BY(mutex_);
+
+  // Current encoder configuration. Most of the fields are unchanging, and are
+  // populated in the ctor; but thereafter, only the encode thread accesses this
+  // struct.
+  //
+  // The speed setting is controlled via a separate libvpx API (see members
+  // below).
+  vpx_codec_enc_cfg_t config_{};
+
+  // These represent the magnitude of the speed setting, where larger values
+  // (i.e., faster speed) request less CPU usage but will provide lower video
+  // quality. Only the encode thread accesses these.
+  double ideal_speed_setting_;  // A time-weighted average, from measurements.
+  int current_speed_setting_;   // Current |encoder_| speed setting.
+
+  // libvpx encoder instance. Only the encode thread accesses this.
+  vpx_codec_ctx_t encoder_;
+
+  // This member should be last in the class since the thread should not start
+  // until all above members have been initialized by the constructor.
+  std::thread encode_thread_;
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STANDALONE_SENDER_STREAMING_VPX_ENCODER_H_
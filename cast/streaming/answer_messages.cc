@@ -6,10 +6,12 @@
 
 #include <utility>
 
+#include "absl/strings/numbers.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_split.h"
 #include "platform/base/error.h"
 #include "util/json/json_helpers.h"
+#include "util/json/json_serialization.h"
 #include "util/osp_logging.h"
 
 namespace openscreen {
@@ -120,6 +122,9 @@ static constexpr char kReceiverGetStatus[] = "receiverGetStatus";
 // If this optional field is present the receiver supports the specific
 // RTP extensions (such as adaptive playout delay).
 static constexpr char kRtpExtensions[] = "rtpExtensions";
+// True if the receiver supports batches of binary RPC messages. This is not
+// part of the specification.
+static constexpr char kBinaryRpc[] = "binaryRpc";
 
 Json::Value AspectRatioConstraintToJson(AspectRatioConstraint aspect_ratio) {
   switch (aspect_ratio) {
@@ -131,15 +136,10 @@ Json::Value AspectRatioConstraintToJson(AspectRatioConstraint aspect_ratio) {
   }
 }
 
-bool AspectRatioConstraintParseAndValidate(const Json::Value& value,
-                                           AspectRatioConstraint* out) {
-  // the aspect ratio constraint is an optional field.
-  if (!value) {
-    return true;
-  }
-
+bool ReadAspectRatioConstraint(json::JsonReader* reader,
+                               AspectRatioConstraint* out) {
   std::string aspect_ratio;
-  if (!json::ParseAndValidateString(value, &aspect_ratio)) {
+  if (!json::ReadAndValidateString(reader, &aspect_ratio)) {
     return false;
   }
   if (aspect_ratio == kScalingReceiver) {
@@ -152,6 +152,20 @@ bool AspectRatioConstraintParseAndValidate(const Json::Value& value,
   return false;
 }
 
+bool ParseAspectRatio(absl::string_view value, AspectRatio* out) {
+  std::vector<absl::string_view> fields =
+      absl::StrSplit(value, kAspectRatioDelimiter);
+  if (fields.size() != 2) {
+    return false;
+  }
+
+  if (!absl::SimpleAtoi(fields[0], &out->width) ||
+      !absl::SimpleAtoi(fields[1], &out->height)) {
+    return false;
+  }
+  return out->IsValid();
+}
+
 template <typename T>
 Json::Value PrimitiveVectorToJson(const std::vector<T>& vec) {
   Json::Value array(Json::ValueType::arrayValue);
@@ -165,39 +179,49 @@ Json::Value PrimitiveVectorToJson(const std::vector<T>& vec) {
 }
 
 template <typename T>
-bool ParseOptional(const Json::Value& value, absl::optional<T>* out) {
-  // It's fine if the value is empty.
-  if (!value) {
+bool ReadOptional(json::JsonReader* reader, absl::optional<T>* out) {
+  // It's fine if the value is null.
+  if (reader->ReadNull()) {
     return true;
   }
   T tentative_out;
-  if (!T::ParseAndValidate(value, &tentative_out)) {
+  if (!T::Read(reader, &tentative_out)) {
     return false;
   }
-  *out = tentative_out;
+  *out = std::move(tentative_out);
   return true;
 }
 
+// Implements T::ParseAndValidate() in terms of T::Read(), for an object.
+template <typename T>
+bool ParseWithReader(const Json::Value& value, T* out) {
+  if (!value.isObject()) {
+    return false;
+  }
+  const ErrorOr<std::string> document = json::Stringify(value);
+  if (document.is_error()) {
+    return false;
+  }
+  json::JsonReader reader(document.value());
+  return T::Read(&reader, out) && reader.Finish();
+}
+
 }  // namespace
 
 // static
 bool AspectRatio::ParseAndValidate(const Json::Value& value, AspectRatio* out) {
+  // A string is not a JSON document on its own, so this can't go through
+  // Read().
   std::string parsed_value;
-  if (!json::ParseAndValidateString(value, &parsed_value)) {
-    return false;
-  }
-
-  std::vector<absl::string_view> fields =
-      absl::StrSplit(parsed_value, kAspectRatioDelimiter);
-  if (fields.size() != 2) {
-    return false;
-  }
+  return json::ParseAndValidateString(value, &parsed_value) &&
+         ParseAspectRatio(parsed_value, out);
+}
 
-  if (!absl::SimpleAtoi(fields[0], &out->width) ||
-      !absl::SimpleAtoi(fields[1], &out->height)) {
-    return false;
-  }
-  return out->IsValid();
+// static
+bool AspectRatio::Read(json::JsonReader* reader, AspectRatio* out) {
+  std::string parsed_value;
+  return json::ReadAndValidateString(reader, &parsed_value) &&
+         ParseAspectRatio(parsed_value, out);
 }
 
 bool AspectRatio::IsValid() const {
@@ -207,22 +231,43 @@ bool AspectRatio::IsValid() const {
 // static
 bool AudioConstraints::ParseAndValidate(const Json::Value& root,
                                         AudioConstraints* out) {
-  if (!json::ParseAndValidateInt(root[kMaxSampleRate],
-                                 &(out->max_sample_rate)) ||
-      !json::ParseAndValidateInt(root[kMaxChannels], &(out->max_channels)) ||
-      !json::ParseAndValidateInt(root[kMaxBitRate], &(out->max_bit_rate))) {
-    return false;
-  }
+  return ParseWithReader(root, out);
+}
 
-  std::chrono::milliseconds max_delay;
-  if (json::ParseAndValidateMilliseconds(root[kMaxDelay], &max_delay)) {
-    out->max_delay = max_delay;
+// static
+bool AudioConstraints::Read(json::JsonReader* reader, AudioConstraints* out) {
+  if (!json::BeginObjectOrSkip(reader)) {
+    return false;
   }
 
-  if (!json::ParseAndValidateInt(root[kMinBitRate], &(out->min_bit_rate))) {
-    out->min_bit_rate = kDefaultAudioMinBitRate;
+  bool has_max_sample_rate = false;
+  bool has_max_channels = false;
+  bool has_max_bit_rate = false;
+  out->min_bit_rate = kDefaultAudioMinBitRate;
+  absl::string_view key;
+  while (reader->NextMember(&key)) {
+    if (key == kMaxSampleRate) {
+      has_max_sample_rate =
+          json::ReadAndValidateInt(reader, &(out->max_sample_rate));
+    } else if (key == kMaxChannels) {
+      has_max_channels = json::ReadAndValidateInt(reader, &(out->max_channels));
+    } else if (key == kMaxBitRate) {
+      has_max_bit_rate = json::ReadAndValidateInt(reader, &(out->max_bit_rate));
+    } else if (key == kMaxDelay) {
+      std::chrono::milliseconds max_delay;
+      if (json::ReadAndValidateMilliseconds(reader, &max_delay)) {
+        out->max_delay = max_delay;
+      }
+    } else if (key == kMinBitRate) {
+      if (!json::ReadAndValidateInt(reader, &(out->min_bit_rate))) {
+        out->min_bit_rate = kDefaultAudioMinBitRate;
+      }
+    } else {
+      reader->SkipValue();
+    }
   }
-  return out->IsValid();
+  return reader->ok() && has_max_sample_rate && has_max_channels &&
+         has_max_bit_rate && out->IsValid();
 }
 
 Json::Value AudioConstraints::ToJson() const {
@@ -243,14 +288,35 @@ bool AudioConstraints::IsValid() const {
          max_bit_rate >= min_bit_rate;
 }
 
+// static
 bool Dimensions::ParseAndValidate(const Json::Value& root, Dimensions* out) {
-  if (!json::ParseAndValidateInt(root[kWidth], &(out->width)) ||
-      !json::ParseAndValidateInt(root[kHeight], &(out->height)) ||
-      !json::ParseAndValidateSimpleFraction(root[kFrameRate],
-                                            &(out->frame_rate))) {
+  return ParseWithReader(root, out);
+}
+
+// static
+bool Dimensions::Read(json::JsonReader* reader, Dimensions* out) {
+  if (!json::BeginObjectOrSkip(reader)) {
     return false;
   }
-  return out->IsValid();
+
+  bool has_width = false;
+  bool has_height = false;
+  bool has_frame_rate = false;
+  absl::string_view key;
+  while (reader->NextMember(&key)) {
+    if (key == kWidth) {
+      has_width = json::ReadAndValidateInt(reader, &(out->width));
+    } else if (key == kHeight) {
+      has_height = json::ReadAndValidateInt(reader, &(out->height));
+    } else if (key == kFrameRate) {
+      has_frame_rate =
+          json::ReadAndValidateSimpleFraction(reader, &(out->frame_rate));
+    } else {
+      reader->SkipValue();
+    }
+  }
+  return reader->ok() && has_width && has_height && has_frame_rate &&
+         out->IsValid();
 }
 
 bool Dimensions::IsValid() const {
@@ -269,29 +335,47 @@ Json::Value Dimensions::ToJson() const {
 // static
 bool VideoConstraints::ParseAndValidate(const Json::Value& root,
                                         VideoConstraints* out) {
-  if (!Dimensions::ParseAndValidate(root[kMaxDimensions],
-                                    &(out->max_dimensions)) ||
-      !json::ParseAndValidateInt(root[kMaxBitRate], &(out->max_bit_rate)) ||
-      !ParseOptional<Dimensions>(root[kMinDimensions],
-                                 &(out->min_dimensions))) {
-    return false;
-  }
-
-  std::chrono::milliseconds max_delay;
-  if (json::ParseAndValidateMilliseconds(root[kMaxDelay], &max_delay)) {
-    out->max_delay = max_delay;
-  }
+  return ParseWithReader(root, out);
+}
 
-  double max_pixels_per_second;
-  if (json::ParseAndValidateDouble(root[kMaxPixelsPerSecond],
-                                   &max_pixels_per_second)) {
-    out->max_pixels_per_second = max_pixels_per_second;
+// static
+bool VideoConstraints::Read(json::JsonReader* reader, VideoConstraints* out) {
+  if (!json::BeginObjectOrSkip(reader)) {
+    return false;
   }
 
-  if (!json::ParseAndValidateInt(root[kMinBitRate], &(out->min_bit_rate))) {
-    out->min_bit_rate = kDefaultVideoMinBitRate;
+  bool has_max_dimensions = false;
+  bool has_max_bit_rate = false;
+  bool valid_min_dimensions = true;
+  out->min_bit_rate = kDefaultVideoMinBitRate;
+  absl::string_view key;
+  while (reader->NextMember(&key)) {
+    if (key == kMaxDimensions) {
+      has_max_dimensions = Dimensions::Read(reader, &(out->max_dimensions));
+    } else if (key == kMaxBitRate) {
+      has_max_bit_rate = json::ReadAndValidateInt(reader, &(out->max_bit_rate));
+    } else if (key == kMinDimensions) {
+      valid_min_dimensions = ReadOptional(reader, &(out->min_dimensions));
+    } else if (key == kMaxDelay) {
+      std::chrono::milliseconds max_delay;
+      if (json::ReadAndValidateMilliseconds(reader, &max_delay)) {
+        out->max_delay = max_delay;
+      }
+    } else if (key == kMaxPixelsPerSecond) {
+      double max_pixels_per_second;
+      if (json::ReadAndValidateDouble(reader, &max_pixels_per_second)) {
+        out->max_pixels_per_second = max_pixels_per_second;
+      }
+    } else if (key == kMinBitRate) {
+      if (!json::ReadAndValidateInt(reader, &(out->min_bit_rate))) {
+        out->min_bit_rate = kDefaultVideoMinBitRate;
+      }
+    } else {
+      reader->SkipValue();
+    }
   }
-  return out->IsValid();
+  return reader->ok() && has_max_dimensions && has_max_bit_rate &&
+         valid_min_dimensions && out->IsValid();
 }
 
 bool VideoConstraints::IsValid() const {
@@ -325,11 +409,28 @@ Json::Value VideoConstraints::ToJson() const {
 
 // static
 bool Constraints::ParseAndValidate(const Json::Value& root, Constraints* out) {
-  if (!AudioConstraints::ParseAndValidate(root[kAudio], &(out->audio)) ||
-      !VideoConstraints::ParseAndValidate(root[kVideo], &(out->video))) {
+  return ParseWithReader(root, out);
+}
+
+// static
+bool Constraints::Read(json::JsonReader* reader, Constraints* out) {
+  if (!json::BeginObjectOrSkip(reader)) {
     return false;
   }
-  return out->IsValid();
+
+  bool has_audio = false;
+  bool has_video = false;
+  absl::string_view key;
+  while (reader->NextMember(&key)) {
+    if (key == kAudio) {
+      has_audio = AudioConstraints::Read(reader, &(out->audio));
+    } else if (key == kVideo) {
+      has_video = VideoConstraints::Read(reader, &(out->video));
+    } else {
+      reader->SkipValue();
+    }
+  }
+  return reader->ok() && has_audio && has_video && out->IsValid();
 }
 
 bool Constraints::IsValid() const {
@@ -347,20 +448,39 @@ Json::Value Constraints::ToJson() const {
 // static
 bool DisplayDescription::ParseAndValidate(const Json::Value& root,
                                           DisplayDescription* out) {
-  if (!ParseOptional<Dimensions>(root[kDimensions], &(out->dimensions)) ||
-      !ParseOptional<AspectRatio>(root[kAspectRatio], &(out->aspect_ratio))) {
+  return ParseWithReader(root, out);
+}
+
+// static
+bool DisplayDescription::Read(json::JsonReader* reader,
+                              DisplayDescription* out) {
+  if (!json::BeginObjectOrSkip(reader)) {
     return false;
   }
 
-  AspectRatioConstraint constraint;
-  if (AspectRatioConstraintParseAndValidate(root[kScaling], &constraint)) {
-    out->aspect_ratio_constraint =
-        absl::optional<AspectRatioConstraint>(std::move(constraint));
-  } else {
-    out->aspect_ratio_constraint = absl::nullopt;
+  bool valid_dimensions = true;
+  bool valid_aspect_ratio = true;
+  // The aspect ratio constraint is optional, and ignored if not valid.
+  out->aspect_ratio_constraint = absl::nullopt;
+  absl::string_view key;
+  while (reader->NextMember(&key)) {
+    if (key == kDimensions) {
+      valid_dimensions = ReadOptional(reader, &(out->dimensions));
+    } else if (key == kAspectRatio) {
+      valid_aspect_ratio = ReadOptional(reader, &(out->aspect_ratio));
+    } else if (key == kScaling) {
+      AspectRatioConstraint constraint;
+      if (ReadAspectRatioConstraint(reader, &constraint)) {
+        out->aspect_ratio_constraint = constraint;
+      } else {
+        out->aspect_ratio_constraint = absl::nullopt;
+      }
+    } else {
+      reader->SkipValue();
+    }
   }
-
-  return out->IsValid();
+  return reader->ok() && valid_dimensions && valid_aspect_ratio &&
+         out->IsValid();
 }
 
 bool DisplayDescription::IsValid() const {
@@ -402,30 +522,61 @@ Json::Value DisplayDescription::ToJson() const {
   return root;
 }
 
+// static
 bool Answer::ParseAndValidate(const Json::Value& root, Answer* out) {
-  if (!json::ParseAndValidateInt(root[kUdpPort], &(out->udp_port)) ||
-      !json::ParseAndValidateIntArray(root[kSendIndexes],
-                                      &(out->send_indexes)) ||
-      !json::ParseAndValidateUintArray(root[kSsrcs], &(out->ssrcs)) ||
-      !ParseOptional<Constraints>(root[kConstraints], &(out->constraints)) ||
-      !ParseOptional<DisplayDescription>(root[kDisplay], &(out->display))) {
+  return ParseWithReader(root, out);
+}
+
+// static
+bool Answer::Read(json::JsonReader* reader, Answer* out) {
+  if (!json::BeginObjectOrSkip(reader)) {
     return false;
   }
-  if (!json::ParseBool(root[kReceiverGetStatus],
-                       &(out->supports_wifi_status_reporting))) {
-    out->supports_wifi_status_reporting = false;
-  }
 
-  // These function set to empty array if not present, so we can ignore
-  // the return value for optional values.
-  json::ParseAndValidateIntArray(root[kReceiverRtcpEventLog],
-                                 &(out->receiver_rtcp_event_log));
-  json::ParseAndValidateIntArray(root[kReceiverRtcpDscp],
-                                 &(out->receiver_rtcp_dscp));
-  json::ParseAndValidateStringArray(root[kRtpExtensions],
-                                    &(out->rtp_extensions));
-
-  return out->IsValid();
+  bool has_udp_port = false;
+  bool has_send_indexes = false;
+  bool has_ssrcs = false;
+  bool valid_constraints = true;
+  bool valid_display = true;
+  out->supports_wifi_status_reporting = false;
+  out->supports_binary_rpc = false;
+  // These optional arrays are left empty if not present, or not valid.
+  out->receiver_rtcp_event_log.clear();
+  out->receiver_rtcp_dscp.clear();
+  out->rtp_extensions.clear();
+  absl::string_view key;
+  while (reader->NextMember(&key)) {
+    if (key == kUdpPort) {
+      has_udp_port = json::ReadAndValidateInt(reader, &(out->udp_port));
+    } else if (key == kSendIndexes) {
+      has_send_indexes =
+          json::ReadAndValidateIntArray(reader, &(out->send_indexes));
+    } else if (key == kSsrcs) {
+      has_ssrcs = json::ReadAndValidateUintArray(reader, &(out->ssrcs));
+    } else if (key == kConstraints) {
+      valid_constraints = ReadOptional(reader, &(out->constraints));
+    } else if (key == kDisplay) {
+      valid_display = ReadOptional(reader, &(out->display));
+    } else if (key == kReceiverGetStatus) {
+      if (!json::ReadBool(reader, &(out->supports_wifi_status_reporting))) {
+        out->supports_wifi_status_reporting = false;
+      }
+    } else if (key == kBinaryRpc) {
+      if (!json::ReadBool(reader, &(out->supports_binary_rpc))) {
+        out->supports_binary_rpc = false;
+      }
+    } else if (key == kReceiverRtcpEventLog) {
+      json::ReadAndValidateIntArray(reader, &(out->receiver_rtcp_event_log));
+    } else if (key == kReceiverRtcpDscp) {
+      json::ReadAndValidateIntArray(reader, &(out->receiver_rtcp_dscp));
+    } else if (key == kRtpExtensions) {
+      json::ReadAndValidateStringArray(reader, &(out->rtp_extensions));
+    } else {
+      reader->SkipValue();
+    }
+  }
+  return reader->ok() && has_udp_port && has_send_indexes && has_ssrcs &&
+         valid_constraints && valid_display && out->IsValid();
 }
 
 bool Answer::IsValid() const {
@@ -474,6 +625,9 @@ Json::Value Answer::ToJson() const {
   if (!rtp_extensions.empty()) {
     root[kRtpExtensions] = PrimitiveVectorToJson(rtp_extensions);
   }
+  if (supports_binary_rpc) {
+    root[kBinaryRpc] = true;
+  }
   return root;
 }
 
@@ -18,6 +18,7 @@
 #include "cast/streaming/ssrc.h"
 #include "json/value.h"
 #include "platform/base/error.h"
+#include "util/json/json_reader.h"
 #include "util/simple_fraction.h"
 
 namespace openscreen {
@@ -30,12 +31,16 @@ namespace cast {
 // definitions, the following method definitions are shared:
 // (1) ParseAndValidate. Shall return a boolean indicating whether the out
 //     parameter is in a valid state after checking bounds and restrictions.
+//     Read is the same, but reads the next value from a JsonReader, which it
+//     consumes whether or not it is valid. ParseAndValidate is implemented
+//     in terms of Read, so the two always agree.
 // (2) ToJson. Should return a proper JSON object. Assumes that IsValid()
 //     has been called already, OSP_DCHECKs if not IsValid().
 // (3) IsValid. Used by both ParseAndValidate and ToJson to ensure that the
 //     object is in a good state.
 struct AudioConstraints {
   static bool ParseAndValidate(const Json::Value& value, AudioConstraints* out);
+  static bool Read(json::JsonReader* reader, AudioConstraints* out);
   Json::Value ToJson() const;
   bool IsValid() const;
 
@@ -48,6 +53,7 @@ struct AudioConstraints {
 
 struct Dimensions {
   static bool ParseAndValidate(const Json::Value& value, Dimensions* out);
+  static bool Read(json::JsonReader* reader, Dimensions* out);
   Json::Value ToJson() const;
   bool IsValid() const;
 
@@ -58,6 +64,7 @@ struct Dimensions {
 
 struct VideoConstraints {
   static bool ParseAndValidate(const Json::Value& value, VideoConstraints* out);
+  static bool Read(json::JsonReader* reader, VideoConstraints* out);
   Json::Value ToJson() const;
   bool IsValid() const;
 
@@ -71,6 +78,7 @@ struct VideoConstraints {
 
 struct Constraints {
   static bool ParseAndValidate(const Json::Value& value, Constraints* out);
+  static bool Read(json::JsonReader* reader, Constraints* out);
   Json::Value ToJson() const;
   bool IsValid() const;
 
@@ -85,6 +93,7 @@ enum class AspectRatioConstraint : uint8_t { kVariable = 0, kFixed };
 
 struct AspectRatio {
   static bool ParseAndValidate(const Json::Value& value, AspectRatio* out);
+  static bool Read(json::JsonReader* reader, AspectRatio* out);
   bool IsValid() const;
 
   bool operator==(const AspectRatio& other) const {
@@ -98,6 +107,7 @@ struct AspectRatio {
 struct DisplayDescription {
   static bool ParseAndValidate(const Json::Value& value,
                                DisplayDescription* out);
+  static bool Read(json::JsonReader* reader, DisplayDescription* out);
   Json::Value ToJson() const;
   bool IsValid() const;
 
@@ -110,6 +120,7 @@ struct DisplayDescription {
 
 struct Answer {
   static bool ParseAndValidate(const Json::Value& value, Answer* out);
+  static bool Read(json::JsonReader* reader, Answer* out);
   Json::Value ToJson() const;
   bool IsValid() const;
 
@@ -127,6 +138,11 @@ struct Answer {
 
   // RTP extensions should be empty, but not null.
   std::vector<std::string> rtp_extensions = {};
+
+  // Whether the receiver can send and receive batches of RPC messages as
+  // binary payloads (see BinaryRpcChannel). This is not part of the
+  // specification.
+  bool supports_binary_rpc = false;
 };
 
 }  // namespace cast
@@ -5,6 +5,7 @@
 #include "cast/streaming/answer_messages.h"
 
 #include <chrono>
+#include <string>
 #include <utility>
 
 #include "gmock/gmock.h"
@@ -323,6 +324,31 @@ TEST(AnswerMessagesTest, CanParseValidAnswerJson) {
   ExpectEqualsValidAnswerJson(answer);
 }
 
+TEST(AnswerMessagesTest, CanReadValidAnswerJson) {
+  // The answer is read from the middle of a larger document, as the body of a
+  // message would be.
+  const std::string document = std::string(R"({"answer": )") +
+                               kValidAnswerJson +
+                               R"(, "bad": {"udpPort": -1}, "after": 2})";
+  json::JsonReader reader(document);
+  ASSERT_TRUE(reader.BeginObject());
+  absl::string_view key;
+  ASSERT_TRUE(reader.NextMember(&key));
+  Answer answer;
+  ASSERT_TRUE(Answer::Read(&reader, &answer));
+  ExpectEqualsValidAnswerJson(answer);
+
+  // An invalid answer is consumed all the same.
+  ASSERT_TRUE(reader.NextMember(&key));
+  Answer bad_answer;
+  EXPECT_FALSE(Answer::Read(&reader, &bad_answer));
+  ASSERT_TRUE(reader.NextMember(&key));
+  EXPECT_EQ("after", key);
+  ASSERT_TRUE(reader.SkipValue());
+  EXPECT_FALSE(reader.NextMember(&key));
+  EXPECT_TRUE(reader.Finish());
+}
+
 // In practice, the rtpExtensions, receiverRtcpDscp, and receiverRtcpEventLog
 // fields may be missing from some receivers. We handle this case by treating
 // them as empty.
@@ -375,6 +401,28 @@ TEST(AnswerMessagesTest, AssumesNoReportingIfGetStatusFalse) {
   EXPECT_FALSE(answer.supports_wifi_status_reporting);
 }
 
+TEST(AnswerMessagesTest, ParsesAndSerializesBinaryRpcSupport) {
+  Answer answer;
+  ExpectSuccessOnParse(R"({
+    "udpPort": 1234,
+    "sendIndexes": [1, 3],
+    "ssrcs": [1233324, 2234222]
+  })",
+                       &answer);
+  EXPECT_FALSE(answer.supports_binary_rpc);
+  EXPECT_FALSE(answer.ToJson().isMember("binaryRpc"));
+
+  ExpectSuccessOnParse(R"({
+    "udpPort": 1234,
+    "sendIndexes": [1, 3],
+    "ssrcs": [1233324, 2234222],
+    "binaryRpc": true
+  })",
+                       &answer);
+  EXPECT_TRUE(answer.supports_binary_rpc);
+  EXPECT_TRUE(answer.ToJson()["binaryRpc"].asBool());
+}
+
 TEST(AnswerMessagesTest, AllowsReceiverSideScaling) {
   Answer answer;
   ExpectSuccessOnParse(R"({
@@ -0,0 +1,182 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/benchmarks/benchmark_harness.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include <algorithm>
+#include <atomic>
+
+#include "util/osp_logging.h"
+
+namespace {
+
+std::atomic<int64_t> g_allocation_count{0};
+
+void* CountedAllocate(size_t size) {
+  g_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  void* const ptr = malloc(size == 0 ? 1 : size);
+  if (!ptr) {
+    abort();
+  }
+  return ptr;
+}
+
+}  // namespace
+
+// Replacements for the global allocation functions, so that the benchmarks can
+// report allocations per operation. The nothrow and aligned variants are not
+// used by the code being measured.
+void* operator new(size_t size) {
+  return CountedAllocate(size);
+}
+
+void* operator new[](size_t size) {
+  return CountedAllocate(size);
+}
+
+void operator delete(void* ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void* ptr) noexcept {
+  free(ptr);
+}
+
+void operator delete(void* ptr, size_t) noexcept {
+  free(ptr);
+}
+
+void operator delete[](void* ptr, size_t) noexcept {
+  free(ptr);
+}
+
+namespace openscreen {
+namespace cast {
+
+namespace {
+
+// Give up on calibrating a micro-benchmark beyond this many iterations.
+constexpr int64_t kMaxIterations = 1000000000;
+
+// When calibrating, never grow the iteration count by more than this factor
+// per attempt, since the first few runs tend to be noisy.
+constexpr double kMaxGrowthFactor = 10.0;
+
+}  // namespace
+
+BenchmarkResult::BenchmarkResult() = default;
+BenchmarkResult::BenchmarkResult(BenchmarkResult&&) noexcept = default;
+BenchmarkResult& BenchmarkResult::operator=(BenchmarkResult&&) noexcept =
+    default;
+BenchmarkResult::~BenchmarkResult() = default;
+
+BenchmarkState::BenchmarkState(int64_t iterations) : iterations_(iterations) {}
+
+BenchmarkState::~BenchmarkState() = default;
+
+void BenchmarkState::StartTiming() {
+  OSP_DCHECK(!is_timing_);
+  is_timing_ = true;
+  start_allocations_ = GetAllocationCount();
+  start_time_ = std::chrono::steady_clock::now();
+}
+
+void BenchmarkState::StopTiming() {
+  const auto stop_time = std::chrono::steady_clock::now();
+  OSP_DCHECK(is_timing_);
+  is_timing_ = false;
+  elapsed_ += stop_time - start_time_;
+  num_allocations_ += GetAllocationCount() - start_allocations_;
+}
+
+Benchmark MakeMicroBenchmark(std::string name,
+                             std::function<void(BenchmarkState* state)> body) {
+  Benchmark benchmark;
+  benchmark.name = name;
+  benchmark.run = [name, body](const BenchmarkOptions& options) {
+    int64_t iterations = 1;
+    while (true) {
+      BenchmarkState state(iterations);
+      body(&state);
+      const std::chrono::duration<double> elapsed = state.elapsed();
+      if (elapsed >= options.min_time || iterations >= kMaxIterations) {
+        BenchmarkResult result;
+        result.name = name;
+        result.AddMetric("iterations", static_cast<double>(iterations));
+        result.AddMetric("ns_per_op", elapsed.count() * 1e9 / iterations);
+        result.AddMetric("allocs_per_op",
+                         static_cast<double>(state.num_allocations()) /
+                             iterations);
+        if (state.bytes_processed() > 0) {
+          result.AddMetric("mb_per_second",
+                           state.bytes_processed() / elapsed.count() / 1e6);
+        }
+        return result;
+      }
+
+      // Aim a bit beyond the minimum time, so that the next run is likely to
+      // be the final one.
+      const double growth =
+          elapsed.count() > 0
+              ? std::min(options.min_time.count() * 1.4 / elapsed.count(),
+                         kMaxGrowthFactor)
+              : kMaxGrowthFactor;
+      iterations = std::min(
+          std::max(static_cast<int64_t>(iterations * growth), iterations + 1),
+          kMaxIterations);
+    }
+  };
+  return benchmark;
+}
+
+int64_t GetAllocationCount() {
+  return g_allocation_count.load(std::memory_order_relaxed);
+}
+
+std::chrono::duration<double> GetProcessCpuTime() {
+  timespec ts;
+  if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &ts) != 0) {
+    return std::chrono::duration<double>(static_cast<double>(clock()) /
+                                         CLOCKS_PER_SEC);
+  }
+  return std::chrono::duration<double>(ts.tv_sec + ts.tv_nsec / 1e9);
+}
+
+void PrintBenchmarkResults(const std::vector<BenchmarkResult>& results,
+                           BenchmarkOutputFormat format) {
+  switch (format) {
+    case BenchmarkOutputFormat::kText:
+      for (const BenchmarkResult& result : results) {
+        printf("%-40s", result.name.c_str());
+        for (const auto& metric : result.metrics) {
+          printf(" %s=%.6g", metric.first.c_str(), metric.second);
+        }
+        printf("\n");
+      }
+      break;
+
+    case BenchmarkOutputFormat::kJson:
+      // Benchmark and metric names are plain identifiers, so no escaping is
+      // necessary.
+      printf("{\n  \"benchmarks\": [");
+      for (size_t i = 0; i < results.size(); ++i) {
+        printf("%s\n    {\"name\": \"%s\"", (i == 0) ? "" : ",",
+               results[i].name.c_str());
+        for (const auto& metric : results[i].metrics) {
+          printf(", \"%s\": %.9g", metric.first.c_str(), metric.second);
+        }
+        printf("}");
+      }
+      printf("\n  ]\n}\n");
+      break;
+  }
+  fflush(stdout);
+}
+
+}  // namespace cast
+}  // namespace openscreen
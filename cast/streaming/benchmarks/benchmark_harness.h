@@ -0,0 +1,123 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STREAMING_BENCHMARKS_BENCHMARK_HARNESS_H_
+#define CAST_STREAMING_BENCHMARKS_BENCHMARK_HARNESS_H_
+
+#include <stdint.h>
+
+#include <chrono>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace openscreen {
+namespace cast {
+
+// A minimal benchmark harness for the openscreen_streaming_benchmarks binary.
+// Each benchmark produces a set of named metrics, which are reported either as
+// human-readable text or as JSON suitable for tracking trends in CI.
+
+// Options common to all benchmarks.
+struct BenchmarkOptions {
+  // The minimum amount of wall time over which to measure each
+  // micro-benchmark.
+  std::chrono::duration<double> min_time{0.5};
+
+  // The length of the media session simulated by each loopback benchmark.
+  std::chrono::seconds loopback_duration{10};
+};
+
+// The results of running one benchmark.
+struct BenchmarkResult {
+  BenchmarkResult();
+  BenchmarkResult(BenchmarkResult&&) noexcept;
+  BenchmarkResult& operator=(BenchmarkResult&&) noexcept;
+  ~BenchmarkResult();
+
+  void AddMetric(std::string metric_name, double value) {
+    metrics.emplace_back(std::move(metric_name), value);
+  }
+
+  std::string name;
+
+  // Named values, in the order they should be reported. By convention, names
+  // include a unit suffix (e.g., "ns_per_op", "p95_ms").
+  std::vector<std::pair<std::string, double>> metrics;
+};
+
+struct Benchmark {
+  std::string name;
+  std::function<BenchmarkResult(const BenchmarkOptions&)> run;
+};
+
+// Passed to the body of a micro-benchmark. The body should perform any set-up
+// work first, then call StartTiming(), execute the operation being measured
+// iterations() times, and finally call StopTiming().
+class BenchmarkState {
+ public:
+  explicit BenchmarkState(int64_t iterations);
+  ~BenchmarkState();
+
+  int64_t iterations() const { return iterations_; }
+
+  void StartTiming();
+  void StopTiming();
+
+  // Reports the total number of bytes processed across all iterations, from
+  // which a throughput is computed.
+  void SetBytesProcessed(int64_t bytes) { bytes_processed_ = bytes; }
+
+  std::chrono::steady_clock::duration elapsed() const { return elapsed_; }
+  int64_t num_allocations() const { return num_allocations_; }
+  int64_t bytes_processed() const { return bytes_processed_; }
+
+ private:
+  const int64_t iterations_;
+  bool is_timing_ = false;
+  std::chrono::steady_clock::time_point start_time_;
+  int64_t start_allocations_ = 0;
+
+  std::chrono::steady_clock::duration elapsed_{};
+  int64_t num_allocations_ = 0;
+  int64_t bytes_processed_ = 0;
+};
+
+// Prevents the compiler from optimizing away the computation of |value|.
+template <typename T>
+inline void DoNotOptimize(const T& value) {
+  asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Returns a Benchmark that runs |body| with an increasing number of iterations
+// until it takes at least BenchmarkOptions::min_time, and then reports the
+// per-iteration time, allocation count and (if set) the throughput.
+Benchmark MakeMicroBenchmark(
+    std::string name,
+    std::function<void(BenchmarkState* state)> body);
+
+// Returns the number of heap allocations made by the process so far. Counted
+// by replacement global operator new functions linked into the benchmarks
+// binary.
+int64_t GetAllocationCount();
+
+// Returns the amount of CPU time consumed by the process so far.
+std::chrono::duration<double> GetProcessCpuTime();
+
+enum class BenchmarkOutputFormat { kText, kJson };
+
+// Writes |results| to stdout in the given |format|.
+void PrintBenchmarkResults(const std::vector<BenchmarkResult>& results,
+                           BenchmarkOutputFormat format);
+
+// The benchmark suites.
+std::vector<Benchmark> GetMicroBenchmarks();
+std::vector<Benchmark> GetLoopbackBenchmarks();
+std::vector<Benchmark> GetCrlBenchmarks();
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STREAMING_BENCHMARKS_BENCHMARK_HARNESS_H_
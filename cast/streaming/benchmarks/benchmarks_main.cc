@@ -0,0 +1,139 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include <getopt.h>
+#include <stdlib.h>
+
+#include <iostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "cast/streaming/benchmarks/benchmark_harness.h"
+#include "platform/impl/logging.h"
+#include "util/stringprintf.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+void LogUsage(const char* argv0) {
+  constexpr char kTemplate[] = R"(
+usage: %s <options>
+
+Runs the Cast Streaming micro-benchmarks and Sender->Receiver loopback
+benchmarks, as well as those for Cast CRL handling, and reports the results.
+
+options:
+    -f, --filter=TEXT: Only run the benchmarks whose names contain TEXT.
+
+    -j, --json: Report the results as JSON, for consumption by tools that
+                track performance over time.
+
+    -m, --min_time=SECONDS: The minimum time to spend measuring each
+                            micro-benchmark. Default: 0.5
+
+    -d, --duration=SECONDS: The length of the simulated media session in each
+                            loopback benchmark. Default: 10
+
+    -l, --list: List the benchmarks, without running them.
+
+    -v, --verbose: Enable verbose logging.
+
+    -h, --help: Show this help message.
+)";
+  std::cerr << StringPrintf(kTemplate, argv0);
+}
+
+int BenchmarksMain(int argc, char* argv[]) {
+  const struct option kArgumentOptions[] = {
+      {"filter", required_argument, nullptr, 'f'},
+      {"json", no_argument, nullptr, 'j'},
+      {"min_time", required_argument, nullptr, 'm'},
+      {"duration", required_argument, nullptr, 'd'},
+      {"list", no_argument, nullptr, 'l'},
+      {"verbose", no_argument, nullptr, 'v'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, 0}};
+
+  std::string filter;
+  BenchmarkOutputFormat format = BenchmarkOutputFormat::kText;
+  BenchmarkOptions options;
+  bool list_only = false;
+  bool is_verbose = false;
+  int ch = -1;
+  while ((ch = getopt_long(argc, argv, "f:jm:d:lvh", kArgumentOptions,
+                           nullptr)) != -1) {
+    switch (ch) {
+      case 'f':
+        filter = optarg;
+        break;
+      case 'j':
+        format = BenchmarkOutputFormat::kJson;
+        break;
+      case 'm':
+        options.min_time = std::chrono::duration<double>(atof(optarg));
+        break;
+      case 'd':
+        options.loopback_duration = std::chrono::seconds(atoi(optarg));
+        if (options.loopback_duration.count() <= 0) {
+          LogUsage(argv[0]);
+          return 1;
+        }
+        break;
+      case 'l':
+        list_only = true;
+        break;
+      case 'v':
+        is_verbose = true;
+        break;
+      case 'h':
+        LogUsage(argv[0]);
+        return 1;
+    }
+  }
+  if (optind != argc) {
+    LogUsage(argv[0]);
+    return 1;
+  }
+  SetLogLevel(is_verbose ? LogLevel::kVerbose : LogLevel::kWarning);
+
+  std::vector<Benchmark> benchmarks = GetMicroBenchmarks();
+  for (Benchmark& benchmark : GetLoopbackBenchmarks()) {
+    benchmarks.push_back(std::move(benchmark));
+  }
+  for (Benchmark& benchmark : GetCrlBenchmarks()) {
+    benchmarks.push_back(std::move(benchmark));
+  }
+
+  std::vector<BenchmarkResult> results;
+  for (const Benchmark& benchmark : benchmarks) {
+    if (benchmark.name.find(filter) == std::string::npos) {
+      continue;
+    }
+    if (list_only) {
+      std::cout << benchmark.name << '\n';
+      continue;
+    }
+    results.push_back(benchmark.run(options));
+    // Text output is reported as each benchmark completes, since the whole
+    // suite can take a while.
+    if (format == BenchmarkOutputFormat::kText) {
+      PrintBenchmarkResults(results, format);
+      results.clear();
+    }
+  }
+  if (format == BenchmarkOutputFormat::kJson && !list_only) {
+    PrintBenchmarkResults(results, format);
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
+
+int main(int argc, char* argv[]) {
+  return openscreen::cast::BenchmarksMain(argc, argv);
+}
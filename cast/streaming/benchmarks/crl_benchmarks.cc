@@ -0,0 +1,190 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Micro-benchmarks for the handling of the Cast CRL during device
+// authentication, with a large synthetic CRL: parsing and verifying it, looking
+// it up in a CastCRLStore, and checking a device certificate chain against it.
+
+#include <openssl/x509.h>
+
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "cast/common/certificate/cast_cert_validator_internal.h"
+#include "cast/common/certificate/cast_crl.h"
+#include "cast/common/certificate/types.h"
+#include "cast/streaming/benchmarks/benchmark_harness.h"
+#include "platform/test/paths.h"
+#include "util/crypto/certificate_utils.h"
+#include "util/crypto/digest_sign.h"
+#include "util/crypto/pem_helpers.h"
+#include "util/crypto/sha2.h"
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+// The number of revoked public key hashes, and the number of revoked serial
+// number ranges, in the synthetic CRL.
+constexpr int kNumRevokedHashes = 5000;
+constexpr int kNumRevokedRanges = 5000;
+
+// Revoked serial numbers start above those of the test certificates.
+constexpr uint64_t kFirstRevokedSerial = 1000000;
+
+const std::string& GetChannelTestDataPath() {
+  static std::string data_path = GetTestDataPath() + "cast/receiver/channel/";
+  return data_path;
+}
+
+// A time when the test certificates are valid.
+DateTime December2019() {
+  DateTime time = {};
+  time.year = 2019;
+  time.month = 12;
+  time.day = 17;
+  return time;
+}
+
+bssl::UniquePtr<X509> ParseCert(const std::string& der_cert) {
+  const uint8_t* data = reinterpret_cast<const uint8_t*>(der_cert.data());
+  return bssl::UniquePtr<X509>{d2i_X509(nullptr, &data, der_cert.size())};
+}
+
+// The test device certificate chain and a CRL bundle, signed by the test CRL
+// issuer, that revokes many certificates but none in the chain.
+struct CrlTestData {
+  // Trust anchor first, as for CastCRL::CheckRevocation().
+  std::vector<bssl::UniquePtr<X509>> device_chain;
+  std::vector<X509*> device_path;
+
+  TrustStore crl_trust_store;
+  std::string crl_bundle;
+};
+
+CrlTestData& GetCrlTestData() {
+  static CrlTestData* const test_data = [] {
+    auto* data = new CrlTestData();
+    const std::string& data_path = GetChannelTestDataPath();
+    for (const std::string& der_cert :
+         ReadCertificatesFromPemFile(data_path + "device_chain.pem")) {
+      data->device_chain.push_back(ParseCert(der_cert));
+    }
+    std::reverse(data->device_chain.begin(), data->device_chain.end());
+    for (const bssl::UniquePtr<X509>& cert : data->device_chain) {
+      OSP_CHECK(cert);
+      data->device_path.push_back(cert.get());
+    }
+    data->crl_trust_store =
+        TrustStore::CreateInstanceFromPemFile(data_path + "crl_root.pem");
+
+    TbsCrl tbs_crl;
+    tbs_crl.set_version(0);
+    tbs_crl.set_not_before_seconds(
+        DateTimeToSeconds(December2019()).count() - 24 * 60 * 60);
+    tbs_crl.set_not_after_seconds(
+        DateTimeToSeconds(December2019()).count() + 180 * 24 * 60 * 60);
+    for (int i = 0; i < kNumRevokedHashes; ++i) {
+      *tbs_crl.add_revoked_public_key_hashes() =
+          SHA256HashString(std::to_string(i)).value();
+    }
+
+    // The ranges are all revoked by the device certificate's issuer, so they
+    // are all candidates when checking the device certificate.
+    const std::string issuer_hash =
+        SHA256HashString(GetSpkiTlv(data->device_path[1])).value();
+    for (int i = 0; i < kNumRevokedRanges; ++i) {
+      SerialNumberRange* range = tbs_crl.add_revoked_serial_number_ranges();
+      range->set_issuer_public_key_hash(issuer_hash);
+      range->set_first_serial_number(kFirstRevokedSerial + 4 * i);
+      range->set_last_serial_number(kFirstRevokedSerial + 4 * i + 1);
+    }
+
+    CrlBundle bundle;
+    Crl* crl = bundle.add_crls();
+    tbs_crl.SerializeToString(crl->mutable_tbs_crl());
+    const std::vector<std::string> signer_der =
+        ReadCertificatesFromPemFile(data_path + "crl_inter.pem");
+    OSP_CHECK_EQ(signer_der.size(), 1u);
+    crl->set_signer_cert(signer_der[0]);
+    bssl::UniquePtr<EVP_PKEY> signer_key =
+        ReadKeyFromPemFile(data_path + "crl_inter_key.pem");
+    OSP_CHECK(signer_key);
+    ErrorOr<std::string> signature = SignData(
+        EVP_sha256(), signer_key.get(),
+        absl::Span<const uint8_t>(
+            reinterpret_cast<const uint8_t*>(crl->tbs_crl().data()),
+            crl->tbs_crl().size()));
+    OSP_CHECK(signature);
+    crl->set_signature(std::move(signature.value()));
+    bundle.SerializeToString(&data->crl_bundle);
+    return data;
+  }();
+  return *test_data;
+}
+
+void BM_CastCRLParseAndVerify(BenchmarkState* state) {
+  CrlTestData& data = GetCrlTestData();
+
+  state->StartTiming();
+  for (int64_t i = 0; i < state->iterations(); ++i) {
+    std::unique_ptr<CastCRL> crl = ParseAndVerifyCRL(
+        data.crl_bundle, December2019(), &data.crl_trust_store);
+    OSP_DCHECK(crl);
+    DoNotOptimize(crl);
+  }
+  state->StopTiming();
+  state->SetBytesProcessed(state->iterations() * data.crl_bundle.size());
+}
+
+void BM_CastCRLStoreGetCRL(BenchmarkState* state) {
+  CrlTestData& data = GetCrlTestData();
+  CastCRLStore store(&data.crl_trust_store);
+  OSP_CHECK(store.GetCRL(data.crl_bundle, December2019()));
+
+  state->StartTiming();
+  for (int64_t i = 0; i < state->iterations(); ++i) {
+    std::shared_ptr<const CastCRL> crl =
+        store.GetCRL(data.crl_bundle, December2019());
+    OSP_DCHECK(crl);
+    DoNotOptimize(crl);
+  }
+  state->StopTiming();
+  state->SetBytesProcessed(state->iterations() * data.crl_bundle.size());
+}
+
+void BM_CastCRLCheckRevocation(BenchmarkState* state) {
+  CrlTestData& data = GetCrlTestData();
+  std::unique_ptr<CastCRL> crl = ParseAndVerifyCRL(
+      data.crl_bundle, December2019(), &data.crl_trust_store);
+  OSP_CHECK(crl);
+
+  state->StartTiming();
+  for (int64_t i = 0; i < state->iterations(); ++i) {
+    const bool ok = crl->CheckRevocation(data.device_path, December2019());
+    OSP_DCHECK(ok);
+    DoNotOptimize(ok);
+  }
+  state->StopTiming();
+}
+
+}  // namespace
+
+std::vector<Benchmark> GetCrlBenchmarks() {
+  return {
+      MakeMicroBenchmark("CastCRL/ParseAndVerify/10000",
+                         &BM_CastCRLParseAndVerify),
+      MakeMicroBenchmark("CastCRL/StoreGetCRL/10000", &BM_CastCRLStoreGetCRL),
+      MakeMicroBenchmark("CastCRL/CheckRevocation/10000",
+                         &BM_CastCRLCheckRevocation),
+  };
+}
+
+}  // namespace cast
+}  // namespace openscreen
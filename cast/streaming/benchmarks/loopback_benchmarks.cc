@@ -0,0 +1,226 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Macro-benchmarks that run a whole Sender→Receiver session over an
+// EmulatedNetwork, on a simulated clock, at fixed bitrates. Since nothing waits
+// on real time, each session runs as fast as the CPU allows, and so the
+// wall-clock throughput and CPU cost of the whole pipeline can be measured
+// along with the (simulated) frame latency.
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <string>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "cast/streaming/benchmarks/benchmark_harness.h"
+#include "cast/streaming/encoded_frame.h"
+#include "cast/streaming/receiver.h"
+#include "cast/streaming/receiver_packet_router.h"
+#include "cast/streaming/rtp_defines.h"
+#include "cast/streaming/sender.h"
+#include "cast/streaming/sender_packet_router.h"
+#include "cast/streaming/session_config.h"
+#include "cast/streaming/testing/emulated_network.h"
+#include "platform/test/fake_clock.h"
+#include "platform/test/fake_task_runner.h"
+#include "util/chrono_helpers.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+constexpr int kFramesPerSecond = 30;
+constexpr Clock::duration kFrameInterval =
+    microseconds(1000000 / kFramesPerSecond);
+constexpr int kKeyFrameInterval = 10 * kFramesPerSecond;
+
+// How long to keep the simulated clock running after the last frame, so that
+// retransmissions can complete.
+constexpr Clock::duration kDrainDuration = seconds(1);
+
+struct LoopbackScenario {
+  const char* name;
+  int64_t bitrate;  // Of the media, in bits per second.
+  double loss_rate;
+};
+
+constexpr LoopbackScenario kScenarios[] = {
+    {"Loopback/2Mbps", 2000000, 0.0},
+    {"Loopback/8Mbps", 8000000, 0.0},
+    {"Loopback/20Mbps", 20000000, 0.0},
+    {"Loopback/8Mbps/1PercentLoss", 8000000, 0.01},
+};
+
+// Records the simulated time at which each frame becomes available from the
+// Receiver.
+class LatencyRecorder : public Receiver::Consumer {
+ public:
+  LatencyRecorder(Receiver* receiver,
+                  const std::vector<Clock::time_point>* enqueue_times)
+      : receiver_(receiver), enqueue_times_(enqueue_times) {
+    receiver_->SetConsumer(this);
+    latencies_.reserve(enqueue_times_->capacity());
+  }
+  ~LatencyRecorder() override { receiver_->SetConsumer(nullptr); }
+
+  int64_t num_bytes() const { return num_bytes_; }
+  std::vector<Clock::duration>* latencies() { return &latencies_; }
+
+  void OnFramesReady(int next_frame_buffer_size) override {
+    if (buffer_.size() < static_cast<size_t>(next_frame_buffer_size)) {
+      buffer_.resize(next_frame_buffer_size);
+    }
+    const EncodedFrame frame = receiver_->ConsumeNextFrame(
+        absl::Span<uint8_t>(buffer_.data(), next_frame_buffer_size));
+    latencies_.push_back(FakeClock::now() -
+                         (*enqueue_times_)[frame.frame_id - FrameId::first()]);
+    num_bytes_ += frame.data.size();
+  }
+
+ private:
+  Receiver* const receiver_;
+  const std::vector<Clock::time_point>* const enqueue_times_;
+  std::vector<uint8_t> buffer_;
+  std::vector<Clock::duration> latencies_;
+  int64_t num_bytes_ = 0;
+};
+
+double ToMilliseconds(Clock::duration duration) {
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+// Returns the |percentile| of the already-sorted |values|, by the
+// nearest-rank method.
+Clock::duration GetPercentile(const std::vector<Clock::duration>& values,
+                              int percentile) {
+  if (values.empty()) {
+    return Clock::duration::zero();
+  }
+  const size_t rank = (values.size() * percentile + 99) / 100;
+  return values[std::max<size_t>(rank, 1) - 1];
+}
+
+BenchmarkResult RunLoopback(const LoopbackScenario& scenario,
+                            const BenchmarkOptions& options) {
+  FakeClock clock(Clock::now());
+  FakeTaskRunner task_runner(&clock);
+  LinkConditions forward;
+  forward.bandwidth = 100000000;
+  forward.propagation_delay = milliseconds(10);
+  forward.loss_rate = scenario.loss_rate;
+  LinkConditions reverse;
+  reverse.propagation_delay = milliseconds(10);
+  reverse.loss_rate = scenario.loss_rate;
+  EmulatedNetwork network(&FakeClock::now, &task_runner, forward, reverse);
+
+  const SessionConfig config(/* sender_ssrc */ 1, /* receiver_ssrc */ 2,
+                             kRtpVideoTimebase, /* channels */ 1,
+                             milliseconds(400), std::array<uint8_t, 16>{},
+                             std::array<uint8_t, 16>{},
+                             /* is_pli_enabled */ true);
+  const int num_frames = options.loopback_duration.count() * kFramesPerSecond;
+  std::vector<Clock::time_point> enqueue_times;
+  enqueue_times.reserve(num_frames);
+
+  ReceiverPacketRouter receiver_router(network.receiver_environment());
+  Receiver receiver(network.receiver_environment(), &receiver_router, config);
+  LatencyRecorder recorder(&receiver, &enqueue_times);
+  SenderPacketRouter sender_router(network.sender_environment());
+  Sender sender(network.sender_environment(), &sender_router, config,
+                GetPayloadType(VideoCodec::kVp8));
+
+  std::vector<uint8_t> payload(scenario.bitrate / 8 / kFramesPerSecond);
+  for (size_t i = 0; i < payload.size(); ++i) {
+    payload[i] = static_cast<uint8_t>(i);
+  }
+
+  const int64_t start_allocations = GetAllocationCount();
+  const auto start_cpu_time = GetProcessCpuTime();
+  const auto wall_start_time = std::chrono::steady_clock::now();
+  const Clock::time_point start_time = FakeClock::now();
+
+  int num_frames_sent = 0;
+  for (int i = 0; i < num_frames; ++i) {
+    const Clock::time_point now = FakeClock::now();
+    EncodedFrame frame;
+    frame.frame_id = sender.GetNextFrameId();
+    const bool is_key_frame = (i % kKeyFrameInterval) == 0;
+    frame.dependency = is_key_frame ? EncodedFrame::KEY_FRAME
+                                    : EncodedFrame::DEPENDS_ON_ANOTHER;
+    frame.referenced_frame_id =
+        is_key_frame ? frame.frame_id : (frame.frame_id - 1);
+    frame.rtp_timestamp =
+        RtpTimeTicks::FromTimeSinceOrigin(now - start_time, kRtpVideoTimebase);
+    frame.reference_time = now;
+    frame.data = absl::Span<uint8_t>(payload);
+    // Like a real encoder, skip frames the Sender cannot accept while too much
+    // media is in-flight.
+    if (sender.EnqueueFrame(frame) == Sender::OK) {
+      enqueue_times.push_back(now);
+      ++num_frames_sent;
+    }
+    clock.Advance(kFrameInterval);
+  }
+  clock.Advance(kDrainDuration);
+
+  const std::chrono::duration<double> wall_time =
+      std::chrono::steady_clock::now() - wall_start_time;
+  const std::chrono::duration<double> cpu_time =
+      GetProcessCpuTime() - start_cpu_time;
+  const int64_t num_allocations = GetAllocationCount() - start_allocations;
+  const std::chrono::duration<double> media_duration =
+      num_frames * kFrameInterval;
+
+  std::vector<Clock::duration>& latencies = *recorder.latencies();
+  const int num_frames_received = latencies.size();
+  std::sort(latencies.begin(), latencies.end());
+  const double megabits = recorder.num_bytes() * 8 / 1e6;
+  const double media_mbps = megabits / media_duration.count();
+
+  BenchmarkResult result;
+  result.name = scenario.name;
+  result.AddMetric("frames_sent", num_frames_sent);
+  result.AddMetric("frames_received", num_frames_received);
+  result.AddMetric("media_mbps", media_mbps);
+  result.AddMetric("throughput_mbps", megabits / wall_time.count());
+  result.AddMetric("realtime_factor", media_duration / wall_time);
+  // The fraction of one CPU core, as a percentage, that would be needed to
+  // stream each Mbps in real-time.
+  result.AddMetric("cpu_percent_per_mbps",
+                   media_mbps > 0 ? 100.0 * (cpu_time / media_duration) /
+                                        media_mbps
+                                  : 0.0);
+  result.AddMetric("latency_p50_ms",
+                   ToMilliseconds(GetPercentile(latencies, 50)));
+  result.AddMetric("latency_p95_ms",
+                   ToMilliseconds(GetPercentile(latencies, 95)));
+  result.AddMetric("latency_p99_ms",
+                   ToMilliseconds(GetPercentile(latencies, 99)));
+  result.AddMetric("latency_max_ms",
+                   ToMilliseconds(latencies.empty() ? Clock::duration::zero()
+                                                    : latencies.back()));
+  result.AddMetric("allocs_per_frame",
+                   num_frames_sent > 0
+                       ? static_cast<double>(num_allocations) / num_frames_sent
+                       : 0.0);
+  return result;
+}
+
+}  // namespace
+
+std::vector<Benchmark> GetLoopbackBenchmarks() {
+  std::vector<Benchmark> benchmarks;
+  for (const LoopbackScenario& scenario : kScenarios) {
+    benchmarks.push_back(Benchmark{
+        scenario.name, [&scenario](const BenchmarkOptions& options) {
+          return RunLoopback(scenario, options);
+        }});
+  }
+  return benchmarks;
+}
+
+}  // namespace cast
+}  // namespace openscreen
@@ -0,0 +1,404 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Micro-benchmarks for the hot paths of the Cast Streaming send and receive
+// pipelines: packetization, parsing, crypto, frame collection and RTCP, as well
+// as remoting RPC dispatch and control message parsing.
+
+#include <array>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "cast/protocol/castv2/streaming_examples/answer_data.h"
+#include "cast/protocol/castv2/streaming_examples/capabilities_response_data.h"
+#include "cast/protocol/castv2/streaming_examples/get_capabilities_data.h"
+#include "cast/protocol/castv2/streaming_examples/get_status_data.h"
+#include "cast/protocol/castv2/streaming_examples/offer_data.h"
+#include "cast/protocol/castv2/streaming_examples/rpc_data.h"
+#include "cast/protocol/castv2/streaming_examples/status_response_data.h"
+#include "cast/streaming/benchmarks/benchmark_harness.h"
+#include "cast/streaming/compound_rtcp_builder.h"
+#include "cast/streaming/compound_rtcp_parser.h"
+#include "cast/streaming/encoded_frame.h"
+#include "cast/streaming/frame_collector.h"
+#include "cast/streaming/frame_crypto.h"
+#include "cast/streaming/receiver_message.h"
+#include "cast/streaming/remoting.pb.h"
+#include "cast/streaming/rpc_broker.h"
+#include "cast/streaming/rtcp_common.h"
+#include "cast/streaming/rtcp_session.h"
+#include "cast/streaming/rtp_defines.h"
+#include "cast/streaming/rtp_packet_parser.h"
+#include "cast/streaming/rtp_packetizer.h"
+#include "cast/streaming/sender_message.h"
+#include "cast/streaming/ssrc.h"
+#include "util/chrono_helpers.h"
+#include "util/osp_logging.h"
+#include "util/yet_another_bit_vector.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+constexpr Ssrc kSenderSsrc = 1;
+constexpr Ssrc kReceiverSsrc = 2;
+constexpr RtpPayloadType kPayloadType = RtpPayloadType::kVideoVp8;
+constexpr int kMaxPacketSize = kMaxRtpPacketSizeForIpv4UdpOnEthernet;
+
+// Roughly the size of a video frame at 5 Mbps and 30 FPS.
+constexpr int kFrameSize = 20000;
+
+constexpr std::array<uint8_t, 16> kAesKey = {0, 1, 2,  3,  4,  5,  6,  7,
+                                             8, 9, 10, 11, 12, 13, 14, 15};
+constexpr std::array<uint8_t, 16> kIvMask = {15, 14, 13, 12, 11, 10, 9, 8,
+                                             7,  6,  5,  4,  3,  2,  1, 0};
+
+// Returns an encrypted frame whose payload is |size| bytes.
+EncryptedFrame MakeEncryptedFrame(int size) {
+  std::vector<uint8_t> payload(size);
+  for (int i = 0; i < size; ++i) {
+    payload[i] = static_cast<uint8_t>(i);
+  }
+  EncodedFrame frame;
+  frame.dependency = EncodedFrame::KEY_FRAME;
+  frame.frame_id = FrameId::first();
+  frame.referenced_frame_id = frame.frame_id;
+  frame.rtp_timestamp = RtpTimeTicks() + RtpTimeDelta::FromTicks(90000);
+  frame.reference_time = Clock::now();
+  frame.data = absl::Span<uint8_t>(payload);
+  return FrameCrypto(kAesKey, kIvMask).Encrypt(frame);
+}
+
+// Returns all the RTP packets for a |frame|.
+std::vector<std::vector<uint8_t>> PacketizeFrame(const EncryptedFrame& frame) {
+  RtpPacketizer packetizer(kPayloadType, kSenderSsrc, kMaxPacketSize);
+  const int num_packets = packetizer.ComputeNumberOfPackets(frame);
+  std::vector<std::vector<uint8_t>> packets;
+  for (int i = 0; i < num_packets; ++i) {
+    std::vector<uint8_t> buffer(kMaxPacketSize);
+    const absl::Span<uint8_t> packet = packetizer.GeneratePacket(
+        frame, static_cast<FramePacketId>(i), absl::Span<uint8_t>(buffer));
+    buffer.resize(packet.size());
+    packets.push_back(std::move(buffer));
+  }
+  return packets;
+}
+
+void BM_RtpPacketizerGeneratePacket(BenchmarkState* state) {
+  const EncryptedFrame frame = MakeEncryptedFrame(kFrameSize);
+  RtpPacketizer packetizer(kPayloadType, kSenderSsrc, kMaxPacketSize);
+  const int num_packets = packetizer.ComputeNumberOfPackets(frame);
+  uint8_t buffer[kMaxPacketSize];
+  int64_t bytes = 0;
+
+  state->StartTiming();
+  for (int64_t i = 0; i < state->iterations(); ++i) {
+    const absl::Span<uint8_t> packet = packetizer.GeneratePacket(
+        frame, static_cast<FramePacketId>(i % num_packets), buffer);
+    bytes += packet.size();
+    DoNotOptimize(packet.data());
+  }
+  state->StopTiming();
+  state->SetBytesProcessed(bytes);
+}
+
+void BM_RtpPacketParserParse(BenchmarkState* state) {
+  const std::vector<std::vector<uint8_t>> packets =
+      PacketizeFrame(MakeEncryptedFrame(kFrameSize));
+  RtpPacketParser parser(kSenderSsrc);
+  int64_t bytes = 0;
+
+  state->StartTiming();
+  for (int64_t i = 0; i < state->iterations(); ++i) {
+    const std::vector<uint8_t>& packet = packets[i % packets.size()];
+    const absl::optional<RtpPacketParser::ParseResult> result =
+        parser.Parse(packet);
+    OSP_DCHECK(result);
+    bytes += packet.size();
+    DoNotOptimize(result->payload.data());
+  }
+  state->StopTiming();
+  state->SetBytesProcessed(bytes);
+}
+
+void BM_FrameCryptoEncrypt(BenchmarkState* state) {
+  std::vector<uint8_t> payload(kFrameSize, 0xab);
+  EncodedFrame frame;
+  frame.frame_id = FrameId::first();
+  frame.data = absl::Span<uint8_t>(payload);
+  const FrameCrypto crypto(kAesKey, kIvMask);
+
+  state->StartTiming();
+  for (int64_t i = 0; i < state->iterations(); ++i) {
+    const EncryptedFrame encrypted = crypto.Encrypt(frame);
+    DoNotOptimize(encrypted.data.data());
+    ++frame.frame_id;
+  }
+  state->StopTiming();
+  state->SetBytesProcessed(state->iterations() * kFrameSize);
+}
+
+void BM_FrameCryptoDecrypt(BenchmarkState* state) {
+  const EncryptedFrame encrypted = MakeEncryptedFrame(kFrameSize);
+  const FrameCrypto crypto(kAesKey, kIvMask);
+  std::vector<uint8_t> buffer(FrameCrypto::GetPlaintextSize(encrypted));
+  EncodedFrame decrypted;
+  decrypted.data = absl::Span<uint8_t>(buffer);
+
+  state->StartTiming();
+  for (int64_t i = 0; i < state->iterations(); ++i) {
+    crypto.Decrypt(encrypted, &decrypted);
+    DoNotOptimize(buffer.data());
+  }
+  state->StopTiming();
+  state->SetBytesProcessed(state->iterations() * kFrameSize);
+}
+
+// Measures collecting all of a frame's packets and assembling the frame. The
+// per-packet copy into a fresh buffer is included, since the Receiver must do
+// the same when it reads each packet from the socket.
+void BM_FrameCollectorCollectAndAssemble(BenchmarkState* state) {
+  const std::vector<std::vector<uint8_t>> packets =
+      PacketizeFrame(MakeEncryptedFrame(kFrameSize));
+  RtpPacketParser parser(kSenderSsrc);
+  std::vector<RtpPacketParser::ParseResult> parts;
+  std::vector<size_t> payload_offsets;
+  for (const std::vector<uint8_t>& packet : packets) {
+    parts.push_back(parser.Parse(packet).value());
+    payload_offsets.push_back(parts.back().payload.data() - packet.data());
+  }
+  FrameCollector collector;
+  std::vector<uint8_t> buffer;
+
+  state->StartTiming();
+  for (int64_t i = 0; i < state->iterations(); ++i) {
+    collector.set_frame_id(FrameId::first());
+    for (size_t j = 0; j < packets.size(); ++j) {
+      buffer.assign(packets[j].begin(), packets[j].end());
+      RtpPacketParser::ParseResult& part = parts[j];
+      part.payload = absl::Span<const uint8_t>(
+          buffer.data() + payload_offsets[j], part.payload.size());
+      const bool ok = collector.CollectRtpPacket(part, &buffer);
+      OSP_DCHECK(ok);
+    }
+    OSP_DCHECK(collector.is_complete());
+    DoNotOptimize(collector.PeekAtAssembledFrame().data.data());
+    collector.Reset();
+  }
+  state->StopTiming();
+  state->SetBytesProcessed(state->iterations() * kFrameSize);
+}
+
+// Includes, in the next packet built by |builder|, the feedback a Receiver
+// might send while recovering from a burst of packet loss.
+void IncludeTypicalFeedback(CompoundRtcpBuilder* builder) {
+  RtcpReportBlock report;
+  report.ssrc = kSenderSsrc;
+  report.SetPacketFractionLostNumerator(100, 95);
+  report.cumulative_packets_lost = 42;
+  report.extended_high_sequence_number = 12345;
+  report.jitter = RtpTimeDelta::FromTicks(90);
+  builder->IncludeReceiverReportInNextPacket(report);
+
+  const FrameId checkpoint = FrameId::first() + 100;
+  std::vector<PacketNack> nacks;
+  for (int i = 0; i < 8; ++i) {
+    nacks.push_back(PacketNack{checkpoint + 1, static_cast<FramePacketId>(i)});
+  }
+  nacks.push_back(PacketNack{checkpoint + 3, kAllPacketsLost});
+  builder->IncludeFeedbackInNextPacket(
+      std::move(nacks), std::vector<FrameId>{checkpoint + 2, checkpoint + 4});
+}
+
+void BM_CompoundRtcpBuilderBuildPacket(BenchmarkState* state) {
+  const Clock::time_point start_time = Clock::now();
+  RtcpSession session(kSenderSsrc, kReceiverSsrc, start_time);
+  CompoundRtcpBuilder builder(&session);
+  builder.SetCheckpointFrame(FrameId::first() + 100);
+  uint8_t buffer[kMaxPacketSize];
+  int64_t bytes = 0;
+
+  state->StartTiming();
+  for (int64_t i = 0; i < state->iterations(); ++i) {
+    IncludeTypicalFeedback(&builder);
+    const absl::Span<uint8_t> packet =
+        builder.BuildPacket(start_time + milliseconds(i), buffer);
+    bytes += packet.size();
+    DoNotOptimize(packet.data());
+  }
+  state->StopTiming();
+  state->SetBytesProcessed(bytes);
+}
+
+void BM_CompoundRtcpParserParse(BenchmarkState* state) {
+  const Clock::time_point start_time = Clock::now();
+  RtcpSession session(kSenderSsrc, kReceiverSsrc, start_time);
+  CompoundRtcpBuilder builder(&session);
+  builder.SetCheckpointFrame(FrameId::first() + 100);
+  IncludeTypicalFeedback(&builder);
+  uint8_t buffer[kMaxPacketSize];
+  const absl::Span<uint8_t> packet = builder.BuildPacket(start_time, buffer);
+
+  // The client callbacks all default to no-ops.
+  class NullClient : public CompoundRtcpParser::Client {
+  } client;
+  CompoundRtcpParser parser(&session, &client);
+  const FrameId max_feedback_frame_id = FrameId::first() + 200;
+
+  state->StartTiming();
+  for (int64_t i = 0; i < state->iterations(); ++i) {
+    const bool ok = parser.Parse(packet, max_feedback_frame_id);
+    OSP_DCHECK(ok);
+  }
+  state->StopTiming();
+  state->SetBytesProcessed(state->iterations() * packet.size());
+}
+
+// Exercises a YetAnotherBitVector of |size| bits the way the Receiver and
+// FrameCollector do: marking bits, searching, counting, and sliding the window.
+void RunBitVectorBenchmark(int size, BenchmarkState* state) {
+  YetAnotherBitVector bits(size, YetAnotherBitVector::CLEARED);
+
+  state->StartTiming();
+  for (int64_t i = 0; i < state->iterations(); ++i) {
+    const int pos = static_cast<int>(i % size);
+    bits.Set(pos);
+    bits.Clear((pos * 7) % size);
+    DoNotOptimize(bits.IsSet((pos * 3) % size));
+    DoNotOptimize(bits.FindFirstSet());
+    DoNotOptimize(bits.CountBitsSet(0, size));
+    if (pos == size - 1) {
+      bits.ShiftRight(size / 2);
+    }
+  }
+  state->StopTiming();
+}
+
+// Dispatches RPC messages round-robin across |num_handles| registered
+// components, one message at a time or (if |batch_size| > 1) in batches.
+void RunRpcBrokerBenchmark(int num_handles,
+                           int batch_size,
+                           BenchmarkState* state) {
+  RpcBroker broker([](std::vector<uint8_t> message) {});
+  int64_t received_count = 0;
+  std::vector<RpcBroker::Handle> handles;
+  for (int i = 0; i < num_handles; ++i) {
+    handles.push_back(broker.GetUniqueHandle());
+    broker.RegisterMessageReceiverCallback(
+        handles.back(),
+        [&received_count](const RpcMessage& message) { ++received_count; });
+  }
+
+  RpcMessageBatch batch;
+  for (int i = 0; i < batch_size; ++i) {
+    RpcMessage* const message = batch.add_messages();
+    message->set_proc(RpcMessage::RPC_DS_READUNTIL);
+    message->set_integer_value(i);
+  }
+
+  state->StartTiming();
+  for (int64_t i = 0; i < state->iterations(); i += batch_size) {
+    for (int j = 0; j < batch_size; ++j) {
+      batch.mutable_messages(j)->set_handle(handles[(i + j) % num_handles]);
+    }
+    if (batch_size == 1) {
+      broker.ProcessMessageFromRemote(batch.messages(0));
+    } else {
+      broker.ProcessBatchFromRemote(batch);
+    }
+  }
+  state->StopTiming();
+  OSP_DCHECK_GE(received_count, state->iterations());
+  DoNotOptimize(received_count);
+}
+
+// Parses each of |documents| as a |Message|, the way SessionMessager does.
+template <typename Message>
+void RunMessageParseBenchmark(absl::Span<const absl::string_view> documents,
+                              BenchmarkState* state) {
+  int64_t bytes_per_iteration = 0;
+  for (absl::string_view document : documents) {
+    bytes_per_iteration += document.size();
+  }
+
+  state->StartTiming();
+  for (int64_t i = 0; i < state->iterations(); ++i) {
+    for (absl::string_view document : documents) {
+      ErrorOr<Message> message = Message::ParseFromString(document);
+      OSP_DCHECK(message.is_value());
+      DoNotOptimize(message);
+    }
+  }
+  state->StopTiming();
+  state->SetBytesProcessed(state->iterations() * bytes_per_iteration);
+}
+
+// The streaming_examples corpus, split by the direction of each message.
+constexpr absl::string_view kSenderMessages[] = {kOffer, kGetStatus,
+                                                 kGetCapabilities, kRpc};
+constexpr absl::string_view kReceiverMessages[] = {
+    kAnswer, kStatusResponse, kCapabilitiesResponse, kRpc};
+
+// The messages sent repeatedly during a session, as opposed to once at the
+// start of it.
+constexpr absl::string_view kFrequentReceiverMessages[] = {kStatusResponse,
+                                                           kRpc};
+
+}  // namespace
+
+std::vector<Benchmark> GetMicroBenchmarks() {
+  return {
+      MakeMicroBenchmark("RtpPacketizer/GeneratePacket",
+                         &BM_RtpPacketizerGeneratePacket),
+      MakeMicroBenchmark("RtpPacketParser/Parse", &BM_RtpPacketParserParse),
+      MakeMicroBenchmark("FrameCrypto/Encrypt", &BM_FrameCryptoEncrypt),
+      MakeMicroBenchmark("FrameCrypto/Decrypt", &BM_FrameCryptoDecrypt),
+      MakeMicroBenchmark("FrameCollector/CollectAndAssemble",
+                         &BM_FrameCollectorCollectAndAssemble),
+      MakeMicroBenchmark("CompoundRtcpBuilder/BuildPacket",
+                         &BM_CompoundRtcpBuilderBuildPacket),
+      MakeMicroBenchmark("CompoundRtcpParser/Parse",
+                         &BM_CompoundRtcpParserParse),
+      MakeMicroBenchmark("YetAnotherBitVector/64",
+                         [](BenchmarkState* state) {
+                           RunBitVectorBenchmark(64, state);
+                         }),
+      MakeMicroBenchmark("YetAnotherBitVector/1024",
+                         [](BenchmarkState* state) {
+                           RunBitVectorBenchmark(1024, state);
+                         }),
+      MakeMicroBenchmark("RpcBroker/ProcessMessageFromRemote/8",
+                         [](BenchmarkState* state) {
+                           RunRpcBrokerBenchmark(8, 1, state);
+                         }),
+      MakeMicroBenchmark("RpcBroker/ProcessMessageFromRemote/256",
+                         [](BenchmarkState* state) {
+                           RunRpcBrokerBenchmark(256, 1, state);
+                         }),
+      MakeMicroBenchmark("RpcBroker/ProcessBatchFromRemote/256",
+                         [](BenchmarkState* state) {
+                           RunRpcBrokerBenchmark(256, 16, state);
+                         }),
+      MakeMicroBenchmark("SenderMessage/Parse",
+                         [](BenchmarkState* state) {
+                           RunMessageParseBenchmark<SenderMessage>(
+                               kSenderMessages, state);
+                         }),
+      MakeMicroBenchmark("ReceiverMessage/Parse",
+                         [](BenchmarkState* state) {
+                           RunMessageParseBenchmark<ReceiverMessage>(
+                               kReceiverMessages, state);
+                         }),
+      MakeMicroBenchmark("ReceiverMessage/ParseFrequent",
+                         [](BenchmarkState* state) {
+                           RunMessageParseBenchmark<ReceiverMessage>(
+                               kFrequentReceiverMessages, state);
+                         }),
+  };
+}
+
+}  // namespace cast
+}  // namespace openscreen
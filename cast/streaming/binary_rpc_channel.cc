@@ -0,0 +1,156 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/binary_rpc_channel.h"
+
+#include <utility>
+
+#include "google/protobuf/arena.h"
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+namespace {
+
+// The tag preceding each RpcMessage in a serialized RpcMessageBatch: field
+// number 1, with the length-delimited wire type.
+constexpr uint8_t kBatchMessageTag = (1 << 3) | 2;
+
+// The maximum size of a varint-encoded length prefix.
+constexpr int kMaxVarintSize = 5;
+
+// Most batches are a handful of small messages, and are parsed entirely within
+// this much stack memory, without any heap allocations.
+constexpr int kArenaInitialBlockSize = 4096;
+
+void AppendVarint(uint32_t value, std::vector<uint8_t>* out) {
+  while (value >= 0x80) {
+    out->push_back(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  out->push_back(static_cast<uint8_t>(value));
+}
+
+// Splits a batch built by BinaryRpcChannel::SendMessage() back into its
+// serialized RpcMessages.
+std::vector<std::vector<uint8_t>> SplitBatch(absl::Span<const uint8_t> batch) {
+  std::vector<std::vector<uint8_t>> messages;
+  while (!batch.empty()) {
+    OSP_DCHECK_EQ(batch[0], kBatchMessageTag);
+    batch.remove_prefix(1);
+    uint32_t size = 0;
+    for (int shift = 0; !batch.empty(); shift += 7) {
+      const uint8_t byte = batch[0];
+      batch.remove_prefix(1);
+      size |= static_cast<uint32_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80)) {
+        break;
+      }
+    }
+    OSP_DCHECK_LE(size, batch.size());
+    messages.emplace_back(batch.begin(), batch.begin() + size);
+    batch.remove_prefix(size);
+  }
+  return messages;
+}
+
+}  // namespace
+
+BinaryRpcChannel::BinaryRpcChannel(TaskRunner* task_runner,
+                                   SendBatchCallback send_batch_cb,
+                                   FallbackSendCallback fallback_send_cb,
+                                   ReceiveBatchCallback receive_batch_cb)
+    : task_runner_(task_runner),
+      send_batch_cb_(std::move(send_batch_cb)),
+      fallback_send_cb_(std::move(fallback_send_cb)),
+      receive_batch_cb_(std::move(receive_batch_cb)) {
+  OSP_DCHECK(task_runner_);
+  OSP_DCHECK(send_batch_cb_);
+  OSP_DCHECK(fallback_send_cb_);
+  OSP_DCHECK(receive_batch_cb_);
+}
+
+BinaryRpcChannel::~BinaryRpcChannel() = default;
+
+void BinaryRpcChannel::EnableBinaryMessages() {
+  if (!is_binary_enabled_) {
+    OSP_DVLOG << "Switching to binary RPC messaging.";
+    is_binary_enabled_ = true;
+  }
+}
+
+void BinaryRpcChannel::SendMessage(std::vector<uint8_t> serialized_message) {
+  if (!is_binary_enabled_) {
+    fallback_send_cb_(std::move(serialized_message));
+    return;
+  }
+
+  const int encoded_size =
+      1 + kMaxVarintSize + static_cast<int>(serialized_message.size());
+  if (static_cast<int>(pending_batch_.size()) + encoded_size > kMaxBatchSize) {
+    Flush();
+  }
+
+  pending_batch_.push_back(kBatchMessageTag);
+  AppendVarint(static_cast<uint32_t>(serialized_message.size()),
+               &pending_batch_);
+  pending_batch_.insert(pending_batch_.end(), serialized_message.begin(),
+                        serialized_message.end());
+
+  if (!flush_task_posted_) {
+    flush_task_posted_ = true;
+    task_runner_->PostTask([weak_this = weak_factory_.GetWeakPtr()] {
+      if (weak_this) {
+        weak_this->flush_task_posted_ = false;
+        weak_this->Flush();
+      }
+    });
+  }
+}
+
+void BinaryRpcChannel::Flush() {
+  if (pending_batch_.empty()) {
+    return;
+  }
+
+  const Error error = send_batch_cb_(pending_batch_);
+  if (!error.ok()) {
+    // The message port cannot carry the batch (e.g., it does not support binary
+    // messages after all), so send its messages individually instead, and
+    // stop batching.
+    OSP_LOG_WARN << "Failed to send a batch of RPC messages, falling back: "
+                 << error;
+    is_binary_enabled_ = false;
+    for (std::vector<uint8_t>& message : SplitBatch(pending_batch_)) {
+      fallback_send_cb_(std::move(message));
+    }
+  }
+  pending_batch_.clear();
+}
+
+Error BinaryRpcChannel::ProcessBatchFromRemote(
+    absl::Span<const uint8_t> batch) {
+  alignas(8) char initial_block[kArenaInitialBlockSize];
+  google::protobuf::ArenaOptions options;
+  options.initial_block = initial_block;
+  options.initial_block_size = sizeof(initial_block);
+  google::protobuf::Arena arena(options);
+
+  RpcMessageBatch* const messages =
+      google::protobuf::Arena::CreateMessage<RpcMessageBatch>(&arena);
+  if (!messages->ParseFromArray(batch.data(), batch.size())) {
+    return Error(Error::Code::kParseError,
+                 "Failed to parse a batch of RPC messages");
+  }
+
+  receive_batch_cb_(*messages);
+  return Error::None();
+}
+
+// static
+constexpr int BinaryRpcChannel::kMaxBatchSize;
+
+}  // namespace cast
+}  // namespace openscreen
@@ -0,0 +1,112 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STREAMING_BINARY_RPC_CHANNEL_H_
+#define CAST_STREAMING_BINARY_RPC_CHANNEL_H_
+
+#include <stdint.h>
+
+#include <functional>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "cast/streaming/remoting.pb.h"
+#include "platform/api/task_runner.h"
+#include "platform/base/error.h"
+#include "util/weak_ptr.h"
+
+namespace openscreen {
+namespace cast {
+
+// Carries RPC messages between an RpcBroker and the remote end point. Once
+// binary messaging has been negotiated, outgoing messages are batched into a
+// single RpcMessageBatch per TaskRunner task, and sent as a binary payload on
+// the |kCastRemotingBinaryNamespace|. Before then (or forever, with older
+// remotes), each message is handed to the fallback callback, which is expected
+// to send it as a base64-encoded RPC message on the |kCastRemotingNamespace|.
+//
+// Negotiation: Each side advertises support in the OFFER/ANSWER exchange (see
+// Offer::supports_binary_rpc and Answer::supports_binary_rpc), but only if its
+// MessagePort supports binary messages. Both the SenderSession and the
+// ReceiverSession then enable binary messaging if, and only if, both sides
+// advertised support. If a batch can not be sent anyway, its messages are
+// handed to the fallback callback, and binary messaging is disabled.
+//
+// Example wiring (see SenderSession and ReceiverSession):
+//
+//   BinaryRpcChannel channel(
+//       task_runner,
+//       [&](absl::Span<const uint8_t> batch) {
+//         return messager.SendBinaryRpcBatch(batch);
+//       },
+//       [&](std::vector<uint8_t> message) { /* Send JSON kRpc message. */ },
+//       [&](const RpcMessageBatch& batch) {
+//         broker.ProcessBatchFromRemote(batch);
+//       });
+//   RpcBroker broker([&](std::vector<uint8_t> message) {
+//     channel.SendMessage(std::move(message));
+//   });
+//   messager.SetBinaryRpcHandler([&](absl::Span<const uint8_t> batch) {
+//     channel.ProcessBatchFromRemote(batch);
+//   });
+class BinaryRpcChannel {
+ public:
+  using SendBatchCallback = std::function<Error(absl::Span<const uint8_t>)>;
+  using FallbackSendCallback = std::function<void(std::vector<uint8_t>)>;
+  using ReceiveBatchCallback = std::function<void(const RpcMessageBatch&)>;
+
+  BinaryRpcChannel(TaskRunner* task_runner,
+                   SendBatchCallback send_batch_cb,
+                   FallbackSendCallback fallback_send_cb,
+                   ReceiveBatchCallback receive_batch_cb);
+  BinaryRpcChannel(const BinaryRpcChannel&) = delete;
+  BinaryRpcChannel& operator=(const BinaryRpcChannel&) = delete;
+  ~BinaryRpcChannel();
+
+  bool is_binary_enabled() const { return is_binary_enabled_; }
+
+  // Switches to sending batches on the binary namespace. See the class
+  // comments for when this should be called.
+  void EnableBinaryMessages();
+
+  // Sends a serialized RpcMessage, as provided to an
+  // RpcBroker::SendMessageCallback. If binary messaging is enabled, the message
+  // is appended to the pending batch, which is sent at the end of the current
+  // TaskRunner task (or sooner, if it becomes too large).
+  void SendMessage(std::vector<uint8_t> serialized_message);
+
+  // Sends the pending batch immediately, if there is one. If sending fails,
+  // binary messaging is disabled, and the batch's messages are handed to the
+  // fallback callback instead.
+  void Flush();
+
+  // Parses a batch received from the remote, and passes it to the
+  // ReceiveBatchCallback. This does not enable binary messaging for replies,
+  // since that must be negotiated.
+  Error ProcessBatchFromRemote(absl::Span<const uint8_t> batch);
+
+  // Batches are kept comfortably below the maximum Cast message body size,
+  // leaving room for the CastMessage envelope.
+  static constexpr int kMaxBatchSize = 60 * 1024;
+
+ private:
+  TaskRunner* const task_runner_;
+  const SendBatchCallback send_batch_cb_;
+  const FallbackSendCallback fallback_send_cb_;
+  const ReceiveBatchCallback receive_batch_cb_;
+
+  bool is_binary_enabled_ = false;
+
+  // The serialized RpcMessageBatch being built, and whether a task has been
+  // posted to send it.
+  std::vector<uint8_t> pending_batch_;
+  bool flush_task_posted_ = false;
+
+  WeakPtrFactory<BinaryRpcChannel> weak_factory_{this};
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STREAMING_BINARY_RPC_CHANNEL_H_
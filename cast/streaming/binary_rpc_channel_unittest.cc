@@ -0,0 +1,178 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/binary_rpc_channel.h"
+
+#include <string>
+#include <vector>
+
+#include "cast/streaming/remoting.pb.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "platform/test/fake_clock.h"
+#include "platform/test/fake_task_runner.h"
+
+namespace openscreen {
+namespace cast {
+
+namespace {
+
+std::vector<uint8_t> Serialize(const RpcMessage& message) {
+  std::vector<uint8_t> serialized(message.ByteSizeLong());
+  EXPECT_TRUE(message.SerializeToArray(serialized.data(), serialized.size()));
+  return serialized;
+}
+
+RpcMessage MakeMessage(int handle, const std::string& value) {
+  RpcMessage message;
+  message.set_handle(handle);
+  message.set_proc(RpcMessage::RPC_R_SETVOLUME);
+  message.set_string_value(value);
+  return message;
+}
+
+}  // namespace
+
+class BinaryRpcChannelTest : public testing::Test {
+ public:
+  BinaryRpcChannelTest()
+      : clock_(Clock::now()),
+        task_runner_(&clock_),
+        channel_(
+            &task_runner_,
+            [this](absl::Span<const uint8_t> batch) {
+              if (!send_batch_result_.ok()) {
+                return send_batch_result_;
+              }
+              sent_batches_.emplace_back(batch.begin(), batch.end());
+              return Error::None();
+            },
+            [this](std::vector<uint8_t> message) {
+              fallback_messages_.push_back(std::move(message));
+            },
+            [this](const RpcMessageBatch& batch) {
+              for (const RpcMessage& message : batch.messages()) {
+                received_messages_.push_back(message);
+              }
+            }) {}
+
+ protected:
+  FakeClock clock_;
+  FakeTaskRunner task_runner_;
+  Error send_batch_result_ = Error::None();
+  std::vector<std::vector<uint8_t>> sent_batches_;
+  std::vector<std::vector<uint8_t>> fallback_messages_;
+  std::vector<RpcMessage> received_messages_;
+  BinaryRpcChannel channel_;
+};
+
+TEST_F(BinaryRpcChannelTest, UsesFallbackUntilEnabled) {
+  ASSERT_FALSE(channel_.is_binary_enabled());
+
+  const std::vector<uint8_t> serialized = Serialize(MakeMessage(101, "a"));
+  channel_.SendMessage(serialized);
+  task_runner_.RunTasksUntilIdle();
+
+  ASSERT_EQ(1u, fallback_messages_.size());
+  EXPECT_EQ(serialized, fallback_messages_[0]);
+  EXPECT_TRUE(sent_batches_.empty());
+}
+
+TEST_F(BinaryRpcChannelTest, BatchesMessagesSentInTheSameTask) {
+  channel_.EnableBinaryMessages();
+  channel_.SendMessage(Serialize(MakeMessage(101, "a")));
+  channel_.SendMessage(Serialize(MakeMessage(102, "b")));
+  channel_.SendMessage(Serialize(MakeMessage(103, "c")));
+  EXPECT_TRUE(sent_batches_.empty());
+
+  task_runner_.RunTasksUntilIdle();
+  EXPECT_TRUE(fallback_messages_.empty());
+  ASSERT_EQ(1u, sent_batches_.size());
+
+  RpcMessageBatch batch;
+  ASSERT_TRUE(
+      batch.ParseFromArray(sent_batches_[0].data(), sent_batches_[0].size()));
+  ASSERT_EQ(3, batch.messages_size());
+  EXPECT_EQ(101, batch.messages(0).handle());
+  EXPECT_EQ("a", batch.messages(0).string_value());
+  EXPECT_EQ(102, batch.messages(1).handle());
+  EXPECT_EQ(103, batch.messages(2).handle());
+  EXPECT_EQ("c", batch.messages(2).string_value());
+
+  // Nothing more to send.
+  channel_.Flush();
+  task_runner_.RunTasksUntilIdle();
+  EXPECT_EQ(1u, sent_batches_.size());
+}
+
+TEST_F(BinaryRpcChannelTest, SplitsBatchesThatWouldBeTooLarge) {
+  channel_.EnableBinaryMessages();
+  const std::string big_value(BinaryRpcChannel::kMaxBatchSize / 3, 'x');
+  for (int i = 0; i < 4; ++i) {
+    channel_.SendMessage(Serialize(MakeMessage(100 + i, big_value)));
+  }
+  task_runner_.RunTasksUntilIdle();
+
+  ASSERT_EQ(2u, sent_batches_.size());
+  int handle = 100;
+  for (const std::vector<uint8_t>& sent : sent_batches_) {
+    EXPECT_LE(static_cast<int>(sent.size()), BinaryRpcChannel::kMaxBatchSize);
+    RpcMessageBatch batch;
+    ASSERT_TRUE(batch.ParseFromArray(sent.data(), sent.size()));
+    for (const RpcMessage& message : batch.messages()) {
+      EXPECT_EQ(handle++, message.handle());
+    }
+  }
+  EXPECT_EQ(104, handle);
+}
+
+TEST_F(BinaryRpcChannelTest, FallsBackIfBatchCannotBeSent) {
+  channel_.EnableBinaryMessages();
+  send_batch_result_ = Error(Error::Code::kOperationInvalid);
+  const std::string big_value(300, 'x');
+  for (int handle = 101; handle < 104; ++handle) {
+    channel_.SendMessage(Serialize(MakeMessage(handle, big_value)));
+  }
+  task_runner_.RunTasksUntilIdle();
+
+  EXPECT_TRUE(sent_batches_.empty());
+  EXPECT_FALSE(channel_.is_binary_enabled());
+  ASSERT_EQ(3u, fallback_messages_.size());
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_EQ(Serialize(MakeMessage(101 + i, big_value)),
+              fallback_messages_[i]);
+  }
+
+  // Later messages go straight to the fallback.
+  channel_.SendMessage(Serialize(MakeMessage(104, "a")));
+  EXPECT_EQ(4u, fallback_messages_.size());
+}
+
+TEST_F(BinaryRpcChannelTest, DispatchesReceivedBatch) {
+  RpcMessageBatch batch;
+  *batch.add_messages() = MakeMessage(101, "a");
+  *batch.add_messages() = MakeMessage(102, std::string(8192, 'b'));
+  std::vector<uint8_t> serialized(batch.ByteSizeLong());
+  ASSERT_TRUE(batch.SerializeToArray(serialized.data(), serialized.size()));
+
+  ASSERT_TRUE(channel_.ProcessBatchFromRemote(serialized).ok());
+  ASSERT_EQ(2u, received_messages_.size());
+  EXPECT_EQ(101, received_messages_[0].handle());
+  EXPECT_EQ("a", received_messages_[0].string_value());
+  EXPECT_EQ(102, received_messages_[1].handle());
+  EXPECT_EQ(8192u, received_messages_[1].string_value().size());
+
+  // Replies are only sent as batches once binary messaging is negotiated.
+  EXPECT_FALSE(channel_.is_binary_enabled());
+}
+
+TEST_F(BinaryRpcChannelTest, RejectsMalformedBatch) {
+  const std::vector<uint8_t> garbage = {0x0a, 0x7f, 0x01};
+  EXPECT_FALSE(channel_.ProcessBatchFromRemote(garbage).ok());
+  EXPECT_TRUE(received_messages_.empty());
+  EXPECT_FALSE(channel_.is_binary_enabled());
+}
+
+}  // namespace cast
+}  // namespace openscreen
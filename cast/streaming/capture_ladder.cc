@@ -0,0 +1,190 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/capture_ladder.h"
+
+#include <algorithm>
+
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+using capture_recommendations::Resolution;
+
+namespace {
+
+// Each offered resolution is also scaled down by these factors, for as long as
+// it stays above the recommended minimum.
+constexpr double kScaleFactors[] = {1.0, 3.0 / 4, 2.0 / 3, 1.0 / 2, 1.0 / 3};
+
+// The maximum frame rate is also halved, but never to below this. NOTE: The
+// recommended minimum frame rate is not used here, since it defaults to the
+// usual maximum.
+constexpr double kMinFrameRate = 15.0;
+
+// Video encoders generally require even dimensions.
+int RoundDownToEven(double value) {
+  return static_cast<int>(value) & ~1;
+}
+
+}  // namespace
+
+CaptureLadder::CaptureLadder(
+    const VideoCaptureConfig& config,
+    const capture_recommendations::Video& recommendations)
+    : CaptureLadder(config, recommendations, Parameters{}) {}
+
+CaptureLadder::CaptureLadder(
+    const VideoCaptureConfig& config,
+    const capture_recommendations::Video& recommendations,
+    Parameters params)
+    : params_(params) {
+  OSP_DCHECK(!config.resolutions.empty());
+  OSP_DCHECK_GT(params_.smoothing_weight, 0.0);
+  OSP_DCHECK_LE(params_.smoothing_weight, 1.0);
+
+  const Resolution& minimum = recommendations.minimum;
+  const Resolution& maximum = recommendations.maximum;
+  const double max_frame_rate =
+      std::min(static_cast<double>(config.max_frame_rate.numerator) /
+                   config.max_frame_rate.denominator,
+               maximum.frame_rate);
+  std::vector<double> frame_rates{max_frame_rate};
+  if (max_frame_rate / 2 >= kMinFrameRate) {
+    frame_rates.push_back(max_frame_rate / 2);
+  }
+
+  for (const DisplayResolution& resolution : config.resolutions) {
+    // Scale down to fit within the recommended maximum, keeping the aspect
+    // ratio.
+    const double fit_factor =
+        std::min({1.0, static_cast<double>(maximum.width) / resolution.width,
+                  static_cast<double>(maximum.height) / resolution.height});
+    for (double scale_factor : kScaleFactors) {
+      const int width =
+          RoundDownToEven(resolution.width * fit_factor * scale_factor);
+      const int height =
+          RoundDownToEven(resolution.height * fit_factor * scale_factor);
+      if (width < minimum.width || height < minimum.height) {
+        break;
+      }
+      for (double frame_rate : frame_rates) {
+        rungs_.push_back(Resolution{width, height, frame_rate});
+      }
+    }
+  }
+
+  // If even the smallest offered resolution is below the recommended minimum,
+  // it must be used anyway.
+  if (rungs_.empty()) {
+    const auto smallest = std::min_element(
+        config.resolutions.begin(), config.resolutions.end(),
+        [](const DisplayResolution& a, const DisplayResolution& b) {
+          return a.width * a.height < b.width * b.height;
+        });
+    rungs_.push_back(
+        Resolution{smallest->width, smallest->height, max_frame_rate});
+  }
+
+  std::sort(rungs_.begin(), rungs_.end(),
+            [](const Resolution& a, const Resolution& b) {
+              return a.effective_bit_rate() > b.effective_bit_rate();
+            });
+  rungs_.erase(std::unique(rungs_.begin(), rungs_.end()), rungs_.end());
+}
+
+CaptureLadder::~CaptureLadder() = default;
+
+void CaptureLadder::OnBandwidthEstimate(int bits_per_second) {
+  OSP_DCHECK_GE(bits_per_second, 0);
+  bandwidth_ = (bandwidth_ < 0)
+                   ? bits_per_second
+                   : bandwidth_ + params_.smoothing_weight *
+                                      (bits_per_second - bandwidth_);
+}
+
+void CaptureLadder::OnEncoderUtilization(double utilization) {
+  OSP_DCHECK_GE(utilization, 0.0);
+  utilization_ = (utilization_ < 0)
+                     ? utilization
+                     : utilization_ + params_.smoothing_weight *
+                                          (utilization - utilization_);
+}
+
+bool CaptureLadder::Update(Clock::time_point now) {
+  const bool is_bandwidth_too_low =
+      bandwidth_ >= 0 && bandwidth_ < GetRequiredBitrate(current());
+  const bool is_encoder_redlining = utilization_ > params_.max_utilization;
+  if (is_bandwidth_too_low || is_encoder_redlining) {
+    if (overloaded_since_ == kNever) {
+      overloaded_since_ = now;
+    }
+  } else {
+    overloaded_since_ = kNever;
+  }
+
+  // Stepping up requires a bandwidth estimate with room to spare. If the
+  // encoder's utilization is not being reported, it is assumed to be fine.
+  const bool can_step_up =
+      current_rung_ > 0 && !is_encoder_redlining &&
+      bandwidth_ >= GetRequiredBitrate(rungs_[current_rung_ - 1]) *
+                        params_.step_up_headroom &&
+      utilization_ < params_.step_up_max_utilization;
+  if (can_step_up) {
+    if (underloaded_since_ == kNever) {
+      underloaded_since_ = now;
+    }
+  } else {
+    underloaded_since_ = kNever;
+  }
+
+  if (now < rung_start_time_ + params_.min_rung_duration) {
+    return false;
+  }
+
+  const int last_rung = static_cast<int>(rungs_.size()) - 1;
+  if (overloaded_since_ != kNever &&
+      now - overloaded_since_ >= params_.step_down_delay &&
+      current_rung_ < last_rung) {
+    // Step down at least one rung, and then as far as needed to fit within the
+    // available bandwidth.
+    int rung = current_rung_ + 1;
+    while (rung < last_rung && bandwidth_ >= 0 &&
+           bandwidth_ < GetRequiredBitrate(rungs_[rung])) {
+      ++rung;
+    }
+    MoveTo(rung, now);
+    return true;
+  }
+
+  if (underloaded_since_ != kNever &&
+      now - underloaded_since_ >= params_.step_up_delay) {
+    MoveTo(current_rung_ - 1, now);
+    return true;
+  }
+
+  return false;
+}
+
+int CaptureLadder::GetRequiredBitrate(const Resolution& rung) const {
+  return static_cast<int>(rung.effective_bit_rate() * params_.bits_per_pixel);
+}
+
+void CaptureLadder::MoveTo(int rung, Clock::time_point now) {
+  OSP_DVLOG << "Moving capture from " << current().width << 'x'
+            << current().height << '@' << current().frame_rate << " to "
+            << rungs_[rung].width << 'x' << rungs_[rung].height << '@'
+            << rungs_[rung].frame_rate;
+  current_rung_ = rung;
+  rung_start_time_ = now;
+  overloaded_since_ = kNever;
+  underloaded_since_ = kNever;
+}
+
+// static
+constexpr Clock::time_point CaptureLadder::kNever;
+
+}  // namespace cast
+}  // namespace openscreen
@@ -0,0 +1,120 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STREAMING_CAPTURE_LADDER_H_
+#define CAST_STREAMING_CAPTURE_LADDER_H_
+
+#include <vector>
+
+#include "cast/streaming/capture_configs.h"
+#include "cast/streaming/capture_recommendations.h"
+#include "platform/api/time.h"
+#include "util/chrono_helpers.h"
+
+namespace openscreen {
+namespace cast {
+
+// Adapts the video capture resolution and frame rate at runtime, by moving
+// between the rungs of a "ladder" of resolution and frame rate pairs, all
+// within the limits of the negotiated VideoCaptureConfig and the receiver's
+// capture recommendations. Adjusting the bitrate alone degrades quality badly
+// when bandwidth is low; capturing less data, instead, lets the encoder spend
+// more bits on each pixel.
+//
+// The rungs are ordered by pixel rate (width * height * frame rate), highest
+// first, and the ladder starts at the top. Two signals drive it:
+//
+//   1. The network bandwidth estimate. If it falls below what the current rung
+//      needs, the ladder steps down to the highest rung that fits.
+//   2. The video encoder's utilization (see StreamingVideoEncoder::Stats). If
+//      the encoder is consistently redlining, the ladder steps down one rung,
+//      regardless of the bandwidth.
+//
+// To avoid oscillation, a condition must persist for some time before the
+// ladder moves, stepping up takes much longer than stepping down, and a rung
+// is never left until it has been held for a minimum time.
+class CaptureLadder {
+ public:
+  struct Parameters {
+    // The number of bits per pixel needed to encode video with good quality.
+    // This determines the bitrate needed by each rung.
+    double bits_per_pixel = 0.1;
+
+    // How much more bandwidth than the next higher rung needs must be
+    // available before stepping up to it.
+    double step_up_headroom = 1.3;
+
+    // Encoder utilization above which it is considered to be redlining, and
+    // below which it is considered to have room for more pixels.
+    double max_utilization = 0.9;
+    double step_up_max_utilization = 0.6;
+
+    // How long a condition must persist before the ladder steps down or up.
+    Clock::duration step_down_delay = seconds(2);
+    Clock::duration step_up_delay = seconds(8);
+
+    // The minimum amount of time to stay on a rung after moving to it.
+    Clock::duration min_rung_duration = seconds(3);
+
+    // The weight given to each new sample by the exponentially-weighted moving
+    // averages of the bandwidth and encoder utilization. Range: (0.0,1.0]
+    double smoothing_weight = 0.25;
+  };
+
+  CaptureLadder(const VideoCaptureConfig& config,
+                const capture_recommendations::Video& recommendations);
+  CaptureLadder(const VideoCaptureConfig& config,
+                const capture_recommendations::Video& recommendations,
+                Parameters params);
+  ~CaptureLadder();
+
+  // Updates the estimates with a new bandwidth estimate, in bits per second,
+  // or a new encoder utilization for a frame (the max of the utilization
+  // metrics, where 1.0 means the entire budget for the frame was used).
+  void OnBandwidthEstimate(int bits_per_second);
+  void OnEncoderUtilization(double utilization);
+
+  // Decides whether to move to another rung, based on the estimates so far.
+  // Returns true if the current rung changed. When it does, the video capture
+  // should be reconfigured, and the encoder will then need to start again with
+  // a key frame; no key frames are needed otherwise.
+  bool Update(Clock::time_point now);
+
+  const std::vector<capture_recommendations::Resolution>& rungs() const {
+    return rungs_;
+  }
+  const capture_recommendations::Resolution& current() const {
+    return rungs_[current_rung_];
+  }
+
+  // Returns the bitrate, in bits per second, needed by the given |rung|.
+  int GetRequiredBitrate(const capture_recommendations::Resolution& rung) const;
+
+ private:
+  // Sentinel value meaning "not currently being timed."
+  static constexpr Clock::time_point kNever = Clock::time_point::max();
+
+  void MoveTo(int rung, Clock::time_point now);
+
+  const Parameters params_;
+
+  // Never empty.
+  std::vector<capture_recommendations::Resolution> rungs_;
+  int current_rung_ = 0;
+
+  // Smoothed estimates, or negative values until the first sample.
+  double bandwidth_ = -1;
+  double utilization_ = -1;
+
+  // When the current rung was moved to, and since when it has been
+  // continuously too high, or low, for the estimates.
+  Clock::time_point rung_start_time_ = Clock::time_point::min();
+  Clock::time_point overloaded_since_ = kNever;
+  Clock::time_point underloaded_since_ = kNever;
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STREAMING_CAPTURE_LADDER_H_
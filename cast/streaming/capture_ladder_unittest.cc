@@ -0,0 +1,153 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/capture_ladder.h"
+
+#include "gtest/gtest.h"
+#include "util/chrono_helpers.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+using capture_recommendations::Resolution;
+
+constexpr Clock::time_point kStartTime =
+    Clock::time_point() + Clock::duration(1234567890);
+
+// Enough bandwidth for any rung.
+constexpr int kHighBandwidth = 100 * 1000 * 1000;
+
+class CaptureLadderTest : public testing::Test {
+ public:
+  CaptureLadderTest()
+      : ladder_(MakeConfig(), capture_recommendations::Video{}) {}
+
+  static VideoCaptureConfig MakeConfig() {
+    VideoCaptureConfig config;
+    config.max_frame_rate = FrameRate{30, 1};
+    config.resolutions = {DisplayResolution{1920, 1080}};
+    return config;
+  }
+
+  // Calls Update() every half-second, for |duration|, first feeding in the
+  // given |bandwidth| and |utilization| (unless negative). Returns the number
+  // of times the ladder moved.
+  int RunFor(Clock::duration duration, int bandwidth, double utilization) {
+    int num_moves = 0;
+    const Clock::time_point end_time = now_ + duration;
+    while (now_ < end_time) {
+      now_ += milliseconds(500);
+      if (bandwidth >= 0) {
+        ladder_.OnBandwidthEstimate(bandwidth);
+      }
+      if (utilization >= 0) {
+        ladder_.OnEncoderUtilization(utilization);
+      }
+      if (ladder_.Update(now_)) {
+        ++num_moves;
+      }
+    }
+    return num_moves;
+  }
+
+  int GetCurrentRung() const {
+    for (size_t i = 0; i < ladder_.rungs().size(); ++i) {
+      if (ladder_.rungs()[i] == ladder_.current()) {
+        return static_cast<int>(i);
+      }
+    }
+    return -1;
+  }
+
+ protected:
+  CaptureLadder ladder_;
+  Clock::time_point now_ = kStartTime;
+};
+
+TEST_F(CaptureLadderTest, BuildsLadderWithinLimits) {
+  const capture_recommendations::Video limits;
+  ASSERT_LT(1u, ladder_.rungs().size());
+  EXPECT_EQ((Resolution{1920, 1080, 30}), ladder_.rungs().front());
+  EXPECT_EQ(ladder_.rungs().front(), ladder_.current());
+
+  for (size_t i = 0; i < ladder_.rungs().size(); ++i) {
+    const Resolution& rung = ladder_.rungs()[i];
+    EXPECT_LE(limits.minimum.width, rung.width);
+    EXPECT_LE(limits.minimum.height, rung.height);
+    EXPECT_GE(limits.maximum.width, rung.width);
+    EXPECT_GE(limits.maximum.height, rung.height);
+    EXPECT_EQ(0, rung.width % 2);
+    EXPECT_EQ(0, rung.height % 2);
+    if (i > 0) {
+      EXPECT_LT(rung.effective_bit_rate(),
+                ladder_.rungs()[i - 1].effective_bit_rate());
+    }
+  }
+
+  // Both the resolution and frame rate are reduced along the way.
+  EXPECT_EQ(15.0, ladder_.rungs().back().frame_rate);
+  EXPECT_GT(1920, ladder_.rungs().back().width);
+}
+
+TEST_F(CaptureLadderTest, StepsDownToFitBandwidth) {
+  constexpr int kLowBandwidth = 1000 * 1000;
+
+  // Nothing happens until the bandwidth has been too low for a while.
+  EXPECT_EQ(0, RunFor(milliseconds(1500), kLowBandwidth, -1));
+  EXPECT_EQ(0, GetCurrentRung());
+
+  // Then, several rungs are skipped, straight to one that fits.
+  EXPECT_EQ(1, RunFor(seconds(1), kLowBandwidth, -1));
+  const int rung = GetCurrentRung();
+  ASSERT_LT(1, rung);
+  EXPECT_LE(ladder_.GetRequiredBitrate(ladder_.current()), kLowBandwidth);
+  EXPECT_GT(ladder_.GetRequiredBitrate(ladder_.rungs()[rung - 1]),
+            kLowBandwidth);
+
+  // The ladder stays there while the bandwidth stays the same.
+  EXPECT_EQ(0, RunFor(seconds(30), kLowBandwidth, -1));
+  EXPECT_EQ(rung, GetCurrentRung());
+}
+
+TEST_F(CaptureLadderTest, StepsUpSlowlyOneRungAtATime) {
+  RunFor(seconds(3), 1000 * 1000, -1);
+  const int low_rung = GetCurrentRung();
+  ASSERT_LT(1, low_rung);
+
+  // Even with plenty of bandwidth, stepping up takes a while.
+  EXPECT_EQ(0, RunFor(milliseconds(7500), kHighBandwidth, 0.1));
+  EXPECT_EQ(low_rung, GetCurrentRung());
+  EXPECT_EQ(1, RunFor(seconds(1), kHighBandwidth, 0.1));
+  EXPECT_EQ(low_rung - 1, GetCurrentRung());
+
+  // ...and each following step up takes just as long.
+  EXPECT_EQ(0, RunFor(milliseconds(7500), kHighBandwidth, 0.1));
+  EXPECT_EQ(1, RunFor(seconds(1), kHighBandwidth, 0.1));
+  EXPECT_EQ(low_rung - 2, GetCurrentRung());
+}
+
+TEST_F(CaptureLadderTest, StepsDownWhenEncoderIsRedlining) {
+  // With no bandwidth estimate, the encoder alone drives the ladder down, one
+  // rung at a time, with a minimum time spent on each.
+  EXPECT_EQ(0, RunFor(seconds(2), -1, 1.5));
+  EXPECT_EQ(1, RunFor(seconds(1), -1, 1.5));
+  EXPECT_EQ(1, GetCurrentRung());
+  EXPECT_EQ(0, RunFor(seconds(2), -1, 1.5));
+  EXPECT_EQ(1, RunFor(milliseconds(500), -1, 1.5));
+  EXPECT_EQ(2, GetCurrentRung());
+}
+
+TEST_F(CaptureLadderTest, DoesNotStepUpWhileEncoderIsBusy) {
+  RunFor(seconds(3), 1000 * 1000, -1);
+  const int low_rung = GetCurrentRung();
+
+  // The encoder is not redlining, but it does not have room for more pixels.
+  EXPECT_EQ(0, RunFor(seconds(30), kHighBandwidth, 0.8));
+  EXPECT_EQ(low_rung, GetCurrentRung());
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
@@ -42,6 +42,11 @@ void CompoundRtcpBuilder::IncludeReceiverReportInNextPacket(
   receiver_report_for_next_packet_ = receiver_report;
 }
 
+void CompoundRtcpBuilder::IncludeFrameStatsInNextPacket(
+    const RtcpReceiverFrameStats& frame_stats) {
+  frame_stats_for_next_packet_ = frame_stats;
+}
+
 void CompoundRtcpBuilder::IncludeFeedbackInNextPacket(
     std::vector<PacketNack> packet_nacks,
     std::vector<FrameId> frame_acks) {
@@ -96,10 +101,11 @@ absl::Span<uint8_t> CompoundRtcpBuilder::BuildPacket(
   // little to do so.
   AppendReceiverReportPacket(&buffer);
 
-  // Receiver Reference Time Report: While this is optional in the Cast
-  // Streaming spec, it is always included by this implementation to improve the
-  // stability of the end-to-end system.
-  AppendReceiverReferenceTimeReportPacket(send_time, &buffer);
+  // Extended Reports: The Receiver Reference Time Report is optional in the
+  // Cast Streaming spec, but it is always included by this implementation to
+  // improve the stability of the end-to-end system. The frame statistics block
+  // is only included if provided.
+  AppendExtendedReportsPacket(send_time, &buffer);
 
   // Picture Loss Indicator: Only included if the flag is currently set.
   if (picture_loss_indicator_) {
@@ -133,7 +139,7 @@ void CompoundRtcpBuilder::AppendReceiverReportPacket(
   }
 }
 
-void CompoundRtcpBuilder::AppendReceiverReferenceTimeReportPacket(
+void CompoundRtcpBuilder::AppendExtendedReportsPacket(
     Clock::time_point send_time,
     absl::Span<uint8_t>* buffer) {
   RtcpCommonHeader header;
@@ -141,6 +147,10 @@ void CompoundRtcpBuilder::AppendReceiverReferenceTimeReportPacket(
   header.payload_size = kRtcpExtendedReportHeaderSize +
                         kRtcpExtendedReportBlockHeaderSize +
                         kRtcpReceiverReferenceTimeReportBlockSize;
+  if (frame_stats_for_next_packet_) {
+    header.payload_size += kRtcpExtendedReportBlockHeaderSize +
+                           kRtcpReceiverFrameStatsReportBlockSize;
+  }
   header.AppendFields(buffer);
   AppendField<uint32_t>(session_->receiver_ssrc(), buffer);
   AppendField<uint8_t>(kRtcpReceiverReferenceTimeReportBlockType, buffer);
@@ -149,6 +159,14 @@ void CompoundRtcpBuilder::AppendReceiverReferenceTimeReportPacket(
       kRtcpReceiverReferenceTimeReportBlockSize / sizeof(uint32_t), buffer);
   AppendField<uint64_t>(session_->ntp_converter().ToNtpTimestamp(send_time),
                         buffer);
+  if (frame_stats_for_next_packet_) {
+    AppendField<uint8_t>(kRtcpReceiverFrameStatsReportBlockType, buffer);
+    AppendField<uint8_t>(0 /* reserved/unused byte */, buffer);
+    AppendField<uint16_t>(
+        kRtcpReceiverFrameStatsReportBlockSize / sizeof(uint32_t), buffer);
+    frame_stats_for_next_packet_->AppendFields(buffer);
+    frame_stats_for_next_packet_ = absl::nullopt;
+  }
 }
 
 void CompoundRtcpBuilder::AppendPictureLossIndicatorPacket(
@@ -72,6 +72,11 @@ class CompoundRtcpBuilder {
   void IncludeReceiverReportInNextPacket(
       const RtcpReportBlock& receiver_report);
 
+  // Include the Receiver's frame pipeline statistics, in a non-standard
+  // Extended Report block, in ONLY the next built RTCP packet. This replaces
+  // prior statistics if BuildPacket() was not called in the meantime.
+  void IncludeFrameStatsInNextPacket(const RtcpReceiverFrameStats& frame_stats);
+
   // Include detailed feedback about wholly-received frames, whole missing
   // frames, and partially-received frames (specific missing packets) in ONLY
   // the next built RTCP packet. The data will be included in a best-effort
@@ -103,15 +108,19 @@ class CompoundRtcpBuilder {
   // The required buffer size to be provided to BuildPacket(). This accounts for
   // all the possible headers and report structures that might be included,
   // along with a reasonable amount of space for the feedback's ACK/NACKs bit
-  // vectors.
-  static constexpr int kRequiredBufferSize = 256;
+  // vectors. The extra 28 bytes are for the optional frame statistics Extended
+  // Report block (see IncludeFrameStatsInNextPacket()), so that including it
+  // does not reduce the space left for the ACK/NACKs.
+  static constexpr int kRequiredBufferSize =
+      256 + kRtcpExtendedReportBlockHeaderSize +
+      kRtcpReceiverFrameStatsReportBlockSize;
 
  private:
   // Helper methods called by BuildPacket() to append one RTCP packet to the
   // |buffer| that will ultimately contain a "compound RTCP packet."
   void AppendReceiverReportPacket(absl::Span<uint8_t>* buffer);
-  void AppendReceiverReferenceTimeReportPacket(Clock::time_point send_time,
-                                               absl::Span<uint8_t>* buffer);
+  void AppendExtendedReportsPacket(Clock::time_point send_time,
+                                   absl::Span<uint8_t>* buffer);
   void AppendPictureLossIndicatorPacket(absl::Span<uint8_t>* buffer);
   void AppendCastFeedbackPacket(absl::Span<uint8_t>* buffer);
   int AppendCastFeedbackLossFields(absl::Span<uint8_t>* buffer);
@@ -123,6 +132,7 @@ class CompoundRtcpBuilder {
   FrameId checkpoint_frame_id_ = FrameId::leader();
   std::chrono::milliseconds playout_delay_ = kDefaultTargetPlayoutDelay;
   absl::optional<RtcpReportBlock> receiver_report_for_next_packet_;
+  absl::optional<RtcpReceiverFrameStats> frame_stats_for_next_packet_;
   std::vector<PacketNack> nacks_for_next_packet_;
   std::vector<FrameId> acks_for_next_packet_;
   bool picture_loss_indicator_ = false;
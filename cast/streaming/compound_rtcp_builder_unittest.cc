@@ -166,6 +166,55 @@ TEST_F(CompoundRtcpBuilderTest, WithPictureLossIndicator) {
   }
 }
 
+// Tests that the builder correctly serializes the Receiver's frame statistics
+// and includes them only in the next-built RTCP packet.
+TEST_F(CompoundRtcpBuilderTest, WithFrameStats) {
+  const FrameId checkpoint = FrameId::first() + 42;
+  builder()->SetCheckpointFrame(checkpoint);
+  const auto playout_delay = builder()->playout_delay();
+
+  RtcpReceiverFrameStats original_stats;
+  original_stats.frames_completed = 1000;
+  original_stats.frames_dropped = 3;
+  original_stats.frames_consumed_late = 7;
+  original_stats.nacks_sent = 0xfffffffe;
+  original_stats.packets_recovered = 42;
+  original_stats.p95_frame_completion_time = milliseconds(21);
+  builder()->IncludeFrameStatsInNextPacket(original_stats);
+
+  const auto send_time = Clock::now();
+  uint8_t buffer[CompoundRtcpBuilder::kRequiredBufferSize];
+  const auto packet = builder()->BuildPacket(send_time, buffer);
+  ASSERT_TRUE(packet.data());
+
+  RtcpReceiverFrameStats parsed_stats;
+  EXPECT_CALL(*(client()), OnReceiverReferenceTimeAdvanced(
+                               ViaNtpTimestampTranslation(send_time)));
+  EXPECT_CALL(*(client()), OnReceiverCheckpoint(checkpoint, playout_delay));
+  EXPECT_CALL(*(client()), OnReceiverFrameStats(_))
+      .WillOnce(SaveArg<0>(&parsed_stats));
+  ASSERT_TRUE(parser()->Parse(packet, checkpoint));
+  Mock::VerifyAndClearExpectations(client());
+  EXPECT_EQ(original_stats.frames_completed, parsed_stats.frames_completed);
+  EXPECT_EQ(original_stats.frames_dropped, parsed_stats.frames_dropped);
+  EXPECT_EQ(original_stats.frames_consumed_late,
+            parsed_stats.frames_consumed_late);
+  EXPECT_EQ(original_stats.nacks_sent, parsed_stats.nacks_sent);
+  EXPECT_EQ(original_stats.packets_recovered, parsed_stats.packets_recovered);
+  EXPECT_EQ(original_stats.p95_frame_completion_time,
+            parsed_stats.p95_frame_completion_time);
+
+  // The next packet should not include the frame stats.
+  const auto send_time2 = send_time + milliseconds(500);
+  const auto packet2 = builder()->BuildPacket(send_time2, buffer);
+  ASSERT_TRUE(packet2.data());
+  EXPECT_CALL(*(client()), OnReceiverReferenceTimeAdvanced(
+                               ViaNtpTimestampTranslation(send_time2)));
+  EXPECT_CALL(*(client()), OnReceiverCheckpoint(checkpoint, playout_delay));
+  EXPECT_CALL(*(client()), OnReceiverFrameStats(_)).Times(0);
+  ASSERT_TRUE(parser()->Parse(packet2, checkpoint));
+}
+
 // Tests that the builder produces packets with frame-level and specific-packet
 // NACKs, but includes this information only in the next-built RTCP packet.
 TEST_F(CompoundRtcpBuilderTest, WithNacks) {
@@ -310,9 +359,9 @@ TEST_F(CompoundRtcpBuilderTest, WithEverythingThatCanFit) {
 
   // Second test: Include fewer NACKs this time, so that none of the NACKs are
   // dropped, but not all of the ACKs can be included. With internal knowledge
-  // of the wire format, it turns out that limiting serialization to 48 loss
+  // of the wire format, it turns out that limiting serialization to 55 loss
   // fields will free-up just enough space for 2 bytes of ACK bit vector.
-  constexpr int kFewerNackCount = 48;
+  constexpr int kFewerNackCount = 55;
   builder()->IncludeFeedbackInNextPacket(
       std::vector<PacketNack>(nacks.begin(), nacks.begin() + kFewerNackCount),
       acks);
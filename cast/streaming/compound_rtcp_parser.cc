@@ -98,6 +98,7 @@ bool CompoundRtcpParser::Parse(absl::Span<const uint8_t> buffer,
   std::vector<FrameId> received_frames;
   std::vector<PacketNack> packet_nacks;
   bool picture_loss_indicator = false;
+  absl::optional<RtcpReceiverFrameStats> frame_stats;
 
   // The data contained in |buffer| can be a "compound packet," which means that
   // it can be the concatenation of multiple RTCP packets. The loop here
@@ -144,7 +145,8 @@ bool CompoundRtcpParser::Parse(absl::Span<const uint8_t> buffer,
         break;
 
       case RtcpPacketType::kExtendedReports:
-        if (!ParseExtendedReports(payload, &receiver_reference_time)) {
+        if (!ParseExtendedReports(payload, &receiver_reference_time,
+                                  &frame_stats)) {
           return false;
         }
         break;
@@ -193,6 +195,9 @@ bool CompoundRtcpParser::Parse(absl::Span<const uint8_t> buffer,
   if (picture_loss_indicator) {
     client_->OnReceiverIndicatesPictureLoss();
   }
+  if (frame_stats) {
+    client_->OnReceiverFrameStats(*frame_stats);
+  }
 
   return true;
 }
@@ -311,7 +316,8 @@ bool CompoundRtcpParser::ParseFeedback(
 
 bool CompoundRtcpParser::ParseExtendedReports(
     absl::Span<const uint8_t> in,
-    Clock::time_point* receiver_reference_time) {
+    Clock::time_point* receiver_reference_time,
+    absl::optional<RtcpReceiverFrameStats>* frame_stats) {
   if (static_cast<int>(in.size()) < kRtcpExtendedReportHeaderSize) {
     return false;
   }
@@ -337,6 +343,14 @@ bool CompoundRtcpParser::ParseExtendedReports(
       }
       *receiver_reference_time = session_->ntp_converter().ToLocalTime(
           ReadBigEndian<uint64_t>(in.data()));
+    } else if (block_type == kRtcpReceiverFrameStatsReportBlockType) {
+      // A block of the wrong size (perhaps from a newer version of the
+      // format) is skipped, rather than failing the whole packet.
+      absl::optional<RtcpReceiverFrameStats> stats =
+          RtcpReceiverFrameStats::Parse(in.subspan(0, block_data_size));
+      if (stats) {
+        *frame_stats = stats;
+      }
     } else {
       // Ignore any other type of extended report.
     }
@@ -374,6 +388,8 @@ void CompoundRtcpParser::Client::OnReceiverHasFrames(
     std::vector<FrameId> acks) {}
 void CompoundRtcpParser::Client::OnReceiverIsMissingPackets(
     std::vector<PacketNack> nacks) {}
+void CompoundRtcpParser::Client::OnReceiverFrameStats(
+    const RtcpReceiverFrameStats& stats) {}
 
 }  // namespace cast
 }  // namespace openscreen
@@ -70,6 +70,10 @@ class CompoundRtcpParser {
     // kAllPacketsLost indicates that all the packets are missing for a frame.
     // The argument's elements are in monotonically increasing order.
     virtual void OnReceiverIsMissingPackets(std::vector<PacketNack> nacks);
+
+    // Called when the Receiver has included its (optional, non-standard) frame
+    // pipeline statistics.
+    virtual void OnReceiverFrameStats(const RtcpReceiverFrameStats& stats);
   };
 
   // |session| and |client| must be non-null and must outlive the
@@ -101,8 +105,10 @@ class CompoundRtcpParser {
                      std::chrono::milliseconds* target_playout_delay,
                      std::vector<FrameId>* received_frames,
                      std::vector<PacketNack>* packet_nacks);
-  bool ParseExtendedReports(absl::Span<const uint8_t> in,
-                            Clock::time_point* receiver_reference_time);
+  bool ParseExtendedReports(
+      absl::Span<const uint8_t> in,
+      Clock::time_point* receiver_reference_time,
+      absl::optional<RtcpReceiverFrameStats>* frame_stats);
   bool ParsePictureLossIndicator(absl::Span<const uint8_t> in,
                                  bool* picture_loss_indicator);
 
@@ -245,6 +245,39 @@ TEST_F(CompoundRtcpParserTest, IgnoresUnknownExtendedReports) {
       parser()->Parse(kPacketWithThreeExtendedReports, FrameId::first()));
 }
 
+// Tests that a frame statistics report of the wrong size is skipped, without
+// failing the rest of the packet.
+TEST_F(CompoundRtcpParserTest, SkipsMalformedFrameStatsReports) {
+  // clang-format off
+  const uint8_t kPacketWithShortFrameStats[] = {
+      0b10000000,  // Version=2, Padding=no.
+      207,  // RTCP Packet type byte.
+      0x00, 0x07,  // Length of remainder of packet, in 32-bit words.
+      0x00, 0x00, 0x00, 0x02,  // Receiver SSRC.
+
+      // Frame statistics report, with too few words:
+      200,  // Block type = Receiver frame stats.
+      0x00,  // Reserved byte.
+      0x00, 0x02,  // Block length = 2 words.
+      0x00, 0x00, 0x00, 0x10,
+      0x00, 0x00, 0x00, 0x01,
+
+      // Receiver Reference Time Report:
+      0x04,  // Block type = RRTR
+      0x00,  // Reserved byte.
+      0x00, 0x02,  // Block length = 2 words.
+      0xe0, 0x73, 0x2e, 0x55,  // NTP Timestamp (late evening on 2019-04-30).
+          0x00, 0x00, 0x00, 0x00,
+  };
+  // clang-format on
+
+  const auto expected_timestamp =
+      session()->ntp_converter().ToLocalTime(NtpTimestamp{0xe0732e5500000000});
+  EXPECT_CALL(*(client()), OnReceiverReferenceTimeAdvanced(expected_timestamp));
+  EXPECT_CALL(*(client()), OnReceiverFrameStats(_)).Times(0);
+  EXPECT_TRUE(parser()->Parse(kPacketWithShortFrameStats, FrameId::first()));
+}
+
 // Tests that a simple Cast Feedback packet is parsed, and the checkpoint frame
 // ID is properly bit-extended, based on the current state of the Sender.
 TEST_F(CompoundRtcpParserTest, ParsesSimpleFeedback) {
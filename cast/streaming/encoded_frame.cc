@@ -4,14 +4,37 @@
 
 #include "cast/streaming/encoded_frame.h"
 
+#include <utility>
+
 namespace openscreen {
 namespace cast {
 
 EncodedFrame::EncodedFrame() = default;
-EncodedFrame::~EncodedFrame() = default;
 
-EncodedFrame::EncodedFrame(EncodedFrame&&) noexcept = default;
-EncodedFrame& EncodedFrame::operator=(EncodedFrame&&) = default;
+EncodedFrame::~EncodedFrame() {
+  if (release_callback) {
+    release_callback();
+  }
+}
+
+EncodedFrame::EncodedFrame(EncodedFrame&& other) noexcept {
+  *this = std::move(other);
+}
+
+EncodedFrame& EncodedFrame::operator=(EncodedFrame&& other) {
+  if (this != &other) {
+    if (release_callback) {
+      release_callback();
+    }
+    other.CopyMetadataTo(this);
+    data = other.data;
+    data_fragments = std::move(other.data_fragments);
+    other.data_fragments.clear();
+    release_callback = std::move(other.release_callback);
+    other.release_callback = nullptr;
+  }
+  return *this;
+}
 
 void EncodedFrame::CopyMetadataTo(EncodedFrame* dest) const {
   dest->dependency = this->dependency;
@@ -22,5 +45,16 @@ void EncodedFrame::CopyMetadataTo(EncodedFrame* dest) const {
   dest->new_playout_delay = this->new_playout_delay;
 }
 
+size_t EncodedFrame::GetPayloadSize() const {
+  if (data_fragments.empty()) {
+    return data.size();
+  }
+  size_t size = 0;
+  for (const absl::Span<const uint8_t>& fragment : data_fragments) {
+    size += fragment.size();
+  }
+  return size;
+}
+
 }  // namespace cast
 }  // namespace openscreen
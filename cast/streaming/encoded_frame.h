@@ -8,6 +8,7 @@
 #include <stdint.h>
 
 #include <chrono>
+#include <functional>
 #include <vector>
 
 #include "absl/types/span.h"
@@ -44,9 +45,14 @@ struct EncodedFrame {
   EncodedFrame(EncodedFrame&&) noexcept;
   EncodedFrame& operator=(EncodedFrame&&);
 
-  // Copies all members except |data| to |dest|. Does not modify |dest->data|.
+  // Copies all members except |data|, |data_fragments| and |release_callback|
+  // to |dest|. Does not modify those members of |dest|.
   void CopyMetadataTo(EncodedFrame* dest) const;
 
+  // Returns the total number of bytes of encoded signal data, whether it is
+  // referenced by |data| or |data_fragments|.
+  size_t GetPayloadSize() const;
+
   // This frame's dependency relationship with respect to other frames.
   Dependency dependency = UNKNOWN_DEPENDENCY;
 
@@ -90,6 +96,18 @@ struct EncodedFrame {
   // client-provided buffer that was populated.
   absl::Span<uint8_t> data;
 
+  // In the sender context only, an alternative to |data|: The encoded signal
+  // data as an ordered list of fragments, to be read as if they were
+  // concatenated. This allows encoders that produce their output in several
+  // internal buffers to avoid copying it all into one. When this is non-empty,
+  // |data| must be empty.
+  std::vector<absl::Span<const uint8_t>> data_fragments;
+
+  // Optional: Run when this EncodedFrame is destroyed (or assigned-over), to
+  // tell the producer that the memory referenced by |data| or |data_fragments|
+  // may be re-used. Moving the frame transfers the callback.
+  std::function<void()> release_callback;
+
   OSP_DISALLOW_COPY_AND_ASSIGN(EncodedFrame);
 };
 
@@ -0,0 +1,82 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/encoded_frame.h"
+
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+TEST(EncodedFrameTest, RunsReleaseCallbackOnceWhenDestroyed) {
+  int release_count = 0;
+  {
+    EncodedFrame frame;
+    frame.release_callback = [&release_count] { ++release_count; };
+    EncodedFrame moved_frame(std::move(frame));
+    EXPECT_EQ(0, release_count);
+
+    EncodedFrame assigned_frame;
+    assigned_frame.release_callback = [&release_count] { ++release_count; };
+    assigned_frame = std::move(moved_frame);
+    // The callback previously held by |assigned_frame| is run, since its
+    // payload has been replaced.
+    EXPECT_EQ(1, release_count);
+  }
+  EXPECT_EQ(2, release_count);
+}
+
+TEST(EncodedFrameTest, MoveAssignmentReleasesTheReplacedPayload) {
+  int old_release_count = 0;
+  int new_release_count = 0;
+
+  EncodedFrame frame;
+  frame.release_callback = [&old_release_count] { ++old_release_count; };
+  {
+    EncodedFrame other;
+    other.release_callback = [&new_release_count] { ++new_release_count; };
+    frame = std::move(other);
+    EXPECT_EQ(1, old_release_count);
+    EXPECT_EQ(0, new_release_count);
+  }
+  // |other| gave up its callback, so destroying it did not run it.
+  EXPECT_EQ(0, new_release_count);
+
+  // Assigning a frame that has no callback still releases the current one.
+  frame = EncodedFrame();
+  EXPECT_EQ(1, old_release_count);
+  EXPECT_EQ(1, new_release_count);
+  EXPECT_FALSE(frame.release_callback);
+}
+
+TEST(EncodedFrameTest, MoveTransfersPayloadAndMetadata) {
+  std::vector<uint8_t> buffer0 = {1, 2, 3};
+  std::vector<uint8_t> buffer1 = {4, 5};
+
+  EncodedFrame frame;
+  frame.dependency = EncodedFrame::KEY_FRAME;
+  frame.frame_id = FrameId::first() + 7;
+  frame.referenced_frame_id = frame.frame_id;
+  frame.data_fragments.emplace_back(buffer0);
+  frame.data_fragments.emplace_back(buffer1);
+  EXPECT_EQ(5u, frame.GetPayloadSize());
+
+  const EncodedFrame moved_frame(std::move(frame));
+  EXPECT_EQ(EncodedFrame::KEY_FRAME, moved_frame.dependency);
+  EXPECT_EQ(FrameId::first() + 7, moved_frame.frame_id);
+  ASSERT_EQ(2u, moved_frame.data_fragments.size());
+  EXPECT_EQ(buffer0.data(), moved_frame.data_fragments[0].data());
+  EXPECT_EQ(buffer1.data(), moved_frame.data_fragments[1].data());
+  EXPECT_EQ(5u, moved_frame.GetPayloadSize());
+  EXPECT_TRUE(frame.data_fragments.empty());
+  EXPECT_EQ(0u, frame.GetPayloadSize());
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
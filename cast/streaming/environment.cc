@@ -73,6 +73,9 @@ int Environment::GetMaxPacketSize() const {
 void Environment::SendPacket(absl::Span<const uint8_t> packet) {
   OSP_DCHECK(remote_endpoint_.address);
   OSP_DCHECK_NE(remote_endpoint_.port, 0);
+  if (packet_observer_) {
+    packet_observer_->OnPacketSent(now_function_(), packet);
+  }
   if (socket_) {
     socket_->SendMessage(packet.data(), packet.size(), remote_endpoint_);
   }
@@ -80,6 +83,10 @@ void Environment::SendPacket(absl::Span<const uint8_t> packet) {
 
 Environment::PacketConsumer::~PacketConsumer() = default;
 
+void Environment::PacketObserver::OnReceiverCreated(const SessionConfig&) {}
+
+Environment::PacketObserver::~PacketObserver() = default;
+
 void Environment::OnBound(UdpSocket* socket) {
   OSP_DCHECK(socket == socket_.get());
   state_ = SocketState::kReady;
@@ -133,9 +140,20 @@ void Environment::OnRead(UdpSocket* socket,
   const Clock::time_point arrival_time = now_function_();
 
   UdpPacket packet = std::move(packet_or_error.value());
-  packet_consumer_->OnReceivedPacket(
-      packet.source(), arrival_time,
-      std::move(static_cast<std::vector<uint8_t>&>(packet)));
+  DeliverReceivedPacket(packet.source(), arrival_time,
+                        std::move(static_cast<std::vector<uint8_t>&>(packet)));
+}
+
+void Environment::DeliverReceivedPacket(const IPEndpoint& source,
+                                        Clock::time_point arrival_time,
+                                        std::vector<uint8_t> packet) {
+  if (!packet_consumer_) {
+    return;
+  }
+  if (packet_observer_) {
+    packet_observer_->OnPacketReceived(arrival_time, packet);
+  }
+  packet_consumer_->OnReceivedPacket(source, arrival_time, std::move(packet));
 }
 
 }  // namespace cast
@@ -12,6 +12,7 @@
 #include <vector>
 
 #include "absl/types/span.h"
+#include "cast/streaming/session_config.h"
 #include "platform/api/time.h"
 #include "platform/api/udp_socket.h"
 #include "platform/base/ip_address.h"
@@ -33,6 +34,30 @@ class Environment : public UdpSocket::Client {
     virtual ~PacketConsumer();
   };
 
+  // Observes all packets sent and received through the environment, e.g., to
+  // capture a session for offline analysis (see PacketCaptureWriter). Observers
+  // are called synchronously, so they should be cheap.
+  class PacketObserver {
+   public:
+    // Called just before a |packet| is sent to the remote endpoint.
+    virtual void OnPacketSent(Clock::time_point send_time,
+                              absl::Span<const uint8_t> packet) = 0;
+
+    // Called just before a received |packet| is delivered to the
+    // PacketConsumer. Packets that arrive while incoming packets are being
+    // dropped are not observed.
+    virtual void OnPacketReceived(Clock::time_point arrival_time,
+                                  absl::Span<const uint8_t> packet) = 0;
+
+    // Called when a Receiver is attached to the environment, so that the
+    // observer knows how to interpret its packets. The default implementation
+    // does nothing.
+    virtual void OnReceiverCreated(const SessionConfig& config);
+
+   protected:
+    virtual ~PacketObserver();
+  };
+
   // Consumers of the environment's UDP socket should be careful to check the
   // socket's state before accessing its methods, especially
   // GetBoundLocalEndpoint(). If the environment is |kStarting|, the
@@ -101,6 +126,12 @@ class Environment : public UdpSocket::Client {
   // nullptr.
   void SetSocketSubscriber(SocketSubscriber* subscriber);
 
+  // Get/Set the PacketObserver. Callers can stop observing by passing nullptr.
+  PacketObserver* packet_observer() const { return packet_observer_; }
+  void SetPacketObserver(PacketObserver* observer) {
+    packet_observer_ = observer;
+  }
+
   // Start/Resume delivery of incoming packets to the given |packet_consumer|.
   // Delivery will continue until DropIncomingPackets() is called.
   void ConsumeIncomingPackets(PacketConsumer* packet_consumer);
@@ -124,6 +155,13 @@ class Environment : public UdpSocket::Client {
  protected:
   Environment() : now_function_(nullptr), task_runner_(nullptr) {}
 
+  // Delivers a received |packet| to the PacketConsumer, if any. This is called
+  // for each packet read from the socket, and may also be called by subclasses
+  // that do not use a socket (e.g., to emulate a network).
+  void DeliverReceivedPacket(const IPEndpoint& source,
+                             Clock::time_point arrival_time,
+                             std::vector<uint8_t> packet);
+
   // Protected so that they can be set by the MockEnvironment for testing.
   ClockNowFunctionPtr now_function_;
   TaskRunner* task_runner_;
@@ -146,6 +184,7 @@ class Environment : public UdpSocket::Client {
   PacketConsumer* packet_consumer_ = nullptr;
   SocketState state_ = SocketState::kStarting;
   SocketSubscriber* socket_subscriber_ = nullptr;
+  PacketObserver* packet_observer_ = nullptr;
 };
 
 }  // namespace cast
@@ -39,6 +39,10 @@ class FrameCollector {
   // assembled.
   bool is_complete() const { return num_missing_packets_ == 0; }
 
+  // Returns the number of packets not yet collected, or the maximum int if the
+  // total number of packets in the frame is not yet known.
+  int num_missing_packets() const { return num_missing_packets_; }
+
   // Appends zero or more elements to |nacks| representing which packets are not
   // yet collected. If all packets for the frame are missing, this appends a
   // single element containing the special kAllPacketsLost packet ID. Otherwise,
@@ -62,9 +62,16 @@ FrameCrypto::~FrameCrypto() = default;
 EncryptedFrame FrameCrypto::Encrypt(const EncodedFrame& encoded_frame) const {
   EncryptedFrame result;
   encoded_frame.CopyMetadataTo(&result);
-  result.owned_data_.resize(encoded_frame.data.size());
+  result.owned_data_.resize(GetEncryptedSize(encoded_frame));
   result.data = absl::Span<uint8_t>(result.owned_data_);
-  EncryptCommon(encoded_frame.frame_id, encoded_frame.data, result.data);
+  if (encoded_frame.data_fragments.empty()) {
+    const absl::Span<const uint8_t> in[] = {encoded_frame.data};
+    EncryptCommon(encoded_frame.frame_id, in, result.data);
+  } else {
+    OSP_DCHECK(encoded_frame.data.empty());
+    EncryptCommon(encoded_frame.frame_id, encoded_frame.data_fragments,
+                  result.data);
+  }
   return result;
 }
 
@@ -77,15 +84,15 @@ void FrameCrypto::Decrypt(const EncryptedFrame& encrypted_frame,
     encoded_frame->data = absl::Span<uint8_t>(encoded_frame->data.data(),
                                               encrypted_frame.data.size());
   }
-  EncryptCommon(encrypted_frame.frame_id, encrypted_frame.data,
-                encoded_frame->data);
+  const absl::Span<const uint8_t> in[] = {encrypted_frame.data};
+  EncryptCommon(encrypted_frame.frame_id, in, encoded_frame->data);
 }
 
-void FrameCrypto::EncryptCommon(FrameId frame_id,
-                                absl::Span<const uint8_t> in,
-                                absl::Span<uint8_t> out) const {
+void FrameCrypto::EncryptCommon(
+    FrameId frame_id,
+    absl::Span<const absl::Span<const uint8_t>> in_fragments,
+    absl::Span<uint8_t> out) const {
   OSP_DCHECK(!frame_id.is_null());
-  OSP_DCHECK_EQ(in.size(), out.size());
 
   // Compute the AES nonce for Cast Streaming payload encryption, which is based
   // on the |frame_id|.
@@ -99,8 +106,15 @@ void FrameCrypto::EncryptCommon(FrameId frame_id,
 
   std::array<uint8_t, 16> ecount_buf{/* zero initialized */};
   unsigned int block_offset = 0;
-  AES_ctr128_encrypt(in.data(), out.data(), in.size(), &aes_key_,
-                     aes_nonce.data(), ecount_buf.data(), &block_offset);
+  // AES-CTR is a stream cipher: Each call picks up the keystream where the
+  // prior one left off, so the fragments need not be concatenated first.
+  for (const absl::Span<const uint8_t>& in : in_fragments) {
+    OSP_DCHECK_LE(in.size(), out.size());
+    AES_ctr128_encrypt(in.data(), out.data(), in.size(), &aes_key_,
+                       aes_nonce.data(), ecount_buf.data(), &block_offset);
+    out.remove_prefix(in.size());
+  }
+  OSP_DCHECK(out.empty());
 }
 
 }  // namespace cast
@@ -55,6 +55,9 @@ class FrameCrypto {
 
   ~FrameCrypto();
 
+  // Encrypts the payload of |encoded_frame|, reading it either from its |data|
+  // or across all of its |data_fragments|, into a new EncryptedFrame that owns
+  // its buffer.
   EncryptedFrame Encrypt(const EncodedFrame& encoded_frame) const;
 
   // Decrypt the given |encrypted_frame| into the output |encoded_frame|. The
@@ -66,7 +69,7 @@ class FrameCrypto {
   // AES crypto inputs and outputs (for either encrypting or decrypting) are
   // always the same size in bytes. The following are just "documentative code."
   static int GetEncryptedSize(const EncodedFrame& encoded_frame) {
-    return encoded_frame.data.size();
+    return encoded_frame.GetPayloadSize();
   }
   static int GetPlaintextSize(const EncryptedFrame& encrypted_frame) {
     return encrypted_frame.data.size();
@@ -82,9 +85,10 @@ class FrameCrypto {
   const std::array<uint8_t, 16> cast_iv_mask_;
 
   // AES-CTR is symmetric. Thus, the "meat" of both Encrypt() and Decrypt() is
-  // the same.
+  // the same. The |in_fragments| are read as if they were concatenated, and
+  // their total size must equal the size of |out|.
   void EncryptCommon(FrameId frame_id,
-                     absl::Span<const uint8_t> in,
+                     absl::Span<const absl::Span<const uint8_t>> in_fragments,
                      absl::Span<uint8_t> out) const;
 };
 
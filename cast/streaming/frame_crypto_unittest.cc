@@ -76,6 +76,43 @@ TEST(FrameCryptoTest, EncryptsAndDecryptsFrames) {
                       frame1.data.size()));
 }
 
+TEST(FrameCryptoTest, EncryptsFragmentedPayloadsSameAsContiguous) {
+  // Fill a payload spanning several AES blocks, and split it into fragments of
+  // odd sizes (including an empty one), so that fragment boundaries fall both
+  // within and on AES block boundaries.
+  std::vector<uint8_t> buffer(100);
+  for (size_t i = 0; i < buffer.size(); ++i) {
+    buffer[i] = static_cast<uint8_t>(i * 7);
+  }
+  EncodedFrame contiguous_frame;
+  contiguous_frame.frame_id = FrameId::first() + 42;
+  contiguous_frame.data = absl::Span<uint8_t>(buffer);
+
+  EncodedFrame fragmented_frame;
+  contiguous_frame.CopyMetadataTo(&fragmented_frame);
+  const absl::Span<const uint8_t> whole(buffer);
+  fragmented_frame.data_fragments = {whole.subspan(0, 5),
+                                     whole.subspan(5, 11),
+                                     whole.subspan(16, 0),
+                                     whole.subspan(16, 33),
+                                     whole.subspan(49, 51)};
+  EXPECT_EQ(buffer.size(), fragmented_frame.GetPayloadSize());
+
+  const FrameCrypto crypto(GenerateRandomBytes16(), GenerateRandomBytes16());
+  const EncryptedFrame expected = crypto.Encrypt(contiguous_frame);
+  const EncryptedFrame actual = crypto.Encrypt(fragmented_frame);
+  EXPECT_EQ(contiguous_frame.frame_id, actual.frame_id);
+  ASSERT_EQ(expected.data.size(), actual.data.size());
+  EXPECT_EQ(0, memcmp(expected.data.data(), actual.data.data(),
+                      expected.data.size()));
+
+  EncodedFrame decrypted_frame;
+  std::vector<uint8_t> decrypted_buffer(FrameCrypto::GetPlaintextSize(actual));
+  decrypted_frame.data = absl::Span<uint8_t>(decrypted_buffer);
+  crypto.Decrypt(actual, &decrypted_frame);
+  EXPECT_EQ(buffer, decrypted_buffer);
+}
+
 }  // namespace
 }  // namespace cast
 }  // namespace openscreen
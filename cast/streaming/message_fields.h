@@ -21,6 +21,12 @@ namespace cast {
 constexpr char kCastWebrtcNamespace[] = "urn:x-cast:com.google.cast.webrtc";
 constexpr char kCastRemotingNamespace[] = "urn:x-cast:com.google.cast.remoting";
 
+// Namespace for batches of RPC messages sent as binary payloads, as an
+// alternative to base64-encoded RPC messages on |kCastRemotingNamespace|. Only
+// used once both sides have advertised support for it.
+constexpr char kCastRemotingBinaryNamespace[] =
+    "urn:x-cast:com.google.cast.remoting.binary";
+
 // JSON message field values specific to the Sender Session.
 constexpr char kMessageType[] = "type";
 
@@ -39,6 +45,13 @@ constexpr char kErrorMessageBody[] = "error";
 constexpr char kErrorCode[] = "code";
 constexpr char kErrorDescription[] = "description";
 
+// RESUME and RESUME_RESPONSE message fields. These are not part of the
+// specification: a RESUME restarts the last negotiated streams with fresh
+// crypto parameters, and carries an OFFER body listing only those streams.
+constexpr char kMessageTypeResume[] = "RESUME";
+constexpr char kResumeMessageBody[] = "resume";
+constexpr char kMessageTypeResumeResponse[] = "RESUME_RESPONSE";
+
 // Other message fields.
 constexpr char kRpcMessageBody[] = "rpc";
 constexpr char kCapabilitiesMessageBody[] = "capabilities";
@@ -21,6 +21,8 @@ class MockCompoundRtcpParserClient : public CompoundRtcpParser::Client {
                void(FrameId frame_id, std::chrono::milliseconds playout_delay));
   MOCK_METHOD1(OnReceiverHasFrames, void(std::vector<FrameId> acks));
   MOCK_METHOD1(OnReceiverIsMissingPackets, void(std::vector<PacketNack> nacks));
+  MOCK_METHOD1(OnReceiverFrameStats,
+               void(const RtcpReceiverFrameStats& stats));
 };
 
 }  // namespace cast
@@ -0,0 +1,198 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/network_history_cache.h"
+
+#include <errno.h>
+#include <stdio.h>
+#include <string.h>
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include "util/chrono_helpers.h"
+#include "util/json/json_helpers.h"
+#include "util/json/json_serialization.h"
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+namespace {
+
+constexpr char kReceivers[] = "receivers";
+constexpr char kBandwidth[] = "bandwidth";
+constexpr char kRoundTripTime[] = "rttMicros";
+constexpr char kPacketLoss[] = "packetLoss";
+constexpr char kLastUpdated[] = "lastUpdated";
+
+}  // namespace
+
+NetworkHistoryCache::NetworkHistoryCache(std::chrono::seconds max_age)
+    : max_age_(max_age) {
+  OSP_DCHECK_GT(max_age_, std::chrono::seconds::zero());
+}
+
+NetworkHistoryCache::NetworkHistoryCache(NetworkHistoryCache&&) noexcept =
+    default;
+NetworkHistoryCache& NetworkHistoryCache::operator=(
+    NetworkHistoryCache&&) noexcept = default;
+NetworkHistoryCache::~NetworkHistoryCache() = default;
+
+absl::optional<NetworkConditions> NetworkHistoryCache::Lookup(
+    const std::string& receiver_id,
+    std::chrono::seconds now) const {
+  const auto it = entries_.find(receiver_id);
+  if (it == entries_.end() || now - it->second.last_updated > max_age_) {
+    return absl::nullopt;
+  }
+  return it->second.conditions;
+}
+
+void NetworkHistoryCache::Update(const std::string& receiver_id,
+                                 const NetworkConditions& conditions,
+                                 std::chrono::seconds now) {
+  OSP_DCHECK(!receiver_id.empty());
+  OSP_DCHECK_GT(conditions.bandwidth, 0);
+  entries_[receiver_id] = Entry{conditions, now};
+  Prune(now);
+}
+
+Json::Value NetworkHistoryCache::ToJson() const {
+  Json::Value receivers(Json::objectValue);
+  for (const auto& entry : entries_) {
+    Json::Value& value = receivers[entry.first];
+    value[kBandwidth] = entry.second.conditions.bandwidth;
+    value[kRoundTripTime] = static_cast<Json::Int64>(
+        to_microseconds(entry.second.conditions.round_trip_time).count());
+    value[kPacketLoss] = entry.second.conditions.packet_loss_fraction;
+    value[kLastUpdated] =
+        static_cast<Json::Int64>(entry.second.last_updated.count());
+  }
+  Json::Value root;
+  root[kReceivers] = std::move(receivers);
+  return root;
+}
+
+Error NetworkHistoryCache::LoadFromJson(const Json::Value& root,
+                                        std::chrono::seconds now) {
+  if (!root.isObject() || !root[kReceivers].isObject()) {
+    return json::CreateParseError("network history");
+  }
+
+  entries_.clear();
+  const Json::Value& receivers = root[kReceivers];
+  for (const std::string& receiver_id : receivers.getMemberNames()) {
+    const Json::Value& value = receivers[receiver_id];
+    Entry entry;
+    // The bandwidth must be positive, the round trip time must not be
+    // negative, and the packet loss fraction must be in the range [0.0,1.0]
+    // (ParseAndValidateDouble() rejects negative values).
+    if (receiver_id.empty() || !value.isObject() ||
+        !json::ParseAndValidateInt(value[kBandwidth],
+                                   &entry.conditions.bandwidth) ||
+        entry.conditions.bandwidth <= 0 || !value[kRoundTripTime].isInt64() ||
+        value[kRoundTripTime].asInt64() < 0 ||
+        !json::ParseAndValidateDouble(value[kPacketLoss],
+                                      &entry.conditions.packet_loss_fraction) ||
+        entry.conditions.packet_loss_fraction > 1.0 ||
+        !value[kLastUpdated].isInt64()) {
+      OSP_LOG_WARN << "Skipping malformed network history entry for "
+                   << receiver_id;
+      continue;
+    }
+    entry.last_updated = std::chrono::seconds(value[kLastUpdated].asInt64());
+    // This also keeps |now - last_updated| from overflowing.
+    if (entry.last_updated < std::chrono::seconds::zero() ||
+        entry.last_updated > now) {
+      OSP_LOG_WARN << "Skipping network history entry for " << receiver_id
+                   << " with a timestamp out of range";
+      continue;
+    }
+    entry.conditions.round_trip_time =
+        Clock::to_duration(microseconds(value[kRoundTripTime].asInt64()));
+    entries_.emplace(receiver_id, entry);
+  }
+  Prune(now);
+  return Error::None();
+}
+
+Error NetworkHistoryCache::LoadFromFile(const char* path,
+                                        std::chrono::seconds now) {
+  entries_.clear();
+  FILE* const file = fopen(path, "rb");
+  if (!file) {
+    if (errno == ENOENT) {
+      return Error::None();
+    }
+    return Error(Error::Code::kFileLoadFailure,
+                 std::string("Unable to open ") + path + ": " +
+                     strerror(errno));
+  }
+  std::string contents;
+  char chunk[4096];
+  size_t bytes_read;
+  while ((bytes_read = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+    contents.append(chunk, bytes_read);
+  }
+  const bool had_error = ferror(file);
+  fclose(file);
+  if (had_error) {
+    return Error(Error::Code::kIOFailure,
+                 std::string("Unable to read ") + path);
+  }
+
+  ErrorOr<Json::Value> root = json::Parse(contents);
+  if (root.is_error()) {
+    return std::move(root.error());
+  }
+  return LoadFromJson(root.value(), now);
+}
+
+Error NetworkHistoryCache::SaveToFile(const char* path) const {
+  const ErrorOr<std::string> contents = json::Stringify(ToJson());
+  if (contents.is_error()) {
+    return contents.error();
+  }
+  FILE* const file = fopen(path, "wb");
+  if (!file) {
+    return Error(Error::Code::kFileLoadFailure,
+                 std::string("Unable to create ") + path + ": " +
+                     strerror(errno));
+  }
+  const bool wrote_all =
+      fwrite(contents.value().data(), 1, contents.value().size(), file) ==
+      contents.value().size();
+  if (fclose(file) != 0 || !wrote_all) {
+    return Error(Error::Code::kIOFailure,
+                 std::string("Unable to write to ") + path);
+  }
+  return Error::None();
+}
+
+void NetworkHistoryCache::Prune(std::chrono::seconds now) {
+  for (auto it = entries_.begin(); it != entries_.end();) {
+    if (now - it->second.last_updated > max_age_) {
+      it = entries_.erase(it);
+    } else {
+      ++it;
+    }
+  }
+
+  while (static_cast<int>(entries_.size()) > kMaxEntries) {
+    const auto oldest = std::min_element(
+        entries_.begin(), entries_.end(), [](const auto& a, const auto& b) {
+          return a.second.last_updated < b.second.last_updated;
+        });
+    entries_.erase(oldest);
+  }
+}
+
+// static
+constexpr std::chrono::seconds NetworkHistoryCache::kDefaultMaxAge;
+constexpr int NetworkHistoryCache::kMaxEntries;
+
+}  // namespace cast
+}  // namespace openscreen
@@ -0,0 +1,95 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STREAMING_NETWORK_HISTORY_CACHE_H_
+#define CAST_STREAMING_NETWORK_HISTORY_CACHE_H_
+
+#include <chrono>
+#include <map>
+#include <string>
+
+#include "absl/types/optional.h"
+#include "json/value.h"
+#include "platform/api/time.h"
+#include "platform/base/error.h"
+
+namespace openscreen {
+namespace cast {
+
+// The network conditions between a Sender and a Receiver, as measured near the
+// end of a session.
+struct NetworkConditions {
+  // The network bandwidth estimate, in bits per second.
+  int bandwidth = 0;
+
+  // The smoothed round trip time.
+  Clock::duration round_trip_time{};
+
+  // The fraction of packets lost, in the range [0.0,1.0].
+  double packet_loss_fraction = 0.0;
+};
+
+// Remembers the NetworkConditions of recent sessions, keyed by the Receiver's
+// unique ID (see ServiceInfo::unique_id), so that a new session with the same
+// Receiver can start from the last-known bandwidth instead of a conservative
+// guess. Entries expire after |max_age|, since networks change; and only the
+// most-recently-updated kMaxEntries are kept.
+//
+// The cache is persisted as a small JSON file. Entries are timestamped with the
+// wall clock (seconds since the UNIX epoch), since Clock::time_point values are
+// not meaningful across processes.
+class NetworkHistoryCache {
+ public:
+  static constexpr std::chrono::seconds kDefaultMaxAge = std::chrono::hours(24);
+  static constexpr int kMaxEntries = 32;
+
+  explicit NetworkHistoryCache(std::chrono::seconds max_age = kDefaultMaxAge);
+  NetworkHistoryCache(NetworkHistoryCache&&) noexcept;
+  NetworkHistoryCache& operator=(NetworkHistoryCache&&) noexcept;
+  ~NetworkHistoryCache();
+
+  // Returns the conditions last recorded for |receiver_id|, or nullopt if there
+  // are none, or they have expired as of |now|.
+  absl::optional<NetworkConditions> Lookup(const std::string& receiver_id,
+                                           std::chrono::seconds now) const;
+
+  // Records the |conditions| for |receiver_id| as of |now|, replacing any
+  // previous entry.
+  void Update(const std::string& receiver_id,
+              const NetworkConditions& conditions,
+              std::chrono::seconds now);
+
+  bool empty() const { return entries_.empty(); }
+
+  Json::Value ToJson() const;
+
+  // Replaces the contents of this cache with those in |root|, a value produced
+  // by ToJson(), and then prunes it as of |now|. Malformed entries are skipped,
+  // as are those last updated before the UNIX epoch or after |now|, since the
+  // wall clock may have been changed meanwhile.
+  Error LoadFromJson(const Json::Value& root, std::chrono::seconds now);
+
+  // Loads or saves the cache from/to the file at |path|. LoadFromFile() leaves
+  // the cache empty if the file does not exist.
+  Error LoadFromFile(const char* path, std::chrono::seconds now);
+  Error SaveToFile(const char* path) const;
+
+ private:
+  struct Entry {
+    NetworkConditions conditions;
+    std::chrono::seconds last_updated;
+  };
+
+  // Removes entries that have expired as of |now|, and then the least-recently
+  // updated ones, if there are more than kMaxEntries.
+  void Prune(std::chrono::seconds now);
+
+  std::chrono::seconds max_age_;
+  std::map<std::string, Entry> entries_;
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STREAMING_NETWORK_HISTORY_CACHE_H_
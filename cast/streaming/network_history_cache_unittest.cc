@@ -0,0 +1,196 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/network_history_cache.h"
+
+#include <stdio.h>
+
+#include <limits>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "util/chrono_helpers.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+constexpr seconds kNow{1600000000};
+
+NetworkConditions MakeConditions(int bandwidth) {
+  NetworkConditions conditions;
+  conditions.bandwidth = bandwidth;
+  conditions.round_trip_time = milliseconds(12);
+  conditions.packet_loss_fraction = 0.125;
+  return conditions;
+}
+
+void ExpectSameConditions(const NetworkConditions& expected,
+                          const NetworkConditions& actual) {
+  EXPECT_EQ(expected.bandwidth, actual.bandwidth);
+  EXPECT_EQ(expected.round_trip_time, actual.round_trip_time);
+  EXPECT_EQ(expected.packet_loss_fraction, actual.packet_loss_fraction);
+}
+
+TEST(NetworkHistoryCacheTest, LooksUpConditionsByReceiver) {
+  NetworkHistoryCache cache;
+  EXPECT_FALSE(cache.Lookup("receiver-1", kNow));
+
+  cache.Update("receiver-1", MakeConditions(1000000), kNow);
+  cache.Update("receiver-2", MakeConditions(2000000), kNow);
+  cache.Update("receiver-1", MakeConditions(3000000), kNow + seconds(1));
+
+  ASSERT_TRUE(cache.Lookup("receiver-1", kNow + seconds(2)));
+  ExpectSameConditions(MakeConditions(3000000),
+                       cache.Lookup("receiver-1", kNow + seconds(2)).value());
+  ASSERT_TRUE(cache.Lookup("receiver-2", kNow + seconds(2)));
+  EXPECT_EQ(2000000,
+            cache.Lookup("receiver-2", kNow + seconds(2)).value().bandwidth);
+  EXPECT_FALSE(cache.Lookup("receiver-3", kNow + seconds(2)));
+}
+
+TEST(NetworkHistoryCacheTest, ExpiresOldEntries) {
+  NetworkHistoryCache cache(hours(1));
+  cache.Update("receiver-1", MakeConditions(1000000), kNow);
+  EXPECT_TRUE(cache.Lookup("receiver-1", kNow + hours(1)));
+  EXPECT_FALSE(cache.Lookup("receiver-1", kNow + hours(1) + seconds(1)));
+
+  // Expired entries are dropped when the cache is next updated.
+  cache.Update("receiver-2", MakeConditions(1000000), kNow + hours(2));
+  EXPECT_EQ(1u, cache.ToJson()["receivers"].size());
+}
+
+TEST(NetworkHistoryCacheTest, KeepsOnlyTheMostRecentEntries) {
+  NetworkHistoryCache cache;
+  for (int i = 0; i <= NetworkHistoryCache::kMaxEntries; ++i) {
+    cache.Update("receiver-" + std::to_string(i), MakeConditions(1000000),
+                 kNow + seconds(i));
+  }
+  const seconds later = kNow + seconds(NetworkHistoryCache::kMaxEntries);
+  EXPECT_FALSE(cache.Lookup("receiver-0", later));
+  EXPECT_TRUE(cache.Lookup("receiver-1", later));
+  EXPECT_TRUE(cache.Lookup(
+      "receiver-" + std::to_string(NetworkHistoryCache::kMaxEntries), later));
+}
+
+TEST(NetworkHistoryCacheTest, RoundTripsThroughJson) {
+  NetworkHistoryCache cache;
+  cache.Update("receiver-1", MakeConditions(1000000), kNow);
+  cache.Update("receiver-2", MakeConditions(2000000), kNow);
+
+  NetworkHistoryCache loaded;
+  ASSERT_TRUE(loaded.LoadFromJson(cache.ToJson(), kNow).ok());
+  ASSERT_TRUE(loaded.Lookup("receiver-1", kNow));
+  ExpectSameConditions(MakeConditions(1000000),
+                       loaded.Lookup("receiver-1", kNow).value());
+  ASSERT_TRUE(loaded.Lookup("receiver-2", kNow));
+  ExpectSameConditions(MakeConditions(2000000),
+                       loaded.Lookup("receiver-2", kNow).value());
+}
+
+TEST(NetworkHistoryCacheTest, SkipsMalformedEntries) {
+  NetworkHistoryCache cache;
+  cache.Update("receiver-1", MakeConditions(1000000), kNow);
+  cache.Update("receiver-2", MakeConditions(2000000), kNow);
+  Json::Value root = cache.ToJson();
+  root["receivers"]["receiver-2"]["bandwidth"] = "lots";
+
+  NetworkHistoryCache loaded;
+  ASSERT_TRUE(loaded.LoadFromJson(root, kNow).ok());
+  EXPECT_TRUE(loaded.Lookup("receiver-1", kNow));
+  EXPECT_FALSE(loaded.Lookup("receiver-2", kNow));
+
+  EXPECT_FALSE(loaded.LoadFromJson(Json::Value("garbage"), kNow).ok());
+}
+
+TEST(NetworkHistoryCacheTest, SkipsEntriesWithOutOfRangeValues) {
+  NetworkHistoryCache cache;
+  for (int i = 1; i <= 5; ++i) {
+    cache.Update("receiver-" + std::to_string(i), MakeConditions(i * 1000000),
+                 kNow);
+  }
+  Json::Value root = cache.ToJson();
+  root["receivers"]["receiver-2"]["bandwidth"] = -1000000;
+  root["receivers"]["receiver-3"]["rttMicros"] = -12000;
+  root["receivers"]["receiver-4"]["packetLoss"] = -0.125;
+  root["receivers"]["receiver-5"]["packetLoss"] = 1.5;
+
+  NetworkHistoryCache loaded;
+  ASSERT_TRUE(loaded.LoadFromJson(root, kNow).ok());
+  EXPECT_TRUE(loaded.Lookup("receiver-1", kNow));
+  EXPECT_FALSE(loaded.Lookup("receiver-2", kNow));
+  EXPECT_FALSE(loaded.Lookup("receiver-3", kNow));
+  EXPECT_FALSE(loaded.Lookup("receiver-4", kNow));
+  EXPECT_FALSE(loaded.Lookup("receiver-5", kNow));
+}
+
+TEST(NetworkHistoryCacheTest, SkipsEntriesWithOutOfRangeTimestamps) {
+  NetworkHistoryCache cache;
+  for (int i = 1; i <= 4; ++i) {
+    cache.Update("receiver-" + std::to_string(i), MakeConditions(1000000),
+                 kNow);
+  }
+  Json::Value root = cache.ToJson();
+  root["receivers"]["receiver-2"]["lastUpdated"] =
+      static_cast<Json::Int64>((kNow + seconds(1)).count());
+  root["receivers"]["receiver-3"]["lastUpdated"] = Json::Int64(-1);
+  root["receivers"]["receiver-4"]["lastUpdated"] =
+      std::numeric_limits<Json::Int64>::min();
+
+  NetworkHistoryCache loaded;
+  ASSERT_TRUE(loaded.LoadFromJson(root, kNow).ok());
+  EXPECT_TRUE(loaded.Lookup("receiver-1", kNow));
+  EXPECT_FALSE(loaded.Lookup("receiver-2", kNow + seconds(1)));
+  EXPECT_FALSE(loaded.Lookup("receiver-3", kNow));
+  EXPECT_FALSE(loaded.Lookup("receiver-4", kNow));
+}
+
+TEST(NetworkHistoryCacheTest, PrunesWhenLoaded) {
+  NetworkHistoryCache cache(hours(1));
+  for (int i = 0; i < NetworkHistoryCache::kMaxEntries; ++i) {
+    cache.Update("receiver-" + std::to_string(i), MakeConditions(1000000),
+                 kNow);
+  }
+  // Add more entries than the cache would ever save itself, one of which has
+  // expired.
+  Json::Value root = cache.ToJson();
+  root["receivers"]["receiver-extra"] = root["receivers"]["receiver-0"];
+  root["receivers"]["receiver-extra"]["lastUpdated"] =
+      static_cast<Json::Int64>((kNow - seconds(2)).count());
+  root["receivers"]["receiver-expired"] = root["receivers"]["receiver-0"];
+  root["receivers"]["receiver-expired"]["lastUpdated"] =
+      static_cast<Json::Int64>((kNow - hours(2)).count());
+
+  NetworkHistoryCache loaded(hours(1));
+  ASSERT_TRUE(loaded.LoadFromJson(root, kNow).ok());
+  EXPECT_EQ(static_cast<Json::ArrayIndex>(NetworkHistoryCache::kMaxEntries),
+            loaded.ToJson()["receivers"].size());
+  EXPECT_FALSE(loaded.ToJson()["receivers"].isMember("receiver-expired"));
+  EXPECT_FALSE(loaded.ToJson()["receivers"].isMember("receiver-extra"));
+}
+
+TEST(NetworkHistoryCacheTest, PersistsToFile) {
+  const std::string path =
+      testing::TempDir() + "network_history_cache_unittest.json";
+  remove(path.c_str());
+
+  NetworkHistoryCache cache;
+  cache.Update("receiver-1", MakeConditions(1000000), kNow);
+  ASSERT_TRUE(cache.SaveToFile(path.c_str()).ok());
+
+  NetworkHistoryCache loaded;
+  ASSERT_TRUE(loaded.LoadFromFile(path.c_str(), kNow).ok());
+  ASSERT_TRUE(loaded.Lookup("receiver-1", kNow));
+  ExpectSameConditions(MakeConditions(1000000),
+                       loaded.Lookup("receiver-1", kNow).value());
+
+  // A missing file just means there is no history yet.
+  remove(path.c_str());
+  ASSERT_TRUE(loaded.LoadFromFile(path.c_str(), kNow).ok());
+  EXPECT_TRUE(loaded.empty());
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
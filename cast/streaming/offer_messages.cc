@@ -14,12 +14,14 @@
 #include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
 #include "absl/strings/str_split.h"
+#include "absl/types/optional.h"
 #include "cast/streaming/capture_recommendations.h"
 #include "cast/streaming/constants.h"
 #include "platform/base/error.h"
 #include "util/big_endian.h"
 #include "util/enum_name_table.h"
 #include "util/json/json_helpers.h"
+#include "util/json/json_reader.h"
 #include "util/json/json_serialization.h"
 #include "util/osp_logging.h"
 #include "util/stringprintf.h"
@@ -34,9 +36,189 @@ constexpr char kAudioSourceType[] = "audio_source";
 constexpr char kVideoSourceType[] = "video_source";
 constexpr char kStreamType[] = "type";
 
-ErrorOr<RtpPayloadType> ParseRtpPayloadType(const Json::Value& parent,
+// The members of one of the |kSupportedStreams|. They may come in any order,
+// and which ones are needed depends on the type of the stream, so they are all
+// read before any is validated. Each is unset if missing, or of the wrong type.
+struct StreamFields {
+  absl::optional<std::string> type;
+  absl::optional<int> index;
+  absl::optional<int> channels;
+  absl::optional<std::string> rtp_profile;
+  absl::optional<int> rtp_payload_type;
+  absl::optional<uint32_t> ssrc;
+  absl::optional<std::string> aes_key;
+  absl::optional<std::string> aes_iv_mask;
+  absl::optional<std::string> time_base;
+  absl::optional<int> target_delay;
+  absl::optional<bool> receiver_rtcp_event_log;
+  absl::optional<std::string> receiver_rtcp_dscp;
+  absl::optional<std::string> codec_name;
+  absl::optional<int> bit_rate;
+  std::vector<Resolution> resolutions;
+  Error resolutions_error;
+  absl::optional<std::string> max_frame_rate;
+  absl::optional<std::string> profile;
+  absl::optional<std::string> protection;
+  absl::optional<int> max_bit_rate;
+  absl::optional<std::string> level;
+  absl::optional<std::string> error_recovery_mode;
+};
+
+bool ReadValue(json::JsonReader* reader, int* out) {
+  return reader->ReadInt(out);
+}
+
+bool ReadValue(json::JsonReader* reader, bool* out) {
+  return reader->ReadBool(out);
+}
+
+bool ReadValue(json::JsonReader* reader, std::string* out) {
+  return reader->ReadString(out);
+}
+
+// Sets |out| to the next value, or unsets it if the value is of another type.
+// Either way, the value is consumed.
+template <typename T>
+void ReadOptional(json::JsonReader* reader, absl::optional<T>* out) {
+  T value;
+  if (ReadValue(reader, &value)) {
+    *out = std::move(value);
+  } else {
+    *out = absl::nullopt;
+    reader->SkipValue();
+  }
+}
+
+// Returns the value of a required |field|, or an error if it was missing.
+template <typename T>
+ErrorOr<T> GetRequired(const absl::optional<T>& value,
+                       const std::string& field) {
+  if (!value) {
+    return json::CreateParseError("field: " + field);
+  }
+  return value.value();
+}
+
+ErrorOr<Resolution> ReadResolution(json::JsonReader* reader) {
+  absl::optional<int> width;
+  absl::optional<int> height;
+  if (json::BeginObjectOrSkip(reader)) {
+    absl::string_view key;
+    while (reader->NextMember(&key)) {
+      if (key == "width") {
+        ReadOptional(reader, &width);
+      } else if (key == "height") {
+        ReadOptional(reader, &height);
+      } else {
+        reader->SkipValue();
+      }
+    }
+  }
+
+  auto w = GetRequired(width, "width");
+  if (!w) {
+    return w.error();
+  }
+  auto h = GetRequired(height, "height");
+  if (!h) {
+    return h.error();
+  }
+  if (w.value() <= 0 || h.value() <= 0) {
+    return json::CreateParameterError("resolution");
+  }
+  return Resolution{w.value(), h.value()};
+}
+
+// Returns the first error, if any, though the whole value is consumed
+// regardless.
+Error ReadResolutions(json::JsonReader* reader,
+                      std::vector<Resolution>* resolutions) {
+  resolutions->clear();
+  // Some legacy senders don't provide resolutions, so just leave it empty.
+  if (reader->PeekType() != json::JsonReader::ValueType::kArray) {
+    reader->SkipValue();
+    return Error::None();
+  }
+
+  Error error;
+  reader->BeginArray();
+  while (reader->NextElement()) {
+    auto r = ReadResolution(reader);
+    if (!r) {
+      if (error.ok()) {
+        error = r.error();
+      }
+      continue;
+    }
+    resolutions->push_back(r.value());
+  }
+  return error;
+}
+
+void ReadStreamFields(json::JsonReader* reader, StreamFields* fields) {
+  if (!json::BeginObjectOrSkip(reader)) {
+    return;
+  }
+
+  absl::string_view key;
+  while (reader->NextMember(&key)) {
+    if (key == kStreamType) {
+      ReadOptional(reader, &fields->type);
+    } else if (key == "index") {
+      ReadOptional(reader, &fields->index);
+    } else if (key == "channels") {
+      ReadOptional(reader, &fields->channels);
+    } else if (key == "rtpProfile") {
+      ReadOptional(reader, &fields->rtp_profile);
+    } else if (key == "rtpPayloadType") {
+      ReadOptional(reader, &fields->rtp_payload_type);
+    } else if (key == "ssrc") {
+      uint32_t ssrc;
+      if (json::ReadAndValidateUint(reader, &ssrc)) {
+        fields->ssrc = ssrc;
+      } else {
+        fields->ssrc = absl::nullopt;
+      }
+    } else if (key == "aesKey") {
+      ReadOptional(reader, &fields->aes_key);
+    } else if (key == "aesIvMask") {
+      ReadOptional(reader, &fields->aes_iv_mask);
+    } else if (key == "timeBase") {
+      ReadOptional(reader, &fields->time_base);
+    } else if (key == "targetDelay") {
+      ReadOptional(reader, &fields->target_delay);
+    } else if (key == "receiverRtcpEventLog") {
+      ReadOptional(reader, &fields->receiver_rtcp_event_log);
+    } else if (key == "receiverRtcpDscp") {
+      ReadOptional(reader, &fields->receiver_rtcp_dscp);
+    } else if (key == "codecName") {
+      ReadOptional(reader, &fields->codec_name);
+    } else if (key == "bitRate") {
+      ReadOptional(reader, &fields->bit_rate);
+    } else if (key == "resolutions") {
+      fields->resolutions_error =
+          ReadResolutions(reader, &fields->resolutions);
+    } else if (key == "maxFrameRate") {
+      ReadOptional(reader, &fields->max_frame_rate);
+    } else if (key == "profile") {
+      ReadOptional(reader, &fields->profile);
+    } else if (key == "protection") {
+      ReadOptional(reader, &fields->protection);
+    } else if (key == "maxBitRate") {
+      ReadOptional(reader, &fields->max_bit_rate);
+    } else if (key == "level") {
+      ReadOptional(reader, &fields->level);
+    } else if (key == "errorRecoveryMode") {
+      ReadOptional(reader, &fields->error_recovery_mode);
+    } else {
+      reader->SkipValue();
+    }
+  }
+}
+
+ErrorOr<RtpPayloadType> ParseRtpPayloadType(const absl::optional<int>& value,
                                             const std::string& field) {
-  auto t = json::ParseInt(parent, field);
+  auto t = GetRequired(value, field);
   if (!t) {
     return t.error();
   }
@@ -50,9 +232,9 @@ ErrorOr<RtpPayloadType> ParseRtpPayloadType(const Json::Value& parent,
   return static_cast<RtpPayloadType>(t_small);
 }
 
-ErrorOr<int> ParseRtpTimebase(const Json::Value& parent,
+ErrorOr<int> ParseRtpTimebase(const absl::optional<std::string>& value,
                               const std::string& field) {
-  auto error_or_raw = json::ParseString(parent, field);
+  auto error_or_raw = GetRequired(value, field);
   if (!error_or_raw) {
     return error_or_raw.error();
   }
@@ -72,9 +254,9 @@ constexpr int kHexDigitsPerByte = 2;
 constexpr int kAesBytesSize = 16;
 constexpr int kAesStringLength = kAesBytesSize * kHexDigitsPerByte;
 ErrorOr<std::array<uint8_t, kAesBytesSize>> ParseAesHexBytes(
-    const Json::Value& parent,
+    const absl::optional<std::string>& value,
     const std::string& field) {
-  auto hex_string = json::ParseString(parent, field);
+  auto hex_string = GetRequired(value, field);
   if (!hex_string) {
     return hex_string.error();
   }
@@ -97,35 +279,35 @@ ErrorOr<std::array<uint8_t, kAesBytesSize>> ParseAesHexBytes(
   return json::CreateParseError("AES hex string bytes");
 }
 
-ErrorOr<Stream> ParseStream(const Json::Value& value, Stream::Type type) {
-  auto index = json::ParseInt(value, "index");
+ErrorOr<Stream> ParseStream(const StreamFields& fields, Stream::Type type) {
+  auto index = GetRequired(fields.index, "index");
   if (!index) {
     return index.error();
   }
   // If channel is omitted, the default value is used later.
-  auto channels = json::ParseInt(value, "channels");
-  if (channels.is_value() && channels.value() <= 0) {
+  if (fields.channels && fields.channels.value() <= 0) {
     return json::CreateParameterError("channel");
   }
-  auto rtp_profile = json::ParseString(value, "rtpProfile");
+  auto rtp_profile = GetRequired(fields.rtp_profile, "rtpProfile");
   if (!rtp_profile) {
     return rtp_profile.error();
   }
-  auto rtp_payload_type = ParseRtpPayloadType(value, "rtpPayloadType");
+  auto rtp_payload_type =
+      ParseRtpPayloadType(fields.rtp_payload_type, "rtpPayloadType");
   if (!rtp_payload_type) {
     return rtp_payload_type.error();
   }
-  auto ssrc = json::ParseUint(value, "ssrc");
+  auto ssrc = GetRequired(fields.ssrc, "ssrc");
   if (!ssrc) {
     return ssrc.error();
   }
-  auto aes_key = ParseAesHexBytes(value, "aesKey");
-  auto aes_iv_mask = ParseAesHexBytes(value, "aesIvMask");
+  auto aes_key = ParseAesHexBytes(fields.aes_key, "aesKey");
+  auto aes_iv_mask = ParseAesHexBytes(fields.aes_iv_mask, "aesIvMask");
   if (!aes_key || !aes_iv_mask) {
     return Error(Error::Code::kUnencryptedOffer,
                  "Offer stream must have both a valid aesKey and aesIvMask");
   }
-  auto rtp_timebase = ParseRtpTimebase(value, "timeBase");
+  auto rtp_timebase = ParseRtpTimebase(fields.time_base, "timeBase");
   if (!rtp_timebase) {
     return rtp_timebase.error();
   }
@@ -136,43 +318,40 @@ ErrorOr<Stream> ParseStream(const Json::Value& value, Stream::Type type) {
     return json::CreateParameterError("rtp_timebase (sample rate)");
   }
 
-  auto target_delay = json::ParseInt(value, "targetDelay");
   std::chrono::milliseconds target_delay_ms = kDefaultTargetPlayoutDelay;
-  if (target_delay) {
-    auto d = std::chrono::milliseconds(target_delay.value());
+  if (fields.target_delay) {
+    auto d = std::chrono::milliseconds(fields.target_delay.value());
     if (kMinTargetPlayoutDelay <= d && d <= kMaxTargetPlayoutDelay) {
       target_delay_ms = d;
     }
   }
 
-  auto receiver_rtcp_event_log = json::ParseBool(value, "receiverRtcpEventLog");
-  auto receiver_rtcp_dscp = json::ParseString(value, "receiverRtcpDscp");
   return Stream{index.value(),
                 type,
-                channels.value(type == Stream::Type::kAudioSource
-                                   ? kDefaultNumAudioChannels
-                                   : kDefaultNumVideoChannels),
+                fields.channels.value_or(type == Stream::Type::kAudioSource
+                                             ? kDefaultNumAudioChannels
+                                             : kDefaultNumVideoChannels),
                 rtp_payload_type.value(),
                 ssrc.value(),
                 target_delay_ms,
                 aes_key.value(),
                 aes_iv_mask.value(),
-                receiver_rtcp_event_log.value({}),
-                receiver_rtcp_dscp.value({}),
+                fields.receiver_rtcp_event_log.value_or(false),
+                fields.receiver_rtcp_dscp.value_or(std::string()),
                 rtp_timebase.value()};
 }
 
-ErrorOr<AudioStream> ParseAudioStream(const Json::Value& value) {
-  auto stream = ParseStream(value, Stream::Type::kAudioSource);
+ErrorOr<AudioStream> ParseAudioStream(const StreamFields& fields) {
+  auto stream = ParseStream(fields, Stream::Type::kAudioSource);
   if (!stream) {
     return stream.error();
   }
-  auto bit_rate = json::ParseInt(value, "bitRate");
+  auto bit_rate = GetRequired(fields.bit_rate, "bitRate");
   if (!bit_rate) {
     return bit_rate.error();
   }
 
-  auto codec_name = json::ParseString(value, "codecName");
+  auto codec_name = GetRequired(fields.codec_name, "codecName");
   if (!codec_name) {
     return codec_name.error();
   }
@@ -189,47 +368,12 @@ ErrorOr<AudioStream> ParseAudioStream(const Json::Value& value) {
   return AudioStream{stream.value(), codec.value(), bit_rate.value()};
 }
 
-ErrorOr<Resolution> ParseResolution(const Json::Value& value) {
-  auto width = json::ParseInt(value, "width");
-  if (!width) {
-    return width.error();
-  }
-  auto height = json::ParseInt(value, "height");
-  if (!height) {
-    return height.error();
-  }
-  if (width.value() <= 0 || height.value() <= 0) {
-    return json::CreateParameterError("resolution");
-  }
-  return Resolution{width.value(), height.value()};
-}
-
-ErrorOr<std::vector<Resolution>> ParseResolutions(const Json::Value& parent,
-                                                  const std::string& field) {
-  std::vector<Resolution> resolutions;
-  // Some legacy senders don't provide resolutions, so just return empty.
-  const Json::Value& value = parent[field];
-  if (!value.isArray() || value.empty()) {
-    return resolutions;
-  }
-
-  for (Json::ArrayIndex i = 0; i < value.size(); ++i) {
-    auto r = ParseResolution(value[i]);
-    if (!r) {
-      return r.error();
-    }
-    resolutions.push_back(r.value());
-  }
-
-  return resolutions;
-}
-
-ErrorOr<VideoStream> ParseVideoStream(const Json::Value& value) {
-  auto stream = ParseStream(value, Stream::Type::kVideoSource);
+ErrorOr<VideoStream> ParseVideoStream(const StreamFields& fields) {
+  auto stream = ParseStream(fields, Stream::Type::kVideoSource);
   if (!stream) {
     return stream.error();
   }
-  auto codec_name = json::ParseString(value, "codecName");
+  auto codec_name = GetRequired(fields.codec_name, "codecName");
   if (!codec_name) {
     return codec_name.error();
   }
@@ -238,34 +382,87 @@ ErrorOr<VideoStream> ParseVideoStream(const Json::Value& value) {
     return Error(Error::Code::kUnknownCodec,
                  "Codec is not known, can't use stream");
   }
-  auto resolutions = ParseResolutions(value, "resolutions");
-  if (!resolutions) {
-    return resolutions.error();
+  if (!fields.resolutions_error.ok()) {
+    return fields.resolutions_error;
   }
 
-  auto raw_max_frame_rate = json::ParseString(value, "maxFrameRate");
   SimpleFraction max_frame_rate{kDefaultMaxFrameRate, 1};
-  if (raw_max_frame_rate.is_value()) {
-    auto parsed = SimpleFraction::FromString(raw_max_frame_rate.value());
+  if (fields.max_frame_rate) {
+    auto parsed = SimpleFraction::FromString(fields.max_frame_rate.value());
     if (parsed.is_value() && parsed.value().is_positive()) {
       max_frame_rate = parsed.value();
     }
   }
 
-  auto profile = json::ParseString(value, "profile");
-  auto protection = json::ParseString(value, "protection");
-  auto max_bit_rate = json::ParseInt(value, "maxBitRate");
-  auto level = json::ParseString(value, "level");
-  auto error_recovery_mode = json::ParseString(value, "errorRecoveryMode");
   return VideoStream{stream.value(),
                      codec.value(),
                      max_frame_rate,
-                     max_bit_rate.value(4 << 20),
-                     protection.value({}),
-                     profile.value({}),
-                     level.value({}),
-                     resolutions.value(),
-                     error_recovery_mode.value({})};
+                     fields.max_bit_rate.value_or(4 << 20),
+                     fields.protection.value_or(std::string()),
+                     fields.profile.value_or(std::string()),
+                     fields.level.value_or(std::string()),
+                     fields.resolutions,
+                     fields.error_recovery_mode.value_or(std::string())};
+}
+
+// Validates one of the |kSupportedStreams|, and adds it to the streams of its
+// type. Streams of unknown types or codecs are dropped.
+Error AddStream(const StreamFields& fields,
+                std::vector<AudioStream>* audio_streams,
+                std::vector<VideoStream>* video_streams) {
+  auto type = GetRequired(fields.type, kStreamType);
+  if (!type) {
+    return type.error();
+  }
+
+  if (type.value() == kAudioSourceType) {
+    auto stream = ParseAudioStream(fields);
+    if (!stream) {
+      if (stream.error().code() == Error::Code::kUnknownCodec) {
+        OSP_DVLOG << "Dropping audio stream due to unknown codec: "
+                  << stream.error();
+        return Error::None();
+      }
+      return stream.error();
+    }
+    audio_streams->push_back(std::move(stream.value()));
+  } else if (type.value() == kVideoSourceType) {
+    auto stream = ParseVideoStream(fields);
+    if (!stream) {
+      if (stream.error().code() == Error::Code::kUnknownCodec) {
+        OSP_DVLOG << "Dropping video stream due to unknown codec: "
+                  << stream.error();
+        return Error::None();
+      }
+      return stream.error();
+    }
+    video_streams->push_back(std::move(stream.value()));
+  }
+  return Error::None();
+}
+
+// Returns the first error, if any, though the whole value is consumed
+// regardless.
+Error ReadSupportedStreams(json::JsonReader* reader,
+                           std::vector<AudioStream>* audio_streams,
+                           std::vector<VideoStream>* video_streams) {
+  audio_streams->clear();
+  video_streams->clear();
+  if (reader->PeekType() != json::JsonReader::ValueType::kArray) {
+    reader->SkipValue();
+    return json::CreateParseError("supported streams in offer");
+  }
+
+  Error error;
+  reader->BeginArray();
+  while (reader->NextElement()) {
+    StreamFields fields;
+    ReadStreamFields(reader, &fields);
+    if (error.ok()) {
+      error = AddStream(fields, audio_streams, video_streams);
+    }
+  }
+  return error;
 }
 
 absl::string_view ToString(Stream::Type type) {
@@ -375,53 +572,56 @@ ErrorOr<Offer> Offer::Parse(const Json::Value& root) {
   if (!root.isObject()) {
     return json::CreateParseError("null offer");
   }
-  ErrorOr<CastMode> cast_mode =
-      GetEnum(kCastModeNames, root["castMode"].asString());
-  const ErrorOr<bool> get_status = json::ParseBool(root, "receiverGetStatus");
-
-  Json::Value supported_streams = root[kSupportedStreams];
-  if (!supported_streams.isArray()) {
-    return json::CreateParseError("supported streams in offer");
+  const ErrorOr<std::string> document = json::Stringify(root);
+  if (document.is_error()) {
+    return json::CreateParseError("offer");
+  }
+  json::JsonReader reader(document.value());
+  ErrorOr<Offer> offer = Read(&reader);
+  if (offer.is_value() && !reader.Finish()) {
+    return json::CreateParseError("offer");
   }
+  return offer;
+}
 
-  std::vector<AudioStream> audio_streams;
-  std::vector<VideoStream> video_streams;
-  for (Json::ArrayIndex i = 0; i < supported_streams.size(); ++i) {
-    const Json::Value& fields = supported_streams[i];
-    auto type = json::ParseString(fields, kStreamType);
-    if (!type) {
-      return type.error();
-    }
+// static
+ErrorOr<Offer> Offer::Read(json::JsonReader* reader) {
+  if (!json::BeginObjectOrSkip(reader)) {
+    return json::CreateParseError("null offer");
+  }
 
-    if (type.value() == kAudioSourceType) {
-      auto stream = ParseAudioStream(fields);
-      if (!stream) {
-        if (stream.error().code() == Error::Code::kUnknownCodec) {
-          OSP_DVLOG << "Dropping audio stream due to unknown codec: "
-                    << stream.error();
-          continue;
-        } else {
-          return stream.error();
-        }
+  Offer offer;
+  Error streams_error = json::CreateParseError("supported streams in offer");
+  absl::string_view key;
+  while (reader->NextMember(&key)) {
+    if (key == "castMode") {
+      std::string cast_mode;
+      offer.cast_mode =
+          json::ReadAndValidateString(reader, &cast_mode)
+              ? GetEnum(kCastModeNames, cast_mode).value(CastMode::kMirroring)
+              : CastMode::kMirroring;
+    } else if (key == "receiverGetStatus") {
+      if (!json::ReadBool(reader, &offer.supports_wifi_status_reporting)) {
+        offer.supports_wifi_status_reporting = false;
       }
-      audio_streams.push_back(std::move(stream.value()));
-    } else if (type.value() == kVideoSourceType) {
-      auto stream = ParseVideoStream(fields);
-      if (!stream) {
-        if (stream.error().code() == Error::Code::kUnknownCodec) {
-          OSP_DVLOG << "Dropping video stream due to unknown codec: "
-                    << stream.error();
-          continue;
-        } else {
-          return stream.error();
-        }
+    } else if (key == "binaryRpc") {
+      if (!json::ReadBool(reader, &offer.supports_binary_rpc)) {
+        offer.supports_binary_rpc = false;
       }
-      video_streams.push_back(std::move(stream.value()));
+    } else if (key == kSupportedStreams) {
+      streams_error = ReadSupportedStreams(reader, &offer.audio_streams,
+                                           &offer.video_streams);
+    } else {
+      reader->SkipValue();
     }
   }
-
-  return Offer{cast_mode.value(CastMode::kMirroring), get_status.value({}),
-               std::move(audio_streams), std::move(video_streams)};
+  if (!reader->ok()) {
+    return json::CreateParseError("offer");
+  }
+  if (!streams_error.ok()) {
+    return streams_error;
+  }
+  return offer;
 }
 
 ErrorOr<Json::Value> Offer::ToJson() const {
@@ -448,6 +648,10 @@ ErrorOr<Json::Value> Offer::ToJson() const {
   }
 
   root[kSupportedStreams] = std::move(streams);
+  // Older receivers may not expect this field, so it is omitted if false.
+  if (supports_binary_rpc) {
+    root["binaryRpc"] = true;
+  }
   return root;
 }
 
@@ -16,6 +16,7 @@
 #include "cast/streaming/session_config.h"
 #include "json/value.h"
 #include "platform/base/error.h"
+#include "util/json/json_reader.h"
 #include "util/simple_fraction.h"
 
 // This file contains the implementation of the Cast V2 Mirroring Control
@@ -98,6 +99,11 @@ enum class CastMode : uint8_t { kMirroring, kRemoting };
 
 struct Offer {
   static ErrorOr<Offer> Parse(const Json::Value& root);
+
+  // Same as Parse(), but reads the next value from |reader|, which is consumed
+  // whether or not it is a valid offer. Parse() is implemented in terms of
+  // this.
+  static ErrorOr<Offer> Read(json::JsonReader* reader);
   ErrorOr<Json::Value> ToJson() const;
 
   CastMode cast_mode = CastMode::kMirroring;
@@ -106,6 +112,10 @@ struct Offer {
   bool supports_wifi_status_reporting = {};
   std::vector<AudioStream> audio_streams = {};
   std::vector<VideoStream> video_streams = {};
+
+  // Whether the sender can send and receive batches of RPC messages as binary
+  // payloads (see BinaryRpcChannel). This is not part of the specification.
+  bool supports_binary_rpc = false;
 };
 
 }  // namespace cast
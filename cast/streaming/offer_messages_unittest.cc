@@ -5,6 +5,7 @@
 #include "cast/streaming/offer_messages.h"
 
 #include <limits>
+#include <string>
 #include <utility>
 
 #include "cast/streaming/rtp_defines.h"
@@ -452,6 +453,32 @@ TEST(OfferTest, CanParseValidOffer) {
   ExpectEqualsValidOffer(offer.value());
 }
 
+TEST(OfferTest, CanReadValidOffer) {
+  // The offer is read from the middle of a larger document, as the body of a
+  // message would be.
+  const std::string document =
+      std::string(R"({"before": 1, "offer": )") + kValidOffer +
+      R"(, "bad": {"supportedStreams": 5}, "after": 2})";
+  json::JsonReader reader(document);
+  ASSERT_TRUE(reader.BeginObject());
+  absl::string_view key;
+  ASSERT_TRUE(reader.NextMember(&key));
+  ASSERT_TRUE(reader.SkipValue());
+  ASSERT_TRUE(reader.NextMember(&key));
+  ErrorOr<Offer> offer = Offer::Read(&reader);
+  ASSERT_TRUE(offer.is_value()) << offer.error();
+  ExpectEqualsValidOffer(offer.value());
+
+  // An invalid offer is consumed all the same.
+  ASSERT_TRUE(reader.NextMember(&key));
+  EXPECT_TRUE(Offer::Read(&reader).is_error());
+  ASSERT_TRUE(reader.NextMember(&key));
+  EXPECT_EQ("after", key);
+  ASSERT_TRUE(reader.SkipValue());
+  EXPECT_FALSE(reader.NextMember(&key));
+  EXPECT_TRUE(reader.Finish());
+}
+
 TEST(OfferTest, ParseAndToJsonResultsInSameOffer) {
   ErrorOr<Json::Value> root = json::Parse(kValidOffer);
   ASSERT_TRUE(root.is_value());
@@ -465,6 +492,21 @@ TEST(OfferTest, ParseAndToJsonResultsInSameOffer) {
   ExpectEqualsValidOffer(reparsed_offer.value());
 }
 
+TEST(OfferTest, ParsesAndSerializesBinaryRpcSupport) {
+  ErrorOr<Json::Value> root = json::Parse(kValidOffer);
+  ASSERT_TRUE(root.is_value());
+  ErrorOr<Offer> offer = Offer::Parse(root.value());
+  ASSERT_TRUE(offer.is_value());
+  EXPECT_FALSE(offer.value().supports_binary_rpc);
+  EXPECT_FALSE(offer.value().ToJson().value().isMember("binaryRpc"));
+
+  root.value()["binaryRpc"] = true;
+  offer = Offer::Parse(root.value());
+  ASSERT_TRUE(offer.is_value());
+  EXPECT_TRUE(offer.value().supports_binary_rpc);
+  EXPECT_TRUE(offer.value().ToJson().value()["binaryRpc"].asBool());
+}
+
 // We don't want to enforce that a given offer must have both audio and
 // video, so we don't assert on either.
 TEST(OfferTest, ToJsonSucceedsWithMissingStreams) {
@@ -0,0 +1,210 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/packet_capture.h"
+
+#include <errno.h>
+#include <string.h>
+
+#include <array>
+#include <limits>
+#include <string>
+#include <utility>
+
+#include "util/big_endian.h"
+#include "util/chrono_helpers.h"
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+using packet_capture::kMagic;
+using packet_capture::kRecordHeaderSize;
+using packet_capture::RecordType;
+
+namespace {
+
+// The serialized size of a SessionConfig record payload.
+constexpr int kSessionConfigSize = 5 * sizeof(uint32_t) +
+                                   2 * sizeof(SessionConfig::aes_secret_key) +
+                                   sizeof(uint8_t);
+
+Error MakeParseError(const char* what) {
+  return Error(Error::Code::kParseError,
+               std::string("Malformed packet capture: ") + what);
+}
+
+}  // namespace
+
+PacketCapture::PacketCapture() = default;
+PacketCapture::PacketCapture(PacketCapture&&) noexcept = default;
+PacketCapture& PacketCapture::operator=(PacketCapture&&) noexcept = default;
+PacketCapture::~PacketCapture() = default;
+
+PacketCaptureWriter::PacketCaptureWriter(FILE* file) : file_(file) {}
+
+PacketCaptureWriter::~PacketCaptureWriter() {
+  fclose(file_);
+}
+
+// static
+ErrorOr<std::unique_ptr<PacketCaptureWriter>> PacketCaptureWriter::Create(
+    const char* path) {
+  FILE* const file = fopen(path, "wb");
+  if (!file) {
+    return Error(Error::Code::kFileLoadFailure,
+                 std::string("Unable to create ") + path + ": " +
+                     strerror(errno));
+  }
+  std::unique_ptr<PacketCaptureWriter> writer(new PacketCaptureWriter(file));
+  if (fwrite(kMagic, sizeof(kMagic), 1, file) != 1) {
+    return Error(Error::Code::kIOFailure,
+                 std::string("Unable to write to ") + path);
+  }
+  return writer;
+}
+
+void PacketCaptureWriter::OnPacketSent(Clock::time_point send_time,
+                                       absl::Span<const uint8_t> packet) {
+  WriteRecord(RecordType::kPacketSent, send_time, packet);
+  ++num_packets_written_;
+}
+
+void PacketCaptureWriter::OnPacketReceived(Clock::time_point arrival_time,
+                                           absl::Span<const uint8_t> packet) {
+  WriteRecord(RecordType::kPacketReceived, arrival_time, packet);
+  ++num_packets_written_;
+}
+
+void PacketCaptureWriter::OnReceiverCreated(const SessionConfig& config) {
+  uint8_t payload[kSessionConfigSize];
+  BigEndianWriter writer(payload, sizeof(payload));
+  writer.Write<uint32_t>(config.sender_ssrc);
+  writer.Write<uint32_t>(config.receiver_ssrc);
+  writer.Write<uint32_t>(config.rtp_timebase);
+  writer.Write<uint32_t>(config.channels);
+  writer.Write<uint32_t>(config.target_playout_delay.count());
+  writer.Write(config.aes_secret_key.data(), config.aes_secret_key.size());
+  writer.Write(config.aes_iv_mask.data(), config.aes_iv_mask.size());
+  writer.Write<uint8_t>(config.is_pli_enabled ? 1 : 0);
+  OSP_DCHECK_EQ(writer.remaining(), size_t{0});
+  // The timestamp of a session config record is not meaningful.
+  WriteRecord(RecordType::kSessionConfig, Clock::time_point(), payload);
+}
+
+void PacketCaptureWriter::WriteRecord(RecordType type,
+                                      Clock::time_point time,
+                                      absl::Span<const uint8_t> payload) {
+  if (has_failed_) {
+    return;
+  }
+  // Packets never exceed the network MTU, so this is only a sanity-check.
+  OSP_DCHECK_LE(payload.size(), std::numeric_limits<uint16_t>::max());
+
+  uint8_t header[kRecordHeaderSize];
+  BigEndianWriter writer(header, sizeof(header));
+  writer.Write<uint8_t>(static_cast<uint8_t>(type));
+  writer.Write<int64_t>(to_microseconds(time.time_since_epoch()).count());
+  writer.Write<uint16_t>(static_cast<uint16_t>(payload.size()));
+
+  // The stdio buffering amortizes the cost of writing many small records.
+  if (fwrite(header, sizeof(header), 1, file_) != 1 ||
+      (!payload.empty() &&
+       fwrite(payload.data(), payload.size(), 1, file_) != 1)) {
+    OSP_LOG_ERROR << "Failed to write packet capture: " << strerror(errno)
+                  << ". No further packets will be captured.";
+    has_failed_ = true;
+  }
+}
+
+ErrorOr<PacketCapture> ParsePacketCapture(absl::Span<const uint8_t> data) {
+  if (data.size() < sizeof(kMagic) ||
+      memcmp(data.data(), kMagic, sizeof(kMagic)) != 0) {
+    return MakeParseError("bad magic");
+  }
+
+  PacketCapture capture;
+  BigEndianReader reader(data.data() + sizeof(kMagic),
+                         data.size() - sizeof(kMagic));
+  while (reader.remaining() >= size_t{kRecordHeaderSize}) {
+    uint8_t type;
+    int64_t time_us;
+    uint16_t size;
+    reader.Read<uint8_t>(&type);
+    reader.Read<int64_t>(&time_us);
+    reader.Read<uint16_t>(&size);
+    if (reader.remaining() < size) {
+      OSP_LOG_WARN << "Ignoring truncated record at the end of the capture.";
+      break;
+    }
+    const absl::Span<const uint8_t> payload(reader.current(), size);
+    reader.Skip(size);
+
+    switch (static_cast<RecordType>(type)) {
+      case RecordType::kSessionConfig: {
+        if (size != kSessionConfigSize) {
+          return MakeParseError("bad session config size");
+        }
+        BigEndianReader config_reader(payload.data(), payload.size());
+        uint32_t sender_ssrc, receiver_ssrc, rtp_timebase, channels, delay_ms;
+        std::array<uint8_t, 16> aes_secret_key, aes_iv_mask;
+        uint8_t is_pli_enabled;
+        config_reader.Read<uint32_t>(&sender_ssrc);
+        config_reader.Read<uint32_t>(&receiver_ssrc);
+        config_reader.Read<uint32_t>(&rtp_timebase);
+        config_reader.Read<uint32_t>(&channels);
+        config_reader.Read<uint32_t>(&delay_ms);
+        config_reader.Read(aes_secret_key.size(), aes_secret_key.data());
+        config_reader.Read(aes_iv_mask.size(), aes_iv_mask.data());
+        config_reader.Read<uint8_t>(&is_pli_enabled);
+        if (rtp_timebase == 0 || channels == 0) {
+          return MakeParseError("bad session config");
+        }
+        capture.session_configs.emplace_back(
+            sender_ssrc, receiver_ssrc, static_cast<int>(rtp_timebase),
+            static_cast<int>(channels), milliseconds(delay_ms), aes_secret_key,
+            aes_iv_mask, is_pli_enabled != 0);
+        break;
+      }
+
+      case RecordType::kPacketSent:
+      case RecordType::kPacketReceived:
+        capture.packets.push_back(CapturedPacket{
+            static_cast<RecordType>(type) == RecordType::kPacketSent,
+            Clock::time_point(microseconds(time_us)),
+            std::vector<uint8_t>(payload.begin(), payload.end())});
+        break;
+
+      default:
+        return MakeParseError("unknown record type");
+    }
+  }
+
+  return capture;
+}
+
+ErrorOr<PacketCapture> ReadPacketCapture(const char* path) {
+  FILE* const file = fopen(path, "rb");
+  if (!file) {
+    return Error(Error::Code::kFileLoadFailure,
+                 std::string("Unable to open ") + path + ": " +
+                     strerror(errno));
+  }
+  std::vector<uint8_t> data;
+  uint8_t chunk[64 * 1024];
+  size_t bytes_read;
+  while ((bytes_read = fread(chunk, 1, sizeof(chunk), file)) > 0) {
+    data.insert(data.end(), chunk, chunk + bytes_read);
+  }
+  const bool had_error = ferror(file);
+  fclose(file);
+  if (had_error) {
+    return Error(Error::Code::kIOFailure,
+                 std::string("Unable to read ") + path);
+  }
+  return ParsePacketCapture(data);
+}
+
+}  // namespace cast
+}  // namespace openscreen
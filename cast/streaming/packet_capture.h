@@ -0,0 +1,120 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STREAMING_PACKET_CAPTURE_H_
+#define CAST_STREAMING_PACKET_CAPTURE_H_
+
+#include <stdint.h>
+#include <stdio.h>
+
+#include <memory>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "cast/streaming/environment.h"
+#include "cast/streaming/session_config.h"
+#include "platform/api/time.h"
+#include "platform/base/error.h"
+#include "platform/base/macros.h"
+
+namespace openscreen {
+namespace cast {
+
+// A packet capture is a compact log of all the RTP/RTCP packets that passed
+// through an Environment, along with the SessionConfig of each Receiver, so
+// that a session can be replayed offline (e.g., by the cast_streaming_replay
+// tool) to reproduce problems or measure the performance of the streaming
+// stack against the same input over time.
+//
+// The file starts with the 8-byte kMagic, followed by any number of records.
+// Each record consists of a one-byte RecordType, a 64-bit timestamp (in
+// microseconds, on the capturing process's Clock), a 16-bit payload size, and
+// then the payload. All integers are big-endian.
+//
+// WARNING: Captures include the AES key and IV mask of each session, so that
+// the frames can be decrypted on replay. Treat them as sensitive.
+namespace packet_capture {
+
+constexpr char kMagic[8] = {'O', 'S', 'C', 'P', 'C', 'A', 'P', '1'};
+
+enum class RecordType : uint8_t {
+  kSessionConfig = 0,
+  kPacketSent = 1,
+  kPacketReceived = 2,
+};
+
+// The size of the fixed-length record header that precedes each payload.
+constexpr int kRecordHeaderSize =
+    sizeof(uint8_t) + sizeof(int64_t) + sizeof(uint16_t);
+
+}  // namespace packet_capture
+
+struct CapturedPacket {
+  // Whether the packet was sent by (true) or received by (false) the capturing
+  // Environment.
+  bool is_outbound;
+  Clock::time_point time;
+  std::vector<uint8_t> data;
+};
+
+struct PacketCapture {
+  PacketCapture();
+  PacketCapture(PacketCapture&&) noexcept;
+  PacketCapture& operator=(PacketCapture&&) noexcept;
+  ~PacketCapture();
+
+  // The configuration of each Receiver created during the capture, in order.
+  std::vector<SessionConfig> session_configs;
+
+  // All packets, in the order they were sent or received.
+  std::vector<CapturedPacket> packets;
+};
+
+// Writes a packet capture file. Attach an instance to an Environment via
+// Environment::SetPacketObserver() before any Receivers are created, and detach
+// it before it is destroyed.
+class PacketCaptureWriter final : public Environment::PacketObserver {
+ public:
+  ~PacketCaptureWriter() final;
+
+  // Creates (or truncates) the file at |path| for writing.
+  static ErrorOr<std::unique_ptr<PacketCaptureWriter>> Create(const char* path);
+
+  int num_packets_written() const { return num_packets_written_; }
+
+  // Environment::PacketObserver implementation.
+  void OnPacketSent(Clock::time_point send_time,
+                    absl::Span<const uint8_t> packet) final;
+  void OnPacketReceived(Clock::time_point arrival_time,
+                        absl::Span<const uint8_t> packet) final;
+  void OnReceiverCreated(const SessionConfig& config) final;
+
+ private:
+  explicit PacketCaptureWriter(FILE* file);
+
+  void WriteRecord(packet_capture::RecordType type,
+                   Clock::time_point time,
+                   absl::Span<const uint8_t> payload);
+
+  FILE* file_;
+  int num_packets_written_ = 0;
+
+  // Set once a write has failed, after which nothing more is written so that
+  // the file remains parseable up to that point.
+  bool has_failed_ = false;
+
+  OSP_DISALLOW_COPY_AND_ASSIGN(PacketCaptureWriter);
+};
+
+// Parses the packet capture in |data|. A truncated final record (e.g., from a
+// process that crashed while capturing) is ignored.
+ErrorOr<PacketCapture> ParsePacketCapture(absl::Span<const uint8_t> data);
+
+// Reads and parses the packet capture file at |path|.
+ErrorOr<PacketCapture> ReadPacketCapture(const char* path);
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STREAMING_PACKET_CAPTURE_H_
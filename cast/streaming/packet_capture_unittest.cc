@@ -0,0 +1,122 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/packet_capture.h"
+
+#include <stdio.h>
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "util/chrono_helpers.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+constexpr Clock::time_point kStartTime =
+    Clock::time_point(milliseconds(1234567));
+
+SessionConfig MakeSessionConfig() {
+  return SessionConfig(
+      /* sender_ssrc */ 1, /* receiver_ssrc */ 2, /* rtp_timebase */ 48000,
+      /* channels */ 2, milliseconds(400),
+      {0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15},
+      {15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0},
+      /* is_pli_enabled */ true);
+}
+
+class PacketCaptureTest : public testing::Test {
+ public:
+  PacketCaptureTest()
+      : path_(testing::TempDir() + "packet_capture_unittest.bin") {}
+
+  ~PacketCaptureTest() override { remove(path_.c_str()); }
+
+  const char* path() const { return path_.c_str(); }
+
+ private:
+  const std::string path_;
+};
+
+TEST_F(PacketCaptureTest, RoundTripsPacketsAndSessionConfigs) {
+  const std::vector<uint8_t> kRtpPacket = {0x80, 0x60, 0x00, 0x01, 0xaa, 0xbb};
+  const std::vector<uint8_t> kRtcpPacket = {0x80, 0xc9, 0x00, 0x01};
+  const SessionConfig config = MakeSessionConfig();
+
+  {
+    ErrorOr<std::unique_ptr<PacketCaptureWriter>> writer =
+        PacketCaptureWriter::Create(path());
+    ASSERT_TRUE(writer.is_value()) << writer.error();
+    writer.value()->OnReceiverCreated(config);
+    writer.value()->OnPacketReceived(kStartTime, kRtpPacket);
+    writer.value()->OnPacketSent(kStartTime + microseconds(1500), kRtcpPacket);
+    writer.value()->OnPacketReceived(kStartTime + seconds(2), {});
+    EXPECT_EQ(3, writer.value()->num_packets_written());
+  }
+
+  ErrorOr<PacketCapture> capture = ReadPacketCapture(path());
+  ASSERT_TRUE(capture.is_value()) << capture.error();
+
+  ASSERT_EQ(1u, capture.value().session_configs.size());
+  const SessionConfig& parsed_config = capture.value().session_configs[0];
+  EXPECT_EQ(config.sender_ssrc, parsed_config.sender_ssrc);
+  EXPECT_EQ(config.receiver_ssrc, parsed_config.receiver_ssrc);
+  EXPECT_EQ(config.rtp_timebase, parsed_config.rtp_timebase);
+  EXPECT_EQ(config.channels, parsed_config.channels);
+  EXPECT_EQ(config.target_playout_delay, parsed_config.target_playout_delay);
+  EXPECT_EQ(config.aes_secret_key, parsed_config.aes_secret_key);
+  EXPECT_EQ(config.aes_iv_mask, parsed_config.aes_iv_mask);
+  EXPECT_EQ(config.is_pli_enabled, parsed_config.is_pli_enabled);
+
+  const std::vector<CapturedPacket>& packets = capture.value().packets;
+  ASSERT_EQ(3u, packets.size());
+  EXPECT_FALSE(packets[0].is_outbound);
+  EXPECT_EQ(kStartTime, packets[0].time);
+  EXPECT_EQ(kRtpPacket, packets[0].data);
+  EXPECT_TRUE(packets[1].is_outbound);
+  EXPECT_EQ(kStartTime + microseconds(1500), packets[1].time);
+  EXPECT_EQ(kRtcpPacket, packets[1].data);
+  EXPECT_FALSE(packets[2].is_outbound);
+  EXPECT_EQ(kStartTime + seconds(2), packets[2].time);
+  EXPECT_TRUE(packets[2].data.empty());
+}
+
+TEST(PacketCaptureParseTest, IgnoresTruncatedFinalRecord) {
+  std::vector<uint8_t> data(std::begin(packet_capture::kMagic),
+                            std::end(packet_capture::kMagic));
+  // A kPacketReceived record at time zero, claiming a 4-byte payload, but with
+  // only 2 bytes present.
+  const uint8_t kRecord[] = {2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 4, 0xaa, 0xbb};
+  data.insert(data.end(), std::begin(kRecord), std::end(kRecord));
+
+  ErrorOr<PacketCapture> capture = ParsePacketCapture(data);
+  ASSERT_TRUE(capture.is_value());
+  EXPECT_TRUE(capture.value().packets.empty());
+
+  // Complete the record, and now it should be parsed.
+  data.push_back(0xcc);
+  data.push_back(0xdd);
+  capture = ParsePacketCapture(data);
+  ASSERT_TRUE(capture.is_value());
+  ASSERT_EQ(1u, capture.value().packets.size());
+  EXPECT_EQ((std::vector<uint8_t>{0xaa, 0xbb, 0xcc, 0xdd}),
+            capture.value().packets[0].data);
+}
+
+TEST(PacketCaptureParseTest, RejectsMalformedInput) {
+  const uint8_t kBadMagic[] = {'N', 'O', 'T', 'A', 'C', 'A', 'P', '!'};
+  EXPECT_TRUE(ParsePacketCapture(kBadMagic).is_error());
+
+  std::vector<uint8_t> data(std::begin(packet_capture::kMagic),
+                            std::end(packet_capture::kMagic));
+  const uint8_t kUnknownRecord[] = {99, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0};
+  data.insert(data.end(), std::begin(kUnknownRecord), std::end(kUnknownRecord));
+  EXPECT_TRUE(ParsePacketCapture(data).is_error());
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
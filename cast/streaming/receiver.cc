@@ -146,10 +146,14 @@ EncodedFrame Receiver::ConsumeNextFrame(absl::Span<uint8_t> buffer) {
   OSP_DCHECK(entry.collector.is_complete());
   EncodedFrame frame;
   frame.data = buffer;
+  const Clock::time_point decrypt_start_time = now_();
   crypto_.Decrypt(entry.collector.PeekAtAssembledFrame(), &frame);
+  const Clock::time_point decrypt_end_time = now_();
   OSP_DCHECK(entry.estimated_capture_time);
   frame.reference_time =
       *entry.estimated_capture_time + ResolveTargetPlayoutDelay(frame_id);
+  frame_stats_.OnFrameConsumed(decrypt_end_time - decrypt_start_time,
+                               frame.reference_time < decrypt_end_time);
 
   RECEIVER_VLOG << "ConsumeNextFrame → " << frame.frame_id << ": "
                 << frame.data.size() << " payload bytes, RTP Timestamp "
@@ -230,9 +234,20 @@ void Receiver::OnReceivedRtpPacket(Clock::time_point arrival_time,
     return;
   }
 
+  const int num_missing_packets_before = collector.num_missing_packets();
   if (!collector.CollectRtpPacket(*part, &packet)) {
     return;  // Bad data in the parsed packet. Ignore it.
   }
+  if (collector.num_missing_packets() < num_missing_packets_before) {
+    // Not a duplicate: Track when the frame started arriving, and whether this
+    // packet was only received after it had been NACKed.
+    if (!pending_frame.first_packet_arrival_time) {
+      pending_frame.first_packet_arrival_time = arrival_time;
+    }
+    if (pending_frame.num_nacks_sent > 0) {
+      frame_stats_.OnPacketRecovered();
+    }
+  }
 
   // The first packet in a frame contains timing information critical for
   // computing this frame's (and all future frames') playout time. Process that,
@@ -267,6 +282,10 @@ void Receiver::OnReceivedRtpPacket(Clock::time_point arrival_time,
   if (!collector.is_complete()) {
     return;  // Wait for the rest of the packets to come in.
   }
+  OSP_DCHECK(pending_frame.first_packet_arrival_time);
+  frame_stats_.OnFrameCompleted(
+      arrival_time - *pending_frame.first_packet_arrival_time,
+      pending_frame.num_nacks_sent);
   const EncryptedFrame& encrypted_frame = collector.PeekAtAssembledFrame();
 
   // Whenever a key frame has been received, the decoder has what it needs to
@@ -322,6 +341,10 @@ void Receiver::OnReceivedRtcpPacket(Clock::time_point arrival_time,
   report.last_status_report_id = last_sender_report_->report_id;
   report.SetDelaySinceLastReport(now_() - last_sender_report_arrival_time_);
   rtcp_builder_.IncludeReceiverReportInNextPacket(report);
+  if (is_frame_stats_reporting_enabled_) {
+    rtcp_builder_.IncludeFrameStatsInNextPacket(
+        frame_stats_.GetRtcpFrameStats());
+  }
 
   SendRtcp();
 }
@@ -331,13 +354,17 @@ void Receiver::SendRtcp() {
   std::vector<PacketNack> packet_nacks;
   std::vector<FrameId> frame_acks;
   for (FrameId f = checkpoint_frame() + 1; f <= latest_frame_expected_; ++f) {
-    const FrameCollector& collector = GetQueueEntry(f).collector;
-    if (collector.is_complete()) {
+    PendingFrame& entry = GetQueueEntry(f);
+    if (entry.collector.is_complete()) {
       frame_acks.push_back(f);
     } else {
-      collector.GetMissingPackets(&packet_nacks);
+      const size_t num_nacks_before = packet_nacks.size();
+      entry.collector.GetMissingPackets(&packet_nacks);
+      entry.num_nacks_sent +=
+          static_cast<int>(packet_nacks.size() - num_nacks_before);
     }
   }
+  frame_stats_.OnNacksSent(static_cast<int>(packet_nacks.size()));
 
   // Build and send a compound RTCP packet.
   const bool no_nacks = packet_nacks.empty();
@@ -447,6 +474,8 @@ void Receiver::DropAllFramesBefore(FrameId first_kept_frame) {
     entry.Reset();
   }
   last_frame_consumed_ = first_kept_frame - 1;
+  frame_stats_.OnFramesDropped(
+      static_cast<int>(first_kept_frame - first_to_drop));
 
   RECEIVER_LOG(INFO) << "Artificially advancing checkpoint after skipping.";
   AdvanceCheckpoint(first_kept_frame);
@@ -473,6 +502,8 @@ Receiver::PendingFrame::~PendingFrame() = default;
 void Receiver::PendingFrame::Reset() {
   collector.Reset();
   estimated_capture_time = absl::nullopt;
+  first_packet_arrival_time = absl::nullopt;
+  num_nacks_sent = 0;
 }
 
 // static
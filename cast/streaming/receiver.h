@@ -21,6 +21,7 @@
 #include "cast/streaming/frame_collector.h"
 #include "cast/streaming/frame_id.h"
 #include "cast/streaming/packet_receive_stats_tracker.h"
+#include "cast/streaming/receiver_stats.h"
 #include "cast/streaming/rtcp_common.h"
 #include "cast/streaming/rtcp_session.h"
 #include "cast/streaming/rtp_packet_parser.h"
@@ -173,6 +174,20 @@ class Receiver {
   // portion of the buffer that was populated.
   EncodedFrame ConsumeNextFrame(absl::Span<uint8_t> buffer);
 
+  // Returns a snapshot of this Receiver's frame pipeline statistics. Unlike all
+  // other methods, this may be called from any thread.
+  ReceiverStats GetStats() const { return frame_stats_.GetStats(); }
+
+  // Sets whether a summary of the frame pipeline statistics is reported to the
+  // Sender, in a non-standard RTCP Extended Report block, each time this
+  // Receiver replies to a Sender Report. Senders not supporting this will
+  // ignore it.
+  //
+  // Default setting: false
+  void SetFrameStatsReportingEnabled(bool enabled) {
+    is_frame_stats_reporting_enabled_ = enabled;
+  }
+
   // Allows setting picture loss indication for testing. In production, this
   // should be done using the config.
   void SetPliEnabledForTesting(bool is_pli_enabled) {
@@ -207,6 +222,11 @@ class Receiver {
     // playout time.
     absl::optional<Clock::time_point> estimated_capture_time;
 
+    // When the first packet of this frame arrived, and how many packet NACKs
+    // have been sent to the Sender for it so far. Used for |frame_stats_|.
+    absl::optional<Clock::time_point> first_packet_arrival_time;
+    int num_nacks_sent = 0;
+
     PendingFrame();
     ~PendingFrame();
 
@@ -273,6 +293,7 @@ class Receiver {
   const int rtp_timebase_;    // RTP timestamp ticks per second.
   const FrameCrypto crypto_;  // Decrypts assembled frames.
   bool is_pli_enabled_;       // Whether picture loss indication is enabled.
+  bool is_frame_stats_reporting_enabled_ = false;
 
   // Buffer for serializing/sending RTCP packets.
   const int rtcp_buffer_capacity_;
@@ -343,6 +364,9 @@ class Receiver {
   // notify the Consumer via OnFramesReady().
   Alarm consumption_alarm_;
 
+  // Tracks the frame pipeline statistics, which may be read from any thread.
+  ReceiverStatsTracker frame_stats_;
+
   // The interval between sending ACK/NACK feedback RTCP messages while
   // incomplete frames exist in the queue.
   //
@@ -25,36 +25,113 @@ EnumNameTable<ReceiverMessage::Type, 5> kMessageTypeNames{
     {{kMessageTypeAnswer, ReceiverMessage::Type::kAnswer},
      {"STATUS_RESPONSE", ReceiverMessage::Type::kStatusResponse},
      {"CAPABILITIES_RESPONSE", ReceiverMessage::Type::kCapabilitiesResponse},
-     {"RPC", ReceiverMessage::Type::kRpc}}};
-
-ReceiverMessage::Type GetMessageType(const Json::Value& root) {
-  std::string type;
-  if (!json::ParseAndValidateString(root[kMessageType], &type)) {
-    return ReceiverMessage::Type::kUnknown;
-  }
+     {"RPC", ReceiverMessage::Type::kRpc},
+     {kMessageTypeResumeResponse, ReceiverMessage::Type::kResumeResponse}}};
 
+ReceiverMessage::Type GetMessageTypeFromName(std::string type) {
   absl::AsciiStrToUpper(&type);
   ErrorOr<ReceiverMessage::Type> parsed = GetEnum(kMessageTypeNames, type);
 
   return parsed.value(ReceiverMessage::Type::kUnknown);
 }
 
-}  // namespace
+// The following read each body type for ReceiverMessage::ParseFromString(),
+// and also implement the Parse() method of each (see ParseBody()). Each
+// consumes the next value, and returns whether it was a valid body.
+bool ReadReceiverError(json::JsonReader* reader, ReceiverError* out) {
+  if (reader->PeekType() != json::JsonReader::ValueType::kObject) {
+    reader->SkipValue();
+    return false;
+  }
 
-// static
-ErrorOr<ReceiverError> ReceiverError::Parse(const Json::Value& value) {
+  bool has_code = false;
+  bool has_description = false;
+  reader->BeginObject();
+  absl::string_view key;
+  while (reader->NextMember(&key)) {
+    if (key == kErrorCode) {
+      has_code = json::ReadAndValidateInt(reader, &out->code);
+    } else if (key == kErrorDescription) {
+      has_description = json::ReadAndValidateString(reader, &out->description);
+    } else {
+      reader->SkipValue();
+    }
+  }
+  return has_code && has_description;
+}
+
+bool ReadReceiverCapability(json::JsonReader* reader, ReceiverCapability* out) {
+  if (reader->PeekType() != json::JsonReader::ValueType::kObject) {
+    reader->SkipValue();
+    return false;
+  }
+
+  bool has_media_capabilities = false;
+  reader->BeginObject();
+  absl::string_view key;
+  while (reader->NextMember(&key)) {
+    if (key == "remoting") {
+      if (!json::ReadAndValidateInt(reader, &out->remoting_version)) {
+        out->remoting_version = ReceiverCapability::kRemotingVersionUnknown;
+      }
+    } else if (key == "mediaCaps") {
+      has_media_capabilities =
+          json::ReadAndValidateStringArray(reader, &out->media_capabilities);
+    } else {
+      reader->SkipValue();
+    }
+  }
+  return has_media_capabilities;
+}
+
+bool ReadReceiverWifiStatus(json::JsonReader* reader, ReceiverWifiStatus* out) {
+  if (reader->PeekType() != json::JsonReader::ValueType::kObject) {
+    reader->SkipValue();
+    return false;
+  }
+
+  bool has_wifi_snr = false;
+  bool has_wifi_speed = false;
+  reader->BeginObject();
+  absl::string_view key;
+  while (reader->NextMember(&key)) {
+    if (key == "wifiSnr") {
+      has_wifi_snr = json::ReadAndValidateDouble(reader, &out->wifi_snr, true);
+    } else if (key == "wifiSpeed") {
+      has_wifi_speed = json::ReadAndValidateIntArray(reader, &out->wifi_speed);
+    } else {
+      reader->SkipValue();
+    }
+  }
+  return has_wifi_snr && has_wifi_speed;
+}
+
+template <typename T>
+ErrorOr<T> ParseBody(const Json::Value& value, json::Reader<T> read) {
   if (!value) {
     return Error(Error::Code::kParameterInvalid,
-                 "Empty JSON in receiver error parsing");
+                 "Empty JSON in receiver message body parsing");
   }
 
-  int code;
-  std::string description;
-  if (!json::ParseAndValidateInt(value[kErrorCode], &code) ||
-      !json::ParseAndValidateString(value[kErrorDescription], &description)) {
+  const ErrorOr<std::string> document =
+      value.isObject() ? json::Stringify(value)
+                       : ErrorOr<std::string>(Error::Code::kJsonParseError);
+  if (document.is_error()) {
     return Error::Code::kJsonParseError;
   }
-  return ReceiverError{code, description};
+  json::JsonReader reader(document.value());
+  T out;
+  if (!read(&reader, &out) || !reader.Finish()) {
+    return Error::Code::kJsonParseError;
+  }
+  return out;
+}
+
+}  // namespace
+
+// static
+ErrorOr<ReceiverError> ReceiverError::Parse(const Json::Value& value) {
+  return ParseBody<ReceiverError>(value, ReadReceiverError);
 }
 
 Json::Value ReceiverError::ToJson() const {
@@ -67,24 +144,7 @@ Json::Value ReceiverError::ToJson() const {
 // static
 ErrorOr<ReceiverCapability> ReceiverCapability::Parse(
     const Json::Value& value) {
-  if (!value) {
-    return Error(Error::Code::kParameterInvalid,
-                 "Empty JSON in capabilities parsing");
-  }
-
-  int remoting_version;
-  if (!json::ParseAndValidateInt(value["remoting"], &remoting_version)) {
-    remoting_version = ReceiverCapability::kRemotingVersionUnknown;
-  }
-
-  std::vector<std::string> media_capabilities;
-  if (!json::ParseAndValidateStringArray(value["mediaCaps"],
-                                         &media_capabilities)) {
-    return Error(Error::Code::kJsonParseError,
-                 "Failed to parse media capabilities");
-  }
-
-  return ReceiverCapability{remoting_version, std::move(media_capabilities)};
+  return ParseBody<ReceiverCapability>(value, ReadReceiverCapability);
 }
 
 Json::Value ReceiverCapability::ToJson() const {
@@ -101,18 +161,7 @@ Json::Value ReceiverCapability::ToJson() const {
 // static
 ErrorOr<ReceiverWifiStatus> ReceiverWifiStatus::Parse(
     const Json::Value& value) {
-  if (!value) {
-    return Error(Error::Code::kParameterInvalid,
-                 "Empty JSON in status parsing");
-  }
-
-  double wifi_snr;
-  std::vector<int32_t> wifi_speed;
-  if (!json::ParseAndValidateDouble(value["wifiSnr"], &wifi_snr, true) ||
-      !json::ParseAndValidateIntArray(value["wifiSpeed"], &wifi_speed)) {
-    return Error::Code::kJsonParseError;
-  }
-  return ReceiverWifiStatus{wifi_snr, std::move(wifi_speed)};
+  return ParseBody<ReceiverWifiStatus>(value, ReadReceiverWifiStatus);
 }
 
 Json::Value ReceiverWifiStatus::ToJson() const {
@@ -128,66 +177,116 @@ Json::Value ReceiverWifiStatus::ToJson() const {
 
 // static
 ErrorOr<ReceiverMessage> ReceiverMessage::Parse(const Json::Value& value) {
-  ReceiverMessage message;
-  if (!value || !json::ParseAndValidateInt(value[kSequenceNumber],
-                                           &(message.sequence_number))) {
-    return Error(Error::Code::kJsonParseError,
-                 "Failed to parse sequence number");
+  const Error kNoSequenceNumber(Error::Code::kJsonParseError,
+                                "Failed to parse sequence number");
+  if (!value.isObject() || value.empty()) {
+    return kNoSequenceNumber;
   }
 
-  std::string result;
-  if (!json::ParseAndValidateString(value[kResult], &result)) {
-    result = kResultError;
+  const ErrorOr<std::string> document = json::Stringify(value);
+  if (document.is_error()) {
+    return document.error();
+  }
+  ErrorOr<ReceiverMessage> message = ParseFromString(document.value());
+  if (message.is_value() && message.value().sequence_number < 0) {
+    return kNoSequenceNumber;
   }
+  return message;
+}
 
-  message.type = GetMessageType(value);
+// static
+ErrorOr<ReceiverMessage> ReceiverMessage::ParseFromString(
+    absl::string_view document) {
+  ReceiverMessage message;
+  std::string type;
+  std::string result = kResultError;
+
+  // The type may well come after the body, so every body is read into its own
+  // struct, and the one matching the type is picked at the end.
+  Answer answer;
+  ReceiverWifiStatus status;
+  ReceiverCapability capability;
+  std::string rpc;
+  ReceiverError error;
+  bool has_answer = false;
+  bool has_status = false;
+  bool has_capability = false;
+  bool has_rpc = false;
+  bool has_error = false;
+
+  json::JsonReader reader(document);
+  if (reader.BeginObject()) {
+    absl::string_view key;
+    while (reader.NextMember(&key)) {
+      if (key == kMessageType) {
+        if (!json::ReadAndValidateString(&reader, &type)) {
+          type.clear();
+        }
+      } else if (key == kSequenceNumber) {
+        if (!json::ReadAndValidateInt(&reader, &message.sequence_number)) {
+          message.sequence_number = -1;
+        }
+      } else if (key == kResult) {
+        if (!json::ReadAndValidateString(&reader, &result)) {
+          result = kResultError;
+        }
+      } else if (key == kAnswerMessageBody) {
+        has_answer = Answer::Read(&reader, &answer);
+      } else if (key == kStatusMessageBody) {
+        has_status = ReadReceiverWifiStatus(&reader, &status);
+      } else if (key == kCapabilitiesMessageBody) {
+        has_capability = ReadReceiverCapability(&reader, &capability);
+      } else if (key == kRpcMessageBody) {
+        has_rpc = json::ReadAndValidateString(&reader, &rpc);
+      } else if (key == kErrorMessageBody) {
+        has_error = ReadReceiverError(&reader, &error);
+      } else {
+        reader.SkipValue();
+      }
+    }
+  }
+  if (!reader.Finish()) {
+    return Error(Error::Code::kJsonParseError, "Invalid JSON");
+  }
+
+  message.type = GetMessageTypeFromName(std::move(type));
   message.valid =
       (result == kResultOk || message.type == ReceiverMessage::Type::kRpc);
   if (!message.valid) {
-    ErrorOr<ReceiverError> error =
-        ReceiverError::Parse(value[kErrorMessageBody]);
-    if (error.is_value()) {
-      message.body = std::move(error.value());
+    if (has_error) {
+      message.body = std::move(error);
     }
     return message;
   }
 
   switch (message.type) {
-    case Type::kAnswer: {
-      Answer answer;
-      if (openscreen::cast::Answer::ParseAndValidate(value[kAnswerMessageBody],
-                                                     &answer)) {
+    case Type::kAnswer:
+      if (has_answer) {
         message.body = std::move(answer);
-        message.valid = true;
       }
-    } break;
-
-    case Type::kStatusResponse: {
-      ErrorOr<ReceiverWifiStatus> status =
-          ReceiverWifiStatus::Parse(value[kStatusMessageBody]);
-      if (status.is_value()) {
-        message.body = std::move(status.value());
-        message.valid = true;
+      break;
+
+    case Type::kStatusResponse:
+      if (has_status) {
+        message.body = std::move(status);
       }
-    } break;
-
-    case Type::kCapabilitiesResponse: {
-      ErrorOr<ReceiverCapability> capability =
-          ReceiverCapability::Parse(value[kCapabilitiesMessageBody]);
-      if (capability.is_value()) {
-        message.body = std::move(capability.value());
-        message.valid = true;
+      break;
+
+    case Type::kCapabilitiesResponse:
+      if (has_capability) {
+        message.body = std::move(capability);
       }
-    } break;
+      break;
 
-    case Type::kRpc: {
-      std::string rpc;
-      if (json::ParseAndValidateString(value[kRpcMessageBody], &rpc) &&
-          base64::Decode(rpc, &rpc)) {
+    case Type::kRpc:
+      if (has_rpc && base64::Decode(rpc, &rpc)) {
         message.body = std::move(rpc);
-        message.valid = true;
       }
-    } break;
+      break;
+
+    case Type::kResumeResponse:
+      // The result is all there is to this message.
+      break;
 
     case Type::kUnknown:
     default:
@@ -230,6 +329,15 @@ ErrorOr<Json::Value> ReceiverMessage::ToJson() const {
           absl::get<ReceiverCapability>(body).ToJson();
       break;
 
+    case ReceiverMessage::Type::kResumeResponse:
+      if (valid) {
+        root[kResult] = kResultOk;
+      } else {
+        root[kResult] = kResultError;
+        root[kErrorMessageBody] = absl::get<ReceiverError>(body).ToJson();
+      }
+      break;
+
     // NOTE: RPC messages do NOT have a result field.
     case ReceiverMessage::Type::kRpc:
       root[kRpcMessageBody] = base64::Encode(absl::get<std::string>(body));
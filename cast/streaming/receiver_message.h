@@ -9,6 +9,7 @@
 #include <string>
 #include <vector>
 
+#include "absl/strings/string_view.h"
 #include "absl/types/variant.h"
 #include "cast/streaming/answer_messages.h"
 #include "json/value.h"
@@ -71,11 +72,23 @@ struct ReceiverMessage {
 
     // Rpc binary messages. The payload is base64-encoded.
     kRpc,
+
+    // Response to RESUME message. Has no body, only a result (and an error,
+    // if the streams could not be resumed).
+    kResumeResponse,
   };
 
+  // Same as ParseFromString(json::Stringify(value)), except that a message
+  // without a valid sequence number is an error.
   static ErrorOr<ReceiverMessage> Parse(const Json::Value& value);
   ErrorOr<Json::Value> ToJson() const;
 
+  // Reads the message straight from |document|, without building a
+  // Json::Value. The only error is invalid JSON, or a document that is not an
+  // object: a message without a valid sequence number is returned with a
+  // |sequence_number| of -1.
+  static ErrorOr<ReceiverMessage> ParseFromString(absl::string_view document);
+
   Type type = Type::kUnknown;
 
   int32_t sequence_number = -1;
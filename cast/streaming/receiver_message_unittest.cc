@@ -0,0 +1,174 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/receiver_message.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "util/json/json_serialization.h"
+
+namespace openscreen {
+namespace cast {
+
+namespace {
+
+using ::testing::ElementsAre;
+
+// Parses |document| both ways, checks that the results match, and returns the
+// streaming one.
+ReceiverMessage ParseBothWays(const std::string& document) {
+  ErrorOr<Json::Value> root = json::Parse(document);
+  EXPECT_TRUE(root.is_value());
+  ErrorOr<ReceiverMessage> expected = ReceiverMessage::Parse(root.value());
+  EXPECT_TRUE(expected.is_value());
+  ErrorOr<ReceiverMessage> actual = ReceiverMessage::ParseFromString(document);
+  EXPECT_TRUE(actual.is_value());
+  if (expected.is_error() || actual.is_error()) {
+    return {};
+  }
+
+  EXPECT_EQ(expected.value().type, actual.value().type);
+  EXPECT_EQ(expected.value().sequence_number, actual.value().sequence_number);
+  EXPECT_EQ(expected.value().valid, actual.value().valid);
+  EXPECT_EQ(expected.value().body.index(), actual.value().body.index());
+  return std::move(actual.value());
+}
+
+}  // namespace
+
+TEST(ReceiverMessageTest, ParsesAnswer) {
+  const ReceiverMessage message = ParseBothWays(R"({
+    "seqNum": 820263768,
+    "type": "ANSWER",
+    "result": "ok",
+    "answer": {
+      "castMode": "mirroring",
+      "udpPort": 1234,
+      "sendIndexes": [1, 3],
+      "ssrcs": [1233324, 2234222]
+    }
+  })");
+  ASSERT_EQ(ReceiverMessage::Type::kAnswer, message.type);
+  EXPECT_EQ(820263768, message.sequence_number);
+  EXPECT_TRUE(message.valid);
+  const Answer& answer = absl::get<Answer>(message.body);
+  EXPECT_EQ(1234, answer.udp_port);
+  EXPECT_THAT(answer.send_indexes, ElementsAre(1, 3));
+}
+
+TEST(ReceiverMessageTest, ParsesErrorAnswer) {
+  const ReceiverMessage message = ParseBothWays(R"({
+    "error": {"code": 123, "description": "something bad happened"},
+    "result": "error",
+    "type": "answer",
+    "seqNum": 3
+  })");
+  EXPECT_EQ(ReceiverMessage::Type::kAnswer, message.type);
+  EXPECT_FALSE(message.valid);
+  const ReceiverError& error = absl::get<ReceiverError>(message.body);
+  EXPECT_EQ(123, error.code);
+  EXPECT_EQ("something bad happened", error.description);
+}
+
+TEST(ReceiverMessageTest, ParsesStatusResponse) {
+  // The body comes before the type.
+  const ReceiverMessage message = ParseBothWays(R"({
+    "seqNum": 820263769,
+    "status": {
+      "wifiSnr": -13.5,
+      "wifiSpeed": [100000, 650000000, 43000000, 48000000]
+    },
+    "result": "ok",
+    "type": "STATUS_RESPONSE"
+  })");
+  ASSERT_EQ(ReceiverMessage::Type::kStatusResponse, message.type);
+  const ReceiverWifiStatus& status =
+      absl::get<ReceiverWifiStatus>(message.body);
+  EXPECT_EQ(-13.5, status.wifi_snr);
+  EXPECT_THAT(status.wifi_speed,
+              ElementsAre(100000, 650000000, 43000000, 48000000));
+}
+
+TEST(ReceiverMessageTest, ParsesCapabilitiesResponse) {
+  const ReceiverMessage message = ParseBothWays(R"({
+    "capabilities": {
+      "keySystems": [],
+      "mediaCaps": ["video", "h264", "opus"],
+      "remoting": 2
+    },
+    "result": "ok",
+    "seqNum": 820263770,
+    "type": "CAPABILITIES_RESPONSE"
+  })");
+  ASSERT_EQ(ReceiverMessage::Type::kCapabilitiesResponse, message.type);
+  const ReceiverCapability& capability =
+      absl::get<ReceiverCapability>(message.body);
+  EXPECT_EQ(2, capability.remoting_version);
+  EXPECT_THAT(capability.media_capabilities,
+              ElementsAre("video", "h264", "opus"));
+}
+
+TEST(ReceiverMessageTest, ParsesRpc) {
+  const ReceiverMessage message = ParseBothWays(R"({
+    "seqNum": 12345,
+    "sessionId": 735189,
+    "type": "RPC",
+    "rpc": "SGVsbG8gZnJvbSB0aGUgQ2FzdCBSZWNlaXZlciE="
+  })");
+  ASSERT_EQ(ReceiverMessage::Type::kRpc, message.type);
+  EXPECT_TRUE(message.valid);
+  EXPECT_EQ("Hello from the Cast Receiver!",
+            absl::get<std::string>(message.body));
+}
+
+TEST(ReceiverMessageTest, MatchesParseForInvalidBodies) {
+  const std::string kDocuments[] = {
+      R"({"seqNum": 1, "type": "STATUS_RESPONSE", "result": "ok",
+          "status": {"wifiSnr": 1, "wifiSpeed": []}})",
+      R"({"seqNum": 1, "type": "STATUS_RESPONSE", "result": "ok",
+          "status": {"wifiSpeed": [1, -2]}})",
+      R"({"seqNum": 1, "type": "CAPABILITIES_RESPONSE", "result": "ok",
+          "capabilities": {"mediaCaps": "video", "remoting": -1}})",
+      R"({"seqNum": 1, "type": "ANSWER", "result": "ok",
+          "answer": {"castMode": "mirroring"}})",
+      R"({"seqNum": 1, "type": "ANSWER", "result": 42})",
+      R"({"seqNum": 1, "type": "ANSWER", "error": {"code": -1}})",
+      R"({"seqNum": 1, "type": "RPC", "rpc": "not base64!"})",
+      R"({"seqNum": 1, "type": "RESUME_RESPONSE", "result": "ok"})",
+      R"({"seqNum": 1, "type": "BOGUS", "result": "ok"})",
+      R"({"seqNum": 1, "type": 7, "result": "ok"})",
+  };
+  for (const std::string& document : kDocuments) {
+    SCOPED_TRACE(document);
+    ParseBothWays(document);
+  }
+}
+
+TEST(ReceiverMessageTest, ParseFromStringAllowsMissingSequenceNumber) {
+  for (const char* document :
+       {R"({"type": "RPC", "rpc": "SGk="})",
+        R"({"seqNum": -5, "type": "RPC", "rpc": "SGk="})",
+        R"({"seqNum": "1", "type": "RPC", "rpc": "SGk="})"}) {
+    ErrorOr<ReceiverMessage> message =
+        ReceiverMessage::ParseFromString(document);
+    ASSERT_TRUE(message.is_value()) << document;
+    EXPECT_EQ(-1, message.value().sequence_number) << document;
+    EXPECT_EQ(ReceiverMessage::Type::kRpc, message.value().type) << document;
+  }
+}
+
+TEST(ReceiverMessageTest, ParseFromStringRejectsInvalidJson) {
+  for (const char* document :
+       {"", "{", "[]", R"({"seqNum": 1,})", R"({"seqNum": 1} trailing)"}) {
+    ErrorOr<ReceiverMessage> message =
+        ReceiverMessage::ParseFromString(document);
+    ASSERT_TRUE(message.is_error()) << document;
+    EXPECT_EQ(Error::Code::kJsonParseError, message.error().code());
+  }
+}
+
+}  // namespace cast
+}  // namespace openscreen
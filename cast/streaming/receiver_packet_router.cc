@@ -27,6 +27,10 @@ void ReceiverPacketRouter::OnReceiverCreated(Ssrc sender_ssrc,
                                              Receiver* receiver) {
   OSP_DCHECK(receivers_.find(sender_ssrc) == receivers_.end());
   receivers_.emplace_back(sender_ssrc, receiver);
+  if (Environment::PacketObserver* observer =
+          environment_->packet_observer()) {
+    observer->OnReceiverCreated(receiver->config());
+  }
 
   // If there were no Receiver instances before, resume receiving packets for
   // dispatch. Reset/Clear the remote endpoint, in preparation for later setting
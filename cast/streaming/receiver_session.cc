@@ -46,6 +46,21 @@ std::unique_ptr<Stream> SelectStream(
   return nullptr;
 }
 
+// Returns the stream in |offered_streams| that resumes the |selected_stream|,
+// or nullptr if there is none.
+template <typename Stream>
+const Stream* FindResumedStream(const Stream& selected_stream,
+                                const std::vector<Stream>& offered_streams) {
+  for (const Stream& offered_stream : offered_streams) {
+    if (offered_stream.stream.index == selected_stream.stream.index &&
+        offered_stream.stream.ssrc == selected_stream.stream.ssrc &&
+        offered_stream.codec == selected_stream.codec) {
+      return &offered_stream;
+    }
+  }
+  return nullptr;
+}
+
 DisplayResolution ToDisplayResolution(const Resolution& resolution) {
   return DisplayResolution{resolution.width, resolution.height};
 }
@@ -85,6 +100,25 @@ ReceiverSession::ReceiverSession(Client* const client,
                   OSP_DLOG_WARN << "Got a session messager error: " << error;
                   client_->OnError(this, error);
                 }),
+      rpc_channel_(
+          environment->task_runner(),
+          [this](absl::Span<const uint8_t> batch) {
+            return messager_.SendBinaryRpcBatch(batch);
+          },
+          [this](std::vector<uint8_t> message) {
+            const Error error = messager_.SendMessage(ReceiverMessage{
+                ReceiverMessage::Type::kRpc, ++rpc_sequence_number_, true,
+                std::string(message.begin(), message.end())});
+            if (!error.ok()) {
+              OSP_DLOG_WARN << "Failed to send RPC message: " << error;
+            }
+          },
+          [this](const RpcMessageBatch& batch) {
+            rpc_broker_.ProcessBatchFromRemote(batch);
+          }),
+      rpc_broker_([this](std::vector<uint8_t> message) {
+        rpc_channel_.SendMessage(std::move(message));
+      }),
       packet_router_(environment_) {
   OSP_DCHECK(client_);
   OSP_DCHECK(environment_);
@@ -92,6 +126,18 @@ ReceiverSession::ReceiverSession(Client* const client,
   messager_.SetHandler(
       SenderMessage::Type::kOffer,
       [this](SenderMessage message) { OnOffer(std::move(message)); });
+  messager_.SetHandler(
+      SenderMessage::Type::kResume,
+      [this](SenderMessage message) { OnResume(std::move(message)); });
+  messager_.SetHandler(
+      SenderMessage::Type::kRpc,
+      [this](SenderMessage message) { OnRpcMessage(std::move(message)); });
+  messager_.SetBinaryRpcHandler([this](absl::Span<const uint8_t> batch) {
+    const Error error = rpc_channel_.ProcessBatchFromRemote(batch);
+    if (!error.ok()) {
+      OSP_DLOG_WARN << "Received an invalid RPC batch: " << error;
+    }
+  });
   environment_->SetSocketSubscriber(this);
 }
 
@@ -101,15 +147,15 @@ ReceiverSession::~ReceiverSession() {
 
 void ReceiverSession::OnSocketReady() {
   if (pending_session_) {
-    InitializeSession(*pending_session_);
-    pending_session_.reset();
+    InitializeSession(std::move(pending_session_));
   }
 }
 
 void ReceiverSession::OnSocketInvalid(Error error) {
   if (pending_session_) {
-    SendErrorAnswerReply(pending_session_->sequence_number,
-                         "Failed to bind UDP socket");
+    SendErrorReply(ReceiverMessage::Type::kAnswer,
+                   pending_session_->sequence_number,
+                   "Failed to bind UDP socket");
     pending_session_.reset();
   }
 
@@ -132,9 +178,12 @@ void ReceiverSession::OnOffer(SenderMessage message) {
     return;
   }
 
+  // Any new OFFER replaces the session that could have been resumed.
+  current_session_.reset();
+
   if (!message.valid) {
-    SendErrorAnswerReply(message.sequence_number,
-                         "Failed to parse malformed OFFER");
+    SendErrorReply(ReceiverMessage::Type::kAnswer, message.sequence_number,
+                   "Failed to parse malformed OFFER");
     client_->OnError(this, Error(Error::Code::kParameterInvalid,
                                  "Received invalid OFFER message"));
     return;
@@ -144,6 +193,7 @@ void ReceiverSession::OnOffer(SenderMessage message) {
   properties->sequence_number = message.sequence_number;
 
   const Offer& offer = absl::get<Offer>(message.body);
+  properties->supports_binary_rpc = offer.supports_binary_rpc;
   if (!offer.audio_streams.empty() && !preferences_.audio_codecs.empty()) {
     properties->selected_audio =
         SelectStream(preferences_.audio_codecs, offer.audio_streams);
@@ -155,8 +205,8 @@ void ReceiverSession::OnOffer(SenderMessage message) {
   }
 
   if (!properties->IsValid()) {
-    SendErrorAnswerReply(message.sequence_number,
-                         "Failed to select any streams from OFFER");
+    SendErrorReply(ReceiverMessage::Type::kAnswer, message.sequence_number,
+                   "Failed to select any streams from OFFER");
     return;
   }
 
@@ -164,12 +214,12 @@ void ReceiverSession::OnOffer(SenderMessage message) {
     // If the environment is ready or in a bad state, we can respond
     // immediately.
     case Environment::SocketState::kInvalid:
-      SendErrorAnswerReply(message.sequence_number,
-                           "UDP socket is closed, likely due to a bind error.");
+      SendErrorReply(ReceiverMessage::Type::kAnswer, message.sequence_number,
+                     "UDP socket is closed, likely due to a bind error.");
       break;
 
     case Environment::SocketState::kReady:
-      InitializeSession(*properties);
+      InitializeSession(std::move(properties));
       break;
 
     // Else we need to store the properties we just created until we get a
@@ -180,25 +230,111 @@ void ReceiverSession::OnOffer(SenderMessage message) {
   }
 }
 
-void ReceiverSession::InitializeSession(const SessionProperties& properties) {
-  Answer answer = ConstructAnswer(properties);
+void ReceiverSession::OnResume(SenderMessage message) {
+  if (message.sequence_number < 0) {
+    OSP_DLOG_WARN
+        << "Dropping resume with missing sequence number, can't respond";
+    return;
+  }
+
+  // The sender falls back to a full renegotiation if the session can't be
+  // resumed, so errors here are not reported to the client.
+  if (!message.valid) {
+    SendErrorReply(ReceiverMessage::Type::kResumeResponse,
+                   message.sequence_number, "Failed to parse malformed RESUME");
+    return;
+  }
+  if (!current_session_ || pending_session_ ||
+      environment_->socket_state() != Environment::SocketState::kReady) {
+    SendErrorReply(ReceiverMessage::Type::kResumeResponse,
+                   message.sequence_number, "No session to resume");
+    return;
+  }
+
+  // Every selected stream must be resumed, or none of them are.
+  const Offer& offer = absl::get<Offer>(message.body);
+  const AudioStream* resumed_audio = nullptr;
+  if (current_session_->selected_audio) {
+    resumed_audio = FindResumedStream(*current_session_->selected_audio,
+                                      offer.audio_streams);
+  }
+  const VideoStream* resumed_video = nullptr;
+  if (current_session_->selected_video) {
+    resumed_video = FindResumedStream(*current_session_->selected_video,
+                                      offer.video_streams);
+  }
+  if (!!resumed_audio != !!current_session_->selected_audio ||
+      !!resumed_video != !!current_session_->selected_video) {
+    SendErrorReply(ReceiverMessage::Type::kResumeResponse,
+                   message.sequence_number,
+                   "RESUME does not match the current session");
+    return;
+  }
+
+  if (resumed_audio) {
+    current_session_->selected_audio->stream.aes_key =
+        resumed_audio->stream.aes_key;
+    current_session_->selected_audio->stream.aes_iv_mask =
+        resumed_audio->stream.aes_iv_mask;
+  }
+  if (resumed_video) {
+    current_session_->selected_video->stream.aes_key =
+        resumed_video->stream.aes_key;
+    current_session_->selected_video->stream.aes_iv_mask =
+        resumed_video->stream.aes_iv_mask;
+  }
+  current_session_->sequence_number = message.sequence_number;
+
+  ConfiguredReceivers receivers = SpawnReceivers(*current_session_);
+  client_->OnMirroringNegotiated(this, std::move(receivers));
+  const Error result = messager_.SendMessage(
+      ReceiverMessage{ReceiverMessage::Type::kResumeResponse,
+                      message.sequence_number, true /* valid */});
+  if (!result.ok()) {
+    client_->OnError(this, std::move(result));
+  }
+}
+
+void ReceiverSession::OnRpcMessage(SenderMessage message) {
+  if (!message.valid) {
+    OSP_DLOG_WARN << "Received an invalid RPC message";
+    return;
+  }
+  RpcMessage rpc;
+  if (!rpc.ParseFromString(absl::get<std::string>(message.body))) {
+    OSP_DLOG_WARN << "Failed to parse RPC message from sender";
+    return;
+  }
+  rpc_broker_.ProcessMessageFromRemote(rpc);
+}
+
+void ReceiverSession::InitializeSession(
+    std::unique_ptr<SessionProperties> properties) {
+  Answer answer = ConstructAnswer(*properties);
   if (!answer.IsValid()) {
     // If the answer message is invalid, there is no point in setting up a
     // negotiation because the sender won't be able to connect to it.
-    SendErrorAnswerReply(properties.sequence_number,
-                         "Failed to construct an ANSWER message");
+    SendErrorReply(ReceiverMessage::Type::kAnswer, properties->sequence_number,
+                   "Failed to construct an ANSWER message");
     return;
   }
 
   // Only spawn receivers if we know we have a valid answer message.
-  ConfiguredReceivers receivers = SpawnReceivers(properties);
+  ConfiguredReceivers receivers = SpawnReceivers(*properties);
   client_->OnMirroringNegotiated(this, std::move(receivers));
+  const bool use_binary_rpc = answer.supports_binary_rpc;
   const Error result = messager_.SendMessage(ReceiverMessage{
-      ReceiverMessage::Type::kAnswer, properties.sequence_number,
+      ReceiverMessage::Type::kAnswer, properties->sequence_number,
       true /* valid */, std::move(answer)});
   if (!result.ok()) {
     client_->OnError(this, std::move(result));
+    return;
+  }
+  // The ANSWER only advertises binary RPC messages if the OFFER did too.
+  if (use_binary_rpc) {
+    rpc_channel_.EnableBinaryMessages();
   }
+  current_session_ = std::move(properties);
 }
 
 std::unique_ptr<Receiver> ReceiverSession::ConstructReceiver(
@@ -285,7 +421,7 @@ Answer ReceiverSession::ConstructAnswer(const SessionProperties& properties) {
         absl::optional<DisplayDescription>(*preferences_.display_description);
   }
 
-  return Answer{environment_->GetBoundLocalEndpoint().port,
+  Answer answer{environment_->GetBoundLocalEndpoint().port,
                 std::move(stream_indexes),
                 std::move(stream_ssrcs),
                 std::move(constraints),
@@ -293,14 +429,18 @@ Answer ReceiverSession::ConstructAnswer(const SessionProperties& properties) {
                 std::vector<int>{},  // receiver_rtcp_event_log
                 std::vector<int>{},  // receiver_rtcp_dscp
                 supports_wifi_status_reporting_};
+  answer.supports_binary_rpc =
+      properties.supports_binary_rpc && messager_.SupportsBinaryMessages();
+  return answer;
 }
 
-void ReceiverSession::SendErrorAnswerReply(int sequence_number,
-                                           const char* message) {
+void ReceiverSession::SendErrorReply(ReceiverMessage::Type type,
+                                     int sequence_number,
+                                     const char* message) {
   const Error error(Error::Code::kParseError, message);
   OSP_DLOG_WARN << message;
   const Error result = messager_.SendMessage(ReceiverMessage{
-      ReceiverMessage::Type::kAnswer, sequence_number, false /* valid */,
+      type, sequence_number, false /* valid */,
       ReceiverError{static_cast<int>(Error::Code::kParseError), message}});
   if (!result.ok()) {
     client_->OnError(this, std::move(result));
@@ -12,9 +12,11 @@
 
 #include "cast/common/public/message_port.h"
 #include "cast/streaming/answer_messages.h"
+#include "cast/streaming/binary_rpc_channel.h"
 #include "cast/streaming/capture_configs.h"
 #include "cast/streaming/offer_messages.h"
 #include "cast/streaming/receiver_packet_router.h"
+#include "cast/streaming/rpc_broker.h"
 #include "cast/streaming/sender_message.h"
 #include "cast/streaming/session_config.h"
 #include "cast/streaming/session_messager.h"
@@ -58,7 +60,8 @@ class ReceiverSession final : public Environment::SocketSubscriber {
     enum ReceiversDestroyingReason { kEndOfSession, kRenegotiated };
 
     // Called when a new set of receivers has been negotiated. This may be
-    // called multiple times during a session, as renegotiations occur.
+    // called multiple times during a session, as renegotiations occur, or as
+    // the sender resumes the session with fresh crypto parameters.
     virtual void OnMirroringNegotiated(const ReceiverSession* session,
                                        ConfiguredReceivers receivers) = 0;
 
@@ -117,6 +120,11 @@ class ReceiverSession final : public Environment::SocketSubscriber {
 
   const std::string& session_id() const { return session_id_; }
 
+  // The broker for RPC messages exchanged with the sender, e.g. for remoting.
+  // They are sent as batches of binary payloads if both sides advertised
+  // support in the OFFER/ANSWER exchange, and as JSON RPC messages otherwise.
+  RpcBroker* rpc_broker() { return &rpc_broker_; }
+
   // Environment::SocketSubscriber event callbacks.
   void OnSocketReady() override;
   void OnSocketInvalid(Error error) override;
@@ -127,6 +135,9 @@ class ReceiverSession final : public Environment::SocketSubscriber {
     std::unique_ptr<VideoStream> selected_video;
     int sequence_number;
 
+    // Whether the sender advertised support for binary RPC messages.
+    bool supports_binary_rpc = false;
+
     // To be valid either the audio or video must be selected, and we must
     // have a sequence number we can reference.
     bool IsValid() const;
@@ -134,10 +145,13 @@ class ReceiverSession final : public Environment::SocketSubscriber {
 
   // Specific message type handler methods.
   void OnOffer(SenderMessage message);
+  void OnResume(SenderMessage message);
+  void OnRpcMessage(SenderMessage message);
 
   // Creates receivers and sends an appropriate Answer message using the
-  // session properties.
-  void InitializeSession(const SessionProperties& properties);
+  // session properties. On success, the properties are kept in case the sender
+  // later resumes the session.
+  void InitializeSession(std::unique_ptr<SessionProperties> properties);
 
   // Used by SpawnReceivers to generate a receiver for a specific stream.
   std::unique_ptr<Receiver> ConstructReceiver(const Stream& stream);
@@ -152,8 +166,11 @@ class ReceiverSession final : public Environment::SocketSubscriber {
   // Handles resetting receivers and notifying the client.
   void ResetReceivers(Client::ReceiversDestroyingReason reason);
 
-  // Sends an error answer reply and notifies the client of the error.
-  void SendErrorAnswerReply(int sequence_number, const char* message);
+  // Sends an error reply, of the given type (ANSWER or RESUME_RESPONSE), and
+  // notifies the client of the error.
+  void SendErrorReply(ReceiverMessage::Type type,
+                      int sequence_number,
+                      const char* message);
 
   Client* const client_;
   Environment* const environment_;
@@ -162,12 +179,21 @@ class ReceiverSession final : public Environment::SocketSubscriber {
   const std::string session_id_;
   ReceiverSessionMessager messager_;
 
+  // Carries the |rpc_broker_|'s messages over the |messager_|.
+  BinaryRpcChannel rpc_channel_;
+  RpcBroker rpc_broker_;
+  int rpc_sequence_number_ = 0;
+
   // In some cases, the session initialization may be pending waiting for the
   // UDP socket to be ready. In this case, the receivers and the answer
   // message will not be configured and sent until the UDP socket has finished
   // binding.
   std::unique_ptr<SessionProperties> pending_session_;
 
+  // The properties of the last successfully negotiated session, updated with
+  // the crypto parameters of each RESUME message.
+  std::unique_ptr<SessionProperties> current_session_;
+
   bool supports_wifi_status_reporting_ = false;
   ReceiverPacketRouter packet_router_;
 
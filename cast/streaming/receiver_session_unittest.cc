@@ -4,6 +4,7 @@
 
 #include "cast/streaming/receiver_session.h"
 
+#include <string>
 #include <utility>
 
 #include "cast/streaming/mock_environment.h"
@@ -246,6 +247,79 @@ constexpr char kInvalidTypeMessage[] = R"({
   "seqNum": 1337
 })";
 
+// Resumes the streams selected from |kValidOfferMessage|, with new keys.
+constexpr char kValidResumeMessage[] = R"({
+  "type": "RESUME",
+  "seqNum": 1338,
+  "resume": {
+    "castMode": "mirroring",
+    "supportedStreams": [
+      {
+        "index": 31338,
+        "type": "video_source",
+        "codecName": "vp8",
+        "rtpProfile": "cast",
+        "rtpPayloadType": 127,
+        "ssrc": 19088745,
+        "maxFrameRate": "60000/1000",
+        "timeBase": "1/90000",
+        "maxBitRate": 5000000,
+        "aesKey": "00112233445566778899aabbccddeeff",
+        "aesIvMask": "ffeeddccbbaa99887766554433221100",
+        "resolutions": [
+          {
+            "width": 1280,
+            "height": 720
+          }
+        ]
+      },
+      {
+        "index": 1337,
+        "type": "audio_source",
+        "codecName": "opus",
+        "rtpProfile": "cast",
+        "rtpPayloadType": 97,
+        "ssrc": 19088747,
+        "bitRate": 124000,
+        "timeBase": "1/48000",
+        "channels": 2,
+        "aesKey": "0123456789abcdef0123456789abcdef",
+        "aesIvMask": "fedcba9876543210fedcba9876543210"
+      }
+    ]
+  }
+})";
+
+// Only resumes the video stream selected from |kValidOfferMessage|.
+constexpr char kPartialResumeMessage[] = R"({
+  "type": "RESUME",
+  "seqNum": 1338,
+  "resume": {
+    "castMode": "mirroring",
+    "supportedStreams": [
+      {
+        "index": 31338,
+        "type": "video_source",
+        "codecName": "vp8",
+        "rtpProfile": "cast",
+        "rtpPayloadType": 127,
+        "ssrc": 19088745,
+        "maxFrameRate": "60000/1000",
+        "timeBase": "1/90000",
+        "maxBitRate": 5000000,
+        "aesKey": "00112233445566778899aabbccddeeff",
+        "aesIvMask": "ffeeddccbbaa99887766554433221100",
+        "resolutions": [
+          {
+            "width": 1280,
+            "height": 720
+          }
+        ]
+      }
+    ]
+  }
+})";
+
 class FakeClient : public ReceiverSession::Client {
  public:
   MOCK_METHOD(void,
@@ -272,6 +346,15 @@ void ExpectIsErrorAnswerMessage(const ErrorOr<Json::Value>& message_or_error) {
   EXPECT_GT(error["code"].asInt(), 0);
 }
 
+// Returns |kValidOfferMessage|, advertising support for binary RPC messages.
+std::string MakeBinaryRpcOfferMessage() {
+  std::string offer = kValidOfferMessage;
+  const std::string cast_mode = R"("castMode": "mirroring",)";
+  offer.insert(offer.find(cast_mode) + cast_mode.size(),
+               R"( "binaryRpc": true,)");
+  return offer;
+}
+
 }  // namespace
 
 class ReceiverSessionTest : public ::testing::Test {
@@ -297,6 +380,15 @@ class ReceiverSessionTest : public ::testing::Test {
   }
 
  protected:
+  void ExpectIsResumeResponse(const std::string& message, bool is_ok) {
+    auto message_body = json::Parse(message);
+    ASSERT_TRUE(message_body.is_value());
+    EXPECT_EQ("RESUME_RESPONSE", message_body.value()["type"].asString());
+    EXPECT_EQ(1338, message_body.value()["seqNum"].asInt());
+    EXPECT_EQ(is_ok ? "ok" : "error",
+              message_body.value()["result"].asString());
+  }
+
   void AssertGotAnErrorAnswerResponse() {
     const auto& messages = message_port_->posted_messages();
     ASSERT_EQ(1u, messages.size());
@@ -691,5 +783,118 @@ TEST_F(ReceiverSessionTest, ReturnsErrorAnswerIfEnvironmentIsInvalidated) {
   EXPECT_EQ("error", message_body.value()["result"].asString());
 }
 
+TEST_F(ReceiverSessionTest, ResumesSessionWithNewKeys) {
+  InSequence s;
+  EXPECT_CALL(client_, OnMirroringNegotiated(session_.get(), _));
+  EXPECT_CALL(client_,
+              OnReceiversDestroying(session_.get(),
+                                    ReceiverSession::Client::kRenegotiated));
+  EXPECT_CALL(client_, OnMirroringNegotiated(session_.get(), _))
+      .WillOnce([](const ReceiverSession* session_,
+                   ReceiverSession::ConfiguredReceivers cr) {
+        ASSERT_TRUE(cr.audio_receiver);
+        EXPECT_EQ(cr.audio_receiver->config().sender_ssrc, 19088747u);
+        EXPECT_EQ(cr.audio_receiver->config().aes_secret_key[0], 0x01);
+        EXPECT_EQ(cr.audio_receiver->config().aes_iv_mask[0], 0xfe);
+        EXPECT_EQ(cr.audio_config.codec, AudioCodec::kOpus);
+
+        ASSERT_TRUE(cr.video_receiver);
+        EXPECT_EQ(cr.video_receiver->config().sender_ssrc, 19088745u);
+        EXPECT_EQ(cr.video_receiver->config().aes_secret_key[0], 0x00);
+        EXPECT_EQ(cr.video_receiver->config().aes_iv_mask[0], 0xff);
+        EXPECT_EQ(cr.video_config.codec, VideoCodec::kVp8);
+      });
+  EXPECT_CALL(client_,
+              OnReceiversDestroying(session_.get(),
+                                    ReceiverSession::Client::kEndOfSession));
+
+  message_port_->ReceiveMessage(kValidOfferMessage);
+  message_port_->ReceiveMessage(kValidResumeMessage);
+
+  const auto& messages = message_port_->posted_messages();
+  ASSERT_EQ(2u, messages.size());
+  ExpectIsResumeResponse(messages[1], true);
+}
+
+TEST_F(ReceiverSessionTest, RejectsResumeWithoutSession) {
+  message_port_->ReceiveMessage(kValidResumeMessage);
+
+  const auto& messages = message_port_->posted_messages();
+  ASSERT_EQ(1u, messages.size());
+  ExpectIsResumeResponse(messages[0], false);
+}
+
+TEST_F(ReceiverSessionTest, RejectsResumeNotMatchingSession) {
+  EXPECT_CALL(client_, OnMirroringNegotiated(session_.get(), _));
+  EXPECT_CALL(client_,
+              OnReceiversDestroying(session_.get(),
+                                    ReceiverSession::Client::kEndOfSession));
+
+  message_port_->ReceiveMessage(kValidOfferMessage);
+  message_port_->ReceiveMessage(kPartialResumeMessage);
+
+  const auto& messages = message_port_->posted_messages();
+  ASSERT_EQ(2u, messages.size());
+  ExpectIsResumeResponse(messages[1], false);
+}
+
+TEST_F(ReceiverSessionTest, SendsBinaryRpcMessagesIfBothSidesSupportThem) {
+  EXPECT_CALL(client_, OnMirroringNegotiated(session_.get(), _));
+  EXPECT_CALL(client_,
+              OnReceiversDestroying(session_.get(),
+                                    ReceiverSession::Client::kEndOfSession));
+
+  message_port_->set_supports_binary_messages(true);
+  message_port_->ReceiveMessage(MakeBinaryRpcOfferMessage());
+  auto answer = json::Parse(message_port_->posted_messages()[0]);
+  ASSERT_TRUE(answer.is_value());
+  EXPECT_TRUE(answer.value()["answer"]["binaryRpc"].asBool());
+
+  session_->rpc_broker()->SendMessageToRemote(RpcMessage{});
+  session_->rpc_broker()->SendMessageToRemote(RpcMessage{});
+  task_runner_.RunTasksUntilIdle();
+  EXPECT_EQ(1u, message_port_->posted_binary_messages().size());
+  EXPECT_EQ(1u, message_port_->posted_messages().size());
+}
+
+TEST_F(ReceiverSessionTest, SendsJsonRpcMessagesIfSenderDoesNotSupportBinary) {
+  EXPECT_CALL(client_, OnMirroringNegotiated(session_.get(), _));
+  EXPECT_CALL(client_,
+              OnReceiversDestroying(session_.get(),
+                                    ReceiverSession::Client::kEndOfSession));
+
+  message_port_->set_supports_binary_messages(true);
+  message_port_->ReceiveMessage(kValidOfferMessage);
+  auto answer = json::Parse(message_port_->posted_messages()[0]);
+  ASSERT_TRUE(answer.is_value());
+  EXPECT_FALSE(answer.value()["answer"].isMember("binaryRpc"));
+
+  session_->rpc_broker()->SendMessageToRemote(RpcMessage{});
+  task_runner_.RunTasksUntilIdle();
+  EXPECT_TRUE(message_port_->posted_binary_messages().empty());
+  const auto& messages = message_port_->posted_messages();
+  ASSERT_EQ(2u, messages.size());
+  auto rpc = json::Parse(messages[1]);
+  ASSERT_TRUE(rpc.is_value());
+  EXPECT_EQ("RPC", rpc.value()["type"].asString());
+}
+
+TEST_F(ReceiverSessionTest, SendsJsonRpcMessagesIfPortDoesNotSupportBinary) {
+  EXPECT_CALL(client_, OnMirroringNegotiated(session_.get(), _));
+  EXPECT_CALL(client_,
+              OnReceiversDestroying(session_.get(),
+                                    ReceiverSession::Client::kEndOfSession));
+
+  message_port_->ReceiveMessage(MakeBinaryRpcOfferMessage());
+  auto answer = json::Parse(message_port_->posted_messages()[0]);
+  ASSERT_TRUE(answer.is_value());
+  EXPECT_FALSE(answer.value()["answer"].isMember("binaryRpc"));
+
+  session_->rpc_broker()->SendMessageToRemote(RpcMessage{});
+  task_runner_.RunTasksUntilIdle();
+  EXPECT_TRUE(message_port_->posted_binary_messages().empty());
+  EXPECT_EQ(2u, message_port_->posted_messages().size());
+}
+
 }  // namespace cast
 }  // namespace openscreen
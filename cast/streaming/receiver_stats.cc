@@ -0,0 +1,189 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/receiver_stats.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "util/chrono_helpers.h"
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+namespace {
+
+// Returns the 0-based index of the most-significant set bit in |value|, which
+// must not be zero.
+int FindLastSet(uint64_t value) {
+  OSP_DCHECK_NE(value, 0u);
+#if defined(__clang__) || defined(__GNUC__)
+  return 63 - __builtin_clzll(value);
+#else
+  int index = 0;
+  while (value >>= 1) {
+    ++index;
+  }
+  return index;
+#endif
+}
+
+// Atomically raises |target| to |value|, if |value| is greater.
+void StoreMax(std::atomic<int64_t>* target, int64_t value) {
+  int64_t current = target->load(std::memory_order_relaxed);
+  while (current < value && !target->compare_exchange_weak(
+                                current, value, std::memory_order_relaxed)) {
+  }
+}
+
+// Returns the low 32 bits of |count|, since the wire format fields are allowed
+// to wrap around.
+uint32_t ToWireCount(int64_t count) {
+  return static_cast<uint32_t>(count);
+}
+
+}  // namespace
+
+LockFreeHistogram::LockFreeHistogram() = default;
+LockFreeHistogram::~LockFreeHistogram() = default;
+
+void LockFreeHistogram::Add(int64_t value) {
+  value = std::max<int64_t>(value, 0);
+  buckets_[ToBucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+  sum_.fetch_add(value, std::memory_order_relaxed);
+  StoreMax(&max_, value);
+}
+
+LockFreeHistogram::Summary LockFreeHistogram::Summarize() const {
+  std::array<int64_t, kNumBuckets> counts;
+  Summary summary;
+  for (int i = 0; i < kNumBuckets; ++i) {
+    counts[i] = buckets_[i].load(std::memory_order_relaxed);
+    summary.count += counts[i];
+  }
+  if (summary.count == 0) {
+    return summary;
+  }
+  summary.mean = sum_.load(std::memory_order_relaxed) / summary.count;
+  summary.max = max_.load(std::memory_order_relaxed);
+
+  // Nearest-rank method: Find the bucket containing each percentile's rank,
+  // and report its upper bound, but never more than the maximum sample.
+  const auto nth = [&](int percentile) {
+    const int64_t rank =
+        std::max<int64_t>((summary.count * percentile + 99) / 100, 1);
+    int64_t seen = 0;
+    for (int i = 0; i < kNumBuckets; ++i) {
+      seen += counts[i];
+      if (seen >= rank) {
+        return std::min(GetBucketUpperBound(i), summary.max);
+      }
+    }
+    return summary.max;
+  };
+  summary.p50 = nth(50);
+  summary.p95 = nth(95);
+  summary.p99 = nth(99);
+  return summary;
+}
+
+// static
+int LockFreeHistogram::ToBucketIndex(int64_t value) {
+  OSP_DCHECK_GE(value, 0);
+  if (value < kSubBucketCount) {
+    return static_cast<int>(value);
+  }
+  const int msb = FindLastSet(static_cast<uint64_t>(value));
+  const int shift = msb - kSubBucketBits;
+  const int sub_bucket =
+      static_cast<int>(value >> shift) & (kSubBucketCount - 1);
+  return kSubBucketCount + shift * kSubBucketCount + sub_bucket;
+}
+
+// static
+int64_t LockFreeHistogram::GetBucketUpperBound(int index) {
+  OSP_DCHECK_GE(index, 0);
+  OSP_DCHECK_LT(index, kNumBuckets);
+  if (index < kSubBucketCount) {
+    return index;
+  }
+  const int shift = (index - kSubBucketCount) / kSubBucketCount;
+  const int sub_bucket = (index - kSubBucketCount) % kSubBucketCount;
+  const int64_t lower_bound = int64_t{kSubBucketCount + sub_bucket} << shift;
+  return lower_bound + ((int64_t{1} << shift) - 1);
+}
+
+ReceiverStatsTracker::ReceiverStatsTracker() = default;
+ReceiverStatsTracker::~ReceiverStatsTracker() = default;
+
+void ReceiverStatsTracker::OnFrameCompleted(Clock::duration completion_time,
+                                            int num_nacks_sent) {
+  frames_completed_.fetch_add(1, std::memory_order_relaxed);
+  frame_completion_times_.Add(to_microseconds(completion_time).count());
+  nacks_per_frame_.Add(num_nacks_sent);
+}
+
+void ReceiverStatsTracker::OnFrameConsumed(Clock::duration decrypt_time,
+                                           bool was_late) {
+  frames_consumed_.fetch_add(1, std::memory_order_relaxed);
+  if (was_late) {
+    frames_consumed_late_.fetch_add(1, std::memory_order_relaxed);
+  }
+  decrypt_times_.Add(to_microseconds(decrypt_time).count());
+}
+
+void ReceiverStatsTracker::OnFramesDropped(int count) {
+  OSP_DCHECK_GE(count, 0);
+  frames_dropped_.fetch_add(count, std::memory_order_relaxed);
+}
+
+void ReceiverStatsTracker::OnNacksSent(int count) {
+  OSP_DCHECK_GE(count, 0);
+  nacks_sent_.fetch_add(count, std::memory_order_relaxed);
+}
+
+void ReceiverStatsTracker::OnPacketRecovered() {
+  packets_recovered_.fetch_add(1, std::memory_order_relaxed);
+}
+
+ReceiverStats ReceiverStatsTracker::GetStats() const {
+  ReceiverStats stats;
+  stats.frames_completed = frames_completed_.load(std::memory_order_relaxed);
+  stats.frames_consumed = frames_consumed_.load(std::memory_order_relaxed);
+  stats.frames_consumed_late =
+      frames_consumed_late_.load(std::memory_order_relaxed);
+  stats.frames_dropped = frames_dropped_.load(std::memory_order_relaxed);
+  stats.nacks_sent = nacks_sent_.load(std::memory_order_relaxed);
+  stats.packets_recovered = packets_recovered_.load(std::memory_order_relaxed);
+  stats.frame_completion_time = frame_completion_times_.Summarize();
+  stats.nacks_per_frame = nacks_per_frame_.Summarize();
+  stats.decrypt_time = decrypt_times_.Summarize();
+  return stats;
+}
+
+RtcpReceiverFrameStats ReceiverStatsTracker::GetRtcpFrameStats() const {
+  RtcpReceiverFrameStats result;
+  result.frames_completed =
+      ToWireCount(frames_completed_.load(std::memory_order_relaxed));
+  result.frames_dropped =
+      ToWireCount(frames_dropped_.load(std::memory_order_relaxed));
+  result.frames_consumed_late =
+      ToWireCount(frames_consumed_late_.load(std::memory_order_relaxed));
+  result.nacks_sent = ToWireCount(nacks_sent_.load(std::memory_order_relaxed));
+  result.packets_recovered =
+      ToWireCount(packets_recovered_.load(std::memory_order_relaxed));
+  const int64_t p95_us = frame_completion_times_.Summarize().p95;
+  result.p95_frame_completion_time = milliseconds(std::min<int64_t>(
+      (p95_us + 999) / 1000, std::numeric_limits<uint32_t>::max()));
+  return result;
+}
+
+// static
+constexpr int LockFreeHistogram::kSubBucketBits;
+constexpr int LockFreeHistogram::kSubBucketCount;
+constexpr int LockFreeHistogram::kNumBuckets;
+
+}  // namespace cast
+}  // namespace openscreen
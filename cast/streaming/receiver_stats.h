@@ -0,0 +1,128 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STREAMING_RECEIVER_STATS_H_
+#define CAST_STREAMING_RECEIVER_STATS_H_
+
+#include <stdint.h>
+
+#include <array>
+#include <atomic>
+
+#include "cast/streaming/rtcp_common.h"
+#include "platform/api/time.h"
+
+namespace openscreen {
+namespace cast {
+
+// A histogram of non-negative integer samples, which can be added to and read
+// from any thread without locking. Values below 4 are counted exactly, and each
+// power of two above that is divided into four buckets, so the reported
+// percentiles are never more than 25% greater than the true values.
+class LockFreeHistogram {
+ public:
+  struct Summary {
+    int64_t count = 0;
+    int64_t mean = 0;
+    int64_t p50 = 0;
+    int64_t p95 = 0;
+    int64_t p99 = 0;
+    int64_t max = 0;
+  };
+
+  LockFreeHistogram();
+  ~LockFreeHistogram();
+
+  // Adds one sample. Negative values are counted as zero.
+  void Add(int64_t value);
+
+  // Returns a summary of all the samples added so far. If samples are being
+  // added concurrently, some of them may be only partly accounted for.
+  Summary Summarize() const;
+
+ private:
+  static constexpr int kSubBucketBits = 2;
+  static constexpr int kSubBucketCount = 1 << kSubBucketBits;
+  static constexpr int kNumBuckets =
+      kSubBucketCount + (62 - kSubBucketBits + 1) * kSubBucketCount;
+
+  static int ToBucketIndex(int64_t value);
+  static int64_t GetBucketUpperBound(int index);
+
+  std::array<std::atomic<int64_t>, kNumBuckets> buckets_{};
+  std::atomic<int64_t> sum_{0};
+  std::atomic<int64_t> max_{0};
+};
+
+// A snapshot of a Receiver's frame pipeline, for diagnosing why frames arrive
+// late or not at all. All counts are since the Receiver was created.
+struct ReceiverStats {
+  // Frames for which all packets were received.
+  int64_t frames_completed = 0;
+
+  // Frames returned by Receiver::ConsumeNextFrame().
+  int64_t frames_consumed = 0;
+
+  // Frames that were consumed after their playout time had already passed.
+  int64_t frames_consumed_late = 0;
+
+  // Frames skipped-over (never consumed) because they were incomplete and
+  // would not have played out on time.
+  int64_t frames_dropped = 0;
+
+  // Packet NACKs sent to the Sender. A NACK for all the packets of a frame
+  // counts as one.
+  int64_t nacks_sent = 0;
+
+  // Packets received for frames that had already been NACKed.
+  int64_t packets_recovered = 0;
+
+  // Microseconds from the arrival of a frame's first packet until the frame was
+  // complete.
+  LockFreeHistogram::Summary frame_completion_time;
+
+  // The number of packet NACKs sent for each completed frame.
+  LockFreeHistogram::Summary nacks_per_frame;
+
+  // Microseconds spent decrypting each consumed frame.
+  LockFreeHistogram::Summary decrypt_time;
+};
+
+// Accumulates the frame pipeline statistics for one Receiver. The On*() methods
+// are called from the Receiver's TaskRunner thread, while GetStats() may be
+// called from any thread. All state is kept in atomics, so that neither side
+// ever blocks the other.
+class ReceiverStatsTracker {
+ public:
+  ReceiverStatsTracker();
+  ~ReceiverStatsTracker();
+
+  void OnFrameCompleted(Clock::duration completion_time, int num_nacks_sent);
+  void OnFrameConsumed(Clock::duration decrypt_time, bool was_late);
+  void OnFramesDropped(int count);
+  void OnNacksSent(int count);
+  void OnPacketRecovered();
+
+  ReceiverStats GetStats() const;
+
+  // Returns the subset of the stats that is reported back to the Sender.
+  RtcpReceiverFrameStats GetRtcpFrameStats() const;
+
+ private:
+  std::atomic<int64_t> frames_completed_{0};
+  std::atomic<int64_t> frames_consumed_{0};
+  std::atomic<int64_t> frames_consumed_late_{0};
+  std::atomic<int64_t> frames_dropped_{0};
+  std::atomic<int64_t> nacks_sent_{0};
+  std::atomic<int64_t> packets_recovered_{0};
+
+  LockFreeHistogram frame_completion_times_;
+  LockFreeHistogram nacks_per_frame_;
+  LockFreeHistogram decrypt_times_;
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STREAMING_RECEIVER_STATS_H_
@@ -0,0 +1,132 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/receiver_stats.h"
+
+#include <limits>
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "util/chrono_helpers.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+TEST(LockFreeHistogramTest, SummarizesNothingInitially) {
+  LockFreeHistogram histogram;
+  const LockFreeHistogram::Summary summary = histogram.Summarize();
+  EXPECT_EQ(0, summary.count);
+  EXPECT_EQ(0, summary.mean);
+  EXPECT_EQ(0, summary.p99);
+  EXPECT_EQ(0, summary.max);
+}
+
+TEST(LockFreeHistogramTest, CountsSmallValuesExactly) {
+  LockFreeHistogram histogram;
+  for (int i = 0; i < 100; ++i) {
+    histogram.Add((i < 50) ? 0 : (i < 95) ? 1 : 3);
+  }
+  histogram.Add(-5);  // Counted as zero.
+
+  const LockFreeHistogram::Summary summary = histogram.Summarize();
+  EXPECT_EQ(101, summary.count);
+  EXPECT_EQ(0, summary.p50);
+  EXPECT_EQ(1, summary.p95);
+  EXPECT_EQ(3, summary.p99);
+  EXPECT_EQ(3, summary.max);
+}
+
+TEST(LockFreeHistogramTest, ApproximatesLargeValues) {
+  LockFreeHistogram histogram;
+  // Add the values 1000, 2000, ..., 100000, in shuffled order.
+  for (int i = 0; i < 100; ++i) {
+    histogram.Add(1000 * (1 + (i * 37) % 100));
+  }
+
+  const LockFreeHistogram::Summary summary = histogram.Summarize();
+  EXPECT_EQ(100, summary.count);
+  EXPECT_EQ(50500, summary.mean);
+  EXPECT_EQ(100000, summary.max);
+  // Each percentile is reported as the upper bound of its bucket, which is
+  // within 25% above the true value.
+  EXPECT_LE(50000, summary.p50);
+  EXPECT_GE(50000 * 5 / 4, summary.p50);
+  EXPECT_LE(95000, summary.p95);
+  EXPECT_GE(95000 * 5 / 4, summary.p95);
+  EXPECT_LE(99000, summary.p99);
+  // ...but never greater than the maximum.
+  EXPECT_GE(100000, summary.p99);
+}
+
+TEST(LockFreeHistogramTest, HandlesExtremeValues) {
+  LockFreeHistogram histogram;
+  histogram.Add(std::numeric_limits<int64_t>::max());
+  const LockFreeHistogram::Summary summary = histogram.Summarize();
+  EXPECT_EQ(1, summary.count);
+  EXPECT_EQ(std::numeric_limits<int64_t>::max(), summary.p50);
+  EXPECT_EQ(std::numeric_limits<int64_t>::max(), summary.max);
+}
+
+TEST(LockFreeHistogramTest, CanBeAddedToFromMultipleThreads) {
+  LockFreeHistogram histogram;
+  constexpr int kSamplesPerThread = 10000;
+  const auto add_samples = [&histogram] {
+    for (int i = 0; i < kSamplesPerThread; ++i) {
+      histogram.Add(i % 100);
+    }
+  };
+  std::thread writer(add_samples);
+  std::thread reader([&histogram] {
+    for (int i = 0; i < 100; ++i) {
+      EXPECT_LE(histogram.Summarize().max, 99);
+    }
+  });
+  add_samples();
+  writer.join();
+  reader.join();
+
+  const LockFreeHistogram::Summary summary = histogram.Summarize();
+  EXPECT_EQ(2 * kSamplesPerThread, summary.count);
+  EXPECT_EQ(49, summary.mean);
+  EXPECT_EQ(99, summary.max);
+}
+
+TEST(ReceiverStatsTrackerTest, AccumulatesCountsAndDistributions) {
+  ReceiverStatsTracker tracker;
+  tracker.OnNacksSent(3);
+  tracker.OnPacketRecovered();
+  tracker.OnPacketRecovered();
+  tracker.OnFrameCompleted(milliseconds(20), 3);
+  tracker.OnFrameCompleted(milliseconds(4), 0);
+  tracker.OnFramesDropped(2);
+  tracker.OnFrameConsumed(microseconds(100), false);
+  tracker.OnFrameConsumed(microseconds(300), true);
+
+  const ReceiverStats stats = tracker.GetStats();
+  EXPECT_EQ(2, stats.frames_completed);
+  EXPECT_EQ(2, stats.frames_consumed);
+  EXPECT_EQ(1, stats.frames_consumed_late);
+  EXPECT_EQ(2, stats.frames_dropped);
+  EXPECT_EQ(3, stats.nacks_sent);
+  EXPECT_EQ(2, stats.packets_recovered);
+  EXPECT_EQ(2, stats.frame_completion_time.count);
+  EXPECT_EQ(12000, stats.frame_completion_time.mean);
+  EXPECT_EQ(20000, stats.frame_completion_time.max);
+  EXPECT_EQ(3, stats.nacks_per_frame.max);
+  EXPECT_EQ(200, stats.decrypt_time.mean);
+  EXPECT_EQ(300, stats.decrypt_time.p99);
+
+  const RtcpReceiverFrameStats rtcp_stats = tracker.GetRtcpFrameStats();
+  EXPECT_EQ(2u, rtcp_stats.frames_completed);
+  EXPECT_EQ(2u, rtcp_stats.frames_dropped);
+  EXPECT_EQ(1u, rtcp_stats.frames_consumed_late);
+  EXPECT_EQ(3u, rtcp_stats.nacks_sent);
+  EXPECT_EQ(2u, rtcp_stats.packets_recovered);
+  EXPECT_EQ(milliseconds(20), rtcp_stats.p95_frame_completion_time);
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
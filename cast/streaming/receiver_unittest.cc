@@ -240,6 +240,8 @@ class MockSender : public CompoundRtcpParser::Client {
                void(FrameId frame_id, milliseconds playout_delay));
   MOCK_METHOD1(OnReceiverHasFrames, void(std::vector<FrameId> acks));
   MOCK_METHOD1(OnReceiverIsMissingPackets, void(std::vector<PacketNack> nacks));
+  MOCK_METHOD1(OnReceiverFrameStats,
+               void(const RtcpReceiverFrameStats& stats));
 
  private:
   TaskRunner* const task_runner_;
@@ -849,6 +851,77 @@ TEST_F(ReceiverTest, DropsLateFrames) {
   AdvanceClockAndRunTasks(kOneWayNetworkDelay);
   testing::Mock::VerifyAndClearExpectations(consumer());
   testing::Mock::VerifyAndClearExpectations(sender());
+
+  // Only the two complete frames were consumed, and the rest were dropped.
+  const ReceiverStats stats = receiver()->GetStats();
+  EXPECT_EQ(2, stats.frames_completed);
+  EXPECT_EQ(2, stats.frames_consumed);
+  EXPECT_EQ(6, stats.frames_dropped);
+}
+
+// Tests that the Receiver tracks its frame pipeline statistics and, when
+// enabled, reports them to the Sender in its replies to Sender Reports.
+TEST_F(ReceiverTest, ReportsFrameStats) {
+  const Clock::time_point start_time = FakeClock::now();
+  receiver()->SetFrameStatsReportingEnabled(true);
+  EXPECT_CALL(*sender(), OnReceiverFrameStats(_)).Times(1);
+  ExchangeInitialReportPackets();
+
+  // Send three frames, but hold back the last packet of Frame 1.
+  for (int i = 0; i <= 2; ++i) {
+    sender()->SetFrameBeingSent(SimulatedFrame(start_time, i));
+    std::vector<FramePacketId> packet_ids = sender()->GetAllPacketIds(0);
+    if (i == 1) {
+      packet_ids.pop_back();
+    }
+    sender()->SendRtpPackets(packet_ids);
+    AdvanceClockAndRunTasks(SimulatedFrame::kFrameDuration);
+  }
+
+  // Wait for the Receiver to NACK the missing packet, then send it.
+  EXPECT_CALL(*sender(), OnReceiverIsMissingPackets(_)).Times(AtLeast(1));
+  AdvanceClockAndRunTasks(kRtcpReportInterval);
+  testing::Mock::VerifyAndClearExpectations(sender());
+  sender()->SetFrameBeingSent(SimulatedFrame(start_time, 1));
+  sender()->SendRtpPackets({sender()->GetAllPacketIds(0).back()});
+  AdvanceClockAndRunTasks(kRoundTripNetworkDelay);
+
+  // The frames are consumed well past their playout times.
+  ConsumeAndVerifyFrames(0, 2, start_time);
+  const ReceiverStats stats = receiver()->GetStats();
+  EXPECT_EQ(3, stats.frames_completed);
+  EXPECT_EQ(3, stats.frames_consumed);
+  EXPECT_EQ(3, stats.frames_consumed_late);
+  EXPECT_EQ(0, stats.frames_dropped);
+  EXPECT_LE(1, stats.nacks_sent);
+  EXPECT_EQ(1, stats.packets_recovered);
+  EXPECT_EQ(3, stats.frame_completion_time.count);
+  EXPECT_EQ(3, stats.nacks_per_frame.count);
+  EXPECT_EQ(3, stats.decrypt_time.count);
+  const auto min_frame_1_completion_time =
+      kRtcpReportInterval - SimulatedFrame::kFrameDuration;
+  EXPECT_LE(to_microseconds(min_frame_1_completion_time).count(),
+            stats.frame_completion_time.max);
+
+  // The reply to the next Sender Report includes a summary of the stats.
+  RtcpReceiverFrameStats reported_stats;
+  EXPECT_CALL(*sender(), OnReceiverFrameStats(_))
+      .WillOnce(SaveArg<0>(&reported_stats));
+  sender()->SendSenderReport(
+      FakeClock::now(),
+      SimulatedFrame::GetRtpStartTime() +
+          RtpTimeDelta::FromDuration(FakeClock::now() - start_time,
+                                     kRtpTimebase));
+  AdvanceClockAndRunTasks(kRoundTripNetworkDelay);
+  testing::Mock::VerifyAndClearExpectations(sender());
+  EXPECT_EQ(3u, reported_stats.frames_completed);
+  EXPECT_EQ(0u, reported_stats.frames_dropped);
+  EXPECT_EQ(3u, reported_stats.frames_consumed_late);
+  EXPECT_EQ(static_cast<uint32_t>(stats.nacks_sent),
+            reported_stats.nacks_sent);
+  EXPECT_EQ(1u, reported_stats.packets_recovered);
+  EXPECT_LE(min_frame_1_completion_time,
+            reported_stats.p95_frame_completion_time);
 }
 
 }  // namespace
@@ -40,7 +40,8 @@ RpcBroker::RpcBroker(SendMessageCallback send_message_cb)
       send_message_cb_(std::move(send_message_cb)) {}
 
 RpcBroker::~RpcBroker() {
-  receive_callbacks_.clear();
+  callbacks_by_handle_.clear();
+  other_callbacks_.clear();
 }
 
 RpcBroker::Handle RpcBroker::GetUniqueHandle() {
@@ -50,25 +51,50 @@ RpcBroker::Handle RpcBroker::GetUniqueHandle() {
 void RpcBroker::RegisterMessageReceiverCallback(
     RpcBroker::Handle handle,
     ReceiveMessageCallback callback) {
-  OSP_DCHECK(receive_callbacks_.find(handle) == receive_callbacks_.end())
-      << "must deregister before re-registering";
+  OSP_DCHECK(!FindCallback(handle)) << "must deregister before re-registering";
   OSP_DVLOG << "registering handle: " << handle;
-  receive_callbacks_.emplace_back(handle, std::move(callback));
+  if (handle >= kFirstHandle && handle < next_handle_) {
+    const size_t index = static_cast<size_t>(handle - kFirstHandle);
+    if (index >= callbacks_by_handle_.size()) {
+      callbacks_by_handle_.resize(index + 1);
+    }
+    callbacks_by_handle_[index] = std::move(callback);
+  } else {
+    other_callbacks_.emplace_back(handle, std::move(callback));
+  }
 }
 
 void RpcBroker::UnregisterMessageReceiverCallback(RpcBroker::Handle handle) {
   OSP_DVLOG << "unregistering handle: " << handle;
-  receive_callbacks_.erase_key(handle);
+  // A handle may be in either table: one registered before GetUniqueHandle()
+  // reached it lives in |other_callbacks_|.
+  ReceiveMessageCallback* const callback = FindDenseCallback(handle);
+  if (callback) {
+    *callback = nullptr;
+    // Trim trailing empty entries, so the table does not keep growing over a
+    // long session.
+    while (!callbacks_by_handle_.empty() && !callbacks_by_handle_.back()) {
+      callbacks_by_handle_.pop_back();
+    }
+    return;
+  }
+  other_callbacks_.erase_key(handle);
 }
 
 void RpcBroker::ProcessMessageFromRemote(const RpcMessage& message) {
   OSP_DVLOG << "received message: " << message;
-  const auto entry = receive_callbacks_.find(message.handle());
-  if (entry == receive_callbacks_.end()) {
+  ReceiveMessageCallback* const callback = FindCallback(message.handle());
+  if (!callback) {
     OSP_DVLOG << "unregistered handle: " << message.handle();
     return;
   }
-  entry->second(message);
+  (*callback)(message);
+}
+
+void RpcBroker::ProcessBatchFromRemote(const RpcMessageBatch& batch) {
+  for (const RpcMessage& message : batch.messages()) {
+    ProcessMessageFromRemote(message);
+  }
 }
 
 void RpcBroker::SendMessageToRemote(const RpcMessage& message) {
@@ -80,7 +106,29 @@ void RpcBroker::SendMessageToRemote(const RpcMessage& message) {
 }
 
 bool RpcBroker::IsRegisteredForTesting(RpcBroker::Handle handle) {
-  return receive_callbacks_.find(handle) != receive_callbacks_.end();
+  return FindCallback(handle) != nullptr;
+}
+
+RpcBroker::ReceiveMessageCallback* RpcBroker::FindCallback(Handle handle) {
+  ReceiveMessageCallback* const callback = FindDenseCallback(handle);
+  if (callback) {
+    return callback;
+  }
+  const auto it = other_callbacks_.find(handle);
+  return (it == other_callbacks_.end()) ? nullptr : &it->second;
+}
+
+RpcBroker::ReceiveMessageCallback* RpcBroker::FindDenseCallback(
+    Handle handle) {
+  if (handle < kFirstHandle) {
+    return nullptr;
+  }
+  const size_t index = static_cast<size_t>(handle - kFirstHandle);
+  if (index >= callbacks_by_handle_.size()) {
+    return nullptr;
+  }
+  ReceiveMessageCallback& callback = callbacks_by_handle_[index];
+  return callback ? &callback : nullptr;
 }
 
 }  // namespace cast
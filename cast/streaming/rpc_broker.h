@@ -5,6 +5,7 @@
 #ifndef CAST_STREAMING_RPC_BROKER_H_
 #define CAST_STREAMING_RPC_BROKER_H_
 
+#include <functional>
 #include <vector>
 
 #include "cast/streaming/remoting.pb.h"
@@ -55,6 +56,10 @@ class RpcBroker {
   // Distributes an incoming RPC message to the registered (if any) component.
   void ProcessMessageFromRemote(const RpcMessage& message);
 
+  // Distributes each message in an incoming batch, in order, as if by calling
+  // ProcessMessageFromRemote() for each.
+  void ProcessBatchFromRemote(const RpcMessageBatch& batch);
+
   // Executes the |send_message_cb_| using |message|.
   void SendMessageToRemote(const RpcMessage& message);
 
@@ -73,11 +78,25 @@ class RpcBroker {
   static constexpr Handle kFirstHandle = 100;
 
  private:
+  // Returns the callback registered for |handle|, or nullptr.
+  ReceiveMessageCallback* FindCallback(Handle handle);
+
+  // Returns the callback registered for |handle| in |callbacks_by_handle_|, or
+  // nullptr.
+  ReceiveMessageCallback* FindDenseCallback(Handle handle);
+
   // Next unique handle to return from GetUniqueHandle().
   Handle next_handle_;
 
-  // Maps of handle values to associated MessageReceivers.
-  FlatMap<Handle, ReceiveMessageCallback> receive_callbacks_;
+  // The callbacks for handles returned by GetUniqueHandle(), indexed by
+  // |handle - kFirstHandle|. Since those handles are allocated sequentially,
+  // this table stays dense, allowing constant-time dispatch no matter how many
+  // components are registered. Unregistered entries are left empty.
+  std::vector<ReceiveMessageCallback> callbacks_by_handle_;
+
+  // Callbacks for any other handles, such as the |kAcquire*Handle|s. There are
+  // only ever a few of these.
+  FlatMap<Handle, ReceiveMessageCallback> other_callbacks_;
 
   // Callback that is ran to send a serialized message.
   SendMessageCallback send_message_cb_;
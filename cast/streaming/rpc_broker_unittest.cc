@@ -150,5 +150,111 @@ TEST_F(RpcBrokerTest, Registration) {
   ASSERT_FALSE(rpc_broker_->IsRegisteredForTesting(handle));
 }
 
+TEST_F(RpcBrokerTest, DispatchesToManyHandles) {
+  std::vector<RpcBroker::Handle> handles;
+  std::vector<int> counts(64);
+  for (int i = 0; i < 64; ++i) {
+    const RpcBroker::Handle handle = rpc_broker_->GetUniqueHandle();
+    handles.push_back(handle);
+    rpc_broker_->RegisterMessageReceiverCallback(
+        handle, [&counts, i](const RpcMessage&) { ++counts[i]; });
+  }
+
+  // Unregistering from the middle must not disturb the other handles.
+  rpc_broker_->UnregisterMessageReceiverCallback(handles[10]);
+  ASSERT_FALSE(rpc_broker_->IsRegisteredForTesting(handles[10]));
+  ASSERT_TRUE(rpc_broker_->IsRegisteredForTesting(handles[11]));
+
+  for (const RpcBroker::Handle handle : handles) {
+    RpcMessage rpc;
+    rpc.set_handle(handle);
+    rpc_broker_->ProcessMessageFromRemote(rpc);
+  }
+  for (int i = 0; i < 64; ++i) {
+    EXPECT_EQ((i == 10) ? 0 : 1, counts[i]) << "i=" << i;
+  }
+  EXPECT_EQ(0, fake_messager_->received_count());
+
+  // Handles that have not been allocated yet are not registered.
+  ASSERT_FALSE(rpc_broker_->IsRegisteredForTesting(handles.back() + 1));
+}
+
+TEST_F(RpcBrokerTest, DispatchesToAcquireHandles) {
+  int renderer_count = 0;
+  rpc_broker_->RegisterMessageReceiverCallback(
+      RpcBroker::kAcquireRendererHandle,
+      [&renderer_count](const RpcMessage&) { ++renderer_count; });
+  ASSERT_TRUE(
+      rpc_broker_->IsRegisteredForTesting(RpcBroker::kAcquireRendererHandle));
+  ASSERT_FALSE(
+      rpc_broker_->IsRegisteredForTesting(RpcBroker::kAcquireDemuxerHandle));
+
+  RpcMessage rpc;
+  rpc.set_handle(RpcBroker::kAcquireRendererHandle);
+  rpc_broker_->ProcessMessageFromRemote(rpc);
+  EXPECT_EQ(1, renderer_count);
+
+  rpc_broker_->UnregisterMessageReceiverCallback(
+      RpcBroker::kAcquireRendererHandle);
+  rpc_broker_->ProcessMessageFromRemote(rpc);
+  EXPECT_EQ(1, renderer_count);
+}
+
+TEST_F(RpcBrokerTest, DispatchesToHandlesRegisteredBeforeAllocation) {
+  // Register a handle that GetUniqueHandle() has not returned yet.
+  const RpcBroker::Handle early_handle = fake_messager_->handle() + 5;
+  int early_count = 0;
+  rpc_broker_->RegisterMessageReceiverCallback(
+      early_handle, [&early_count](const RpcMessage&) { ++early_count; });
+
+  // Allocate and register handles past it, so that the table of allocated
+  // handles now covers it.
+  RpcBroker::Handle handle;
+  do {
+    handle = rpc_broker_->GetUniqueHandle();
+  } while (handle <= early_handle + 1);
+  int later_count = 0;
+  rpc_broker_->RegisterMessageReceiverCallback(
+      handle, [&later_count](const RpcMessage&) { ++later_count; });
+  ASSERT_TRUE(rpc_broker_->IsRegisteredForTesting(early_handle));
+
+  RpcMessage rpc;
+  rpc.set_handle(early_handle);
+  rpc_broker_->ProcessMessageFromRemote(rpc);
+  EXPECT_EQ(1, early_count);
+  EXPECT_EQ(0, later_count);
+
+  rpc_broker_->UnregisterMessageReceiverCallback(early_handle);
+  ASSERT_FALSE(rpc_broker_->IsRegisteredForTesting(early_handle));
+  rpc_broker_->ProcessMessageFromRemote(rpc);
+  EXPECT_EQ(1, early_count);
+  ASSERT_TRUE(rpc_broker_->IsRegisteredForTesting(handle));
+}
+
+TEST_F(RpcBrokerTest, ProcessBatchFromRemote) {
+  const auto other_handle = rpc_broker_->GetUniqueHandle();
+  std::vector<double> other_values;
+  rpc_broker_->RegisterMessageReceiverCallback(
+      other_handle, [&other_values](const RpcMessage& message) {
+        other_values.push_back(message.double_value());
+      });
+
+  RpcMessageBatch batch;
+  for (int i = 0; i < 3; ++i) {
+    RpcMessage* const rpc = batch.add_messages();
+    rpc->set_handle(fake_messager_->handle());
+    rpc->set_double_value(i);
+    RpcMessage* const other_rpc = batch.add_messages();
+    other_rpc->set_handle(other_handle);
+    other_rpc->set_double_value(10 + i);
+  }
+  batch.add_messages()->set_handle(RpcBroker::kInvalidHandle);
+  rpc_broker_->ProcessBatchFromRemote(batch);
+
+  EXPECT_EQ(3, fake_messager_->received_count());
+  EXPECT_EQ(2, fake_messager_->received_rpc().double_value());
+  EXPECT_THAT(other_values, testing::ElementsAre(10, 11, 12));
+}
+
 }  // namespace cast
 }  // namespace openscreen
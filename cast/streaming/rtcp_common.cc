@@ -240,6 +240,37 @@ absl::optional<RtcpReportBlock> RtcpReportBlock::ParseOne(
   return result;
 }
 
+void RtcpReceiverFrameStats::AppendFields(absl::Span<uint8_t>* buffer) const {
+  OSP_CHECK_GE(buffer->size(), kRtcpReceiverFrameStatsReportBlockSize);
+
+  AppendField<uint32_t>(frames_completed, buffer);
+  AppendField<uint32_t>(frames_dropped, buffer);
+  AppendField<uint32_t>(frames_consumed_late, buffer);
+  AppendField<uint32_t>(nacks_sent, buffer);
+  AppendField<uint32_t>(packets_recovered, buffer);
+  AppendField<uint32_t>(
+      saturate_cast<uint32_t>(p95_frame_completion_time.count()), buffer);
+}
+
+// static
+absl::optional<RtcpReceiverFrameStats> RtcpReceiverFrameStats::Parse(
+    absl::Span<const uint8_t> buffer) {
+  if (static_cast<int>(buffer.size()) !=
+      kRtcpReceiverFrameStatsReportBlockSize) {
+    return absl::nullopt;
+  }
+
+  RtcpReceiverFrameStats stats;
+  stats.frames_completed = ConsumeField<uint32_t>(&buffer);
+  stats.frames_dropped = ConsumeField<uint32_t>(&buffer);
+  stats.frames_consumed_late = ConsumeField<uint32_t>(&buffer);
+  stats.nacks_sent = ConsumeField<uint32_t>(&buffer);
+  stats.packets_recovered = ConsumeField<uint32_t>(&buffer);
+  stats.p95_frame_completion_time =
+      std::chrono::milliseconds(ConsumeField<uint32_t>(&buffer));
+  return stats;
+}
+
 RtcpSenderReport::RtcpSenderReport() = default;
 RtcpSenderReport::~RtcpSenderReport() = default;
 
@@ -7,6 +7,7 @@
 
 #include <stdint.h>
 
+#include <chrono>
 #include <tuple>
 #include <vector>
 
@@ -154,6 +155,31 @@ struct RtcpSenderReport {
   absl::optional<RtcpReportBlock> report_block;
 };
 
+// Statistics about a Receiver's frame pipeline, optionally reported to the
+// Sender in an RTCP Extended Report block (see rtp_defines.h). The counts are
+// since the start of the session, and wrap-around is possible.
+struct RtcpReceiverFrameStats {
+  uint32_t frames_completed = 0;
+  uint32_t frames_dropped = 0;
+  uint32_t frames_consumed_late = 0;
+  uint32_t nacks_sent = 0;
+  uint32_t packets_recovered = 0;
+
+  // The 95th percentile of the time from the arrival of a frame's first packet
+  // until the frame was complete.
+  std::chrono::milliseconds p95_frame_completion_time{};
+
+  // Serializes the block data (not including the block header) in the first
+  // |kRtcpReceiverFrameStatsReportBlockSize| bytes of the given |buffer| and
+  // adjusts |buffer| to point to the first byte after it.
+  void AppendFields(absl::Span<uint8_t>* buffer) const;
+
+  // Parses the block data (not including the block header) from |buffer|.
+  // Returns nullopt if the data is not the expected size.
+  static absl::optional<RtcpReceiverFrameStats> Parse(
+      absl::Span<const uint8_t> buffer);
+};
+
 // A pair of IDs that refers to a specific missing packet within a frame. If
 // |packet_id| is kAllPacketsLost, then it represents all the packets of a
 // frame.
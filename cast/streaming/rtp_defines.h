@@ -341,6 +341,32 @@ constexpr int kRtcpExtendedReportBlockHeaderSize = 4;
 // +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
 constexpr uint8_t kRtcpReceiverReferenceTimeReportBlockType = 4;
 constexpr int kRtcpReceiverReferenceTimeReportBlockSize = 8;
+//
+// Open Screen Receivers may also include a non-standard Receiver Frame
+// Statistics block, which reports on the health of the Receiver's frame
+// pipeline. The block type is from the range not assigned by IANA, and per RFC
+// 3611 Section 3, Senders that do not recognize it will skip over it. All
+// counts are since the start of the session, and wrap-around is possible.
+//
+//  0                   1                   2                   3
+//  0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1 2 3 4 5 6 7 8 9 0 1
+// +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// | Block Type=200| Reserved = 0  |       Block Length = 6        |
+// +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// |                       Frames Completed                        |
+// +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// |                        Frames Dropped                         |
+// +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// |                     Frames Consumed Late                      |
+// +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// |                          NACKs Sent                           |
+// +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// |                       Packets Recovered                       |
+// +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+// |         95th Percentile Frame Completion Time (in ms)         |
+// +-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+-+
+constexpr uint8_t kRtcpReceiverFrameStatsReportBlockType = 200;
+constexpr int kRtcpReceiverFrameStatsReportBlockSize = 24;
 
 // Cast Picture Loss Indicator Message:
 //
@@ -22,7 +22,8 @@ Sender::Sender(Environment* environment,
                SenderPacketRouter* packet_router,
                SessionConfig config,
                RtpPayloadType rtp_payload_type)
-    : config_(config),
+    : now_(environment->now_function()),
+      config_(config),
       packet_router_(packet_router),
       rtcp_session_(config.sender_ssrc,
                     config.receiver_ssrc,
@@ -53,6 +54,10 @@ void Sender::SetObserver(Sender::Observer* observer) {
   observer_ = observer;
 }
 
+void Sender::SetIgnoringReceiverFeedback(bool ignoring) {
+  ignoring_receiver_feedback_ = ignoring;
+}
+
 int Sender::GetInFlightFrameCount() const {
   return num_frames_in_flight_;
 }
@@ -103,7 +108,8 @@ Sender::EnqueueFrameResult Sender::EnqueueFrame(const EncodedFrame& frame) {
     OSP_DCHECK_GT(frame.rtp_timestamp, pending_sender_report_.rtp_timestamp);
     OSP_DCHECK_GT(frame.reference_time, pending_sender_report_.reference_time);
   }
-  OSP_DCHECK(frame.data.data());
+  OSP_DCHECK(frame.data_fragments.empty() ? !!frame.data.data()
+                                          : frame.data.empty());
 
   // Check whether enqueuing the frame would exceed the design limit for the
   // span of FrameIds. Even if |num_frames_in_flight_| is less than
@@ -130,6 +136,9 @@ Sender::EnqueueFrameResult Sender::EnqueueFrame(const EncodedFrame& frame) {
   }
   slot->send_flags.Resize(packet_count, YetAnotherBitVector::SET);
   slot->packet_sent_times.assign(packet_count, SenderPacketRouter::kNever);
+  slot->num_packets_never_sent = packet_count;
+  slot->timing = FrameTimingRecord{};
+  slot->timing.enqueue_time = now_();
 
   // Officially record the "enqueue."
   ++num_frames_in_flight_;
@@ -167,23 +176,33 @@ Sender::EnqueueFrameResult Sender::EnqueueFrame(const EncodedFrame& frame) {
   // Re-activate RTP sending if it was suspended.
   packet_router_->RequestRtpSend(rtcp_session_.receiver_ssrc());
 
+  RecordCurrentState();
+
   return OK;
 }
 
 void Sender::CancelInFlightData() {
   while (checkpoint_frame_id_ <= last_enqueued_frame_id_) {
     ++checkpoint_frame_id_;
-    CancelPendingFrame(checkpoint_frame_id_);
+    CancelPendingFrame(checkpoint_frame_id_, false);
   }
 }
 
+SenderStats Sender::GetStats() const {
+  return stats_tracker_.GetStats();
+}
+
 void Sender::OnReceivedRtcpPacket(Clock::time_point arrival_time,
                                   absl::Span<const uint8_t> packet) {
+  if (ignoring_receiver_feedback_) {
+    return;
+  }
   rtcp_packet_arrival_time_ = arrival_time;
   // This call to Parse() invoke zero or more of the OnReceiverXYZ() methods in
   // the current call stack:
   if (rtcp_parser_.Parse(packet, last_enqueued_frame_id_)) {
     packet_router_->OnRtcpReceived(arrival_time, round_trip_time_);
+    RecordCurrentState();
   }
 }
 
@@ -235,7 +254,21 @@ absl::Span<uint8_t> Sender::GetRtpPacketForImmediateSend(
   const absl::Span<uint8_t> result = rtp_packetizer_.GeneratePacket(
       *chosen.slot->frame, chosen.packet_id, buffer);
   chosen.slot->send_flags.Clear(chosen.packet_id);
-  chosen.slot->packet_sent_times[chosen.packet_id] = send_time;
+  Clock::time_point& packet_sent_time =
+      chosen.slot->packet_sent_times[chosen.packet_id];
+  FrameTimingRecord& timing = chosen.slot->timing;
+  if (packet_sent_time == SenderPacketRouter::kNever) {
+    if (chosen.slot->num_packets_never_sent ==
+        static_cast<int>(chosen.slot->packet_sent_times.size())) {
+      timing.first_packet_sent_time = send_time;
+    }
+    if (--chosen.slot->num_packets_never_sent == 0) {
+      timing.last_packet_sent_time = send_time;
+    }
+  } else {
+    ++timing.num_retransmitted_packets;
+  }
+  packet_sent_time = send_time;
 
   ++pending_sender_report_.send_packet_count;
   // According to RFC3550, the octet count does not include the RTP header. The
@@ -265,6 +298,10 @@ void Sender::OnReceiverReferenceTimeAdvanced(Clock::time_point reference_time) {
 void Sender::OnReceiverReport(const RtcpReportBlock& receiver_report) {
   OSP_DCHECK_NE(rtcp_packet_arrival_time_, SenderPacketRouter::kNever);
 
+  stats_tracker_.RecordPacketLoss(
+      static_cast<double>(receiver_report.packet_fraction_lost_numerator) /
+      RtcpReportBlock::kPacketFractionLostDenominator);
+
   const Clock::duration total_delay =
       rtcp_packet_arrival_time_ -
       sender_report_builder_.GetRecentReportTime(
@@ -354,7 +391,7 @@ void Sender::OnReceiverCheckpoint(FrameId frame_id,
 
   while (checkpoint_frame_id_ < frame_id) {
     ++checkpoint_frame_id_;
-    CancelPendingFrame(checkpoint_frame_id_);
+    CancelPendingFrame(checkpoint_frame_id_, true);
   }
   latest_expected_frame_id_ = std::max(latest_expected_frame_id_, frame_id);
 
@@ -378,7 +415,7 @@ void Sender::OnReceiverHasFrames(std::vector<FrameId> acks) {
   }
 
   for (FrameId id : acks) {
-    CancelPendingFrame(id);
+    CancelPendingFrame(id, true);
   }
   latest_expected_frame_id_ = std::max(latest_expected_frame_id_, acks.back());
 }
@@ -456,6 +493,10 @@ void Sender::OnReceiverIsMissingPackets(std::vector<PacketNack> nacks) {
   }
 }
 
+void Sender::OnReceiverFrameStats(const RtcpReceiverFrameStats& stats) {
+  stats_tracker_.RecordReceiverFrameStats(stats);
+}
+
 Sender::ChosenPacket Sender::ChooseNextRtpPacketNeedingSend() {
   // Find the oldest packet needing to be sent (or re-sent).
   for (FrameId frame_id = checkpoint_frame_id_ + 1;
@@ -519,12 +560,19 @@ Sender::ChosenPacketAndWhen Sender::ChooseKickstartPacket() {
   return chosen;
 }
 
-void Sender::CancelPendingFrame(FrameId frame_id) {
+void Sender::CancelPendingFrame(FrameId frame_id, bool was_acked) {
   PendingFrameSlot* const slot = get_slot_for(frame_id);
   if (!slot->is_active_for_frame(frame_id)) {
     return;  // Frame was already canceled.
   }
 
+  // Only frames that were transmitted in full have a complete timeline. The
+  // Receiver may have skipped over the others.
+  if (was_acked && slot->num_packets_never_sent == 0) {
+    slot->timing.ack_time = rtcp_packet_arrival_time_;
+    stats_tracker_.RecordAckedFrame(slot->timing);
+  }
+
   packet_router_->OnPayloadReceived(
       slot->frame->data.size(), rtcp_packet_arrival_time_, round_trip_time_);
 
@@ -536,6 +584,14 @@ void Sender::CancelPendingFrame(FrameId frame_id) {
   }
 }
 
+void Sender::RecordCurrentState() {
+  stats_tracker_.RecordState(
+      num_frames_in_flight_,
+      GetInFlightMediaDuration(pending_sender_report_.rtp_timestamp),
+      GetMaxInFlightMediaDuration(), round_trip_time_,
+      packet_router_->ComputeNetworkBandwidth());
+}
+
 void Sender::Observer::OnFrameCanceled(FrameId frame_id) {}
 void Sender::Observer::OnPictureLost() {}
 Sender::Observer::~Observer() = default;
@@ -21,6 +21,7 @@
 #include "cast/streaming/rtp_time.h"
 #include "cast/streaming/sender_packet_router.h"
 #include "cast/streaming/sender_report_builder.h"
+#include "cast/streaming/sender_stats.h"
 #include "cast/streaming/session_config.h"
 #include "platform/api/time.h"
 #include "util/yet_another_bit_vector.h"
@@ -129,6 +130,13 @@ class Sender final : public SenderPacketRouter::Sender,
   // observing.
   void SetObserver(Observer* observer);
 
+  // Sets whether RTCP packets from the Receiver are ignored. This is used when
+  // a Sender replaces one with the same SSRCs (e.g., see
+  // SenderSession::ResumeMirroring()): until the Receiver has restarted its
+  // side, its feedback refers to the old Sender's frames, and would cancel the
+  // new Sender's frames having the same IDs.
+  void SetIgnoringReceiverFeedback(bool ignoring);
+
   // Returns the number of frames currently in-flight. This is only meant to be
   // informative. Clients should use GetInFlightMediaDuration() to make
   // throttling decisions.
@@ -165,13 +173,21 @@ class Sender final : public SenderPacketRouter::Sender,
   // All fields of the |frame| must be set to valid values: the |frame_id| must
   // be the same as GetNextFrameId(); both the |rtp_timestamp| and
   // |reference_time| fields must be monotonically increasing relative to the
-  // prior frame; and the frame's |data| pointer must be set.
+  // prior frame; and either the frame's |data| pointer or its |data_fragments|
+  // must be set. The payload is encrypted into a Sender-owned buffer before
+  // this method returns, so the caller may release or re-use the memory it
+  // references immediately afterwards.
   [[nodiscard]] EnqueueFrameResult EnqueueFrame(const EncodedFrame& frame);
 
   // Causes all pending operations to discard data when they are processed
   // later.
   void CancelInFlightData();
 
+  // Returns a snapshot of recent per-frame latency statistics, along with the
+  // in-flight media and bandwidth estimate as of the last enqueued frame or
+  // RTCP packet. Unlike the other methods, this may be called from any thread.
+  SenderStats GetStats() const;
+
  private:
   // Tracking/Storage for frames that are ready-to-send, and until they are
   // fully received at the other end.
@@ -189,6 +205,14 @@ class Sender final : public SenderPacketRouter::Sender,
     // re-transmitting any given packet too frequently.
     std::vector<Clock::time_point> packet_sent_times;
 
+    // The number of packets that have not been sent even once, used to detect
+    // when the whole frame has been transmitted.
+    int num_packets_never_sent = 0;
+
+    // The timeline of the frame, reported to the SenderStatsTracker once the
+    // frame is ACKed.
+    FrameTimingRecord timing;
+
     PendingFrameSlot();
     ~PendingFrameSlot();
 
@@ -230,6 +254,7 @@ class Sender final : public SenderPacketRouter::Sender,
                             std::chrono::milliseconds playout_delay) final;
   void OnReceiverHasFrames(std::vector<FrameId> acks) final;
   void OnReceiverIsMissingPackets(std::vector<PacketNack> nacks) final;
+  void OnReceiverFrameStats(const RtcpReceiverFrameStats& stats) final;
 
   // Helper to choose which packet to send, from those that have been flagged as
   // "need to send." Returns a "false" result if nothing needs to be sent.
@@ -243,7 +268,12 @@ class Sender final : public SenderPacketRouter::Sender,
   // Cancels the given frame once it is known to have been fully received (i.e.,
   // based on the ACK feedback from the Receiver in a RTCP packet). This clears
   // the corresponding entry in |pending_frames_| and notifies the Observer.
-  void CancelPendingFrame(FrameId frame_id);
+  // |was_acked| is false if the frame is being canceled for other reasons, in
+  // which case it is not included in the latency statistics.
+  void CancelPendingFrame(FrameId frame_id, bool was_acked);
+
+  // Provides the current in-flight and network state to |stats_tracker_|.
+  void RecordCurrentState();
 
   // Inline helper to return the slot that would contain the tracking info for
   // the given |frame_id|.
@@ -256,6 +286,7 @@ class Sender final : public SenderPacketRouter::Sender,
                             pending_frames_.size()];
   }
 
+  const ClockNowFunctionPtr now_;
   const SessionConfig config_;
   SenderPacketRouter* const packet_router_;
   RtcpSession rtcp_session_;
@@ -290,6 +321,9 @@ class Sender final : public SenderPacketRouter::Sender,
   std::chrono::milliseconds target_playout_delay_;
   FrameId playout_delay_change_at_frame_id_ = FrameId::first();
 
+  // If true, RTCP packets from the Receiver are dropped without being parsed.
+  bool ignoring_receiver_feedback_ = false;
+
   // The exact arrival time of the last RTCP packet.
   Clock::time_point rtcp_packet_arrival_time_ = SenderPacketRouter::kNever;
 
@@ -316,6 +350,8 @@ class Sender final : public SenderPacketRouter::Sender,
 
   // The current observer (optional).
   Observer* observer_ = nullptr;
+
+  SenderStatsTracker stats_tracker_;
 };
 
 }  // namespace cast
@@ -18,18 +18,14 @@ namespace cast {
 
 namespace {
 
-EnumNameTable<SenderMessage::Type, 4> kMessageTypeNames{
+EnumNameTable<SenderMessage::Type, 5> kMessageTypeNames{
     {{kMessageTypeOffer, SenderMessage::Type::kOffer},
      {"GET_STATUS", SenderMessage::Type::kGetStatus},
      {"GET_CAPABILITIES", SenderMessage::Type::kGetCapabilities},
-     {"RPC", SenderMessage::Type::kRpc}}};
-
-SenderMessage::Type GetMessageType(const Json::Value& root) {
-  std::string type;
-  if (!json::ParseAndValidateString(root[kMessageType], &type)) {
-    return SenderMessage::Type::kUnknown;
-  }
+     {"RPC", SenderMessage::Type::kRpc},
+     {kMessageTypeResume, SenderMessage::Type::kResume}}};
 
+SenderMessage::Type GetMessageTypeFromName(std::string type) {
   absl::AsciiStrToUpper(&type);
   ErrorOr<SenderMessage::Type> parsed = GetEnum(kMessageTypeNames, type);
 
@@ -44,24 +40,65 @@ ErrorOr<SenderMessage> SenderMessage::Parse(const Json::Value& value) {
     return Error(Error::Code::kParameterInvalid, "Empty JSON");
   }
 
+  const ErrorOr<std::string> document = json::Stringify(value);
+  if (document.is_error()) {
+    return document.error();
+  }
+  return ParseFromString(document.value());
+}
+
+// static
+ErrorOr<SenderMessage> SenderMessage::ParseFromString(
+    absl::string_view document) {
   SenderMessage message;
-  message.type = GetMessageType(value);
-  if (!json::ParseAndValidateInt(value[kSequenceNumber],
-                                 &(message.sequence_number))) {
-    message.sequence_number = -1;
+  std::string type;
+
+  // The type may well come after the body, so the body of each type is kept
+  // until the end.
+  ErrorOr<Offer> offer = json::CreateParseError("offer");
+  ErrorOr<Offer> resume = json::CreateParseError("offer");
+  std::string rpc;
+  bool has_rpc = false;
+
+  json::JsonReader reader(document);
+  if (reader.BeginObject()) {
+    absl::string_view key;
+    while (reader.NextMember(&key)) {
+      if (key == kMessageType) {
+        if (!json::ReadAndValidateString(&reader, &type)) {
+          type.clear();
+        }
+      } else if (key == kSequenceNumber) {
+        if (!json::ReadAndValidateInt(&reader, &message.sequence_number)) {
+          message.sequence_number = -1;
+        }
+      } else if (key == kOfferMessageBody) {
+        offer = Offer::Read(&reader);
+      } else if (key == kResumeMessageBody) {
+        resume = Offer::Read(&reader);
+      } else if (key == kRpcMessageBody) {
+        has_rpc = json::ReadAndValidateString(&reader, &rpc);
+      } else {
+        reader.SkipValue();
+      }
+    }
+  }
+  if (!reader.Finish()) {
+    return Error(Error::Code::kJsonParseError, "Invalid JSON");
   }
 
-  if (message.type == SenderMessage::Type::kOffer) {
-    ErrorOr<Offer> offer = Offer::Parse(value[kOfferMessageBody]);
-    if (offer.is_value()) {
-      message.body = std::move(offer.value());
+  message.type = GetMessageTypeFromName(std::move(type));
+  if (message.type == SenderMessage::Type::kOffer ||
+      message.type == SenderMessage::Type::kResume) {
+    ErrorOr<Offer>& parsed_offer =
+        message.type == SenderMessage::Type::kOffer ? offer : resume;
+    if (parsed_offer.is_value()) {
+      message.body = std::move(parsed_offer.value());
       message.valid = true;
     }
   } else if (message.type == SenderMessage::Type::kRpc) {
-    std::string rpc_body;
-    if (json::ParseAndValidateString(value[kRpcMessageBody], &rpc_body) &&
-        base64::Decode(rpc_body, &rpc_body)) {
-      message.body = rpc_body;
+    if (has_rpc && base64::Decode(rpc, &rpc)) {
+      message.body = std::move(rpc);
       message.valid = true;
     }
   } else if (message.type == SenderMessage::Type::kGetStatus ||
@@ -89,6 +126,10 @@ ErrorOr<Json::Value> SenderMessage::ToJson() const {
       root[kOfferMessageBody] = absl::get<Offer>(body).ToJson().value();
       break;
 
+    case SenderMessage::Type::kResume:
+      root[kResumeMessageBody] = absl::get<Offer>(body).ToJson().value();
+      break;
+
     case SenderMessage::Type::kRpc:
       root[kRpcMessageBody] = base64::Encode(absl::get<std::string>(body));
       break;
@@ -9,6 +9,7 @@
 #include <string>
 #include <vector>
 
+#include "absl/strings/string_view.h"
 #include "absl/types/variant.h"
 #include "cast/streaming/offer_messages.h"
 #include "json/value.h"
@@ -36,11 +37,22 @@ struct SenderMessage {
 
     // Rpc binary messages. The payload is base64-encoded.
     kRpc,
+
+    // RESUME request message, asking the receiver to restart the streams it
+    // last selected from an OFFER, using the new AES key and IV mask of each.
+    // The body is an Offer holding just those streams.
+    kResume,
   };
 
+  // Same as ParseFromString(json::Stringify(value)).
   static ErrorOr<SenderMessage> Parse(const Json::Value& value);
   ErrorOr<Json::Value> ToJson() const;
 
+  // Reads the message straight from |document|, without building a
+  // Json::Value. Returns an error for invalid JSON, or a document that is not
+  // an object.
+  static ErrorOr<SenderMessage> ParseFromString(absl::string_view document);
+
   Type type = Type::kUnknown;
   int32_t sequence_number = -1;
   bool valid = false;
@@ -0,0 +1,144 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/sender_message.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+#include "util/json/json_serialization.h"
+
+namespace openscreen {
+namespace cast {
+
+namespace {
+
+// The offer comes before the type, to check that it is picked up regardless.
+constexpr char kOfferMessage[] = R"({
+  "offer": {
+    "castMode": "mirroring",
+    "receiverGetStatus": true,
+    "supportedStreams": [
+      {
+        "index": 31337,
+        "type": "video_source",
+        "codecName": "vp8",
+        "rtpProfile": "cast",
+        "rtpPayloadType": 127,
+        "ssrc": 19088743,
+        "maxFrameRate": "60000/1000",
+        "timeBase": "1/90000",
+        "maxBitRate": 5000000,
+        "aesKey": "bbf109bf84513b456b13a184453b66ce",
+        "aesIvMask": "edaf9e4536e2b66191f560d9c04b2a69",
+        "resolutions": [{"width": 1280, "height": 720}]
+      },
+      {
+        "index": 1337,
+        "type": "audio_source",
+        "codecName": "opus",
+        "rtpProfile": "cast",
+        "rtpPayloadType": 97,
+        "ssrc": 19088747,
+        "bitRate": 124000,
+        "timeBase": "1/48000",
+        "channels": 2,
+        "aesKey": "51027e4e2347cbcb49d57ef10177aebc",
+        "aesIvMask": "7f12a19be62a36c04ae4116caaeff6d1"
+      }
+    ]
+  },
+  "seqNum": 1337,
+  "type": "OFFER"
+})";
+
+// Parses |document| both ways, checks that the results match, and returns the
+// streaming one.
+SenderMessage ParseBothWays(const std::string& document) {
+  ErrorOr<Json::Value> root = json::Parse(document);
+  EXPECT_TRUE(root.is_value());
+  ErrorOr<SenderMessage> expected = SenderMessage::Parse(root.value());
+  EXPECT_TRUE(expected.is_value());
+  ErrorOr<SenderMessage> actual = SenderMessage::ParseFromString(document);
+  EXPECT_TRUE(actual.is_value());
+  if (expected.is_error() || actual.is_error()) {
+    return {};
+  }
+
+  EXPECT_EQ(expected.value().type, actual.value().type);
+  EXPECT_EQ(expected.value().sequence_number, actual.value().sequence_number);
+  EXPECT_EQ(expected.value().valid, actual.value().valid);
+  EXPECT_EQ(expected.value().body.index(), actual.value().body.index());
+  return std::move(actual.value());
+}
+
+}  // namespace
+
+TEST(SenderMessageTest, ParsesOffer) {
+  const SenderMessage message = ParseBothWays(kOfferMessage);
+  ASSERT_EQ(SenderMessage::Type::kOffer, message.type);
+  EXPECT_EQ(1337, message.sequence_number);
+  EXPECT_TRUE(message.valid);
+  const Offer& offer = absl::get<Offer>(message.body);
+  EXPECT_TRUE(offer.supports_wifi_status_reporting);
+  ASSERT_EQ(1u, offer.video_streams.size());
+  EXPECT_EQ(31337, offer.video_streams[0].stream.index);
+  ASSERT_EQ(1u, offer.audio_streams.size());
+  EXPECT_EQ(1337, offer.audio_streams[0].stream.index);
+}
+
+TEST(SenderMessageTest, ParsesMessagesWithoutBodies) {
+  SenderMessage message =
+      ParseBothWays(R"({"seqNum": 820263770, "type": "GET_CAPABILITIES"})");
+  EXPECT_EQ(SenderMessage::Type::kGetCapabilities, message.type);
+  EXPECT_EQ(820263770, message.sequence_number);
+  EXPECT_TRUE(message.valid);
+
+  message = ParseBothWays(R"({
+    "get_status": ["wifiSnr", "wifiSpeed"],
+    "seqNum": 820263769,
+    "type": "get_status"
+  })");
+  EXPECT_EQ(SenderMessage::Type::kGetStatus, message.type);
+  EXPECT_TRUE(message.valid);
+}
+
+TEST(SenderMessageTest, ParsesRpc) {
+  const SenderMessage message = ParseBothWays(
+      R"({"type": "RPC", "seqNum": 2, "rpc": "SGVsbG8gd29ybGQh"})");
+  ASSERT_EQ(SenderMessage::Type::kRpc, message.type);
+  EXPECT_TRUE(message.valid);
+  EXPECT_EQ("Hello world!", absl::get<std::string>(message.body));
+}
+
+TEST(SenderMessageTest, MatchesParseForInvalidMessages) {
+  const std::string kDocuments[] = {
+      R"({"type": "OFFER", "seqNum": 1})",
+      R"({"type": "OFFER", "seqNum": 1, "offer": {"castMode": "mirroring"}})",
+      R"({"type": "OFFER", "seqNum": 1, "resume": {"supportedStreams": []}})",
+      R"({"type": "RPC", "seqNum": 1, "rpc": 42})",
+      R"({"type": "RPC", "seqNum": 1, "rpc": "not base64!"})",
+      R"({"type": "BOGUS", "seqNum": 1})",
+      R"({"type": ["OFFER"], "seqNum": 1})",
+      R"({"type": "GET_STATUS"})",
+      R"({"type": "GET_STATUS", "seqNum": -1})",
+      R"({"type": "GET_STATUS", "seqNum": 1.5})",
+  };
+  for (const std::string& document : kDocuments) {
+    SCOPED_TRACE(document);
+    ParseBothWays(document);
+  }
+}
+
+TEST(SenderMessageTest, ParseFromStringRejectsInvalidJson) {
+  for (const char* document :
+       {"", "{", "[]", R"({"type": "OFFER",})", R"({"type": 'OFFER'})"}) {
+    ErrorOr<SenderMessage> message = SenderMessage::ParseFromString(document);
+    ASSERT_TRUE(message.is_error()) << document;
+    EXPECT_EQ(Error::Code::kJsonParseError, message.error().code());
+  }
+}
+
+}  // namespace cast
+}  // namespace openscreen
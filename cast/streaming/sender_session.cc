@@ -8,18 +8,21 @@
 #include <stdint.h>
 
 #include <algorithm>
+#include <cmath>
 #include <iterator>
 #include <string>
 #include <utility>
 
 #include "absl/strings/match.h"
 #include "absl/strings/numbers.h"
+#include "cast/streaming/capture_ladder.h"
 #include "cast/streaming/capture_recommendations.h"
 #include "cast/streaming/environment.h"
 #include "cast/streaming/message_fields.h"
 #include "cast/streaming/offer_messages.h"
 #include "cast/streaming/sender.h"
 #include "cast/streaming/sender_message.h"
+#include "util/chrono_helpers.h"
 #include "util/crypto/random_bytes.h"
 #include "util/json/json_helpers.h"
 #include "util/json/json_serialization.h"
@@ -30,6 +33,15 @@ namespace cast {
 
 namespace {
 
+// How often the capture ladder is updated with a new bandwidth estimate.
+constexpr milliseconds kCaptureLadderUpdateInterval{500};
+
+// A prior bandwidth estimate, from a previous session, is discounted by this
+// factor, and then halved every kPriorBandwidthHalfLife, until the actual
+// estimate is available (normally within a couple of seconds).
+constexpr double kPriorBandwidthDiscount = 0.8;
+constexpr seconds kPriorBandwidthHalfLife{5};
+
 AudioStream CreateStream(int index, const AudioCaptureConfig& config) {
   return AudioStream{
       Stream{index,
@@ -136,8 +148,32 @@ bool AreAllValid(const std::vector<AudioCaptureConfig>& audio_configs,
                      IsValidVideoCaptureConfig);
 }
 
+bool IsSelected(const Answer& answer, const Stream& stream) {
+  return std::find(answer.send_indexes.begin(), answer.send_indexes.end(),
+                   stream.index) != answer.send_indexes.end();
+}
+
+// Restarting a stream's frame IDs with the same AES key and IV mask would reuse
+// AES-CTR nonces, so resumed streams must always be given new ones.
+template <typename S>
+void RotateSelectedStreamKeys(const Answer& answer,
+                              std::vector<S>* streams,
+                              std::vector<S>* resumed_streams) {
+  for (S& stream : *streams) {
+    if (IsSelected(answer, stream.stream)) {
+      stream.stream.aes_key = GenerateRandomBytes16();
+      stream.stream.aes_iv_mask = GenerateRandomBytes16();
+      resumed_streams->push_back(stream);
+    }
+  }
+}
+
 }  // namespace
 
+void SenderSession::Client::OnCaptureResolutionChanged(
+    const SenderSession* session,
+    const capture_recommendations::Resolution& resolution) {}
+
 SenderSession::Client::~Client() = default;
 
 SenderSession::SenderSession(IPAddress remote_address,
@@ -158,9 +194,39 @@ SenderSession::SenderSession(IPAddress remote_address,
             client_->OnError(this, error);
           },
           environment->task_runner()),
-      packet_router_(environment_) {
+      rpc_channel_(
+          environment->task_runner(),
+          [this](absl::Span<const uint8_t> batch) {
+            return messager_.SendBinaryRpcBatch(batch);
+          },
+          [this](std::vector<uint8_t> message) {
+            const Error error = messager_.SendOutboundMessage(SenderMessage{
+                SenderMessage::Type::kRpc, ++rpc_sequence_number_, true,
+                std::string(message.begin(), message.end())});
+            if (!error.ok()) {
+              OSP_DLOG_WARN << "Failed to send RPC message: " << error;
+            }
+          },
+          [this](const RpcMessageBatch& batch) {
+            rpc_broker_.ProcessBatchFromRemote(batch);
+          }),
+      rpc_broker_([this](std::vector<uint8_t> message) {
+        rpc_channel_.SendMessage(std::move(message));
+      }),
+      packet_router_(environment_),
+      capture_ladder_alarm_(environment_->now_function(),
+                            environment_->task_runner()) {
   OSP_DCHECK(client_);
   OSP_DCHECK(environment_);
+  messager_.SetHandler(
+      ReceiverMessage::Type::kRpc,
+      [this](ReceiverMessage message) { OnRpcMessage(std::move(message)); });
+  messager_.SetBinaryRpcHandler([this](absl::Span<const uint8_t> batch) {
+    const Error error = rpc_channel_.ProcessBatchFromRemote(batch);
+    if (!error.ok()) {
+      OSP_DLOG_WARN << "Received an invalid RPC batch: " << error;
+    }
+  });
 }
 
 SenderSession::~SenderSession() = default;
@@ -178,8 +244,12 @@ Error SenderSession::NegotiateMirroring(
   }
 
   Offer offer = CreateOffer(audio_configs, video_configs);
+  offer.supports_binary_rpc = messager_.SupportsBinaryMessages();
   current_negotiation_ = std::unique_ptr<Negotiation>(new Negotiation{
       offer, std::move(audio_configs), std::move(video_configs)});
+  current_answer_.reset();
+  capture_ladder_.reset();
+  capture_ladder_alarm_.Cancel();
 
   return messager_.SendRequest(
       SenderMessage{SenderMessage::Type::kOffer, ++current_sequence_number_,
@@ -188,8 +258,93 @@ Error SenderSession::NegotiateMirroring(
       [this](ReceiverMessage message) { OnAnswer(message); });
 }
 
+Error SenderSession::ResumeMirroring() {
+  if (!current_answer_) {
+    return Error(Error::Code::kOperationInvalid,
+                 "No successfully negotiated session to resume.");
+  }
+  OSP_DCHECK(current_negotiation_);
+
+  Offer resume_offer;
+  RotateSelectedStreamKeys(*current_answer_,
+                           &current_negotiation_->offer.audio_streams,
+                           &resume_offer.audio_streams);
+  RotateSelectedStreamKeys(*current_answer_,
+                           &current_negotiation_->offer.video_streams,
+                           &resume_offer.video_streams);
+
+  const Error error = messager_.SendRequest(
+      SenderMessage{SenderMessage::Type::kResume, ++current_sequence_number_,
+                    true, std::move(resume_offer)},
+      ReceiverMessage::Type::kResumeResponse,
+      [this](ReceiverMessage message) { OnResumeResponse(message); });
+  if (!error.ok()) {
+    return error;
+  }
+
+  // The new senders use the same SSRCs, so the old ones must be destroyed
+  // first.
+  current_audio_sender_.reset();
+  current_video_sender_.reset();
+  ConfiguredSenders senders = SpawnSenders(*current_answer_);
+
+  // Until the receiver confirms that it has restarted its receivers, any
+  // feedback is from the old ones, and refers to the old senders' frames.
+  for (Sender* sender :
+       {current_audio_sender_.get(), current_video_sender_.get()}) {
+    if (sender) {
+      sender->SetIgnoringReceiverFeedback(true);
+    }
+  }
+  client_->OnMirroringNegotiated(
+      this, std::move(senders),
+      capture_recommendations::GetRecommendations(*current_answer_));
+  return Error::None();
+}
+
 int SenderSession::GetEstimatedNetworkBandwidth() const {
-  return packet_router_.ComputeNetworkBandwidth();
+  const int bandwidth = packet_router_.ComputeNetworkBandwidth();
+  if (bandwidth > 0 || prior_bandwidth_ == 0) {
+    return bandwidth;
+  }
+  const Clock::duration elapsed = environment_->now() - prior_bandwidth_time_;
+  const double half_lives =
+      static_cast<double>(elapsed.count()) /
+      Clock::to_duration(kPriorBandwidthHalfLife).count();
+  return static_cast<int>(kPriorBandwidthDiscount * prior_bandwidth_ *
+                          std::exp2(-half_lives));
+}
+
+void SenderSession::SetPriorNetworkConditions(
+    const NetworkConditions& conditions) {
+  OSP_DCHECK_GE(conditions.bandwidth, 0);
+  prior_bandwidth_ = conditions.bandwidth;
+  prior_bandwidth_time_ = environment_->now();
+}
+
+absl::optional<NetworkConditions> SenderSession::GetNetworkConditions() const {
+  NetworkConditions conditions;
+  conditions.bandwidth = packet_router_.ComputeNetworkBandwidth();
+  if (conditions.bandwidth <= 0) {
+    return absl::nullopt;
+  }
+  for (const Sender* sender :
+       {current_audio_sender_.get(), current_video_sender_.get()}) {
+    if (sender) {
+      const SenderStats stats = sender->GetStats();
+      conditions.round_trip_time =
+          std::max(conditions.round_trip_time, stats.round_trip_time);
+      conditions.packet_loss_fraction =
+          std::max(conditions.packet_loss_fraction, stats.packet_loss_fraction);
+    }
+  }
+  return conditions;
+}
+
+void SenderSession::ReportVideoEncoderUtilization(double utilization) {
+  if (capture_ladder_) {
+    capture_ladder_->OnEncoderUtilization(utilization);
+  }
 }
 
 void SenderSession::OnAnswer(ReceiverMessage message) {
@@ -208,14 +363,70 @@ void SenderSession::OnAnswer(ReceiverMessage message) {
   }
 
   const Answer& answer = absl::get<Answer>(message.body);
+  if (current_negotiation_->offer.supports_binary_rpc &&
+      answer.supports_binary_rpc) {
+    rpc_channel_.EnableBinaryMessages();
+  }
   ConfiguredSenders senders = SpawnSenders(answer);
   // If we didn't select any senders, the negotiation was unsuccessful.
   if (senders.audio_sender == nullptr && senders.video_sender == nullptr) {
     return;
   }
-  client_->OnMirroringNegotiated(
-      this, std::move(senders),
-      capture_recommendations::GetRecommendations(answer));
+  current_answer_ = std::make_unique<Answer>(answer);
+  capture_recommendations::Recommendations recommendations =
+      capture_recommendations::GetRecommendations(answer);
+  if (senders.video_sender) {
+    capture_ladder_ = std::make_unique<CaptureLadder>(senders.video_config,
+                                                      recommendations.video);
+    capture_ladder_alarm_.ScheduleFromNow([this] { UpdateCaptureLadder(); },
+                                          kCaptureLadderUpdateInterval);
+  }
+  client_->OnMirroringNegotiated(this, std::move(senders),
+                                 std::move(recommendations));
+}
+
+void SenderSession::OnResumeResponse(ReceiverMessage message) {
+  // Ignore the response if the session has since been renegotiated, or resumed
+  // again.
+  if (message.sequence_number != current_sequence_number_) {
+    return;
+  }
+
+  if (message.valid) {
+    // The receiver has restarted its receivers, so the senders may now act on
+    // its feedback.
+    for (Sender* sender :
+         {current_audio_sender_.get(), current_video_sender_.get()}) {
+      if (sender) {
+        sender->SetIgnoringReceiverFeedback(false);
+      }
+    }
+    return;
+  }
+
+  // The receiver either could not resume its side of the session, or did not
+  // reply in time (e.g., it does not support RESUME messages). Fall back to
+  // negotiating a new session.
+  OSP_LOG_WARN << "Failed to resume session, renegotiating...";
+  OSP_DCHECK(current_negotiation_);
+  const Error error = NegotiateMirroring(current_negotiation_->audio_configs,
+                                         current_negotiation_->video_configs);
+  if (!error.ok()) {
+    client_->OnError(this, error);
+  }
+}
+
+void SenderSession::OnRpcMessage(ReceiverMessage message) {
+  if (!message.valid) {
+    OSP_DLOG_WARN << "Received an invalid RPC message";
+    return;
+  }
+  RpcMessage rpc;
+  if (!rpc.ParseFromString(absl::get<std::string>(message.body))) {
+    OSP_DLOG_WARN << "Failed to parse RPC message from receiver";
+    return;
+  }
+  rpc_broker_.ProcessMessageFromRemote(rpc);
 }
 
 std::unique_ptr<Sender> SenderSession::CreateSender(Ssrc receiver_ssrc,
@@ -299,5 +510,18 @@ SenderSession::ConfiguredSenders SenderSession::SpawnSenders(
   return senders;
 }
 
+void SenderSession::UpdateCaptureLadder() {
+  OSP_DCHECK(capture_ladder_);
+  const int bandwidth = GetEstimatedNetworkBandwidth();
+  if (bandwidth > 0) {
+    capture_ladder_->OnBandwidthEstimate(bandwidth);
+  }
+  capture_ladder_alarm_.ScheduleFromNow([this] { UpdateCaptureLadder(); },
+                                        kCaptureLadderUpdateInterval);
+  if (capture_ladder_->Update(environment_->now())) {
+    client_->OnCaptureResolutionChanged(this, capture_ladder_->current());
+  }
+}
+
 }  // namespace cast
 }  // namespace openscreen
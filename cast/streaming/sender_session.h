@@ -10,15 +10,20 @@
 #include <utility>
 #include <vector>
 
+#include "absl/types/optional.h"
 #include "cast/common/public/message_port.h"
 #include "cast/streaming/answer_messages.h"
+#include "cast/streaming/binary_rpc_channel.h"
 #include "cast/streaming/capture_configs.h"
+#include "cast/streaming/network_history_cache.h"
 #include "cast/streaming/offer_messages.h"
+#include "cast/streaming/rpc_broker.h"
 #include "cast/streaming/sender.h"
 #include "cast/streaming/sender_packet_router.h"
 #include "cast/streaming/session_config.h"
 #include "cast/streaming/session_messager.h"
 #include "json/value.h"
+#include "util/alarm.h"
 #include "util/json/json_serialization.h"
 
 namespace openscreen {
@@ -26,8 +31,10 @@ namespace cast {
 
 namespace capture_recommendations {
 struct Recommendations;
-}
+struct Resolution;
+}  // namespace capture_recommendations
 
+class CaptureLadder;
 class Environment;
 class Sender;
 
@@ -56,9 +63,10 @@ class SenderSession final {
    public:
     // Called when a new set of senders has been negotiated. This may be
     // called multiple times during a session, once for every time
-    // NegotiateMirroring() is called on the SenderSession object. The
-    // negotiation call also includes capture recommendations that can be used
-    // by the sender to provide an optimal video stream for the receiver.
+    // NegotiateMirroring() or ResumeMirroring() is called on the SenderSession
+    // object. The negotiation call also includes capture recommendations that
+    // can be used by the sender to provide an optimal video stream for the
+    // receiver.
     virtual void OnMirroringNegotiated(
         const SenderSession* session,
         ConfiguredSenders senders,
@@ -69,6 +77,17 @@ class SenderSession final {
     // streaming.
     virtual void OnError(const SenderSession* session, Error error) = 0;
 
+    // Called when the video capture resolution and frame rate should change,
+    // to adapt to the network and video encoder conditions during a session.
+    // The encoder will produce a key frame at the new resolution; no other key
+    // frames are needed. Before the first call, the capture should use the
+    // highest resolution and frame rate allowed by the negotiated config and
+    // recommendations. See CaptureLadder. The default implementation ignores
+    // these changes.
+    virtual void OnCaptureResolutionChanged(
+        const SenderSession* session,
+        const capture_recommendations::Resolution& resolution);
+
    protected:
     virtual ~Client();
   };
@@ -100,11 +119,56 @@ class SenderSession final {
   Error NegotiateMirroring(std::vector<AudioCaptureConfig> audio_configs,
                            std::vector<VideoCaptureConfig> video_configs);
 
+  // Restarts the senders from the last successful negotiation, without waiting
+  // on another OFFER/ANSWER exchange: new senders, with the same SSRCs but
+  // fresh crypto parameters, are handed to the Client's OnMirroringNegotiated()
+  // before this method returns. Their frame IDs start over, and the first frame
+  // each one sends must be a key frame. Meanwhile, a RESUME message tells the
+  // receiver to restart its receivers in the same way. If the receiver does
+  // not confirm this in time, a full renegotiation using the last capture
+  // configs is started instead. As with NegotiateMirroring(), the caller should
+  // assume any previously configured senders become invalid.
+  //
+  // NOTE: Until the receiver has processed the RESUME message, packets from
+  // the new senders reach its old receivers, whose feedback refers to the old
+  // senders' frames. So, the new senders ignore all feedback until the
+  // receiver confirms the RESUME; they then retransmit whatever the new
+  // receivers report as missing.
+  Error ResumeMirroring();
+
   // Get the current network usage (in bits per second). This includes all
   // senders managed by this session, and is a best guess based on receiver
   // feedback. Embedders may use this information to throttle capture devices.
+  // Until there has been enough feedback, this returns the prior estimate (see
+  // SetPriorNetworkConditions()), if any, or zero.
   int GetEstimatedNetworkBandwidth() const;
 
+  // Seeds the network bandwidth estimate with the |conditions| measured at the
+  // end of a previous session with the same receiver (see NetworkHistoryCache),
+  // so that streaming can start at a good bitrate and capture resolution. The
+  // prior estimate is discounted, and decays over time, so that a network that
+  // has become worse cannot cause lasting harm; and it is replaced by the
+  // actual estimate as soon as there is enough feedback from the receiver.
+  void SetPriorNetworkConditions(const NetworkConditions& conditions);
+
+  // Returns the current network conditions, for adapting the encoders or for
+  // saving to a NetworkHistoryCache at the end of the session; or nullopt if
+  // there has not yet been enough feedback from the receiver to estimate them.
+  absl::optional<NetworkConditions> GetNetworkConditions() const;
+
+  // Reports how much of its budget the video encoder used for the last frame:
+  // the max of the utilization metrics in StreamingVideoEncoder::Stats. Along
+  // with the network bandwidth estimate, this is used to adapt the video
+  // capture resolution and frame rate. See
+  // Client::OnCaptureResolutionChanged().
+  void ReportVideoEncoderUtilization(double utilization);
+
+  // The broker for RPC messages exchanged with the receiver, e.g. for
+  // remoting. They are sent as batches of binary payloads if both sides
+  // advertised support in the OFFER/ANSWER exchange, and as JSON RPC messages
+  // otherwise.
+  RpcBroker* rpc_broker() { return &rpc_broker_; }
+
  private:
   // We store the current negotiation, so that when we get an answer from the
   // receiver we can line up the selected streams with the original
@@ -118,6 +182,8 @@ class SenderSession final {
 
   // Specific message type handler methods.
   void OnAnswer(ReceiverMessage message);
+  void OnResumeResponse(ReceiverMessage message);
+  void OnRpcMessage(ReceiverMessage message);
 
   // Used by SpawnSenders to generate a sender for a specific stream.
   std::unique_ptr<Sender> CreateSender(Ssrc receiver_ssrc,
@@ -137,6 +203,10 @@ class SenderSession final {
   // Spawn a set of configured senders from the currently stored negotiation.
   ConfiguredSenders SpawnSenders(const Answer& answer);
 
+  // Periodically feeds the bandwidth estimate to the |capture_ladder_|, and
+  // notifies the client when it moves to another rung.
+  void UpdateCaptureLadder();
+
   // The remote address of the receiver we are communicating with. Used
   // for both TLS and UDP traffic.
   const IPAddress remote_address_;
@@ -148,6 +218,13 @@ class SenderSession final {
   Environment* const environment_;
   SenderSessionMessager messager_;
 
+  // Carries the |rpc_broker_|'s messages over the |messager_|. RPC messages
+  // have their own sequence numbers, so that they do not interfere with
+  // matching replies to the current negotiation.
+  BinaryRpcChannel rpc_channel_;
+  RpcBroker rpc_broker_;
+  int rpc_sequence_number_ = 0;
+
   // The packet router used for messaging across all senders.
   SenderPacketRouter packet_router_;
 
@@ -160,10 +237,24 @@ class SenderSession final {
   // the receiver. If not present, any provided ANSWERS are rejected.
   std::unique_ptr<Negotiation> current_negotiation_;
 
+  // The ANSWER to the current negotiation, once it has succeeded. If present,
+  // the session may be resumed with ResumeMirroring().
+  std::unique_ptr<Answer> current_answer_;
+
   // If the negotiation has succeeded, we store the current audio and video
   // senders used for this session. Either or both may be nullptr.
   std::unique_ptr<Sender> current_audio_sender_;
   std::unique_ptr<Sender> current_video_sender_;
+
+  // The bandwidth estimate to use until there is an actual one, and when it
+  // was provided. Zero if none.
+  int prior_bandwidth_ = 0;
+  Clock::time_point prior_bandwidth_time_{};
+
+  // Adapts the video capture resolution and frame rate while there is a
+  // negotiated video sender.
+  std::unique_ptr<CaptureLadder> capture_ladder_;
+  Alarm capture_ladder_alarm_;
 };  // namespace cast
 
 }  // namespace cast
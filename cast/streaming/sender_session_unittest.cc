@@ -9,11 +9,15 @@
 
 #include "cast/streaming/capture_configs.h"
 #include "cast/streaming/capture_recommendations.h"
+#include "cast/streaming/compound_rtcp_builder.h"
+#include "cast/streaming/encoded_frame.h"
 #include "cast/streaming/mock_environment.h"
+#include "cast/streaming/rtcp_session.h"
 #include "cast/streaming/testing/simple_message_port.h"
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "platform/base/ip_address.h"
+#include "platform/base/udp_packet.h"
 #include "platform/test/fake_clock.h"
 #include "platform/test/fake_task_runner.h"
 #include "util/chrono_helpers.h"
@@ -158,7 +162,23 @@ class SenderSessionTest : public ::testing::Test {
         message_port_.get(), "sender-12345", "receiver-12345");
   }
 
-  std::string NegotiateOfferAndConstructAnswer() {
+  // Negotiates a session, and then resumes it, returning the RESUME message.
+  Json::Value NegotiateAndResume() {
+    EXPECT_CALL(client_, OnMirroringNegotiated(session_.get(), _, _)).Times(2);
+    message_port_->ReceiveMessage(NegotiateOfferAndConstructAnswer());
+    EXPECT_TRUE(session_->ResumeMirroring().ok());
+
+    const auto& messages = message_port_->posted_messages();
+    EXPECT_EQ(2u, messages.size());
+    auto message_body = json::Parse(messages.back());
+    EXPECT_TRUE(message_body.is_value());
+    return std::move(message_body.value());
+  }
+
+  // If |supports_binary_rpc|, the ANSWER advertises support for binary RPC
+  // messages.
+  std::string NegotiateOfferAndConstructAnswer(
+      bool supports_binary_rpc = false) {
     const Error error = session_->NegotiateMirroring(
         std::vector<AudioCaptureConfig>{kAudioCaptureConfigValid},
         std::vector<VideoCaptureConfig>{kVideoCaptureConfigValid});
@@ -200,14 +220,16 @@ class SenderSessionTest : public ::testing::Test {
         "seqNum": %d,
         "result": "ok",
         "answer": {
-          "castMode": "mirroring",
+          "castMode": "mirroring",%s
           "udpPort": 1234,
           "sendIndexes": [%d, %d],
           "ssrcs": [%d, %d]
         }
         })";
-    return StringPrintf(kAnswerTemplate, offer["seqNum"].asInt(), audio_index,
-                        video_index, audio_ssrc + 1, video_ssrc + 1);
+    return StringPrintf(kAnswerTemplate, offer["seqNum"].asInt(),
+                        supports_binary_rpc ? R"( "binaryRpc": true,)" : "",
+                        audio_index, video_index, audio_ssrc + 1,
+                        video_ssrc + 1);
   }
 
  protected:
@@ -459,6 +481,237 @@ TEST_F(SenderSessionTest, ReportsZeroBandwidthWhenNoPacketsSent) {
   // we need to ensure that we are providing reasonable network bandwidth
   // measurements.
   EXPECT_EQ(0, session_->GetEstimatedNetworkBandwidth());
+  EXPECT_FALSE(session_->GetNetworkConditions());
+}
+
+TEST_F(SenderSessionTest, UsesDecayingPriorBandwidthUntilEstimated) {
+  NetworkConditions conditions;
+  conditions.bandwidth = 10 * 1000 * 1000;
+  session_->SetPriorNetworkConditions(conditions);
+
+  // The prior is discounted at first, and then decays over time.
+  const int initial_bandwidth = session_->GetEstimatedNetworkBandwidth();
+  EXPECT_LT(0, initial_bandwidth);
+  EXPECT_GT(conditions.bandwidth, initial_bandwidth);
+  clock_.Advance(seconds(5));
+  EXPECT_EQ(initial_bandwidth / 2, session_->GetEstimatedNetworkBandwidth());
+  clock_.Advance(seconds(60));
+  EXPECT_GT(initial_bandwidth / 1000,
+            session_->GetEstimatedNetworkBandwidth());
+
+  // The prior is never reported back as the measured conditions.
+  EXPECT_FALSE(session_->GetNetworkConditions());
+}
+
+TEST_F(SenderSessionTest, ComplainsIfNothingToResume) {
+  EXPECT_EQ(Error::Code::kOperationInvalid, session_->ResumeMirroring().code());
+
+  // Nor can a session be resumed until the receiver has answered.
+  session_->NegotiateMirroring(
+      std::vector<AudioCaptureConfig>{kAudioCaptureConfigValid},
+      std::vector<VideoCaptureConfig>{kVideoCaptureConfigValid});
+  EXPECT_EQ(Error::Code::kOperationInvalid, session_->ResumeMirroring().code());
+}
+
+TEST_F(SenderSessionTest, ResumesSessionWithNewKeys) {
+  std::vector<SessionConfig> configs;
+  EXPECT_CALL(client_, OnMirroringNegotiated(session_.get(), _, _))
+      .Times(2)
+      .WillRepeatedly([&configs](const SenderSession*,
+                                 SenderSession::ConfiguredSenders senders,
+                                 capture_recommendations::Recommendations) {
+        ASSERT_TRUE(senders.audio_sender);
+        ASSERT_TRUE(senders.video_sender);
+        configs.push_back(senders.audio_sender->config());
+        configs.push_back(senders.video_sender->config());
+      });
+  message_port_->ReceiveMessage(NegotiateOfferAndConstructAnswer());
+  ASSERT_TRUE(session_->ResumeMirroring().ok());
+
+  // The senders are restarted immediately, with the same SSRCs, but new keys.
+  ASSERT_EQ(4u, configs.size());
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(configs[i].sender_ssrc, configs[i + 2].sender_ssrc);
+    EXPECT_EQ(configs[i].receiver_ssrc, configs[i + 2].receiver_ssrc);
+    EXPECT_NE(configs[i].aes_secret_key, configs[i + 2].aes_secret_key);
+    EXPECT_NE(configs[i].aes_iv_mask, configs[i + 2].aes_iv_mask);
+  }
+
+  const auto& messages = message_port_->posted_messages();
+  ASSERT_EQ(2u, messages.size());
+  auto offer = json::Parse(messages[0]);
+  auto resume = json::Parse(messages[1]);
+  ASSERT_TRUE(offer.is_value());
+  ASSERT_TRUE(resume.is_value());
+  EXPECT_EQ("RESUME", resume.value()["type"].asString());
+  EXPECT_LT(offer.value()["seqNum"].asInt(), resume.value()["seqNum"].asInt());
+
+  const Json::Value& offered = offer.value()["offer"]["supportedStreams"];
+  const Json::Value& resumed = resume.value()["resume"]["supportedStreams"];
+  ASSERT_TRUE(resumed.isArray());
+  ASSERT_EQ(2u, resumed.size());
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_EQ(offered[i]["index"].asInt(), resumed[i]["index"].asInt());
+    EXPECT_EQ(offered[i]["ssrc"].asUInt(), resumed[i]["ssrc"].asUInt());
+    EXPECT_EQ(offered[i]["codecName"].asString(),
+              resumed[i]["codecName"].asString());
+    EXPECT_NE(offered[i]["aesKey"].asString(), resumed[i]["aesKey"].asString());
+    EXPECT_NE(offered[i]["aesIvMask"].asString(),
+              resumed[i]["aesIvMask"].asString());
+  }
+}
+
+TEST_F(SenderSessionTest, DoesNotRenegotiateIfResumeSucceeds) {
+  const Json::Value resume = NegotiateAndResume();
+
+  constexpr char kResponseTemplate[] = R"({
+      "type": "RESUME_RESPONSE",
+      "seqNum": %d,
+      "result": "ok"
+  })";
+  message_port_->ReceiveMessage(
+      StringPrintf(kResponseTemplate, resume["seqNum"].asInt()));
+  clock_.Advance(seconds(5));
+  EXPECT_EQ(2u, message_port_->posted_messages().size());
+}
+
+TEST_F(SenderSessionTest, IgnoresStaleFeedbackUntilResumeIsConfirmed) {
+  Sender* video_sender = nullptr;
+  EXPECT_CALL(client_, OnMirroringNegotiated(session_.get(), _, _))
+      .Times(2)
+      .WillRepeatedly(
+          [&video_sender](const SenderSession*,
+                          SenderSession::ConfiguredSenders senders,
+                          capture_recommendations::Recommendations) {
+            video_sender = senders.video_sender;
+          });
+  message_port_->ReceiveMessage(NegotiateOfferAndConstructAnswer());
+  ASSERT_TRUE(session_->ResumeMirroring().ok());
+  ASSERT_TRUE(video_sender);
+
+  // The new sender starts over from the first frame ID.
+  std::vector<uint8_t> payload(100);
+  EncodedFrame frame;
+  frame.dependency = EncodedFrame::KEY_FRAME;
+  frame.frame_id = video_sender->GetNextFrameId();
+  ASSERT_EQ(FrameId::first(), frame.frame_id);
+  frame.referenced_frame_id = frame.frame_id;
+  frame.reference_time = clock_.now();
+  frame.data = absl::Span<uint8_t>(payload);
+  ASSERT_EQ(Sender::OK, video_sender->EnqueueFrame(frame));
+  ASSERT_EQ(1, video_sender->GetInFlightFrameCount());
+
+  // The receiver's old receivers, which have the same SSRCs, report a
+  // checkpoint for one of the old sender's frames that has the same ID.
+  const SessionConfig& config = video_sender->config();
+  RtcpSession rtcp_session(config.sender_ssrc, config.receiver_ssrc,
+                           clock_.now());
+  CompoundRtcpBuilder rtcp_builder(&rtcp_session);
+  rtcp_builder.SetPlayoutDelay(config.target_playout_delay);
+  rtcp_builder.SetCheckpointFrame(FrameId::first());
+  uint8_t buffer[kMaxRtpPacketSizeForIpv6UdpOnEthernet];
+  const absl::Span<uint8_t> rtcp_packet =
+      rtcp_builder.BuildPacket(clock_.now(), buffer);
+  const auto deliver_rtcp_packet = [&] {
+    UdpPacket packet(rtcp_packet.begin(), rtcp_packet.end());
+    packet.set_source(environment_->remote_endpoint());
+    static_cast<UdpSocket::Client*>(environment_.get())
+        ->OnRead(nullptr, std::move(packet));
+  };
+
+  // The stale checkpoint must not cancel the new sender's key frame.
+  deliver_rtcp_packet();
+  EXPECT_EQ(1, video_sender->GetInFlightFrameCount());
+
+  // Once the receiver confirms the RESUME, its feedback is acted upon.
+  const Json::Value resume =
+      json::Parse(message_port_->posted_messages().back()).value();
+  constexpr char kResponseTemplate[] = R"({
+      "type": "RESUME_RESPONSE",
+      "seqNum": %d,
+      "result": "ok"
+  })";
+  message_port_->ReceiveMessage(
+      StringPrintf(kResponseTemplate, resume["seqNum"].asInt()));
+  deliver_rtcp_packet();
+  EXPECT_EQ(0, video_sender->GetInFlightFrameCount());
+}
+
+TEST_F(SenderSessionTest, RenegotiatesIfResumeIsRejected) {
+  const Json::Value resume = NegotiateAndResume();
+
+  constexpr char kResponseTemplate[] = R"({
+      "type": "RESUME_RESPONSE",
+      "seqNum": %d,
+      "result": "error",
+      "error": {
+        "code": 123,
+        "description": "No session to resume"
+      }
+  })";
+  message_port_->ReceiveMessage(
+      StringPrintf(kResponseTemplate, resume["seqNum"].asInt()));
+
+  const auto& messages = message_port_->posted_messages();
+  ASSERT_EQ(3u, messages.size());
+  auto offer = json::Parse(messages[2]);
+  ASSERT_TRUE(offer.is_value());
+  EXPECT_EQ("OFFER", offer.value()["type"].asString());
+  EXPECT_EQ(2u, offer.value()["offer"]["supportedStreams"].size());
+}
+
+TEST_F(SenderSessionTest, RenegotiatesIfResumeTimesOut) {
+  NegotiateAndResume();
+
+  clock_.Advance(seconds(5));
+  const auto& messages = message_port_->posted_messages();
+  ASSERT_EQ(3u, messages.size());
+  auto offer = json::Parse(messages[2]);
+  ASSERT_TRUE(offer.is_value());
+  EXPECT_EQ("OFFER", offer.value()["type"].asString());
+}
+
+TEST_F(SenderSessionTest, SendsBinaryRpcMessagesIfBothSidesSupportThem) {
+  message_port_->set_supports_binary_messages(true);
+  EXPECT_CALL(client_, OnMirroringNegotiated(session_.get(), _, _));
+  message_port_->ReceiveMessage(NegotiateOfferAndConstructAnswer(true));
+  auto offer = json::Parse(message_port_->posted_messages()[0]);
+  ASSERT_TRUE(offer.is_value());
+  EXPECT_TRUE(offer.value()["offer"]["binaryRpc"].asBool());
+
+  session_->rpc_broker()->SendMessageToRemote(RpcMessage{});
+  session_->rpc_broker()->SendMessageToRemote(RpcMessage{});
+  task_runner_.RunTasksUntilIdle();
+  EXPECT_EQ(1u, message_port_->posted_binary_messages().size());
+  EXPECT_EQ(1u, message_port_->posted_messages().size());
+}
+
+TEST_F(SenderSessionTest, SendsJsonRpcMessagesIfReceiverDoesNotSupportBinary) {
+  message_port_->set_supports_binary_messages(true);
+  EXPECT_CALL(client_, OnMirroringNegotiated(session_.get(), _, _));
+  message_port_->ReceiveMessage(NegotiateOfferAndConstructAnswer());
+
+  session_->rpc_broker()->SendMessageToRemote(RpcMessage{});
+  task_runner_.RunTasksUntilIdle();
+  EXPECT_TRUE(message_port_->posted_binary_messages().empty());
+  const auto& messages = message_port_->posted_messages();
+  ASSERT_EQ(2u, messages.size());
+  auto rpc = json::Parse(messages[1]);
+  ASSERT_TRUE(rpc.is_value());
+  EXPECT_EQ("RPC", rpc.value()["type"].asString());
+}
+
+TEST_F(SenderSessionTest, SendsJsonRpcMessagesIfPortDoesNotSupportBinary) {
+  EXPECT_CALL(client_, OnMirroringNegotiated(session_.get(), _, _));
+  message_port_->ReceiveMessage(NegotiateOfferAndConstructAnswer(true));
+  auto offer = json::Parse(message_port_->posted_messages()[0]);
+  ASSERT_TRUE(offer.is_value());
+  EXPECT_FALSE(offer.value()["offer"].isMember("binaryRpc"));
+
+  session_->rpc_broker()->SendMessageToRemote(RpcMessage{});
+  task_runner_.RunTasksUntilIdle();
+  EXPECT_TRUE(message_port_->posted_binary_messages().empty());
+  EXPECT_EQ(2u, message_port_->posted_messages().size());
 }
 
 }  // namespace cast
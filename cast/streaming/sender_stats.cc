@@ -0,0 +1,127 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/sender_stats.h"
+
+#include <algorithm>
+#include <vector>
+
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+namespace {
+
+// Computes the percentiles of |values|, by the nearest-rank method. |values| is
+// re-ordered in the process.
+template <typename T>
+Percentiles<T> ComputePercentiles(std::vector<T>* values) {
+  Percentiles<T> result;
+  if (values->empty()) {
+    return result;
+  }
+  const auto nth = [values](int percentile) {
+    const size_t rank = (values->size() * percentile + 99) / 100;
+    const auto it = values->begin() + (std::max<size_t>(rank, 1) - 1);
+    std::nth_element(values->begin(), it, values->end());
+    return *it;
+  };
+  result.p50 = nth(50);
+  result.p95 = nth(95);
+  result.p99 = nth(99);
+  return result;
+}
+
+}  // namespace
+
+SenderStatsTracker::SenderStatsTracker() = default;
+SenderStatsTracker::~SenderStatsTracker() = default;
+
+void SenderStatsTracker::RecordAckedFrame(const FrameTimingRecord& record) {
+  OSP_DCHECK_LE(record.enqueue_time, record.first_packet_sent_time);
+  OSP_DCHECK_LE(record.first_packet_sent_time, record.last_packet_sent_time);
+
+  const FrameSample sample{
+      record.first_packet_sent_time - record.enqueue_time,
+      record.last_packet_sent_time - record.first_packet_sent_time,
+      record.ack_time - record.last_packet_sent_time,
+      record.num_retransmitted_packets};
+
+  std::lock_guard<std::mutex> lock(mutex_);
+  samples_[num_samples_ % kWindowSize] = sample;
+  ++num_samples_;
+  state_.total_retransmitted_packets += record.num_retransmitted_packets;
+}
+
+void SenderStatsTracker::RecordState(
+    int in_flight_frame_count,
+    Clock::duration in_flight_media_duration,
+    Clock::duration max_in_flight_media_duration,
+    Clock::duration round_trip_time,
+    int bandwidth_estimate) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  state_.in_flight_frame_count = in_flight_frame_count;
+  state_.in_flight_media_duration = in_flight_media_duration;
+  state_.max_in_flight_media_duration = max_in_flight_media_duration;
+  state_.round_trip_time = round_trip_time;
+  state_.bandwidth_estimate = bandwidth_estimate;
+}
+
+void SenderStatsTracker::RecordReceiverFrameStats(
+    const RtcpReceiverFrameStats& stats) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  state_.receiver_frame_stats = stats;
+}
+
+void SenderStatsTracker::RecordPacketLoss(double packet_loss_fraction) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  state_.packet_loss_fraction = packet_loss_fraction;
+}
+
+SenderStats SenderStatsTracker::GetStats() const {
+  std::array<FrameSample, kWindowSize> samples;
+  SenderStats stats;
+  {
+    std::lock_guard<std::mutex> lock(mutex_);
+    stats = state_;
+    stats.num_frames =
+        static_cast<int>(std::min<int64_t>(num_samples_, kWindowSize));
+    std::copy(samples_.begin(), samples_.begin() + stats.num_frames,
+              samples.begin());
+  }
+
+  std::vector<Clock::duration> queueing_delays;
+  std::vector<Clock::duration> transmit_durations;
+  std::vector<Clock::duration> ack_delays;
+  std::vector<Clock::duration> total_latencies;
+  std::vector<int> retransmitted_packets;
+  queueing_delays.reserve(stats.num_frames);
+  transmit_durations.reserve(stats.num_frames);
+  ack_delays.reserve(stats.num_frames);
+  total_latencies.reserve(stats.num_frames);
+  retransmitted_packets.reserve(stats.num_frames);
+  for (int i = 0; i < stats.num_frames; ++i) {
+    const FrameSample& sample = samples[i];
+    queueing_delays.push_back(sample.queueing_delay);
+    transmit_durations.push_back(sample.transmit_duration);
+    ack_delays.push_back(sample.ack_delay);
+    total_latencies.push_back(sample.queueing_delay +
+                              sample.transmit_duration + sample.ack_delay);
+    retransmitted_packets.push_back(sample.num_retransmitted_packets);
+  }
+
+  stats.queueing_delay = ComputePercentiles(&queueing_delays);
+  stats.transmit_duration = ComputePercentiles(&transmit_durations);
+  stats.ack_delay = ComputePercentiles(&ack_delays);
+  stats.total_latency = ComputePercentiles(&total_latencies);
+  stats.retransmitted_packets = ComputePercentiles(&retransmitted_packets);
+  return stats;
+}
+
+// static
+constexpr int SenderStatsTracker::kWindowSize;
+
+}  // namespace cast
+}  // namespace openscreen
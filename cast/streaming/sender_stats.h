@@ -0,0 +1,141 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STREAMING_SENDER_STATS_H_
+#define CAST_STREAMING_SENDER_STATS_H_
+
+#include <stdint.h>
+
+#include <array>
+#include <mutex>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/types/optional.h"
+#include "cast/streaming/rtcp_common.h"
+#include "platform/api/time.h"
+
+namespace openscreen {
+namespace cast {
+
+// The 50th, 95th and 99th percentiles of a distribution.
+template <typename T>
+struct Percentiles {
+  T p50{};
+  T p95{};
+  T p99{};
+};
+
+// A snapshot of a Sender's recent behavior, for diagnosing where end-to-end
+// latency is being added: in the Sender's own queue (pacing by the
+// SenderPacketRouter), on the network, by re-transmissions, or at the Receiver.
+//
+// The latency distributions are computed over the most-recently ACKed frames.
+// Frames canceled by other means (e.g., CancelInFlightData()) are not included.
+struct SenderStats {
+  // The number of frames the distributions below were computed from.
+  int num_frames = 0;
+
+  // From EnqueueFrame() until the frame's first packet was sent.
+  Percentiles<Clock::duration> queueing_delay;
+
+  // From the first packet being sent until every packet of the frame had been
+  // sent at least once.
+  Percentiles<Clock::duration> transmit_duration;
+
+  // From every packet having been sent until the ACK arrived. This includes
+  // the network round trip, time spent re-transmitting lost packets, and any
+  // delay at the Receiver.
+  Percentiles<Clock::duration> ack_delay;
+
+  // From EnqueueFrame() until the ACK arrived.
+  Percentiles<Clock::duration> total_latency;
+
+  // The number of packets re-sent per frame, either in response to NACKs or
+  // as Kickstart packets.
+  Percentiles<int> retransmitted_packets;
+
+  // The number of packets re-sent over the lifetime of the Sender.
+  int64_t total_retransmitted_packets = 0;
+
+  // The state of the Sender as of the last enqueued frame or RTCP packet. See
+  // the Sender methods of the same names.
+  int in_flight_frame_count = 0;
+  Clock::duration in_flight_media_duration{};
+  Clock::duration max_in_flight_media_duration{};
+  Clock::duration round_trip_time{};
+
+  // The SenderPacketRouter's network bandwidth estimate, in bits per second,
+  // or zero if not yet known.
+  int bandwidth_estimate = 0;
+
+  // The fraction of RTP packets lost, in the range [0.0,1.0], as of the last
+  // Receiver Report.
+  double packet_loss_fraction = 0.0;
+
+  // The frame pipeline statistics most recently reported by the Receiver, or
+  // nullopt if the Receiver does not report them.
+  absl::optional<RtcpReceiverFrameStats> receiver_frame_stats;
+};
+
+// The timeline of one frame, from its enqueuing until it was ACKed.
+struct FrameTimingRecord {
+  Clock::time_point enqueue_time;
+  Clock::time_point first_packet_sent_time;
+  Clock::time_point last_packet_sent_time;
+  Clock::time_point ack_time;
+  int num_retransmitted_packets = 0;
+};
+
+// Accumulates the per-frame timing records and state snapshots provided by a
+// Sender, and produces SenderStats. The Record methods are called from the
+// Sender's TaskRunner thread, while GetStats() may be called from any thread.
+// The recording side only appends to a fixed-size ring buffer, under a briefly
+// held lock, and the percentiles are computed by the caller of GetStats().
+class SenderStatsTracker {
+ public:
+  // The number of most-recent frames the distributions are computed over.
+  static constexpr int kWindowSize = 256;
+
+  SenderStatsTracker();
+  ~SenderStatsTracker();
+
+  void RecordAckedFrame(const FrameTimingRecord& record);
+
+  void RecordState(int in_flight_frame_count,
+                   Clock::duration in_flight_media_duration,
+                   Clock::duration max_in_flight_media_duration,
+                   Clock::duration round_trip_time,
+                   int bandwidth_estimate);
+
+  void RecordReceiverFrameStats(const RtcpReceiverFrameStats& stats);
+
+  void RecordPacketLoss(double packet_loss_fraction);
+
+  SenderStats GetStats() const;
+
+ private:
+  // The durations derived from a FrameTimingRecord.
+  struct FrameSample {
+    Clock::duration queueing_delay;
+    Clock::duration transmit_duration;
+    Clock::duration ack_delay;
+    int num_retransmitted_packets;
+  };
+
+  mutable std::mutex mutex_;
+
+  // Ring buffer of the most-recent samples. The next one is written at
+  // |num_samples_ % kWindowSize|.
+  std::array<FrameSample, kWindowSize> samples_ ABSL_GUARDED_BY(mutex_);
+  int64_t num_samples_ ABSL_GUARDED_BY(mutex_) = 0;
+
+  // Holds the running totals and state snapshot. The distributions are not
+  // populated until GetStats() is called.
+  SenderStats state_ ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STREAMING_SENDER_STATS_H_
@@ -0,0 +1,116 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/sender_stats.h"
+
+#include <thread>
+
+#include "gtest/gtest.h"
+#include "util/chrono_helpers.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+constexpr Clock::time_point kStartTime =
+    Clock::time_point(milliseconds(1234567));
+
+// Returns a record for a frame that waited |queueing_ms| to be sent, took
+// |transmit_ms| to be sent, and was ACKed |ack_ms| later.
+FrameTimingRecord MakeRecord(int queueing_ms,
+                             int transmit_ms,
+                             int ack_ms,
+                             int num_retransmitted_packets) {
+  FrameTimingRecord record;
+  record.enqueue_time = kStartTime;
+  record.first_packet_sent_time = kStartTime + milliseconds(queueing_ms);
+  record.last_packet_sent_time =
+      record.first_packet_sent_time + milliseconds(transmit_ms);
+  record.ack_time = record.last_packet_sent_time + milliseconds(ack_ms);
+  record.num_retransmitted_packets = num_retransmitted_packets;
+  return record;
+}
+
+TEST(SenderStatsTrackerTest, ReportsNothingInitially) {
+  SenderStatsTracker tracker;
+  const SenderStats stats = tracker.GetStats();
+  EXPECT_EQ(0, stats.num_frames);
+  EXPECT_EQ(Clock::duration::zero(), stats.total_latency.p99);
+  EXPECT_EQ(0, stats.total_retransmitted_packets);
+  EXPECT_EQ(0, stats.bandwidth_estimate);
+}
+
+TEST(SenderStatsTrackerTest, ComputesPercentilesOfEachStage) {
+  SenderStatsTracker tracker;
+  // Record 100 frames, with stage latencies of 1..100 ms, in shuffled order.
+  for (int i = 0; i < 100; ++i) {
+    const int value = 1 + (i * 37) % 100;
+    tracker.RecordAckedFrame(
+        MakeRecord(value, 2 * value, 3 * value, (value == 100) ? 5 : 0));
+  }
+
+  const SenderStats stats = tracker.GetStats();
+  EXPECT_EQ(100, stats.num_frames);
+  EXPECT_EQ(milliseconds(50), stats.queueing_delay.p50);
+  EXPECT_EQ(milliseconds(95), stats.queueing_delay.p95);
+  EXPECT_EQ(milliseconds(99), stats.queueing_delay.p99);
+  EXPECT_EQ(milliseconds(100), stats.transmit_duration.p50);
+  EXPECT_EQ(milliseconds(285), stats.ack_delay.p95);
+  EXPECT_EQ(milliseconds(6 * 99), stats.total_latency.p99);
+  EXPECT_EQ(0, stats.retransmitted_packets.p99);
+  EXPECT_EQ(5, stats.total_retransmitted_packets);
+}
+
+TEST(SenderStatsTrackerTest, OnlyKeepsRecentFrames) {
+  SenderStatsTracker tracker;
+  for (int i = 0; i < SenderStatsTracker::kWindowSize; ++i) {
+    tracker.RecordAckedFrame(MakeRecord(1000, 0, 0, 1));
+  }
+  for (int i = 0; i < SenderStatsTracker::kWindowSize; ++i) {
+    tracker.RecordAckedFrame(MakeRecord(10, 0, 0, 0));
+  }
+
+  const SenderStats stats = tracker.GetStats();
+  EXPECT_EQ(SenderStatsTracker::kWindowSize, stats.num_frames);
+  EXPECT_EQ(milliseconds(10), stats.queueing_delay.p99);
+  EXPECT_EQ(0, stats.retransmitted_packets.p99);
+  // The lifetime total is not limited to the window.
+  EXPECT_EQ(SenderStatsTracker::kWindowSize, stats.total_retransmitted_packets);
+}
+
+TEST(SenderStatsTrackerTest, ReportsLatestState) {
+  SenderStatsTracker tracker;
+  tracker.RecordState(3, milliseconds(100), milliseconds(200),
+                      milliseconds(20), 5000000);
+  tracker.RecordState(2, milliseconds(66), milliseconds(210), milliseconds(25),
+                      6000000);
+  tracker.RecordPacketLoss(0.25);
+
+  const SenderStats stats = tracker.GetStats();
+  EXPECT_EQ(2, stats.in_flight_frame_count);
+  EXPECT_EQ(milliseconds(66), stats.in_flight_media_duration);
+  EXPECT_EQ(milliseconds(210), stats.max_in_flight_media_duration);
+  EXPECT_EQ(milliseconds(25), stats.round_trip_time);
+  EXPECT_EQ(6000000, stats.bandwidth_estimate);
+  EXPECT_EQ(0.25, stats.packet_loss_fraction);
+}
+
+TEST(SenderStatsTrackerTest, CanBeReadFromAnotherThread) {
+  SenderStatsTracker tracker;
+  std::thread reader([&tracker] {
+    for (int i = 0; i < 100; ++i) {
+      const SenderStats stats = tracker.GetStats();
+      EXPECT_LE(stats.num_frames, SenderStatsTracker::kWindowSize);
+    }
+  });
+  for (int i = 0; i < 1000; ++i) {
+    tracker.RecordAckedFrame(MakeRecord(i % 10, 1, 1, 0));
+  }
+  reader.join();
+  EXPECT_EQ(SenderStatsTracker::kWindowSize, tracker.GetStats().num_frames);
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
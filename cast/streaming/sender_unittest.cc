@@ -498,6 +498,47 @@ TEST_F(SenderTest, SendsFramesEfficiently) {
   ExpectFramesReceivedCorrectly(frames, receiver()->TakeCompleteFrames());
 }
 
+// Tests that the Sender reports the latency breakdown of the frames it has
+// sent, along with its in-flight state.
+TEST_F(SenderTest, ReportsFrameLatencyStats) {
+  constexpr milliseconds kOneWayNetworkDelay{3};
+  SetSenderToReceiverNetworkDelay(kOneWayNetworkDelay);
+  SetReceiverToSenderNetworkDelay(kOneWayNetworkDelay);
+  ON_CALL(*receiver(), OnFrameComplete(_)).WillByDefault(InvokeWithoutArgs([&] {
+    if (receiver()->AutoAdvanceCheckpoint()) {
+      receiver()->TransmitRtcpFeedbackPacket();
+    }
+  }));
+
+  EXPECT_EQ(0, sender()->GetStats().num_frames);
+
+  EncodedFrameWithBuffer frames[3];
+  for (int i = 0; i < 3; ++i) {
+    PopulateFrameWithDefaults(FrameId::first() + i,
+                              FakeClock::now() - kCaptureDelay, 0xbf - i, 4000,
+                              &frames[i]);
+    ASSERT_EQ(Sender::OK, sender()->EnqueueFrame(frames[i]));
+    if (i == 0) {
+      const SenderStats stats = sender()->GetStats();
+      EXPECT_EQ(1, stats.in_flight_frame_count);
+      EXPECT_LT(Clock::duration::zero(), stats.max_in_flight_media_duration);
+    }
+    SimulateExecution(kFrameDuration);
+  }
+  SimulateExecution(kTargetPlayoutDelay);
+
+  const SenderStats stats = sender()->GetStats();
+  EXPECT_EQ(3, stats.num_frames);
+  // Each frame's ACK cannot arrive sooner than one network round trip after
+  // its last packet was sent.
+  EXPECT_LE(2 * kOneWayNetworkDelay, stats.ack_delay.p50);
+  EXPECT_LE(stats.ack_delay.p99, stats.total_latency.p99);
+  EXPECT_EQ(0, stats.retransmitted_packets.p99);
+  EXPECT_EQ(0, stats.total_retransmitted_packets);
+  EXPECT_EQ(0, stats.in_flight_frame_count);
+  EXPECT_EQ(Clock::duration::zero(), stats.in_flight_media_duration);
+}
+
 // Tests that the Sender correctly computes the current in-flight media
 // duration, a backlog signal for clients.
 TEST_F(SenderTest, ComputesInFlightMediaDuration) {
@@ -7,8 +7,7 @@
 #include "absl/strings/ascii.h"
 #include "cast/common/public/message_port.h"
 #include "cast/streaming/message_fields.h"
-#include "util/json/json_helpers.h"
-#include "util/json/json_serialization.h"
+#include "util/json/json_writer.h"
 #include "util/osp_logging.h"
 
 namespace openscreen {
@@ -27,8 +26,11 @@ void ReplyIfTimedOut(
       OSP_DVLOG
           << "Replying with empty message due to timeout for sequence number: "
           << sequence_number;
-      it->second(ReceiverMessage{reply_type, sequence_number});
+      // The callback may send another request, so it must be removed from the
+      // list before it is run.
+      SenderSessionMessager::ReplyCallback callback = std::move(it->second);
       replies->erase(it);
+      callback(ReceiverMessage{reply_type, sequence_number});
       break;
     }
   }
@@ -54,17 +56,58 @@ Error SessionMessager::SendMessage(const std::string& destination_id,
                                    const Json::Value& message_root) {
   OSP_DCHECK(namespace_ == kCastRemotingNamespace ||
              namespace_ == kCastWebrtcNamespace);
-  auto body_or_error = json::Stringify(message_root);
-  if (body_or_error.is_error()) {
-    return std::move(body_or_error.error());
+  if (message_root.empty()) {
+    return Error(Error::Code::kJsonWriteError, "Empty value");
   }
+
+  // The buffer keeps its capacity between messages, so once it has grown to
+  // fit the largest one, serializing a message does not allocate.
+  send_buffer_.clear();
+  json::JsonWriter writer(&send_buffer_);
+  writer.Value(message_root);
   OSP_DVLOG << "Sending message: DESTINATION[" << destination_id
             << "], NAMESPACE[" << namespace_ << "], BODY:\n"
-            << body_or_error.value();
-  message_port_->PostMessage(destination_id, namespace_, body_or_error.value());
+            << send_buffer_;
+  message_port_->PostMessage(destination_id, namespace_, send_buffer_);
   return Error::None();
 }
 
+bool SessionMessager::SupportsBinaryMessages() const {
+  return message_port_->SupportsBinaryMessages();
+}
+
+void SessionMessager::SetBinaryRpcHandler(BinaryRpcCallback cb) {
+  binary_rpc_callback_ = std::move(cb);
+}
+
+Error SessionMessager::SendBinaryMessage(const std::string& destination_id,
+                                         absl::Span<const uint8_t> batch) {
+  if (!message_port_->SupportsBinaryMessages()) {
+    return Error(Error::Code::kOperationInvalid,
+                 "Message port does not support binary messages");
+  }
+  OSP_DVLOG << "Sending binary message: DESTINATION[" << destination_id
+            << "], " << batch.size() << " bytes";
+  message_port_->PostBinaryMessage(destination_id,
+                                   kCastRemotingBinaryNamespace, batch);
+  return Error::None();
+}
+
+void SessionMessager::HandleBinaryMessage(const std::string& message_namespace,
+                                          absl::Span<const uint8_t> payload) {
+  if (message_namespace != kCastRemotingBinaryNamespace) {
+    OSP_DLOG_WARN << "Received binary message from unknown namespace: "
+                  << message_namespace;
+    return;
+  }
+
+  if (binary_rpc_callback_) {
+    binary_rpc_callback_(payload);
+  } else {
+    OSP_DLOG_INFO << "Received binary RPC message but no callback, dropping";
+  }
+}
+
 void SessionMessager::ReportError(Error error) {
   error_callback_(std::move(error));
 }
@@ -121,6 +164,11 @@ Error SenderSessionMessager::SendRequest(SenderMessage message,
   return Error::None();
 }
 
+Error SenderSessionMessager::SendBinaryRpcBatch(
+    absl::Span<const uint8_t> batch) {
+  return SessionMessager::SendBinaryMessage(receiver_id_, batch);
+}
+
 void SenderSessionMessager::OnMessage(const std::string& source_id,
                                       const std::string& message_namespace,
                                       const std::string& message) {
@@ -138,33 +186,24 @@ void SenderSessionMessager::OnMessage(const std::string& source_id,
     return;
   }
 
-  ErrorOr<Json::Value> message_body = json::Parse(message);
-  if (!message_body) {
-    ReportError(message_body.error());
+  // Only invalid JSON is an error here. If the message is valid JSON and we
+  // don't understand it, it is either of an unknown type, or the receiver
+  // filled it out incorrectly: either way, the reply callback gets an invalid
+  // message.
+  ErrorOr<ReceiverMessage> receiver_message =
+      ReceiverMessage::ParseFromString(message);
+  if (receiver_message.is_error()) {
+    ReportError(receiver_message.error());
     OSP_DLOG_WARN << "Received an invalid message: " << message;
     return;
   }
 
-  int sequence_number;
-  if (!json::ParseAndValidateInt(message_body.value()[kSequenceNumber],
-                                 &sequence_number)) {
+  const int sequence_number = receiver_message.value().sequence_number;
+  if (sequence_number < 0) {
     OSP_DLOG_WARN << "Received a message without a sequence number";
     return;
   }
 
-  // If the message is valid JSON and we don't understand it, there are two
-  // options: (1) it's an unknown type, or (2) the receiver filled out the
-  // message incorrectly. In the first case we can drop it, it's likely just
-  // unsupported. In the second case we might need it, so worth warning the
-  // client.
-  ErrorOr<ReceiverMessage> receiver_message =
-      ReceiverMessage::Parse(message_body.value());
-  if (receiver_message.is_error()) {
-    ReportError(receiver_message.error());
-    OSP_DLOG_WARN << "Received an invalid receiver message: "
-                  << receiver_message.error();
-  }
-
   if (receiver_message.value().type == ReceiverMessage::Type::kRpc) {
     if (rpc_callback_) {
       rpc_callback_(receiver_message.value({}));
@@ -179,11 +218,25 @@ void SenderSessionMessager::OnMessage(const std::string& source_id,
       return;
     }
 
-    it->second(receiver_message.value({}));
+    ReplyCallback callback = std::move(it->second);
     awaiting_replies_.erase(it);
+    callback(receiver_message.value({}));
   }
 }
 
+void SenderSessionMessager::OnBinaryMessage(
+    const std::string& source_id,
+    const std::string& message_namespace,
+    absl::Span<const uint8_t> payload) {
+  if (source_id != receiver_id_) {
+    OSP_DLOG_WARN << "Received message from unknown/incorrect Cast Receiver, "
+                     "expected id \""
+                  << receiver_id_ << "\", got \"" << source_id << "\"";
+    return;
+  }
+  HandleBinaryMessage(message_namespace, payload);
+}
+
 void SenderSessionMessager::OnError(Error error) {
   OSP_DLOG_WARN << "Received an error in the session messager: " << error;
 }
@@ -215,6 +268,15 @@ Error ReceiverSessionMessager::SendMessage(ReceiverMessage message) {
                                       message_json.value());
 }
 
+Error ReceiverSessionMessager::SendBinaryRpcBatch(
+    absl::Span<const uint8_t> batch) {
+  if (sender_session_id_.empty()) {
+    return Error(Error::Code::kInitializationFailure,
+                 "Tried to send a message without receving one first");
+  }
+  return SessionMessager::SendBinaryMessage(sender_session_id_, batch);
+}
+
 void ReceiverSessionMessager::OnMessage(const std::string& source_id,
                                         const std::string& message_namespace,
                                         const std::string& message) {
@@ -236,20 +298,11 @@ void ReceiverSessionMessager::OnMessage(const std::string& source_id,
   }
 
   // If the message is bad JSON, the sender is in a funky state so we
-  // report an error.
-  ErrorOr<Json::Value> message_body = json::Parse(message);
-  if (message_body.is_error()) {
-    ReportError(message_body.error());
-    return;
-  }
-
-  // If the message is valid JSON and we don't understand it, there are two
-  // options: (1) it's an unknown type, or (2) the sender filled out the message
-  // incorrectly. In the first case we can drop it, it's likely just
-  // unsupported. In the second case we might need it, so worth warning the
-  // client.
+  // report an error. If the message is valid JSON and we don't understand it,
+  // it is either of an unknown type, or the sender filled it out incorrectly:
+  // either way, the callback for its type (if any) gets an invalid message.
   ErrorOr<SenderMessage> sender_message =
-      SenderMessage::Parse(message_body.value());
+      SenderMessage::ParseFromString(message);
   if (sender_message.is_error()) {
     ReportError(sender_message.error());
     OSP_DLOG_WARN << "Received an invalid sender message: "
@@ -265,6 +318,21 @@ void ReceiverSessionMessager::OnMessage(const std::string& source_id,
   }
 }
 
+void ReceiverSessionMessager::OnBinaryMessage(
+    const std::string& source_id,
+    const std::string& message_namespace,
+    absl::Span<const uint8_t> payload) {
+  // Binary messages are only ever sent after negotiation over JSON messages,
+  // so the sender must already be known.
+  if (source_id != sender_session_id_) {
+    OSP_DLOG_WARN << "Received binary message from unknown/incorrect sender, "
+                     "expected id \""
+                  << sender_session_id_ << "\", got \"" << source_id << "\"";
+    return;
+  }
+  HandleBinaryMessage(message_namespace, payload);
+}
+
 void ReceiverSessionMessager::OnError(Error error) {
   OSP_DLOG_WARN << "Received an error in the session messager: " << error;
 }
@@ -5,12 +5,15 @@
 #ifndef CAST_STREAMING_SESSION_MESSAGER_H_
 #define CAST_STREAMING_SESSION_MESSAGER_H_
 
+#include <stdint.h>
+
 #include <functional>
 #include <string>
 #include <utility>
 #include <vector>
 
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "absl/types/variant.h"
 #include "cast/common/public/message_port.h"
 #include "cast/streaming/answer_messages.h"
@@ -30,24 +33,46 @@ namespace cast {
 class SessionMessager : public MessagePort::Client {
  public:
   using ErrorCallback = std::function<void(Error)>;
+  using BinaryRpcCallback = std::function<void(absl::Span<const uint8_t>)>;
 
   SessionMessager(MessagePort* message_port,
                   std::string source_id,
                   ErrorCallback cb);
   ~SessionMessager() override;
 
+  // Whether the message port can carry binary RPC batches at all. See
+  // BinaryRpcChannel for how their use is negotiated with the remote.
+  bool SupportsBinaryMessages() const;
+
+  // Set the handler for batches of RPC messages received on the binary
+  // remoting namespace.
+  void SetBinaryRpcHandler(BinaryRpcCallback cb);
+
  protected:
   // Barebones message sending method shared by both children.
   Error SendMessage(const std::string& destination_id,
                     const std::string& namespace_,
                     const Json::Value& message_root);
 
+  // Sends a batch of RPC messages on the binary remoting namespace.
+  Error SendBinaryMessage(const std::string& destination_id,
+                          absl::Span<const uint8_t> batch);
+
+  // Runs the binary RPC handler, if any, for a message received on
+  // |message_namespace|.
+  void HandleBinaryMessage(const std::string& message_namespace,
+                           absl::Span<const uint8_t> payload);
+
   // Used to report errors in subclasses.
   void ReportError(Error error);
 
  private:
   MessagePort* const message_port_;
   ErrorCallback error_callback_;
+  BinaryRpcCallback binary_rpc_callback_;
+
+  // Reused to serialize each outgoing JSON message.
+  std::string send_buffer_;
 };
 
 class SenderSessionMessager final : public SessionMessager {
@@ -71,10 +96,17 @@ class SenderSessionMessager final : public SessionMessager {
                                   ReceiverMessage::Type reply_type,
                                   ReplyCallback cb);
 
+  // Send a batch of RPC messages as a binary payload. Only valid once both
+  // sides have advertised support in the OFFER/ANSWER exchange.
+  [[nodiscard]] Error SendBinaryRpcBatch(absl::Span<const uint8_t> batch);
+
   // MessagePort::Client overrides
   void OnMessage(const std::string& source_id,
                  const std::string& message_namespace,
                  const std::string& message) override;
+  void OnBinaryMessage(const std::string& source_id,
+                       const std::string& message_namespace,
+                       absl::Span<const uint8_t> payload) override;
   void OnError(Error error) override;
 
  private:
@@ -109,10 +141,17 @@ class ReceiverSessionMessager final : public SessionMessager {
   // Send a JSON message.
   [[nodiscard]] Error SendMessage(ReceiverMessage message);
 
+  // Send a batch of RPC messages as a binary payload. Only valid once both
+  // sides have advertised support in the OFFER/ANSWER exchange.
+  [[nodiscard]] Error SendBinaryRpcBatch(absl::Span<const uint8_t> batch);
+
   // MessagePort::Client overrides
   void OnMessage(const std::string& source_id,
                  const std::string& message_namespace,
                  const std::string& message) override;
+  void OnBinaryMessage(const std::string& source_id,
+                       const std::string& message_namespace,
+                       absl::Span<const uint8_t> payload) override;
   void OnError(Error error) override;
 
  private:
@@ -222,6 +222,51 @@ TEST_F(SessionMessagerTest, CapabilitiesMessaging) {
   EXPECT_THAT(capability.media_capabilities, ElementsAre("ac3", "4k"));
 }
 
+TEST_F(SessionMessagerTest, BinaryRpcMessaging) {
+  std::vector<std::vector<uint8_t>> sender_batches;
+  std::vector<std::vector<uint8_t>> receiver_batches;
+  sender_messager_.SetBinaryRpcHandler(
+      [&](absl::Span<const uint8_t> batch) {
+        sender_batches.emplace_back(batch.begin(), batch.end());
+      });
+  receiver_messager_.SetBinaryRpcHandler(
+      [&](absl::Span<const uint8_t> batch) {
+        receiver_batches.emplace_back(batch.begin(), batch.end());
+      });
+  ASSERT_TRUE(sender_messager_.SupportsBinaryMessages());
+
+  // The receiver may not reply until it knows who the sender is.
+  const std::vector<uint8_t> kBatch = {0x0a, 0x02, 0x08, 0x65};
+  EXPECT_FALSE(receiver_messager_.SendBinaryRpcBatch(kBatch).ok());
+
+  ASSERT_TRUE(
+      sender_messager_
+          .SendRequest(SenderMessage{SenderMessage::Type::kGetCapabilities,
+                                     1337, true /* valid */},
+                       ReceiverMessage::Type::kCapabilitiesResponse,
+                       message_store_.GetReplyCallback())
+          .ok());
+  ASSERT_TRUE(receiver_messager_
+                  .SendMessage(ReceiverMessage{
+                      ReceiverMessage::Type::kCapabilitiesResponse, 1337,
+                      true /* valid */,
+                      ReceiverCapability{47, {"ac3"}}})
+                  .ok());
+  ASSERT_EQ(1u, message_store_.receiver_messages.size());
+
+  ASSERT_TRUE(sender_messager_.SendBinaryRpcBatch(kBatch).ok());
+  ASSERT_EQ(1u, receiver_batches.size());
+  EXPECT_EQ(kBatch, receiver_batches[0]);
+
+  ASSERT_TRUE(receiver_messager_.SendBinaryRpcBatch(kBatch).ok());
+  ASSERT_EQ(1u, sender_batches.size());
+  EXPECT_EQ(kBatch, sender_batches[0]);
+
+  // Binary payloads on other namespaces are dropped.
+  pipe_.right()->ReceiveBinaryMessage(kCastRemotingNamespace, kBatch);
+  EXPECT_EQ(1u, receiver_batches.size());
+}
+
 TEST_F(SessionMessagerTest, OfferAnswerMessaging) {
   ASSERT_TRUE(sender_messager_
                   .SendRequest(SenderMessage{SenderMessage::Type::kOffer, 42,
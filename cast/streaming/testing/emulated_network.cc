@@ -0,0 +1,192 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/testing/emulated_network.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "cast/streaming/constants.h"
+#include "util/chrono_helpers.h"
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+namespace {
+
+// The endpoints the two sides of an EmulatedNetwork appear to be bound to.
+const IPEndpoint kSenderEndpoint{{127, 0, 0, 1}, 12345};
+const IPEndpoint kReceiverEndpoint{{127, 0, 0, 1}, kDefaultCastStreamingPort};
+
+constexpr int64_t kMicrosecondsPerSecond = 1000000;
+
+}  // namespace
+
+EmulatedLink::EmulatedLink(ClockNowFunctionPtr now_function,
+                           TaskRunner* task_runner,
+                           LinkConditions conditions,
+                           uint32_t random_seed,
+                           DeliverFunction deliver)
+    : now_function_(now_function),
+      task_runner_(task_runner),
+      conditions_(std::move(conditions)),
+      random_(random_seed),
+      deliver_(std::move(deliver)) {
+  OSP_DCHECK(now_function_);
+  OSP_DCHECK(task_runner_);
+  OSP_DCHECK(deliver_);
+}
+
+EmulatedLink::~EmulatedLink() = default;
+
+void EmulatedLink::SetConditions(LinkConditions conditions) {
+  conditions_ = std::move(conditions);
+}
+
+void EmulatedLink::Send(absl::Span<const uint8_t> packet) {
+  const Clock::time_point now = now_function_();
+  ++stats_.packets_sent;
+  stats_.bytes_sent += packet.size();
+
+  // Model the bottleneck: Each packet must wait for all those queued ahead of
+  // it to be sent, and is dropped if the queue is full.
+  Clock::time_point departure_time = now;
+  if (conditions_.bandwidth > 0) {
+    const Clock::time_point start_time = std::max(now, queue_drain_time_);
+    const Clock::duration queueing_delay = start_time - now;
+    if (conditions_.queue_size > 0) {
+      const int64_t queued_bytes = to_microseconds(queueing_delay).count() *
+                                   conditions_.bandwidth / 8 /
+                                   kMicrosecondsPerSecond;
+      if (queued_bytes + static_cast<int64_t>(packet.size()) >
+          conditions_.queue_size) {
+        ++stats_.packets_dropped;
+        return;
+      }
+    }
+    stats_.max_queueing_delay =
+        std::max(stats_.max_queueing_delay, queueing_delay);
+    queue_drain_time_ =
+        start_time +
+        microseconds(static_cast<int64_t>(packet.size()) * 8 *
+                     kMicrosecondsPerSecond / conditions_.bandwidth);
+    departure_time = queue_drain_time_;
+  }
+
+  // Packets lost "on the wire" have still occupied the bottleneck.
+  if (ShouldLosePacket()) {
+    ++stats_.packets_lost;
+    return;
+  }
+
+  Clock::time_point arrival_time =
+      departure_time + conditions_.propagation_delay;
+  if (conditions_.jitter > Clock::duration::zero()) {
+    std::uniform_int_distribution<Clock::duration::rep> distribution(
+        0, conditions_.jitter.count());
+    arrival_time += Clock::duration(distribution(random_));
+  }
+  arrival_time = std::max(arrival_time, last_arrival_time_);
+  last_arrival_time_ = arrival_time;
+  if (RandomEvent(conditions_.reorder_rate)) {
+    arrival_time += conditions_.reorder_delay;
+    ++stats_.packets_reordered;
+  }
+
+  task_runner_->PostTaskWithDelay(
+      [weak_this = weak_factory_.GetWeakPtr(),
+       data = std::vector<uint8_t>(packet.begin(), packet.end())]() mutable {
+        if (weak_this) {
+          ++weak_this->stats_.packets_delivered;
+          weak_this->deliver_(std::move(data));
+        }
+      },
+      arrival_time - now);
+}
+
+bool EmulatedLink::ShouldLosePacket() {
+  if (conditions_.burst_start_rate > 0.0) {
+    if (in_loss_burst_) {
+      in_loss_burst_ = !RandomEvent(conditions_.burst_end_rate);
+    } else {
+      in_loss_burst_ = RandomEvent(conditions_.burst_start_rate);
+    }
+    if (in_loss_burst_) {
+      return RandomEvent(conditions_.burst_loss_rate);
+    }
+  }
+  return RandomEvent(conditions_.loss_rate);
+}
+
+bool EmulatedLink::RandomEvent(double probability) {
+  if (probability <= 0.0) {
+    return false;
+  }
+  return std::uniform_real_distribution<double>(0.0, 1.0)(random_) <
+         probability;
+}
+
+EmulatedNetwork::EmulatedNetwork(ClockNowFunctionPtr now_function,
+                                 TaskRunner* task_runner,
+                                 LinkConditions sender_to_receiver,
+                                 LinkConditions receiver_to_sender,
+                                 uint32_t random_seed)
+    : sender_environment_(now_function, task_runner, kSenderEndpoint),
+      receiver_environment_(now_function, task_runner, kReceiverEndpoint),
+      sender_to_receiver_(now_function,
+                          task_runner,
+                          std::move(sender_to_receiver),
+                          random_seed,
+                          [this](std::vector<uint8_t> packet) {
+                            receiver_environment_.DeliverPacket(
+                                kSenderEndpoint, std::move(packet));
+                          }),
+      // Use a different random sequence for each direction.
+      receiver_to_sender_(now_function,
+                          task_runner,
+                          std::move(receiver_to_sender),
+                          ~random_seed,
+                          [this](std::vector<uint8_t> packet) {
+                            sender_environment_.DeliverPacket(
+                                kReceiverEndpoint, std::move(packet));
+                          }) {
+  sender_environment_.set_outbound_link(&sender_to_receiver_);
+  receiver_environment_.set_outbound_link(&receiver_to_sender_);
+
+  // The Sender must know where to send from the start, while the Receiver
+  // discovers the Sender's endpoint from its first packet.
+  sender_environment_.set_remote_endpoint(kReceiverEndpoint);
+}
+
+EmulatedNetwork::~EmulatedNetwork() = default;
+
+EmulatedNetwork::LinkedEnvironment::LinkedEnvironment(
+    ClockNowFunctionPtr now_function,
+    TaskRunner* task_runner,
+    const IPEndpoint& local_endpoint)
+    : local_endpoint_(local_endpoint) {
+  now_function_ = now_function;
+  task_runner_ = task_runner;
+  set_socket_state_for_testing(SocketState::kReady);
+}
+
+EmulatedNetwork::LinkedEnvironment::~LinkedEnvironment() = default;
+
+void EmulatedNetwork::LinkedEnvironment::DeliverPacket(
+    const IPEndpoint& source,
+    std::vector<uint8_t> packet) {
+  DeliverReceivedPacket(source, now(), std::move(packet));
+}
+
+void EmulatedNetwork::LinkedEnvironment::SendPacket(
+    absl::Span<const uint8_t> packet) {
+  // There is no socket, so this only notifies the PacketObserver.
+  Environment::SendPacket(packet);
+  OSP_DCHECK(outbound_link_);
+  outbound_link_->Send(packet);
+}
+
+}  // namespace cast
+}  // namespace openscreen
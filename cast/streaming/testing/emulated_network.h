@@ -0,0 +1,180 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STREAMING_TESTING_EMULATED_NETWORK_H_
+#define CAST_STREAMING_TESTING_EMULATED_NETWORK_H_
+
+#include <stdint.h>
+
+#include <functional>
+#include <random>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "cast/streaming/environment.h"
+#include "platform/api/task_runner.h"
+#include "platform/api/time.h"
+#include "platform/base/ip_address.h"
+#include "util/weak_ptr.h"
+
+namespace openscreen {
+namespace cast {
+
+// The properties of one direction of an emulated network link. The defaults
+// describe a perfect link: infinitely fast, with no delay or loss.
+struct LinkConditions {
+  // The bottleneck bandwidth, in bits per second. Packets are serialized onto
+  // the link one at a time, at this rate. Zero means unlimited.
+  int64_t bandwidth = 0;
+
+  // The size of the drop-tail queue in front of the bottleneck, in bytes.
+  // Packets that arrive when the queue is full are dropped. Zero means
+  // unlimited.
+  int queue_size = 0;
+
+  // The fixed one-way delay added to each packet after it leaves the
+  // bottleneck.
+  Clock::duration propagation_delay{};
+
+  // An additional random delay, chosen uniformly from [0,jitter], added to
+  // each packet. Packets are still delivered in order, unless reordered below.
+  Clock::duration jitter{};
+
+  // The probability of each packet being lost. With the Gilbert-Elliott burst
+  // loss model below, this is the loss rate while in the "good" state.
+  double loss_rate = 0.0;
+
+  // Gilbert-Elliott burst loss model: Before each packet, the link transitions
+  // from the "good" to the "bad" state with probability |burst_start_rate|, or
+  // from the "bad" to the "good" state with probability |burst_end_rate|.
+  // While in the "bad" state, packets are lost with probability
+  // |burst_loss_rate|. A |burst_start_rate| of zero disables the model.
+  double burst_start_rate = 0.0;
+  double burst_end_rate = 1.0;
+  double burst_loss_rate = 1.0;
+
+  // The probability of a packet being held back by an additional
+  // |reorder_delay|, allowing later packets to overtake it.
+  double reorder_rate = 0.0;
+  Clock::duration reorder_delay{};
+};
+
+// Emulates one direction of a network link. Packets are delivered via Tasks
+// posted to the TaskRunner, to run at their emulated arrival times. This works
+// with either the real Clock and TaskRunner, or with a FakeClock and
+// FakeTaskRunner, in which case a whole session can be run repeatably and
+// faster than real-time.
+class EmulatedLink {
+ public:
+  struct Stats {
+    int packets_sent = 0;
+    int64_t bytes_sent = 0;
+    int packets_delivered = 0;
+    int packets_lost = 0;     // Random or burst loss.
+    int packets_dropped = 0;  // Queue overflow.
+    int packets_reordered = 0;
+    Clock::duration max_queueing_delay{};
+  };
+
+  // A function that delivers a packet at its destination.
+  using DeliverFunction = std::function<void(std::vector<uint8_t> packet)>;
+
+  EmulatedLink(ClockNowFunctionPtr now_function,
+               TaskRunner* task_runner,
+               LinkConditions conditions,
+               uint32_t random_seed,
+               DeliverFunction deliver);
+  ~EmulatedLink();
+
+  const LinkConditions& conditions() const { return conditions_; }
+  const Stats& stats() const { return stats_; }
+
+  // Changes the link's properties. Packets already in flight are not affected.
+  void SetConditions(LinkConditions conditions);
+
+  // Sends a |packet| over the link.
+  void Send(absl::Span<const uint8_t> packet);
+
+ private:
+  // Returns true if the next packet should be lost, advancing the state of the
+  // burst loss model.
+  bool ShouldLosePacket();
+
+  // Returns true with the given |probability|.
+  bool RandomEvent(double probability);
+
+  const ClockNowFunctionPtr now_function_;
+  TaskRunner* const task_runner_;
+  LinkConditions conditions_;
+  std::mt19937 random_;
+  const DeliverFunction deliver_;
+
+  // The time at which the bottleneck will have finished sending all packets
+  // currently in its queue.
+  Clock::time_point queue_drain_time_{};
+
+  // The arrival time of the last packet, used to prevent jitter from
+  // reordering packets.
+  Clock::time_point last_arrival_time_{};
+
+  // The state of the Gilbert-Elliott burst loss model.
+  bool in_loss_burst_ = false;
+
+  Stats stats_;
+
+  WeakPtrFactory<EmulatedLink> weak_factory_{this};
+};
+
+// A pair of Environments connected by an emulated network, one for the Sender
+// side and one for the Receiver side, allowing a Sender→Receiver session to
+// run end-to-end in one process.
+class EmulatedNetwork {
+ public:
+  EmulatedNetwork(ClockNowFunctionPtr now_function,
+                  TaskRunner* task_runner,
+                  LinkConditions sender_to_receiver,
+                  LinkConditions receiver_to_sender,
+                  uint32_t random_seed = 1);
+  ~EmulatedNetwork();
+
+  Environment* sender_environment() { return &sender_environment_; }
+  Environment* receiver_environment() { return &receiver_environment_; }
+
+  EmulatedLink* sender_to_receiver() { return &sender_to_receiver_; }
+  EmulatedLink* receiver_to_sender() { return &receiver_to_sender_; }
+
+ private:
+  // An Environment without a socket, whose packets are sent over an
+  // EmulatedLink.
+  class LinkedEnvironment final : public Environment {
+   public:
+    LinkedEnvironment(ClockNowFunctionPtr now_function,
+                      TaskRunner* task_runner,
+                      const IPEndpoint& local_endpoint);
+    ~LinkedEnvironment() final;
+
+    void set_outbound_link(EmulatedLink* link) { outbound_link_ = link; }
+
+    // Called by the inbound EmulatedLink.
+    void DeliverPacket(const IPEndpoint& source, std::vector<uint8_t> packet);
+
+    // Environment overrides.
+    IPEndpoint GetBoundLocalEndpoint() const final { return local_endpoint_; }
+    void SendPacket(absl::Span<const uint8_t> packet) final;
+
+   private:
+    const IPEndpoint local_endpoint_;
+    EmulatedLink* outbound_link_ = nullptr;
+  };
+
+  LinkedEnvironment sender_environment_;
+  LinkedEnvironment receiver_environment_;
+  EmulatedLink sender_to_receiver_;
+  EmulatedLink receiver_to_sender_;
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STREAMING_TESTING_EMULATED_NETWORK_H_
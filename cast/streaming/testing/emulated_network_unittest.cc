@@ -0,0 +1,285 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/testing/emulated_network.h"
+
+#include <array>
+#include <vector>
+
+#include "cast/streaming/encoded_frame.h"
+#include "cast/streaming/receiver.h"
+#include "cast/streaming/receiver_packet_router.h"
+#include "cast/streaming/rtp_defines.h"
+#include "cast/streaming/sender.h"
+#include "cast/streaming/sender_packet_router.h"
+#include "cast/streaming/session_config.h"
+#include "gtest/gtest.h"
+#include "platform/test/fake_clock.h"
+#include "platform/test/fake_task_runner.h"
+#include "util/chrono_helpers.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+constexpr int kPacketSize = 1000;
+
+class EmulatedLinkTest : public testing::Test {
+ public:
+  EmulatedLinkTest() : clock_(Clock::now()), task_runner_(&clock_) {}
+
+  void CreateLink(LinkConditions conditions) {
+    link_ = std::make_unique<EmulatedLink>(
+        &FakeClock::now, &task_runner_, conditions, /* random_seed */ 42,
+        [this](std::vector<uint8_t> packet) {
+          arrivals_.emplace_back(FakeClock::now(), packet.front());
+        });
+  }
+
+  // Sends a packet whose first byte is |tag|.
+  void SendPacket(uint8_t tag) {
+    std::vector<uint8_t> packet(kPacketSize, 0);
+    packet[0] = tag;
+    link_->Send(packet);
+  }
+
+  void AdvanceClock(Clock::duration delta) { clock_.Advance(delta); }
+
+  EmulatedLink* link() { return link_.get(); }
+
+  // The arrival time and tag of each packet delivered, in order.
+  const std::vector<std::pair<Clock::time_point, uint8_t>>& arrivals() const {
+    return arrivals_;
+  }
+
+ private:
+  FakeClock clock_;
+  FakeTaskRunner task_runner_;
+  std::unique_ptr<EmulatedLink> link_;
+  std::vector<std::pair<Clock::time_point, uint8_t>> arrivals_;
+};
+
+TEST_F(EmulatedLinkTest, PerfectLinkDeliversImmediately) {
+  CreateLink(LinkConditions{});
+  const Clock::time_point start_time = FakeClock::now();
+  for (uint8_t i = 0; i < 10; ++i) {
+    SendPacket(i);
+  }
+  AdvanceClock(Clock::duration::zero());
+
+  ASSERT_EQ(10u, arrivals().size());
+  for (uint8_t i = 0; i < 10; ++i) {
+    EXPECT_EQ(start_time, arrivals()[i].first);
+    EXPECT_EQ(i, arrivals()[i].second);
+  }
+  EXPECT_EQ(10, link()->stats().packets_delivered);
+}
+
+TEST_F(EmulatedLinkTest, SerializesPacketsAtTheBottleneckRate) {
+  LinkConditions conditions;
+  conditions.bandwidth = 1000000;  // 1 Mbps: 8 ms per 1000-byte packet.
+  conditions.propagation_delay = milliseconds(20);
+  CreateLink(conditions);
+
+  const Clock::time_point start_time = FakeClock::now();
+  SendPacket(0);
+  SendPacket(1);
+  SendPacket(2);
+  AdvanceClock(milliseconds(100));
+
+  ASSERT_EQ(3u, arrivals().size());
+  EXPECT_EQ(start_time + milliseconds(28), arrivals()[0].first);
+  EXPECT_EQ(start_time + milliseconds(36), arrivals()[1].first);
+  EXPECT_EQ(start_time + milliseconds(44), arrivals()[2].first);
+  EXPECT_EQ(milliseconds(16), link()->stats().max_queueing_delay);
+}
+
+TEST_F(EmulatedLinkTest, DropsPacketsWhenQueueIsFull) {
+  LinkConditions conditions;
+  conditions.bandwidth = 1000000;
+  conditions.queue_size = 3 * kPacketSize;
+  CreateLink(conditions);
+
+  for (uint8_t i = 0; i < 5; ++i) {
+    SendPacket(i);
+  }
+  // After the queue has drained, more packets should be accepted.
+  AdvanceClock(milliseconds(100));
+  SendPacket(5);
+  AdvanceClock(milliseconds(100));
+
+  ASSERT_EQ(4u, arrivals().size());
+  EXPECT_EQ(0, arrivals()[0].second);
+  EXPECT_EQ(2, arrivals()[2].second);
+  EXPECT_EQ(5, arrivals()[3].second);
+  EXPECT_EQ(2, link()->stats().packets_dropped);
+}
+
+TEST_F(EmulatedLinkTest, LosesPacketsAtTheConfiguredRate) {
+  LinkConditions conditions;
+  conditions.loss_rate = 0.1;
+  CreateLink(conditions);
+
+  constexpr int kNumPackets = 10000;
+  for (int i = 0; i < kNumPackets; ++i) {
+    SendPacket(0);
+  }
+  AdvanceClock(Clock::duration::zero());
+
+  EXPECT_NEAR(kNumPackets * 0.9, arrivals().size(), kNumPackets * 0.02);
+  EXPECT_EQ(kNumPackets, link()->stats().packets_delivered +
+                             link()->stats().packets_lost);
+}
+
+TEST_F(EmulatedLinkTest, LosesPacketsInBursts) {
+  LinkConditions conditions;
+  conditions.burst_start_rate = 0.01;
+  conditions.burst_end_rate = 0.2;
+  CreateLink(conditions);
+
+  constexpr int kNumPackets = 10000;
+  for (int i = 0; i < kNumPackets; ++i) {
+    SendPacket(i % 256);
+  }
+  AdvanceClock(Clock::duration::zero());
+
+  // With an average burst length of 5, the stationary loss rate is about 5%.
+  // Most losses should be adjacent to other losses.
+  const int num_lost = link()->stats().packets_lost;
+  EXPECT_NEAR(kNumPackets * 0.05, num_lost, kNumPackets * 0.02);
+  int num_gaps = 0;
+  for (size_t i = 1; i < arrivals().size(); ++i) {
+    if (static_cast<uint8_t>(arrivals()[i - 1].second + 1) !=
+        arrivals()[i].second) {
+      ++num_gaps;
+    }
+  }
+  EXPECT_LT(num_gaps, num_lost / 2);
+}
+
+TEST_F(EmulatedLinkTest, JitterDoesNotReorderPackets) {
+  LinkConditions conditions;
+  conditions.propagation_delay = milliseconds(10);
+  conditions.jitter = milliseconds(10);
+  CreateLink(conditions);
+
+  const Clock::time_point start_time = FakeClock::now();
+  for (uint8_t i = 0; i < 100; ++i) {
+    SendPacket(i);
+    AdvanceClock(milliseconds(1));
+  }
+  AdvanceClock(milliseconds(100));
+
+  ASSERT_EQ(100u, arrivals().size());
+  for (uint8_t i = 0; i < 100; ++i) {
+    EXPECT_EQ(i, arrivals()[i].second);
+    EXPECT_GE(arrivals()[i].first, start_time + milliseconds(10 + i));
+    if (i > 0) {
+      EXPECT_GE(arrivals()[i].first, arrivals()[i - 1].first);
+    }
+  }
+}
+
+TEST_F(EmulatedLinkTest, ReordersPackets) {
+  LinkConditions conditions;
+  conditions.reorder_rate = 0.5;
+  conditions.reorder_delay = milliseconds(5);
+  CreateLink(conditions);
+
+  for (uint8_t i = 0; i < 100; ++i) {
+    SendPacket(i);
+    AdvanceClock(milliseconds(1));
+  }
+  AdvanceClock(milliseconds(100));
+
+  ASSERT_EQ(100u, arrivals().size());
+  int num_out_of_order = 0;
+  for (size_t i = 1; i < arrivals().size(); ++i) {
+    if (arrivals()[i].second < arrivals()[i - 1].second) {
+      ++num_out_of_order;
+    }
+  }
+  EXPECT_GT(num_out_of_order, 0);
+  EXPECT_EQ(link()->stats().packets_reordered > 0, num_out_of_order > 0);
+}
+
+// Counts the frames received from a Receiver.
+class FrameCounter : public Receiver::Consumer {
+ public:
+  explicit FrameCounter(Receiver* receiver) : receiver_(receiver) {
+    receiver_->SetConsumer(this);
+  }
+  ~FrameCounter() override { receiver_->SetConsumer(nullptr); }
+
+  int num_frames() const { return num_frames_; }
+
+  void OnFramesReady(int next_frame_buffer_size) override {
+    buffer_.resize(next_frame_buffer_size);
+    receiver_->ConsumeNextFrame(absl::Span<uint8_t>(buffer_));
+    ++num_frames_;
+  }
+
+ private:
+  Receiver* const receiver_;
+  std::vector<uint8_t> buffer_;
+  int num_frames_ = 0;
+};
+
+TEST(EmulatedNetworkTest, StreamsEndToEndOverLossyLink) {
+  FakeClock clock(Clock::now());
+  FakeTaskRunner task_runner(&clock);
+  LinkConditions forward;
+  forward.bandwidth = 10000000;
+  forward.queue_size = 100000;
+  forward.propagation_delay = milliseconds(15);
+  forward.jitter = milliseconds(5);
+  forward.loss_rate = 0.05;
+  LinkConditions reverse;
+  reverse.propagation_delay = milliseconds(15);
+  EmulatedNetwork network(&FakeClock::now, &task_runner, forward, reverse);
+
+  const SessionConfig config(/* sender_ssrc */ 1, /* receiver_ssrc */ 2,
+                             kRtpVideoTimebase, /* channels */ 1,
+                             milliseconds(400), std::array<uint8_t, 16>{},
+                             std::array<uint8_t, 16>{},
+                             /* is_pli_enabled */ true);
+  ReceiverPacketRouter receiver_router(network.receiver_environment());
+  Receiver receiver(network.receiver_environment(), &receiver_router, config);
+  FrameCounter frame_counter(&receiver);
+  SenderPacketRouter sender_router(network.sender_environment());
+  Sender sender(network.sender_environment(), &sender_router, config,
+                GetPayloadType(VideoCodec::kVp8));
+
+  constexpr int kNumFrames = 60;
+  std::vector<uint8_t> data(10000, 0xab);
+  const Clock::time_point start_time = FakeClock::now();
+  int num_frames_sent = 0;
+  for (int i = 0; i < kNumFrames; ++i) {
+    EncodedFrame frame;
+    frame.frame_id = sender.GetNextFrameId();
+    frame.dependency =
+        (i == 0) ? EncodedFrame::KEY_FRAME : EncodedFrame::DEPENDS_ON_ANOTHER;
+    frame.referenced_frame_id = (i == 0) ? frame.frame_id : frame.frame_id - 1;
+    frame.rtp_timestamp = RtpTimeTicks() + RtpTimeDelta::FromTicks(3000 * i);
+    frame.reference_time = start_time + milliseconds(33 * i);
+    frame.data = absl::Span<uint8_t>(data);
+    // Like a real encoder, skip frames the Sender cannot accept while too much
+    // media is in-flight (i.e., while retransmissions are pending).
+    if (sender.EnqueueFrame(frame) == Sender::OK) {
+      ++num_frames_sent;
+    }
+    clock.Advance(milliseconds(33));
+  }
+  clock.Advance(seconds(1));
+
+  // All frames sent should have made it, thanks to retransmissions.
+  EXPECT_GT(num_frames_sent, kNumFrames / 2);
+  EXPECT_EQ(num_frames_sent, frame_counter.num_frames());
+  EXPECT_GT(network.sender_to_receiver()->stats().packets_lost, 0);
+  EXPECT_GT(network.receiver_to_sender()->stats().packets_delivered, 0);
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
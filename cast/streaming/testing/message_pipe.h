@@ -8,6 +8,8 @@
 #ifndef CAST_STREAMING_TESTING_MESSAGE_PIPE_H_
 #define CAST_STREAMING_TESTING_MESSAGE_PIPE_H_
 
+#include <stdint.h>
+
 #include <string>
 #include <utility>
 #include <vector>
@@ -53,6 +55,21 @@ class MessagePipeEnd : public MessagePort {
     other_end_->ReceiveMessage(message_namespace, message);
   }
 
+  void ReceiveBinaryMessage(const std::string& namespace_,
+                            absl::Span<const uint8_t> payload) {
+    ASSERT_NE(client_, nullptr);
+    client_->OnBinaryMessage(destination_id_, namespace_, payload);
+  }
+
+  bool SupportsBinaryMessages() const override { return true; }
+
+  void PostBinaryMessage(const std::string& sender_id,
+                         const std::string& message_namespace,
+                         absl::Span<const uint8_t> payload) override {
+    ASSERT_NE(other_end_, nullptr);
+    other_end_->ReceiveBinaryMessage(message_namespace, payload);
+  }
+
  private:
   std::string sender_id_;
   std::string destination_id_;
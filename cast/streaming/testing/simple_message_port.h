@@ -5,6 +5,8 @@
 #ifndef CAST_STREAMING_TESTING_SIMPLE_MESSAGE_PORT_H_
 #define CAST_STREAMING_TESTING_SIMPLE_MESSAGE_PORT_H_
 
+#include <stdint.h>
+
 #include <string>
 #include <utility>
 #include <vector>
@@ -46,6 +48,12 @@ class SimpleMessagePort : public MessagePort {
     client_->OnMessage(sender_id, namespace_, message);
   }
 
+  void ReceiveBinaryMessage(const std::string& namespace_,
+                            absl::Span<const uint8_t> payload) {
+    ASSERT_NE(client_, nullptr);
+    client_->OnBinaryMessage(destination_id_, namespace_, payload);
+  }
+
   void ReceiveError(Error error) {
     ASSERT_NE(client_, nullptr);
     client_->OnError(error);
@@ -57,14 +65,35 @@ class SimpleMessagePort : public MessagePort {
     posted_messages_.emplace_back(message);
   }
 
+  bool SupportsBinaryMessages() const override {
+    return supports_binary_messages_;
+  }
+
+  void PostBinaryMessage(const std::string& sender_id,
+                         const std::string& message_namespace,
+                         absl::Span<const uint8_t> payload) override {
+    ASSERT_TRUE(supports_binary_messages_);
+    posted_binary_messages_.emplace_back(payload.begin(), payload.end());
+  }
+
   const std::vector<std::string> posted_messages() const {
     return posted_messages_;
   }
 
+  const std::vector<std::vector<uint8_t>>& posted_binary_messages() const {
+    return posted_binary_messages_;
+  }
+
+  void set_supports_binary_messages(bool supports) {
+    supports_binary_messages_ = supports;
+  }
+
  private:
   MessagePort::Client* client_ = nullptr;
   std::string destination_id_;
   std::vector<std::string> posted_messages_;
+  std::vector<std::vector<uint8_t>> posted_binary_messages_;
+  bool supports_binary_messages_ = false;
 };
 
 }  // namespace cast
@@ -0,0 +1,182 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/threaded_receiver.h"
+
+#include <utility>
+
+#include "cast/streaming/environment.h"
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+// The I/O thread side of a ThreadedReceiver, which owns the Receiver.
+class ThreadedReceiver::Core final : public Receiver::Consumer {
+ public:
+  Core(std::shared_ptr<SharedState> shared, TaskRunner* app_task_runner)
+      : shared_(std::move(shared)), app_task_runner_(app_task_runner) {}
+
+  ~Core() final {
+    if (receiver_) {
+      shared_->receiver.store(nullptr);
+      receiver_->SetConsumer(nullptr);
+    }
+  }
+
+  Receiver* receiver() const { return receiver_.get(); }
+
+  void CreateReceiver(Environment* environment,
+                      ReceiverPacketRouter* packet_router,
+                      SessionConfig config) {
+    OSP_DCHECK(!receiver_);
+    receiver_ =
+        std::make_unique<Receiver>(environment, packet_router, config);
+    shared_->receiver.store(receiver_.get());
+    receiver_->SetConsumer(this);
+  }
+
+  // Consumes and decrypts frames from the Receiver, until either no more are
+  // ready or the queue is full.
+  void ConsumeReadyFrames() {
+    bool did_push = false;
+    for (;;) {
+      if (shared_->frames.size() == shared_->frames.capacity()) {
+        shared_->is_stalled.store(true);
+        // Re-check, in case the application made room just before the flag
+        // was set, and so did not see it.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        if (shared_->frames.size() == shared_->frames.capacity() ||
+            !shared_->is_stalled.exchange(false)) {
+          break;
+        }
+      }
+
+      const int buffer_size = receiver_->AdvanceToNextFrame();
+      if (buffer_size == Receiver::kNoFramesReady) {
+        break;
+      }
+      ReceivedFrame received;
+      received.buffer.resize(buffer_size);
+      received.frame =
+          receiver_->ConsumeNextFrame(absl::Span<uint8_t>(received.buffer));
+      const bool pushed = shared_->frames.TryPush(std::move(received));
+      OSP_DCHECK(pushed);
+      did_push = true;
+    }
+
+    if (did_push && !shared_->notify_task_posted.exchange(true)) {
+      app_task_runner_->PostTask([shared = shared_] {
+        shared->notify_task_posted.store(false);
+        if (shared->consumer) {
+          shared->consumer->OnFramesReady();
+        }
+      });
+    }
+  }
+
+ private:
+  // Receiver::Consumer implementation.
+  void OnFramesReady(int next_frame_buffer_size) final {
+    ConsumeReadyFrames();
+  }
+
+  const std::shared_ptr<SharedState> shared_;
+  TaskRunner* const app_task_runner_;
+
+  std::unique_ptr<Receiver> receiver_;
+};
+
+ThreadedReceiver::ThreadedReceiver(TaskRunner* app_task_runner,
+                                   Environment* environment,
+                                   ReceiverPacketRouter* packet_router,
+                                   SessionConfig config,
+                                   int queue_capacity)
+    : io_task_runner_(environment->task_runner()),
+      shared_(std::make_shared<SharedState>(queue_capacity)),
+      core_(std::make_unique<Core>(shared_, app_task_runner)) {
+  OSP_DCHECK(app_task_runner);
+  OSP_DCHECK(io_task_runner_);
+  OSP_DCHECK(packet_router);
+  OSP_DCHECK_GT(queue_capacity, 0);
+
+  // The Core is only accessed from tasks posted to the I/O thread from here on.
+  // Since these tasks run in order, and the Core is destroyed by the last one
+  // posted (from the destructor), it is safe for them to use a raw pointer.
+  Core* const core = core_.get();
+  io_task_runner_->PostTask([core, environment, packet_router, config] {
+    core->CreateReceiver(environment, packet_router, config);
+  });
+}
+
+ThreadedReceiver::~ThreadedReceiver() {
+  shared_->consumer = nullptr;
+  io_task_runner_->PostTask(
+      [core = std::move(core_)]() mutable { core.reset(); });
+}
+
+void ThreadedReceiver::SetConsumer(Consumer* consumer) {
+  shared_->consumer = consumer;
+  if (consumer && !shared_->frames.empty()) {
+    consumer->OnFramesReady();
+  }
+}
+
+bool ThreadedReceiver::ConsumeNextFrame(ReceivedFrame* frame) {
+  if (!shared_->frames.TryPop(frame)) {
+    return false;
+  }
+  if (shared_->is_stalled.exchange(false)) {
+    PostToCore([](Core* core) { core->ConsumeReadyFrames(); });
+  }
+  return true;
+}
+
+void ThreadedReceiver::SetPlayerProcessingTime(Clock::duration needed_time) {
+  PostToCore([needed_time](Core* core) {
+    core->receiver()->SetPlayerProcessingTime(needed_time);
+  });
+}
+
+void ThreadedReceiver::RequestKeyFrame() {
+  PostToCore([](Core* core) { core->receiver()->RequestKeyFrame(); });
+}
+
+void ThreadedReceiver::SetFrameStatsReportingEnabled(bool enabled) {
+  PostToCore([enabled](Core* core) {
+    core->receiver()->SetFrameStatsReportingEnabled(enabled);
+  });
+}
+
+ReceiverStats ThreadedReceiver::GetStats() const {
+  const Receiver* const receiver = shared_->receiver.load();
+  return receiver ? receiver->GetStats() : ReceiverStats{};
+}
+
+template <typename Task>
+void ThreadedReceiver::PostToCore(Task task) {
+  // See comments in the constructor about the use of a raw pointer here.
+  Core* const core = core_.get();
+  io_task_runner_->PostTask(
+      [core, task = std::move(task)]() mutable { task(core); });
+}
+
+ThreadedReceiver::ReceivedFrame::ReceivedFrame() = default;
+ThreadedReceiver::ReceivedFrame::~ReceivedFrame() = default;
+ThreadedReceiver::ReceivedFrame::ReceivedFrame(ReceivedFrame&&) noexcept =
+    default;
+ThreadedReceiver::ReceivedFrame& ThreadedReceiver::ReceivedFrame::operator=(
+    ReceivedFrame&&) = default;
+
+ThreadedReceiver::SharedState::SharedState(int queue_capacity)
+    : frames(queue_capacity) {}
+ThreadedReceiver::SharedState::~SharedState() = default;
+
+ThreadedReceiver::Consumer::~Consumer() = default;
+
+// static
+constexpr int ThreadedReceiver::kDefaultQueueCapacity;
+
+}  // namespace cast
+}  // namespace openscreen
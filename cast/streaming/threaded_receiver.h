@@ -0,0 +1,148 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STREAMING_THREADED_RECEIVER_H_
+#define CAST_STREAMING_THREADED_RECEIVER_H_
+
+#include <stdint.h>
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include "cast/streaming/encoded_frame.h"
+#include "cast/streaming/receiver.h"
+#include "cast/streaming/receiver_stats.h"
+#include "cast/streaming/session_config.h"
+#include "platform/api/task_runner.h"
+#include "platform/api/time.h"
+#include "platform/base/macros.h"
+#include "util/spsc_queue.h"
+
+namespace openscreen {
+namespace cast {
+
+class Environment;
+class ReceiverPacketRouter;
+
+// Runs a Receiver on a dedicated packet I/O thread, so that RTP packets are
+// collected, and RTCP feedback is sent, on time even while the application's
+// thread is busy (e.g., decoding or rendering).
+//
+// Threading model: The |environment|, |packet_router| and the Receiver this
+// creates all live on, and are only ever touched from, the |environment|'s
+// TaskRunner (the "I/O thread"). As soon as each frame is ready, it is
+// decrypted on the I/O thread and handed to the application through a
+// lock-free queue. The public methods of ThreadedReceiver, and all Consumer
+// callbacks, are on the |app_task_runner| thread.
+//
+// If the application falls behind and the queue fills up, the I/O thread stops
+// consuming frames until there is room again. Meanwhile, the Receiver keeps
+// collecting packets, and will skip frames that can no longer be played out
+// on-time, as usual.
+class ThreadedReceiver {
+ public:
+  // A frame consumed from the Receiver, along with the buffer its |data|
+  // points into.
+  struct ReceivedFrame {
+    ReceivedFrame();
+    ~ReceivedFrame();
+    ReceivedFrame(ReceivedFrame&&) noexcept;
+    ReceivedFrame& operator=(ReceivedFrame&&);
+
+    EncodedFrame frame;
+    std::vector<uint8_t> buffer;
+  };
+
+  class Consumer {
+   public:
+    // Called on the application thread when one or more frames can be taken
+    // with ConsumeNextFrame().
+    virtual void OnFramesReady() = 0;
+
+   protected:
+    virtual ~Consumer();
+  };
+
+  // The default maximum number of decrypted frames waiting to be taken by the
+  // application.
+  static constexpr int kDefaultQueueCapacity = 8;
+
+  // Constructs on the |app_task_runner| thread. The Receiver is created soon
+  // after, on the |environment|'s TaskRunner. See Receiver's constructor for a
+  // description of the other arguments. The |environment| and |packet_router|
+  // must outlive this ThreadedReceiver, and may only be destroyed by a task
+  // posted to the I/O thread after this ThreadedReceiver has been destroyed.
+  ThreadedReceiver(TaskRunner* app_task_runner,
+                   Environment* environment,
+                   ReceiverPacketRouter* packet_router,
+                   SessionConfig config,
+                   int queue_capacity = kDefaultQueueCapacity);
+
+  ~ThreadedReceiver();
+
+  // Sets the Consumer to be notified when frames are ready. Frames arriving
+  // before this is called wait in the queue, and if there are any, the new
+  // |consumer| is notified immediately.
+  void SetConsumer(Consumer* consumer);
+
+  // Takes the next frame, if any, returning true; or returns false if no
+  // frames are ready.
+  bool ConsumeNextFrame(ReceivedFrame* frame);
+
+  // Forwarded to the Receiver on the I/O thread. See Receiver for details.
+  void SetPlayerProcessingTime(Clock::duration needed_time);
+  void RequestKeyFrame();
+  void SetFrameStatsReportingEnabled(bool enabled);
+
+  // Returns a snapshot of the Receiver's frame pipeline statistics, or default
+  // values until the Receiver has been created.
+  ReceiverStats GetStats() const;
+
+ private:
+  class Core;
+
+  // State accessed from both threads, and retained until any tasks referring to
+  // it have run.
+  struct SharedState {
+    explicit SharedState(int queue_capacity);
+    ~SharedState();
+
+    // Decrypted frames waiting to be taken by the application.
+    SpscQueue<ReceivedFrame> frames;
+
+    // True while a task to notify the Consumer is pending on the application
+    // thread.
+    std::atomic<bool> notify_task_posted{false};
+
+    // Set by the I/O thread when it stops consuming frames because |frames| is
+    // full. The application thread clears it when it makes room, and posts a
+    // task to resume.
+    std::atomic<bool> is_stalled{false};
+
+    // Set by the I/O thread while the Receiver exists, for GetStats().
+    std::atomic<const Receiver*> receiver{nullptr};
+
+    // Only accessed on the application thread.
+    Consumer* consumer = nullptr;
+  };
+
+  // Posts |task| to run against the Core on the I/O thread.
+  template <typename Task>
+  void PostToCore(Task task);
+
+  TaskRunner* const io_task_runner_;
+  const std::shared_ptr<SharedState> shared_;
+
+  // Owned by this ThreadedReceiver, but only accessed on (and destroyed by a
+  // task posted to) the I/O thread.
+  std::unique_ptr<Core> core_;
+
+  OSP_DISALLOW_COPY_AND_ASSIGN(ThreadedReceiver);
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STREAMING_THREADED_RECEIVER_H_
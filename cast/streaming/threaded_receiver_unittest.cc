@@ -0,0 +1,178 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/threaded_receiver.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "cast/streaming/receiver_packet_router.h"
+#include "cast/streaming/sender_packet_router.h"
+#include "cast/streaming/testing/emulated_network.h"
+#include "cast/streaming/threaded_sender.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "platform/test/fake_clock.h"
+#include "platform/test/fake_task_runner.h"
+#include "util/chrono_helpers.h"
+
+using testing::Invoke;
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+constexpr milliseconds kFrameDuration{33};
+
+const SessionConfig kConfig(/* sender_ssrc */ 1,
+                            /* receiver_ssrc */ 2,
+                            kRtpVideoTimebase,
+                            /* channels */ 1,
+                            milliseconds(400),
+                            std::array<uint8_t, 16>{},
+                            std::array<uint8_t, 16>{},
+                            /* is_pli_enabled */ true);
+
+class MockConsumer : public ThreadedReceiver::Consumer {
+ public:
+  MOCK_METHOD0(OnFramesReady, void());
+};
+
+// Streams frames from a ThreadedSender to a ThreadedReceiver, both with their
+// I/O on one TaskRunner, and the application on another.
+class ThreadedReceiverTest : public testing::Test {
+ public:
+  ThreadedReceiverTest()
+      : clock_(Clock::now()),
+        app_task_runner_(&clock_),
+        io_task_runner_(&clock_),
+        network_(&FakeClock::now,
+                 &io_task_runner_,
+                 LinkConditions{},
+                 LinkConditions{}),
+        sender_router_(network_.sender_environment()),
+        receiver_router_(network_.receiver_environment()),
+        sender_(std::make_unique<ThreadedSender>(
+            &app_task_runner_,
+            network_.sender_environment(),
+            &sender_router_,
+            kConfig,
+            GetPayloadType(VideoCodec::kVp8))),
+        start_time_(FakeClock::now()) {}
+
+  ~ThreadedReceiverTest() override {
+    // Let the I/O thread destroy the Sender and Receiver before the packet
+    // routers go away.
+    sender_.reset();
+    receiver_.reset();
+    clock_.Advance(Clock::duration::zero());
+  }
+
+  void CreateReceiver(int queue_capacity) {
+    receiver_ = std::make_unique<ThreadedReceiver>(
+        &app_task_runner_, network_.receiver_environment(), &receiver_router_,
+        kConfig, queue_capacity);
+  }
+
+  // Sends the |index|-th frame, whose payload is |index + 1| bytes, all having
+  // the value |index|.
+  void SendFrame(int index) {
+    payloads_.emplace_back(index + 1, static_cast<uint8_t>(index));
+    EncodedFrame frame;
+    frame.dependency = (index == 0) ? EncodedFrame::KEY_FRAME
+                                    : EncodedFrame::DEPENDS_ON_ANOTHER;
+    frame.rtp_timestamp =
+        RtpTimeTicks() + RtpTimeDelta::FromTicks(3000 * index);
+    frame.reference_time = start_time_ + kFrameDuration * index;
+    frame.data = absl::Span<uint8_t>(payloads_.back());
+    ASSERT_TRUE(sender_->EnqueueFrame(std::move(frame)));
+  }
+
+  void Advance(Clock::duration delta) { clock_.Advance(delta); }
+
+  ThreadedReceiver* receiver() { return receiver_.get(); }
+
+ private:
+  FakeClock clock_;
+  FakeTaskRunner app_task_runner_;
+  FakeTaskRunner io_task_runner_;
+  EmulatedNetwork network_;
+  SenderPacketRouter sender_router_;
+  ReceiverPacketRouter receiver_router_;
+  std::unique_ptr<ThreadedSender> sender_;
+  std::unique_ptr<ThreadedReceiver> receiver_;
+  const Clock::time_point start_time_;
+  std::vector<std::vector<uint8_t>> payloads_;
+};
+
+TEST_F(ThreadedReceiverTest, DeliversDecryptedFramesToTheApplication) {
+  CreateReceiver(ThreadedReceiver::kDefaultQueueCapacity);
+  MockConsumer consumer;
+  receiver()->SetConsumer(&consumer);
+
+  constexpr int kNumFrames = 5;
+  int num_consumed = 0;
+  EXPECT_CALL(consumer, OnFramesReady())
+      .WillRepeatedly(Invoke([&] {
+        ThreadedReceiver::ReceivedFrame received;
+        while (receiver()->ConsumeNextFrame(&received)) {
+          EXPECT_EQ(FrameId::first() + num_consumed, received.frame.frame_id);
+          EXPECT_EQ(std::vector<uint8_t>(num_consumed + 1,
+                                         static_cast<uint8_t>(num_consumed)),
+                    std::vector<uint8_t>(received.frame.data.begin(),
+                                         received.frame.data.end()));
+          ++num_consumed;
+        }
+      }));
+  for (int i = 0; i < kNumFrames; ++i) {
+    SendFrame(i);
+    Advance(kFrameDuration);
+  }
+  Advance(seconds(1));
+
+  EXPECT_EQ(kNumFrames, num_consumed);
+  EXPECT_EQ(kNumFrames, receiver()->GetStats().frames_consumed);
+  receiver()->SetConsumer(nullptr);
+}
+
+TEST_F(ThreadedReceiverTest, ResumesConsumingOnceTheApplicationCatchesUp) {
+  CreateReceiver(2);
+  // Let frames pile up, without a Consumer.
+  constexpr int kNumFrames = 5;
+  for (int i = 0; i < kNumFrames; ++i) {
+    SendFrame(i);
+  }
+  Advance(kFrameDuration);
+  EXPECT_EQ(2, receiver()->GetStats().frames_consumed);
+
+  // Setting a Consumer notifies it immediately, since frames are waiting. Then,
+  // each frame taken makes room for the I/O thread to consume another.
+  MockConsumer consumer;
+  int num_consumed = 0;
+  EXPECT_CALL(consumer, OnFramesReady())
+      .WillRepeatedly(Invoke([&] {
+        ThreadedReceiver::ReceivedFrame received;
+        if (receiver()->ConsumeNextFrame(&received)) {
+          EXPECT_EQ(FrameId::first() + num_consumed, received.frame.frame_id);
+          ++num_consumed;
+        }
+      }));
+  receiver()->SetConsumer(&consumer);
+  EXPECT_EQ(1, num_consumed);
+  Advance(Clock::duration::zero());
+  EXPECT_EQ(kNumFrames, receiver()->GetStats().frames_consumed);
+
+  ThreadedReceiver::ReceivedFrame received;
+  while (receiver()->ConsumeNextFrame(&received)) {
+    EXPECT_EQ(FrameId::first() + num_consumed, received.frame.frame_id);
+    ++num_consumed;
+  }
+  EXPECT_EQ(kNumFrames, num_consumed);
+  receiver()->SetConsumer(nullptr);
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
@@ -0,0 +1,188 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/threaded_sender.h"
+
+#include <utility>
+
+#include "cast/streaming/environment.h"
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace cast {
+
+// The I/O thread side of a ThreadedSender, which owns the Sender.
+class ThreadedSender::Core final : public Sender::Observer {
+ public:
+  Core(std::shared_ptr<SharedState> shared, TaskRunner* app_task_runner)
+      : shared_(std::move(shared)), app_task_runner_(app_task_runner) {}
+
+  ~Core() final {
+    // No more frames can be enqueued by now. Release any that were never sent.
+    EncodedFrame discarded;
+    while (shared_->frames.TryPop(&discarded)) {
+    }
+
+    if (sender_) {
+      shared_->sender.store(nullptr);
+      sender_->SetObserver(nullptr);
+    }
+  }
+
+  void CreateSender(Environment* environment,
+                    SenderPacketRouter* packet_router,
+                    SessionConfig config,
+                    RtpPayloadType rtp_payload_type) {
+    OSP_DCHECK(!sender_);
+    sender_ = std::make_unique<Sender>(environment, packet_router, config,
+                                       rtp_payload_type);
+    sender_->SetObserver(this);
+    shared_->sender.store(sender_.get());
+  }
+
+  // Enqueues all the frames the application has handed off so far.
+  void DrainQueue() {
+    // Clear the flag first, so that any frame pushed after the queue is found
+    // empty below will cause another drain task to be posted.
+    shared_->drain_task_posted.store(false);
+
+    EncodedFrame frame;
+    while (shared_->frames.TryPop(&frame)) {
+      const RtpTimeTicks rtp_timestamp = frame.rtp_timestamp;
+      Sender::EnqueueFrameResult result = last_drop_reason_;
+      if (frame.dependency == EncodedFrame::KEY_FRAME ||
+          !is_awaiting_key_frame_) {
+        frame.frame_id = sender_->GetNextFrameId();
+        frame.referenced_frame_id =
+            (frame.dependency == EncodedFrame::KEY_FRAME) ? frame.frame_id
+                                                          : frame.frame_id - 1;
+        result = sender_->EnqueueFrame(frame);
+      }
+
+      if (result == Sender::OK) {
+        if (frame.dependency == EncodedFrame::KEY_FRAME) {
+          is_awaiting_key_frame_ = false;
+        }
+      } else {
+        is_awaiting_key_frame_ = true;
+        last_drop_reason_ = result;
+        PostToObserver(
+            [rtp_timestamp, result](ThreadedSender::Observer* observer) {
+              observer->OnFrameDropped(rtp_timestamp, result);
+            });
+      }
+    }
+    // The last frame's release callback is run when |frame| goes out of scope.
+
+    UpdateNeedsKeyFrame();
+  }
+
+ private:
+  // Sender::Observer implementation.
+  void OnFrameCanceled(FrameId frame_id) final { UpdateNeedsKeyFrame(); }
+  void OnPictureLost() final {
+    UpdateNeedsKeyFrame();
+    PostToObserver(
+        [](ThreadedSender::Observer* observer) { observer->OnPictureLost(); });
+  }
+
+  void UpdateNeedsKeyFrame() {
+    shared_->needs_key_frame.store(is_awaiting_key_frame_ ||
+                                   sender_->NeedsKeyFrame());
+  }
+
+  // Posts a task to run |notify| on the application thread, if the
+  // ThreadedSender still has an Observer at that point.
+  template <typename Notify>
+  void PostToObserver(Notify notify) {
+    app_task_runner_->PostTask([shared = shared_, notify = std::move(notify)] {
+      if (shared->observer) {
+        notify(shared->observer);
+      }
+    });
+  }
+
+  const std::shared_ptr<SharedState> shared_;
+  TaskRunner* const app_task_runner_;
+
+  std::unique_ptr<Sender> sender_;
+
+  // The first frame must be a key frame. After that, this is set whenever a
+  // frame is dropped, since any following non-key frames would reference it.
+  bool is_awaiting_key_frame_ = true;
+  Sender::EnqueueFrameResult last_drop_reason_ = Sender::OK;
+};
+
+ThreadedSender::ThreadedSender(TaskRunner* app_task_runner,
+                               Environment* environment,
+                               SenderPacketRouter* packet_router,
+                               SessionConfig config,
+                               RtpPayloadType rtp_payload_type,
+                               int queue_capacity)
+    : io_task_runner_(environment->task_runner()),
+      shared_(std::make_shared<SharedState>(queue_capacity)),
+      core_(std::make_unique<Core>(shared_, app_task_runner)) {
+  OSP_DCHECK(app_task_runner);
+  OSP_DCHECK(io_task_runner_);
+  OSP_DCHECK(packet_router);
+  OSP_DCHECK_GT(queue_capacity, 0);
+
+  // The Core is only accessed from tasks posted to the I/O thread from here on.
+  // Since these tasks run in order, and the Core is destroyed by the last one
+  // posted (from the destructor), it is safe for them to use a raw pointer.
+  Core* const core = core_.get();
+  io_task_runner_->PostTask(
+      [core, environment, packet_router, config, rtp_payload_type] {
+        core->CreateSender(environment, packet_router, config,
+                           rtp_payload_type);
+      });
+}
+
+ThreadedSender::~ThreadedSender() {
+  shared_->observer = nullptr;
+  io_task_runner_->PostTask(
+      [core = std::move(core_)]() mutable { core.reset(); });
+}
+
+void ThreadedSender::SetObserver(Observer* observer) {
+  shared_->observer = observer;
+}
+
+bool ThreadedSender::EnqueueFrame(EncodedFrame&& frame) {
+  OSP_DCHECK(frame.data_fragments.empty() ? !!frame.data.data()
+                                          : frame.data.empty());
+  if (!shared_->frames.TryPush(std::move(frame))) {
+    return false;
+  }
+  if (!shared_->drain_task_posted.exchange(true)) {
+    Core* const core = core_.get();
+    io_task_runner_->PostTask([core] { core->DrainQueue(); });
+  }
+  return true;
+}
+
+bool ThreadedSender::NeedsKeyFrame() const {
+  return shared_->needs_key_frame.load();
+}
+
+SenderStats ThreadedSender::GetStats() const {
+  const Sender* const sender = shared_->sender.load();
+  return sender ? sender->GetStats() : SenderStats{};
+}
+
+ThreadedSender::SharedState::SharedState(int queue_capacity)
+    : frames(queue_capacity) {}
+ThreadedSender::SharedState::~SharedState() = default;
+
+void ThreadedSender::Observer::OnFrameDropped(
+    RtpTimeTicks rtp_timestamp,
+    Sender::EnqueueFrameResult reason) {}
+void ThreadedSender::Observer::OnPictureLost() {}
+ThreadedSender::Observer::~Observer() = default;
+
+// static
+constexpr int ThreadedSender::kDefaultQueueCapacity;
+
+}  // namespace cast
+}  // namespace openscreen
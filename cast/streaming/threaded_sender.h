@@ -0,0 +1,142 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef CAST_STREAMING_THREADED_SENDER_H_
+#define CAST_STREAMING_THREADED_SENDER_H_
+
+#include <atomic>
+#include <memory>
+
+#include "cast/streaming/encoded_frame.h"
+#include "cast/streaming/rtp_defines.h"
+#include "cast/streaming/rtp_time.h"
+#include "cast/streaming/sender.h"
+#include "cast/streaming/sender_stats.h"
+#include "cast/streaming/session_config.h"
+#include "platform/api/task_runner.h"
+#include "platform/base/macros.h"
+#include "util/spsc_queue.h"
+
+namespace openscreen {
+namespace cast {
+
+class Environment;
+class SenderPacketRouter;
+
+// Runs a Sender on a dedicated packet I/O thread, so that RTP sends and RTCP
+// feedback processing are never held up by work on the application's thread
+// (e.g., session signalling, encoder callbacks, or app logic).
+//
+// Threading model: The |environment|, |packet_router| and the Sender this
+// creates all live on, and are only ever touched from, the |environment|'s
+// TaskRunner (the "I/O thread"). This includes the encryption of each frame's
+// payload. The public methods of ThreadedSender, and all Observer callbacks,
+// are on the |app_task_runner| thread. Frames are handed from the application
+// to the I/O thread through a lock-free queue, and neither thread ever blocks
+// the other.
+//
+// Because frames are enqueued asynchronously, the application does not choose
+// their FrameIds. Instead, the I/O thread assigns them in order, assuming each
+// non-key frame references the frame before it (as the in-tree encoders do).
+// If the Sender rejects a frame, all following non-key frames are dropped as
+// well, and NeedsKeyFrame() returns true until a key frame is accepted.
+class ThreadedSender {
+ public:
+  // Notifications, all run on the application thread.
+  class Observer {
+   public:
+    // Called when the frame having the given |rtp_timestamp| was not sent,
+    // either because the Sender rejected it for the given |reason|, or because
+    // it depends on a frame that was dropped for that |reason|.
+    virtual void OnFrameDropped(RtpTimeTicks rtp_timestamp,
+                                Sender::EnqueueFrameResult reason);
+
+    // See Sender::Observer::OnPictureLost().
+    virtual void OnPictureLost();
+
+   protected:
+    virtual ~Observer();
+  };
+
+  // The default maximum number of frames waiting to be picked up by the I/O
+  // thread.
+  static constexpr int kDefaultQueueCapacity = 8;
+
+  // Constructs on the |app_task_runner| thread. The Sender is created soon
+  // after, on the |environment|'s TaskRunner. See Sender's constructor for a
+  // description of the other arguments. The |environment| and |packet_router|
+  // must outlive this ThreadedSender, and may only be destroyed by a task
+  // posted to the I/O thread after this ThreadedSender has been destroyed.
+  ThreadedSender(TaskRunner* app_task_runner,
+                 Environment* environment,
+                 SenderPacketRouter* packet_router,
+                 SessionConfig config,
+                 RtpPayloadType rtp_payload_type,
+                 int queue_capacity = kDefaultQueueCapacity);
+
+  ~ThreadedSender();
+
+  // Sets an observer for receiving notifications. Call with nullptr to stop
+  // observing.
+  void SetObserver(Observer* observer);
+
+  // Hands off the given |frame| to the I/O thread, to be encrypted and sent.
+  // The |frame_id| and |referenced_frame_id| fields are ignored (see class
+  // comments), while all other fields must be set as described for
+  // Sender::EnqueueFrame(). The memory referenced by the frame's payload must
+  // remain valid until the frame's |release_callback| is run, which will happen
+  // on the I/O thread.
+  //
+  // Returns false, without taking the |frame|, if too many frames are already
+  // waiting for the I/O thread.
+  bool EnqueueFrame(EncodedFrame&& frame);
+
+  // Returns true if the Receiver requires a key frame, or a frame was dropped
+  // and only a key frame can be sent next. This is a snapshot as of the last
+  // event processed on the I/O thread.
+  bool NeedsKeyFrame() const;
+
+  // Returns a snapshot of the Sender's statistics, including the in-flight
+  // frame count and media duration, which should be used to throttle encoding.
+  // Returns default values until the Sender has been created.
+  SenderStats GetStats() const;
+
+ private:
+  class Core;
+
+  // State accessed from both threads, and retained until any tasks referring to
+  // it have run.
+  struct SharedState {
+    explicit SharedState(int queue_capacity);
+    ~SharedState();
+
+    // Frames waiting to be picked up by the I/O thread.
+    SpscQueue<EncodedFrame> frames;
+
+    // True while a task to drain |frames| is pending on the I/O thread.
+    std::atomic<bool> drain_task_posted{false};
+
+    std::atomic<bool> needs_key_frame{true};
+
+    // Set by the I/O thread while the Sender exists, for GetStats().
+    std::atomic<const Sender*> sender{nullptr};
+
+    // Only accessed on the application thread.
+    Observer* observer = nullptr;
+  };
+
+  TaskRunner* const io_task_runner_;
+  const std::shared_ptr<SharedState> shared_;
+
+  // Owned by this ThreadedSender, but only accessed on (and destroyed by a task
+  // posted to) the I/O thread.
+  std::unique_ptr<Core> core_;
+
+  OSP_DISALLOW_COPY_AND_ASSIGN(ThreadedSender);
+};
+
+}  // namespace cast
+}  // namespace openscreen
+
+#endif  // CAST_STREAMING_THREADED_SENDER_H_
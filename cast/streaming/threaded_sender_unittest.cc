@@ -0,0 +1,218 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "cast/streaming/threaded_sender.h"
+
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "cast/streaming/receiver.h"
+#include "cast/streaming/receiver_packet_router.h"
+#include "cast/streaming/sender_packet_router.h"
+#include "cast/streaming/testing/emulated_network.h"
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "platform/test/fake_clock.h"
+#include "platform/test/fake_task_runner.h"
+#include "util/chrono_helpers.h"
+
+using testing::_;
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+constexpr int kPayloadSize = 1000;
+constexpr milliseconds kFrameDuration{33};
+
+const SessionConfig kConfig(/* sender_ssrc */ 1,
+                            /* receiver_ssrc */ 2,
+                            kRtpVideoTimebase,
+                            /* channels */ 1,
+                            milliseconds(400),
+                            std::array<uint8_t, 16>{},
+                            std::array<uint8_t, 16>{},
+                            /* is_pli_enabled */ true);
+
+class MockObserver : public ThreadedSender::Observer {
+ public:
+  MOCK_METHOD2(OnFrameDropped,
+               void(RtpTimeTicks rtp_timestamp,
+                    Sender::EnqueueFrameResult reason));
+  MOCK_METHOD0(OnPictureLost, void());
+};
+
+// Collects the frames received by a Receiver, on the I/O thread.
+class FrameCollector : public Receiver::Consumer {
+ public:
+  explicit FrameCollector(Receiver* receiver) : receiver_(receiver) {
+    receiver_->SetConsumer(this);
+  }
+  ~FrameCollector() override { receiver_->SetConsumer(nullptr); }
+
+  const std::vector<EncodedFrame>& frames() const { return frames_; }
+
+  void OnFramesReady(int next_frame_buffer_size) override {
+    buffer_.resize(next_frame_buffer_size);
+    frames_.push_back(
+        receiver_->ConsumeNextFrame(absl::Span<uint8_t>(buffer_)));
+  }
+
+ private:
+  Receiver* const receiver_;
+  std::vector<uint8_t> buffer_;
+  std::vector<EncodedFrame> frames_;
+};
+
+class ThreadedSenderTest : public testing::Test {
+ public:
+  ThreadedSenderTest()
+      : clock_(Clock::now()),
+        app_task_runner_(&clock_),
+        io_task_runner_(&clock_),
+        network_(&FakeClock::now,
+                 &io_task_runner_,
+                 LinkConditions{},
+                 LinkConditions{}),
+        sender_router_(network_.sender_environment()),
+        payload_(kPayloadSize, 0xab),
+        start_time_(FakeClock::now()) {}
+
+  ~ThreadedSenderTest() override {
+    // Let the I/O thread destroy the Sender before the packet router goes away.
+    sender_.reset();
+    clock_.Advance(Clock::duration::zero());
+  }
+
+  void CreateSender(int queue_capacity) {
+    sender_ = std::make_unique<ThreadedSender>(
+        &app_task_runner_, network_.sender_environment(), &sender_router_,
+        kConfig, GetPayloadType(VideoCodec::kVp8), queue_capacity);
+    sender_->SetObserver(&observer_);
+  }
+
+  void CreateReceiver() {
+    receiver_router_ =
+        std::make_unique<ReceiverPacketRouter>(network_.receiver_environment());
+    receiver_ = std::make_unique<Receiver>(network_.receiver_environment(),
+                                           receiver_router_.get(), kConfig);
+    collector_ = std::make_unique<FrameCollector>(receiver_.get());
+  }
+
+  // Returns the |index|-th frame, whose release callback counts into
+  // |num_released_|.
+  EncodedFrame MakeFrame(int index, bool is_key_frame) {
+    EncodedFrame frame;
+    frame.dependency = is_key_frame ? EncodedFrame::KEY_FRAME
+                                    : EncodedFrame::DEPENDS_ON_ANOTHER;
+    frame.rtp_timestamp = GetRtpTimestamp(index);
+    frame.reference_time = start_time_ + kFrameDuration * index;
+    frame.data = absl::Span<uint8_t>(payload_);
+    frame.release_callback = [this] { ++num_released_; };
+    return frame;
+  }
+
+  static RtpTimeTicks GetRtpTimestamp(int index) {
+    return RtpTimeTicks() + RtpTimeDelta::FromTicks(3000 * index);
+  }
+
+  void Advance(Clock::duration delta) { clock_.Advance(delta); }
+
+  ThreadedSender* sender() { return sender_.get(); }
+  MockObserver* observer() { return &observer_; }
+  FrameCollector* collector() { return collector_.get(); }
+  int num_released() const { return num_released_; }
+
+ private:
+  FakeClock clock_;
+  FakeTaskRunner app_task_runner_;
+  FakeTaskRunner io_task_runner_;
+  EmulatedNetwork network_;
+  SenderPacketRouter sender_router_;
+  std::unique_ptr<ReceiverPacketRouter> receiver_router_;
+  std::unique_ptr<Receiver> receiver_;
+  std::unique_ptr<FrameCollector> collector_;
+  testing::StrictMock<MockObserver> observer_;
+  std::unique_ptr<ThreadedSender> sender_;
+  std::vector<uint8_t> payload_;
+  const Clock::time_point start_time_;
+  int num_released_ = 0;
+};
+
+TEST_F(ThreadedSenderTest, SendsFramesAndAssignsFrameIds) {
+  CreateReceiver();
+  CreateSender(ThreadedSender::kDefaultQueueCapacity);
+  EXPECT_TRUE(sender()->NeedsKeyFrame());
+
+  constexpr int kNumFrames = 10;
+  for (int i = 0; i < kNumFrames; ++i) {
+    ASSERT_TRUE(sender()->EnqueueFrame(MakeFrame(i, i == 0)));
+    Advance(kFrameDuration);
+  }
+  Advance(seconds(1));
+
+  EXPECT_FALSE(sender()->NeedsKeyFrame());
+  EXPECT_EQ(kNumFrames, num_released());
+  ASSERT_EQ(kNumFrames, static_cast<int>(collector()->frames().size()));
+  for (int i = 0; i < kNumFrames; ++i) {
+    const EncodedFrame& frame = collector()->frames()[i];
+    EXPECT_EQ(FrameId::first() + i, frame.frame_id);
+    EXPECT_EQ((i == 0) ? frame.frame_id : frame.frame_id - 1,
+              frame.referenced_frame_id);
+    EXPECT_EQ(GetRtpTimestamp(i), frame.rtp_timestamp);
+    EXPECT_EQ(kPayloadSize, static_cast<int>(frame.data.size()));
+  }
+  EXPECT_EQ(kNumFrames, sender()->GetStats().num_frames);
+}
+
+TEST_F(ThreadedSenderTest, RejectsFramesWhenQueueIsFull) {
+  CreateSender(2);
+  EXPECT_TRUE(sender()->EnqueueFrame(MakeFrame(0, true)));
+  EXPECT_TRUE(sender()->EnqueueFrame(MakeFrame(1, false)));
+  EncodedFrame frame = MakeFrame(2, false);
+  EXPECT_FALSE(sender()->EnqueueFrame(std::move(frame)));
+  // The rejected frame was left with the caller.
+  EXPECT_TRUE(frame.release_callback);
+  EXPECT_EQ(0, num_released());
+
+  // Once the I/O thread has drained the queue, there is room again.
+  Advance(Clock::duration::zero());
+  EXPECT_EQ(2, num_released());
+  EXPECT_TRUE(sender()->EnqueueFrame(std::move(frame)));
+}
+
+TEST_F(ThreadedSenderTest, DropsDependentFramesAfterRejection) {
+  // With no Receiver, nothing is ever ACKed, and so the Sender will eventually
+  // reject a frame because too much media is in-flight.
+  CreateSender(ThreadedSender::kDefaultQueueCapacity);
+  std::vector<RtpTimeTicks> dropped;
+  EXPECT_CALL(*observer(), OnFrameDropped(_, Sender::MAX_DURATION_IN_FLIGHT))
+      .WillRepeatedly([&dropped](RtpTimeTicks rtp_timestamp,
+                                 Sender::EnqueueFrameResult reason) {
+        dropped.push_back(rtp_timestamp);
+      });
+
+  constexpr int kNumFrames = 30;
+  for (int i = 0; i < kNumFrames; ++i) {
+    ASSERT_TRUE(sender()->EnqueueFrame(MakeFrame(i, i == 0)));
+    Advance(kFrameDuration);
+  }
+  EXPECT_EQ(kNumFrames, num_released());
+
+  // Once the first frame was dropped, all the following non-key frames were
+  // dropped too, since they would have depended on it.
+  ASSERT_FALSE(dropped.empty());
+  const int num_sent = kNumFrames - static_cast<int>(dropped.size());
+  EXPECT_GT(num_sent, 1);
+  for (int i = num_sent; i < kNumFrames; ++i) {
+    EXPECT_EQ(GetRtpTimestamp(i), dropped[i - num_sent]);
+  }
+  EXPECT_TRUE(sender()->NeedsKeyFrame());
+  EXPECT_EQ(num_sent, sender()->GetStats().in_flight_frame_count);
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
@@ -0,0 +1,347 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Replays a packet capture (see cast/streaming/packet_capture.h), such as one
+// made with the cast_receiver --capture option, into Receivers running on a
+// simulated clock. Since nothing waits on real time, the capture is processed
+// as fast as possible, which makes this useful for profiling the receive path
+// and for catching performance regressions with a fixed, real-world input.
+//
+// Only the inbound packets are replayed. The outbound (RTCP) packets in the
+// capture are used only to compare the original NACK volume with that of the
+// replay.
+
+#include <getopt.h>
+#include <stdio.h>
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "absl/types/span.h"
+#include "cast/streaming/compound_rtcp_parser.h"
+#include "cast/streaming/constants.h"
+#include "cast/streaming/encoded_frame.h"
+#include "cast/streaming/environment.h"
+#include "cast/streaming/packet_capture.h"
+#include "cast/streaming/packet_util.h"
+#include "cast/streaming/receiver.h"
+#include "cast/streaming/receiver_packet_router.h"
+#include "cast/streaming/rtcp_session.h"
+#include "cast/streaming/rtp_packet_parser.h"
+#include "platform/impl/logging.h"
+#include "platform/test/fake_clock.h"
+#include "platform/test/fake_task_runner.h"
+#include "util/chrono_helpers.h"
+#include "util/osp_logging.h"
+#include "util/stringprintf.h"
+
+namespace openscreen {
+namespace cast {
+namespace {
+
+// The replayed packets all appear to come from this endpoint.
+const IPEndpoint kSenderEndpoint{{127, 0, 0, 1}, 12345};
+
+// How long to keep the simulated clock running after the last packet, so that
+// the Receivers can finish up.
+constexpr Clock::duration kDrainDuration = seconds(1);
+
+void LogUsage(const char* argv0) {
+  constexpr char kTemplate[] = R"(
+usage: %s <options> capture_file
+
+Replays the inbound RTP/RTCP packets of a packet capture into Receivers running
+on a simulated clock, as fast as possible, and reports performance statistics.
+
+options:
+    -v, --verbose: Enable verbose logging.
+
+    -h, --help: Show this help message.
+)";
+  std::cerr << StringPrintf(kTemplate, argv0);
+}
+
+// An Environment with no socket, which counts the packets sent by the
+// Receivers instead of sending them.
+class ReplayEnvironment final : public Environment {
+ public:
+  ReplayEnvironment(ClockNowFunctionPtr now_function, TaskRunner* task_runner) {
+    now_function_ = now_function;
+    task_runner_ = task_runner;
+  }
+  ~ReplayEnvironment() final = default;
+
+  void set_sent_packet_handler(
+      std::function<void(absl::Span<const uint8_t>)> handler) {
+    sent_packet_handler_ = std::move(handler);
+  }
+
+  // Environment overrides.
+  IPEndpoint GetBoundLocalEndpoint() const final {
+    return IPEndpoint{{127, 0, 0, 1}, kDefaultCastStreamingPort};
+  }
+  void SendPacket(absl::Span<const uint8_t> packet) final {
+    sent_packet_handler_(packet);
+  }
+
+ private:
+  std::function<void(absl::Span<const uint8_t>)> sent_packet_handler_;
+};
+
+// Parses the RTCP packets sent by one Receiver, counting the NACKs.
+class NackCounter final : public CompoundRtcpParser::Client {
+ public:
+  NackCounter(const SessionConfig& config, Clock::time_point start_time)
+      : session_(config.sender_ssrc, config.receiver_ssrc, start_time),
+        parser_(&session_, this) {}
+  ~NackCounter() final = default;
+
+  void Parse(absl::Span<const uint8_t> packet, FrameId max_feedback_frame_id) {
+    ++num_rtcp_packets_;
+    parser_.Parse(packet, max_feedback_frame_id);
+  }
+
+  int num_rtcp_packets() const { return num_rtcp_packets_; }
+  int num_nacks() const { return num_nacks_; }
+
+  // CompoundRtcpParser::Client implementation.
+  void OnReceiverIsMissingPackets(std::vector<PacketNack> nacks) final {
+    num_nacks_ += nacks.size();
+  }
+
+ private:
+  RtcpSession session_;
+  CompoundRtcpParser parser_;
+  int num_rtcp_packets_ = 0;
+  int num_nacks_ = 0;
+};
+
+// Replays one stream (i.e., the packets to/from one Receiver) and collects its
+// statistics.
+class ReplayedStream final : public Receiver::Consumer {
+ public:
+  ReplayedStream(ReplayEnvironment* environment,
+                 ReceiverPacketRouter* router,
+                 const SessionConfig& config)
+      : environment_(environment),
+        receiver_(environment, router, config),
+        rtp_parser_(config.sender_ssrc),
+        original_nacks_(config, environment->now()),
+        replay_nacks_(config, environment->now()) {
+    receiver_.SetConsumer(this);
+  }
+
+  ~ReplayedStream() final { receiver_.SetConsumer(nullptr); }
+
+  Ssrc sender_ssrc() const { return receiver_.config().sender_ssrc; }
+  Ssrc receiver_ssrc() const { return receiver_.ssrc(); }
+
+  // Called just before each inbound RTP packet is delivered to the Receiver,
+  // to track when each frame started to arrive.
+  void OnInboundRtpPacket(absl::Span<const uint8_t> packet) {
+    const absl::optional<RtpPacketParser::ParseResult> result =
+        rtp_parser_.Parse(packet);
+    if (!result) {
+      return;
+    }
+    ++num_rtp_packets_;
+    latest_frame_id_ = std::max(latest_frame_id_, result->frame_id);
+    first_packet_times_.emplace(result->frame_id, environment_->now());
+  }
+
+  void OnOriginalRtcpPacket(absl::Span<const uint8_t> packet) {
+    original_nacks_.Parse(packet, latest_frame_id_);
+  }
+
+  void OnReplayRtcpPacket(absl::Span<const uint8_t> packet) {
+    replay_nacks_.Parse(packet, latest_frame_id_);
+  }
+
+  // Receiver::Consumer implementation.
+  void OnFramesReady(int next_frame_buffer_size) final {
+    buffer_.resize(next_frame_buffer_size);
+    const EncodedFrame frame =
+        receiver_.ConsumeNextFrame(absl::Span<uint8_t>(buffer_));
+    ++num_frames_;
+    num_bytes_ += frame.data.size();
+
+    const auto it = first_packet_times_.find(frame.frame_id);
+    if (it != first_packet_times_.end()) {
+      assembly_latencies_.push_back(environment_->now() - it->second);
+    }
+    // Forget about this frame and any that were skipped.
+    first_packet_times_.erase(first_packet_times_.begin(),
+                              first_packet_times_.upper_bound(frame.frame_id));
+  }
+
+  void PrintStats(Clock::duration wall_time) {
+    const double wall_seconds = to_microseconds(wall_time).count() / 1e6;
+    printf("Stream %u->%u (rtp_timebase=%d):\n", sender_ssrc(),
+           receiver_ssrc(), receiver_.rtp_timebase());
+    printf("  rtp_packets: %d\n", num_rtp_packets_);
+    printf("  frames_completed: %d (%.1f per second)\n", num_frames_,
+           wall_seconds > 0 ? num_frames_ / wall_seconds : 0.0);
+    printf("  bytes_completed: %lld\n", static_cast<long long>(num_bytes_));
+    printf("  nacks: %d in %d RTCP packets (originally %d in %d)\n",
+           replay_nacks_.num_nacks(), replay_nacks_.num_rtcp_packets(),
+           original_nacks_.num_nacks(), original_nacks_.num_rtcp_packets());
+
+    if (assembly_latencies_.empty()) {
+      return;
+    }
+    std::sort(assembly_latencies_.begin(), assembly_latencies_.end());
+    Clock::duration sum{};
+    for (Clock::duration latency : assembly_latencies_) {
+      sum += latency;
+    }
+    const auto percentile_ms = [this](int percentile) {
+      const size_t index =
+          (assembly_latencies_.size() - 1) * percentile / 100;
+      return to_microseconds(assembly_latencies_[index]).count() / 1e3;
+    };
+    printf(
+        "  assembly_latency_ms: mean=%.2f p50=%.2f p95=%.2f p99=%.2f "
+        "max=%.2f\n",
+        to_microseconds(sum).count() / 1e3 / assembly_latencies_.size(),
+        percentile_ms(50), percentile_ms(95), percentile_ms(99),
+        percentile_ms(100));
+  }
+
+ private:
+  ReplayEnvironment* const environment_;
+  Receiver receiver_;
+  RtpPacketParser rtp_parser_;
+  NackCounter original_nacks_;
+  NackCounter replay_nacks_;
+
+  FrameId latest_frame_id_ = FrameId::first();
+  std::map<FrameId, Clock::time_point> first_packet_times_;
+  std::vector<uint8_t> buffer_;
+
+  int num_rtp_packets_ = 0;
+  int num_frames_ = 0;
+  int64_t num_bytes_ = 0;
+
+  // The time from the arrival of the first packet of each frame until the
+  // Receiver made it available for consumption.
+  std::vector<Clock::duration> assembly_latencies_;
+};
+
+int ReplayMain(int argc, char* argv[]) {
+  const struct option kArgumentOptions[] = {
+      {"verbose", no_argument, nullptr, 'v'},
+      {"help", no_argument, nullptr, 'h'},
+      {nullptr, 0, nullptr, 0}};
+
+  bool is_verbose = false;
+  int ch = -1;
+  while ((ch = getopt_long(argc, argv, "vh", kArgumentOptions, nullptr)) !=
+         -1) {
+    switch (ch) {
+      case 'v':
+        is_verbose = true;
+        break;
+      case 'h':
+        LogUsage(argv[0]);
+        return 1;
+    }
+  }
+  if (optind != (argc - 1)) {
+    LogUsage(argv[0]);
+    return 1;
+  }
+  SetLogLevel(is_verbose ? LogLevel::kVerbose : LogLevel::kWarning);
+
+  ErrorOr<PacketCapture> capture = ReadPacketCapture(argv[optind]);
+  if (capture.is_error()) {
+    OSP_LOG_ERROR << capture.error();
+    return 1;
+  }
+  const std::vector<CapturedPacket>& packets = capture.value().packets;
+  if (capture.value().session_configs.empty() || packets.empty()) {
+    OSP_LOG_ERROR << "Nothing to replay: The capture contains no Receivers or "
+                     "no packets.";
+    return 1;
+  }
+
+  FakeClock clock(packets.front().time);
+  FakeTaskRunner task_runner(&clock);
+  ReplayEnvironment environment(&FakeClock::now, &task_runner);
+  ReceiverPacketRouter router(&environment);
+  std::vector<std::unique_ptr<ReplayedStream>> streams;
+  for (const SessionConfig& config : capture.value().session_configs) {
+    streams.emplace_back(
+        std::make_unique<ReplayedStream>(&environment, &router, config));
+  }
+
+  // Routes RTCP packets by the SSRC of their originator: either the sender
+  // (inbound) or the receiver (outbound).
+  const auto find_stream = [&](absl::Span<const uint8_t> packet,
+                               bool is_outbound) -> ReplayedStream* {
+    const std::pair<ApparentPacketType, Ssrc> seems_like =
+        InspectPacketForRouting(packet);
+    for (const auto& stream : streams) {
+      if (seems_like.second == (is_outbound ? stream->receiver_ssrc()
+                                            : stream->sender_ssrc())) {
+        return stream.get();
+      }
+    }
+    return nullptr;
+  };
+
+  environment.set_sent_packet_handler([&](absl::Span<const uint8_t> packet) {
+    if (ReplayedStream* stream = find_stream(packet, true)) {
+      stream->OnReplayRtcpPacket(packet);
+    }
+  });
+
+  const auto wall_start_time = std::chrono::steady_clock::now();
+  Environment::PacketConsumer* const consumer = &router;
+  for (const CapturedPacket& packet : packets) {
+    if (packet.time > FakeClock::now()) {
+      clock.Advance(packet.time - FakeClock::now());
+    }
+
+    ReplayedStream* const stream = find_stream(packet.data, packet.is_outbound);
+    if (packet.is_outbound) {
+      if (stream) {
+        stream->OnOriginalRtcpPacket(packet.data);
+      }
+      continue;
+    }
+    if (stream && InspectPacketForRouting(packet.data).first ==
+                      ApparentPacketType::RTP) {
+      stream->OnInboundRtpPacket(packet.data);
+    }
+    consumer->OnReceivedPacket(kSenderEndpoint, FakeClock::now(), packet.data);
+    task_runner.RunTasksUntilIdle();
+  }
+  clock.Advance(kDrainDuration);
+  const Clock::duration wall_time = to_microseconds(
+      std::chrono::steady_clock::now() - wall_start_time);
+
+  const Clock::duration capture_duration =
+      packets.back().time - packets.front().time;
+  printf("Replayed %zu packets (%.3f seconds of capture) in %.3f seconds.\n",
+         packets.size(), to_microseconds(capture_duration).count() / 1e6,
+         to_microseconds(wall_time).count() / 1e6);
+  for (const auto& stream : streams) {
+    stream->PrintStats(wall_time);
+  }
+  return 0;
+}
+
+}  // namespace
+}  // namespace cast
+}  // namespace openscreen
+
+int main(int argc, char* argv[]) {
+  return openscreen::cast::ReplayMain(argc, argv);
+}
@@ -9,4 +9,6 @@ namespace openscreen {
 TlsConnection::TlsConnection() = default;
 TlsConnection::~TlsConnection() = default;
 
+void TlsConnection::ReturnReadBlock(std::vector<uint8_t> block) {}
+
 }  // namespace openscreen
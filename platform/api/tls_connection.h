@@ -46,6 +46,12 @@ class TlsConnection {
   // Get the connected remote address.
   virtual IPEndpoint GetRemoteEndpoint() const = 0;
 
+  // Hands back a |block| passed to Client::OnRead() once the client is done
+  // with it, so that the implementation may reuse its storage for a later
+  // read. Clients are not required to call this, and by default the block is
+  // simply freed.
+  virtual void ReturnReadBlock(std::vector<uint8_t> block);
+
  protected:
   TlsConnection();
 };
@@ -16,6 +16,7 @@
 
 #include <cstring>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <vector>
 
@@ -29,6 +30,16 @@
 
 namespace openscreen {
 
+namespace {
+
+constexpr int kMaxApplicationDataBytes = 4096;
+
+// Enough for the reads that can be in flight between the networking thread
+// and the TaskRunner at once in practice; any beyond this are just freed.
+constexpr size_t kMaxPooledReadBlocks = 4;
+
+}  // namespace
+
 // TODO(jophba, rwkeane): implement write blocking/unblocking
 TlsConnectionPosix::TlsConnectionPosix(IPEndpoint local_address,
                                        TaskRunner* task_runner)
@@ -63,8 +74,8 @@ TlsConnectionPosix::~TlsConnectionPosix() {
 
 void TlsConnectionPosix::TryReceiveMessage() {
   OSP_DCHECK(ssl_);
-  constexpr int kMaxApplicationDataBytes = 4096;
-  std::vector<uint8_t> block(kMaxApplicationDataBytes);
+  std::vector<uint8_t> block = TakeReadBlock();
+  block.resize(kMaxApplicationDataBytes);
   ClearOpenSSLERRStack(CURRENT_LOCATION);
   const int bytes_read =
       SSL_read(ssl_.get(), block.data(), kMaxApplicationDataBytes);
@@ -73,6 +84,7 @@ void TlsConnectionPosix::TryReceiveMessage() {
   // no application data available, an error occurred, or we have to take an
   // action.
   if (bytes_read <= 0) {
+    ReturnReadBlock(std::move(block));
     const Error error = GetSSLError(ssl_.get(), bytes_read);
     if (!error.ok() && (error != Error::Code::kAgain)) {
       DispatchError(error);
@@ -118,6 +130,14 @@ IPEndpoint TlsConnectionPosix::GetRemoteEndpoint() const {
   return endpoint.value();
 }
 
+void TlsConnectionPosix::ReturnReadBlock(std::vector<uint8_t> block) {
+  std::lock_guard<std::mutex> lock(read_block_pool_mutex_);
+  if (read_block_pool_.size() < kMaxPooledReadBlocks &&
+      block.capacity() >= static_cast<size_t>(kMaxApplicationDataBytes)) {
+    read_block_pool_.push_back(std::move(block));
+  }
+}
+
 void TlsConnectionPosix::RegisterConnectionWithDataRouter(
     PlatformClientPosix* platform_client) {
   OSP_DCHECK(!platform_client_);
@@ -155,4 +175,14 @@ void TlsConnectionPosix::DispatchError(Error error) {
   });
 }
 
+std::vector<uint8_t> TlsConnectionPosix::TakeReadBlock() {
+  std::lock_guard<std::mutex> lock(read_block_pool_mutex_);
+  if (read_block_pool_.empty()) {
+    return std::vector<uint8_t>();
+  }
+  std::vector<uint8_t> block = std::move(read_block_pool_.back());
+  read_block_pool_.pop_back();
+  return block;
+}
+
 }  // namespace openscreen
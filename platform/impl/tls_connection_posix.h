@@ -8,7 +8,10 @@
 #include <openssl/ssl.h>
 
 #include <memory>
+#include <mutex>
+#include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "platform/api/tls_connection.h"
 #include "platform/impl/platform_client_posix.h"
 #include "platform/impl/stream_socket_posix.h"
@@ -36,6 +39,7 @@ class TlsConnectionPosix : public TlsConnection {
   bool Send(const void* data, size_t len) override;
   IPEndpoint GetLocalEndpoint() const override;
   IPEndpoint GetRemoteEndpoint() const override;
+  void ReturnReadBlock(std::vector<uint8_t> block) override;
 
   // Registers |this| with the platform TlsDataRouterPosix.  This is called
   // automatically by TlsConnectionFactoryPosix after the handshake completes.
@@ -56,6 +60,10 @@ class TlsConnectionPosix : public TlsConnection {
   // has occurred.
   void DispatchError(Error error);
 
+  // Called on the networking thread to get a block to read into, reusing one
+  // handed back through ReturnReadBlock() if there is one.
+  std::vector<uint8_t> TakeReadBlock();
+
   TaskRunner* const task_runner_;
   PlatformClientPosix* platform_client_ = nullptr;
 
@@ -66,6 +74,13 @@ class TlsConnectionPosix : public TlsConnection {
 
   TlsWriteBuffer buffer_;
 
+  // Blocks handed back by the Client, ready to be read into again.  Reads
+  // happen on the networking thread while blocks come back on the TaskRunner
+  // thread, hence the lock.
+  std::mutex read_block_pool_mutex_;
+  std::vector<std::vector<uint8_t>> read_block_pool_
+      GUARDED_BY(read_block_pool_mutex_);
+
   WeakPtrFactory<TlsConnectionPosix> weak_factory_{this};
 
   OSP_DISALLOW_COPY_AND_ASSIGN(TlsConnectionPosix);
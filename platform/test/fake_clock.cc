@@ -42,10 +42,18 @@ void FakeClock::Advance(Clock::duration delta) {
 
   for (;;) {
     // Run tasks at the current time, since this might cause additional delayed
-    // tasks to be posted.
-    for (FakeTaskRunner* task_runner : task_runners_) {
-      task_runner->RunTasksUntilIdle();
-    }
+    // tasks to be posted. Repeat until all the task runners are idle, since
+    // tasks running on one might post tasks to another.
+    bool did_run_tasks;
+    do {
+      did_run_tasks = false;
+      for (FakeTaskRunner* task_runner : task_runners_) {
+        if (task_runner->GetResumeTime() <= now()) {
+          task_runner->RunTasksUntilIdle();
+          did_run_tasks = true;
+        }
+      }
+    } while (did_run_tasks);
 
     // Find the next "step-to" time, and advance the clock to that point.
     Clock::time_point step_to = Clock::time_point::max();
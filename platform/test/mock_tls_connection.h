@@ -26,6 +26,11 @@ class MockTlsConnection : public TlsConnection {
 
   IPEndpoint GetLocalEndpoint() const override { return local_address_; }
   IPEndpoint GetRemoteEndpoint() const override { return remote_address_; }
+  void ReturnReadBlock(std::vector<uint8_t> block) override {
+    ++returned_read_blocks_;
+  }
+
+  int returned_read_blocks() const { return returned_read_blocks_; }
 
   void OnError(Error error) {
     if (client_) {
@@ -42,6 +47,7 @@ class MockTlsConnection : public TlsConnection {
   Client* client_;
   const IPEndpoint local_address_;
   const IPEndpoint remote_address_;
+  int returned_read_blocks_ = 0;
 };
 
 }  // namespace openscreen
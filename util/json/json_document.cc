@@ -0,0 +1,250 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "util/json/json_document.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <utility>
+
+#include "util/json/json_reader.h"
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace json {
+
+namespace {
+
+// Most Cast messages fit in the first block.
+constexpr size_t kMinBlockSize = 4096;
+
+constexpr JsonValue kNullValue;
+
+bool IsIntegral(double d) {
+  return std::trunc(d) == d;
+}
+
+}  // namespace
+
+bool JsonValue::is_int() const {
+  return type_ == Type::kNumber && IsIntegral(number_) &&
+         number_ >= std::numeric_limits<int>::min() &&
+         number_ <= std::numeric_limits<int>::max();
+}
+
+bool JsonValue::is_uint() const {
+  return type_ == Type::kNumber && IsIntegral(number_) && number_ >= 0 &&
+         number_ <= std::numeric_limits<uint32_t>::max();
+}
+
+bool JsonValue::as_bool() const {
+  OSP_DCHECK(is_bool());
+  return bool_value_;
+}
+
+double JsonValue::as_double() const {
+  OSP_DCHECK(is_double());
+  return number_;
+}
+
+int JsonValue::as_int() const {
+  OSP_DCHECK(is_int());
+  return static_cast<int>(number_);
+}
+
+uint32_t JsonValue::as_uint() const {
+  OSP_DCHECK(is_uint());
+  return static_cast<uint32_t>(number_);
+}
+
+absl::string_view JsonValue::as_string() const {
+  OSP_DCHECK(is_string());
+  return absl::string_view(string_, size_);
+}
+
+absl::Span<const JsonValue> JsonValue::elements() const {
+  if (!is_array()) {
+    return {};
+  }
+  return absl::Span<const JsonValue>(elements_, size_);
+}
+
+absl::Span<const JsonMember> JsonValue::members() const {
+  if (!is_object()) {
+    return {};
+  }
+  return absl::Span<const JsonMember>(members_, size_);
+}
+
+size_t JsonValue::size() const {
+  return (is_array() || is_object()) ? size_ : 0;
+}
+
+const JsonValue& JsonValue::operator[](size_t index) const {
+  OSP_DCHECK(is_array());
+  OSP_DCHECK_LT(index, size_);
+  return elements_[index];
+}
+
+const JsonValue& JsonValue::operator[](absl::string_view key) const {
+  const JsonValue* value = Find(key);
+  return value ? *value : kNullValue;
+}
+
+const JsonValue* JsonValue::Find(absl::string_view key) const {
+  for (const JsonMember& member : members()) {
+    if (member.key == key) {
+      return &member.value;
+    }
+  }
+  return nullptr;
+}
+
+JsonDocument::JsonDocument() = default;
+JsonDocument::JsonDocument(JsonDocument&& other) noexcept = default;
+JsonDocument& JsonDocument::operator=(JsonDocument&& other) noexcept = default;
+JsonDocument::~JsonDocument() = default;
+
+Error JsonDocument::Parse(absl::string_view text) {
+  Reset();
+  text_ = text;
+
+  JsonReader reader(text);
+  JsonValue root;
+  // The reader only allows an object or array at the root.
+  if (!ParseValue(&reader, &root) || !reader.Finish()) {
+    pending_elements_.clear();
+    pending_members_.clear();
+    return Error(Error::Code::kJsonParseError, "Invalid JSON");
+  }
+
+  OSP_DCHECK(pending_elements_.empty());
+  OSP_DCHECK(pending_members_.empty());
+  root_ = root;
+  return Error::None();
+}
+
+void JsonDocument::Reset() {
+  root_ = JsonValue();
+  text_ = {};
+  current_block_ = 0;
+  offset_ = 0;
+}
+
+void* JsonDocument::Allocate(size_t size, size_t alignment) {
+  while (current_block_ < blocks_.size()) {
+    const size_t aligned_offset = (offset_ + alignment - 1) & ~(alignment - 1);
+    if (aligned_offset + size <= blocks_[current_block_].size) {
+      offset_ = aligned_offset + size;
+      return blocks_[current_block_].data.get() + aligned_offset;
+    }
+    ++current_block_;
+    offset_ = 0;
+  }
+
+  // Out of blocks: add one, twice the size of the last, so that the number of
+  // blocks grows only logarithmically with the size of the documents.
+  const size_t block_size =
+      std::max({kMinBlockSize, blocks_.empty() ? 0 : 2 * blocks_.back().size,
+                size + alignment});
+  blocks_.push_back(Block{std::make_unique<char[]>(block_size), block_size});
+  current_block_ = blocks_.size() - 1;
+  offset_ = 0;
+  return Allocate(size, alignment);
+}
+
+absl::string_view JsonDocument::Intern(absl::string_view str) {
+  if (str.empty() || (str.data() >= text_.data() &&
+                      str.data() + str.size() <= text_.data() + text_.size())) {
+    return str;
+  }
+  return absl::string_view(CopyToArena<char>(str), str.size());
+}
+
+bool JsonDocument::ParseValue(JsonReader* reader, JsonValue* out) {
+  switch (reader->PeekType()) {
+    case JsonReader::ValueType::kObject: {
+      if (!reader->BeginObject()) {
+        return false;
+      }
+      // Nested objects use the end of |pending_members_| while this one is
+      // being parsed, but are done with it by the time they return.
+      const size_t first = pending_members_.size();
+      absl::string_view key;
+      while (reader->NextMember(&key)) {
+        JsonMember member{Intern(key), {}};
+        if (!ParseValue(reader, &member.value)) {
+          return false;
+        }
+        pending_members_.push_back(member);
+      }
+      if (!reader->ok()) {
+        return false;
+      }
+      const absl::Span<const JsonMember> members =
+          absl::MakeConstSpan(pending_members_).subspan(first);
+      out->type_ = JsonValue::Type::kObject;
+      out->size_ = static_cast<uint32_t>(members.size());
+      out->members_ = CopyToArena(members);
+      pending_members_.resize(first);
+      return true;
+    }
+
+    case JsonReader::ValueType::kArray: {
+      if (!reader->BeginArray()) {
+        return false;
+      }
+      const size_t first = pending_elements_.size();
+      while (reader->NextElement()) {
+        JsonValue element;
+        if (!ParseValue(reader, &element)) {
+          return false;
+        }
+        pending_elements_.push_back(element);
+      }
+      if (!reader->ok()) {
+        return false;
+      }
+      const absl::Span<const JsonValue> elements =
+          absl::MakeConstSpan(pending_elements_).subspan(first);
+      out->type_ = JsonValue::Type::kArray;
+      out->size_ = static_cast<uint32_t>(elements.size());
+      out->elements_ = CopyToArena(elements);
+      pending_elements_.resize(first);
+      return true;
+    }
+
+    case JsonReader::ValueType::kString: {
+      absl::string_view str;
+      if (!reader->ReadString(&str)) {
+        return false;
+      }
+      str = Intern(str);
+      out->type_ = JsonValue::Type::kString;
+      out->size_ = static_cast<uint32_t>(str.size());
+      out->string_ = str.data();
+      return true;
+    }
+
+    case JsonReader::ValueType::kNumber:
+      out->type_ = JsonValue::Type::kNumber;
+      return reader->ReadDouble(&out->number_);
+
+    case JsonReader::ValueType::kBool:
+      out->type_ = JsonValue::Type::kBool;
+      return reader->ReadBool(&out->bool_value_);
+
+    case JsonReader::ValueType::kNull:
+      out->type_ = JsonValue::Type::kNull;
+      return reader->ReadNull();
+
+    case JsonReader::ValueType::kInvalid:
+    default:
+      return false;
+  }
+}
+
+}  // namespace json
+}  // namespace openscreen
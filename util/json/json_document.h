@@ -0,0 +1,173 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UTIL_JSON_JSON_DOCUMENT_H_
+#define UTIL_JSON_JSON_DOCUMENT_H_
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "platform/base/error.h"
+
+namespace openscreen {
+namespace json {
+
+class JsonReader;
+struct JsonMember;
+
+// A read-only view of a value in a JsonDocument. JsonValues are small and
+// trivially copyable, and remain valid until their JsonDocument is destroyed
+// or parses another document.
+class JsonValue {
+ public:
+  enum class Type : uint8_t {
+    kNull,
+    kBool,
+    kNumber,
+    kString,
+    kArray,
+    kObject,
+  };
+
+  constexpr JsonValue() = default;
+
+  Type type() const { return type_; }
+  bool is_null() const { return type_ == Type::kNull; }
+  bool is_bool() const { return type_ == Type::kBool; }
+  bool is_string() const { return type_ == Type::kString; }
+  bool is_array() const { return type_ == Type::kArray; }
+  bool is_object() const { return type_ == Type::kObject; }
+
+  // Like Json::Value, any number is a double, but only numbers that are
+  // exactly representable as an int (or uint32_t) are ints (or uints).
+  bool is_double() const { return type_ == Type::kNumber; }
+  bool is_int() const;
+  bool is_uint() const;
+
+  // The accessors must only be called for values of the matching type.
+  bool as_bool() const;
+  double as_double() const;
+  int as_int() const;
+  uint32_t as_uint() const;
+  absl::string_view as_string() const;
+
+  // The elements of an array, or the members of an object, in the order they
+  // appeared in the document.
+  absl::Span<const JsonValue> elements() const;
+  absl::Span<const JsonMember> members() const;
+
+  // The number of elements or members of an array or object, or zero.
+  size_t size() const;
+
+  // Returns the array element at |index|, which must be less than size().
+  const JsonValue& operator[](size_t index) const;
+
+  // Returns the value of the object member named |key|, or a null value if
+  // there is no such member (or this is not an object). Like Find(), this is a
+  // linear search, which is faster than a map for the small objects in Cast
+  // messages.
+  const JsonValue& operator[](absl::string_view key) const;
+
+  // Like operator[], but returns nullptr if there is no such member.
+  const JsonValue* Find(absl::string_view key) const;
+
+ private:
+  friend class JsonDocument;
+
+  Type type_ = Type::kNull;
+
+  // The length of a string, or the number of elements or members.
+  uint32_t size_ = 0;
+
+  union {
+    bool bool_value_;
+    double number_ = 0.0;
+    const char* string_;
+    const JsonValue* elements_;
+    const JsonMember* members_;
+  };
+};
+
+struct JsonMember {
+  absl::string_view key;
+  JsonValue value;
+};
+
+// A parsed JSON document, held in an arena: every value, along with the
+// arrays of elements and members, is allocated from a few large blocks, which
+// are kept and reused when the JsonDocument parses another document. Strings
+// are not copied at all, but point into the original text (unless they have
+// escape sequences, which are rare in practice), so that text must outlive
+// the JsonDocument, or at least its next call to Parse().
+//
+// Like json::Parse(), the document must be a single object or array, and
+// comments are not allowed. Unlike json::Parse(), duplicate keys are not
+// detected: Find() returns the first.
+class JsonDocument {
+ public:
+  JsonDocument();
+  JsonDocument(JsonDocument&& other) noexcept;
+  JsonDocument& operator=(JsonDocument&& other) noexcept;
+  JsonDocument(const JsonDocument&) = delete;
+  JsonDocument& operator=(const JsonDocument&) = delete;
+  ~JsonDocument();
+
+  // Parses |text|, replacing any previously parsed document.
+  Error Parse(absl::string_view text);
+
+  // The root object or array, or a null value if nothing has been parsed
+  // successfully.
+  const JsonValue& root() const { return root_; }
+
+ private:
+  struct Block {
+    std::unique_ptr<char[]> data;
+    size_t size;
+  };
+
+  // Frees nothing, but makes all the blocks available for reuse.
+  void Reset();
+
+  // Copies |items| to the arena. They must be trivially destructible, since
+  // they are never destroyed.
+  template <typename T>
+  const T* CopyToArena(absl::Span<const T> items) {
+    static_assert(std::is_trivially_destructible<T>::value,
+                  "Arena objects are never destroyed");
+    T* const copy =
+        static_cast<T*>(Allocate(items.size() * sizeof(T), alignof(T)));
+    std::uninitialized_copy(items.begin(), items.end(), copy);
+    return copy;
+  }
+  void* Allocate(size_t size, size_t alignment);
+
+  // Returns |str| if it points into |text_|, or else an arena copy of it.
+  absl::string_view Intern(absl::string_view str);
+
+  // Consumes the next value from |reader| into |out|.
+  bool ParseValue(JsonReader* reader, JsonValue* out);
+
+  absl::string_view text_;
+  JsonValue root_;
+
+  std::vector<Block> blocks_;
+  size_t current_block_ = 0;
+  size_t offset_ = 0;
+
+  // The elements and members of the arrays and objects being parsed, which
+  // are moved to the arena once they are complete, and their sizes known.
+  std::vector<JsonValue> pending_elements_;
+  std::vector<JsonMember> pending_members_;
+};
+
+}  // namespace json
+}  // namespace openscreen
+
+#endif  // UTIL_JSON_JSON_DOCUMENT_H_
@@ -0,0 +1,144 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "util/json/json_document.h"
+
+#include <string>
+
+#include "gtest/gtest.h"
+
+namespace openscreen {
+namespace json {
+namespace {
+
+using Type = JsonValue::Type;
+
+bool PointsInto(absl::string_view str, absl::string_view text) {
+  return str.data() >= text.data() &&
+         str.data() + str.size() <= text.data() + text.size();
+}
+
+}  // namespace
+
+TEST(JsonDocumentTest, ParsesAllTypes) {
+  const std::string text = R"({
+    "null": null, "bool": true, "int": -42, "double": 1.5, "big": 5e9,
+    "string": "OFFER", "array": [1, "two", [3]], "object": {"nested": {}}
+  })";
+  JsonDocument document;
+  ASSERT_TRUE(document.Parse(text).ok());
+
+  const JsonValue& root = document.root();
+  ASSERT_TRUE(root.is_object());
+  EXPECT_EQ(8u, root.size());
+
+  EXPECT_TRUE(root["null"].is_null());
+  EXPECT_TRUE(root["bool"].as_bool());
+  ASSERT_TRUE(root["int"].is_int());
+  EXPECT_FALSE(root["int"].is_uint());
+  EXPECT_EQ(-42, root["int"].as_int());
+  EXPECT_TRUE(root["double"].is_double());
+  EXPECT_FALSE(root["double"].is_int());
+  EXPECT_EQ(1.5, root["double"].as_double());
+  EXPECT_FALSE(root["big"].is_int());
+  EXPECT_FALSE(root["big"].is_uint());
+  EXPECT_EQ(5e9, root["big"].as_double());
+  EXPECT_EQ("OFFER", root["string"].as_string());
+
+  const JsonValue& array = root["array"];
+  ASSERT_TRUE(array.is_array());
+  ASSERT_EQ(3u, array.size());
+  EXPECT_EQ(1, array[0].as_int());
+  EXPECT_EQ("two", array[1].as_string());
+  ASSERT_EQ(Type::kArray, array[2].type());
+  EXPECT_EQ(3, array[2][0].as_int());
+
+  const JsonValue& object = root["object"];
+  ASSERT_TRUE(object.is_object());
+  ASSERT_NE(nullptr, object.Find("nested"));
+  EXPECT_TRUE(object.Find("nested")->is_object());
+  EXPECT_EQ(0u, object["nested"].size());
+}
+
+TEST(JsonDocumentTest, KeepsMemberOrder) {
+  JsonDocument document;
+  ASSERT_TRUE(document.Parse(R"({"b": 1, "a": 2, "c": 3})").ok());
+  std::string keys;
+  for (const JsonMember& member : document.root().members()) {
+    keys += std::string(member.key);
+  }
+  EXPECT_EQ("bac", keys);
+}
+
+TEST(JsonDocumentTest, MissingMembersAreNull) {
+  JsonDocument document;
+  ASSERT_TRUE(document.Parse(R"({"a": [1]})").ok());
+  EXPECT_EQ(nullptr, document.root().Find("b"));
+  EXPECT_TRUE(document.root()["b"].is_null());
+  EXPECT_TRUE(document.root()["b"]["c"].is_null());
+  // Not an object.
+  EXPECT_TRUE(document.root()["a"]["c"].is_null());
+  EXPECT_EQ(0u, document.root()["a"].members().size());
+}
+
+TEST(JsonDocumentTest, StringsPointIntoTextUnlessEscaped) {
+  const std::string text = R"({"plain": "value", "esc\naped": "tab\tbed"})";
+  JsonDocument document;
+  ASSERT_TRUE(document.Parse(text).ok());
+
+  const absl::Span<const JsonMember> members = document.root().members();
+  ASSERT_EQ(2u, members.size());
+  EXPECT_TRUE(PointsInto(members[0].key, text));
+  EXPECT_TRUE(PointsInto(members[0].value.as_string(), text));
+  EXPECT_EQ("esc\naped", members[1].key);
+  EXPECT_FALSE(PointsInto(members[1].key, text));
+  EXPECT_EQ("tab\tbed", members[1].value.as_string());
+  EXPECT_FALSE(PointsInto(members[1].value.as_string(), text));
+}
+
+TEST(JsonDocumentTest, ParsesLargeDocuments) {
+  // Enough values to need several arena blocks.
+  std::string text = "[";
+  for (int i = 0; i < 10000; ++i) {
+    text += (i == 0 ? "" : ",") + std::string(R"({"index": )") +
+            std::to_string(i) + R"(, "name": "A"})";
+  }
+  text += "]";
+
+  JsonDocument document;
+  ASSERT_TRUE(document.Parse(text).ok());
+  ASSERT_EQ(10000u, document.root().size());
+  for (int i = 0; i < 10000; ++i) {
+    ASSERT_EQ(i, document.root()[i]["index"].as_int());
+    ASSERT_EQ("A", document.root()[i]["name"].as_string());
+  }
+}
+
+TEST(JsonDocumentTest, CanBeReused) {
+  JsonDocument document;
+  ASSERT_TRUE(document.Parse(R"({"first": [1, 2, 3]})").ok());
+  EXPECT_EQ(3u, document.root()["first"].size());
+
+  EXPECT_FALSE(document.Parse(R"({"second": )").ok());
+  EXPECT_TRUE(document.root().is_null());
+
+  ASSERT_TRUE(document.Parse(R"([{"third": "3"}])").ok());
+  ASSERT_TRUE(document.root().is_array());
+  EXPECT_EQ("3", document.root()[0]["third"].as_string());
+  EXPECT_TRUE(document.root()[0]["first"].is_null());
+}
+
+TEST(JsonDocumentTest, RejectsInvalidDocuments) {
+  const char* const kInvalidDocuments[] = {
+      "", "{", "42", R"("root")", "{} {}", "{ foo: bar }", "[1,]", "[01]",
+  };
+  for (const char* text : kInvalidDocuments) {
+    JsonDocument document;
+    const Error error = document.Parse(text);
+    EXPECT_EQ(Error::Code::kJsonParseError, error.code()) << text;
+  }
+}
+
+}  // namespace json
+}  // namespace openscreen
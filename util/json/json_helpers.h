@@ -7,7 +7,7 @@
 
 #include <chrono>
 #include <cmath>
-#include <functional>
+#include <limits>
 #include <string>
 #include <utility>
 #include <vector>
@@ -16,6 +16,8 @@
 #include "json/value.h"
 #include "platform/base/error.h"
 #include "util/chrono_helpers.h"
+#include "util/json/json_document.h"
+#include "util/json/json_reader.h"
 #include "util/simple_fraction.h"
 
 // This file contains helper methods for parsing JSON, in an attempt to
@@ -165,8 +167,10 @@ inline bool ParseAndValidateMilliseconds(const Json::Value& value,
   return true;
 }
 
+// A plain function pointer, so that passing the name of one of the overloaded
+// helpers above selects the right overload.
 template <typename T>
-using Parser = std::function<bool(const Json::Value&, T*)>;
+using Parser = bool (*)(const Json::Value&, T*);
 
 // NOTE: array parsing methods reset the output vector to an empty vector in
 // any error case. This is especially useful for optional arrays.
@@ -207,6 +211,296 @@ inline bool ParseAndValidateStringArray(const Json::Value& value,
   return ParseAndValidateArray<std::string>(value, ParseAndValidateString, out);
 }
 
+// Counterparts of the methods above, for values in a JsonDocument.
+inline ErrorOr<bool> ParseBool(const JsonValue& parent,
+                               absl::string_view field) {
+  const JsonValue& value = parent[field];
+  if (!value.is_bool()) {
+    return CreateParseError("bool field " + std::string(field));
+  }
+  return value.as_bool();
+}
+
+inline ErrorOr<int> ParseInt(const JsonValue& parent, absl::string_view field) {
+  const JsonValue& value = parent[field];
+  if (!value.is_int()) {
+    return CreateParseError("integer field: " + std::string(field));
+  }
+  return value.as_int();
+}
+
+inline ErrorOr<uint32_t> ParseUint(const JsonValue& parent,
+                                   absl::string_view field) {
+  const JsonValue& value = parent[field];
+  if (!value.is_uint()) {
+    return CreateParseError("unsigned integer field: " + std::string(field));
+  }
+  return value.as_uint();
+}
+
+inline ErrorOr<std::string> ParseString(const JsonValue& parent,
+                                        absl::string_view field) {
+  const JsonValue& value = parent[field];
+  if (!value.is_string()) {
+    return CreateParseError("string field: " + std::string(field));
+  }
+  return std::string(value.as_string());
+}
+
+inline bool ParseBool(const JsonValue& value, bool* out) {
+  if (!value.is_bool()) {
+    return false;
+  }
+  *out = value.as_bool();
+  return true;
+}
+
+inline bool ParseAndValidateDouble(const JsonValue& value,
+                                   double* out,
+                                   bool allow_negative = false) {
+  if (!value.is_double()) {
+    return false;
+  }
+  const double d = value.as_double();
+  if (!allow_negative && d < 0) {
+    return false;
+  }
+  *out = d;
+  return true;
+}
+
+inline bool ParseAndValidateInt(const JsonValue& value, int* out) {
+  if (!value.is_int()) {
+    return false;
+  }
+  int i = value.as_int();
+  if (i < 0) {
+    return false;
+  }
+  *out = i;
+  return true;
+}
+
+inline bool ParseAndValidateUint(const JsonValue& value, uint32_t* out) {
+  if (!value.is_uint()) {
+    return false;
+  }
+  *out = value.as_uint();
+  return true;
+}
+
+inline bool ParseAndValidateString(const JsonValue& value, std::string* out) {
+  if (!value.is_string()) {
+    return false;
+  }
+  out->assign(value.as_string().data(), value.as_string().size());
+  return true;
+}
+
+// Like the above, but without copying the string out of the JsonDocument.
+inline bool ParseAndValidateString(const JsonValue& value,
+                                   absl::string_view* out) {
+  if (!value.is_string()) {
+    return false;
+  }
+  *out = value.as_string();
+  return true;
+}
+
+template <typename T>
+using JsonValueParser = bool (*)(const JsonValue&, T*);
+
+template <typename T>
+bool ParseAndValidateArray(const JsonValue& value,
+                           JsonValueParser<T> parser,
+                           std::vector<T>* out) {
+  out->clear();
+  if (!value.is_array() || value.size() == 0) {
+    return false;
+  }
+
+  out->reserve(value.size());
+  for (const JsonValue& element : value.elements()) {
+    T v;
+    if (!parser(element, &v)) {
+      out->clear();
+      return false;
+    }
+    out->push_back(std::move(v));
+  }
+
+  return true;
+}
+
+inline bool ParseAndValidateIntArray(const JsonValue& value,
+                                     std::vector<int>* out) {
+  return ParseAndValidateArray<int>(value, ParseAndValidateInt, out);
+}
+
+inline bool ParseAndValidateUintArray(const JsonValue& value,
+                                      std::vector<uint32_t>* out) {
+  return ParseAndValidateArray<uint32_t>(value, ParseAndValidateUint, out);
+}
+
+inline bool ParseAndValidateStringArray(const JsonValue& value,
+                                        std::vector<std::string>* out) {
+  return ParseAndValidateArray<std::string>(value, ParseAndValidateString, out);
+}
+
+// Counterparts of the methods above, for reading straight from a JsonReader
+// instead of a Json::Value. Each consumes the next value, whether or not it is
+// valid.
+inline bool ReadBool(JsonReader* reader, bool* out) {
+  if (reader->ReadBool(out)) {
+    return true;
+  }
+  reader->SkipValue();
+  return false;
+}
+
+inline bool ReadAndValidateDouble(JsonReader* reader,
+                                  double* out,
+                                  bool allow_negative = false) {
+  double d;
+  if (!reader->ReadDouble(&d)) {
+    reader->SkipValue();
+    return false;
+  }
+  if (!allow_negative && d < 0) {
+    return false;
+  }
+  *out = d;
+  return true;
+}
+
+inline bool ReadAndValidateInt(JsonReader* reader, int* out) {
+  int i;
+  if (!reader->ReadInt(&i)) {
+    reader->SkipValue();
+    return false;
+  }
+  if (i < 0) {
+    return false;
+  }
+  *out = i;
+  return true;
+}
+
+inline bool ReadAndValidateString(JsonReader* reader, std::string* out) {
+  if (reader->ReadString(out)) {
+    return true;
+  }
+  reader->SkipValue();
+  return false;
+}
+
+inline bool ReadAndValidateUint(JsonReader* reader, uint32_t* out) {
+  // Like Json::Value::isUInt(), this accepts any number that is exactly
+  // representable as a uint32_t (including, e.g., 3.0).
+  double d;
+  if (!reader->ReadDouble(&d)) {
+    reader->SkipValue();
+    return false;
+  }
+  if (d < 0 || d > std::numeric_limits<uint32_t>::max() || d != std::floor(d)) {
+    return false;
+  }
+  *out = static_cast<uint32_t>(d);
+  return true;
+}
+
+inline bool ReadAndValidateSimpleFraction(JsonReader* reader,
+                                          SimpleFraction* out) {
+  if (reader->PeekType() == JsonReader::ValueType::kNumber) {
+    int parsed;
+    if (!ReadAndValidateInt(reader, &parsed)) {
+      return false;
+    }
+    *out = SimpleFraction{parsed, 1};
+    return true;
+  }
+
+  std::string raw;
+  if (!ReadAndValidateString(reader, &raw)) {
+    return false;
+  }
+  auto fraction_or_error = SimpleFraction::FromString(raw);
+  if (!fraction_or_error || !fraction_or_error.value().is_positive() ||
+      !fraction_or_error.value().is_defined()) {
+    return false;
+  }
+  *out = std::move(fraction_or_error.value());
+  return true;
+}
+
+inline bool ReadAndValidateMilliseconds(JsonReader* reader,
+                                        milliseconds* out) {
+  int out_ms;
+  if (!ReadAndValidateInt(reader, &out_ms)) {
+    return false;
+  }
+  *out = milliseconds(out_ms);
+  return true;
+}
+
+// Consumes the start of an object, just like JsonReader::BeginObject(). For a
+// value of any other type, consumes the whole value instead, and returns false.
+inline bool BeginObjectOrSkip(JsonReader* reader) {
+  if (reader->PeekType() == JsonReader::ValueType::kObject) {
+    return reader->BeginObject();
+  }
+  reader->SkipValue();
+  return false;
+}
+
+// A plain function pointer, like Parser.
+template <typename T>
+using Reader = bool (*)(JsonReader*, T*);
+
+// Like ParseAndValidateArray(), |out| is reset to an empty vector in any error
+// case.
+template <typename T>
+bool ReadAndValidateArray(JsonReader* reader,
+                          Reader<T> element_reader,
+                          std::vector<T>* out) {
+  out->clear();
+  if (reader->PeekType() != JsonReader::ValueType::kArray) {
+    reader->SkipValue();
+    return false;
+  }
+
+  reader->BeginArray();
+  bool valid = true;
+  while (reader->NextElement()) {
+    T v;
+    if (!element_reader(reader, &v)) {
+      valid = false;
+    } else if (valid) {
+      out->push_back(std::move(v));
+    }
+  }
+
+  if (!valid || out->empty() || !reader->ok()) {
+    out->clear();
+    return false;
+  }
+  return true;
+}
+
+inline bool ReadAndValidateIntArray(JsonReader* reader, std::vector<int>* out) {
+  return ReadAndValidateArray<int>(reader, ReadAndValidateInt, out);
+}
+
+inline bool ReadAndValidateUintArray(JsonReader* reader,
+                                     std::vector<uint32_t>* out) {
+  return ReadAndValidateArray<uint32_t>(reader, ReadAndValidateUint, out);
+}
+
+inline bool ReadAndValidateStringArray(JsonReader* reader,
+                                       std::vector<std::string>* out) {
+  return ReadAndValidateArray<std::string>(reader, ReadAndValidateString, out);
+}
+
 }  // namespace json
 }  // namespace openscreen
 
@@ -212,5 +212,175 @@ TEST(ParsingHelpersTest, ParseAndValidateStringArray) {
   EXPECT_FALSE(ParseAndValidateStringArray(kEmptyArray, &out));
 }
 
+TEST(ParsingHelpersTest, ParsesJsonDocumentValues) {
+  JsonDocument document;
+  ASSERT_TRUE(document
+                  .Parse(R"({"bool": true, "int": 42, "negative": -1,
+                              "double": -0.5, "string": "nitro cold brew",
+                              "ints": [123, 456], "strings": ["a", 1]})")
+                  .ok());
+  const JsonValue& root = document.root();
+
+  bool b = false;
+  EXPECT_TRUE(ParseBool(root["bool"], &b));
+  EXPECT_TRUE(b);
+  EXPECT_FALSE(ParseBool(root["int"], &b));
+  EXPECT_TRUE(ParseBool(root, "bool").value());
+  EXPECT_TRUE(ParseBool(root, "missing").is_error());
+
+  int i = 0;
+  EXPECT_TRUE(ParseAndValidateInt(root["int"], &i));
+  EXPECT_EQ(42, i);
+  EXPECT_FALSE(ParseAndValidateInt(root["negative"], &i));
+  EXPECT_FALSE(ParseAndValidateInt(root["double"], &i));
+  EXPECT_EQ(-1, ParseInt(root, "negative").value());
+  EXPECT_TRUE(ParseInt(root, "string").is_error());
+
+  uint32_t u = 0;
+  EXPECT_TRUE(ParseAndValidateUint(root["int"], &u));
+  EXPECT_EQ(42u, u);
+  EXPECT_FALSE(ParseAndValidateUint(root["negative"], &u));
+  EXPECT_EQ(42u, ParseUint(root, "int").value());
+
+  double d = 0;
+  EXPECT_FALSE(ParseAndValidateDouble(root["double"], &d));
+  EXPECT_TRUE(ParseAndValidateDouble(root["double"], &d, true));
+  EXPECT_EQ(-0.5, d);
+
+  std::string s;
+  EXPECT_TRUE(ParseAndValidateString(root["string"], &s));
+  EXPECT_EQ("nitro cold brew", s);
+  absl::string_view view;
+  EXPECT_TRUE(ParseAndValidateString(root["string"], &view));
+  EXPECT_EQ("nitro cold brew", view);
+  EXPECT_FALSE(ParseAndValidateString(root["int"], &view));
+  EXPECT_EQ("nitro cold brew", ParseString(root, "string").value());
+
+  std::vector<int> ints;
+  EXPECT_TRUE(ParseAndValidateIntArray(root["ints"], &ints));
+  EXPECT_THAT(ints, ElementsAre(123, 456));
+  EXPECT_FALSE(ParseAndValidateIntArray(root["strings"], &ints));
+  EXPECT_TRUE(ints.empty());
+  std::vector<std::string> strings;
+  EXPECT_FALSE(ParseAndValidateStringArray(root["strings"], &strings));
+  EXPECT_FALSE(ParseAndValidateStringArray(root["missing"], &strings));
+}
+
+TEST(ParsingHelpersTest, ReadAndValidateScalars) {
+  JsonReader reader(
+      R"([-1.5, 42, -42, "iced coffee", true, 1.5, "not a number", null])");
+  ASSERT_TRUE(reader.BeginArray());
+
+  double d;
+  ASSERT_TRUE(reader.NextElement());
+  EXPECT_TRUE(ReadAndValidateDouble(&reader, &d, true));
+  EXPECT_EQ(-1.5, d);
+
+  int i;
+  ASSERT_TRUE(reader.NextElement());
+  EXPECT_TRUE(ReadAndValidateInt(&reader, &i));
+  EXPECT_EQ(42, i);
+  ASSERT_TRUE(reader.NextElement());
+  EXPECT_FALSE(ReadAndValidateInt(&reader, &i));
+
+  std::string s;
+  ASSERT_TRUE(reader.NextElement());
+  EXPECT_TRUE(ReadAndValidateString(&reader, &s));
+  EXPECT_EQ("iced coffee", s);
+
+  bool b = false;
+  ASSERT_TRUE(reader.NextElement());
+  EXPECT_TRUE(ReadBool(&reader, &b));
+  EXPECT_TRUE(b);
+
+  // Invalid values are consumed all the same.
+  ASSERT_TRUE(reader.NextElement());
+  EXPECT_FALSE(ReadAndValidateInt(&reader, &i));
+  ASSERT_TRUE(reader.NextElement());
+  EXPECT_FALSE(ReadAndValidateDouble(&reader, &d));
+  ASSERT_TRUE(reader.NextElement());
+  EXPECT_FALSE(ReadBool(&reader, &b));
+
+  EXPECT_FALSE(reader.NextElement());
+  EXPECT_TRUE(reader.Finish());
+}
+
+TEST(ParsingHelpersTest, ReadAndValidateArrays) {
+  JsonReader reader(R"([[123, 456], [-1, 456], [], "latte", ["a", "b"]])");
+  ASSERT_TRUE(reader.BeginArray());
+
+  std::vector<int> ints;
+  ASSERT_TRUE(reader.NextElement());
+  EXPECT_TRUE(ReadAndValidateIntArray(&reader, &ints));
+  EXPECT_THAT(ints, ElementsAre(123, 456));
+  ASSERT_TRUE(reader.NextElement());
+  EXPECT_FALSE(ReadAndValidateIntArray(&reader, &ints));
+  EXPECT_TRUE(ints.empty());
+  ASSERT_TRUE(reader.NextElement());
+  EXPECT_FALSE(ReadAndValidateIntArray(&reader, &ints));
+  ASSERT_TRUE(reader.NextElement());
+  EXPECT_FALSE(ReadAndValidateIntArray(&reader, &ints));
+
+  std::vector<std::string> strings;
+  ASSERT_TRUE(reader.NextElement());
+  EXPECT_TRUE(ReadAndValidateStringArray(&reader, &strings));
+  EXPECT_THAT(strings, ElementsAre("a", "b"));
+
+  EXPECT_FALSE(reader.NextElement());
+  EXPECT_TRUE(reader.Finish());
+}
+
+TEST(ParsingHelpersTest, ReadAndValidateOtherValues) {
+  JsonReader reader(R"([4294967295, -1, 1.5, "60000/1001", 30, "5/0", 250,
+                        [1, 2], [1, -2], {"a": 1}, [3]])");
+  ASSERT_TRUE(reader.BeginArray());
+
+  uint32_t u;
+  ASSERT_TRUE(reader.NextElement());
+  EXPECT_TRUE(ReadAndValidateUint(&reader, &u));
+  EXPECT_EQ(4294967295u, u);
+  ASSERT_TRUE(reader.NextElement());
+  EXPECT_FALSE(ReadAndValidateUint(&reader, &u));
+  ASSERT_TRUE(reader.NextElement());
+  EXPECT_FALSE(ReadAndValidateUint(&reader, &u));
+
+  SimpleFraction fraction;
+  ASSERT_TRUE(reader.NextElement());
+  EXPECT_TRUE(ReadAndValidateSimpleFraction(&reader, &fraction));
+  EXPECT_EQ((SimpleFraction{60000, 1001}), fraction);
+  ASSERT_TRUE(reader.NextElement());
+  EXPECT_TRUE(ReadAndValidateSimpleFraction(&reader, &fraction));
+  EXPECT_EQ((SimpleFraction{30, 1}), fraction);
+  ASSERT_TRUE(reader.NextElement());
+  EXPECT_FALSE(ReadAndValidateSimpleFraction(&reader, &fraction));
+
+  milliseconds ms;
+  ASSERT_TRUE(reader.NextElement());
+  EXPECT_TRUE(ReadAndValidateMilliseconds(&reader, &ms));
+  EXPECT_EQ(milliseconds(250), ms);
+
+  std::vector<uint32_t> uints;
+  ASSERT_TRUE(reader.NextElement());
+  EXPECT_TRUE(ReadAndValidateUintArray(&reader, &uints));
+  EXPECT_THAT(uints, ElementsAre(1u, 2u));
+  ASSERT_TRUE(reader.NextElement());
+  EXPECT_FALSE(ReadAndValidateUintArray(&reader, &uints));
+  EXPECT_TRUE(uints.empty());
+
+  // Only an object is begun; anything else is skipped.
+  absl::string_view key;
+  ASSERT_TRUE(reader.NextElement());
+  ASSERT_TRUE(BeginObjectOrSkip(&reader));
+  ASSERT_TRUE(reader.NextMember(&key));
+  EXPECT_EQ("a", key);
+  EXPECT_TRUE(reader.SkipValue());
+  EXPECT_FALSE(reader.NextMember(&key));
+  ASSERT_TRUE(reader.NextElement());
+  EXPECT_FALSE(BeginObjectOrSkip(&reader));
+
+  EXPECT_FALSE(reader.NextElement());
+  EXPECT_TRUE(reader.Finish());
+}
+
 }  // namespace json
 }  // namespace openscreen
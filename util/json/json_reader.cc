@@ -0,0 +1,537 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "util/json/json_reader.h"
+
+#include <stdint.h>
+
+#include <cmath>
+#include <limits>
+
+#include "absl/strings/numbers.h"
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace json {
+
+namespace {
+
+bool IsDigit(char c) {
+  return c >= '0' && c <= '9';
+}
+
+// Parses the four hex digits at the start of |hex|.
+bool ParseHex4(absl::string_view hex, uint32_t* out) {
+  if (hex.size() < 4) {
+    return false;
+  }
+  uint32_t value = 0;
+  for (int i = 0; i < 4; ++i) {
+    const char c = hex[i];
+    value <<= 4;
+    if (c >= '0' && c <= '9') {
+      value |= c - '0';
+    } else if (c >= 'a' && c <= 'f') {
+      value |= c - 'a' + 10;
+    } else if (c >= 'A' && c <= 'F') {
+      value |= c - 'A' + 10;
+    } else {
+      return false;
+    }
+  }
+  *out = value;
+  return true;
+}
+
+void AppendUtf8(uint32_t code_point, std::string* out) {
+  if (code_point < 0x80) {
+    out->push_back(static_cast<char>(code_point));
+  } else if (code_point < 0x800) {
+    out->push_back(static_cast<char>(0xc0 | (code_point >> 6)));
+    out->push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+  } else if (code_point < 0x10000) {
+    out->push_back(static_cast<char>(0xe0 | (code_point >> 12)));
+    out->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+    out->push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+  } else {
+    out->push_back(static_cast<char>(0xf0 | (code_point >> 18)));
+    out->push_back(static_cast<char>(0x80 | ((code_point >> 12) & 0x3f)));
+    out->push_back(static_cast<char>(0x80 | ((code_point >> 6) & 0x3f)));
+    out->push_back(static_cast<char>(0x80 | (code_point & 0x3f)));
+  }
+}
+
+}  // namespace
+
+JsonReader::JsonReader(absl::string_view document) : document_(document) {}
+
+JsonReader::~JsonReader() = default;
+
+JsonReader::ValueType JsonReader::PeekType() {
+  if (!ok_) {
+    return ValueType::kInvalid;
+  }
+  SkipWhitespace();
+  if (pos_ >= document_.size()) {
+    return ValueType::kInvalid;
+  }
+  const char c = document_[pos_];
+  switch (c) {
+    case '{':
+      return ValueType::kObject;
+    case '[':
+      return ValueType::kArray;
+    case '"':
+      return ValueType::kString;
+    case 't':
+    case 'f':
+      return ValueType::kBool;
+    case 'n':
+      return ValueType::kNull;
+    default:
+      return (c == '-' || IsDigit(c)) ? ValueType::kNumber
+                                      : ValueType::kInvalid;
+  }
+}
+
+bool JsonReader::BeginObject() {
+  return BeginContainer('{', '}');
+}
+
+bool JsonReader::NextMember(absl::string_view* key) {
+  if (!NextInContainer('}')) {
+    return false;
+  }
+  if (PeekType() != ValueType::kString) {
+    return Fail();
+  }
+  absl::string_view raw;
+  bool has_escapes;
+  if (!ScanString(&raw, &has_escapes)) {
+    return false;
+  }
+  if (has_escapes) {
+    if (!Unescape(raw, &key_buffer_)) {
+      return Fail();
+    }
+    *key = key_buffer_;
+  } else {
+    *key = raw;
+  }
+  return Expect(':');
+}
+
+bool JsonReader::BeginArray() {
+  return BeginContainer('[', ']');
+}
+
+bool JsonReader::NextElement() {
+  return NextInContainer(']');
+}
+
+bool JsonReader::ReadString(std::string* out) {
+  if (PeekType() != ValueType::kString || !CheckScalarAllowed()) {
+    return false;
+  }
+  absl::string_view raw;
+  bool has_escapes;
+  if (!ScanString(&raw, &has_escapes)) {
+    return false;
+  }
+  if (!has_escapes) {
+    out->assign(raw.data(), raw.size());
+    return true;
+  }
+  return Unescape(raw, out) || Fail();
+}
+
+bool JsonReader::ReadString(absl::string_view* out) {
+  if (PeekType() != ValueType::kString || !CheckScalarAllowed()) {
+    return false;
+  }
+  bool has_escapes;
+  if (!ScanString(out, &has_escapes)) {
+    return false;
+  }
+  if (has_escapes) {
+    if (!Unescape(*out, &value_buffer_)) {
+      return Fail();
+    }
+    *out = value_buffer_;
+  }
+  return true;
+}
+
+bool JsonReader::ReadInt(int* out) {
+  if (PeekType() != ValueType::kNumber || !CheckScalarAllowed()) {
+    return false;
+  }
+  const size_t start = pos_;
+  absl::string_view text;
+  bool is_integer_literal;
+  if (!ScanNumber(&text, &is_integer_literal)) {
+    return false;
+  }
+
+  if (is_integer_literal) {
+    int64_t value;
+    if (absl::SimpleAtoi(text, &value) &&
+        value >= std::numeric_limits<int>::min() &&
+        value <= std::numeric_limits<int>::max()) {
+      *out = static_cast<int>(value);
+      return true;
+    }
+  } else {
+    double value;
+    if (absl::SimpleAtod(text, &value) && std::trunc(value) == value &&
+        value >= std::numeric_limits<int>::min() &&
+        value <= std::numeric_limits<int>::max()) {
+      *out = static_cast<int>(value);
+      return true;
+    }
+  }
+
+  // A valid number, but not an int: leave it for the caller to skip.
+  pos_ = start;
+  return false;
+}
+
+bool JsonReader::ReadDouble(double* out) {
+  if (PeekType() != ValueType::kNumber || !CheckScalarAllowed()) {
+    return false;
+  }
+  absl::string_view text;
+  bool is_integer_literal;
+  if (!ScanNumber(&text, &is_integer_literal)) {
+    return false;
+  }
+  return absl::SimpleAtod(text, out) || Fail();
+}
+
+bool JsonReader::ReadBool(bool* out) {
+  if (PeekType() != ValueType::kBool || !CheckScalarAllowed()) {
+    return false;
+  }
+  if (document_[pos_] == 't') {
+    *out = true;
+    return ScanLiteral("true");
+  }
+  *out = false;
+  return ScanLiteral("false");
+}
+
+bool JsonReader::ReadNull() {
+  if (PeekType() != ValueType::kNull || !CheckScalarAllowed()) {
+    return false;
+  }
+  return ScanLiteral("null");
+}
+
+bool JsonReader::SkipValue() {
+  switch (PeekType()) {
+    case ValueType::kObject: {
+      if (!BeginObject()) {
+        return false;
+      }
+      absl::string_view key;
+      while (NextMember(&key)) {
+        if (!SkipValue()) {
+          return false;
+        }
+      }
+      return ok_;
+    }
+
+    case ValueType::kArray:
+      if (!BeginArray()) {
+        return false;
+      }
+      while (NextElement()) {
+        if (!SkipValue()) {
+          return false;
+        }
+      }
+      return ok_;
+
+    case ValueType::kString: {
+      if (!CheckScalarAllowed()) {
+        return false;
+      }
+      absl::string_view raw;
+      bool has_escapes;
+      return ScanString(&raw, &has_escapes);
+    }
+
+    case ValueType::kNumber: {
+      if (!CheckScalarAllowed()) {
+        return false;
+      }
+      absl::string_view text;
+      bool is_integer_literal;
+      return ScanNumber(&text, &is_integer_literal);
+    }
+
+    case ValueType::kBool: {
+      bool unused;
+      return ReadBool(&unused);
+    }
+
+    case ValueType::kNull:
+      return ReadNull();
+
+    case ValueType::kInvalid:
+    default:
+      return Fail();
+  }
+}
+
+bool JsonReader::ReadRawValue(absl::string_view* raw) {
+  if (!ok_) {
+    return false;
+  }
+  SkipWhitespace();
+  const size_t start = pos_;
+  if (!SkipValue()) {
+    return false;
+  }
+  *raw = document_.substr(start, pos_ - start);
+  return true;
+}
+
+bool JsonReader::Finish() {
+  if (!ok_) {
+    return false;
+  }
+  SkipWhitespace();
+  if (!has_root_ || !containers_.empty() || pos_ != document_.size()) {
+    return Fail();
+  }
+  return true;
+}
+
+bool JsonReader::Fail() {
+  ok_ = false;
+  return false;
+}
+
+void JsonReader::SkipWhitespace() {
+  while (pos_ < document_.size()) {
+    const char c = document_[pos_];
+    if (c != ' ' && c != '\t' && c != '\n' && c != '\r') {
+      break;
+    }
+    ++pos_;
+  }
+}
+
+bool JsonReader::Expect(char c) {
+  if (!ok_) {
+    return false;
+  }
+  SkipWhitespace();
+  if (pos_ >= document_.size() || document_[pos_] != c) {
+    return Fail();
+  }
+  ++pos_;
+  return true;
+}
+
+bool JsonReader::CheckScalarAllowed() {
+  return !containers_.empty() || Fail();
+}
+
+bool JsonReader::BeginContainer(char open, char close) {
+  if (!ok_) {
+    return false;
+  }
+  if (containers_.empty()) {
+    // There can only be one root value.
+    if (has_root_) {
+      return Fail();
+    }
+    has_root_ = true;
+  } else if (static_cast<int>(containers_.size()) >= kMaxDepth) {
+    return Fail();
+  }
+  if (!Expect(open)) {
+    return false;
+  }
+  containers_.push_back(Container{close, false});
+  return true;
+}
+
+bool JsonReader::NextInContainer(char close) {
+  if (!ok_) {
+    return false;
+  }
+  if (containers_.empty() || containers_.back().close != close) {
+    return Fail();
+  }
+  SkipWhitespace();
+  if (pos_ < document_.size() && document_[pos_] == close) {
+    ++pos_;
+    containers_.pop_back();
+    return false;
+  }
+  if (containers_.back().expect_comma && !Expect(',')) {
+    return false;
+  }
+  containers_.back().expect_comma = true;
+  return true;
+}
+
+bool JsonReader::ScanString(absl::string_view* raw, bool* has_escapes) {
+  OSP_DCHECK_EQ(document_[pos_], '"');
+  const size_t start = ++pos_;
+  *has_escapes = false;
+  while (pos_ < document_.size()) {
+    const char c = document_[pos_];
+    if (c == '"') {
+      *raw = document_.substr(start, pos_ - start);
+      ++pos_;
+      return true;
+    }
+    if (static_cast<unsigned char>(c) < 0x20) {
+      return Fail();  // Control characters must be escaped.
+    }
+    if (c == '\\') {
+      *has_escapes = true;
+      ++pos_;
+      if (pos_ >= document_.size()) {
+        break;
+      }
+      // Unescape() checks \u sequences in detail, if the string is used.
+      if (absl::string_view("\"\\/bfnrtu").find(document_[pos_]) ==
+          absl::string_view::npos) {
+        return Fail();
+      }
+    }
+    ++pos_;
+  }
+  return Fail();  // Unterminated.
+}
+
+// static
+bool JsonReader::Unescape(absl::string_view raw, std::string* out) {
+  out->clear();
+  out->reserve(raw.size());
+  for (size_t i = 0; i < raw.size(); ++i) {
+    const char c = raw[i];
+    if (c != '\\') {
+      out->push_back(c);
+      continue;
+    }
+    OSP_DCHECK_LT(i + 1, raw.size());
+    switch (raw[++i]) {
+      case '"':
+        out->push_back('"');
+        break;
+      case '\\':
+        out->push_back('\\');
+        break;
+      case '/':
+        out->push_back('/');
+        break;
+      case 'b':
+        out->push_back('\b');
+        break;
+      case 'f':
+        out->push_back('\f');
+        break;
+      case 'n':
+        out->push_back('\n');
+        break;
+      case 'r':
+        out->push_back('\r');
+        break;
+      case 't':
+        out->push_back('\t');
+        break;
+      case 'u': {
+        uint32_t code_point;
+        if (!ParseHex4(raw.substr(i + 1), &code_point)) {
+          return false;
+        }
+        i += 4;
+        if (code_point >= 0xd800 && code_point <= 0xdbff) {
+          // A high surrogate must be followed by an escaped low surrogate.
+          uint32_t low;
+          if (raw.substr(i + 1, 2) != "\\u" ||
+              !ParseHex4(raw.substr(i + 3), &low) || low < 0xdc00 ||
+              low > 0xdfff) {
+            return false;
+          }
+          i += 6;
+          code_point = 0x10000 + ((code_point - 0xd800) << 10) + (low - 0xdc00);
+        } else if (code_point >= 0xdc00 && code_point <= 0xdfff) {
+          return false;
+        }
+        AppendUtf8(code_point, out);
+        break;
+      }
+      default:
+        return false;
+    }
+  }
+  return true;
+}
+
+bool JsonReader::ScanNumber(absl::string_view* text, bool* is_integer_literal) {
+  const size_t start = pos_;
+  const auto consume_digits = [this] {
+    const size_t digits_start = pos_;
+    while (pos_ < document_.size() && IsDigit(document_[pos_])) {
+      ++pos_;
+    }
+    return pos_ > digits_start;
+  };
+  const auto next_is = [this](char c) {
+    return pos_ < document_.size() && document_[pos_] == c;
+  };
+
+  if (next_is('-')) {
+    ++pos_;
+  }
+  if (next_is('0')) {
+    ++pos_;  // No leading zeros.
+  } else if (!consume_digits()) {
+    return Fail();
+  }
+
+  *is_integer_literal = true;
+  if (next_is('.')) {
+    ++pos_;
+    *is_integer_literal = false;
+    if (!consume_digits()) {
+      return Fail();
+    }
+  }
+  if (next_is('e') || next_is('E')) {
+    ++pos_;
+    *is_integer_literal = false;
+    if (next_is('+') || next_is('-')) {
+      ++pos_;
+    }
+    if (!consume_digits()) {
+      return Fail();
+    }
+  }
+
+  *text = document_.substr(start, pos_ - start);
+  return true;
+}
+
+bool JsonReader::ScanLiteral(absl::string_view word) {
+  if (document_.substr(pos_, word.size()) != word) {
+    return Fail();
+  }
+  pos_ += word.size();
+  return true;
+}
+
+// static
+constexpr int JsonReader::kMaxDepth;
+
+}  // namespace json
+}  // namespace openscreen
@@ -0,0 +1,165 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UTIL_JSON_JSON_READER_H_
+#define UTIL_JSON_JSON_READER_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+
+namespace openscreen {
+namespace json {
+
+// A forward-only, pull-style JSON reader. Rather than building a Json::Value
+// DOM, the caller walks the document, reading each value straight into its own
+// C++ structs, and skipping anything it does not care about. For example:
+//
+//   JsonReader reader(document);
+//   absl::string_view key;
+//   if (reader.BeginObject()) {
+//     while (reader.NextMember(&key)) {
+//       if (key == "seqNum") {
+//         if (!reader.ReadInt(&sequence_number)) {
+//           reader.SkipValue();  // Not an int: ignore it.
+//         }
+//       } else {
+//         reader.SkipValue();
+//       }
+//     }
+//   }
+//   if (!reader.Finish()) {
+//     // Invalid JSON.
+//   }
+//
+// Syntax errors are sticky: once one is found, every method returns false,
+// and so does Finish(). A Read*() method that finds a value of another type
+// also returns false, but consumes nothing, so the caller may SkipValue().
+//
+// Like json::Parse(), the document must be a single object or array, and
+// comments are not allowed. Unlike json::Parse(), duplicate keys are not
+// detected.
+class JsonReader {
+ public:
+  enum class ValueType {
+    kInvalid,
+    kNull,
+    kBool,
+    kNumber,
+    kString,
+    kArray,
+    kObject,
+  };
+
+  explicit JsonReader(absl::string_view document);
+  ~JsonReader();
+
+  // False once a syntax error has been found.
+  bool ok() const { return ok_; }
+
+  // Returns the type of the next value, without consuming it.
+  ValueType PeekType();
+
+  // Consumes the start of an object. Then, NextMember() reads the key of each
+  // member in turn, after which the caller must consume exactly one value.
+  // Once there are no more members, NextMember() consumes the end of the
+  // object and returns false. |key| remains valid until the next call.
+  bool BeginObject();
+  bool NextMember(absl::string_view* key);
+
+  // Consumes the start of an array. Then, NextElement() returns true before
+  // each element, which the caller must consume. Once there are no more
+  // elements, NextElement() consumes the end of the array and returns false.
+  bool BeginArray();
+  bool NextElement();
+
+  // Scalar values. ReadInt() only accepts numbers that are exactly
+  // representable as an int (including, e.g., 3.0), just like
+  // Json::Value::isInt().
+  bool ReadString(std::string* out);
+  bool ReadInt(int* out);
+  bool ReadDouble(double* out);
+  bool ReadBool(bool* out);
+  bool ReadNull();
+
+  // Like ReadString(), but without copying: |out| points into the document,
+  // unless the string had escape sequences, in which case it points to the
+  // decoded string, which remains valid until the next call.
+  bool ReadString(absl::string_view* out);
+
+  // Consumes the next value, of any type, including everything nested within.
+  bool SkipValue();
+
+  // Like SkipValue(), but also sets |raw| to the text of the value, which
+  // points into the document.
+  bool ReadRawValue(absl::string_view* raw);
+
+  // Returns true if the document was valid, and has been entirely consumed
+  // (aside from trailing whitespace).
+  bool Finish();
+
+  // The maximum depth of nested arrays and objects.
+  static constexpr int kMaxDepth = 256;
+
+ private:
+  // Sets the sticky error state, and returns false.
+  bool Fail();
+
+  void SkipWhitespace();
+
+  // Consumes |c| (after any whitespace), failing if it is not next.
+  bool Expect(char c);
+
+  // Called before consuming a scalar value. The root of the document must be
+  // an object or array.
+  bool CheckScalarAllowed();
+
+  // Shared by BeginObject() and BeginArray().
+  bool BeginContainer(char open, char close);
+
+  // Shared by NextMember() and NextElement(): Consumes the separating comma,
+  // if needed, and returns false at the |close| character.
+  bool NextInContainer(char close);
+
+  // Scans the string starting at |pos_|, which must be a '"', setting |raw|
+  // to its contents (between the quotes) and whether they contain any escape
+  // sequences.
+  bool ScanString(absl::string_view* raw, bool* has_escapes);
+
+  // Decodes the escape sequences in |raw| into |out|.
+  static bool Unescape(absl::string_view raw, std::string* out);
+
+  // Scans the number starting at |pos_|, setting |text| to it, and whether it
+  // is an integer literal (no fraction or exponent).
+  bool ScanNumber(absl::string_view* text, bool* is_integer_literal);
+
+  // Consumes the literal |word| (e.g., "true"), failing otherwise.
+  bool ScanLiteral(absl::string_view word);
+
+  struct Container {
+    char close;         // The character that ends the container.
+    bool expect_comma;  // Whether a comma precedes the next member/element.
+  };
+
+  const absl::string_view document_;
+  size_t pos_ = 0;
+  bool ok_ = true;
+
+  // Set once the root object or array has begun.
+  bool has_root_ = false;
+
+  // The objects and arrays currently open, innermost last.
+  std::vector<Container> containers_;
+
+  // Hold the most recent object key, and the most recent string value read
+  // by ReadString(absl::string_view*), if they had escape sequences.
+  std::string key_buffer_;
+  std::string value_buffer_;
+};
+
+}  // namespace json
+}  // namespace openscreen
+
+#endif  // UTIL_JSON_JSON_READER_H_
@@ -0,0 +1,255 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "util/json/json_reader.h"
+
+#include <string>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace openscreen {
+namespace json {
+namespace {
+
+using ValueType = JsonReader::ValueType;
+
+// Returns true if the reader considers |document| to be valid JSON.
+bool IsValid(const std::string& document) {
+  JsonReader reader(document);
+  reader.SkipValue();
+  return reader.Finish();
+}
+
+}  // namespace
+
+TEST(JsonReaderTest, ReadsObjectMembers) {
+  JsonReader reader(R"({
+    "type": "OFFER", "seqNum": 42, "ratio": 1.5,
+    "enabled": true, "nothing": null
+  })");
+
+  std::string type;
+  int seq_num = 0;
+  double ratio = 0;
+  bool enabled = false;
+  bool saw_null = false;
+
+  ASSERT_TRUE(reader.BeginObject());
+  absl::string_view key;
+  while (reader.NextMember(&key)) {
+    if (key == "type") {
+      EXPECT_TRUE(reader.ReadString(&type));
+    } else if (key == "seqNum") {
+      EXPECT_TRUE(reader.ReadInt(&seq_num));
+    } else if (key == "ratio") {
+      EXPECT_TRUE(reader.ReadDouble(&ratio));
+    } else if (key == "enabled") {
+      EXPECT_TRUE(reader.ReadBool(&enabled));
+    } else if (key == "nothing") {
+      saw_null = reader.ReadNull();
+    } else {
+      ADD_FAILURE() << "Unexpected key: " << key;
+      reader.SkipValue();
+    }
+  }
+  EXPECT_TRUE(reader.Finish());
+
+  EXPECT_EQ("OFFER", type);
+  EXPECT_EQ(42, seq_num);
+  EXPECT_EQ(1.5, ratio);
+  EXPECT_TRUE(enabled);
+  EXPECT_TRUE(saw_null);
+}
+
+TEST(JsonReaderTest, ReadsNestedArrays) {
+  JsonReader reader(R"([[1, 2], [], [3]])");
+  std::vector<int> values;
+  int arrays = 0;
+
+  ASSERT_TRUE(reader.BeginArray());
+  while (reader.NextElement()) {
+    ASSERT_EQ(ValueType::kArray, reader.PeekType());
+    ASSERT_TRUE(reader.BeginArray());
+    ++arrays;
+    while (reader.NextElement()) {
+      int value;
+      ASSERT_TRUE(reader.ReadInt(&value));
+      values.push_back(value);
+    }
+  }
+  EXPECT_TRUE(reader.Finish());
+
+  EXPECT_EQ(3, arrays);
+  EXPECT_EQ((std::vector<int>{1, 2, 3}), values);
+}
+
+TEST(JsonReaderTest, TypeMismatchConsumesNothing) {
+  JsonReader reader(R"({"a": "text", "b": 1.5, "c": 3.0, "d": 1e100})");
+  ASSERT_TRUE(reader.BeginObject());
+  absl::string_view key;
+
+  ASSERT_TRUE(reader.NextMember(&key));
+  int value = 0;
+  EXPECT_FALSE(reader.ReadInt(&value));
+  std::string text;
+  EXPECT_TRUE(reader.ReadString(&text));
+  EXPECT_EQ("text", text);
+
+  ASSERT_TRUE(reader.NextMember(&key));
+  EXPECT_FALSE(reader.ReadInt(&value));
+  EXPECT_FALSE(reader.ReadString(&text));
+  EXPECT_TRUE(reader.SkipValue());
+
+  // Integral values are ints, even if they are not integer literals.
+  ASSERT_TRUE(reader.NextMember(&key));
+  EXPECT_TRUE(reader.ReadInt(&value));
+  EXPECT_EQ(3, value);
+
+  // ...as long as they are in range.
+  ASSERT_TRUE(reader.NextMember(&key));
+  EXPECT_FALSE(reader.ReadInt(&value));
+  double big = 0;
+  EXPECT_TRUE(reader.ReadDouble(&big));
+  EXPECT_EQ(1e100, big);
+
+  EXPECT_FALSE(reader.NextMember(&key));
+  EXPECT_TRUE(reader.Finish());
+}
+
+TEST(JsonReaderTest, DecodesEscapeSequences) {
+  JsonReader reader(R"({"k\"ey": "tab\there \u00e9 \ud83d\ude00 \/\\"})");
+  ASSERT_TRUE(reader.BeginObject());
+  absl::string_view key;
+  ASSERT_TRUE(reader.NextMember(&key));
+  EXPECT_EQ("k\"ey", key);
+  std::string value;
+  ASSERT_TRUE(reader.ReadString(&value));
+  EXPECT_EQ("tab\there \xc3\xa9 \xf0\x9f\x98\x80 /\\", value);
+  EXPECT_FALSE(reader.NextMember(&key));
+  EXPECT_TRUE(reader.Finish());
+}
+
+TEST(JsonReaderTest, ReadsStringViews) {
+  const std::string document = R"(["plain", "esc\u0061ped"])";
+  JsonReader reader(document);
+  ASSERT_TRUE(reader.BeginArray());
+
+  absl::string_view value;
+  ASSERT_TRUE(reader.NextElement());
+  ASSERT_TRUE(reader.ReadString(&value));
+  EXPECT_EQ("plain", value);
+  // Strings without escape sequences are not copied.
+  EXPECT_GE(value.data(), document.data());
+  EXPECT_LT(value.data(), document.data() + document.size());
+
+  ASSERT_TRUE(reader.NextElement());
+  ASSERT_TRUE(reader.ReadString(&value));
+  EXPECT_EQ("escaped", value);
+
+  EXPECT_FALSE(reader.NextElement());
+  EXPECT_TRUE(reader.Finish());
+}
+
+TEST(JsonReaderTest, ReadsRawValues) {
+  JsonReader reader(R"({"offer": {"a": [1, {"b": null}]}, "seqNum": 1})");
+  ASSERT_TRUE(reader.BeginObject());
+  absl::string_view key;
+  ASSERT_TRUE(reader.NextMember(&key));
+  absl::string_view raw;
+  ASSERT_TRUE(reader.ReadRawValue(&raw));
+  EXPECT_EQ(R"({"a": [1, {"b": null}]})", raw);
+  ASSERT_TRUE(reader.NextMember(&key));
+  EXPECT_EQ("seqNum", key);
+  EXPECT_TRUE(reader.SkipValue());
+  EXPECT_FALSE(reader.NextMember(&key));
+  EXPECT_TRUE(reader.Finish());
+}
+
+TEST(JsonReaderTest, AcceptsValidDocuments) {
+  const std::string kValidDocuments[] = {
+      "{}",
+      "[]",
+      " \n{ } \t",
+      R"({"a": [true, false, null, -0, 0.5, 1E+2, -3e-4, "A"]})",
+      R"([{}, [], [[]], {"": ""}])",
+  };
+  for (const std::string& document : kValidDocuments) {
+    EXPECT_TRUE(IsValid(document)) << document;
+  }
+}
+
+TEST(JsonReaderTest, RejectsInvalidDocuments) {
+  const std::string kInvalidDocuments[] = {
+      "",
+      "{",
+      "]",
+      "42",
+      R"("root string")",
+      "{} {}",
+      "{}x",
+      "{ foo: bar }",
+      R"({"a": 1,})",
+      R"({"a" 1})",
+      R"({"a": 1 "b": 2})",
+      "[1, 2,]",
+      "[01]",
+      "[1.]",
+      "[.5]",
+      "[1e]",
+      "[-]",
+      "[tru]",
+      "[nul]",
+      R"(["unterminated])",
+      "[\"control\x01char\"]",
+      R"(["bad \x escape"])",
+      "[1] // comment",
+      std::string(JsonReader::kMaxDepth + 1, '[') +
+          std::string(JsonReader::kMaxDepth + 1, ']'),
+  };
+  for (const std::string& document : kInvalidDocuments) {
+    EXPECT_FALSE(IsValid(document)) << document;
+  }
+}
+
+TEST(JsonReaderTest, RejectsInvalidUnicodeEscapes) {
+  const std::string kInvalidDocuments[] = {
+      R"(["\u12"])",
+      R"(["\uzzzz"])",
+      R"(["\ud83d"])",
+      R"(["\ude00"])",
+      R"(["\ud83dA"])",
+  };
+  for (const std::string& document : kInvalidDocuments) {
+    JsonReader reader(document);
+    ASSERT_TRUE(reader.BeginArray());
+    ASSERT_TRUE(reader.NextElement());
+    std::string value;
+    EXPECT_FALSE(reader.ReadString(&value)) << document;
+    EXPECT_FALSE(reader.Finish()) << document;
+  }
+}
+
+TEST(JsonReaderTest, ErrorsAreSticky) {
+  JsonReader reader(R"({"a": x, "b": 1})");
+  ASSERT_TRUE(reader.BeginObject());
+  absl::string_view key;
+  ASSERT_TRUE(reader.NextMember(&key));
+  EXPECT_FALSE(reader.SkipValue());
+  EXPECT_FALSE(reader.ok());
+  EXPECT_FALSE(reader.NextMember(&key));
+  EXPECT_EQ(ValueType::kInvalid, reader.PeekType());
+  EXPECT_FALSE(reader.Finish());
+}
+
+TEST(JsonReaderTest, FinishRequiresWholeDocument) {
+  JsonReader reader(R"({"a": 1})");
+  ASSERT_TRUE(reader.BeginObject());
+  absl::string_view key;
+  ASSERT_TRUE(reader.NextMember(&key));
+  EXPECT_FALSE(reader.Finish());
+}
+
+}  // namespace json
+}  // namespace openscreen
@@ -0,0 +1,261 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "util/json/json_writer.h"
+
+#include <stdio.h>
+
+#include <cmath>
+
+#include "absl/strings/ascii.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "util/json/json_document.h"
+#include "util/osp_logging.h"
+
+namespace openscreen {
+namespace json {
+
+namespace {
+
+bool NeedsEscaping(char c) {
+  return c == '"' || c == '\\' || static_cast<unsigned char>(c) < 0x20;
+}
+
+// Appends |value| to |out| like printf("%.*g"), but always with a '.' for the
+// decimal point. snprintf() uses the decimal point of the current locale,
+// which may be ',' (or even several bytes), so it is replaced here, just as
+// jsoncpp does.
+void AppendDouble(double value, int precision, std::string* out) {
+  char buffer[32];
+  const int length = snprintf(buffer, sizeof(buffer), "%.*g", precision, value);
+  OSP_DCHECK_GT(length, 0);
+  OSP_DCHECK_LT(length, static_cast<int>(sizeof(buffer)));
+  bool in_decimal_point = false;
+  for (int i = 0; i < length; ++i) {
+    const char c = buffer[i];
+    if (absl::ascii_isdigit(c) || c == '-' || c == '+' || c == 'e') {
+      out->push_back(c);
+      in_decimal_point = false;
+    } else if (!in_decimal_point) {
+      out->push_back('.');
+      in_decimal_point = true;
+    }
+  }
+}
+
+}  // namespace
+
+JsonWriter::JsonWriter(std::string* out) : out_(out) {
+  OSP_DCHECK(out_);
+}
+
+JsonWriter::~JsonWriter() = default;
+
+void JsonWriter::BeginObject() {
+  BeginValue();
+  out_->push_back('{');
+  needs_comma_ = false;
+}
+
+void JsonWriter::EndObject() {
+  out_->push_back('}');
+  needs_comma_ = true;
+}
+
+void JsonWriter::BeginArray() {
+  BeginValue();
+  out_->push_back('[');
+  needs_comma_ = false;
+}
+
+void JsonWriter::EndArray() {
+  out_->push_back(']');
+  needs_comma_ = true;
+}
+
+void JsonWriter::Key(absl::string_view key) {
+  BeginValue();
+  AppendEscaped(key);
+  out_->push_back(':');
+  // The value that follows belongs with the key.
+  needs_comma_ = false;
+}
+
+void JsonWriter::String(absl::string_view value) {
+  BeginValue();
+  AppendEscaped(value);
+}
+
+void JsonWriter::Int(int64_t value) {
+  BeginValue();
+  absl::StrAppend(out_, value);
+}
+
+void JsonWriter::Uint(uint64_t value) {
+  BeginValue();
+  absl::StrAppend(out_, value);
+}
+
+void JsonWriter::Double(double value) {
+  BeginValue();
+  if (!std::isfinite(value)) {
+    // JSON has no representation for these.
+    out_->append("null");
+    return;
+  }
+
+  // Use the shortest representation that reads back as the same value.
+  // Unlike strtod(), absl::SimpleAtod() does not depend on the locale either.
+  const size_t start = out_->size();
+  AppendDouble(value, 15, out_);
+  double read_back;
+  if (!absl::SimpleAtod(absl::string_view(*out_).substr(start), &read_back) ||
+      read_back != value) {
+    out_->resize(start);
+    AppendDouble(value, 17, out_);
+  }
+}
+
+void JsonWriter::Bool(bool value) {
+  BeginValue();
+  out_->append(value ? "true" : "false");
+}
+
+void JsonWriter::Null() {
+  BeginValue();
+  out_->append("null");
+}
+
+void JsonWriter::Value(const JsonValue& value) {
+  switch (value.type()) {
+    case JsonValue::Type::kNull:
+      Null();
+      break;
+    case JsonValue::Type::kBool:
+      Bool(value.as_bool());
+      break;
+    case JsonValue::Type::kNumber:
+      Double(value.as_double());
+      break;
+    case JsonValue::Type::kString:
+      String(value.as_string());
+      break;
+    case JsonValue::Type::kArray:
+      BeginArray();
+      for (const JsonValue& element : value.elements()) {
+        Value(element);
+      }
+      EndArray();
+      break;
+    case JsonValue::Type::kObject:
+      BeginObject();
+      for (const JsonMember& member : value.members()) {
+        Key(member.key);
+        Value(member.value);
+      }
+      EndObject();
+      break;
+  }
+}
+
+void JsonWriter::Value(const Json::Value& value) {
+  switch (value.type()) {
+    case Json::nullValue:
+      Null();
+      break;
+    case Json::intValue:
+      Int(value.asLargestInt());
+      break;
+    case Json::uintValue:
+      Uint(value.asLargestUInt());
+      break;
+    case Json::realValue:
+      Double(value.asDouble());
+      break;
+    case Json::stringValue: {
+      const char* begin;
+      const char* end;
+      value.getString(&begin, &end);
+      String(absl::string_view(begin, end - begin));
+      break;
+    }
+    case Json::booleanValue:
+      Bool(value.asBool());
+      break;
+    case Json::arrayValue:
+      BeginArray();
+      for (const Json::Value& element : value) {
+        Value(element);
+      }
+      EndArray();
+      break;
+    case Json::objectValue:
+      BeginObject();
+      for (auto it = value.begin(), end = value.end(); it != end; ++it) {
+        const char* name_end;
+        const char* name = it.memberName(&name_end);
+        Key(absl::string_view(name, name_end - name));
+        Value(*it);
+      }
+      EndObject();
+      break;
+  }
+}
+
+void JsonWriter::BeginValue() {
+  if (needs_comma_) {
+    out_->push_back(',');
+  }
+  needs_comma_ = true;
+}
+
+void JsonWriter::AppendEscaped(absl::string_view str) {
+  static constexpr char kHexDigits[] = "0123456789abcdef";
+
+  out_->push_back('"');
+  size_t run_start = 0;
+  for (size_t i = 0; i < str.size(); ++i) {
+    const char c = str[i];
+    if (!NeedsEscaping(c)) {
+      continue;
+    }
+    out_->append(str.data() + run_start, i - run_start);
+    run_start = i + 1;
+    switch (c) {
+      case '"':
+        out_->append("\\\"");
+        break;
+      case '\\':
+        out_->append("\\\\");
+        break;
+      case '\b':
+        out_->append("\\b");
+        break;
+      case '\f':
+        out_->append("\\f");
+        break;
+      case '\n':
+        out_->append("\\n");
+        break;
+      case '\r':
+        out_->append("\\r");
+        break;
+      case '\t':
+        out_->append("\\t");
+        break;
+      default:
+        out_->append("\\u00");
+        out_->push_back(kHexDigits[(c >> 4) & 0xf]);
+        out_->push_back(kHexDigits[c & 0xf]);
+        break;
+    }
+  }
+  out_->append(str.data() + run_start, str.size() - run_start);
+  out_->push_back('"');
+}
+
+}  // namespace json
+}  // namespace openscreen
@@ -0,0 +1,74 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UTIL_JSON_JSON_WRITER_H_
+#define UTIL_JSON_JSON_WRITER_H_
+
+#include <stdint.h>
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "json/value.h"
+
+namespace openscreen {
+namespace json {
+
+class JsonValue;
+
+// Writes compact JSON by appending to a caller-provided string, which can be
+// cleared and reused for the next document, so that once it has grown to the
+// size of the largest message, writing allocates nothing. For example:
+//
+//   buffer.clear();
+//   JsonWriter writer(&buffer);
+//   writer.BeginObject();
+//   writer.Key("type");
+//   writer.String("CONNECTED");
+//   writer.Key("protocolVersion");
+//   writer.Int(4);
+//   writer.EndObject();
+//
+// It is up to the caller to write a well-formed document: a key before each
+// value in an object, and a single root.
+class JsonWriter {
+ public:
+  explicit JsonWriter(std::string* out);
+  JsonWriter(const JsonWriter&) = delete;
+  JsonWriter& operator=(const JsonWriter&) = delete;
+  ~JsonWriter();
+
+  void BeginObject();
+  void EndObject();
+  void BeginArray();
+  void EndArray();
+  void Key(absl::string_view key);
+
+  void String(absl::string_view value);
+  void Int(int64_t value);
+  void Uint(uint64_t value);
+  void Double(double value);
+  void Bool(bool value);
+  void Null();
+
+  // Writes a whole value, and everything nested within it.
+  void Value(const JsonValue& value);
+  void Value(const Json::Value& value);
+
+ private:
+  // Writes the separating comma, if one is needed before the next value.
+  void BeginValue();
+  void AppendEscaped(absl::string_view str);
+
+  std::string* const out_;
+
+  // Whether a value has been written at the current nesting level, so a comma
+  // is needed before the next one.
+  bool needs_comma_ = false;
+};
+
+}  // namespace json
+}  // namespace openscreen
+
+#endif  // UTIL_JSON_JSON_WRITER_H_
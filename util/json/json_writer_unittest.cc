@@ -0,0 +1,159 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "util/json/json_writer.h"
+
+#include <clocale>
+#include <limits>
+#include <string>
+
+#include "gtest/gtest.h"
+#include "util/json/json_document.h"
+#include "util/json/json_serialization.h"
+
+namespace openscreen {
+namespace json {
+
+TEST(JsonWriterTest, WritesCompactDocuments) {
+  std::string buffer;
+  JsonWriter writer(&buffer);
+  writer.BeginObject();
+  writer.Key("type");
+  writer.String("CONNECT");
+  writer.Key("versions");
+  writer.BeginArray();
+  writer.Int(-1);
+  writer.Uint(18446744073709551615u);
+  writer.Double(0.1);
+  writer.Double(3);
+  writer.BeginObject();
+  writer.EndObject();
+  writer.BeginArray();
+  writer.EndArray();
+  writer.EndArray();
+  writer.Key("ok");
+  writer.Bool(true);
+  writer.Key("nothing");
+  writer.Null();
+  writer.EndObject();
+
+  EXPECT_EQ(
+      R"({"type":"CONNECT","versions":[-1,18446744073709551615,0.1,3,{},[]],)"
+      R"("ok":true,"nothing":null})",
+      buffer);
+}
+
+TEST(JsonWriterTest, AppendsToBuffer) {
+  std::string buffer = "prefix:";
+  JsonWriter writer(&buffer);
+  writer.BeginArray();
+  writer.EndArray();
+  EXPECT_EQ("prefix:[]", buffer);
+}
+
+TEST(JsonWriterTest, EscapesStrings) {
+  std::string buffer;
+  JsonWriter writer(&buffer);
+  writer.BeginArray();
+  writer.String("quote\" backslash\\ newline\n tab\t bell\x07 utf8 \xc3\xa9");
+  writer.EndArray();
+  EXPECT_EQ(
+      R"(["quote\" backslash\\ newline\n tab\t bell\u0007 utf8 )"
+      "\xc3\xa9\"]",
+      buffer);
+
+  // It reads back the same.
+  JsonDocument document;
+  ASSERT_TRUE(document.Parse(buffer).ok());
+  EXPECT_EQ("quote\" backslash\\ newline\n tab\t bell\x07 utf8 \xc3\xa9",
+            document.root()[0].as_string());
+}
+
+TEST(JsonWriterTest, WritesDoublesThatReadBackTheSame) {
+  const double kValues[] = {0.0,  -2.5,     1.0 / 3, 1e300,
+                            5e-324, 123456.0, -1e-7,   0.30000000000000004};
+  for (double value : kValues) {
+    std::string buffer;
+    JsonWriter writer(&buffer);
+    writer.BeginArray();
+    writer.Double(value);
+    writer.EndArray();
+
+    JsonDocument document;
+    ASSERT_TRUE(document.Parse(buffer).ok()) << buffer;
+    EXPECT_EQ(value, document.root()[0].as_double()) << buffer;
+  }
+
+  std::string buffer;
+  JsonWriter writer(&buffer);
+  writer.BeginArray();
+  writer.Double(std::numeric_limits<double>::quiet_NaN());
+  writer.Double(std::numeric_limits<double>::infinity());
+  writer.EndArray();
+  EXPECT_EQ("[null,null]", buffer);
+}
+
+TEST(JsonWriterTest, WritesDoublesRegardlessOfLocale) {
+  // Many locales use ',' for the decimal point, though the system may not have
+  // any of these, in which case this test proves little.
+  const std::string old_locale = setlocale(LC_NUMERIC, nullptr);
+  for (const char* name : {"de_DE.UTF-8", "fr_FR.UTF-8", "de_DE", "fr_FR"}) {
+    if (setlocale(LC_NUMERIC, name)) {
+      break;
+    }
+  }
+
+  std::string buffer;
+  JsonWriter writer(&buffer);
+  writer.BeginArray();
+  writer.Double(2.5);
+  writer.Double(0.1);
+  writer.Double(1.0 / 3);
+  writer.EndArray();
+  setlocale(LC_NUMERIC, old_locale.c_str());
+
+  EXPECT_EQ("[2.5,0.1,0.33333333333333331]", buffer);
+}
+
+TEST(JsonWriterTest, WritesJsonDocumentValues) {
+  const std::string text =
+      R"({"b":[1,2.5,"x\"y"],"a":{"t":true,"f":false,"n":null}})";
+  JsonDocument document;
+  ASSERT_TRUE(document.Parse(text).ok());
+
+  std::string buffer;
+  JsonWriter writer(&buffer);
+  writer.Value(document.root());
+  EXPECT_EQ(text, buffer);
+}
+
+TEST(JsonWriterTest, WritesJsonCppValues) {
+  Json::Value root;
+  root["type"] = "CONNECTED";
+  root["int"] = -7;
+  root["uint"] = Json::UInt64(1) << 40;
+  root["real"] = 0.5;
+  root["list"].append(true);
+  root["list"].append(Json::Value());
+  root["empty"] = Json::Value(Json::objectValue);
+
+  std::string buffer;
+  JsonWriter writer(&buffer);
+  writer.Value(root);
+
+  // jsoncpp orders the members by name.
+  EXPECT_EQ(
+      R"({"empty":{},"int":-7,"list":[true,null],"real":0.5,)"
+      R"("type":"CONNECTED","uint":1099511627776})",
+      buffer);
+
+  // The result is equivalent to that of json::Stringify().
+  ErrorOr<Json::Value> reparsed = json::Parse(buffer);
+  ASSERT_TRUE(reparsed.is_value());
+  EXPECT_EQ(json::Stringify(root).value(),
+            json::Stringify(reparsed.value()).value());
+}
+
+}  // namespace json
+}  // namespace openscreen
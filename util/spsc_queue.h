@@ -0,0 +1,94 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef UTIL_SPSC_QUEUE_H_
+#define UTIL_SPSC_QUEUE_H_
+
+#include <stddef.h>
+
+#include <atomic>
+#include <utility>
+#include <vector>
+
+#include "platform/base/macros.h"
+#include "util/osp_logging.h"
+
+namespace openscreen {
+
+// A fixed-capacity FIFO queue for passing values from exactly one producer
+// thread to exactly one consumer thread, without locking. TryPush() must only
+// be called from the producer thread, and TryPop() only from the consumer
+// thread. The other methods may be called from either thread, but their results
+// are only a snapshot.
+//
+// |T| must be default-constructible and move-assignable. Popped slots are reset
+// to a default-constructed T, so that any resources held by a value are freed
+// promptly.
+template <typename T>
+class SpscQueue {
+ public:
+  explicit SpscQueue(size_t capacity) : slots_(capacity + 1) {
+    OSP_DCHECK_GT(capacity, 0u);
+  }
+  ~SpscQueue() = default;
+
+  size_t capacity() const { return slots_.size() - 1; }
+
+  // Moves |value| to the back of the queue and returns true, or returns false
+  // (leaving |value| untouched) if the queue is full.
+  bool TryPush(T&& value) {
+    const size_t tail = tail_.load(std::memory_order_relaxed);
+    const size_t next_tail = Advance(tail);
+    if (next_tail == head_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    slots_[tail] = std::move(value);
+    tail_.store(next_tail, std::memory_order_release);
+    return true;
+  }
+
+  // Moves the value at the front of the queue into |*value| and returns true,
+  // or returns false if the queue is empty.
+  bool TryPop(T* value) {
+    OSP_DCHECK(value);
+    const size_t head = head_.load(std::memory_order_relaxed);
+    if (head == tail_.load(std::memory_order_acquire)) {
+      return false;
+    }
+    *value = std::move(slots_[head]);
+    slots_[head] = T();
+    head_.store(Advance(head), std::memory_order_release);
+    return true;
+  }
+
+  size_t size() const {
+    const size_t head = head_.load(std::memory_order_acquire);
+    const size_t tail = tail_.load(std::memory_order_acquire);
+    return (tail >= head) ? (tail - head) : (tail + slots_.size() - head);
+  }
+
+  bool empty() const { return size() == 0; }
+
+ private:
+  size_t Advance(size_t index) const {
+    return (index + 1 == slots_.size()) ? 0 : (index + 1);
+  }
+
+  // One more slot than the capacity, so that a full queue can be told apart
+  // from an empty one without a separate counter.
+  std::vector<T> slots_;
+
+  // The index of the next slot to pop, written only by the consumer. Kept on
+  // its own cache line, apart from |tail_|, to avoid false sharing.
+  alignas(64) std::atomic<size_t> head_{0};
+
+  // The index of the next slot to fill, written only by the producer.
+  alignas(64) std::atomic<size_t> tail_{0};
+
+  OSP_DISALLOW_COPY_AND_ASSIGN(SpscQueue);
+};
+
+}  // namespace openscreen
+
+#endif  // UTIL_SPSC_QUEUE_H_
@@ -0,0 +1,91 @@
+// Copyright 2021 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "util/spsc_queue.h"
+
+#include <memory>
+#include <thread>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+namespace openscreen {
+namespace {
+
+TEST(SpscQueueTest, PushesAndPopsInOrderUpToCapacity) {
+  SpscQueue<int> queue(3);
+  EXPECT_EQ(3u, queue.capacity());
+  EXPECT_TRUE(queue.empty());
+
+  int value = -1;
+  EXPECT_FALSE(queue.TryPop(&value));
+  EXPECT_TRUE(queue.TryPush(1));
+  EXPECT_TRUE(queue.TryPush(2));
+  EXPECT_TRUE(queue.TryPush(3));
+  EXPECT_FALSE(queue.TryPush(4));
+  EXPECT_EQ(3u, queue.size());
+
+  ASSERT_TRUE(queue.TryPop(&value));
+  EXPECT_EQ(1, value);
+  // Wrap around the end of the internal storage.
+  EXPECT_TRUE(queue.TryPush(4));
+  EXPECT_FALSE(queue.TryPush(5));
+  for (int expected = 2; expected <= 4; ++expected) {
+    ASSERT_TRUE(queue.TryPop(&value));
+    EXPECT_EQ(expected, value);
+  }
+  EXPECT_FALSE(queue.TryPop(&value));
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(SpscQueueTest, MovesValuesInAndOut) {
+  SpscQueue<std::unique_ptr<int>> queue(2);
+  auto owned = std::make_unique<int>(42);
+  int* const raw = owned.get();
+  ASSERT_TRUE(queue.TryPush(std::move(owned)));
+  EXPECT_FALSE(owned);
+
+  std::unique_ptr<int> popped;
+  ASSERT_TRUE(queue.TryPop(&popped));
+  EXPECT_EQ(raw, popped.get());
+
+  // A failed push leaves the value with the caller.
+  ASSERT_TRUE(queue.TryPush(std::make_unique<int>(1)));
+  ASSERT_TRUE(queue.TryPush(std::make_unique<int>(2)));
+  auto rejected = std::make_unique<int>(3);
+  EXPECT_FALSE(queue.TryPush(std::move(rejected)));
+  ASSERT_TRUE(rejected);
+  EXPECT_EQ(3, *rejected);
+}
+
+TEST(SpscQueueTest, TransfersValuesBetweenThreads) {
+  constexpr int kNumValues = 100000;
+  SpscQueue<int> queue(16);
+  std::thread producer([&queue] {
+    for (int i = 0; i < kNumValues;) {
+      int value = i;
+      if (queue.TryPush(std::move(value))) {
+        ++i;
+      } else {
+        std::this_thread::yield();
+      }
+    }
+  });
+
+  int expected = 0;
+  while (expected < kNumValues) {
+    int value;
+    if (queue.TryPop(&value)) {
+      ASSERT_EQ(expected, value);
+      ++expected;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+  producer.join();
+  EXPECT_TRUE(queue.empty());
+}
+
+}  // namespace
+}  // namespace openscreen